@@ -144,6 +144,25 @@ extern "C"
         axis2_byte_t * input_stream,
         int input_stream_len);
 
+    /**
+     * Decodes a piece of base64 text and appends the binary to the buffer
+     * of the data handler, without copying the text first. Text split over
+     * several pieces is decoded by calling this for each piece in order.
+     * @param data_handler, a pointer to data handler struct
+     * @param env environment, MUST NOT be NULL.
+     * @param encoded base64 text, need not be '\0' terminated
+     * @param encoded_len length of the base64 text
+     * @param is_last AXIS2_TRUE for the last piece of the text
+     * @return status code, AXIS2_SUCCESS on success and AXIS2_FAILURE on error.
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axiom_data_handler_append_base64(
+        axiom_data_handler_t * data_handler,
+        const axutil_env_t * env,
+        const axis2_char_t * encoded,
+        int encoded_len,
+        axis2_bool_t is_last);
+
     /**
      * @param data_handler, a pointer to data handler struct
      * @param env environment, MUST NOT be NULL.
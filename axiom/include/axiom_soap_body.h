@@ -30,6 +30,7 @@
 #include <axiom_namespace.h>
 #include <axiom_soap_fault.h>
 #include <axiom_soap_envelope.h>
+#include <axiom_output.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -81,7 +82,9 @@ extern "C"
 
     /**
      * Indicates whether a soap fault is available with this 
-     * soap body 
+     * soap body. A fault is the first child element of the body, so a body
+     * being built is built up to the start of its first child element and
+     * no further.
      * @param body soap_body struct
      * @param env environment must not be null
      * @return AXIS2_TRUE if fault is available, AXIS2_FALSE otherwise
@@ -165,6 +168,40 @@ extern "C"
         const axutil_env_t * env);
 
 
+    /**
+     * Writes the child elements of the body to an output, for intermediaries
+     * that pass a body on without looking into it. The part of a received
+     * body that is not built yet is copied from the parser as it is read,
+     * without building it, and the body is left complete and empty; see
+     * axiom_stax_builder_forward_element_content. A body that is built, or
+     * that holds a fault, is serialized and kept.
+     * @param soap_body pointer to soap_body struct
+     * @param env axutil_environment struct MUST not be NULL
+     * @param om_output output to write to
+     * @returns AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axiom_soap_body_forward_content(
+        axiom_soap_body_t * soap_body,
+        const axutil_env_t * env,
+        axiom_output_t * om_output);
+
+    /**
+     * Replaces the content of a received body that is not built yet with a
+     * data source node holding it as text, copied from the parser without
+     * building it (see axiom_soap_body_forward_content). The node serializes
+     * its text as is, so a pass-through service can put it in the body of
+     * the message it sends on. Nothing is done for a body holding a fault.
+     * @param soap_body pointer to soap_body struct
+     * @param env axutil_environment struct MUST not be NULL
+     * @returns the data source node, now the only child of the body, or NULL
+     * if the body holds a fault or on error
+     */
+    AXIS2_EXTERN axiom_node_t *AXIS2_CALL
+    axiom_soap_body_capture_content(
+        axiom_soap_body_t * soap_body,
+        const axutil_env_t * env);
+
     AXIS2_EXTERN axis2_status_t AXIS2_CALL
     axiom_soap_body_process_attachments(
         axiom_soap_body_t * soap_body,
@@ -134,6 +134,29 @@ extern "C"
         struct axiom_stax_builder *builder,
         const axutil_env_t * env);
 
+    /**
+      * Writes the content of an element that is still being built to an
+      * output: the children built so far are serialized, the rest is copied
+      * from the parser event by event without building nodes for it. The
+      * element is complete afterwards and its children are freed, so the
+      * content can be passed on once, by an intermediary that never looks
+      * into it. The start and end tags of the element itself are not
+      * written. The namespaces in scope where the copying starts are
+      * declared again on the outermost elements copied, so that the content
+      * written stands on its own.
+      * @param builder pointer to stax builder struct to be used
+      * @param env environment, MUST NOT be NULL
+      * @param element_node element being built by this builder
+      * @param om_output output to write to
+      * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+      */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axiom_stax_builder_forward_element_content(
+        struct axiom_stax_builder *builder,
+        const axutil_env_t * env,
+        axiom_node_t * element_node,
+        struct axiom_output *om_output);
+
     /** @} */
 
 #ifdef __cplusplus
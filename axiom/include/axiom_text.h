@@ -216,6 +216,23 @@ extern "C"
         struct axiom_text *om_text,
         const axutil_env_t * env);
 
+    /**
+     * Decode the base64 value of a non optimized OM text, as sent by
+     * clients that do not use MTOM, into a new buffer data handler. The
+     * text is decoded in place, without an intermediate copy.
+     * @param om_text pointer to the OM Text struct
+     * @param environment Environment. MUST NOT be NULL
+     * @param mime_type content type of the decoded data, may be NULL
+     *
+     * @return the new data handler, or NULL if the text has no value.
+     * Caller must free it
+     */
+    AXIS2_EXTERN axiom_data_handler_t *AXIS2_CALL
+    axiom_text_create_data_handler_from_base64(
+        struct axiom_text *om_text,
+        const axutil_env_t * env,
+        const axis2_char_t * mime_type);
+
     /**
      * Get the Content ID of the OM text
      * @param om_text pointer to the OM Text struct
@@ -23,6 +23,7 @@
 #include <axutil_env.h>
 #include <axutil_stack.h>
 #include <axiom_soap.h>
+#include <axiom_xml_reader.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -77,6 +78,13 @@ extern "C"
       */
     typedef struct axiom_xpath_result_node axiom_xpath_result_node_t;
 
+    /**
+      * Cache of compiled XPath expressions
+      * Hands out compiled expressions by expression string; safe to share
+      * between threads.
+      */
+    typedef struct axiom_xpath_cache axiom_xpath_cache_t;
+
     /**
       * XPath result types
       */
@@ -173,6 +181,10 @@ extern "C"
 
         /** An array list containing the set of results */
         axutil_array_list_t * nodes;
+
+        /** Root of the nodes built by axiom_xpath_evaluate_reader;
+          * freed with the result */
+        axiom_node_t * streamed_root;
     };
 
     /**
@@ -354,6 +366,30 @@ extern "C"
         axiom_xpath_context_t *context,
         axiom_xpath_expression_t *xpath_expr);
 
+    /**
+      * Evaluates an XPath expression on the events of an XML reader without
+      * building the OM tree of the document.
+      * Unions of location paths with child, attribute, text() and '//' steps
+      * are supported, with predicates that can be decided at the start tag:
+      * tests and comparisons of the element's attributes and a leading
+      * position. Other expressions give a result flagged
+      * AXIOM_XPATH_ERROR_STREAMING_NOT_SUPPORTED.
+      * Only the matched elements are built; they belong to the result and are
+      * freed by axiom_xpath_free_result. Matched attributes are returned on a
+      * copy of their element without children. The reader is consumed up to
+      * the end of the document element.
+      *
+      * @param context XPath Context, must not be null. Only the environment and
+      *        the registered namespaces are used; the root node may be NULL
+      * @param xpath_expr XPath expression to be evaluated
+      * @param reader XML reader positioned before the document element
+      * @return The result set
+      */
+    AXIS2_EXTERN axiom_xpath_result_t * AXIS2_CALL axiom_xpath_evaluate_reader(
+        axiom_xpath_context_t *context,
+        axiom_xpath_expression_t *xpath_expr,
+        axiom_xml_reader_t *reader);
+
     /**
       * Checks whether the given expression can be evaluated on streaming XML.
       * If it is possible AXIS2_TRUE will be retuned; AXIS2_FALSE otherwise.
@@ -398,6 +434,54 @@ extern "C"
         axiom_xpath_context_t *context,
         axis2_char_t *name);
 
+    /**
+      * Creates a cache of compiled XPath expressions
+      *
+      * @param env Environment must not be null; it must outlive the cache
+      * @return The cache, NULL on failure
+      */
+    AXIS2_EXTERN axiom_xpath_cache_t * AXIS2_CALL axiom_xpath_cache_create(
+        const axutil_env_t *env);
+
+    /**
+      * Checks out a compiled expression from the cache, compiling it if there is
+      * no idle one. Evaluation keeps state in the compiled expression, so the
+      * caller has it exclusively until it is given back with
+      * axiom_xpath_cache_release. Namespace prefixes are resolved through the
+      * context at evaluation time, so one entry serves any namespace mapping.
+      *
+      * @param cache XPath expression cache, must not be null
+      * @param env Environment must not be null
+      * @param xpath_expr XPath expression as a string
+      * @return The compiled expression, NULL if it could not be parsed
+      */
+    AXIS2_EXTERN axiom_xpath_expression_t * AXIS2_CALL axiom_xpath_cache_get(
+        axiom_xpath_cache_t *cache,
+        const axutil_env_t *env,
+        const axis2_char_t *xpath_expr);
+
+    /**
+      * Gives back an expression obtained with axiom_xpath_cache_get
+      *
+      * @param cache XPath expression cache, must not be null
+      * @param env Environment must not be null
+      * @param expr Compiled expression
+      */
+    AXIS2_EXTERN void AXIS2_CALL axiom_xpath_cache_release(
+        axiom_xpath_cache_t *cache,
+        const axutil_env_t *env,
+        axiom_xpath_expression_t *expr);
+
+    /**
+      * Frees the cache and the idle expressions in it
+      *
+      * @param cache XPath expression cache
+      * @param env Environment must not be null
+      */
+    AXIS2_EXTERN void AXIS2_CALL axiom_xpath_cache_free(
+        axiom_xpath_cache_t *cache,
+        const axutil_env_t *env);
+
     /** @} */
 
 #ifdef __cplusplus
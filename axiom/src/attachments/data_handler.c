@@ -19,6 +19,7 @@
 #include <stdio.h>
 #include <sys/stat.h>
 #include <axiom_mime_part.h>
+#include <axutil_base64.h>
 
 struct axiom_data_handler
 {
@@ -46,6 +47,9 @@ struct axiom_data_handler
     /* In the case of sending callback this is required */
     void *user_param;    
 
+    /* While base64 text is being appended, the decoder state between
+     * the pieces */
+    axutil_base64_decoder_t *base64_decoder;
 };
 
 
@@ -80,6 +84,7 @@ axiom_data_handler_create(
     data_handler->cached = AXIS2_FALSE;
     data_handler->mime_id = NULL;
     data_handler->user_param = NULL;
+    data_handler->base64_decoder = NULL;
 
     if (mime_type)
     {
@@ -129,6 +134,11 @@ axiom_data_handler_free(
         AXIS2_FREE(env->allocator, data_handler->mime_id);
     }
 
+    if (data_handler->base64_decoder)
+    {
+        axutil_base64_decoder_free(data_handler->base64_decoder, env);
+    }
+
     if (data_handler)
     {
         AXIS2_FREE(env->allocator, data_handler);
@@ -369,6 +379,60 @@ axiom_data_handler_set_binary_data(
     return AXIS2_SUCCESS;
 }
 
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axiom_data_handler_append_base64(
+    axiom_data_handler_t *data_handler,
+    const axutil_env_t *env,
+    const axis2_char_t *encoded,
+    int encoded_len,
+    axis2_bool_t is_last)
+{
+    axis2_byte_t *buffer = NULL;
+    int len = 0;
+
+    AXIS2_PARAM_CHECK(env->error, encoded, AXIS2_FAILURE);
+
+    if (!data_handler->base64_decoder)
+    {
+        data_handler->base64_decoder = axutil_base64_decoder_create(env);
+        if (!data_handler->base64_decoder)
+        {
+            return AXIS2_FAILURE;
+        }
+    }
+
+    /* Grow the buffer by the most this piece can decode to and decode
+     * straight into it */
+    buffer = AXIS2_REALLOC(env->allocator, data_handler->buffer,
+        data_handler->buffer_len + (encoded_len / 4 + 1) * 3);
+    if (!buffer)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+            "No memory. Cannot decode base64 data to data handler");
+        return AXIS2_FAILURE;
+    }
+    data_handler->buffer = buffer;
+
+    len = axutil_base64_decoder_decode(data_handler->base64_decoder, env,
+        (unsigned char *) buffer + data_handler->buffer_len, encoded, encoded_len);
+    if (len < 0)
+    {
+        return AXIS2_FAILURE;
+    }
+    data_handler->buffer_len += len;
+
+    if (is_last)
+    {
+        data_handler->buffer_len += axutil_base64_decoder_finish(
+            data_handler->base64_decoder, env,
+            (unsigned char *) buffer + data_handler->buffer_len);
+        axutil_base64_decoder_free(data_handler->base64_decoder, env);
+        data_handler->base64_decoder = NULL;
+    }
+    return AXIS2_SUCCESS;
+}
+
 /* This function will write the data in the buffer 
  * to a file. When caching is being used this will 
  * not be called , because the parser it self cache 
@@ -500,7 +564,7 @@ axiom_data_handler_add_binary_data(
         else
         {
             binary_part->file_name = (axis2_char_t *)axutil_strdup(env, data_handler->file_name);
-            binary_part->part_size = stat_p.st_size;
+            binary_part->part_size = (size_t) stat_p.st_size;
             binary_part->type = AXIOM_MIME_PART_FILE;
         }    
     }
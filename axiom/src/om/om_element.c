@@ -22,6 +22,7 @@
 #include <axiom_namespace.h>
 #include <axiom_xml_writer.h>
 #include <axiom_stax_builder.h>
+#include <axutil_free_list.h>
 #include <string.h>
 #include <stdio.h>
 
@@ -82,8 +83,8 @@ axiom_element_create(
         AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "No Memory");
         return NULL;
     }
-    element = (axiom_element_t *) AXIS2_MALLOC(env->allocator,
-                                               sizeof(axiom_element_t));
+    element = (axiom_element_t *)
+        axutil_free_list_malloc(env->allocator, sizeof(axiom_element_t));
 
     if (!element)
     {
@@ -744,7 +745,8 @@ axiom_element_free(
     {
         AXIS2_FREE(env->allocator, om_element->text_value);
     }
-    AXIS2_FREE(env->allocator, om_element);
+    axutil_free_list_free(env->allocator, om_element,
+                          sizeof(axiom_element_t));
 
     return;
 }
@@ -1700,8 +1702,8 @@ axiom_element_create_str(
         AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
         return NULL;
     }
-    element = (axiom_element_t *) AXIS2_MALLOC(env->allocator,
-                                               sizeof(axiom_element_t));
+    element = (axiom_element_t *)
+        axutil_free_list_malloc(env->allocator, sizeof(axiom_element_t));
 
     if (!element)
     {
@@ -25,6 +25,7 @@
 #include <axiom_doctype.h>
 #include <axiom_document.h>
 #include <axiom_stax_builder.h>
+#include <axutil_free_list.h>
 
 struct axiom_node
 {
@@ -72,7 +73,8 @@ axiom_node_create(
     axiom_node_t *node = NULL;
     AXIS2_ENV_CHECK(env, NULL);
 
-    node = (axiom_node_t *) AXIS2_MALLOC(env->allocator, sizeof(axiom_node_t));
+    node = (axiom_node_t *) axutil_free_list_malloc(env->allocator,
+                                                    sizeof(axiom_node_t));
     if (!node)
     {
         env->error->error_number = AXIS2_ERROR_NO_MEMORY;
@@ -197,7 +199,7 @@ axiom_node_free_detached_subtree(
         }
     }
 
-    AXIS2_FREE(env->allocator, om_node);
+    axutil_free_list_free(env->allocator, om_node, sizeof(axiom_node_t));
 
     return;
 }
@@ -614,7 +616,9 @@ axiom_node_serialize(
                 }
             }
 
-            temp_node = axiom_node_get_next_sibling(om_node, env);
+            /* The siblings of the node being serialized are not part of it */
+            temp_node = count > 1 ?
+                axiom_node_get_next_sibling(om_node, env) : NULL;
             if (temp_node)
             {
                 om_node = temp_node;
@@ -24,6 +24,8 @@
 #include <axutil_string.h>
 #include <axiom_xml_writer.h>
 #include <axiom_doctype.h>
+#include <axiom_output.h>
+#include <axutil_array_list.h>
 #include "axiom_node_internal.h"
 #include "axiom_stax_builder_internal.h"
 
@@ -1207,3 +1209,399 @@ axiom_stax_builder_next_with_token(
     }
     return token;
 }
+
+/* Returns prefix:localname, or a copy of localname when there is no
+   prefix */
+static axis2_char_t *
+axiom_stax_builder_forward_qname(
+    const axutil_env_t * env,
+    const axis2_char_t * prefix,
+    const axis2_char_t * localname)
+{
+    if (prefix && *prefix)
+    {
+        return axutil_strcat(env, prefix, ":", localname, NULL);
+    }
+    return axutil_strdup(env, localname);
+}
+
+/* Declares the namespaces in scope of scope_node on the element being
+   written, except the prefixes in declared, which the element declares
+   itself. The closest declaration of a prefix is the one in scope. */
+static axis2_status_t
+axiom_stax_builder_forward_namespaces(
+    const axutil_env_t * env,
+    axiom_node_t * scope_node,
+    axutil_hash_t * declared,
+    axiom_output_t * om_output)
+{
+    axiom_node_t *node = NULL;
+    axis2_status_t status = AXIS2_SUCCESS;
+
+    for (node = scope_node; node && AXIS2_SUCCESS == status;
+         node = axiom_node_get_parent(node, env))
+    {
+        axiom_element_t *om_ele = NULL;
+        axutil_hash_t *namespaces = NULL;
+        axutil_hash_index_t *hi = NULL;
+
+        if (axiom_node_get_node_type(node, env) != AXIOM_ELEMENT)
+        {
+            continue;
+        }
+        om_ele = (axiom_element_t *) axiom_node_get_data_element(node, env);
+        namespaces = om_ele ? axiom_element_get_namespaces(om_ele, env) : NULL;
+        for (hi = namespaces ? axutil_hash_first(namespaces, env) : NULL;
+             hi && AXIS2_SUCCESS == status; hi = axutil_hash_next(env, hi))
+        {
+            void *val = NULL;
+            axis2_char_t *ns_prefix = NULL;
+
+            axutil_hash_this(hi, NULL, NULL, &val);
+            ns_prefix = axiom_namespace_get_prefix((axiom_namespace_t *) val,
+                                                   env);
+            if (!ns_prefix)
+            {
+                ns_prefix = "";
+            }
+            if (axutil_hash_get(declared, ns_prefix, AXIS2_HASH_KEY_STRING))
+            {
+                continue;
+            }
+            axutil_hash_set(declared, ns_prefix, AXIS2_HASH_KEY_STRING,
+                            ns_prefix);
+            status = axiom_output_write(om_output, env, AXIOM_NAMESPACE, 2,
+                                        *ns_prefix ? ns_prefix : NULL,
+                                        axiom_namespace_get_uri((axiom_namespace_t
+                                                                 *) val, env));
+        }
+    }
+    return status;
+}
+
+/* Copies the start tag the parser is at to the output. The outermost
+   elements copied get the namespaces in scope of scope_node declared */
+static axis2_status_t
+axiom_stax_builder_forward_start_element(
+    axiom_stax_builder_t * om_builder,
+    const axutil_env_t * env,
+    axiom_node_t * scope_node,
+    axis2_bool_t is_outermost,
+    axis2_bool_t is_empty,
+    axiom_output_t * om_output)
+{
+    axiom_xml_reader_t *parser = om_builder->parser;
+    axis2_char_t *localname = NULL;
+    axis2_char_t *prefix = NULL;
+    axis2_char_t *qname = NULL;
+    axutil_hash_t *declared = NULL;
+    axutil_array_list_t *reader_strings = NULL;
+    int count = 0;
+    int i = 0;
+    axis2_status_t status = AXIS2_SUCCESS;
+
+    localname = axiom_xml_reader_get_name(parser, env);
+    if (!localname)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_XML_READER_ELEMENT_NULL,
+                        AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+    prefix = axiom_xml_reader_get_prefix(parser, env);
+    qname = axiom_stax_builder_forward_qname(env, prefix, localname);
+    axiom_xml_reader_xml_free(parser, env, localname);
+    if (prefix)
+    {
+        axiom_xml_reader_xml_free(parser, env, prefix);
+    }
+    if (!qname)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+    if (is_empty)
+    {
+        status = axiom_output_write(om_output, env, AXIOM_ELEMENT, 4, qname,
+                                    NULL, NULL, NULL);
+    }
+    else
+    {
+        status = axiom_output_write(om_output, env, AXIOM_ELEMENT, 1, qname);
+    }
+    AXIS2_FREE(env->allocator, qname);
+
+    if (is_outermost)
+    {
+        declared = axutil_hash_make(env);
+        reader_strings = axutil_array_list_create(env, 0);
+        if (!declared || !reader_strings)
+        {
+            status = AXIS2_FAILURE;
+        }
+    }
+
+    count = axiom_xml_reader_get_namespace_count(parser, env);
+    for (i = 1; i <= count && AXIS2_SUCCESS == status; i++)
+    {
+        axis2_char_t *ns_prefix =
+            axiom_xml_reader_get_namespace_prefix_by_number(parser, env, i);
+        axis2_char_t *ns_uri =
+            axiom_xml_reader_get_namespace_uri_by_number(parser, env, i);
+        axis2_char_t *key = ns_prefix;
+
+        if (!ns_prefix || !axutil_strcmp(ns_prefix, "xmlns"))
+        {
+            /* default namespace, NULL from guththila */
+            key = "";
+        }
+        status = axiom_output_write(om_output, env, AXIOM_NAMESPACE, 2,
+                                    *key ? key : NULL, ns_uri ? ns_uri : "");
+        if (declared)
+        {
+            axutil_hash_set(declared, key, AXIS2_HASH_KEY_STRING, key);
+            axutil_array_list_add(reader_strings, env, ns_prefix);
+            axutil_array_list_add(reader_strings, env, ns_uri);
+        }
+        else
+        {
+            axiom_xml_reader_xml_free(parser, env, ns_prefix);
+            axiom_xml_reader_xml_free(parser, env, ns_uri);
+        }
+    }
+
+    if (declared && AXIS2_SUCCESS == status)
+    {
+        status = axiom_stax_builder_forward_namespaces(env, scope_node,
+                                                       declared, om_output);
+    }
+    if (declared)
+    {
+        axutil_hash_free(declared, env);
+    }
+    if (reader_strings)
+    {
+        for (i = 0; i < axutil_array_list_size(reader_strings, env); i++)
+        {
+            void *str = axutil_array_list_get(reader_strings, env, i);
+            if (str)
+            {
+                axiom_xml_reader_xml_free(parser, env, str);
+            }
+        }
+        axutil_array_list_free(reader_strings, env);
+    }
+
+    count = axiom_xml_reader_get_attribute_count(parser, env);
+    for (i = 1; i <= count && AXIS2_SUCCESS == status; i++)
+    {
+        axis2_char_t *attr_prefix =
+            axiom_xml_reader_get_attribute_prefix_by_number(parser, env, i);
+        axis2_char_t *attr_name =
+            axiom_xml_reader_get_attribute_name_by_number(parser, env, i);
+        axis2_char_t *attr_value =
+            axiom_xml_reader_get_attribute_value_by_number(parser, env, i);
+
+        if (attr_name)
+        {
+            qname = axiom_stax_builder_forward_qname(env, attr_prefix,
+                                                     attr_name);
+            status = qname ? axiom_output_write(om_output, env,
+                                                AXIOM_ATTRIBUTE, 2, qname,
+                                                attr_value) : AXIS2_FAILURE;
+            AXIS2_FREE(env->allocator, qname);
+        }
+        if (attr_prefix)
+        {
+            axiom_xml_reader_xml_free(parser, env, attr_prefix);
+        }
+        if (attr_name)
+        {
+            axiom_xml_reader_xml_free(parser, env, attr_name);
+        }
+        if (attr_value)
+        {
+            axiom_xml_reader_xml_free(parser, env, attr_value);
+        }
+    }
+    return status;
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axiom_stax_builder_forward_element_content(
+    axiom_stax_builder_t * om_builder,
+    const axutil_env_t * env,
+    axiom_node_t * element_node,
+    axiom_output_t * om_output)
+{
+    axiom_node_t *current = NULL;
+    axiom_node_t *child = NULL;
+    int depth = 0;
+    axis2_status_t status = AXIS2_SUCCESS;
+
+    AXIS2_PARAM_CHECK(env->error, om_builder, AXIS2_FAILURE);
+    AXIS2_PARAM_CHECK(env->error, element_node, AXIS2_FAILURE);
+    AXIS2_PARAM_CHECK(env->error, om_output, AXIS2_FAILURE);
+
+    /* Serialize what is built. Only the last child of an element can be
+       incomplete; its start tag is written and its children follow, down to
+       the element the parser is in. Nothing here pulls from the parser. */
+    current = element_node;
+    while (current && AXIS2_SUCCESS == status)
+    {
+        axiom_node_t *last = axiom_node_get_last_child(current, env);
+        axiom_node_t *open = NULL;
+
+        if (last && !axiom_node_is_complete(last, env))
+        {
+            open = last;
+        }
+        child = last;
+        while (child && axiom_node_get_previous_sibling(child, env))
+        {
+            child = axiom_node_get_previous_sibling(child, env);
+        }
+        while (child && child != open && AXIS2_SUCCESS == status)
+        {
+            status = axiom_node_serialize(child, env, om_output);
+            child = child == last ? NULL :
+                axiom_node_get_next_sibling(child, env);
+        }
+        if (!open || AXIS2_SUCCESS != status)
+        {
+            break;
+        }
+        status = axiom_element_serialize_start_part((axiom_element_t *)
+                                                    axiom_node_get_data_element
+                                                    (open, env), env,
+                                                    om_output, open);
+        if (AXIS2_SUCCESS == status && current == element_node)
+        {
+            /* The outermost element written declares what is in scope */
+            axutil_hash_t *declared = axutil_hash_make(env);
+            axutil_hash_t *namespaces =
+                axiom_element_get_namespaces((axiom_element_t *)
+                                             axiom_node_get_data_element
+                                             (open, env), env);
+            axutil_hash_index_t *hi = NULL;
+
+            for (hi = namespaces ? axutil_hash_first(namespaces, env) : NULL;
+                 hi && declared; hi = axutil_hash_next(env, hi))
+            {
+                void *val = NULL;
+                axis2_char_t *ns_prefix = NULL;
+
+                axutil_hash_this(hi, NULL, NULL, &val);
+                ns_prefix = axiom_namespace_get_prefix((axiom_namespace_t *)
+                                                       val, env);
+                ns_prefix = ns_prefix ? ns_prefix : "";
+                axutil_hash_set(declared, ns_prefix, AXIS2_HASH_KEY_STRING,
+                                ns_prefix);
+            }
+            status = declared ?
+                axiom_stax_builder_forward_namespaces(env, element_node,
+                                                      declared, om_output) :
+                AXIS2_FAILURE;
+            if (declared)
+            {
+                axutil_hash_free(declared, env);
+            }
+        }
+        current = open;
+    }
+
+    /* Copy the rest from the parser, closing the elements opened above as
+       their end tags come */
+    while (AXIS2_SUCCESS == status &&
+           !axiom_node_is_complete(element_node, env))
+    {
+        int token = axiom_xml_reader_next(om_builder->parser, env);
+        axis2_char_t *value = NULL;
+
+        if (token == -1)
+        {
+            om_builder->done = AXIS2_TRUE;
+            status = AXIS2_FAILURE;
+            break;
+        }
+        om_builder->current_event = token;
+
+        switch (token)
+        {
+        case AXIOM_XML_READER_START_ELEMENT:
+            status = axiom_stax_builder_forward_start_element(om_builder, env,
+                                                              current,
+                                                              depth == 0 &&
+                                                              current ==
+                                                              element_node,
+                                                              AXIS2_FALSE,
+                                                              om_output);
+            depth++;
+            break;
+
+        case AXIOM_XML_READER_EMPTY_ELEMENT:
+            status = axiom_stax_builder_forward_start_element(om_builder, env,
+                                                              current,
+                                                              depth == 0 &&
+                                                              current ==
+                                                              element_node,
+                                                              AXIS2_TRUE,
+                                                              om_output);
+            break;
+
+        case AXIOM_XML_READER_END_ELEMENT:
+            if (depth > 0)
+            {
+                depth--;
+                status = axiom_output_write(om_output, env, AXIOM_ELEMENT, 0);
+            }
+            else
+            {
+                if (current != element_node)
+                {
+                    status = axiom_element_serialize_end_part((axiom_element_t
+                                                               *)
+                                                              axiom_node_get_data_element
+                                                              (current, env),
+                                                              env, om_output);
+                }
+                axiom_stax_builder_end_element(om_builder, env);
+                current = axiom_node_get_parent(current, env);
+            }
+            break;
+
+        case AXIOM_XML_READER_SPACE:
+        case AXIOM_XML_READER_CHARACTER:
+            value = axiom_xml_reader_get_value(om_builder->parser, env);
+            if (value)
+            {
+                status = axiom_output_write(om_output, env, AXIOM_TEXT, 1,
+                                            value);
+                axiom_xml_reader_xml_free(om_builder->parser, env, value);
+            }
+            break;
+
+        case AXIOM_XML_READER_COMMENT:
+            value = axiom_xml_reader_get_value(om_builder->parser, env);
+            if (value)
+            {
+                status = axiom_output_write(om_output, env, AXIOM_COMMENT, 1,
+                                            value);
+                axiom_xml_reader_xml_free(om_builder->parser, env, value);
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    if (AXIS2_SUCCESS == status)
+    {
+        /* What was written is not in the tree; keep none of it */
+        while ((child = axiom_node_get_first_child(element_node, env)))
+        {
+            axiom_node_free_tree(child, env);
+        }
+    }
+    return status;
+}
@@ -566,6 +566,33 @@ axiom_text_get_data_handler(
     return om_text->data_handler;
 }
 
+AXIS2_EXTERN axiom_data_handler_t *AXIS2_CALL
+axiom_text_create_data_handler_from_base64(
+    axiom_text_t * om_text,
+    const axutil_env_t * env,
+    const axis2_char_t * mime_type)
+{
+    axiom_data_handler_t *data_handler = NULL;
+
+    if (!om_text->value)
+    {
+        return NULL;
+    }
+    data_handler = axiom_data_handler_create(env, NULL, mime_type);
+    if (!data_handler)
+    {
+        return NULL;
+    }
+    if (AXIS2_SUCCESS != axiom_data_handler_append_base64(data_handler, env,
+            axutil_string_get_buffer(om_text->value, env),
+            axutil_string_get_length(om_text->value, env), AXIS2_TRUE))
+    {
+        axiom_data_handler_free(data_handler, env);
+        return NULL;
+    }
+    return data_handler;
+}
+
 AXIS2_EXTERN axiom_text_t *AXIS2_CALL
 axiom_text_create_str(
     const axutil_env_t * env,
@@ -217,6 +217,8 @@ typedef struct guththila_xml_writer_wrapper_impl
 {
     axiom_xml_writer_t writer;
     guththila_xml_writer_t *wr;
+    /* File the output of a file writer is flushed to */
+    FILE *out_file;
 }
 guththila_xml_writer_wrapper_impl_t;
 
@@ -263,6 +265,19 @@ static const axiom_xml_writer_ops_t axiom_xml_writer_ops_var = {
 
 /******************************* End macro ***************************************/
 
+static int GUTHTHILA_CALL
+guththila_xml_writer_wrapper_write_file(
+    const guththila_char_t * data,
+    size_t len,
+    void *ctx)
+{
+    if (fwrite(data, 1, len, (FILE *) ctx) != len)
+    {
+        return GUTHTHILA_FAILURE;
+    }
+    return GUTHTHILA_SUCCESS;
+}
+
 AXIS2_EXTERN axiom_xml_writer_t *AXIS2_CALL
 axiom_xml_writer_create(
     const axutil_env_t * env,
@@ -274,11 +289,43 @@ axiom_xml_writer_create(
     guththila_xml_writer_wrapper_impl_t *writer_impl;
 
     AXIS2_ENV_CHECK(env, NULL);
+    AXIS2_PARAM_CHECK(env->error, filename, NULL);
 
     writer_impl =
         (guththila_xml_writer_wrapper_impl_t *) AXIS2_MALLOC(env->allocator,
                                                              sizeof
                                                              (guththila_xml_writer_wrapper_impl_t));
+    if (!writer_impl)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+
+    writer_impl->out_file = fopen(filename, "wb");
+    if (!writer_impl->out_file)
+    {
+        AXIS2_FREE(env->allocator, writer_impl);
+        AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_CREATING_XML_STREAM_WRITER,
+                           AXIS2_FAILURE);
+        return NULL;
+    }
+
+    /* The file writer of guththila finds the names of open elements in the
+     * output, so a memory writer is used that hands each filled chunk to
+     * the file and keeps only the chunk being written */
+    writer_impl->wr = guththila_create_xml_stream_writer_for_memory(env);
+    if (!(writer_impl->wr))
+    {
+        fclose(writer_impl->out_file);
+        AXIS2_FREE(env->allocator, writer_impl);
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+    guththila_xml_writer_set_flush(writer_impl->wr,
+                                   guththila_xml_writer_wrapper_write_file,
+                                   writer_impl->out_file, env);
+
+    writer_impl->writer.ops = &axiom_xml_writer_ops_var;
     return &(writer_impl->writer);
 }
 
@@ -317,6 +364,7 @@ axiom_xml_writer_create_for_memory(
         AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
         return NULL;
     }
+    writer_impl->out_file = NULL;
 
     writer_impl->writer.ops = NULL;
     /* ops */
@@ -331,6 +379,12 @@ guththila_xml_writer_wrapper_free(
     const axutil_env_t * env)
 {
     AXIS2_ENV_CHECK(env, AXIS2_FAILURE);
+    if (AXIS2_INTF_TO_IMPL(writer)->out_file)
+    {
+        /* Whatever is left of the document goes to the file */
+        guththila_xml_writer_flush(AXIS2_INTF_TO_IMPL(writer)->wr, env);
+        fclose(AXIS2_INTF_TO_IMPL(writer)->out_file);
+    }
     if (AXIS2_INTF_TO_IMPL(writer)->wr)
     {
         guththila_xml_writer_free(AXIS2_INTF_TO_IMPL(writer)->wr, env);
@@ -743,6 +797,11 @@ guththila_xml_writer_wrapper_get_xml(
 {
     char *buffer = NULL;
     AXIS2_ENV_CHECK(env, AXIS2_FAILURE);
+    if (AXIS2_INTF_TO_IMPL(writer)->out_file)
+    {
+        /* The output is in the file */
+        return NULL;
+    }
     buffer = guththila_get_memory_buffer(AXIS2_INTF_TO_IMPL(writer)->wr, env);
     return (void *) buffer;
 }
@@ -788,6 +847,14 @@ guththila_xml_writer_wrapper_flush(
     axiom_xml_writer_t * writer,
     const axutil_env_t * env)
 {
+    if (AXIS2_INTF_TO_IMPL(writer)->out_file)
+    {
+        if (!guththila_xml_writer_flush(AXIS2_INTF_TO_IMPL(writer)->wr, env) ||
+            fflush(AXIS2_INTF_TO_IMPL(writer)->out_file) != 0)
+        {
+            return AXIS2_FAILURE;
+        }
+    }
     return AXIS2_SUCCESS;
 }
 
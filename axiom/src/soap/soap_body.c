@@ -28,6 +28,11 @@
 #include "_axiom_soap_fault_value.h"
 #include "_axiom_soap_fault_text.h"
 #include <axiom_util.h>
+#include <axiom_stax_builder.h>
+#include <axiom_node_internal.h>
+#include <axiom_data_source.h>
+#include <axiom_xml_writer.h>
+#include <axutil_free_list.h>
 
 struct axiom_soap_body
 {
@@ -48,8 +53,8 @@ axiom_soap_body_create(
 {
     axiom_soap_body_t *soap_body = NULL;
 
-    soap_body = (axiom_soap_body_t *) AXIS2_MALLOC(env->allocator,
-                                                   sizeof(axiom_soap_body_t));
+    soap_body = (axiom_soap_body_t *)
+        axutil_free_list_malloc(env->allocator, sizeof(axiom_soap_body_t));
 
     if (!soap_body)
     {
@@ -60,6 +65,7 @@ axiom_soap_body_create(
     soap_body->soap_builder = NULL;
     soap_body->has_fault = AXIS2_FALSE;
     soap_body->soap_fault = NULL;
+    soap_body->soap_version = AXIOM_SOAP12;
 
     return soap_body;
 }
@@ -126,11 +132,34 @@ axiom_soap_body_free(
         axiom_soap_fault_free(soap_body->soap_fault, env);
         soap_body->soap_fault = NULL;
     }
-    AXIS2_FREE(env->allocator, soap_body);
+    axutil_free_list_free(env->allocator, soap_body,
+                          sizeof(axiom_soap_body_t));
     soap_body = NULL;
     return;
 }
 
+/* A fault is the first child element of the body, so looking for one needs
+   the body built no further than the start of its first child element. Only
+   what is built is looked at here. */
+static axis2_bool_t
+axiom_soap_body_has_child_element(
+    axiom_soap_body_t * soap_body,
+    const axutil_env_t * env)
+{
+    axiom_node_t *child = NULL;
+
+    child = axiom_node_get_last_child(soap_body->om_ele_node, env);
+    while (child)
+    {
+        if (axiom_node_get_node_type(child, env) == AXIOM_ELEMENT)
+        {
+            return AXIS2_TRUE;
+        }
+        child = axiom_node_get_previous_sibling(child, env);
+    }
+    return AXIS2_FALSE;
+}
+
 AXIS2_EXTERN axis2_bool_t AXIS2_CALL
 axiom_soap_body_has_fault(
     axiom_soap_body_t * soap_body,
@@ -148,7 +177,8 @@ axiom_soap_body_has_fault(
         if (soap_body->soap_builder)
         {
             while (!(soap_body->soap_fault) &&
-                   !(axiom_node_is_complete(soap_body->om_ele_node, env)))
+                   !(axiom_node_is_complete(soap_body->om_ele_node, env)) &&
+                   !axiom_soap_body_has_child_element(soap_body, env))
             {
                 status = axiom_soap_builder_next(soap_body->soap_builder, env);
                 if (status == AXIS2_FAILURE)
@@ -186,7 +216,8 @@ axiom_soap_body_get_fault(
     else if (soap_body->soap_builder)
     {
         while (!(soap_body->soap_fault) &&
-               !(axiom_node_is_complete(soap_body->om_ele_node, env)))
+               !(axiom_node_is_complete(soap_body->om_ele_node, env)) &&
+               !axiom_soap_body_has_child_element(soap_body, env))
         {
             int status = AXIS2_SUCCESS;
             status = axiom_soap_builder_next(soap_body->soap_builder, env);
@@ -570,3 +601,112 @@ axiom_soap_body_process_attachments(
         return axiom_soap_body_build(soap_body, env);                        
     }
 }
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axiom_soap_body_forward_content(
+    axiom_soap_body_t * soap_body,
+    const axutil_env_t * env,
+    axiom_output_t * om_output)
+{
+    axiom_node_t *child = NULL;
+    axis2_status_t status = AXIS2_SUCCESS;
+
+    AXIS2_PARAM_CHECK(env->error, om_output, AXIS2_FAILURE);
+    if (!soap_body->om_ele_node)
+    {
+        return AXIS2_FAILURE;
+    }
+
+    if (soap_body->soap_builder && !soap_body->soap_fault &&
+        !axiom_node_is_complete(soap_body->om_ele_node, env))
+    {
+        return axiom_stax_builder_forward_element_content(
+            axiom_node_get_builder(soap_body->om_ele_node, env), env,
+            soap_body->om_ele_node, om_output);
+    }
+
+    /* A fault, or a body that is built already, is written from the tree
+       and kept */
+    if (soap_body->soap_builder)
+    {
+        while (!axiom_node_is_complete(soap_body->om_ele_node, env))
+        {
+            status = axiom_soap_builder_next(soap_body->soap_builder, env);
+            if (status == AXIS2_FAILURE)
+            {
+                return AXIS2_FAILURE;
+            }
+        }
+    }
+    child = axiom_node_get_first_child(soap_body->om_ele_node, env);
+    while (child && AXIS2_SUCCESS == status)
+    {
+        status = axiom_node_serialize(child, env, om_output);
+        child = axiom_node_get_next_sibling(child, env);
+    }
+    return status;
+}
+
+AXIS2_EXTERN axiom_node_t *AXIS2_CALL
+axiom_soap_body_capture_content(
+    axiom_soap_body_t * soap_body,
+    const axutil_env_t * env)
+{
+    axiom_xml_writer_t *xml_writer = NULL;
+    axiom_output_t *om_output = NULL;
+    axiom_node_t *child = NULL;
+    axiom_node_t *data_node = NULL;
+    axiom_data_source_t *data_source = NULL;
+    axis2_char_t *buffer = NULL;
+    axis2_status_t status = AXIS2_FAILURE;
+
+    if (!soap_body->om_ele_node ||
+        axiom_soap_body_has_fault(soap_body, env))
+    {
+        return NULL;
+    }
+
+    xml_writer = axiom_xml_writer_create_for_memory(env, NULL, AXIS2_FALSE,
+                                                    AXIS2_FALSE,
+                                                    AXIS2_XML_PARSER_TYPE_BUFFER);
+    if (!xml_writer)
+    {
+        return NULL;
+    }
+    om_output = axiom_output_create(env, xml_writer);
+    if (!om_output)
+    {
+        axiom_xml_writer_free(xml_writer, env);
+        return NULL;
+    }
+    status = axiom_soap_body_forward_content(soap_body, env, om_output);
+    if (AXIS2_SUCCESS == status)
+    {
+        axiom_xml_writer_flush(xml_writer, env);
+        buffer = (axis2_char_t *) axiom_xml_writer_get_xml(xml_writer, env);
+
+        /* A body that was built is written from the tree and kept */
+        while ((child = axiom_node_get_first_child(soap_body->om_ele_node,
+                                                   env)))
+        {
+            axiom_node_free_tree(axiom_node_detach(child, env), env);
+        }
+        data_source = axiom_data_source_create(env, soap_body->om_ele_node,
+                                               &data_node);
+    }
+    if (data_source)
+    {
+        int size = axiom_xml_writer_get_xml_size(xml_writer, env);
+
+        axiom_node_set_complete(data_node, env, AXIS2_TRUE);
+        if (buffer && size > 0 &&
+            axutil_stream_write(axiom_data_source_get_stream(data_source, env),
+                                env, buffer, size) < 0)
+        {
+            axiom_node_free_tree(axiom_node_detach(data_node, env), env);
+            data_node = NULL;
+        }
+    }
+    axiom_output_free(om_output, env);
+    return data_node;
+}
@@ -996,6 +996,16 @@ axiom_soap_builder_parse_headers(
              */
         }
     }
+
+    /* Stop at the start tag of the body; its content is built when asked
+       for, or forwarded without being built */
+    while (!soap_builder->body_present &&
+           !axiom_stax_builder_is_complete(soap_builder->om_builder, env))
+    {
+        status = axiom_soap_builder_next(soap_builder, env);
+        if (status == AXIS2_FAILURE)
+            return AXIS2_FAILURE;
+    }
     return AXIS2_SUCCESS;
 }
 
@@ -30,6 +30,7 @@
 #include <axiom_soap_fault_value.h>
 #include <axiom_soap_fault_text.h>
 #include <axiom_namespace_internal.h>
+#include <axutil_free_list.h>
 
 struct axiom_soap_envelope
 {
@@ -56,9 +57,8 @@ axiom_soap_envelope_create_null(
 {
     axiom_soap_envelope_t *soap_envelope = NULL;
     
-    soap_envelope = (axiom_soap_envelope_t *) AXIS2_MALLOC(env->allocator,
-                                                           sizeof
-                                                           (axiom_soap_envelope_t));
+    soap_envelope = (axiom_soap_envelope_t *)
+        axutil_free_list_malloc(env->allocator, sizeof(axiom_soap_envelope_t));
     if (!soap_envelope)
     {
         AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
@@ -184,7 +184,8 @@ axiom_soap_envelope_free(
         }
     }
 
-    AXIS2_FREE(env->allocator, soap_envelope);
+    axutil_free_list_free(env->allocator, soap_envelope,
+                          sizeof(axiom_soap_envelope_t));
     return;
 }
 
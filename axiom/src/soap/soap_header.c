@@ -26,6 +26,7 @@
 #include <stdio.h>
 #include <axiom_node_internal.h>
 #include <axutil_array_list.h>
+#include <axutil_free_list.h>
 
 struct axiom_soap_header
 {
@@ -55,9 +56,8 @@ axiom_soap_header_create(
 {
     axiom_soap_header_t *soap_header = NULL;
 
-    soap_header = (axiom_soap_header_t *) AXIS2_MALLOC(env->allocator,
-                                                       sizeof
-                                                       (axiom_soap_header_t));
+    soap_header = (axiom_soap_header_t *)
+        axutil_free_list_malloc(env->allocator, sizeof(axiom_soap_header_t));
     if (!soap_header)
     {
         AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
@@ -70,6 +70,7 @@ axiom_soap_header_create(
     soap_header->soap_envelope = NULL;
     soap_header->hbnumber = 0;
     soap_header->header_blocks = NULL;
+    soap_header->soap_builder = NULL;
 
     /** default value */
     soap_header->soap_version = AXIOM_SOAP12;
@@ -199,7 +200,8 @@ axiom_soap_header_free(
         axutil_array_list_free(soap_header->header_block_keys, env);
         soap_header->header_block_keys = NULL;
     }
-    AXIS2_FREE(env->allocator, soap_header);
+    axutil_free_list_free(env->allocator, soap_header,
+                          sizeof(axiom_soap_header_t));
 
     soap_header = NULL;
 
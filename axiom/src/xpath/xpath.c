@@ -105,12 +105,24 @@ AXIS2_EXTERN axiom_xpath_result_t * AXIS2_CALL axiom_xpath_evaluate_streaming(
         res = AXIS2_MALLOC(
                     context->env->allocator, sizeof(axiom_xpath_result_t));
         res->nodes = NULL;
+        res->streamed_root = NULL;
         res->flag = AXIOM_XPATH_ERROR_STREAMING_NOT_SUPPORTED;
 
         return res;
     }
 }
 
+AXIS2_EXTERN axiom_xpath_result_t * AXIS2_CALL axiom_xpath_evaluate_reader(
+    axiom_xpath_context_t *context,
+    axiom_xpath_expression_t *xpath_expr,
+    axiom_xml_reader_t *reader)
+{
+    AXIS2_PARAM_CHECK(context->env->error, xpath_expr, NULL);
+    AXIS2_PARAM_CHECK(context->env->error, reader, NULL);
+
+    return axiom_xpath_streaming_evaluate_reader(context, xpath_expr, reader);
+}
+
 AXIS2_EXTERN void AXIS2_CALL axiom_xpath_register_default_functions_set(
     axiom_xpath_context_t *context)
 {
@@ -390,8 +402,23 @@ AXIS2_EXTERN void AXIS2_CALL axiom_xpath_free_result(
     const axutil_env_t *env,
     axiom_xpath_result_t* result)
 {
+    int i;
+
     if (result)
     {
+        if (result->streamed_root)
+        {
+            /* Results of a reader evaluation own their nodes */
+            for (i = 0; result->nodes
+                    && i < axutil_array_list_size(result->nodes, env); i++)
+            {
+                AXIS2_FREE(env->allocator,
+                        axutil_array_list_get(result->nodes, env, i));
+            }
+
+            axiom_node_free_tree(result->streamed_root, env);
+        }
+
         if (result->nodes)
         {
             axutil_array_list_free(result->nodes, env);
@@ -0,0 +1,184 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <axiom_xpath.h>
+#include <axutil_thread.h>
+
+/* Evaluation keeps per-run state (the predicate position) in the operations
+   of a compiled expression, so an instance cannot be evaluated by two threads
+   at once. The cache therefore keeps a pool of idle instances per expression
+   string; an instance is checked out by axiom_xpath_cache_get and put back by
+   axiom_xpath_cache_release. Namespace prefixes are resolved through the
+   context at evaluation time, so the compiled form does not depend on the
+   namespaces registered by the caller and the string alone is the key. */
+struct axiom_xpath_cache
+{
+    /** Expression string -> array list of idle compiled expressions */
+    axutil_hash_t *idle;
+
+    /** Guards idle */
+    axutil_thread_mutex_t *mutex;
+};
+
+AXIS2_EXTERN axiom_xpath_cache_t * AXIS2_CALL axiom_xpath_cache_create(
+    const axutil_env_t *env)
+{
+    axiom_xpath_cache_t *cache;
+
+    cache = AXIS2_MALLOC(env->allocator, sizeof(axiom_xpath_cache_t));
+    if (!cache)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+
+    cache->idle = axutil_hash_make(env);
+    cache->mutex = axutil_thread_mutex_create(env->allocator,
+            AXIS2_THREAD_MUTEX_DEFAULT);
+
+    if (!cache->idle || !cache->mutex)
+    {
+        axiom_xpath_cache_free(cache, env);
+        return NULL;
+    }
+
+    return cache;
+}
+
+AXIS2_EXTERN axiom_xpath_expression_t * AXIS2_CALL axiom_xpath_cache_get(
+    axiom_xpath_cache_t *cache,
+    const axutil_env_t *env,
+    const axis2_char_t *xpath_expr)
+{
+    axutil_array_list_t *pool;
+    axiom_xpath_expression_t *expr = NULL;
+    int size;
+
+    AXIS2_PARAM_CHECK(env->error, cache, NULL);
+    AXIS2_PARAM_CHECK(env->error, xpath_expr, NULL);
+
+    axutil_thread_mutex_lock(cache->mutex);
+
+    pool = axutil_hash_get(cache->idle, xpath_expr, AXIS2_HASH_KEY_STRING);
+    if (pool)
+    {
+        size = axutil_array_list_size(pool, env);
+        if (size > 0)
+        {
+            expr = axutil_array_list_remove(pool, env, size - 1);
+        }
+    }
+
+    axutil_thread_mutex_unlock(cache->mutex);
+
+    if (!expr)
+    {
+        /* Compile outside the lock; the instance joins the pool on release */
+        expr = axiom_xpath_compile_expression(env, xpath_expr);
+    }
+
+    return expr;
+}
+
+AXIS2_EXTERN void AXIS2_CALL axiom_xpath_cache_release(
+    axiom_xpath_cache_t *cache,
+    const axutil_env_t *env,
+    axiom_xpath_expression_t *expr)
+{
+    axutil_array_list_t *pool;
+    axis2_char_t *key;
+
+    if (!cache || !expr)
+    {
+        return;
+    }
+
+    axutil_thread_mutex_lock(cache->mutex);
+
+    pool = axutil_hash_get(cache->idle, expr->expr_str, AXIS2_HASH_KEY_STRING);
+    if (!pool)
+    {
+        pool = axutil_array_list_create(env, 0);
+        key = axutil_strdup(env, expr->expr_str);
+
+        if (!pool || !key)
+        {
+            axutil_thread_mutex_unlock(cache->mutex);
+
+            if (pool)
+            {
+                axutil_array_list_free(pool, env);
+            }
+            if (key)
+            {
+                AXIS2_FREE(env->allocator, key);
+            }
+            axiom_xpath_free_expression(env, expr);
+            return;
+        }
+
+        axutil_hash_set(cache->idle, key, AXIS2_HASH_KEY_STRING, pool);
+    }
+
+    axutil_array_list_add(pool, env, expr);
+
+    axutil_thread_mutex_unlock(cache->mutex);
+}
+
+AXIS2_EXTERN void AXIS2_CALL axiom_xpath_cache_free(
+    axiom_xpath_cache_t *cache,
+    const axutil_env_t *env)
+{
+    axutil_hash_index_t *hi;
+    axutil_array_list_t *pool;
+    const void *key;
+    void *val;
+    int i;
+
+    if (!cache)
+    {
+        return;
+    }
+
+    if (cache->idle)
+    {
+        for (hi = axutil_hash_first(cache->idle, env); hi;
+                hi = axutil_hash_next(env, hi))
+        {
+            axutil_hash_this(hi, &key, NULL, &val);
+            pool = (axutil_array_list_t *)val;
+
+            for (i = 0; i < axutil_array_list_size(pool, env); i++)
+            {
+                axiom_xpath_free_expression(env,
+                        axutil_array_list_get(pool, env, i));
+            }
+
+            axutil_array_list_free(pool, env);
+            AXIS2_FREE(env->allocator, (void *)key);
+        }
+
+        axutil_hash_free(cache->idle, env);
+    }
+
+    if (cache->mutex)
+    {
+        axutil_thread_mutex_destroy(cache->mutex);
+    }
+
+    AXIS2_FREE(env->allocator, cache);
+}
@@ -34,6 +34,8 @@ axiom_xpath_result_t * axiom_xpath_run(axiom_xpath_context_t *context)
 
     res->nodes = axutil_array_list_create(context->env, 0);
 
+    res->streamed_root = NULL;
+
     context->stack = axutil_stack_create(context->env);
 
     /* Expression is empty */
@@ -204,7 +206,10 @@ int axiom_xpath_number_operator(
     /* This is not required; it gives some problems */
     /* context->node = NULL;*/
 
-    node->value = op->par1;
+    /* Casting frees the value, and the compiled one must survive for the
+       next evaluation of the expression */
+    node->value = AXIS2_MALLOC(context->env->allocator, sizeof(double));
+    *(double *)node->value = *(double *)op->par1;
     node->type = AXIOM_XPATH_TYPE_NUMBER;
 
     axutil_stack_push(context->stack, context->env, node);
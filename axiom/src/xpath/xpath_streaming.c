@@ -17,6 +17,9 @@
  */
 
 #include <axiom_xpath.h>
+#include <string.h>
+#include <stdlib.h>
+#include <axiom_node_internal.h>
 #include "xpath_streaming.h"
 #include "xpath_internals.h"
 #include "xpath_internals_engine.h"
@@ -223,3 +226,1304 @@ axiom_xpath_streaming_t axiom_xpath_streaming_combine_independent(
     }
 }
 
+
+/* Evaluation over axiom_xml_reader events
+ *
+ * The location paths of the expression are flattened into an array of
+ * steps. For every open element the evaluator keeps the set of steps its
+ * children are to be tested against; a descendant-or-self::node() step stays
+ * active all the way down. Predicates are decided at the start tag, so they
+ * may only look at the attributes of the element and at its position. */
+
+#define AXIOM_XPATH_READER_ACTIVE(st, d) ((st)->active + (d) * (st)->n_steps)
+
+#define AXIOM_XPATH_READER_COUNTS(st, d) ((st)->counts + (d) * (st)->n_steps)
+
+typedef struct axiom_xpath_reader_step
+{
+    axiom_xpath_axis_t axis;
+    axiom_xpath_node_test_t *node_test;
+    int predicate;
+    axis2_bool_t last;
+} axiom_xpath_reader_step_t;
+
+typedef struct axiom_xpath_reader_ns
+{
+    axis2_char_t *prefix;
+    axis2_char_t *uri;
+} axiom_xpath_reader_ns_t;
+
+typedef struct axiom_xpath_reader_attr
+{
+    axis2_char_t *prefix;
+    axis2_char_t *name;
+    axis2_char_t *value;
+    const axis2_char_t *uri;
+    axiom_attribute_t *om;
+    axis2_bool_t collected;
+} axiom_xpath_reader_attr_t;
+
+typedef struct axiom_xpath_reader_frame
+{
+    /* Node being built for the element, NULL if it is not materialized */
+    axiom_node_t *node;
+    /* Size of the namespace scope before the element's declarations */
+    int n_ns;
+} axiom_xpath_reader_frame_t;
+
+typedef enum axiom_xpath_reader_value_type_t
+{
+    AXIOM_XPATH_READER_NONE = 0,
+    AXIOM_XPATH_READER_ATTRIBUTE,
+    AXIOM_XPATH_READER_STRING,
+    AXIOM_XPATH_READER_NUMBER,
+    AXIOM_XPATH_READER_BOOLEAN
+} axiom_xpath_reader_value_type_t;
+
+typedef struct axiom_xpath_reader_value
+{
+    axiom_xpath_reader_value_type_t type;
+    const axis2_char_t *str;
+    double num;
+} axiom_xpath_reader_value_t;
+
+typedef struct axiom_xpath_reader_state
+{
+    const axutil_env_t *env;
+    axiom_xpath_context_t *context;
+    axiom_xpath_expression_t *expr;
+    axiom_xml_reader_t *reader;
+    axiom_xpath_result_t *res;
+
+    axiom_xpath_reader_step_t *steps;
+    int n_steps;
+    int max_steps;
+
+    axiom_xpath_reader_frame_t *frames;
+    axis2_char_t *active;
+    int *counts;
+    int depth;
+    int max_depth;
+
+    axiom_xpath_reader_ns_t *ns;
+    int n_ns;
+    int max_ns;
+
+    axiom_xpath_reader_attr_t *attrs;
+    int n_attrs;
+    int max_attrs;
+} axiom_xpath_reader_state_t;
+
+static axis2_bool_t axiom_xpath_reader_grow(
+    const axutil_env_t *env,
+    void **array,
+    int *max,
+    int needed,
+    size_t size)
+{
+    void *grown;
+    int n;
+
+    if (needed <= *max)
+    {
+        return AXIS2_TRUE;
+    }
+
+    n = *max ? *max * 2 : 16;
+    while (n < needed)
+    {
+        n *= 2;
+    }
+
+    if (*array)
+    {
+        grown = AXIS2_REALLOC(env->allocator, *array, n * size);
+    }
+    else
+    {
+        grown = AXIS2_MALLOC(env->allocator, n * size);
+    }
+
+    if (!grown)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FALSE;
+    }
+
+    *array = grown;
+    *max = n;
+
+    return AXIS2_TRUE;
+}
+
+/* Skip PATH_EXPRESSION wrappers around a plain filter expression */
+static axiom_xpath_operation_t * axiom_xpath_reader_unwrap(
+    const axutil_env_t *env,
+    axiom_xpath_expression_t *expr,
+    int op_p)
+{
+    axiom_xpath_operation_t *op;
+
+    if (op_p == AXIOM_XPATH_PARSE_END)
+    {
+        return NULL;
+    }
+
+    op = AXIOM_XPATH_OPR_EXPR_GET(op_p);
+
+    while (op->opr == AXIOM_XPATH_OPERATION_PATH_EXPRESSION
+            && op->op2 == AXIOM_XPATH_PARSE_END
+            && op->op1 != AXIOM_XPATH_PARSE_END)
+    {
+        op = AXIOM_XPATH_OPR_EXPR_GET(op->op1);
+    }
+
+    return op;
+}
+
+/* Returns the node test of a relative path of a single attribute step,
+   such as @id, NULL for anything else */
+static axiom_xpath_node_test_t * axiom_xpath_reader_attribute_test(
+    const axutil_env_t *env,
+    axiom_xpath_expression_t *expr,
+    axiom_xpath_operation_t *op)
+{
+    axiom_xpath_operation_t *step, *test, *next;
+    axiom_xpath_node_test_t *node_test;
+
+    if (!op || op->opr != AXIOM_XPATH_OPERATION_CONTEXT_NODE
+            || op->op1 == AXIOM_XPATH_PARSE_END)
+    {
+        return NULL;
+    }
+
+    step = AXIOM_XPATH_OPR_EXPR_GET(op->op1);
+
+    if (step->opr != AXIOM_XPATH_OPERATION_STEP
+            || step->op1 == AXIOM_XPATH_PARSE_END
+            || step->op2 == AXIOM_XPATH_PARSE_END)
+    {
+        return NULL;
+    }
+
+    test = AXIOM_XPATH_OPR_EXPR_GET(step->op1);
+    next = AXIOM_XPATH_OPR_EXPR_GET(step->op2);
+
+    if (test->opr != AXIOM_XPATH_OPERATION_NODE_TEST || !test->par2
+            || *((axiom_xpath_axis_t *)test->par2) != AXIOM_XPATH_AXIS_ATTRIBUTE
+            || test->op1 != AXIOM_XPATH_PARSE_END
+            || next->opr != AXIOM_XPATH_OPERATION_RESULT)
+    {
+        return NULL;
+    }
+
+    node_test = (axiom_xpath_node_test_t *)test->par1;
+
+    if (node_test->type != AXIOM_XPATH_NODE_TEST_STANDARD
+            && node_test->type != AXIOM_XPATH_NODE_TEST_ALL)
+    {
+        return NULL;
+    }
+
+    return node_test;
+}
+
+static axis2_bool_t axiom_xpath_reader_check_condition(
+    const axutil_env_t *env,
+    axiom_xpath_expression_t *expr,
+    int op_p)
+{
+    axiom_xpath_operation_t *op;
+
+    op = axiom_xpath_reader_unwrap(env, expr, op_p);
+
+    if (!op)
+    {
+        return AXIS2_FALSE;
+    }
+
+    switch (op->opr)
+    {
+        case AXIOM_XPATH_OPERATION_LITERAL:
+        case AXIOM_XPATH_OPERATION_NUMBER:
+            return AXIS2_TRUE;
+
+        case AXIOM_XPATH_OPERATION_CONTEXT_NODE:
+            return axiom_xpath_reader_attribute_test(env, expr, op) != NULL;
+
+        case AXIOM_XPATH_OPERATION_EQUAL_EXPR:
+        case AXIOM_XPATH_OPERATION_AND_EXPR:
+        case AXIOM_XPATH_OPERATION_OR_EXPR:
+            return axiom_xpath_reader_check_condition(env, expr, op->op1)
+                && axiom_xpath_reader_check_condition(env, expr, op->op2);
+
+        default:
+            return AXIS2_FALSE;
+    }
+}
+
+/* A position is only known for the leading predicate; the ones after it
+   would need the size of the filtered sibling set */
+static axis2_bool_t axiom_xpath_reader_check_predicates(
+    const axutil_env_t *env,
+    axiom_xpath_expression_t *expr,
+    int op_p)
+{
+    axiom_xpath_operation_t *op, *cond;
+    axis2_bool_t first = AXIS2_TRUE;
+
+    while (op_p != AXIOM_XPATH_PARSE_END)
+    {
+        op = AXIOM_XPATH_OPR_EXPR_GET(op_p);
+
+        if (op->opr != AXIOM_XPATH_OPERATION_PREDICATE
+                || !axiom_xpath_reader_check_condition(env, expr, op->op1))
+        {
+            return AXIS2_FALSE;
+        }
+
+        cond = axiom_xpath_reader_unwrap(env, expr, op->op1);
+        if (!first && cond->opr == AXIOM_XPATH_OPERATION_NUMBER)
+        {
+            return AXIS2_FALSE;
+        }
+
+        first = AXIS2_FALSE;
+        op_p = op->op2;
+    }
+
+    return AXIS2_TRUE;
+}
+
+/* Appends the steps of a location path */
+static axis2_bool_t axiom_xpath_reader_add_path(
+    axiom_xpath_reader_state_t *st,
+    int op_p)
+{
+    const axutil_env_t *env = st->env;
+    axiom_xpath_expression_t *expr = st->expr;
+    axiom_xpath_operation_t *op, *test;
+    axiom_xpath_reader_step_t *step;
+    int first = st->n_steps;
+    int i;
+
+    while (op_p != AXIOM_XPATH_PARSE_END)
+    {
+        op = AXIOM_XPATH_OPR_EXPR_GET(op_p);
+
+        if (op->opr == AXIOM_XPATH_OPERATION_RESULT)
+        {
+            break;
+        }
+
+        if (op->opr != AXIOM_XPATH_OPERATION_STEP
+                || op->op1 == AXIOM_XPATH_PARSE_END)
+        {
+            return AXIS2_FALSE;
+        }
+
+        test = AXIOM_XPATH_OPR_EXPR_GET(op->op1);
+
+        if (test->opr != AXIOM_XPATH_OPERATION_NODE_TEST || !test->par2)
+        {
+            return AXIS2_FALSE;
+        }
+
+        if (!axiom_xpath_reader_grow(env, (void **)&st->steps, &st->max_steps,
+                    st->n_steps + 1, sizeof(axiom_xpath_reader_step_t)))
+        {
+            return AXIS2_FALSE;
+        }
+
+        step = st->steps + st->n_steps++;
+        step->axis = *((axiom_xpath_axis_t *)test->par2);
+        step->node_test = (axiom_xpath_node_test_t *)test->par1;
+        step->predicate = test->op1;
+        step->last = AXIS2_FALSE;
+
+        op_p = op->op2;
+    }
+
+    if (st->n_steps == first)
+    {
+        return AXIS2_FALSE;
+    }
+
+    st->steps[st->n_steps - 1].last = AXIS2_TRUE;
+
+    for (i = first; i < st->n_steps; i++)
+    {
+        step = st->steps + i;
+
+        switch (step->axis)
+        {
+            case AXIOM_XPATH_AXIS_CHILD:
+                if (step->node_test->type == AXIOM_XPATH_NODE_TYPE_TEXT)
+                {
+                    if (!step->last
+                            || step->predicate != AXIOM_XPATH_PARSE_END)
+                    {
+                        return AXIS2_FALSE;
+                    }
+                }
+                else if (step->node_test->type != AXIOM_XPATH_NODE_TEST_STANDARD
+                        && step->node_test->type != AXIOM_XPATH_NODE_TEST_ALL)
+                {
+                    return AXIS2_FALSE;
+                }
+
+                if (!axiom_xpath_reader_check_predicates(
+                            env, expr, step->predicate))
+                {
+                    return AXIS2_FALSE;
+                }
+                break;
+
+            case AXIOM_XPATH_AXIS_ATTRIBUTE:
+                if (!step->last || step->predicate != AXIOM_XPATH_PARSE_END
+                        || (step->node_test->type != AXIOM_XPATH_NODE_TEST_STANDARD
+                            && step->node_test->type != AXIOM_XPATH_NODE_TEST_ALL))
+                {
+                    return AXIS2_FALSE;
+                }
+                break;
+
+            case AXIOM_XPATH_AXIS_DESCENDANT_OR_SELF:
+                if (step->last || step->predicate != AXIOM_XPATH_PARSE_END
+                        || step->node_test->type != AXIOM_XPATH_NODE_TYPE_NODE)
+                {
+                    return AXIS2_FALSE;
+                }
+                break;
+
+            default:
+                return AXIS2_FALSE;
+        }
+    }
+
+    return AXIS2_TRUE;
+}
+
+static axis2_bool_t axiom_xpath_reader_add_paths(
+    axiom_xpath_reader_state_t *st,
+    int op_p)
+{
+    const axutil_env_t *env = st->env;
+    axiom_xpath_expression_t *expr = st->expr;
+    axiom_xpath_operation_t *op;
+
+    op = axiom_xpath_reader_unwrap(env, expr, op_p);
+
+    if (!op)
+    {
+        return AXIS2_FALSE;
+    }
+
+    switch (op->opr)
+    {
+        case AXIOM_XPATH_OPERATION_UNION:
+            return axiom_xpath_reader_add_paths(st, op->op1)
+                && axiom_xpath_reader_add_paths(st, op->op2);
+
+        /* The context node is the document, so both are the same here */
+        case AXIOM_XPATH_OPERATION_ROOT_NODE:
+        case AXIOM_XPATH_OPERATION_CONTEXT_NODE:
+            return axiom_xpath_reader_add_path(st, op->op1);
+
+        default:
+            return AXIS2_FALSE;
+    }
+}
+
+static const axis2_char_t * axiom_xpath_reader_lookup_ns(
+    axiom_xpath_reader_state_t *st,
+    const axis2_char_t *prefix)
+{
+    int i;
+
+    if (!prefix)
+    {
+        prefix = "";
+    }
+
+    if (axutil_strcmp(prefix, "xml") == 0)
+    {
+        return "http://www.w3.org/XML/1998/namespace";
+    }
+
+    for (i = st->n_ns - 1; i >= 0; i--)
+    {
+        if (axutil_strcmp(st->ns[i].prefix, prefix) == 0)
+        {
+            return *st->ns[i].uri ? st->ns[i].uri : NULL;
+        }
+    }
+
+    return NULL;
+}
+
+/* Same rules as axiom_xpath_node_test_match */
+static axis2_bool_t axiom_xpath_reader_name_test(
+    axiom_xpath_reader_state_t *st,
+    axiom_xpath_node_test_t *node_test,
+    const axis2_char_t *uri,
+    const axis2_char_t *name)
+{
+    axiom_namespace_t *xpath_ns;
+
+    if (node_test->type == AXIOM_XPATH_NODE_TEST_ALL)
+    {
+        if (!uri && node_test->prefix)
+        {
+            return AXIS2_FALSE;
+        }
+    }
+    else if (node_test->type == AXIOM_XPATH_NODE_TEST_STANDARD)
+    {
+        if ((uri && !node_test->prefix) || (!uri && node_test->prefix))
+        {
+            return AXIS2_FALSE;
+        }
+    }
+    else
+    {
+        return AXIS2_FALSE;
+    }
+
+    if (uri && node_test->prefix)
+    {
+        xpath_ns = axiom_xpath_get_namespace(st->context, node_test->prefix);
+
+        if (!xpath_ns || axutil_strcmp(uri,
+                    axiom_namespace_get_uri(xpath_ns, st->env)))
+        {
+            return AXIS2_FALSE;
+        }
+    }
+
+    if (node_test->type == AXIOM_XPATH_NODE_TEST_ALL)
+    {
+        return AXIS2_TRUE;
+    }
+
+    return name && axutil_strcmp(node_test->name, name) == 0;
+}
+
+static axis2_bool_t axiom_xpath_reader_to_boolean(
+    axiom_xpath_reader_value_t *v)
+{
+    switch (v->type)
+    {
+        case AXIOM_XPATH_READER_ATTRIBUTE:
+            return AXIS2_TRUE;
+
+        case AXIOM_XPATH_READER_STRING:
+            return v->str && *v->str;
+
+        case AXIOM_XPATH_READER_NUMBER:
+        case AXIOM_XPATH_READER_BOOLEAN:
+            return v->num != 0;
+
+        default:
+            return AXIS2_FALSE;
+    }
+}
+
+static axis2_bool_t axiom_xpath_reader_to_number(
+    axiom_xpath_reader_value_t *v,
+    double *num)
+{
+    char *end;
+
+    if (v->type == AXIOM_XPATH_READER_NUMBER
+            || v->type == AXIOM_XPATH_READER_BOOLEAN)
+    {
+        *num = v->num;
+        return AXIS2_TRUE;
+    }
+
+    if (!v->str || !*v->str)
+    {
+        return AXIS2_FALSE;
+    }
+
+    *num = strtod(v->str, &end);
+
+    while (*end == ' ' || *end == '\t' || *end == '\n' || *end == '\r')
+    {
+        end++;
+    }
+
+    return *end == '\0';
+}
+
+static void axiom_xpath_reader_evaluate(
+    axiom_xpath_reader_state_t *st,
+    int op_p,
+    axiom_xpath_reader_value_t *v)
+{
+    const axutil_env_t *env = st->env;
+    axiom_xpath_expression_t *expr = st->expr;
+    axiom_xpath_operation_t *op;
+    axiom_xpath_node_test_t *node_test;
+    axiom_xpath_reader_value_t v1, v2;
+    double n1, n2;
+    int i;
+
+    op = axiom_xpath_reader_unwrap(env, expr, op_p);
+
+    v->type = AXIOM_XPATH_READER_NONE;
+    v->str = NULL;
+    v->num = 0;
+
+    switch (op->opr)
+    {
+        case AXIOM_XPATH_OPERATION_LITERAL:
+            v->type = AXIOM_XPATH_READER_STRING;
+            v->str = (axis2_char_t *)op->par1;
+            break;
+
+        case AXIOM_XPATH_OPERATION_NUMBER:
+            v->type = AXIOM_XPATH_READER_NUMBER;
+            v->num = *((double *)op->par1);
+            break;
+
+        case AXIOM_XPATH_OPERATION_CONTEXT_NODE:
+            node_test = axiom_xpath_reader_attribute_test(env, expr, op);
+
+            for (i = 0; i < st->n_attrs; i++)
+            {
+                if (axiom_xpath_reader_name_test(st, node_test,
+                            st->attrs[i].uri, st->attrs[i].name))
+                {
+                    v->type = AXIOM_XPATH_READER_ATTRIBUTE;
+                    v->str = st->attrs[i].value;
+                    break;
+                }
+            }
+            break;
+
+        case AXIOM_XPATH_OPERATION_EQUAL_EXPR:
+            axiom_xpath_reader_evaluate(st, op->op1, &v1);
+            axiom_xpath_reader_evaluate(st, op->op2, &v2);
+
+            v->type = AXIOM_XPATH_READER_BOOLEAN;
+
+            if (v1.type == AXIOM_XPATH_READER_NONE
+                    || v2.type == AXIOM_XPATH_READER_NONE)
+            {
+                v->num = 0;
+            }
+            else if (v1.type == AXIOM_XPATH_READER_BOOLEAN
+                    || v2.type == AXIOM_XPATH_READER_BOOLEAN)
+            {
+                v->num = axiom_xpath_reader_to_boolean(&v1)
+                    == axiom_xpath_reader_to_boolean(&v2);
+            }
+            else if (v1.type == AXIOM_XPATH_READER_NUMBER
+                    || v2.type == AXIOM_XPATH_READER_NUMBER)
+            {
+                v->num = axiom_xpath_reader_to_number(&v1, &n1)
+                    && axiom_xpath_reader_to_number(&v2, &n2) && n1 == n2;
+            }
+            else
+            {
+                v->num = axutil_strcmp(v1.str, v2.str) == 0;
+            }
+            break;
+
+        case AXIOM_XPATH_OPERATION_AND_EXPR:
+            axiom_xpath_reader_evaluate(st, op->op1, &v1);
+            v->type = AXIOM_XPATH_READER_BOOLEAN;
+            if (axiom_xpath_reader_to_boolean(&v1))
+            {
+                axiom_xpath_reader_evaluate(st, op->op2, &v2);
+                v->num = axiom_xpath_reader_to_boolean(&v2);
+            }
+            break;
+
+        case AXIOM_XPATH_OPERATION_OR_EXPR:
+            axiom_xpath_reader_evaluate(st, op->op1, &v1);
+            v->type = AXIOM_XPATH_READER_BOOLEAN;
+            if (axiom_xpath_reader_to_boolean(&v1))
+            {
+                v->num = 1;
+            }
+            else
+            {
+                axiom_xpath_reader_evaluate(st, op->op2, &v2);
+                v->num = axiom_xpath_reader_to_boolean(&v2);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+static axis2_bool_t axiom_xpath_reader_predicates(
+    axiom_xpath_reader_state_t *st,
+    int op_p,
+    int position)
+{
+    const axutil_env_t *env = st->env;
+    axiom_xpath_expression_t *expr = st->expr;
+    axiom_xpath_operation_t *op;
+    axiom_xpath_reader_value_t v;
+
+    while (op_p != AXIOM_XPATH_PARSE_END)
+    {
+        op = AXIOM_XPATH_OPR_EXPR_GET(op_p);
+
+        axiom_xpath_reader_evaluate(st, op->op1, &v);
+
+        if (v.type == AXIOM_XPATH_READER_NUMBER)
+        {
+            if (v.num != (double)position)
+            {
+                return AXIS2_FALSE;
+            }
+        }
+        else if (!axiom_xpath_reader_to_boolean(&v))
+        {
+            return AXIS2_FALSE;
+        }
+
+        op_p = op->op2;
+    }
+
+    return AXIS2_TRUE;
+}
+
+static void axiom_xpath_reader_add_result(
+    axiom_xpath_reader_state_t *st,
+    axiom_xpath_result_type_t type,
+    void *value)
+{
+    axiom_xpath_result_node_t *node;
+
+    node = AXIS2_MALLOC(st->env->allocator,
+            sizeof(axiom_xpath_result_node_t));
+    if (!node)
+    {
+        return;
+    }
+
+    node->type = type;
+    node->value = value;
+
+    axutil_array_list_add(st->res->nodes, st->env, node);
+}
+
+/* Matched nodes which are not inside another match hang off a dummy root
+   owned by the result */
+static axiom_node_t * axiom_xpath_reader_parent(
+    axiom_xpath_reader_state_t *st)
+{
+    if (st->frames[st->depth].node)
+    {
+        return st->frames[st->depth].node;
+    }
+
+    if (!st->res->streamed_root)
+    {
+        st->res->streamed_root = axiom_node_create(st->env);
+    }
+
+    return st->res->streamed_root;
+}
+
+/* Builds the element at the start tag the reader is on, with its attributes
+   and the namespaces it needs. The outermost built element also gets every
+   namespace in scope, so that QName valued content stays resolvable. */
+static axiom_node_t * axiom_xpath_reader_build_element(
+    axiom_xpath_reader_state_t *st,
+    const axis2_char_t *name,
+    const axis2_char_t *prefix,
+    const axis2_char_t *uri,
+    int n_ns)
+{
+    const axutil_env_t *env = st->env;
+    axiom_node_t *node = NULL;
+    axiom_element_t *element;
+    axiom_namespace_t *ns = NULL;
+    axutil_hash_t *seen = NULL;
+    axiom_xpath_reader_attr_t *attr;
+    const axis2_char_t *ns_prefix;
+    int i, from;
+
+    if (uri)
+    {
+        ns = axiom_namespace_create(env, uri, prefix ? prefix : "");
+    }
+
+    element = axiom_element_create(env, axiom_xpath_reader_parent(st),
+            name, ns, &node);
+    if (!element)
+    {
+        return NULL;
+    }
+
+    /* Declarations of the element itself, or all of the scope for the
+       outermost built element */
+    from = st->frames[st->depth].node ? n_ns : 0;
+    if (from == 0)
+    {
+        seen = axutil_hash_make(env);
+    }
+
+    for (i = st->n_ns - 1; i >= from; i--)
+    {
+        ns_prefix = st->ns[i].prefix;
+
+        if (seen)
+        {
+            if (axutil_hash_get(seen, ns_prefix, AXIS2_HASH_KEY_STRING))
+            {
+                continue;
+            }
+            axutil_hash_set(seen, ns_prefix, AXIS2_HASH_KEY_STRING, ns_prefix);
+        }
+
+        if (!*st->ns[i].uri || axiom_element_find_namespace(element, env,
+                    node, st->ns[i].uri, ns_prefix))
+        {
+            continue;
+        }
+
+        ns = axiom_namespace_create(env, st->ns[i].uri, ns_prefix);
+        if (ns && axiom_element_declare_namespace(element, env, node, ns)
+                != AXIS2_SUCCESS)
+        {
+            axiom_namespace_free(ns, env);
+        }
+    }
+
+    if (seen)
+    {
+        axutil_hash_free(seen, env);
+    }
+
+    for (i = 0; i < st->n_attrs; i++)
+    {
+        attr = st->attrs + i;
+        ns = NULL;
+
+        if (attr->uri)
+        {
+            ns = axiom_element_find_namespace(element, env, node,
+                    attr->uri, attr->prefix);
+            if (!ns)
+            {
+                ns = axiom_namespace_create(env, attr->uri, attr->prefix);
+            }
+        }
+
+        attr->om = axiom_attribute_create(env, attr->name, attr->value, ns);
+        if (attr->om)
+        {
+            axiom_element_add_attribute(element, env, attr->om, node);
+        }
+    }
+
+    return node;
+}
+
+static void axiom_xpath_reader_clear_attributes(
+    axiom_xpath_reader_state_t *st)
+{
+    int i;
+
+    for (i = 0; i < st->n_attrs; i++)
+    {
+        axiom_xml_reader_xml_free(st->reader, st->env, st->attrs[i].prefix);
+        axiom_xml_reader_xml_free(st->reader, st->env, st->attrs[i].name);
+        axiom_xml_reader_xml_free(st->reader, st->env, st->attrs[i].value);
+    }
+
+    st->n_attrs = 0;
+}
+
+static void axiom_xpath_reader_end_element(
+    axiom_xpath_reader_state_t *st)
+{
+    axiom_xpath_reader_frame_t *frame = st->frames + st->depth;
+
+    while (st->n_ns > frame->n_ns)
+    {
+        st->n_ns--;
+        AXIS2_FREE(st->env->allocator, st->ns[st->n_ns].prefix);
+        AXIS2_FREE(st->env->allocator, st->ns[st->n_ns].uri);
+    }
+
+    if (frame->node)
+    {
+        axiom_node_set_complete(frame->node, st->env, AXIS2_TRUE);
+    }
+
+    st->depth--;
+}
+
+/* The per-depth arrays grow together, so they always hold max_depth rows */
+static axis2_bool_t axiom_xpath_reader_grow_depth(
+    axiom_xpath_reader_state_t *st)
+{
+    const axutil_env_t *env = st->env;
+    int n = st->max_depth * 2;
+    void *grown;
+
+    grown = AXIS2_REALLOC(env->allocator, st->frames,
+            n * sizeof(axiom_xpath_reader_frame_t));
+    if (!grown)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FALSE;
+    }
+    st->frames = grown;
+
+    grown = AXIS2_REALLOC(env->allocator, st->active, n * st->n_steps);
+    if (!grown)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FALSE;
+    }
+    st->active = grown;
+
+    grown = AXIS2_REALLOC(env->allocator, st->counts,
+            n * st->n_steps * sizeof(int));
+    if (!grown)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FALSE;
+    }
+    st->counts = grown;
+
+    st->max_depth = n;
+
+    return AXIS2_TRUE;
+}
+
+static axis2_bool_t axiom_xpath_reader_start_element(
+    axiom_xpath_reader_state_t *st,
+    axis2_bool_t is_empty)
+{
+    const axutil_env_t *env = st->env;
+    axiom_xml_reader_t *reader = st->reader;
+    axiom_xpath_reader_step_t *step;
+    axiom_xpath_reader_attr_t *attr;
+    axiom_xpath_reader_ns_t *ns;
+    axis2_char_t *name, *prefix, *ns_prefix, *ns_uri;
+    const axis2_char_t *uri;
+    axis2_char_t *parent_active, *active;
+    int *parent_counts;
+    axiom_node_t *node = NULL;
+    axis2_bool_t matched = AXIS2_FALSE;
+    int parent = st->depth;
+    int child = parent + 1;
+    int n_ns = st->n_ns;
+    int i, k, count;
+
+    if (child >= st->max_depth && !axiom_xpath_reader_grow_depth(st))
+    {
+        return AXIS2_FALSE;
+    }
+
+    /* Namespace declarations of the element */
+    count = axiom_xml_reader_get_namespace_count(reader, env);
+
+    if (!axiom_xpath_reader_grow(env, (void **)&st->ns, &st->max_ns,
+                st->n_ns + count, sizeof(axiom_xpath_reader_ns_t)))
+    {
+        return AXIS2_FALSE;
+    }
+
+    for (i = 1; i <= count; i++)
+    {
+        ns_prefix = axiom_xml_reader_get_namespace_prefix_by_number(
+                    reader, env, i);
+        ns = st->ns + st->n_ns++;
+
+        /* guththila gives no prefix for the default namespace, libxml2 xmlns */
+        if (!ns_prefix || axutil_strcmp(ns_prefix, "xmlns") == 0)
+        {
+            ns->prefix = axutil_strdup(env, "");
+        }
+        else
+        {
+            ns->prefix = axutil_strdup(env, ns_prefix);
+        }
+
+        ns_uri = axiom_xml_reader_get_namespace_uri_by_number(reader, env, i);
+        ns->uri = axutil_strdup(env, ns_uri ? ns_uri : "");
+
+        if (ns_prefix)
+        {
+            axiom_xml_reader_xml_free(reader, env, ns_prefix);
+        }
+        if (ns_uri)
+        {
+            axiom_xml_reader_xml_free(reader, env, ns_uri);
+        }
+    }
+
+    /* Attributes */
+    count = axiom_xml_reader_get_attribute_count(reader, env);
+
+    if (!axiom_xpath_reader_grow(env, (void **)&st->attrs, &st->max_attrs,
+                count, sizeof(axiom_xpath_reader_attr_t)))
+    {
+        return AXIS2_FALSE;
+    }
+
+    for (i = 1; i <= count; i++)
+    {
+        attr = st->attrs + st->n_attrs++;
+        attr->prefix = axiom_xml_reader_get_attribute_prefix_by_number(
+                    reader, env, i);
+        attr->name = axiom_xml_reader_get_attribute_name_by_number(
+                    reader, env, i);
+        attr->value = axiom_xml_reader_get_attribute_value_by_number(
+                    reader, env, i);
+        attr->uri = attr->prefix && *attr->prefix
+            ? axiom_xpath_reader_lookup_ns(st, attr->prefix) : NULL;
+        attr->om = NULL;
+        attr->collected = AXIS2_FALSE;
+    }
+
+    name = axiom_xml_reader_get_name(reader, env);
+    prefix = axiom_xml_reader_get_prefix(reader, env);
+    uri = axiom_xpath_reader_lookup_ns(st, prefix);
+
+    /* Test the element against the steps active on its parent */
+    parent_active = AXIOM_XPATH_READER_ACTIVE(st, parent);
+    parent_counts = AXIOM_XPATH_READER_COUNTS(st, parent);
+    active = AXIOM_XPATH_READER_ACTIVE(st, child);
+
+    memset(active, 0, st->n_steps);
+    memset(AXIOM_XPATH_READER_COUNTS(st, child), 0,
+            st->n_steps * sizeof(int));
+
+    for (k = 0; k < st->n_steps; k++)
+    {
+        if (!parent_active[k])
+        {
+            continue;
+        }
+
+        step = st->steps + k;
+
+        if (step->axis == AXIOM_XPATH_AXIS_DESCENDANT_OR_SELF)
+        {
+            active[k] = 1;
+            continue;
+        }
+
+        if (step->axis != AXIOM_XPATH_AXIS_CHILD
+                || !axiom_xpath_reader_name_test(st, step->node_test, uri, name))
+        {
+            continue;
+        }
+
+        if (!axiom_xpath_reader_predicates(st, step->predicate,
+                    ++parent_counts[k]))
+        {
+            continue;
+        }
+
+        if (step->last)
+        {
+            matched = AXIS2_TRUE;
+        }
+        else
+        {
+            active[k + 1] = 1;
+        }
+    }
+
+    /* descendant-or-self::node() includes the element itself */
+    for (k = 0; k < st->n_steps; k++)
+    {
+        if (active[k] && st->steps[k].axis == AXIOM_XPATH_AXIS_DESCENDANT_OR_SELF)
+        {
+            active[k + 1] = 1;
+        }
+    }
+
+    if (matched || st->frames[parent].node)
+    {
+        node = axiom_xpath_reader_build_element(st, name, prefix, uri, n_ns);
+    }
+
+    if (matched && node)
+    {
+        axiom_xpath_reader_add_result(st, AXIOM_XPATH_TYPE_NODE, node);
+    }
+
+    for (k = 0; k < st->n_steps; k++)
+    {
+        if (!active[k] || st->steps[k].axis != AXIOM_XPATH_AXIS_ATTRIBUTE)
+        {
+            continue;
+        }
+
+        for (i = 0; i < st->n_attrs; i++)
+        {
+            attr = st->attrs + i;
+
+            if (attr->collected || !axiom_xpath_reader_name_test(st,
+                        st->steps[k].node_test, attr->uri, attr->name))
+            {
+                continue;
+            }
+
+            /* The attribute is returned on a shallow copy of its element */
+            if (!node)
+            {
+                node = axiom_xpath_reader_build_element(
+                            st, name, prefix, uri, n_ns);
+            }
+
+            if (attr->om)
+            {
+                attr->collected = AXIS2_TRUE;
+                axiom_xpath_reader_add_result(st,
+                        AXIOM_XPATH_TYPE_ATTRIBUTE, attr->om);
+            }
+        }
+    }
+
+    axiom_xpath_reader_clear_attributes(st);
+    axiom_xml_reader_xml_free(reader, env, name);
+    if (prefix)
+    {
+        axiom_xml_reader_xml_free(reader, env, prefix);
+    }
+
+    st->depth = child;
+    st->frames[child].n_ns = n_ns;
+    st->frames[child].node = (matched || st->frames[parent].node) ? node : NULL;
+
+    if (is_empty)
+    {
+        if (node)
+        {
+            axiom_element_set_is_empty(axiom_node_get_data_element(node, env),
+                    env, AXIS2_TRUE);
+        }
+        axiom_xpath_reader_end_element(st);
+    }
+
+    return AXIS2_TRUE;
+}
+
+static void axiom_xpath_reader_text(
+    axiom_xpath_reader_state_t *st,
+    int event)
+{
+    const axutil_env_t *env = st->env;
+    axiom_xpath_reader_frame_t *frame = st->frames + st->depth;
+    axis2_char_t *active = AXIOM_XPATH_READER_ACTIVE(st, st->depth);
+    axiom_node_t *node = NULL;
+    axis2_char_t *value;
+    int k;
+
+    value = axiom_xml_reader_get_value(st->reader, env);
+
+    if (event == AXIOM_XML_READER_COMMENT)
+    {
+        if (frame->node)
+        {
+            axiom_comment_create(env, frame->node, value, &node);
+        }
+    }
+    else
+    {
+        if (frame->node)
+        {
+            axiom_text_create(env, frame->node, value, &node);
+        }
+
+        for (k = 0; k < st->n_steps && st->depth > 0; k++)
+        {
+            if (active[k] && st->steps[k].axis == AXIOM_XPATH_AXIS_CHILD
+                    && st->steps[k].node_test->type == AXIOM_XPATH_NODE_TYPE_TEXT)
+            {
+                /* axiom_text_create only attaches to element parents */
+                if (!node && axiom_text_create(env, NULL, value, &node))
+                {
+                    axiom_node_add_child(axiom_xpath_reader_parent(st),
+                            env, node);
+                }
+
+                if (node)
+                {
+                    axiom_xpath_reader_add_result(st,
+                            AXIOM_XPATH_TYPE_NODE, node);
+                }
+                break;
+            }
+        }
+    }
+
+    if (value)
+    {
+        axiom_xml_reader_xml_free(st->reader, env, value);
+    }
+}
+
+axiom_xpath_result_t * axiom_xpath_streaming_evaluate_reader(
+    axiom_xpath_context_t *context,
+    axiom_xpath_expression_t *expr,
+    axiom_xml_reader_t *reader)
+{
+    const axutil_env_t *env = context->env;
+    axiom_xpath_reader_state_t st;
+    axiom_xpath_result_t *res;
+    axis2_bool_t started = AXIS2_FALSE;
+    int event, k;
+
+    res = AXIS2_MALLOC(env->allocator, sizeof(axiom_xpath_result_t));
+    if (!res)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+
+    res->flag = 0;
+    res->nodes = NULL;
+    res->streamed_root = NULL;
+
+    memset(&st, 0, sizeof(st));
+    st.env = env;
+    st.context = context;
+    st.expr = expr;
+    st.reader = reader;
+    st.res = res;
+
+    if (!axiom_xpath_reader_add_paths(&st, expr->start))
+    {
+        if (st.steps)
+        {
+            AXIS2_FREE(env->allocator, st.steps);
+        }
+
+        res->flag = AXIOM_XPATH_ERROR_STREAMING_NOT_SUPPORTED;
+        return res;
+    }
+
+    res->nodes = axutil_array_list_create(env, 0);
+
+    /* Frame 0 is the document; every path starts at its first step */
+    st.max_depth = 16;
+    st.frames = AXIS2_MALLOC(env->allocator,
+            st.max_depth * sizeof(axiom_xpath_reader_frame_t));
+    st.active = AXIS2_MALLOC(env->allocator, st.max_depth * st.n_steps);
+    st.counts = AXIS2_MALLOC(env->allocator,
+            st.max_depth * st.n_steps * sizeof(int));
+
+    if (st.frames && st.active && st.counts)
+    {
+        memset(st.active, 0, st.n_steps);
+        memset(st.counts, 0, st.n_steps * sizeof(int));
+        st.frames[0].node = NULL;
+        st.frames[0].n_ns = 0;
+
+        for (k = 0; k < st.n_steps; k++)
+        {
+            if (k == 0 || st.steps[k - 1].last)
+            {
+                st.active[k] = 1;
+            }
+            if (st.active[k]
+                    && st.steps[k].axis == AXIOM_XPATH_AXIS_DESCENDANT_OR_SELF)
+            {
+                st.active[k + 1] = 1;
+            }
+        }
+
+        while (!(started && st.depth == 0)
+                && (event = axiom_xml_reader_next(reader, env)) != -1)
+        {
+            switch (event)
+            {
+                case AXIOM_XML_READER_START_ELEMENT:
+                case AXIOM_XML_READER_EMPTY_ELEMENT:
+                    started = AXIS2_TRUE;
+                    if (!axiom_xpath_reader_start_element(&st,
+                                event == AXIOM_XML_READER_EMPTY_ELEMENT))
+                    {
+                        res->flag = AXIOM_XPATH_EVALUATION_ERROR;
+                    }
+                    break;
+
+                case AXIOM_XML_READER_END_ELEMENT:
+                    if (st.depth > 0)
+                    {
+                        axiom_xpath_reader_end_element(&st);
+                    }
+                    break;
+
+                case AXIOM_XML_READER_CHARACTER:
+                case AXIOM_XML_READER_SPACE:
+                case AXIOM_XML_READER_CDATA:
+                case AXIOM_XML_READER_COMMENT:
+                    if (st.depth > 0)
+                    {
+                        axiom_xpath_reader_text(&st, event);
+                    }
+                    break;
+
+                default:
+                    break;
+            }
+
+            if (res->flag)
+            {
+                break;
+            }
+        }
+    }
+    else
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        res->flag = AXIOM_XPATH_EVALUATION_ERROR;
+    }
+
+    /* Unwind what is left open after an error or a truncated document */
+    while (st.depth > 0)
+    {
+        axiom_xpath_reader_end_element(&st);
+    }
+
+    axiom_xpath_reader_clear_attributes(&st);
+    while (st.n_ns > 0)
+    {
+        st.n_ns--;
+        AXIS2_FREE(env->allocator, st.ns[st.n_ns].prefix);
+        AXIS2_FREE(env->allocator, st.ns[st.n_ns].uri);
+    }
+
+    if (st.attrs)
+    {
+        AXIS2_FREE(env->allocator, st.attrs);
+    }
+    if (st.ns)
+    {
+        AXIS2_FREE(env->allocator, st.ns);
+    }
+    if (st.counts)
+    {
+        AXIS2_FREE(env->allocator, st.counts);
+    }
+    if (st.active)
+    {
+        AXIS2_FREE(env->allocator, st.active);
+    }
+    if (st.frames)
+    {
+        AXIS2_FREE(env->allocator, st.frames);
+    }
+    AXIS2_FREE(env->allocator, st.steps);
+
+    return res;
+}
@@ -117,6 +117,20 @@ extern "C"
         axiom_xpath_streaming_t r1,
         axiom_xpath_streaming_t r2);
 
+    /**
+      * Evaluates an expression on the events of an XML reader
+      *
+      * @param context XPath context, supplies the environment and namespaces
+      * @param expr A pointer to the XPath expression
+      * @param reader Reader positioned before the document element
+      * @return The result set; flagged AXIOM_XPATH_ERROR_STREAMING_NOT_SUPPORTED
+      *         if the expression cannot be evaluated on the events
+      */
+    axiom_xpath_result_t * axiom_xpath_streaming_evaluate_reader(
+        axiom_xpath_context_t *context,
+        axiom_xpath_expression_t *expr,
+        axiom_xml_reader_t *reader);
+
     /** @} */
 
 #ifdef __cplusplus
@@ -16,17 +16,21 @@
  * limitations under the License.
  */
 
+#include <string.h>
 #include <axiom_stax_builder.h>
 #include <axiom_document.h>
 #include <axiom_node.h>
 #include <axiom_element.h>
 #include <axiom_text.h>
 #include <axiom_data_source.h>
+#include <axiom_data_handler.h>
 #include <axutil_stream.h>
 #include <axutil_log_default.h>
 #include <axutil_error_default.h>
 #include <axiom_xml_reader.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <axiom_xml_writer.h>
 #include <axutil_env.h>
 
@@ -281,8 +285,8 @@ int test_om_buffer()
     /*AXIS2C-1628 buffer modified by axiom_node_create_from_buffer */
     axis2_char_t * output;
 
-    char * xml = strdup("<foo>T1 &amp; T2</foo>");
-    char * xml_unaltered= strdup("<foo>T1 &amp; T2</foo>");
+    char * xml = axutil_strdup(environment, "<foo>T1 &amp; T2</foo>");
+    char * xml_unaltered= axutil_strdup(environment, "<foo>T1 &amp; T2</foo>");
 
     printf("\nstart test_om_bufer\n");
 
@@ -424,6 +428,195 @@ test_om_serialize(
 
     return 0;
 }
+/* base64 text sent by value, as a client that does not use MTOM does */
+int test_om_base64()
+{
+    const char *plain = "Hello, base64 world!";
+    const char *pieces[] = { "SGVsb", "G8sIGJh", "c2U2", "NCB3b3JsZCE", "=" };
+    char *xml = axutil_strdup(environment,
+        "<data>SGVsbG8sIGJh\n  c2U2NCB3\n  b3JsZCE=</data>");
+    axiom_node_t *om_node = NULL;
+    axiom_node_t *text_node = NULL;
+    axiom_data_handler_t *data_handler = NULL;
+    int status = 0;
+    int i = 0;
+
+    printf("\nstart test_om_base64\n");
+
+    om_node = axiom_node_create_from_buffer(environment, xml);
+    text_node = om_node ? axiom_node_get_first_child(om_node, environment) :
+        NULL;
+    if (!text_node ||
+        axiom_node_get_node_type(text_node, environment) != AXIOM_TEXT)
+    {
+        printf("ERROR NO TEXT NODE\n");
+        return -1;
+    }
+    data_handler = axiom_text_create_data_handler_from_base64(
+        (axiom_text_t *) axiom_node_get_data_element(text_node, environment),
+        environment, NULL);
+    if (!data_handler ||
+        axiom_data_handler_get_input_stream_len(data_handler, environment) !=
+        (int) strlen(plain) ||
+        memcmp(axiom_data_handler_get_input_stream(data_handler, environment),
+               plain, strlen(plain)))
+    {
+        printf("ERROR WRAPPED TEXT DECODED WRONG\n");
+        status = -1;
+    }
+    if (data_handler)
+    {
+        axiom_data_handler_free(data_handler, environment);
+    }
+    axiom_node_free_tree(om_node, environment);
+    AXIS2_FREE(environment->allocator, xml);
+
+    /* text that arrives in pieces, split anywhere */
+    data_handler = axiom_data_handler_create(environment, NULL, NULL);
+    for (i = 0; i < 5; i++)
+    {
+        if (AXIS2_SUCCESS != axiom_data_handler_append_base64(data_handler,
+                environment, pieces[i], (int) strlen(pieces[i]), i == 4))
+        {
+            status = -1;
+        }
+    }
+    if (axiom_data_handler_get_input_stream_len(data_handler, environment) !=
+        (int) strlen(plain) ||
+        memcmp(axiom_data_handler_get_input_stream(data_handler, environment),
+               plain, strlen(plain)))
+    {
+        printf("ERROR PIECES DECODED WRONG\n");
+        status = -1;
+    }
+    axiom_data_handler_free(data_handler, environment);
+
+    printf("\nend test_om_base64\n");
+
+    return status;
+}
+
+/* a document larger than a chunk of the writer, written to a file and to
+   memory */
+int test_om_file_writer()
+{
+    const char *file_name = "test_om_file_writer.xml";
+    axiom_namespace_t *ns = NULL;
+    axiom_node_t *root = NULL;
+    axiom_node_t *node = NULL;
+    axiom_node_t *text_node = NULL;
+    axiom_xml_writer_t *writer = NULL;
+    axiom_output_t *om_output = NULL;
+    axis2_char_t *expected = NULL;
+    axis2_char_t *got = NULL;
+    char name[32];
+    FILE *file = NULL;
+    size_t len = 0;
+    int status = 0;
+    int i = 0;
+
+    printf("\nstart test_om_file_writer\n");
+
+    ns = axiom_namespace_create(environment, "urn:test", "t");
+    axiom_element_create(environment, NULL, "root", ns, &root);
+    for (i = 0; i < 2000; i++)
+    {
+        sprintf(name, "child%d", i);
+        axiom_element_create(environment, root, name, ns, &node);
+        axiom_text_create(environment, node, "text & more text", &text_node);
+    }
+
+    writer = axiom_xml_writer_create_for_memory(environment, NULL, AXIS2_TRUE,
+                                                0, AXIS2_XML_PARSER_TYPE_BUFFER);
+    om_output = axiom_output_create(environment, writer);
+    axiom_node_serialize(root, environment, om_output);
+    expected = axutil_strdup(environment,
+        (axis2_char_t *) axiom_xml_writer_get_xml(writer, environment));
+    axiom_output_free(om_output, environment);
+
+    writer = axiom_xml_writer_create(environment, (axis2_char_t *) file_name,
+                                     NULL, AXIS2_TRUE, 0);
+    if (!writer)
+    {
+        printf("ERROR CANNOT CREATE FILE WRITER\n");
+        status = -1;
+    }
+    else
+    {
+        om_output = axiom_output_create(environment, writer);
+        axiom_node_serialize(root, environment, om_output);
+        axiom_output_free(om_output, environment);
+
+        got = (axis2_char_t *) malloc(strlen(expected) + 2);
+        file = fopen(file_name, "rb");
+        if (file)
+        {
+            len = fread(got, 1, strlen(expected) + 1, file);
+            fclose(file);
+        }
+        if (!file || len != strlen(expected) || memcmp(got, expected, len))
+        {
+            printf("ERROR FILE DIFFERS FROM MEMORY OUTPUT\n");
+            status = -1;
+        }
+        free(got);
+        remove(file_name);
+    }
+
+    AXIS2_FREE(environment->allocator, expected);
+    axiom_node_free_tree(root, environment);
+
+    printf("\nend test_om_file_writer\n");
+
+    return status;
+}
+
+/* an element with no children serialized on its own, without the
+   siblings that follow it */
+int test_om_serialize_leaf()
+{
+    axiom_node_t *root = NULL;
+    axiom_node_t *first = NULL;
+    axiom_node_t *node = NULL;
+    axiom_node_t *last = NULL;
+    axiom_node_t *text_node = NULL;
+    axis2_char_t *output = NULL;
+    int status = 0;
+
+    printf("\nstart test_om_serialize_leaf\n");
+
+    axiom_element_create(environment, NULL, "root", NULL, &root);
+    axiom_element_create(environment, root, "first", NULL, &first);
+    axiom_element_create(environment, root, "middle", NULL, &node);
+    axiom_text_create(environment, node, "text", &text_node);
+    axiom_element_create(environment, root, "last", NULL, &last);
+
+    output = axiom_node_to_string(first, environment);
+    if (!output || strstr(output, "middle") || strstr(output, "last"))
+    {
+        printf("ERROR FIRST ELEMENT SERIALIZED AS %s\n",
+               output ? output : "NULL");
+        status = -1;
+    }
+    if (output)
+        AXIS2_FREE(environment->allocator, output);
+
+    output = axiom_node_to_string(node, environment);
+    if (!output || strcmp(output, "<middle>text</middle>"))
+    {
+        printf("ERROR MIDDLE ELEMENT SERIALIZED AS %s\n",
+               output ? output : "NULL");
+        status = -1;
+    }
+    if (output)
+        AXIS2_FREE(environment->allocator, output);
+
+    axiom_node_free_tree(root, environment);
+
+    printf("\nend test_om_serialize_leaf\n");
+
+    return status;
+}
 
 int
 main(
@@ -431,6 +624,7 @@ main(
     char *argv[])
  {
     const char *file_name = "../../resources/xml/om/test.xml";
+    int status = 0;
     if (argc > 1)
         file_name = argv[1];
     allocator = axutil_allocator_init(NULL);
@@ -441,7 +635,16 @@ main(
     test_om_build(file_name);
     test_om_serialize();
     test_om_buffer();
+    status = test_om_base64();
+    if (test_om_file_writer() != 0)
+    {
+        status = -1;
+    }
+    if (test_om_serialize_leaf() != 0)
+    {
+        status = -1;
+    }
 
     axutil_env_free(environment);
-    return 0;
+    return status;
 }
@@ -512,6 +512,214 @@ test_soap_fault_value(
     return 0;
 }
 
+static const char *forward_message =
+    "<soapenv:Envelope xmlns:soapenv=\"http://www.w3.org/2003/05/soap-envelope\""
+    " xmlns:ns1=\"urn:echo\">"
+    "<soapenv:Header><ns1:Route>a</ns1:Route></soapenv:Header>"
+    "<soapenv:Body>\n"
+    " <ns1:echo a=\"1\"><ns1:text>hello &amp; bye</ns1:text>"
+    "<item xmlns=\"urn:items\"/><!--note--></ns1:echo>\n"
+    " <ns1:trailer/>\n"
+    "</soapenv:Body></soapenv:Envelope>";
+
+static axiom_soap_builder_t *
+create_forward_builder(
+    const axutil_env_t * env)
+{
+    axiom_xml_reader_t *xml_reader = NULL;
+    axiom_stax_builder_t *om_builder = NULL;
+
+    xml_reader =
+        axiom_xml_reader_create_for_memory(env, (void *) forward_message,
+                                           strlen(forward_message), "UTF-8",
+                                           AXIS2_XML_PARSER_TYPE_BUFFER);
+    om_builder = axiom_stax_builder_create(env, xml_reader);
+    return axiom_soap_builder_create(env, om_builder,
+                                     AXIOM_SOAP12_SOAP_ENVELOPE_NAMESPACE_URI);
+}
+
+/* The builder stops at the body start tag, and neither a fault check nor
+   the dispatch on the first body element builds the body any further */
+int
+test_header_first_build(
+    const axutil_env_t * env)
+{
+    axiom_soap_builder_t *soap_builder = NULL;
+    axiom_soap_envelope_t *soap_envelope = NULL;
+    axiom_soap_body_t *soap_body = NULL;
+    axiom_node_t *body_node = NULL;
+    axiom_node_t *first_node = NULL;
+    axis2_char_t *localname = NULL;
+    int failed = 0;
+
+    printf("TEST HEADER FIRST BUILD\n");
+    soap_builder = create_forward_builder(env);
+    soap_envelope = axiom_soap_builder_get_soap_envelope(soap_builder, env);
+    soap_body = axiom_soap_envelope_get_body(soap_envelope, env);
+    body_node = axiom_soap_body_get_base_node(soap_body, env);
+    if (!axiom_soap_envelope_get_header(soap_envelope, env) ||
+        axiom_node_get_last_child(body_node, env))
+    {
+        failed = 1;
+    }
+
+    if (axiom_soap_body_has_fault(soap_body, env) ||
+        axiom_node_is_complete(body_node, env))
+    {
+        failed = 1;
+    }
+    first_node = axiom_node_get_first_element(body_node, env);
+    if (first_node)
+    {
+        localname = axiom_element_get_localname((axiom_element_t *)
+                                                axiom_node_get_data_element
+                                                (first_node, env), env);
+    }
+    if (!localname || strcmp(localname, "echo") ||
+        axiom_node_is_complete(first_node, env) ||
+        axiom_node_is_complete(body_node, env))
+    {
+        failed = 1;
+    }
+
+    printf("Actual = %s Expected = %s |", localname, "echo");
+    printf(failed ? "FAILURE\n" : "SUCCESS\n");
+    axiom_soap_builder_free(soap_builder, env);
+    return failed;
+}
+
+/* Forwards the body of a message, after building it up to the first body
+   element when prebuild is set */
+static int
+test_forward_body_content(
+    const axutil_env_t * env,
+    axis2_bool_t prebuild)
+{
+    axiom_soap_builder_t *soap_builder = NULL;
+    axiom_soap_envelope_t *soap_envelope = NULL;
+    axiom_soap_body_t *soap_body = NULL;
+    axiom_node_t *body_node = NULL;
+    axiom_xml_writer_t *xml_writer = NULL;
+    axiom_output_t *om_output = NULL;
+    axis2_char_t *buffer = NULL;
+    axis2_char_t *envelope_str = NULL;
+    int failed = 0;
+
+    soap_builder = create_forward_builder(env);
+    soap_envelope = axiom_soap_builder_get_soap_envelope(soap_builder, env);
+    soap_body = axiom_soap_envelope_get_body(soap_envelope, env);
+    body_node = axiom_soap_body_get_base_node(soap_body, env);
+    if (prebuild)
+    {
+        axiom_soap_body_has_fault(soap_body, env);
+        axiom_node_get_first_element(body_node, env);
+    }
+
+    xml_writer =
+        axiom_xml_writer_create_for_memory(env, NULL, AXIS2_FALSE, AXIS2_FALSE,
+                                           AXIS2_XML_PARSER_TYPE_BUFFER);
+    om_output = axiom_output_create(env, xml_writer);
+    if (axiom_soap_body_forward_content(soap_body, env, om_output) !=
+        AXIS2_SUCCESS)
+    {
+        failed = 1;
+    }
+    axiom_xml_writer_flush(xml_writer, env);
+    buffer = (axis2_char_t *) axiom_xml_writer_get_xml(xml_writer, env);
+    printf("Forwarded = %s\n", buffer);
+
+    if (!buffer ||
+        !strstr(buffer, "<ns1:echo") ||
+        !strstr(buffer, "xmlns:ns1=\"urn:echo\"") ||
+        !strstr(buffer, "a=\"1\"") ||
+        !strstr(buffer, "hello &amp; bye</ns1:text>") ||
+        !strstr(buffer, "<item") ||
+        !strstr(buffer, "xmlns=\"urn:items\"") ||
+        !strstr(buffer, "note") ||
+        !strstr(buffer, "</ns1:echo>") ||
+        !strstr(buffer, "<ns1:trailer") ||
+        strstr(buffer, "Body"))
+    {
+        failed = 1;
+    }
+
+    /* The body is consumed; the rest of the envelope is still there */
+    if (!axiom_node_is_complete(body_node, env) ||
+        axiom_node_get_first_child(body_node, env))
+    {
+        failed = 1;
+    }
+    envelope_str =
+        axiom_node_to_string(axiom_soap_envelope_get_base_node
+                             (soap_envelope, env), env);
+    if (!envelope_str || !strstr(envelope_str, "<ns1:Route>a</ns1:Route>") ||
+        strstr(envelope_str, "<ns1:echo"))
+    {
+        failed = 1;
+    }
+
+    AXIS2_FREE(env->allocator, envelope_str);
+    axiom_output_free(om_output, env);
+    axiom_soap_builder_free(soap_builder, env);
+    return failed;
+}
+
+int
+test_forward_body(
+    const axutil_env_t * env)
+{
+    int failed = 0;
+
+    printf("TEST FORWARD BODY\n");
+    failed = test_forward_body_content(env, AXIS2_FALSE) ||
+        test_forward_body_content(env, AXIS2_TRUE);
+    printf(failed ? "FAILURE\n" : "SUCCESS\n");
+    return failed;
+}
+
+int
+test_capture_body(
+    const axutil_env_t * env)
+{
+    axiom_soap_builder_t *soap_builder = NULL;
+    axiom_soap_envelope_t *soap_envelope = NULL;
+    axiom_soap_body_t *soap_body = NULL;
+    axiom_node_t *body_node = NULL;
+    axiom_node_t *data_node = NULL;
+    axis2_char_t *body_str = NULL;
+    int failed = 0;
+
+    printf("TEST CAPTURE BODY\n");
+    soap_builder = create_forward_builder(env);
+    soap_envelope = axiom_soap_builder_get_soap_envelope(soap_builder, env);
+    soap_body = axiom_soap_envelope_get_body(soap_envelope, env);
+    body_node = axiom_soap_body_get_base_node(soap_body, env);
+
+    data_node = axiom_soap_body_capture_content(soap_body, env);
+    if (!data_node ||
+        axiom_node_get_node_type(data_node, env) != AXIOM_DATA_SOURCE ||
+        axiom_node_get_first_child(body_node, env) != data_node ||
+        axiom_node_get_next_sibling(data_node, env))
+    {
+        failed = 1;
+    }
+
+    /* The captured content is written back as it was read */
+    body_str = axiom_node_to_string(body_node, env);
+    printf("Body = %s\n", body_str ? body_str : "");
+    if (!body_str || !strstr(body_str, "hello &amp; bye</ns1:text>") ||
+        !strstr(body_str, "<item xmlns=\"urn:items\"/>") ||
+        !strstr(body_str, "<ns1:trailer") || !strstr(body_str, "</soapenv:Body>"))
+    {
+        failed = 1;
+    }
+
+    AXIS2_FREE(env->allocator, body_str);
+    axiom_soap_builder_free(soap_builder, env);
+    printf(failed ? "FAILURE\n" : "SUCCESS\n");
+    return failed;
+}
+
 int
 main(
     int argc,
@@ -523,6 +731,7 @@ main(
     axutil_log_t *log = NULL;
     const axis2_char_t *uri = AXIOM_SOAP12_SOAP_ENVELOPE_NAMESPACE_URI;
     const char *filename = "../resources/xml/soap/test.xml";
+    int failed = 0;
     if (argc > 1)
         filename = argv[1];
     if (argc > 2)
@@ -545,6 +754,9 @@ main(
     create_soap_fault_with_exception(env);
     test_soap_fault_node(env);
     test_soap_fault_value(env);
+    failed = test_header_first_build(env);
+    failed = test_forward_body(env) || failed;
+    failed = test_capture_body(env) || failed;
     axutil_env_free(env);
-    return 0;
+    return failed;
 }
@@ -41,18 +41,70 @@ void evaluate(const axutil_env_t *env,
 void evaluate_expressions(const axutil_env_t *env,
         char *file_name);
 
+void evaluate_reader(const axutil_env_t *env,
+        axiom_xpath_expression_t *expr);
+
+int compare_reader_result(const axutil_env_t *env,
+        axis2_char_t *expr_str,
+        axiom_xpath_result_t *tree_result,
+        axiom_xpath_result_t *reader_result);
+
+void test_reader(const axutil_env_t *env);
+
+void test_cache(const axutil_env_t *env);
+
 void add_namespaces(const axutil_env_t *env,
         axiom_xpath_context_t *context,
         char *file_name);
 
 int readline(FILE *fin, char *str);
 
+int compare_result(axis2_char_t *rs);
+
 FILE *fcor;
 char *xml_file = "test.xml";
 char *xpath_file = "test.xpath";
 char *cor_file = "results.txt";
 char *ns_file = "test.ns";
 
+/* Number of failed checks */
+int failures = 0;
+
+/* Document the reader evaluation is checked against tree evaluation on.
+   Elements built by the reader carry the namespaces in scope, so every
+   namespace is declared on the element using it for the serialized forms
+   to compare equal */
+char *reader_xml =
+    "<root>"
+    "<item id=\"1\" price=\"5\"><name>first</name></item>"
+    "<item id=\"2\" price=\"15\"><name>second</name>"
+    "<t:tag xmlns:t=\"urn:test\">x</t:tag></item>"
+    "<other><item id=\"3\" price=\"25\"><name>third</name></item></other>"
+    "<t:entry xmlns:t=\"urn:test\" kind=\"a\">one</t:entry>"
+    "<t:entry xmlns:t=\"urn:test\" kind=\"b\">two</t:entry>"
+    "</root>";
+
+/* Expressions, and how many results tree evaluation gives for each */
+struct
+{
+    char *expr;
+    int count;
+} reader_exprs[] = {
+    { "/root/item", 2 },
+    { "//item", 3 },
+    { "/root/item[@id='2']", 1 },
+    { "/root/item[2]", 1 },
+    { "//item[@price='25']", 1 },
+    { "//item/@id", 3 },
+    { "/root/item/name/text()", 2 },
+    { "/root/item | /root/other", 3 },
+    { "//t:entry", 2 },
+    { "/root/t:entry[@kind='b']", 1 },
+    { "//t:tag", 1 },
+    { "/root/missing", 0 },
+    { NULL, 0 }
+};
+
 /*FILE *ftemp;*/
 
 int main(int argc, char *argv[])
@@ -80,6 +132,9 @@ int main(int argc, char *argv[])
         }
     }
 
+    test_reader(env);
+    test_cache(env);
+
     /*Create the request */
     test_tree = read_test_xml(env, (axis2_char_t *)xml_file);
 
@@ -112,6 +167,12 @@ int main(int argc, char *argv[])
         fclose(fcor); 
     }
 
+    if (failures)
+    {
+        printf("\n%d checks failed\n", failures);
+        return 1;
+    }
+
     return 0;
 }
 
@@ -283,12 +344,334 @@ void evaluate(
         axiom_xpath_free_result(env, result);
     }
 
+    evaluate_reader(env, expr);
+
     if (expr)
     {
         axiom_xpath_free_expression(env, expr);
     }
 }
 
+/* Evaluate directly on the pull parser events, without building the tree,
+   and check the result against evaluation on the tree */
+void evaluate_reader(
+    const axutil_env_t *env,
+    axiom_xpath_expression_t *expr)
+{
+    axiom_xml_reader_t *reader = NULL;
+    axiom_xpath_context_t *context = NULL;
+    axiom_xpath_context_t *tree_context = NULL;
+    axiom_xpath_result_t *result = NULL;
+    axiom_xpath_result_t *tree_result = NULL;
+    axiom_node_t *test_tree = NULL;
+
+    reader = axiom_xml_reader_create_for_file(env, xml_file, NULL);
+
+    if (!reader)
+    {
+        printf("Error creating pullparser");
+        return;
+    }
+
+    context = axiom_xpath_context_create(env, NULL);
+    add_namespaces(env, context, ns_file);
+
+    result = axiom_xpath_evaluate_reader(context, expr, reader);
+
+    if (!result)
+    {
+        printf("An error occured while evaluating on the reader.\n");
+        failures++;
+    }
+    else if (result->flag == AXIOM_XPATH_ERROR_STREAMING_NOT_SUPPORTED)
+    {
+        printf("Not supported on the reader.\n");
+    }
+    else
+    {
+        test_tree = read_test_xml(env, (axis2_char_t *)xml_file);
+        tree_context = axiom_xpath_context_create(env, test_tree);
+        add_namespaces(env, tree_context, ns_file);
+        tree_result = axiom_xpath_evaluate(tree_context, expr);
+
+        if (compare_reader_result(env, expr->expr_str, tree_result, result))
+        {
+            printf("Reader: %d results, same as the tree\n",
+                    axutil_array_list_size(result->nodes, env));
+        }
+
+        axiom_xpath_free_result(env, tree_result);
+        axiom_xpath_free_context(env, tree_context);
+        axiom_node_free_tree(test_tree, env);
+    }
+
+    axiom_xpath_free_result(env, result);
+    axiom_xpath_free_context(env, context);
+    axiom_xml_reader_free(reader, env);
+}
+
+/* String form of a result node, for comparing results of the reader with
+   results on the tree */
+static axis2_char_t *result_node_to_string(
+    const axutil_env_t *env,
+    axiom_xpath_result_node_t *result_node)
+{
+    axiom_node_t *node;
+    axis2_char_t *str;
+
+    if (result_node->type == AXIOM_XPATH_TYPE_NODE)
+    {
+        node = result_node->value;
+
+        if (axiom_node_get_node_type(node, env) == AXIOM_TEXT)
+        {
+            return axutil_strdup(env, axiom_text_get_value(
+                        axiom_node_get_data_element(node, env), env));
+        }
+
+        return axiom_node_to_string(node, env);
+    }
+    else if (result_node->type == AXIOM_XPATH_TYPE_ATTRIBUTE)
+    {
+        str = axutil_stracat(env, "@",
+                axiom_attribute_get_localname(result_node->value, env));
+
+        return axutil_strcat(env, str, "=",
+                axiom_attribute_get_value(result_node->value, env), NULL);
+    }
+
+    return axutil_strdup(env, "?");
+}
+
+/* Checks that the reader gave the nodes tree evaluation gave, in any order */
+int compare_reader_result(
+    const axutil_env_t *env,
+    axis2_char_t *expr_str,
+    axiom_xpath_result_t *tree_result,
+    axiom_xpath_result_t *reader_result)
+{
+    int tree_count, reader_count;
+    int i, j;
+    int same = 1;
+    axis2_char_t **tree_strs;
+    axis2_char_t *str;
+
+    tree_count = (tree_result && tree_result->nodes) ?
+        axutil_array_list_size(tree_result->nodes, env) : 0;
+    reader_count = (reader_result && reader_result->nodes) ?
+        axutil_array_list_size(reader_result->nodes, env) : 0;
+
+    if (tree_count != reader_count)
+    {
+        printf("FAILED \"%s\": %d results on the tree, %d on the reader\n",
+                expr_str, tree_count, reader_count);
+        failures++;
+        return 0;
+    }
+
+    tree_strs = AXIS2_MALLOC(env->allocator,
+            (tree_count + 1) * sizeof(axis2_char_t *));
+
+    for (i = 0; i < tree_count; i++)
+    {
+        tree_strs[i] = result_node_to_string(env,
+                axutil_array_list_get(tree_result->nodes, env, i));
+    }
+
+    for (i = 0; i < reader_count && same; i++)
+    {
+        str = result_node_to_string(env,
+                axutil_array_list_get(reader_result->nodes, env, i));
+
+        for (j = 0; j < tree_count; j++)
+        {
+            if (tree_strs[j] && axutil_strcmp(tree_strs[j], str) == 0)
+            {
+                /* Each tree result matches one reader result only */
+                AXIS2_FREE(env->allocator, tree_strs[j]);
+                tree_strs[j] = NULL;
+                break;
+            }
+        }
+
+        if (j == tree_count)
+        {
+            printf("FAILED \"%s\": %s not in the results on the tree\n",
+                    expr_str, str);
+            failures++;
+            same = 0;
+        }
+
+        AXIS2_FREE(env->allocator, str);
+    }
+
+    for (i = 0; i < tree_count; i++)
+    {
+        if (tree_strs[i])
+        {
+            AXIS2_FREE(env->allocator, tree_strs[i]);
+        }
+    }
+    AXIS2_FREE(env->allocator, tree_strs);
+
+    return same;
+}
+
+/* Evaluates each of reader_exprs on the tree and on the reader */
+void test_reader(
+    const axutil_env_t *env)
+{
+    axiom_xml_reader_t *reader;
+    axiom_xpath_context_t *context;
+    axiom_xpath_context_t *tree_context;
+    axiom_xpath_expression_t *expr;
+    axiom_xpath_result_t *result;
+    axiom_xpath_result_t *tree_result;
+    axiom_node_t *tree;
+    axis2_char_t *xml;
+    int tree_count;
+    int i;
+
+    printf("\nEvaluating on the reader and on the tree\n");
+
+    for (i = 0; reader_exprs[i].expr; i++)
+    {
+        expr = axiom_xpath_compile_expression(env, reader_exprs[i].expr);
+
+        if (!expr)
+        {
+            printf("FAILED \"%s\": not compiled\n", reader_exprs[i].expr);
+            failures++;
+            continue;
+        }
+
+        xml = axutil_strdup(env, reader_xml);
+        tree = axiom_node_create_from_buffer(env, xml);
+        tree_context = axiom_xpath_context_create(env, tree);
+        axiom_xpath_register_namespace(tree_context,
+                axiom_namespace_create(env, "urn:test", "t"));
+        tree_result = axiom_xpath_evaluate(tree_context, expr);
+        tree_count = (tree_result && tree_result->nodes) ?
+            axutil_array_list_size(tree_result->nodes, env) : 0;
+
+        if (tree_count != reader_exprs[i].count)
+        {
+            printf("FAILED \"%s\": %d results on the tree, %d expected\n",
+                    reader_exprs[i].expr, tree_count, reader_exprs[i].count);
+            failures++;
+        }
+
+        reader = axiom_xml_reader_create_for_memory(env, reader_xml,
+                (int)strlen(reader_xml), NULL, AXIS2_XML_PARSER_TYPE_BUFFER);
+        context = axiom_xpath_context_create(env, NULL);
+        axiom_xpath_register_namespace(context,
+                axiom_namespace_create(env, "urn:test", "t"));
+        result = axiom_xpath_evaluate_reader(context, expr, reader);
+
+        if (!result || result->flag == AXIOM_XPATH_ERROR_STREAMING_NOT_SUPPORTED)
+        {
+            printf("FAILED \"%s\": not evaluated on the reader\n",
+                    reader_exprs[i].expr);
+            failures++;
+        }
+        else if (compare_reader_result(env, reader_exprs[i].expr,
+                    tree_result, result))
+        {
+            printf("\"%s\": %d results\n", reader_exprs[i].expr, tree_count);
+        }
+
+        axiom_xpath_free_result(env, result);
+        axiom_xpath_free_context(env, context);
+        axiom_xml_reader_free(reader, env);
+        axiom_xpath_free_result(env, tree_result);
+        axiom_xpath_free_context(env, tree_context);
+        axiom_node_free_tree(tree, env);
+        AXIS2_FREE(env->allocator, xml);
+        axiom_xpath_free_expression(env, expr);
+    }
+
+    /* Evaluation that needs the tree is refused, not answered wrongly */
+    expr = axiom_xpath_compile_expression(env, "count(//item)");
+    reader = axiom_xml_reader_create_for_memory(env, reader_xml,
+            (int)strlen(reader_xml), NULL, AXIS2_XML_PARSER_TYPE_BUFFER);
+    context = axiom_xpath_context_create(env, NULL);
+    result = axiom_xpath_evaluate_reader(context, expr, reader);
+
+    if (!result || result->flag != AXIOM_XPATH_ERROR_STREAMING_NOT_SUPPORTED)
+    {
+        printf("FAILED \"count(//item)\": evaluated on the reader\n");
+        failures++;
+    }
+
+    axiom_xpath_free_result(env, result);
+    axiom_xpath_free_context(env, context);
+    axiom_xml_reader_free(reader, env);
+    axiom_xpath_free_expression(env, expr);
+}
+
+/* An idle compiled expression is handed out again; one that is checked out
+   is not */
+void test_cache(
+    const axutil_env_t *env)
+{
+    axiom_xpath_cache_t *cache;
+    axiom_xpath_expression_t *first;
+    axiom_xpath_expression_t *second;
+    axiom_xpath_expression_t *other;
+
+    printf("\nCompiled expression cache\n");
+
+    cache = axiom_xpath_cache_create(env);
+
+    /* Miss: compiled */
+    first = axiom_xpath_cache_get(cache, env, "//item[@id='2']");
+    if (!first)
+    {
+        printf("FAILED: expression not compiled\n");
+        failures++;
+        axiom_xpath_cache_free(cache, env);
+        return;
+    }
+
+    /* Miss: the only instance is checked out */
+    second = axiom_xpath_cache_get(cache, env, "//item[@id='2']");
+    if (!second || second == first)
+    {
+        printf("FAILED: checked out expression handed out twice\n");
+        failures++;
+    }
+
+    axiom_xpath_cache_release(cache, env, first);
+    axiom_xpath_cache_release(cache, env, second);
+
+    /* Hits: both instances are idle now */
+    other = axiom_xpath_cache_get(cache, env, "//item[@id='2']");
+    if (other != first && other != second)
+    {
+        printf("FAILED: idle expression not reused\n");
+        failures++;
+    }
+    axiom_xpath_cache_release(cache, env, other);
+
+    /* Another string does not hit */
+    other = axiom_xpath_cache_get(cache, env, "//item[@id='3']");
+    if (!other || other == first || other == second)
+    {
+        printf("FAILED: expression of another string reused\n");
+        failures++;
+    }
+    axiom_xpath_cache_release(cache, env, other);
+
+    /* Unparsable strings are not cached */
+    if (axiom_xpath_cache_get(cache, env, "//item[") != NULL)
+    {
+        printf("FAILED: unparsable expression compiled\n");
+        failures++;
+    }
+
+    axiom_xpath_cache_free(cache, env);
+}
+
 int compare_result(axis2_char_t *rs)
 {
     int i;
@@ -61,6 +61,15 @@ typedef enum guththila_writer_status_s
     BEGINING
 } guththila_writer_status_t;
 
+/*
+ * Receives the memory writer output in flush mode. Returns GUTHTHILA_SUCCESS
+ * if all len characters of data were consumed.
+ */
+typedef int (GUTHTHILA_CALL *GUTHTHILA_WRITER_FLUSH_FUNC)(
+    const guththila_char_t *data,
+    size_t len,
+    void *ctx);
+
 /*Main structure which provides the writer capability*/
 typedef struct guththila_xml_writer_s
 {
@@ -77,6 +86,15 @@ typedef struct guththila_xml_writer_s
     guththila_buffer_t buffer;
     guththila_writer_status_t status;
     int next;
+    /* Flush mode of the memory writer. Filled chunks are handed to
+       flush_func and released instead of being kept until the end */
+    GUTHTHILA_WRITER_FLUSH_FUNC flush_func;
+    void *flush_ctx;
+    /* Number of characters already handed to flush_func */
+    size_t flushed;
+    /* Copies of the names that were still in use when their chunk was
+       flushed. Each is freed when the element using it is closed */
+    guththila_stack_t detached;
 } guththila_xml_writer_t;
 
 /*TODO: we need to came up with common implementation of followng two structures in writer and reader*/
@@ -483,6 +501,60 @@ guththila_get_memory_buffer_size(
     guththila_xml_writer_t * wr,
     const axutil_env_t * env);
 
+/*
+ * Get the number of chunks the memory writer output is kept in. Together
+ * with guththila_get_memory_chunk the output can be sent without
+ * copying it into one buffer.
+ * @param wr pointer to the writer
+ * @param env pointer to the environment
+ * @return number of chunks
+ */
+GUTHTHILA_EXPORT int GUTHTHILA_CALL
+guththila_get_memory_chunk_count(
+    guththila_xml_writer_t * wr,
+    const axutil_env_t * env);
+
+/*
+ * Get a chunk of the memory writer output. 
+ * @param wr pointer to the writer
+ * @param index index of the chunk, starting from 0
+ * @param size set to the number of characters in the chunk
+ * @param env pointer to the environment
+ * @return the chunk, or NULL if index is out of range
+ */
+GUTHTHILA_EXPORT char *GUTHTHILA_CALL
+guththila_get_memory_chunk(
+    guththila_xml_writer_t * wr,
+    int index,
+    size_t *size,
+    const axutil_env_t * env);
+
+/*
+ * Put the memory writer into flush mode. Whenever a chunk is full it is
+ * handed to func and released, so the memory used stays bounded however
+ * large the document is. Passing NULL as func turns flush mode off.
+ * @param wr pointer to the writer
+ * @param func function that receives the output
+ * @param ctx passed to func as is
+ * @param env pointer to the environment
+ */
+GUTHTHILA_EXPORT int GUTHTHILA_CALL
+guththila_xml_writer_set_flush(
+    guththila_xml_writer_t * wr,
+    GUTHTHILA_WRITER_FLUSH_FUNC func,
+    void *ctx,
+    const axutil_env_t * env);
+
+/*
+ * Hand everything written so far to the flush function.
+ * @param wr pointer to the writer
+ * @param env pointer to the environment
+ */
+GUTHTHILA_EXPORT int GUTHTHILA_CALL
+guththila_xml_writer_flush(
+    guththila_xml_writer_t * wr,
+    const axutil_env_t * env);
+
 /*
  * Free the writer. 
  * @param wr pointer to the writer
@@ -105,7 +105,15 @@ guththila_buffer_get(guththila_buffer_t * buffer,const axutil_env_t * env)
     {
         size += buffer->data_size[i];
     }
+    if (buffer->xml)
+    {
+        AXIS2_FREE(env->allocator, buffer->xml);
+    }
     buffer->xml = (char *) AXIS2_MALLOC(env->allocator, sizeof(char) * (size + 1));
+    if (!buffer->xml)
+    {
+        return NULL;
+    }
     for (i = 0; i <= buffer->cur_buff; i++)
     {
         memcpy(buffer->xml + current_size, buffer->buff[i], buffer->data_size[i]);
@@ -20,6 +20,30 @@
 #include <string.h>
     
 #include <guththila_xml_writer.h>
+
+/* Clean runs of character data are found 16 bytes at a time with SSE2,
+ * which every x86_64 compiler enables by default */
+#if defined(__GNUC__) && defined(__SSE2__) && !defined(GUTHTHILA_WRITER_NO_SIMD)
+#define GUTHTHILA_WRITER_SSE2
+#include <emmintrin.h>
+#endif
+
+/* Longest replacement of a special character, "&apos;" and "&quot;" */
+#define GUTHTHILA_ESCAPE_MAX_LEN 6
+
+/* Smallest run of input worth escaping into the tail of the current
+ * buffer before a new buffer is taken */
+#define GUTHTHILA_ESCAPE_MIN_RUN 256
+
+/* Longest run of input escaped after a single check of the room left */
+#define GUTHTHILA_ESCAPE_MAX_RUN 4096
+
+/* A name copied out of a flushed chunk, followed by its characters */
+typedef struct guththila_writer_detached_s
+{
+    /* Index of the element in the element stack whose closing frees it */
+    int depth;
+} guththila_writer_detached_t;
     
 #define GUTHTHILA_WRITER_SD_DECLARATION  "<?xml version=\"1.0\" encoding=\"utf-8\" ?>"
     
@@ -35,7 +59,8 @@
 #define GUTHTHILA_WRITER_ELEM_FREE(wr, elem, _env)		\
     if ((elem)->prefix) guththila_tok_list_release_token(&wr->tok_list, (elem)->prefix, _env); \
     if ((elem)->name) guththila_tok_list_release_token(&wr->tok_list, (elem)->name, _env); \
-    AXIS2_FREE(env->allocator, elem);
+    AXIS2_FREE(env->allocator, elem); \
+    guththila_writer_release_detached(wr, _env);
 #endif 
 #endif 
     
@@ -135,6 +160,34 @@ int GUTHTHILA_CALL guththila_write_xtoken(
     size_t buff_len,
     const axutil_env_t * env);
 
+/*
+ * Escape len characters of buff and write them. Clean runs are copied in
+ * bulk and, for the memory writer, the room left in the chunk is checked
+ * once per run instead of once per write.
+ */
+static int GUTHTHILA_CALL guththila_write_escaped(
+    guththila_xml_writer_t * wr,
+    guththila_char_t *buff,
+    size_t len,
+    const axutil_env_t * env);
+
+/*
+ * Start a new chunk of the memory writer that can hold at least min_size
+ * characters.
+ */
+static int guththila_writer_next_buffer(
+    guththila_xml_writer_t * wr,
+    size_t min_size,
+    const axutil_env_t * env);
+
+/*
+ * Free the copies of names made by a flush that are no longer used by an
+ * open element.
+ */
+static void guththila_writer_release_detached(
+    guththila_xml_writer_t * wr,
+    const axutil_env_t * env);
+
 /*
  * Private function for free the contents of a empty element.
  */
@@ -172,6 +225,9 @@ guththila_create_xml_stream_writer(guththila_char_t *file_name,
     wr->type = GUTHTHILA_WRITER_FILE;
     wr->status = BEGINING;
     wr->next = 0;
+    wr->flush_func = NULL;
+    wr->flush_ctx = NULL;
+    wr->flushed = 0;
     return wr;
 }
 
@@ -201,12 +257,22 @@ guththila_create_xml_stream_writer_for_memory(const axutil_env_t * env)
         return NULL;
     }
     
+    if (!guththila_stack_init(&wr->detached, env))
+    {
+        guththila_buffer_un_init(&wr->buffer, env);
+        guththila_stack_un_init(&wr->element, env);
+        guththila_stack_un_init(&wr->namesp, env);
+        AXIS2_FREE(env->allocator, wr);
+        return NULL;
+    }
+    
 #ifdef GUTHTHILA_XML_WRITER_TOKEN
     if (!guththila_tok_list_init(&wr->tok_list, env))
     {
         guththila_buffer_un_init(&wr->buffer, env);
         guththila_stack_un_init(&wr->element, env);
         guththila_stack_un_init(&wr->namesp, env);
+        guththila_stack_un_init(&wr->detached, env);
         AXIS2_FREE(env->allocator, wr);
         return NULL;
     }
@@ -214,6 +280,9 @@ guththila_create_xml_stream_writer_for_memory(const axutil_env_t * env)
     wr->type = GUTHTHILA_WRITER_MEMORY;
     wr->status = BEGINING;
     wr->next = 0;
+    wr->flush_func = NULL;
+    wr->flush_ctx = NULL;
+    wr->flushed = 0;
     return wr;
 }
 
@@ -222,9 +291,16 @@ guththila_xml_writer_free(
     guththila_xml_writer_t * wr,
     const axutil_env_t * env) 
 {
+    guththila_writer_detached_t *detached = NULL;
     if (wr->type == GUTHTHILA_WRITER_MEMORY)
     {
         guththila_buffer_un_init(&wr->buffer, env);
+        while ((detached = (guththila_writer_detached_t *)
+                guththila_stack_pop(&wr->detached, env)) != NULL)
+        {
+            AXIS2_FREE(env->allocator, detached);
+        }
+        guththila_stack_un_init(&wr->detached, env);
     }
     else if (wr->type == GUTHTHILA_WRITER_FILE)
     {
@@ -244,74 +320,35 @@ guththila_write(guththila_xml_writer_t * wr, guththila_char_t *buff,
                 size_t buff_len, const axutil_env_t * env) 
 {
     size_t remain_len = 0;
-    size_t temp = 0;
-    size_t * temp1 = NULL, *temp2 = NULL;
-    guththila_char_t **temp3 = NULL;
-    int i = 0;
+    size_t copied = 0;
     if (wr->type == GUTHTHILA_WRITER_MEMORY)
     {
-        remain_len = wr->buffer.buffs_size[wr->buffer.cur_buff] -
-                     wr->buffer.data_size[wr->buffer.cur_buff];
-        /* We have space */
-        if (buff_len < remain_len)
+        /* Fill the current chunk and carry the rest over to new chunks of
+         * the default size. Chunks are never reallocated, so data already
+         * written stays where it is */
+        while (copied < buff_len)
         {
-            memcpy(wr->buffer.buff[wr->buffer.cur_buff] +
-                    wr->buffer.data_size[wr->buffer.cur_buff], buff, buff_len);
-            wr->buffer.data_size[wr->buffer.cur_buff] += buff_len;
-            wr->next += (int)buff_len;
-            /* We are sure that the difference lies within the int range */
-            return (int) buff_len;
-        }
-        else
-        {
-            if (remain_len != 0)
-            {
-                memcpy(wr->buffer.buff[wr->buffer.cur_buff] +
-                        wr->buffer.data_size[wr->buffer.cur_buff], buff, remain_len);
-                wr->buffer.data_size[wr->buffer.cur_buff] += remain_len;
-            }
-            /* We are sure that the difference lies within the int range */
-            if (((int)wr->buffer.no_buffers - 1) == wr->buffer.cur_buff)
+            remain_len = GUTHTHILA_BUFFER_CURRENT_BUFF_SIZE(wr->buffer);
+            if (remain_len == 0)
             {
-                /* Out of allocated array buffers. Need to allocate*/
-                wr->buffer.no_buffers = wr->buffer.no_buffers * 2;
-                temp3 = (guththila_char_t **) AXIS2_MALLOC(env->allocator,
-                         sizeof(guththila_char_t *) * wr->buffer.no_buffers);
-                temp1 = (size_t *) AXIS2_MALLOC(env->allocator,
-                         sizeof(size_t) * wr->buffer.no_buffers);
-                temp2 = (size_t *) AXIS2_MALLOC(env->allocator,
-                         sizeof(size_t) * wr->buffer.no_buffers);
-                for (i = 0; i <= wr->buffer.cur_buff; i++)
+                if (!guththila_writer_next_buffer(wr, 0, env))
                 {
-                    temp3[i] = wr->buffer.buff[i];
-                    temp1[i] = wr->buffer.data_size[i];
-                    temp2[i] = wr->buffer.buffs_size[i];
+                    return GUTHTHILA_FAILURE;
                 }
-                AXIS2_FREE(env->allocator, wr->buffer.data_size);
-                AXIS2_FREE(env->allocator, wr->buffer.buffs_size);
-                AXIS2_FREE(env->allocator, wr->buffer.buff);
-                wr->buffer.buff = temp3;
-                wr->buffer.buffs_size = temp2;
-                wr->buffer.data_size = temp1;
+                continue;
             }
-            wr->buffer.cur_buff++;
-            temp = wr->buffer.buffs_size[wr->buffer.cur_buff - 1] * 2;
-            while (temp < (buff_len - remain_len))
+            if (remain_len > buff_len - copied)
             {
-                temp = temp * 2;
+                remain_len = buff_len - copied;
             }
-            /* Create a be buffer */
-            wr->buffer.buff[wr->buffer.cur_buff] =
-                (guththila_char_t *) AXIS2_MALLOC(env->allocator, sizeof(guththila_char_t) * temp);
-            wr->buffer.buffs_size[wr->buffer.cur_buff] = temp;
-            memcpy(wr->buffer.buff[wr->buffer.cur_buff], buff + remain_len,
-                   buff_len - remain_len);
-            wr->buffer.data_size[wr->buffer.cur_buff] = buff_len - remain_len;
-            wr->buffer.pre_tot_data += wr->buffer.data_size[wr->buffer.cur_buff - 1];
-            wr->next += (int)buff_len;
-            /* We are sure that the difference lies within the int range */
-            return (int) buff_len;
-        } 
+            memcpy(GUTHTHILA_BUFFER_CURRENT_BUFF(wr->buffer), buff + copied,
+                   remain_len);
+            wr->buffer.data_size[wr->buffer.cur_buff] += remain_len;
+            copied += remain_len;
+        }
+        wr->next += (int)buff_len;
+        /* We are sure that the difference lies within the int range */
+        return (int) buff_len;
     }
     else if (wr->type == GUTHTHILA_WRITER_FILE)
     {
@@ -325,163 +362,493 @@ int GUTHTHILA_CALL
 guththila_write_token(guththila_xml_writer_t * wr, guththila_token_t * tok,
                         const axutil_env_t * env) 
 {
-    int i;
-    size_t remain_len = 0;
-    size_t temp = 0;
-    size_t * temp1 = NULL, *temp2 = NULL;
-    guththila_char_t **temp3 = NULL;
+    return guththila_write(wr, tok->start, tok->size, env);
+}
+
+int GUTHTHILA_CALL
+guththila_write_xtoken(guththila_xml_writer_t * wr, guththila_char_t *buff,
+                        size_t buff_len, const axutil_env_t * env) 
+{
     if (wr->type == GUTHTHILA_WRITER_MEMORY)
     {
-        remain_len = wr->buffer.buffs_size[wr->buffer.cur_buff] -
-                     wr->buffer.data_size[wr->buffer.cur_buff];
-        if (tok->size < remain_len)
+        /* Tokens are referenced by position later on, so they must not be
+         * split across two chunks */
+        if (buff_len > GUTHTHILA_BUFFER_CURRENT_BUFF_SIZE(wr->buffer) &&
+            !guththila_writer_next_buffer(wr, buff_len, env))
         {
-            memcpy(wr->buffer.buff[wr->buffer.cur_buff] +
-                    wr->buffer.data_size[wr->buffer.cur_buff], 
-                    tok->start,
-                    tok->size);
-
-            wr->buffer.data_size[wr->buffer.cur_buff] += tok->size;
-            wr->next += (int)tok->size;
-            /* We are sure that the difference lies within the int range */
-            return (int) tok->size;
+            return GUTHTHILA_FAILURE;
         }
-        else
+        memcpy(GUTHTHILA_BUFFER_CURRENT_BUFF(wr->buffer), buff, buff_len);
+        wr->buffer.data_size[wr->buffer.cur_buff] += buff_len;
+        wr->next += (int)buff_len;
+        /* We are sure that the difference lies within the int range */
+        return (int) buff_len;
+    }
+    else if (wr->type == GUTHTHILA_WRITER_FILE)
+    {
+        return (int) fwrite(buff, 1, buff_len, wr->out_stream);
+    }
+    return GUTHTHILA_FAILURE;
+}
+
+/*
+ * Returns the address of the character written at position pos, which
+ * may be in an earlier chunk than the current one.
+ */
+static guththila_char_t *
+guththila_writer_get_position(
+    guththila_xml_writer_t * wr,
+    int pos)
+{
+    int i = wr->buffer.cur_buff;
+    size_t start = wr->buffer.pre_tot_data;
+
+    while ((size_t) pos < start && i > 0)
+    {
+        i--;
+        start -= wr->buffer.data_size[i];
+    }
+    if ((size_t) pos < start)
+    {
+        /* Already flushed */
+        return NULL;
+    }
+    return wr->buffer.buff[i] + ((size_t) pos - start);
+}
+
+#ifdef GUTHTHILA_XML_WRITER_TOKEN
+/*
+ * If tok points into the first count chunks, move it to a copy of its own
+ * so those chunks can be released. The copy is kept until the element at
+ * index depth of the element stack is closed. Names that share the memory
+ * of a namespace prefix are copied by the first flush after the prefix
+ * and point to the copy of the prefix from then on, which the element
+ * declaring the namespace outlives.
+ */
+static int
+guththila_writer_detach_token(
+    guththila_xml_writer_t * wr,
+    guththila_token_t * tok,
+    int count,
+    int depth,
+    const axutil_env_t * env)
+{
+    int i;
+    guththila_writer_detached_t *detached = NULL;
+    guththila_char_t *copy = NULL;
+
+    if (!tok || !tok->start)
+    {
+        return GUTHTHILA_SUCCESS;
+    }
+    for (i = 0; i < count; i++)
+    {
+        if (tok->start >= wr->buffer.buff[i] &&
+            tok->start < wr->buffer.buff[i] + wr->buffer.buffs_size[i])
         {
-            if (remain_len != 0)
+            /* The name is kept right after the entry */
+            detached = (guththila_writer_detached_t *)
+                AXIS2_MALLOC(env->allocator,
+                             sizeof(guththila_writer_detached_t) +
+                             sizeof(guththila_char_t) * (tok->size + 1));
+            if (!detached)
             {
-                memcpy(wr->buffer.buff[wr->buffer.cur_buff] +
-                       wr->buffer.data_size[wr->buffer.cur_buff], 
-                       tok->start,
-                       remain_len);
-
-                wr->buffer.data_size[wr->buffer.cur_buff] += remain_len;
+                return GUTHTHILA_FAILURE;
             }
-            /* We are sure that the difference lies within the int range */
-            if (((int)wr->buffer.no_buffers - 1) == wr->buffer.cur_buff)
+            detached->depth = depth;
+            copy = (guththila_char_t *) (detached + 1);
+            memcpy(copy, tok->start, tok->size);
+            copy[tok->size] = '\0';
+            if (guththila_stack_push(&wr->detached, detached, env) < 0)
             {
-                wr->buffer.no_buffers = wr->buffer.no_buffers * 2;
-                temp3 = (guththila_char_t **) AXIS2_MALLOC(env->allocator,
-                         sizeof(guththila_char_t *) * wr->buffer.no_buffers);
-                temp1 = (size_t *) AXIS2_MALLOC(env->allocator,
-                         sizeof(size_t) * wr->buffer.no_buffers);
-                temp2 = (size_t *) AXIS2_MALLOC(env->allocator,
-                         sizeof(size_t) * wr->buffer.no_buffers);
-                for (i = 0; i <= wr->buffer.cur_buff; i++)
-                {
-                    temp3[i] = wr->buffer.buff[i];
-                    temp1[i] = wr->buffer.data_size[i];
-                    temp2[i] = wr->buffer.buffs_size[i];
-                }
-                AXIS2_FREE(env->allocator, wr->buffer.data_size);
-                AXIS2_FREE(env->allocator, wr->buffer.buffs_size);
-                AXIS2_FREE(env->allocator, wr->buffer.buff);
-                wr->buffer.buff = temp3;
-                wr->buffer.buffs_size = temp2;
-                wr->buffer.data_size = temp1;
+                AXIS2_FREE(env->allocator, detached);
+                return GUTHTHILA_FAILURE;
             }
-            wr->buffer.cur_buff++;
-            temp = wr->buffer.buffs_size[wr->buffer.cur_buff - 1] * 2;
-            while (temp < (tok->size - remain_len))
+            tok->start = copy;
+            return GUTHTHILA_SUCCESS;
+        }
+    }
+    return GUTHTHILA_SUCCESS;
+}
+#endif
+
+static void
+guththila_writer_release_detached(
+    guththila_xml_writer_t * wr,
+    const axutil_env_t * env)
+{
+    int i;
+    int kept = 0;
+    int depth = GUTHTHILA_STACK_SIZE(wr->element);
+    guththila_writer_detached_t *detached = NULL;
+
+    if (wr->type != GUTHTHILA_WRITER_MEMORY)
+    {
+        return;
+    }
+    for (i = 0; i < GUTHTHILA_STACK_SIZE(wr->detached); i++)
+    {
+        detached = (guththila_writer_detached_t *) wr->detached.data[i];
+        if (detached->depth >= depth)
+        {
+            AXIS2_FREE(env->allocator, detached);
+        }
+        else
+        {
+            wr->detached.data[kept++] = detached;
+        }
+    }
+    wr->detached.top = kept;
+}
+
+/*
+ * Hand the first count chunks to the flush function and release them.
+ * Names of the open elements and their namespaces still point into the
+ * chunks, so they are copied out first.
+ */
+static int
+guththila_writer_flush_chunks(
+    guththila_xml_writer_t * wr,
+    int count,
+    const axutil_env_t * env)
+{
+    int i, j;
+    int size;
+    int depth;
+    guththila_xml_writer_element_t * elem = NULL;
+    guththila_xml_writer_namesp_t * namesp = NULL;
+
+    if (count <= 0)
+    {
+        return GUTHTHILA_SUCCESS;
+    }
+#ifdef GUTHTHILA_XML_WRITER_TOKEN
+    size = GUTHTHILA_STACK_SIZE(wr->element);
+    for (i = 0; i < size; i++)
+    {
+        elem = (guththila_xml_writer_element_t *)
+            guththila_stack_get_by_index(&wr->element, i, env);
+        if (!guththila_writer_detach_token(wr, elem->prefix, count, i, env) ||
+            !guththila_writer_detach_token(wr, elem->name, count, i, env))
+        {
+            return GUTHTHILA_FAILURE;
+        }
+    }
+    size = GUTHTHILA_STACK_SIZE(wr->namesp);
+    for (i = 0; i < size; i++)
+    {
+        namesp = (guththila_xml_writer_namesp_t *)
+            guththila_stack_get_by_index(&wr->namesp, i, env);
+        /* The namespaces are cleared with the innermost element whose
+           own namespaces start at or below them */
+        depth = GUTHTHILA_STACK_SIZE(wr->element) - 1;
+        while (depth > 0)
+        {
+            elem = (guththila_xml_writer_element_t *)
+                guththila_stack_get_by_index(&wr->element, depth, env);
+            if (elem->name_sp_stack_no != -1 && elem->name_sp_stack_no <= i)
+            {
+                break;
+            }
+            depth--;
+        }
+        for (j = 0; j < namesp->no; j++)
+        {
+            if (!guththila_writer_detach_token(wr, namesp->name[j], count,
+                                               depth, env) ||
+                !guththila_writer_detach_token(wr, namesp->uri[j], count,
+                                               depth, env))
             {
-                temp = temp * 2;
+                return GUTHTHILA_FAILURE;
             }
-            wr->buffer.buff[wr->buffer.cur_buff] =
-                (guththila_char_t *) AXIS2_MALLOC(env->allocator, 
-                                         sizeof(guththila_char_t) * temp);
-
-            wr->buffer.buffs_size[wr->buffer.cur_buff] = temp;
-            memcpy(wr->buffer.buff[wr->buffer.cur_buff],
-                    tok->start + remain_len, tok->size - remain_len);
-            wr->buffer.data_size[wr->buffer.cur_buff] = tok->size - remain_len;
-            wr->buffer.pre_tot_data += wr->buffer.data_size[wr->buffer.cur_buff - 1];
-            wr->next += (int)tok->size;
-            /* We are sure that the difference lies within the int range */
-            return (int) tok->size;
-        } 
+        }
     }
-    else if (wr->type == GUTHTHILA_WRITER_FILE)
+#endif
+    for (i = 0; i < count; i++)
     {
-        return (int) fwrite(tok->start, 1, tok->size, wr->out_stream);
+        if (wr->buffer.data_size[i] > 0 &&
+            wr->flush_func(wr->buffer.buff[i], wr->buffer.data_size[i],
+                           wr->flush_ctx) != GUTHTHILA_SUCCESS)
+        {
+            return GUTHTHILA_FAILURE;
+        }
+        wr->flushed += wr->buffer.data_size[i];
+        if (i == wr->buffer.cur_buff)
+        {
+            /* The current chunk is emptied and reused */
+            wr->buffer.pre_tot_data += wr->buffer.data_size[i];
+            wr->buffer.data_size[i] = 0;
+            wr->buffer.buff[0] = wr->buffer.buff[i];
+            wr->buffer.data_size[0] = 0;
+            wr->buffer.buffs_size[0] = wr->buffer.buffs_size[i];
+            wr->buffer.cur_buff = 0;
+            return GUTHTHILA_SUCCESS;
+        }
+        AXIS2_FREE(env->allocator, wr->buffer.buff[i]);
     }
-    return GUTHTHILA_FAILURE;
+    for (i = count; i <= wr->buffer.cur_buff; i++)
+    {
+        wr->buffer.buff[i - count] = wr->buffer.buff[i];
+        wr->buffer.data_size[i - count] = wr->buffer.data_size[i];
+        wr->buffer.buffs_size[i - count] = wr->buffer.buffs_size[i];
+    }
+    wr->buffer.cur_buff -= count;
+    return GUTHTHILA_SUCCESS;
 }
 
-int GUTHTHILA_CALL
-guththila_write_xtoken(guththila_xml_writer_t * wr, guththila_char_t *buff,
-                        size_t buff_len, const axutil_env_t * env) 
+/*
+ * In flush mode, hand every chunk but the current one to the flush
+ * function. Only called on entry to the public writing functions, where
+ * no position of a name being written is pending.
+ */
+static int
+guththila_writer_flush_full_chunks(
+    guththila_xml_writer_t * wr,
+    const axutil_env_t * env)
+{
+    if (wr->type != GUTHTHILA_WRITER_MEMORY || !wr->flush_func ||
+        wr->buffer.cur_buff == 0)
+    {
+        return GUTHTHILA_SUCCESS;
+    }
+    return guththila_writer_flush_chunks(wr, wr->buffer.cur_buff, env);
+}
+
+/*
+ * Move the memory writer to a new chunk that can hold at least min_size
+ * characters. The rest of the current chunk is left unused. Chunks are
+ * GUTHTHILA_BUFFER_DEF_SIZE long. Only a name longer than that, which
+ * cannot be split, gets a chunk of its own size.
+ */
+static int
+guththila_writer_next_buffer(
+    guththila_xml_writer_t * wr,
+    size_t min_size,
+    const axutil_env_t * env)
 {
     int i;
     size_t temp = 0;
-    size_t remain_len = 0;
     size_t * temp1 = NULL, *temp2 = NULL;
     guththila_char_t **temp3 = NULL;
-    if (wr->type == GUTHTHILA_WRITER_MEMORY)
+    guththila_char_t *new_buff = NULL;
+
+    /* We are sure that the difference lies within the int range */
+    if (((int)wr->buffer.no_buffers - 1) == wr->buffer.cur_buff)
+    {
+        /* Out of allocated array buffers. Need to allocate*/
+        temp3 = (guththila_char_t **) AXIS2_MALLOC(env->allocator,
+                 sizeof(guththila_char_t *) * wr->buffer.no_buffers * 2);
+        temp1 = (size_t *) AXIS2_MALLOC(env->allocator,
+                 sizeof(size_t) * wr->buffer.no_buffers * 2);
+        temp2 = (size_t *) AXIS2_MALLOC(env->allocator,
+                 sizeof(size_t) * wr->buffer.no_buffers * 2);
+        if (!temp1 || !temp2 || !temp3)
+        {
+            if (temp1)
+                AXIS2_FREE(env->allocator, temp1);
+            if (temp2)
+                AXIS2_FREE(env->allocator, temp2);
+            if (temp3)
+                AXIS2_FREE(env->allocator, temp3);
+            return GUTHTHILA_FAILURE;
+        }
+        for (i = 0; i <= wr->buffer.cur_buff; i++)
+        {
+            temp3[i] = wr->buffer.buff[i];
+            temp1[i] = wr->buffer.data_size[i];
+            temp2[i] = wr->buffer.buffs_size[i];
+        }
+        AXIS2_FREE(env->allocator, wr->buffer.data_size);
+        AXIS2_FREE(env->allocator, wr->buffer.buffs_size);
+        AXIS2_FREE(env->allocator, wr->buffer.buff);
+        wr->buffer.buff = temp3;
+        wr->buffer.buffs_size = temp2;
+        wr->buffer.data_size = temp1;
+        wr->buffer.no_buffers = wr->buffer.no_buffers * 2;
+    }
+    temp = (min_size > GUTHTHILA_BUFFER_DEF_SIZE) ?
+        min_size : GUTHTHILA_BUFFER_DEF_SIZE;
+    new_buff = (guththila_char_t *) AXIS2_MALLOC(env->allocator,
+                                    sizeof(guththila_char_t) * temp);
+    if (!new_buff)
     {
-        remain_len = wr->buffer.buffs_size[wr->buffer.cur_buff] -
-                     wr->buffer.data_size[wr->buffer.cur_buff];
-        if (buff_len < remain_len)
+        return GUTHTHILA_FAILURE;
+    }
+    wr->buffer.cur_buff++;
+    wr->buffer.buff[wr->buffer.cur_buff] = new_buff;
+    wr->buffer.buffs_size[wr->buffer.cur_buff] = temp;
+    wr->buffer.data_size[wr->buffer.cur_buff] = 0;
+    wr->buffer.pre_tot_data += wr->buffer.data_size[wr->buffer.cur_buff - 1];
+    return GUTHTHILA_SUCCESS;
+}
+
+/*
+ * Returns the index of the first character in buff that must be escaped,
+ * or len if there is none.
+ */
+static size_t
+guththila_escape_scan(
+    const guththila_char_t *buff,
+    size_t len)
+{
+    size_t i = 0;
+#ifdef GUTHTHILA_WRITER_SSE2
+    __m128i in;
+    __m128i hit;
+    int mask;
+
+    for (; i + 16 <= len; i += 16)
+    {
+        in = _mm_loadu_si128((const __m128i *) (buff + i));
+        hit = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('<')),
+                         _mm_cmpeq_epi8(in, _mm_set1_epi8('>'))),
+            _mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('&')),
+                _mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('"')),
+                             _mm_cmpeq_epi8(in, _mm_set1_epi8('\'')))));
+        mask = _mm_movemask_epi8(hit);
+        if (mask)
         {
-            memcpy(wr->buffer.buff[wr->buffer.cur_buff] +
-                    wr->buffer.data_size[wr->buffer.cur_buff], buff, buff_len);
-            wr->buffer.data_size[wr->buffer.cur_buff] += buff_len;
-            wr->next += (int)buff_len;
-            /* We are sure that the difference lies within the int range */
-            return (int) buff_len;
+            return i + (size_t) __builtin_ctz((unsigned int) mask);
         }
-        else
+    }
+#endif
+    for (; i < len; i++)
+    {
+        switch (buff[i])
         {
-            /* We are sure that the difference lies within the int range */
-            if (((int)wr->buffer.no_buffers - 1) == wr->buffer.cur_buff)
+        case '<':
+        case '>':
+        case '&':
+        case '"':
+        case '\'':
+            return i;
+        default:
+            break;
+        }
+    }
+    return len;
+}
+
+/*
+ * Returns the replacement for a character reported by guththila_escape_scan
+ * and its length in esc_len.
+ */
+static const guththila_char_t *
+guththila_escape_string(
+    guththila_char_t ch,
+    size_t *esc_len)
+{
+    switch (ch)
+    {
+    case '>':
+        *esc_len = 4;
+        return "&gt;";
+    case '<':
+        *esc_len = 4;
+        return "&lt;";
+    case '\'':
+        *esc_len = 6;
+        return "&apos;";
+    case '"':
+        *esc_len = 6;
+        return "&quot;";
+    default:
+        *esc_len = 5;
+        return "&amp;";
+    }
+}
+
+static int GUTHTHILA_CALL
+guththila_write_escaped(
+    guththila_xml_writer_t * wr,
+    guththila_char_t *buff,
+    size_t len,
+    const axutil_env_t * env)
+{
+    size_t i = 0;
+    size_t run = 0;
+    size_t esc_len = 0;
+    size_t remain_len = 0;
+    const guththila_char_t *esc = NULL;
+    guththila_char_t *out = NULL;
+    guththila_char_t *out_start = NULL;
+
+    if (wr->type == GUTHTHILA_WRITER_FILE)
+    {
+        while (len > 0)
+        {
+            i = guththila_escape_scan(buff, len);
+            if (i > 0 && fwrite(buff, 1, i, wr->out_stream) != i)
             {
-                wr->buffer.no_buffers = wr->buffer.no_buffers * 2;
-                temp3 = (guththila_char_t **) AXIS2_MALLOC(env->allocator,
-                                           sizeof(guththila_char_t *) *
-                                           wr->buffer.no_buffers);
-                temp1 = (size_t *) AXIS2_MALLOC(env->allocator,
-                                            sizeof(size_t) *
-                                            wr->buffer.no_buffers);
-                temp2 = (size_t *) AXIS2_MALLOC(env->allocator,
-                                            sizeof(size_t) *
-                                            wr->buffer.no_buffers);
-                for (i = 0; i <= wr->buffer.cur_buff; i++)
+                return GUTHTHILA_FAILURE;
+            }
+            buff += i;
+            len -= i;
+            if (len > 0)
+            {
+                esc = guththila_escape_string(*buff, &esc_len);
+                if (fwrite(esc, 1, esc_len, wr->out_stream) != esc_len)
                 {
-                    temp3[i] = wr->buffer.buff[i];
-                    temp1[i] = wr->buffer.data_size[i];
-                    temp2[i] = wr->buffer.buffs_size[i];
+                    return GUTHTHILA_FAILURE;
                 }
-                AXIS2_FREE(env->allocator, wr->buffer.data_size);
-                AXIS2_FREE(env->allocator, wr->buffer.buffs_size);
-                AXIS2_FREE(env->allocator, wr->buffer.buff);
-                wr->buffer.buff = temp3;
-                wr->buffer.buffs_size = temp2;
-                wr->buffer.data_size = temp1;
+                buff++;
+                len--;
             }
-            temp = wr->buffer.buffs_size[wr->buffer.cur_buff] * 2;
-            while (temp < (buff_len))
+        }
+        return GUTHTHILA_SUCCESS;
+    }
+    else if (wr->type != GUTHTHILA_WRITER_MEMORY)
+    {
+        return GUTHTHILA_FAILURE;
+    }
+
+    while (len > 0)
+    {
+        /* Take a run of input that fits the rest of the chunk even if every
+         * character in it has to be escaped, so the run is written without
+         * further checks. A new chunk is only started when the rest is too
+         * short to be worth it, and has the default size */
+        run = (len < GUTHTHILA_ESCAPE_MAX_RUN) ? len : GUTHTHILA_ESCAPE_MAX_RUN;
+        remain_len = wr->buffer.buffs_size[wr->buffer.cur_buff] -
+                     wr->buffer.data_size[wr->buffer.cur_buff];
+        if (remain_len / GUTHTHILA_ESCAPE_MAX_LEN <
+            ((run < GUTHTHILA_ESCAPE_MIN_RUN) ? run : GUTHTHILA_ESCAPE_MIN_RUN))
+        {
+            if (!guththila_writer_next_buffer(wr, 0, env))
             {
-                temp = temp * 2;
+                return GUTHTHILA_FAILURE;
             }
-            wr->buffer.cur_buff++;
-            wr->buffer.buff[wr->buffer.cur_buff] =
-                (guththila_char_t *) AXIS2_MALLOC(env->allocator, 
-                                    sizeof(guththila_char_t) * temp);
+            remain_len = wr->buffer.buffs_size[wr->buffer.cur_buff];
+        }
+        if (run > remain_len / GUTHTHILA_ESCAPE_MAX_LEN)
+        {
+            run = remain_len / GUTHTHILA_ESCAPE_MAX_LEN;
+        }
 
-            wr->buffer.buffs_size[wr->buffer.cur_buff] = temp;
-            memcpy(wr->buffer.buff[wr->buffer.cur_buff], buff, buff_len);
-            wr->buffer.data_size[wr->buffer.cur_buff] = buff_len;
-            wr->buffer.pre_tot_data +=
-                wr->buffer.data_size[wr->buffer.cur_buff - 1];
-            wr->next += (int)buff_len;
-            /* We are sure that the difference lies within the int range */
-            return (int) buff_len;
-        } 
-    }
-    else if (wr->type == GUTHTHILA_WRITER_FILE)
-    {
-        return (int) fwrite(buff, 1, buff_len, wr->out_stream);
+        out_start = out = GUTHTHILA_BUFFER_CURRENT_BUFF(wr->buffer);
+        len -= run;
+        while (run > 0)
+        {
+            i = guththila_escape_scan(buff, run);
+            memcpy(out, buff, i);
+            out += i;
+            buff += i;
+            run -= i;
+            if (run > 0)
+            {
+                esc = guththila_escape_string(*buff, &esc_len);
+                memcpy(out, esc, esc_len);
+                out += esc_len;
+                buff++;
+                run--;
+            }
+        }
+        wr->buffer.data_size[wr->buffer.cur_buff] += (size_t)(out - out_start);
+        wr->next += (int)(out - out_start);
+        /* We are sure that the difference lies within the int range */
     }
-    return GUTHTHILA_FAILURE;
+    return GUTHTHILA_SUCCESS;
 }
 
 int GUTHTHILA_CALL 
@@ -596,7 +963,7 @@ guththila_write_start_element(guththila_xml_writer_t * wr,
     element->prefix = NULL;    
 #else  
     element->name = guththila_tok_list_get_token(&wr->tok_list, env);
-    element->name->start = GUTHTHILA_BUF_POS(wr->buffer, cur_pos);
+    element->name->start = guththila_writer_get_position(wr, cur_pos);
     element->name->size = len;
     element->prefix = NULL;
     
@@ -611,6 +978,10 @@ guththila_write_end_element(guththila_xml_writer_t * wr, const axutil_env_t * en
     guththila_xml_writer_element_t * elem = NULL;
     guththila_xml_writer_namesp_t * namesp = NULL;
     int i = 0, j = 0;
+    if (!guththila_writer_flush_full_chunks(wr, env))
+    {
+        return GUTHTHILA_FAILURE;
+    }
     if (wr->status == START)
     {
         guththila_write(wr, "></", 3u, env);
@@ -727,9 +1098,11 @@ GUTHTHILA_EXPORT int GUTHTHILA_CALL
 guththila_write_characters(guththila_xml_writer_t * wr, guththila_char_t *buff,
                            const axutil_env_t * env) 
 {
-    size_t i = 0;
     size_t len = strlen(buff);
-    guththila_char_t ch = 0;
+    if (!guththila_writer_flush_full_chunks(wr, env))
+    {
+        return GUTHTHILA_FAILURE;
+    }
     if (wr->status == START)
     {
         wr->status = BEGINING;
@@ -745,31 +1118,7 @@ guththila_write_characters(guththila_xml_writer_t * wr, guththila_char_t *buff,
     {
         return GUTHTHILA_FAILURE;
     }
-    while (len > 0)
-    {
-        /* scan buffer until the next special character */
-        for (i = 0; 
-            (i < len) && ((ch = buff[i]) != '&') && (ch != '<') && (ch != '>') && (ch != '\"') && (ch != '\'');
-            i++)
-            ;
-        /* write everything until the special character */
-        if (i > 0)
-        {
-            guththila_write(wr, buff, i, env);
-            buff += i;
-            len -= i;
-        }
-        /* replace the character with the appropriate sequence */
-        if (len > 0)
-        {
-            if (AXIS2_SUCCESS != guththila_write_escape_character(wr, buff, env))
-                return GUTHTHILA_FAILURE;
-            /* skip the character */
-            buff++;
-            len--;
-        }
-    }
-    return GUTHTHILA_SUCCESS;
+    return guththila_write_escaped(wr, buff, len, env);
 }
 
 GUTHTHILA_EXPORT int GUTHTHILA_CALL 
@@ -778,6 +1127,10 @@ guththila_write_comment(
     guththila_char_t *buff,
     const axutil_env_t * env) 
 {
+    if (!guththila_writer_flush_full_chunks(wr, env))
+    {
+        return GUTHTHILA_FAILURE;
+    }
     if (wr->status == START)
     {
         wr->status = BEGINING;
@@ -879,7 +1232,7 @@ guththila_write_empty_element(guththila_xml_writer_t * wr,
     element->prefix = NULL;    
 #else  
     element->name = guththila_tok_list_get_token(&wr->tok_list, env);
-    element->name->start = GUTHTHILA_BUF_POS(wr->buffer, cur_pos);
+    element->name->start = guththila_writer_get_position(wr, cur_pos);
     element->name->size = len;
     element->prefix = NULL;
     
@@ -989,12 +1342,12 @@ guththila_write_namespace(
                 namesp->name[0] =
                     guththila_tok_list_get_token(&wr->tok_list, env);
                 namesp->name[0]->start =
-                    GUTHTHILA_BUF_POS(wr->buffer, pref_start);
+                    guththila_writer_get_position(wr, pref_start);
                 namesp->name[0]->size = pref_len;
                 namesp->uri[0] =
                     guththila_tok_list_get_token(&wr->tok_list, env);
                 namesp->uri[0]->start =
-                    GUTHTHILA_BUF_POS(wr->buffer, uri_start);
+                    guththila_writer_get_position(wr, uri_start);
                 namesp->uri[0]->size = uri_len;
                 
 #endif  
@@ -1024,10 +1377,10 @@ guththila_write_namespace(
                 namesp->uri[namesp->no - 1] =
                     guththila_tok_list_get_token(&wr->tok_list, env);
                 namesp->name[namesp->no - 1]->start =
-                    GUTHTHILA_BUF_POS(wr->buffer, pref_start);
+                    guththila_writer_get_position(wr, pref_start);
                 namesp->name[namesp->no - 1]->size = pref_len;
                 namesp->uri[namesp->no - 1]->start =
-                    GUTHTHILA_BUF_POS(wr->buffer, uri_start);
+                    guththila_writer_get_position(wr, uri_start);
                 namesp->uri[namesp->no - 1]->size = uri_len;
                 
 #endif  
@@ -1078,10 +1431,10 @@ guththila_write_namespace(
                     guththila_tok_list_get_token(&wr->tok_list, env);
 
                 namesp->name[namesp->no ]->start =
-                    GUTHTHILA_BUF_POS(wr->buffer, pref_start);
+                    guththila_writer_get_position(wr, pref_start);
                 namesp->name[namesp->no ]->size = pref_len;
                 namesp->uri[namesp->no ]->start =
-                    GUTHTHILA_BUF_POS(wr->buffer, uri_start);
+                    guththila_writer_get_position(wr, uri_start);
                 namesp->uri[namesp->no ]->size = uri_len;
                 namesp->no ++;
 #endif  
@@ -1377,10 +1730,10 @@ guththila_write_start_element_with_prefix_and_namespace(
                                                     *
                                                     GUTHTHILA_XML_WRITER_NAMESP_DEF_SIZE);
             namesp->name[0] = guththila_tok_list_get_token(&wr->tok_list, env);
-            namesp->name[0]->start = GUTHTHILA_BUF_POS(wr->buffer, pref_start);
+            namesp->name[0]->start = guththila_writer_get_position(wr, pref_start);
             namesp->name[0]->size = pref_len;
             namesp->uri[0] = guththila_tok_list_get_token(&wr->tok_list, env);
-            namesp->uri[0]->start = GUTHTHILA_BUF_POS(wr->buffer, uri_start);
+            namesp->uri[0]->start = guththila_writer_get_position(wr, uri_start);
             namesp->uri[0]->size = uri_len;            
 #endif  
             namesp->no = 1;
@@ -1395,9 +1748,9 @@ guththila_write_start_element_with_prefix_and_namespace(
 #else   
         elem->name = guththila_tok_list_get_token(&wr->tok_list, env);
         elem->prefix = guththila_tok_list_get_token(&wr->tok_list, env);
-        elem->name->start = GUTHTHILA_BUF_POS(wr->buffer, elem_start);
+        elem->name->start = guththila_writer_get_position(wr, elem_start);
         elem->name->size = elem_len;
-        elem->prefix->start = GUTHTHILA_BUF_POS(wr->buffer, elem_pref_start);
+        elem->prefix->start = guththila_writer_get_position(wr, elem_pref_start);
         elem->prefix->size = pref_len;        
 #endif           
         guththila_stack_push(&wr->element, elem, env);
@@ -1502,7 +1855,7 @@ guththila_write_start_element_with_namespace(
         guththila_tok_list_get_token(&wr->tok_list, env);
     element->name->size = elem_len;
     element->name->start =
-        GUTHTHILA_BUF_POS(wr->buffer, elem_start);
+        guththila_writer_get_position(wr, elem_start);
     if (writer_namesp && (j < writer_namesp->no))
     {
         element->prefix =
@@ -1601,7 +1954,7 @@ guththila_write_start_element_with_prefix(
                     guththila_tok_list_get_token(&wr->tok_list, env);
                 element->name->size = elem_len;
                 element->name->start =
-                    GUTHTHILA_BUF_POS(wr->buffer, elem_start);
+                    guththila_writer_get_position(wr, elem_start);
                 element->prefix =
                     guththila_tok_list_get_token(&wr->tok_list, env);
                 element->prefix->size = writer_namesp->name[j]->size;
@@ -1766,10 +2119,10 @@ guththila_write_empty_element_with_prefix_and_namespace(
                                                     *
                                                     GUTHTHILA_XML_WRITER_NAMESP_DEF_SIZE);
             namesp->name[0] = guththila_tok_list_get_token(&wr->tok_list, env);
-            namesp->name[0]->start = GUTHTHILA_BUF_POS(wr->buffer, pref_start);
+            namesp->name[0]->start = guththila_writer_get_position(wr, pref_start);
             namesp->name[0]->size = pref_len;
             namesp->uri[0] = guththila_tok_list_get_token(&wr->tok_list, env);
-            namesp->uri[0]->start = GUTHTHILA_BUF_POS(wr->buffer, uri_start);
+            namesp->uri[0]->start = guththila_writer_get_position(wr, uri_start);
             namesp->uri[0]->size = uri_len;            
 #endif  
             namesp->no = 1;
@@ -1784,9 +2137,9 @@ guththila_write_empty_element_with_prefix_and_namespace(
 #else   
         elem->name = guththila_tok_list_get_token(&wr->tok_list, env);
         elem->prefix = guththila_tok_list_get_token(&wr->tok_list, env);
-        elem->name->start = GUTHTHILA_BUF_POS(wr->buffer, elem_start);
+        elem->name->start = guththila_writer_get_position(wr, elem_start);
         elem->name->size = elem_len;
-        elem->prefix->start = GUTHTHILA_BUF_POS(wr->buffer, elem_pref_start);
+        elem->prefix->start = guththila_writer_get_position(wr, elem_pref_start);
         elem->prefix->size = pref_len;        
 #endif           
         guththila_stack_push(&wr->element, elem, env);
@@ -1887,7 +2240,7 @@ guththila_write_empty_element_with_namespace(
         guththila_tok_list_get_token(&wr->tok_list, env);
     element->name->size = elem_len;
     element->name->start =
-        GUTHTHILA_BUF_POS(wr->buffer, elem_start);
+        guththila_writer_get_position(wr, elem_start);
     if (writer_namesp && (j < writer_namesp->no))
     {
         element->prefix =
@@ -1986,7 +2339,7 @@ guththila_write_empty_element_with_prefix(
                     guththila_tok_list_get_token(&wr->tok_list, env);
                 element->name->size = elem_len;
                 element->name->start =
-                    GUTHTHILA_BUF_POS(wr->buffer, elem_start);
+                    guththila_writer_get_position(wr, elem_start);
                 element->prefix =
                     guththila_tok_list_get_token(&wr->tok_list, env);
                 element->prefix->size = writer_namesp->name[j]->size;
@@ -2056,7 +2409,7 @@ guththila_get_memory_buffer_size(
     if (wr->type == GUTHTHILA_WRITER_MEMORY)
     {
         return (unsigned int)(wr->buffer.pre_tot_data +
-            wr->buffer.data_size[wr->buffer.cur_buff]);
+            wr->buffer.data_size[wr->buffer.cur_buff] - wr->flushed);
     }
     return 0;
 }
@@ -2100,6 +2453,10 @@ guththila_write_to_buffer(
     int size,
     const axutil_env_t * env) 
 {
+    if (!guththila_writer_flush_full_chunks(wr, env))
+    {
+        return GUTHTHILA_FAILURE;
+    }
     /* Just write what ever given. But need to close things before */
     if(wr->status == START)
     {
@@ -2114,5 +2471,61 @@ guththila_write_to_buffer(
     return GUTHTHILA_SUCCESS;
 }
 
+GUTHTHILA_EXPORT int GUTHTHILA_CALL 
+guththila_xml_writer_set_flush(
+    guththila_xml_writer_t * wr,
+    GUTHTHILA_WRITER_FLUSH_FUNC func,
+    void *ctx,
+    const axutil_env_t * env) 
+{
+    if (wr->type != GUTHTHILA_WRITER_MEMORY)
+    {
+        return GUTHTHILA_FAILURE;
+    }
+    wr->flush_func = func;
+    wr->flush_ctx = ctx;
+    return GUTHTHILA_SUCCESS;
+}
 
+GUTHTHILA_EXPORT int GUTHTHILA_CALL 
+guththila_xml_writer_flush(
+    guththila_xml_writer_t * wr,
+    const axutil_env_t * env) 
+{
+    if (wr->type != GUTHTHILA_WRITER_MEMORY || !wr->flush_func)
+    {
+        return GUTHTHILA_FAILURE;
+    }
+    /* The current chunk goes out as well but its memory is kept for what
+     * is written next */
+    return guththila_writer_flush_chunks(wr, wr->buffer.cur_buff + 1, env);
+}
 
+GUTHTHILA_EXPORT int GUTHTHILA_CALL 
+guththila_get_memory_chunk_count(
+    guththila_xml_writer_t * wr,
+    const axutil_env_t * env) 
+{
+    if (wr->type == GUTHTHILA_WRITER_MEMORY)
+    {
+        return wr->buffer.cur_buff + 1;
+    }
+    return 0;
+}
+
+GUTHTHILA_EXPORT guththila_char_t *GUTHTHILA_CALL 
+guththila_get_memory_chunk(
+    guththila_xml_writer_t * wr,
+    int index,
+    size_t *size,
+    const axutil_env_t * env) 
+{
+    if (wr->type != GUTHTHILA_WRITER_MEMORY || index < 0 ||
+        index > wr->buffer.cur_buff)
+    {
+        *size = 0;
+        return NULL;
+    }
+    *size = wr->buffer.data_size[index];
+    return wr->buffer.buff[index];
+}
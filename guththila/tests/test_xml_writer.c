@@ -0,0 +1,247 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <axutil_env.h>
+#include <guththila_xml_writer.h>
+
+/* Output of a test, built the way the writer is expected to write it */
+typedef struct test_output
+{
+    char *data;
+    size_t len;
+    size_t size;
+} test_output_t;
+
+static int failures = 0;
+
+static void
+test_output_append(
+    test_output_t * out,
+    const char *data,
+    size_t len)
+{
+    if (out->len + len + 1 > out->size)
+    {
+        out->size = (out->len + len + 1) * 2;
+        out->data = (char *) realloc(out->data, out->size);
+    }
+    memcpy(out->data + out->len, data, len);
+    out->len += len;
+    out->data[out->len] = '\0';
+}
+
+static void
+test_output_append_escaped(
+    test_output_t * out,
+    const char *text)
+{
+    for (; *text; text++)
+    {
+        switch (*text)
+        {
+        case '<':
+            test_output_append(out, "&lt;", 4);
+            break;
+        case '>':
+            test_output_append(out, "&gt;", 4);
+            break;
+        case '&':
+            test_output_append(out, "&amp;", 5);
+            break;
+        case '"':
+            test_output_append(out, "&quot;", 6);
+            break;
+        case '\'':
+            test_output_append(out, "&apos;", 6);
+            break;
+        default:
+            test_output_append(out, text, 1);
+            break;
+        }
+    }
+}
+
+static void
+test_check(
+    const char *test_name,
+    int cond,
+    const char *what)
+{
+    if (!cond)
+    {
+        printf("%s: FAILED, %s\n", test_name, what);
+        failures++;
+    }
+}
+
+/* Reassembles the chunks of the memory writer and compares them, and the
+ * single buffer, with the expected output. Escaped text never makes a
+ * chunk grow past the default size */
+static void
+test_check_chunks(
+    const char *test_name,
+    guththila_xml_writer_t * wr,
+    test_output_t * expected,
+    int min_chunks,
+    const axutil_env_t * env)
+{
+    test_output_t got = { NULL, 0, 0 };
+    int count = guththila_get_memory_chunk_count(wr, env);
+    int i;
+    char *chunk = NULL;
+    size_t size = 0;
+
+    test_check(test_name, count >= min_chunks, "too few chunks");
+    for (i = 0; i < count; i++)
+    {
+        chunk = guththila_get_memory_chunk(wr, i, &size, env);
+        test_check(test_name, chunk != NULL, "chunk missing");
+        if (chunk)
+        {
+            test_output_append(&got, chunk, size);
+        }
+        test_check(test_name, size <= GUTHTHILA_BUFFER_DEF_SIZE,
+                   "chunk larger than the default size");
+    }
+    test_check(test_name,
+               guththila_get_memory_chunk(wr, count, &size, env) == NULL,
+               "chunk past the last one");
+    test_check(test_name, got.len == expected->len &&
+               memcmp(got.data, expected->data, got.len) == 0,
+               "chunks differ from the expected output");
+    test_check(test_name,
+               guththila_get_memory_buffer_size(wr, env) == expected->len &&
+               memcmp(guththila_get_memory_buffer(wr, env), expected->data,
+                      expected->len) == 0,
+               "buffer differs from the expected output");
+    free(got.data);
+}
+
+/* Text with escapable characters just before, across and just after the
+ * end of the first chunk */
+static void
+test_escape_at_chunk_boundary(
+    const axutil_env_t * env)
+{
+    static char special[] = "<&>\"'";
+    int shift;
+    char *text = NULL;
+    size_t filler;
+
+    for (shift = -8; shift <= 8; shift++)
+    {
+        guththila_xml_writer_t *wr =
+            guththila_create_xml_stream_writer_for_memory(env);
+        test_output_t expected = { NULL, 0, 0 };
+
+        /* "<a>" and the filler end shift characters before the end of the
+           first chunk */
+        filler = GUTHTHILA_BUFFER_DEF_SIZE - 3 - 8 + shift;
+        text = (char *) malloc(filler + 1);
+        memset(text, 'x', filler);
+        text[filler] = '\0';
+
+        guththila_write_start_element(wr, "a", env);
+        guththila_write_characters(wr, text, env);
+        guththila_write_characters(wr, special, env);
+        guththila_write_end_element(wr, env);
+
+        test_output_append(&expected, "<a>", 3);
+        test_output_append(&expected, text, filler);
+        test_output_append_escaped(&expected, special);
+        test_output_append(&expected, "</a>", 4);
+        test_check_chunks("test_escape_at_chunk_boundary", wr, &expected, 1,
+                          env);
+
+        free(text);
+        free(expected.data);
+        guththila_xml_writer_free(wr, env);
+    }
+    printf("test_escape_at_chunk_boundary: done\n");
+}
+
+/* Runs longer than the 4096 characters escaped after one check of the
+ * room left, both with few and with only escapable characters */
+static void
+test_escape_long_runs(
+    const axutil_env_t * env)
+{
+    static const size_t lengths[] = { 4095, 4096, 4097, 3 * 4096 + 100,
+                                      5 * GUTHTHILA_BUFFER_DEF_SIZE };
+    size_t i, j;
+    char *text = NULL;
+
+    for (i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+    {
+        guththila_xml_writer_t *wr =
+            guththila_create_xml_stream_writer_for_memory(env);
+        test_output_t expected = { NULL, 0, 0 };
+
+        text = (char *) malloc(lengths[i] + 1);
+        test_output_append(&expected, "<a>", 3);
+        guththila_write_start_element(wr, "a", env);
+
+        /* mostly clean, an escapable character every 7 */
+        for (j = 0; j < lengths[i]; j++)
+        {
+            text[j] = (j % 7 == 6) ? "<&>\"'"[j % 5] : (char) ('a' + j % 26);
+        }
+        text[lengths[i]] = '\0';
+        guththila_write_characters(wr, text, env);
+        test_output_append_escaped(&expected, text);
+
+        /* escapable only, each six characters long when escaped */
+        memset(text, '\'', lengths[i]);
+        guththila_write_characters(wr, text, env);
+        test_output_append_escaped(&expected, text);
+
+        guththila_write_end_element(wr, env);
+        test_output_append(&expected, "</a>", 4);
+        test_check_chunks("test_escape_long_runs", wr, &expected,
+                          lengths[i] > GUTHTHILA_BUFFER_DEF_SIZE / 6 ? 2 : 1,
+                          env);
+
+        free(text);
+        free(expected.data);
+        guththila_xml_writer_free(wr, env);
+    }
+    printf("test_escape_long_runs: done\n");
+}
+
+int
+main(
+    int argc,
+    char *argv[])
+{
+    axutil_allocator_t *allocator = axutil_allocator_init(NULL);
+    axutil_env_t *env = axutil_env_create(allocator);
+
+    test_escape_at_chunk_boundary(env);
+    test_escape_long_runs(env);
+
+    axutil_env_free(env);
+    if (failures)
+    {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,273 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <axutil_env.h>
+#include <guththila_xml_writer.h>
+
+/* Output of a test, built the way the writer is expected to write it */
+typedef struct test_output
+{
+    char *data;
+    size_t len;
+    size_t size;
+} test_output_t;
+
+static int failures = 0;
+
+static void
+test_output_append(
+    test_output_t * out,
+    const char *data,
+    size_t len)
+{
+    if (out->len + len + 1 > out->size)
+    {
+        out->size = (out->len + len + 1) * 2;
+        out->data = (char *) realloc(out->data, out->size);
+    }
+    memcpy(out->data + out->len, data, len);
+    out->len += len;
+    out->data[out->len] = '\0';
+}
+
+static int GUTHTHILA_CALL
+test_collect(
+    const guththila_char_t * data,
+    size_t len,
+    void *ctx)
+{
+    test_output_append((test_output_t *) ctx, data, len);
+    return GUTHTHILA_SUCCESS;
+}
+
+static void
+test_check(
+    const char *test_name,
+    int cond,
+    const char *what)
+{
+    if (!cond)
+    {
+        printf("%s: FAILED, %s\n", test_name, what);
+        failures++;
+    }
+}
+
+/* Reassembles the chunks of the memory writer and compares them, and the
+ * single buffer, with the expected output. No chunk is larger than the
+ * default size */
+static void
+test_check_chunks(
+    const char *test_name,
+    guththila_xml_writer_t * wr,
+    test_output_t * expected,
+    int min_chunks,
+    const axutil_env_t * env)
+{
+    test_output_t got = { NULL, 0, 0 };
+    int count = guththila_get_memory_chunk_count(wr, env);
+    int i;
+    char *chunk = NULL;
+    size_t size = 0;
+
+    test_check(test_name, count >= min_chunks, "too few chunks");
+    for (i = 0; i < count; i++)
+    {
+        chunk = guththila_get_memory_chunk(wr, i, &size, env);
+        test_check(test_name, chunk != NULL, "chunk missing");
+        if (chunk)
+        {
+            test_output_append(&got, chunk, size);
+        }
+        test_check(test_name, size <= GUTHTHILA_BUFFER_DEF_SIZE,
+                   "chunk larger than the default size");
+    }
+    test_check(test_name,
+               guththila_get_memory_chunk(wr, count, &size, env) == NULL,
+               "chunk past the last one");
+    test_check(test_name, got.len == expected->len &&
+               memcmp(got.data, expected->data, got.len) == 0,
+               "chunks differ from the expected output");
+    test_check(test_name,
+               guththila_get_memory_buffer_size(wr, env) == expected->len &&
+               memcmp(guththila_get_memory_buffer(wr, env), expected->data,
+                      expected->len) == 0,
+               "buffer differs from the expected output");
+    free(got.data);
+}
+
+/* A document with many elements kept in several chunks. Element names are
+ * not split across chunks, so closing tags still find them */
+static void
+test_chunks(
+    const axutil_env_t * env)
+{
+    guththila_xml_writer_t *wr =
+        guththila_create_xml_stream_writer_for_memory(env);
+    test_output_t expected = { NULL, 0, 0 };
+    char name[32];
+    int i;
+
+    guththila_write_start_element_with_prefix_and_namespace(wr, "p",
+        "urn:test", "root", env);
+    test_output_append(&expected, "<p:root xmlns:p=\"urn:test\">", 27);
+    for (i = 0; i < 4000; i++)
+    {
+        sprintf(name, "element_%d", i);
+        guththila_write_start_element(wr, name, env);
+        guththila_write_characters(wr, "a&b", env);
+        guththila_write_end_element(wr, env);
+        test_output_append(&expected, "<", 1);
+        test_output_append(&expected, name, strlen(name));
+        test_output_append(&expected, ">a&amp;b</", 10);
+        test_output_append(&expected, name, strlen(name));
+        test_output_append(&expected, ">", 1);
+    }
+    guththila_write_end_element(wr, env);
+    test_output_append(&expected, "</p:root>", 9);
+
+    test_check_chunks("test_chunks", wr, &expected, 3, env);
+    free(expected.data);
+    guththila_xml_writer_free(wr, env);
+    printf("test_chunks: done\n");
+}
+
+/* Flush mode: the output arrives in order, the writer keeps one chunk, and
+ * the names copied out of flushed chunks are freed as their elements are
+ * closed */
+static void
+test_flush(
+    const axutil_env_t * env)
+{
+    guththila_xml_writer_t *wr =
+        guththila_create_xml_stream_writer_for_memory(env);
+    test_output_t expected = { NULL, 0, 0 };
+    test_output_t flushed = { NULL, 0, 0 };
+    char name[32];
+    char *text = NULL;
+    int i, j;
+    int max_detached = 0;
+
+    text = (char *) malloc(GUTHTHILA_BUFFER_DEF_SIZE / 4 + 1);
+    memset(text, 'y', GUTHTHILA_BUFFER_DEF_SIZE / 4);
+    text[GUTHTHILA_BUFFER_DEF_SIZE / 4] = '\0';
+
+    guththila_xml_writer_set_flush(wr, test_collect, &flushed, env);
+    guththila_write_start_element_with_prefix_and_namespace(wr, "p",
+        "urn:test", "root", env);
+    test_output_append(&expected, "<p:root xmlns:p=\"urn:test\">", 27);
+    for (i = 0; i < 50; i++)
+    {
+        /* elements opened in one chunk and closed several chunks later */
+        for (j = 0; j < 4; j++)
+        {
+            sprintf(name, "level_%d_%d", i, j);
+            guththila_write_start_element_with_prefix(wr, "p", name, env);
+            guththila_write_characters(wr, text, env);
+            test_output_append(&expected, "<p:", 3);
+            test_output_append(&expected, name, strlen(name));
+            test_output_append(&expected, ">", 1);
+            test_output_append(&expected, text, strlen(text));
+        }
+        for (j = 3; j >= 0; j--)
+        {
+            sprintf(name, "level_%d_%d", i, j);
+            guththila_write_end_element(wr, env);
+            test_output_append(&expected, "</p:", 4);
+            test_output_append(&expected, name, strlen(name));
+            test_output_append(&expected, ">", 1);
+        }
+        test_check("test_flush",
+                   guththila_get_memory_chunk_count(wr, env) <= 2,
+                   "chunks kept in flush mode");
+        if (GUTHTHILA_STACK_SIZE(wr->detached) > max_detached)
+        {
+            max_detached = GUTHTHILA_STACK_SIZE(wr->detached);
+        }
+    }
+    guththila_write_end_element(wr, env);
+    test_output_append(&expected, "</p:root>", 9);
+    guththila_xml_writer_flush(wr, env);
+
+    test_check("test_flush", flushed.len == expected.len &&
+               memcmp(flushed.data, expected.data, expected.len) == 0,
+               "flushed output differs from the expected output");
+    test_check("test_flush", max_detached > 0, "no name was copied");
+    test_check("test_flush", GUTHTHILA_STACK_SIZE(wr->detached) == 0,
+               "copies of names kept after their elements were closed");
+    test_check("test_flush", guththila_get_memory_buffer_size(wr, env) == 0,
+               "output left after the flush");
+
+    free(text);
+    free(expected.data);
+    free(flushed.data);
+    guththila_xml_writer_free(wr, env);
+    printf("test_flush: done\n");
+}
+
+/* A comment longer than a chunk is split over chunks of the default size
+ * instead of getting one of its own */
+static void
+test_large_write(
+    const axutil_env_t * env)
+{
+    guththila_xml_writer_t *wr =
+        guththila_create_xml_stream_writer_for_memory(env);
+    test_output_t expected = { NULL, 0, 0 };
+    size_t len = 3 * GUTHTHILA_BUFFER_DEF_SIZE + 5;
+    char *text = (char *) malloc(len + 1);
+
+    memset(text, 'z', len);
+    text[len] = '\0';
+    guththila_write_start_element(wr, "a", env);
+    guththila_write_comment(wr, text, env);
+    guththila_write_end_element(wr, env);
+    test_output_append(&expected, "<a><!--", 7);
+    test_output_append(&expected, text, len);
+    test_output_append(&expected, "--></a>", 7);
+
+    test_check_chunks("test_large_write", wr, &expected, 4, env);
+    free(text);
+    free(expected.data);
+    guththila_xml_writer_free(wr, env);
+    printf("test_large_write: done\n");
+}
+
+int
+main(
+    int argc,
+    char *argv[])
+{
+    axutil_allocator_t *allocator = axutil_allocator_init(NULL);
+    axutil_env_t *env = axutil_env_create(allocator);
+
+    test_chunks(env);
+    test_large_write(env);
+    test_flush(env);
+
+    axutil_env_free(env);
+    if (failures)
+    {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,126 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AXIS2_ASYNC_ENGINE_H
+#define AXIS2_ASYNC_ENGINE_H
+
+/**
+ * @defgroup axis2_async_engine asynchronous client engine
+ * @ingroup axis2_client_api
+ * By default a non blocking invocation over a single channel takes a thread
+ * that blocks until the response arrives. The asynchronous engine instead
+ * drives the sockets of all outstanding invocations from a few I/O threads,
+ * so the number of calls in flight is bounded by the number of sockets
+ * rather than by the number of threads.
+ *
+ * The engine is set on the options used for an invocation with the
+ * AXIS2_ASYNC_ENGINE property, or with axis2_svc_client_set_async_engine.
+ * The out flow of a call still runs in the calling thread; the request is
+ * then written, and the response read, parsed and run through the in flow
+ * by an I/O thread, which finally calls the callback of the invocation.
+ * Callbacks therefore must not block. Connections are kept alive and reused
+ * for later calls to the same host and port.
+ *
+ * The engine talks plain HTTP/1.1 and sends SOAP without attachments.
+ * Invocations needing anything else, such as SSL, a proxy, authentication,
+ * MTOM or a separate listener, use the thread based path as before.
+ * The engine relies on epoll and is not available where that is missing.
+ * @{
+ */
+
+/**
+ * @file axis2_async_engine.h
+ */
+
+#include <axis2_defines.h>
+#include <axutil_env.h>
+#include <axis2_op_client.h>
+
+/** Options property holding the asynchronous engine to use */
+#define AXIS2_ASYNC_ENGINE "AsyncEngine"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /** Type name for struct axis2_async_engine */
+    typedef struct axis2_async_engine axis2_async_engine_t;
+
+    /**
+     * Creates an engine and starts its I/O threads.
+     * @param env pointer to environment struct. It must stay valid for the
+     * lifetime of the engine, as the I/O threads derive theirs from it
+     * @param io_threads number of I/O threads, at least one
+     * @return pointer to the newly created engine, or NULL on error or when
+     * the platform lacks epoll
+     */
+    AXIS2_EXTERN axis2_async_engine_t *AXIS2_CALL
+    axis2_async_engine_create(
+        const axutil_env_t * env,
+        int io_threads);
+
+    /**
+     * Sends the out message of an operation client and hands the call over
+     * to an I/O thread. This is called by axis2_op_client_execute for non
+     * blocking invocations that have an engine set.
+     * @param async_engine pointer to engine
+     * @param env pointer to environment struct
+     * @param op_client operation client of the invocation. It and its
+     * callback must stay valid until the callback completes
+     * @param msg_ctx out message context, prepared for invocation
+     * @return AXIS2_SUCCESS once the request is queued, else AXIS2_FAILURE,
+     * in which case the callback is not called
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_async_engine_send(
+        axis2_async_engine_t * async_engine,
+        const axutil_env_t * env,
+        axis2_op_client_t * op_client,
+        axis2_msg_ctx_t * msg_ctx);
+
+    /**
+     * Tells whether the engine can carry a message. Messages it cannot
+     * carry are sent on the thread based path.
+     * @param async_engine pointer to engine
+     * @param env pointer to environment struct
+     * @param msg_ctx out message context, prepared for invocation
+     * @return AXIS2_TRUE if the engine can send the message, else AXIS2_FALSE
+     */
+    AXIS2_EXTERN axis2_bool_t AXIS2_CALL
+    axis2_async_engine_can_send(
+        axis2_async_engine_t * async_engine,
+        const axutil_env_t * env,
+        axis2_msg_ctx_t * msg_ctx);
+
+    /**
+     * Stops the I/O threads and frees the engine. Calls still outstanding
+     * are reported to their callbacks as failed.
+     * @param async_engine pointer to engine
+     * @param env pointer to environment struct
+     * @return void
+     */
+    AXIS2_EXTERN void AXIS2_CALL
+    axis2_async_engine_free(
+        axis2_async_engine_t * async_engine,
+        const axutil_env_t * env);
+
+    /** @} */
+#ifdef __cplusplus
+}
+#endif
+#endif                          /* AXIS2_ASYNC_ENGINE_H */
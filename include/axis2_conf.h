@@ -158,6 +158,20 @@ extern "C"
         const axutil_env_t * env,
         const axis2_char_t * name);
 
+    /**
+     * Removes the named service group from configuration. The service group
+     * is not freed.
+     * @param conf pointer to conf struct
+     * @param env pointer to environment struct
+     * @param svc_grp_name name of service group to be removed
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_conf_remove_svc_grp(
+        axis2_conf_t * conf,
+        const axutil_env_t * env,
+        const axis2_char_t * svc_grp_name);
+
     /**
      * Adds a parameter to configuration.
      * @param conf pointer to conf struct
@@ -0,0 +1,144 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AXIS2_CONF_CTX_CACHE_H
+#define AXIS2_CONF_CTX_CACHE_H
+
+/**
+ * @defgroup axis2_conf_ctx_cache client configuration context cache
+ * @ingroup axis2_client_api
+ * Building a client configuration context reads axis2.xml, runs the
+ * deployment engine and initializes all modules and transports. The cache
+ * keeps one configuration context per client repository and hands out
+ * references to it, so that service clients talking to different endpoints
+ * do not each pay for that. An application creates one cache at start up
+ * and uses it from all its threads.
+ *
+ * Everything a service client changes on the shared configuration, such as
+ * a proxy set with axis2_svc_client_set_proxy, is seen by all the clients
+ * sharing it. Settings meant for a single client or call belong in its
+ * options.
+ * @{
+ */
+
+/**
+ * @file axis2_conf_ctx_cache.h
+ */
+
+#include <axis2_defines.h>
+#include <axutil_env.h>
+#include <axis2_conf_ctx.h>
+#include <axis2_svc.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /** Type name for struct axis2_conf_ctx_cache */
+    typedef struct axis2_conf_ctx_cache axis2_conf_ctx_cache_t;
+
+    /**
+     * Creates an empty cache.
+     * @param env pointer to environment struct
+     * @return pointer to the newly created cache, or NULL on error
+     */
+    AXIS2_EXTERN axis2_conf_ctx_cache_t *AXIS2_CALL
+    axis2_conf_ctx_cache_create(
+        const axutil_env_t * env);
+
+    /**
+     * Gets the configuration context for a client repository, building it
+     * on first use, and takes a reference to it.
+     * @param cache pointer to cache
+     * @param env pointer to environment struct
+     * @param client_home client repository path, as given to
+     * axis2_svc_client_create
+     * @return configuration context, to be given back with
+     * axis2_conf_ctx_cache_release, or NULL on error
+     */
+    AXIS2_EXTERN axis2_conf_ctx_t *AXIS2_CALL
+    axis2_conf_ctx_cache_get(
+        axis2_conf_ctx_cache_t * cache,
+        const axutil_env_t * env,
+        const axis2_char_t * client_home);
+
+    /**
+     * Drops a reference taken with axis2_conf_ctx_cache_get. The
+     * configuration context is freed with the last reference.
+     * @param cache pointer to cache
+     * @param env pointer to environment struct
+     * @param conf_ctx configuration context returned by the cache
+     * @return AXIS2_SUCCESS on success, AXIS2_FAILURE if conf_ctx does not
+     * come from this cache
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_conf_ctx_cache_release(
+        axis2_conf_ctx_cache_t * cache,
+        const axutil_env_t * env,
+        axis2_conf_ctx_t * conf_ctx);
+
+    /**
+     * Adds a service to a shared configuration, building its execution
+     * chains. Services are added and removed under the cache lock since
+     * several clients may do so at once.
+     * @param cache pointer to cache
+     * @param env pointer to environment struct
+     * @param conf_ctx configuration context returned by the cache
+     * @param svc service to add. The service stays owned by the caller
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_conf_ctx_cache_add_svc(
+        axis2_conf_ctx_cache_t * cache,
+        const axutil_env_t * env,
+        axis2_conf_ctx_t * conf_ctx,
+        axis2_svc_t * svc);
+
+    /**
+     * Removes a service added with axis2_conf_ctx_cache_add_svc, freeing
+     * the service group and service group context created for it.
+     * @param cache pointer to cache
+     * @param env pointer to environment struct
+     * @param conf_ctx configuration context returned by the cache
+     * @param svc service to remove. The service itself is not freed
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_conf_ctx_cache_remove_svc(
+        axis2_conf_ctx_cache_t * cache,
+        const axutil_env_t * env,
+        axis2_conf_ctx_t * conf_ctx,
+        axis2_svc_t * svc);
+
+    /**
+     * Frees the cache and every configuration context still in it. All
+     * service clients using the cache must have been freed before.
+     * @param cache pointer to cache
+     * @param env pointer to environment struct
+     * @return void
+     */
+    AXIS2_EXTERN void AXIS2_CALL
+    axis2_conf_ctx_cache_free(
+        axis2_conf_ctx_cache_t * cache,
+        const axutil_env_t * env);
+
+    /** @} */
+#ifdef __cplusplus
+}
+#endif
+#endif                          /* AXIS2_CONF_CTX_CACHE_H */
@@ -119,6 +119,7 @@ extern "C"
 #define AXIS2_TRANSPORT_HTTPS	"https"
 #define AXIS2_TRANSPORT_AMQP	"amqp"
 #define AXIS2_TRANSPORT_UDP		"soap.udp"
+#define AXIS2_TRANSPORT_LOCAL	"local"
     typedef enum
     {
         AXIS2_TRANSPORT_ENUM_HTTP = 0,
@@ -128,6 +129,7 @@ extern "C"
         AXIS2_TRANSPORT_ENUM_HTTPS,
         AXIS2_TRANSPORT_ENUM_AMQP,
 		AXIS2_TRANSPORT_ENUM_UDP,
+        AXIS2_TRANSPORT_ENUM_LOCAL,
         AXIS2_TRANSPORT_ENUM_MAX
     } AXIS2_TRANSPORT_ENUMS;
 
@@ -368,6 +370,20 @@ extern "C"
 
 #define AXIS2_EXPOSE_HEADERS "exposeHeaders"
 
+    /* keep the body of a response as text, unbuilt, for passing it on */
+#define AXIS2_PASSTHROUGH_BODY "passthroughBody"
+
+    /* copies of the bytes a transport reads or writes, for logging messages
+       as they stream through; the values give the number of bytes kept.
+       The in copy is asked for on the configuration context and kept in
+       the message context as a stream under AXIS2_TRANSPORT_TEE_DATA.
+       A message context asks for the in copy to be logged, once the request
+       has been read, with AXIS2_TRANSPORT_TEE_LOG */
+#define AXIS2_TRANSPORT_TEE_IN "transportTeeIn"
+#define AXIS2_TRANSPORT_TEE_OUT "transportTeeOut"
+#define AXIS2_TRANSPORT_TEE_DATA "transportTeeData"
+#define AXIS2_TRANSPORT_TEE_LOG "transportTeeLog"
+
     /******************************************************************************/
 
 #define AXIS2_VALUE_TRUE "true"
@@ -102,6 +102,71 @@ extern "C"
         const axutil_env_t * env,
         axutil_hash_t *rest_map);
 
+    /** Most parameters a REST location template can capture */
+#define AXIS2_CORE_UTILS_REST_MAX_CAPTURES 32
+
+    /**
+     * REST location templates of a service compiled into a trie, one root per
+     * HTTP method. Each level of the trie is one path segment: constant
+     * segments are kept sorted and found by binary search, segments holding
+     * parameters are kept as parsed templates and tried in declaration order
+     * when no constant matches. Matching walks the request path once and
+     * records the parameters as ranges of the path, without allocating.
+     */
+    typedef struct axis2_core_utils_rest_trie axis2_core_utils_rest_trie_t;
+
+    /** A parameter captured by axis2_core_utils_rest_trie_match. The value
+        points into the matched path and is not NUL terminated. */
+    typedef struct axis2_core_utils_rest_capture
+    {
+        const axis2_char_t *name;
+        const axis2_char_t *value;
+        int value_len;
+    } axis2_core_utils_rest_capture_t;
+
+    AXIS2_EXTERN axis2_core_utils_rest_trie_t *AXIS2_CALL
+    axis2_core_utils_rest_trie_create(
+        const axutil_env_t * env);
+
+    /**
+     * Compiles a location template into the trie.
+     * @param method HTTP method of the operation
+     * @param location template such as "students/{name}/marks/{subject}",
+     * without a leading '/' or query part
+     * @return AXIS2_FAILURE on a malformed template, a duplicate mapping or
+     * more than AXIS2_CORE_UTILS_REST_MAX_CAPTURES parameters
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_core_utils_rest_trie_add(
+        axis2_core_utils_rest_trie_t * trie,
+        const axutil_env_t * env,
+        const axis2_char_t * method,
+        const axis2_char_t * location,
+        axis2_op_t * op_desc);
+
+    /**
+     * Finds the operation mapped to a request path. The path may start with
+     * '/' and ends at '?' or at the end of the string.
+     * @param captures array of max_captures entries filled with the
+     * parameters of the template matched
+     * @param n_captures set to the number of captures filled
+     * @return the operation, or NULL if no template matches
+     */
+    AXIS2_EXTERN axis2_op_t *AXIS2_CALL
+    axis2_core_utils_rest_trie_match(
+        const axis2_core_utils_rest_trie_t * trie,
+        const axutil_env_t * env,
+        const axis2_char_t * method,
+        const axis2_char_t * path,
+        axis2_core_utils_rest_capture_t * captures,
+        int max_captures,
+        int *n_captures);
+
+    AXIS2_EXTERN void AXIS2_CALL
+    axis2_core_utils_rest_trie_free(
+        axis2_core_utils_rest_trie_t * trie,
+        const axutil_env_t * env);
+
 
 
     /** @} */
@@ -53,6 +53,77 @@ extern "C"
     /** Type name for struct axis2_ctx */
     typedef struct axis2_ctx axis2_ctx_t;
 
+    /**
+     * Slots of the well known properties. A property with one of these keys
+     * is still stored in the property map under its key, but can be got by
+     * its slot without hashing the key.
+     */
+    typedef enum axis2_ctx_slot
+    {
+        /** AXIS2_TRANSPORT_IN */
+        AXIS2_CTX_SLOT_TRANSPORT_IN = 0,
+
+        /** AXIS2_TRANSPORT_OUT */
+        AXIS2_CTX_SLOT_TRANSPORT_OUT,
+
+        /** AXIS2_TRANSPORT_HEADERS */
+        AXIS2_CTX_SLOT_TRANSPORT_HEADERS,
+
+        /** AXIS2_TRANSPORT_URL */
+        AXIS2_CTX_SLOT_TRANSPORT_URL,
+
+        /** AXIS2_CHARACTER_SET_ENCODING */
+        AXIS2_CTX_SLOT_CHARACTER_SET_ENCODING,
+
+        /** AXIS2_SVR_PEER_IP_ADDR */
+        AXIS2_CTX_SLOT_SVR_PEER_IP_ADDR,
+
+        /** AXIS2_ENABLE_REST */
+        AXIS2_CTX_SLOT_ENABLE_REST,
+
+        /** AXIS2_WSA_VERSION */
+        AXIS2_CTX_SLOT_WSA_VERSION,
+
+        /** AXIS2_HTTP_CLIENT */
+        AXIS2_CTX_SLOT_HTTP_CLIENT,
+
+        /** AXIS2_HTTP_METHOD */
+        AXIS2_CTX_SLOT_HTTP_METHOD,
+
+        /** AXIS2_HTTP_TRANSPORT_ERROR */
+        AXIS2_CTX_SLOT_HTTP_TRANSPORT_ERROR,
+
+        /** AXIS2_HTTP_CONNECTION_TIMEOUT */
+        AXIS2_CTX_SLOT_HTTP_CONNECTION_TIMEOUT,
+
+        /** AXIS2_TRANSPORT_HEADER_PROPERTY */
+        AXIS2_CTX_SLOT_TRANSPORT_HEADER_PROPERTY,
+
+        /** AXIS2_USER_DEFINED_HTTP_HEADER_CONTENT_TYPE */
+        AXIS2_CTX_SLOT_USER_DEFINED_HTTP_HEADER_CONTENT_TYPE,
+
+        /** AXIS2_HTTP_HEADER_CONTENT_LENGTH */
+        AXIS2_CTX_SLOT_HTTP_HEADER_CONTENT_LENGTH,
+
+        /** MTOM_RECIVED_CONTENT_TYPE */
+        AXIS2_CTX_SLOT_MTOM_RECEIVED_CONTENT_TYPE,
+
+        /** AXIS2_TEST_HTTP_AUTH */
+        AXIS2_CTX_SLOT_TEST_HTTP_AUTH,
+
+        /** AXIS2_TEST_PROXY_AUTH */
+        AXIS2_CTX_SLOT_TEST_PROXY_AUTH,
+
+        /** AXIS2_FORCE_HTTP_AUTH */
+        AXIS2_CTX_SLOT_FORCE_HTTP_AUTH,
+
+        /** AXIS2_FORCE_PROXY_AUTH */
+        AXIS2_CTX_SLOT_FORCE_PROXY_AUTH,
+
+        /** number of slots, not a slot */
+        AXIS2_CTX_SLOT_COUNT
+    } axis2_ctx_slot_t;
+
     /**
      * Creates a context struct.
      * @param env pointer to environment struct
@@ -91,6 +162,47 @@ extern "C"
         const axutil_env_t * env,
         const axis2_char_t * key);
 
+    /**
+     * Sets the property of a well known key, as axis2_ctx_set_property
+     * with the key of the slot.
+     * @param ctx pointer to context struct
+     * @param env pointer to environment struct
+     * @param slot slot of the key
+     * @param value pointer to property to be stored, context assumes the
+     * ownership of the property
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_ctx_set_property_at(
+        struct axis2_ctx *ctx,
+        const axutil_env_t * env,
+        axis2_ctx_slot_t slot,
+        axutil_property_t * value);
+
+    /**
+     * Gets the property of a well known key, without looking the key up.
+     * @param ctx pointer to context struct
+     * @param env pointer to environment struct
+     * @param slot slot of the key
+     * @return pointer to property struct stored with the key of the slot
+     */
+    AXIS2_EXTERN axutil_property_t *AXIS2_CALL
+    axis2_ctx_get_property_at(
+        const axis2_ctx_t * ctx,
+        const axutil_env_t * env,
+        axis2_ctx_slot_t slot);
+
+    /**
+     * Gets the key of a slot.
+     * @param env pointer to environment struct
+     * @param slot slot of the key
+     * @return the key, or NULL if slot is not a slot
+     */
+    AXIS2_EXTERN const axis2_char_t *AXIS2_CALL
+    axis2_ctx_get_slot_key(
+        const axutil_env_t * env,
+        axis2_ctx_slot_t slot);
+
     /**
      * Gets the non-persistent map of properties.
      * @param ctx pointer to context struct
@@ -0,0 +1,365 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AXIS2_HTTP2_H
+#define AXIS2_HTTP2_H
+
+/**
+ * @ingroup axis2_core_transport_http
+ * @{
+ */
+
+/**
+ * @file axis2_http2.h
+ * @brief HTTP/2 framing and HPACK header compression (RFC 7540, RFC 7541),
+ * shared by the HTTP/2 support of the simple http server and of the http
+ * client. Only cleartext HTTP/2 (h2c) is spoken.
+ */
+
+#include <axis2_const.h>
+#include <axis2_defines.h>
+#include <axutil_env.h>
+#include <axutil_array_list.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /** what a client sends first on an HTTP/2 connection */
+#define AXIS2_HTTP2_PREFACE "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"
+#define AXIS2_HTTP2_PREFACE_LEN 24
+
+    /** request line of the preface, as an HTTP/1.x server reads it */
+#define AXIS2_HTTP2_PREFACE_METHOD "PRI"
+#define AXIS2_HTTP2_PREFACE_VERSION "HTTP/2.0"
+    /** what is left of the preface after its request line */
+#define AXIS2_HTTP2_PREFACE_REST "SM\r\n\r\n"
+#define AXIS2_HTTP2_PREFACE_REST_LEN 6
+
+#define AXIS2_HTTP2_HEADER_UPGRADE "Upgrade"
+#define AXIS2_HTTP2_HEADER_SETTINGS "HTTP2-Settings"
+#define AXIS2_HTTP2_UPGRADE_TOKEN "h2c"
+
+#define AXIS2_HTTP2_FRAME_HEADER_LEN 9
+
+    /* frame types */
+#define AXIS2_HTTP2_DATA 0x0
+#define AXIS2_HTTP2_HEADERS 0x1
+#define AXIS2_HTTP2_PRIORITY 0x2
+#define AXIS2_HTTP2_RST_STREAM 0x3
+#define AXIS2_HTTP2_SETTINGS 0x4
+#define AXIS2_HTTP2_PUSH_PROMISE 0x5
+#define AXIS2_HTTP2_PING 0x6
+#define AXIS2_HTTP2_GOAWAY 0x7
+#define AXIS2_HTTP2_WINDOW_UPDATE 0x8
+#define AXIS2_HTTP2_CONTINUATION 0x9
+
+    /* frame flags */
+#define AXIS2_HTTP2_FLAG_END_STREAM 0x1
+#define AXIS2_HTTP2_FLAG_ACK 0x1
+#define AXIS2_HTTP2_FLAG_END_HEADERS 0x4
+#define AXIS2_HTTP2_FLAG_PADDED 0x8
+#define AXIS2_HTTP2_FLAG_PRIORITY 0x20
+
+    /* settings */
+#define AXIS2_HTTP2_SETTINGS_HEADER_TABLE_SIZE 0x1
+#define AXIS2_HTTP2_SETTINGS_ENABLE_PUSH 0x2
+#define AXIS2_HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS 0x3
+#define AXIS2_HTTP2_SETTINGS_INITIAL_WINDOW_SIZE 0x4
+#define AXIS2_HTTP2_SETTINGS_MAX_FRAME_SIZE 0x5
+#define AXIS2_HTTP2_SETTINGS_MAX_HEADER_LIST_SIZE 0x6
+
+    /* error codes */
+#define AXIS2_HTTP2_NO_ERROR 0x0
+#define AXIS2_HTTP2_PROTOCOL_ERROR 0x1
+#define AXIS2_HTTP2_INTERNAL_ERROR 0x2
+#define AXIS2_HTTP2_FLOW_CONTROL_ERROR 0x3
+#define AXIS2_HTTP2_STREAM_CLOSED 0x5
+#define AXIS2_HTTP2_FRAME_SIZE_ERROR 0x6
+#define AXIS2_HTTP2_REFUSED_STREAM 0x7
+#define AXIS2_HTTP2_CANCEL 0x8
+#define AXIS2_HTTP2_COMPRESSION_ERROR 0x9
+
+    /** initial flow control window of connections and streams */
+#define AXIS2_HTTP2_DEFAULT_WINDOW_SIZE 65535
+#define AXIS2_HTTP2_MAX_WINDOW_SIZE 0x7fffffff
+    /** largest frame payload either side may send unless told otherwise */
+#define AXIS2_HTTP2_DEFAULT_MAX_FRAME_SIZE 16384
+#define AXIS2_HTTP2_DEFAULT_HEADER_TABLE_SIZE 4096
+
+    /** buffers frames to write, so that they go out in few writes */
+    typedef struct axis2_http2_frame_buf axis2_http2_frame_buf_t;
+
+    /** splits what is read from a connection into frames */
+    typedef struct axis2_http2_frame_reader axis2_http2_frame_reader_t;
+
+    /** state of the header compression of one direction of a connection */
+    typedef struct axis2_http2_hpack axis2_http2_hpack_t;
+
+    /**
+     * Frame header fields of a frame read
+     */
+    typedef struct axis2_http2_frame
+    {
+        int length;
+        int type;
+        int flags;
+        int stream_id;
+        /* points into the buffer of the reader, valid until the next read */
+        const unsigned char *payload;
+    } axis2_http2_frame_t;
+
+    /**
+     * @param env pointer to environment struct
+     * @return buffer for frames to write, NULL on error
+     */
+    AXIS2_EXTERN axis2_http2_frame_buf_t *AXIS2_CALL
+    axis2_http2_frame_buf_create(
+        const axutil_env_t * env);
+
+    /**
+     * Appends a frame to the buffer.
+     * @param frame_buf pointer to frame buffer
+     * @param env pointer to environment struct
+     * @param type frame type
+     * @param flags frame flags
+     * @param stream_id stream of the frame, 0 for the connection
+     * @param payload frame payload, may be NULL when length is 0
+     * @param length length of the payload
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_http2_frame_buf_add(
+        axis2_http2_frame_buf_t * frame_buf,
+        const axutil_env_t * env,
+        int type,
+        int flags,
+        int stream_id,
+        const void *payload,
+        int length);
+
+    /**
+     * Appends bytes that are not framed, the connection preface.
+     * @param frame_buf pointer to frame buffer
+     * @param env pointer to environment struct
+     * @param data bytes to append
+     * @param length number of bytes
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_http2_frame_buf_add_raw(
+        axis2_http2_frame_buf_t * frame_buf,
+        const axutil_env_t * env,
+        const void *data,
+        int length);
+
+    /**
+     * @param frame_buf pointer to frame buffer
+     * @param env pointer to environment struct
+     * @return number of bytes waiting to be written
+     */
+    AXIS2_EXTERN int AXIS2_CALL
+    axis2_http2_frame_buf_get_len(
+        const axis2_http2_frame_buf_t * frame_buf,
+        const axutil_env_t * env);
+
+    /**
+     * Writes all buffered frames to a socket and empties the buffer.
+     * @param frame_buf pointer to frame buffer
+     * @param env pointer to environment struct
+     * @param socket socket to write to
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_http2_frame_buf_flush(
+        axis2_http2_frame_buf_t * frame_buf,
+        const axutil_env_t * env,
+        int socket);
+
+    /**
+     * @param frame_buf pointer to frame buffer
+     * @param env pointer to environment struct
+     */
+    AXIS2_EXTERN void AXIS2_CALL
+    axis2_http2_frame_buf_free(
+        axis2_http2_frame_buf_t * frame_buf,
+        const axutil_env_t * env);
+
+    /**
+     * @param env pointer to environment struct
+     * @param max_frame_size largest frame payload accepted
+     * @return frame reader, NULL on error
+     */
+    AXIS2_EXTERN axis2_http2_frame_reader_t *AXIS2_CALL
+    axis2_http2_frame_reader_create(
+        const axutil_env_t * env,
+        int max_frame_size);
+
+    /**
+     * Adds bytes that were read from the connection by someone else.
+     * @param reader pointer to frame reader
+     * @param env pointer to environment struct
+     * @param data bytes read
+     * @param length number of bytes
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_http2_frame_reader_put(
+        axis2_http2_frame_reader_t * reader,
+        const axutil_env_t * env,
+        const void *data,
+        int length);
+
+    /**
+     * Reads once from a socket into the reader.
+     * @param reader pointer to frame reader
+     * @param env pointer to environment struct
+     * @param socket socket to read from
+     * @return number of bytes read, 0 when the peer closed the connection,
+     * -1 on error
+     */
+    AXIS2_EXTERN int AXIS2_CALL
+    axis2_http2_frame_reader_fill(
+        axis2_http2_frame_reader_t * reader,
+        const axutil_env_t * env,
+        int socket);
+
+    /**
+     * Takes the given bytes, the connection preface, from the start of what
+     * was read.
+     * @param reader pointer to frame reader
+     * @param env pointer to environment struct
+     * @param expected bytes expected
+     * @param length number of bytes expected
+     * @return 1 when they were taken, 0 when more has to be read, -1 when
+     * something else was read
+     */
+    AXIS2_EXTERN int AXIS2_CALL
+    axis2_http2_frame_reader_expect(
+        axis2_http2_frame_reader_t * reader,
+        const axutil_env_t * env,
+        const void *expected,
+        int length);
+
+    /**
+     * Takes the next frame read completely.
+     * @param reader pointer to frame reader
+     * @param env pointer to environment struct
+     * @param frame filled with the frame
+     * @return 1 when a frame was taken, 0 when more has to be read, -1 when
+     * the frame is larger than the reader accepts
+     */
+    AXIS2_EXTERN int AXIS2_CALL
+    axis2_http2_frame_reader_next(
+        axis2_http2_frame_reader_t * reader,
+        const axutil_env_t * env,
+        axis2_http2_frame_t * frame);
+
+    /**
+     * @param reader pointer to frame reader
+     * @param env pointer to environment struct
+     */
+    AXIS2_EXTERN void AXIS2_CALL
+    axis2_http2_frame_reader_free(
+        axis2_http2_frame_reader_t * reader,
+        const axutil_env_t * env);
+
+    /**
+     * Creates the header compression state of one direction of a connection.
+     * @param env pointer to environment struct
+     * @param max_table_size size limit of the dynamic table
+     * @return hpack state, NULL on error
+     */
+    AXIS2_EXTERN axis2_http2_hpack_t *AXIS2_CALL
+    axis2_http2_hpack_create(
+        const axutil_env_t * env,
+        int max_table_size);
+
+    /**
+     * Decodes a complete header block. Huffman coded strings are decoded and
+     * the dynamic table is updated.
+     * @param hpack pointer to hpack state of the receiving direction
+     * @param env pointer to environment struct
+     * @param block header block
+     * @param length length of the block
+     * @param headers axis2_http_header_t of the fields decoded are appended
+     * to it, pseudo headers keep their names starting with ':'
+     * @return AXIS2_SUCCESS on success, AXIS2_FAILURE on a compression error
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_http2_hpack_decode(
+        axis2_http2_hpack_t * hpack,
+        const axutil_env_t * env,
+        const unsigned char *block,
+        int length,
+        axutil_array_list_t * headers);
+
+    /**
+     * Encodes a header field. Names are taken from the static table when
+     * they can be, values are written as literals not added to the dynamic
+     * table, so encoding needs no state.
+     * @param env pointer to environment struct
+     * @param name field name, lower case
+     * @param value field value
+     * @param buffer buffer to write to, at least
+     * axis2_http2_hpack_encoded_max_len bytes
+     * @return number of bytes written
+     */
+    AXIS2_EXTERN int AXIS2_CALL
+    axis2_http2_hpack_encode(
+        const axutil_env_t * env,
+        const axis2_char_t * name,
+        const axis2_char_t * value,
+        unsigned char *buffer);
+
+    /**
+     * @param name field name
+     * @param value field value
+     * @return largest number of bytes axis2_http2_hpack_encode writes
+     */
+    AXIS2_EXTERN int AXIS2_CALL
+    axis2_http2_hpack_encoded_max_len(
+        const axis2_char_t * name,
+        const axis2_char_t * value);
+
+    /**
+     * @param hpack pointer to hpack state
+     * @param env pointer to environment struct
+     */
+    AXIS2_EXTERN void AXIS2_CALL
+    axis2_http2_hpack_free(
+        axis2_http2_hpack_t * hpack,
+        const axutil_env_t * env);
+
+    /**
+     * Tells whether a header of an HTTP/1.x message concerns only the
+     * connection, and so may not be carried over HTTP/2.
+     * @param name header name
+     * @return AXIS2_TRUE for connection specific headers
+     */
+    AXIS2_EXTERN axis2_bool_t AXIS2_CALL
+    axis2_http2_is_connection_header(
+        const axis2_char_t * name);
+
+    /** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif                          /* AXIS2_HTTP2_H */
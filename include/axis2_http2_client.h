@@ -0,0 +1,101 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AXIS2_HTTP2_CLIENT_H
+#define AXIS2_HTTP2_CLIENT_H
+
+/**
+ * @defgroup axis2_http2_client http2 client
+ * @ingroup axis2_core_trans_http
+ * @{
+ */
+
+/**
+ * @file axis2_http2_client.h
+ * @brief HTTP/2 over clear text, with prior knowledge, for the http sender.
+ * The client keeps one connection per host and port and sends the requests
+ * of all the threads using it as streams of that connection. Each
+ * connection has a thread of its own reading the responses.
+ */
+
+#include <axis2_const.h>
+#include <axis2_defines.h>
+#include <axutil_env.h>
+#include <axis2_http_simple_request.h>
+#include <axis2_http_simple_response.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /** Type name for struct axis2_http2_client */
+    typedef struct axis2_http2_client axis2_http2_client_t;
+
+    /**
+     * Sends a request as a stream and waits for its response. A stream the
+     * server refused, or left out when going away, is sent again on a new
+     * connection, up to twice.
+     * @param client pointer to the client
+     * @param env pointer to environment struct
+     * @param host host of the server
+     * @param port port of the server
+     * @param request request to send, its Host header is sent as the
+     * authority
+     * @param body body of the request, may be NULL
+     * @param body_len length of the body
+     * @param timeout milliseconds to wait for the server, 0 waits for ever
+     * @param response set to the response, the caller frees it and its body
+     * stream
+     * @return the status code of the response, -1 on failure
+     */
+    AXIS2_EXTERN int AXIS2_CALL
+    axis2_http2_client_send(
+        axis2_http2_client_t * client,
+        const axutil_env_t * env,
+        const axis2_char_t * host,
+        int port,
+        axis2_http_simple_request_t * request,
+        const axis2_char_t * body,
+        int body_len,
+        int timeout,
+        axis2_http_simple_response_t ** response);
+
+    /**
+     * Closes the connections and frees the client. No request may be in
+     * progress.
+     * @param client pointer to the client
+     * @param env pointer to environment struct
+     */
+    AXIS2_EXTERN void AXIS2_CALL
+    axis2_http2_client_free(
+        axis2_http2_client_t * client,
+        const axutil_env_t * env);
+
+    /**
+     * @param env pointer to environment struct
+     */
+    AXIS2_EXTERN axis2_http2_client_t *AXIS2_CALL
+    axis2_http2_client_create(
+        const axutil_env_t * env);
+
+    /** @} */
+#ifdef __cplusplus
+}
+#endif
+
+#endif                          /* AXIS2_HTTP2_CLIENT_H */
@@ -0,0 +1,102 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AXIS2_HTTP2_SVR_CONN_H
+#define AXIS2_HTTP2_SVR_CONN_H
+
+/**
+ * @ingroup axis2_core_transport_http
+ * @{
+ */
+
+/**
+ * @file axis2_http2_svr_conn.h
+ * @brief Serves a connection of the simple http server in HTTP/2. Each
+ * stream is made into an axis2_http_simple_request_t and handed to the http
+ * worker, in a thread of its own on a multi threaded server, so the streams
+ * of a connection are processed concurrently. The HTTP/1.1 response the
+ * worker writes is sent back as the frames of the stream.
+ */
+
+#include <axis2_const.h>
+#include <axis2_defines.h>
+#include <axutil_env.h>
+#include <axis2_http_simple_request.h>
+#include <axis2_simple_http_svr_conn.h>
+#include <axis2_http_worker.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * Tells whether a request just read is the start of the preface of a
+     * client that knows the server speaks HTTP/2.
+     * @param env pointer to environment struct
+     * @param request request read from the connection
+     * @return AXIS2_TRUE for the preface
+     */
+    AXIS2_EXTERN axis2_bool_t AXIS2_CALL
+    axis2_http2_svr_conn_is_preface(
+        const axutil_env_t * env,
+        axis2_http_simple_request_t * request);
+
+    /**
+     * Tells whether a request asks to upgrade the connection to HTTP/2 and
+     * can be served as the first stream. Requests with a chunked body are
+     * served in HTTP/1.1.
+     * @param env pointer to environment struct
+     * @param request request read from the connection
+     * @return AXIS2_TRUE to upgrade
+     */
+    AXIS2_EXTERN axis2_bool_t AXIS2_CALL
+    axis2_http2_svr_conn_is_upgrade(
+        const axutil_env_t * env,
+        axis2_http_simple_request_t * request);
+
+    /**
+     * Serves the connection in HTTP/2 until the client or the server closes
+     * it. For an upgrade the request is answered on stream 1.
+     * @param env pointer to environment struct
+     * @param worker worker that processes the requests
+     * @param svr_conn connection, its socket is closed when it is freed
+     * @param request the preface or the request asking for the upgrade
+     * @param max_streams streams the client may have open at a time
+     * @param max_requests streams served before the connection is closed
+     * @param idle_timeout milliseconds to wait for frames while no request
+     * is being processed
+     * @return AXIS2_SUCCESS if the connection ended normally, else
+     * AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_http2_svr_conn_serve(
+        const axutil_env_t * env,
+        axis2_http_worker_t * worker,
+        axis2_simple_http_svr_conn_t * svr_conn,
+        axis2_http_simple_request_t * request,
+        int max_streams,
+        int max_requests,
+        int idle_timeout);
+
+    /** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif                          /* AXIS2_HTTP2_SVR_CONN_H */
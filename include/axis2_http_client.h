@@ -37,6 +37,7 @@
 #include <axis2_http_simple_response.h>
 #include <axis2_http_simple_request.h>
 #include <axutil_url.h>
+#include <axis2_http2_client.h>
 
 
 
@@ -261,6 +262,21 @@ extern "C"
         const axutil_env_t * env,
         axis2_char_t *callback_name);
 
+    /**
+     * Sends the requests of the client as streams of the shared HTTP/2
+     * client. Requests over https, through a proxy or with MTOM are still
+     * sent in HTTP/1.1.
+     * @param client pointer to client
+     * @param env pointer to environment struct
+     * @param http2_client HTTP/2 client, not owned, NULL for HTTP/1.x
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_http_client_set_http2_client(
+        axis2_http_client_t * client,
+        const axutil_env_t * env,
+        axis2_http2_client_t * http2_client);
+
 
     /** @} */
 #ifdef __cplusplus
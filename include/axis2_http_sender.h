@@ -37,6 +37,7 @@
 #include <axis2_http_simple_response.h>
 #include <axiom_soap_envelope.h>
 #include <axis2_http_simple_request.h>
+#include <axis2_http2_client.h>
 
 #ifdef AXIS2_LIBCURL_ENABLED
 #include <curl/curl.h>
@@ -126,6 +127,19 @@ extern "C"
         const axutil_env_t * env,
         axis2_char_t * version);
 
+    /**
+     * @param sender sender
+     * @param env pointer to environment struct
+     * @param http2_client HTTP/2 client the requests are sent with, not
+     * owned, NULL to send them in HTTP/1.x
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_http_sender_set_http2_client(
+        axis2_http_sender_t * sender,
+        const axutil_env_t * env,
+        axis2_http2_client_t * http2_client);
+
     /**
      * @param sender sender
      * @param env pointer to environment struct
@@ -367,6 +367,11 @@ extern "C"
      */
 #define AXIS2_HTTP_HEADER_PROTOCOL_11 "HTTP/1.1"
 
+    /**
+     * HEADER_PROTOCOL_20, HTTP/2 over clear text, h2c
+     */
+#define AXIS2_HTTP_HEADER_PROTOCOL_20 "HTTP/2.0"
+
     /**
      * CHAR_SET_ENCODING
      */
@@ -832,6 +837,30 @@ extern "C"
      */
 #define AXIS2_HTTP_DEFAULT_SO_TIMEOUT 60000
 
+    /**
+     * DEFAULT_KEEP_ALIVE_TIMEOUT, the time in milliseconds the server waits
+     * for the next request on a connection kept alive
+     */
+#define AXIS2_HTTP_DEFAULT_KEEP_ALIVE_TIMEOUT 15000
+
+    /**
+     * DEFAULT_KEEP_ALIVE_MAX_REQUESTS, the number of requests the server
+     * serves on one connection
+     */
+#define AXIS2_HTTP_DEFAULT_KEEP_ALIVE_MAX_REQUESTS 100
+
+    /**
+     * DEFAULT_MAX_PIPELINE_DEPTH, the number of requests in a row a client
+     * may send before getting the response to the previous one
+     */
+#define AXIS2_HTTP_DEFAULT_MAX_PIPELINE_DEPTH 16
+
+    /**
+     * DEFAULT_HTTP2_MAX_STREAMS, the number of HTTP/2 streams a client may
+     * have open on one connection, 0 serves HTTP/1.1 only
+     */
+#define AXIS2_HTTP_DEFAULT_HTTP2_MAX_STREAMS 100
+
     /**
      * DEFAULT_CONNECTION_TIMEOUT
      */
@@ -407,6 +407,21 @@ extern "C"
         const axutil_env_t *env,
         axutil_array_list_t *mime_parts);
 
+    /**
+     * Logs the first bytes of a message written by the transport, when the
+     * message context asks for it with AXIS2_TRANSPORT_TEE_OUT
+     * @param env pointer to environment struct
+     * @param msg_ctx message context of the message written
+     * @param buffer bytes written
+     * @param size number of bytes written
+     */
+    AXIS2_EXTERN void AXIS2_CALL
+    axis2_http_transport_utils_tee_output(
+        const axutil_env_t * env,
+        axis2_msg_ctx_t * msg_ctx,
+        const axis2_char_t * buffer,
+        int size);
+
 
 
     /** @} */
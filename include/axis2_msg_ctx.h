@@ -1029,6 +1029,35 @@ extern "C"
         const axis2_char_t * key,
         axutil_property_t * value);
 
+    /**
+     * Gets the property of a well known key, looked up in the same contexts
+     * as axis2_msg_ctx_get_property but by slot instead of by key.
+     * @param msg_ctx pointer to message context
+     * @param env pointer to environment struct
+     * @param slot slot of the key
+     * @return pointer to property struct
+     */
+    AXIS2_EXTERN axutil_property_t *AXIS2_CALL
+    axis2_msg_ctx_get_property_at(
+        const axis2_msg_ctx_t * msg_ctx,
+        const axutil_env_t * env,
+        axis2_ctx_slot_t slot);
+
+    /**
+     * Sets the property of a well known key.
+     * @param msg_ctx message context
+     * @param env pointer to environment struct
+     * @param slot slot of the key
+     * @param value property to be stored
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_msg_ctx_set_property_at(
+        axis2_msg_ctx_t * msg_ctx,
+        const axutil_env_t * env,
+        axis2_ctx_slot_t slot,
+        axutil_property_t * value);
+
     /**
      * Gets the QName of the handler at which invocation was paused.
      * @param msg_ctx message context
@@ -0,0 +1,69 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AXIS2_PASSTHROUGH_MSG_RECV_H
+#define AXIS2_PASSTHROUGH_MSG_RECV_H
+
+/** @defgroup axis2_passthrough_msg_recv pass-through message receiver
+ * @ingroup axis2_receivers
+ * Message receiver for services that route messages by their headers and
+ * pass the body on unchanged. The body of the request is not built: the
+ * service is invoked with a data source node holding the body content as
+ * text (see axiom_soap_body_capture_content), which is written out as it
+ * is when the service puts it in the body of the message it sends on.
+ * Setting the AXIS2_PASSTHROUGH_BODY option on that call gets the body of
+ * the response the same way, ready to be returned as the result. Headers
+ * are built and processed by the handlers as for any other message.
+ *
+ * Services choose the receiver with
+ * <messageReceiver class="axis2_passthrough_msg_recv"/>.
+ * @{
+ */
+
+/**
+ * @file axis2_passthrough_msg_recv.h
+ * @brief Axis2 pass-through message receiver interface
+ */
+
+#include <axis2_const.h>
+#include <axis2_defines.h>
+#include <axutil_env.h>
+#include <axis2_msg_recv.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /** Class name the receiver is configured with in services.xml */
+#define AXIS2_PASSTHROUGH_MSG_RECV "axis2_passthrough_msg_recv"
+
+    /**
+     * Creates pass-through message receiver struct
+     * @param env pointer to environment struct
+     * @return pointer to newly created pass-through message receiver
+     */
+    AXIS2_EXTERN axis2_msg_recv_t *AXIS2_CALL
+    axis2_passthrough_msg_recv_create(
+        const axutil_env_t * env);
+
+    /** @} */
+
+#ifdef __cplusplus
+}
+#endif
+#endif                          /* AXIS2_PASSTHROUGH_MSG_RECV_H */
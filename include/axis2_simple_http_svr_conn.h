@@ -85,6 +85,64 @@ extern "C"
         axis2_simple_http_svr_conn_t * svr_conn,
         const axutil_env_t * env);
 
+    /**
+     * Sets how many requests the connection serves. Keep alive is refused
+     * for the last of them, so that the response tells the client the
+     * connection is closed. The default is 1.
+     * @param svr_conn pointer to server connection struct
+     * @param env pointer to environment struct
+     * @param max_requests number of requests served on the connection
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_simple_http_svr_conn_set_max_requests(
+        axis2_simple_http_svr_conn_t * svr_conn,
+        const axutil_env_t * env,
+        int max_requests);
+
+    /**
+     * Sets how many requests in a row a client may pipeline, that is send
+     * before the response to the previous one. Pipelined requests are served
+     * in order; past the depth, the connection is closed after answering.
+     * @param svr_conn pointer to server connection struct
+     * @param env pointer to environment struct
+     * @param max_pipeline_depth number of requests in a row
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_simple_http_svr_conn_set_max_pipeline_depth(
+        axis2_simple_http_svr_conn_t * svr_conn,
+        const axutil_env_t * env,
+        int max_pipeline_depth);
+
+    /**
+     * Waits for the client to start another request on the connection. A
+     * request already received, pipelined, is returned at once.
+     * @param svr_conn pointer to server connection struct
+     * @param env pointer to environment struct
+     * @param timeout longest time to wait in milliseconds
+     * @return AXIS2_TRUE if data arrived, AXIS2_FALSE if the connection was
+     * closed or stayed idle for the timeout
+     */
+    AXIS2_EXTERN axis2_bool_t AXIS2_CALL
+    axis2_simple_http_svr_conn_wait_for_request(
+        axis2_simple_http_svr_conn_t * svr_conn,
+        const axutil_env_t * env,
+        int timeout);
+
+    /**
+     * Reads and discards what is left of the body of the last request read,
+     * which the service may not have read in full.
+     * @param svr_conn pointer to server connection struct
+     * @param env pointer to environment struct
+     * @return AXIS2_SUCCESS if the connection is at the start of the next
+     * request, AXIS2_FAILURE if it cannot be used for another request
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_simple_http_svr_conn_drain_body(
+        axis2_simple_http_svr_conn_t * svr_conn,
+        const axutil_env_t * env);
+
     /**
      * @param svr_conn pointer to server connection struct
      * @param env pointer to environment struct
@@ -174,6 +232,31 @@ extern "C"
         const axis2_simple_http_svr_conn_t * svr_conn,
         const axutil_env_t * env);
 
+    /**
+     * Moves the bytes read from the socket and not used by the requests read
+     * so far to a buffer, for whoever reads from the socket next.
+     * @param svr_conn pointer to server connection struct
+     * @param env pointer to environment struct
+     * @param buffer buffer to move the bytes to
+     * @param size size of the buffer
+     * @return number of bytes moved
+     */
+    AXIS2_EXTERN int AXIS2_CALL
+    axis2_simple_http_svr_conn_take_buffered(
+        axis2_simple_http_svr_conn_t * svr_conn,
+        const axutil_env_t * env,
+        axis2_char_t * buffer,
+        int size);
+
+    /**
+     * @param svr_conn pointer to server connection struct
+     * @param env pointer to environment struct
+     * @return socket of the connection
+     */
+    AXIS2_EXTERN int AXIS2_CALL
+    axis2_simple_http_svr_conn_get_socket(
+        const axis2_simple_http_svr_conn_t * svr_conn,
+        const axutil_env_t * env);
 
     /**
      * @param svr_conn pointer to server connection struct
@@ -196,6 +279,21 @@ extern "C"
         const axutil_env_t * env,
         int sockfd);
 
+    /**
+     * Creates a connection that writes the response to a stream instead of
+     * the socket, for a request that arrived on a connection multiplexing
+     * several, such as an HTTP/2 stream. The socket only tells the
+     * addresses. Neither the socket nor the stream is closed on free.
+     * @param env pointer to environment struct
+     * @param sockfd socket the request arrived on
+     * @param stream stream to write the HTTP/1.1 response to
+     */
+    AXIS2_EXTERN axis2_simple_http_svr_conn_t *AXIS2_CALL
+    axis2_simple_http_svr_conn_create_with_stream(
+        const axutil_env_t * env,
+        int sockfd,
+        axutil_stream_t * stream);
+
     /** @} */
 
 #ifdef __cplusplus
@@ -71,6 +71,7 @@ extern "C"
     struct axutil_param_container;
     struct axis2_module_desc;
     struct axis2_conf;
+    struct axis2_core_utils_rest_trie;
 
     /**
      * Frees service.
@@ -140,6 +141,17 @@ extern "C"
         const axis2_svc_t * svc,
         const axutil_env_t * env);
 
+    /**
+     * Gets the REST location templates of the service compiled for matching
+     * @param svc pointer to service struct
+     * @param env pointer to environment struct
+     * @return pointer to the trie, NULL if the service has no REST mappings
+     */
+    AXIS2_EXTERN struct axis2_core_utils_rest_trie *AXIS2_CALL
+    axis2_svc_get_rest_trie(
+        const axis2_svc_t * svc,
+        const axutil_env_t * env);
+
     /**
      * Gets operation corresponding to the name.
      * @param svc pointer to service struct
@@ -1208,6 +1220,22 @@ extern "C"
         const axis2_svc_t * svc,
         const axutil_env_t * env);
 
+    /**
+     * Calculates the effective policies of all the operations of the service
+     * and of their messages, so that looking them up while serving requests
+     * does not have to merge or normalize anything. Results stay cached on
+     * the policy includes until a policy of the description or of one of
+     * its parents changes.
+     * @param svc pointer to service struct
+     * @param env pointer to environment struct
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE if a policy of
+     * the service, an operation or a message could not be merged
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_svc_calculate_effective_policies(
+        axis2_svc_t * svc,
+        const axutil_env_t * env);
+
 	/* Get the mutex associated with this service 
 	 * @param svc pointer to message
      * @param env pointer to environment struct
@@ -51,6 +51,8 @@
 #include <axis2_endpoint_ref.h>
 #include <axis2_svc_ctx.h>
 #include <axis2_conf_ctx.h>
+#include <axis2_conf_ctx_cache.h>
+#include <axis2_async_engine.h>
 #include <axis2_op_client.h>
 #include <axutil_string.h>
 #include <neethi_policy.h>
@@ -141,6 +143,48 @@ extern "C"
         const axis2_svc_client_t * svc_client,
         const axutil_env_t * env);
 
+    /**
+     * Sets options for the following invocations. Anything they leave unset
+     * is taken from the options of the service client, so a caller only
+     * fills in what differs for a call, such as the endpoint address or
+     * the action, and can reuse the same struct for every call. Unlike
+     * options given to axis2_svc_client_set_options and
+     * axis2_svc_client_set_override_options, the service client does not
+     * take ownership of them; they must stay valid until replaced or unset
+     * with NULL, and for non blocking calls until the callback completes.
+     * While installed, their parent is set to the options of the service
+     * client, so they cannot be installed on two clients at once; the
+     * parent they had is given back when they are replaced, unset or the
+     * client is freed.
+     * @param svc_client pointer to service client struct
+     * @param env pointer to environment struct
+     * @param call_options pointer to options struct, or NULL to unset
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_svc_client_set_call_options(
+        axis2_svc_client_t * svc_client,
+        const axutil_env_t * env,
+        axis2_options_t * call_options);
+
+    /**
+     * Makes the non blocking invocations of this client run on an
+     * asynchronous engine rather than on a thread each. As a service client
+     * has one invocation in flight at a time, an application with many
+     * outstanding calls uses a client per call, cheaply created with
+     * axis2_svc_client_create_with_conf_ctx_cache, all sharing one engine.
+     * @param svc_client pointer to service client struct
+     * @param env pointer to environment struct
+     * @param async_engine pointer to engine, or NULL to go back to threads.
+     * The engine is not owned by the service client
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_svc_client_set_async_engine(
+        axis2_svc_client_t * svc_client,
+        const axutil_env_t * env,
+        axis2_async_engine_t * async_engine);
+
     /**
      * Engages the named module. The engaged modules extend the message
      * processing when consuming services. Modules help to apply QoS
@@ -517,6 +561,26 @@ extern "C"
         axis2_conf_ctx_t * conf_ctx,
         axis2_svc_t * svc);
 
+    /**
+     * Creates a service client using the configuration context cached for
+     * client_home, building it only for the first client of that
+     * repository. The client holds a reference to the configuration context
+     * until it is freed. Each client still has its own anonymous service,
+     * so modules engaged and policies set on one client do not affect the
+     * others.
+     * @param env pointer to environment struct
+     * @param client_home name of the directory that contains the Axis2/C repository
+     * @param conf_ctx_cache pointer to the cache to take the configuration
+     * context from. It must outlive the client
+     * @return a pointer to newly created service client struct,
+     *         or NULL on error with error code set in environment's error
+     */
+    AXIS2_EXTERN axis2_svc_client_t *AXIS2_CALL
+    axis2_svc_client_create_with_conf_ctx_cache(
+        const axutil_env_t * env,
+        const axis2_char_t * client_home,
+        axis2_conf_ctx_cache_t * conf_ctx_cache);
+
     /**
      * Gets the last response SOAP envelope. 
      * @param svc_client pointer to service_client struct
@@ -80,6 +80,21 @@ static void neethi_engine_clear_element_attributes(
     axutil_hash_t *attr_hash,
     const axutil_env_t *env);
 
+static axis2_bool_t neethi_engine_components_contain(
+    axutil_array_list_t *components,
+    void *value,
+    const axutil_env_t *env);
+
+static void neethi_engine_all_add_unique_components(
+    neethi_all_t *all,
+    axutil_array_list_t *components,
+    const axutil_env_t *env);
+
+static axis2_bool_t neethi_engine_exactlyone_has_alternative(
+    neethi_exactlyone_t *exactlyone,
+    neethi_all_t *all,
+    const axutil_env_t *env);
+
 
 /*Implementations*/
 
@@ -1232,10 +1247,32 @@ static neethi_exactlyone_t *neethi_engine_compute_resultant_component(
                 axutil_array_list_get(normalized_inner_components, env, i);
             if (inner_exactlyone)
             {
-                neethi_exactlyone_add_policy_components(exactlyone,
-                                                        neethi_exactlyone_get_policy_components
-                                                        (inner_exactlyone, env),
-                                                        env);
+                axutil_array_list_t *alternatives = NULL;
+                int j = 0;
+
+                /* The same alternative reached through different branches
+                 * is only kept once, otherwise later cross products grow
+                 * with every copy */
+
+                alternatives = neethi_exactlyone_get_policy_components(
+                    inner_exactlyone, env);
+                for (j = 0; j < axutil_array_list_size(alternatives, env); j++)
+                {
+                    neethi_operator_t *alternative = NULL;
+                    alternative = (neethi_operator_t *)
+                        axutil_array_list_get(alternatives, env, j);
+
+                    if (neethi_operator_get_type(alternative, env) ==
+                        OPERATOR_TYPE_ALL &&
+                        neethi_engine_exactlyone_has_alternative(exactlyone,
+                            (neethi_all_t *) neethi_operator_get_value(
+                                alternative, env), env))
+                    {
+                        continue;
+                    }
+                    neethi_exactlyone_add_operator(exactlyone, env,
+                                                   alternative);
+                }
             }
             else
             {
@@ -1407,13 +1444,25 @@ static neethi_exactlyone_t *neethi_engine_get_cross_product(
                 AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "Out of memory");
                 return NULL;
             }
-            neethi_all_add_policy_components(cross_product_all,
-                                             neethi_all_get_policy_components
-                                             (current_all1, env), env);
+            /* An assertion present in both alternatives is taken once and
+             * a combination that is already in the result is dropped */
+
+            neethi_engine_all_add_unique_components(cross_product_all,
+                                                    neethi_all_get_policy_components
+                                                    (current_all1, env), env);
 
-            neethi_all_add_policy_components(cross_product_all,
-                                             neethi_all_get_policy_components
-                                             (current_all2, env), env);
+            neethi_engine_all_add_unique_components(cross_product_all,
+                                                    neethi_all_get_policy_components
+                                                    (current_all2, env), env);
+
+            if (neethi_engine_exactlyone_has_alternative(cross_product,
+                                                         cross_product_all,
+                                                         env))
+            {
+                neethi_all_free(cross_product_all, env);
+                cross_product_all = NULL;
+                continue;
+            }
 
             component = neethi_operator_create(env);
             if (!component)
@@ -1431,6 +1480,132 @@ static neethi_exactlyone_t *neethi_engine_get_cross_product(
     return cross_product;
 }
 
+/* Components are compared by the object they wrap, since normalization and
+ * merging share the assertions of the source policies instead of copying
+ * them. */
+
+static axis2_bool_t neethi_engine_components_contain(
+    axutil_array_list_t *components,
+    void *value,
+    const axutil_env_t *env)
+{
+    int i = 0;
+
+    for (i = 0; i < axutil_array_list_size(components, env); i++)
+    {
+        neethi_operator_t *component = NULL;
+        component = (neethi_operator_t *)
+            axutil_array_list_get(components, env, i);
+        if (component && neethi_operator_get_value(component, env) == value)
+        {
+            return AXIS2_TRUE;
+        }
+    }
+    return AXIS2_FALSE;
+}
+
+static void neethi_engine_all_add_unique_components(
+    neethi_all_t *all,
+    axutil_array_list_t *components,
+    const axutil_env_t *env)
+{
+    int i = 0;
+
+    for (i = 0; i < axutil_array_list_size(components, env); i++)
+    {
+        neethi_operator_t *component = NULL;
+        component = (neethi_operator_t *)
+            axutil_array_list_get(components, env, i);
+        if (!component || neethi_engine_components_contain(
+                neethi_all_get_policy_components(all, env),
+                neethi_operator_get_value(component, env), env))
+        {
+            continue;
+        }
+        neethi_all_add_operator(all, env, component);
+    }
+}
+
+/* Returns true when the exactlyone already holds an alternative made of
+ * the same components as all, in any order */
+
+static axis2_bool_t neethi_engine_exactlyone_has_alternative(
+    neethi_exactlyone_t *exactlyone,
+    neethi_all_t *all,
+    const axutil_env_t *env)
+{
+    axutil_array_list_t *alternatives = NULL;
+    axutil_array_list_t *components = NULL;
+    int size = 0;
+    int i = 0;
+
+    if (!all)
+    {
+        return AXIS2_FALSE;
+    }
+
+    alternatives = neethi_exactlyone_get_policy_components(exactlyone, env);
+    components = neethi_all_get_policy_components(all, env);
+    size = axutil_array_list_size(components, env);
+
+    for (i = 0; i < axutil_array_list_size(alternatives, env); i++)
+    {
+        neethi_operator_t *alternative = NULL;
+        axutil_array_list_t *other = NULL;
+        int j = 0;
+
+        alternative = (neethi_operator_t *)
+            axutil_array_list_get(alternatives, env, i);
+        if (!alternative ||
+            neethi_operator_get_type(alternative, env) != OPERATOR_TYPE_ALL)
+        {
+            continue;
+        }
+
+        other = neethi_all_get_policy_components((neethi_all_t *)
+            neethi_operator_get_value(alternative, env), env);
+        if (axutil_array_list_size(other, env) != size)
+        {
+            continue;
+        }
+
+        for (j = 0; j < size; j++)
+        {
+            neethi_operator_t *component = NULL;
+            component = (neethi_operator_t *)
+                axutil_array_list_get(components, env, j);
+            if (!neethi_engine_components_contain(other,
+                    neethi_operator_get_value(component, env), env))
+            {
+                break;
+            }
+        }
+        if (j < size)
+        {
+            continue;
+        }
+
+        /* Checked both ways in case either side repeats a component */
+
+        for (j = 0; j < size; j++)
+        {
+            neethi_operator_t *component = NULL;
+            component = (neethi_operator_t *)
+                axutil_array_list_get(other, env, j);
+            if (!neethi_engine_components_contain(components,
+                    neethi_operator_get_value(component, env), env))
+            {
+                break;
+            }
+        }
+        if (j == size)
+        {
+            return AXIS2_TRUE;
+        }
+    }
+    return AXIS2_FALSE;
+}
+
 /*These functions are for serializing a policy object*/
 
 AXIS2_EXTERN axiom_node_t *AXIS2_CALL
@@ -152,32 +152,27 @@ axis2_mtom_mtom(
 
                     else if (axiom_node_get_node_type(binary_node, env) == AXIOM_TEXT) /* attachment has come by value, as non-optimized binary */
                     {
-                        int plain_binary_len = 0;
-                        int ret_len = 0;
                         axiom_text_t *bin_text = (axiom_text_t *)
                             axiom_node_get_data_element(binary_node, env);
-                        axis2_byte_t *plain_binary = NULL;
                         axiom_data_handler_t *data_handler = NULL;
 
                         axis2_char_t *base64text =
                             (axis2_char_t *) axiom_text_get_value(bin_text,
                                                                   env);
                         printf("base64text = %s\n", base64text);
-                        plain_binary_len = axutil_base64_decode_len(base64text);
-                        plain_binary = AXIS2_MALLOC(env->
-                                                    allocator,
-                                                    sizeof(unsigned char) *
-                                                    plain_binary_len);
-                        ret_len =
-                            axutil_base64_decode_binary((unsigned char *)
-                                                        plain_binary,
-                                                        base64text);
+                        /* line wrapped text is decoded as well */
                         data_handler =
-                            axiom_data_handler_create(env, text_str, NULL);
-                        axiom_data_handler_set_binary_data(data_handler, env,
-                                                           plain_binary,
-                                                           ret_len);
+                            axiom_text_create_data_handler_from_base64(bin_text,
+                                                                       env,
+                                                                       NULL);
+                        if (!data_handler)
+                        {
+                            return NULL;
+                        }
+                        axiom_data_handler_set_file_name(data_handler, env,
+                                                         text_str);
                         axiom_data_handler_write_to(data_handler, env);
+                        axiom_data_handler_free(data_handler, env);
                         ret_node = build_response1(env, base64text);
                     }
                     else /* nothing came */
@@ -0,0 +1,1714 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <axis2_async_engine.h>
+#include <axis2_engine.h>
+#include <axis2_transport_sender.h>
+#include <axis2_transport_out_desc.h>
+#include <axis2_http_transport.h>
+#include <axis2_callback.h>
+#include <axis2_async_result.h>
+#include <axiom_xml_writer.h>
+#include <axiom_xml_reader.h>
+#include <axiom_output.h>
+#include <axiom_stax_builder.h>
+#include <axiom_soap_builder.h>
+#include <axiom_soap_const.h>
+#include <axutil_uri.h>
+#include <axutil_thread.h>
+#include <axutil_thread_pool.h>
+#include <axutil_property.h>
+#include <platforms/axutil_platform_auto_sense.h>
+
+#ifdef HAVE_SYS_EPOLL_H
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+
+/* Operation context property through which the sender finds its call */
+#define AXIS2_ASYNC_ENGINE_CALL "AsyncEngineCall"
+
+/* Response message context property owning the buffer the response
+   envelope is built from */
+#define AXIS2_ASYNC_ENGINE_RESPONSE "AsyncEngineResponse"
+
+#define AXIS2_ASYNC_ENGINE_READ_SIZE 8192
+#define AXIS2_ASYNC_ENGINE_MAX_HEADER_SIZE 65536
+#define AXIS2_ASYNC_ENGINE_MAX_EVENTS 64
+
+/* Idle connections kept per I/O thread */
+#define AXIS2_ASYNC_ENGINE_MAX_IDLE 64
+
+/* How often, in milliseconds, calls are checked for time outs */
+#define AXIS2_ASYNC_ENGINE_TICK 100
+
+typedef struct axis2_async_conn
+{
+    /* host:port the connection is open to */
+    axis2_char_t *key;
+    int fd;
+    struct axis2_async_conn *next;
+} axis2_async_conn_t;
+
+typedef struct axis2_async_call
+{
+    axis2_op_client_t *op_client;
+
+    /* Out message context, owned by the operation client */
+    axis2_msg_ctx_t *msg_ctx;
+
+    /* Operation context of the operation client */
+    axis2_op_ctx_t *op_ctx;
+
+    axis2_char_t *key;
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+
+    axis2_char_t *request;
+    int request_len;
+    int sent;
+
+    axis2_char_t *response;
+    int response_len;
+    int response_size;
+
+    /* Length of the response head, 0 until it has been read */
+    int header_len;
+    int status_code;
+    int content_length;
+    axis2_bool_t chunked;
+    axis2_bool_t keep_alive;
+
+    /* Offset, from the start of the body, of the next chunk to check */
+    int chunk_scan;
+    int body_len;
+
+    int fd;
+    axis2_bool_t connected;
+
+    /* The connection came from the idle pool and may have been closed by
+       the server meanwhile; such a call is retried once on a new one */
+    axis2_bool_t reused;
+
+    /* Milliseconds since the engine started, 0 for no time out */
+    long deadline;
+
+    struct axis2_async_call *prev;
+    struct axis2_async_call *next;
+} axis2_async_call_t;
+
+typedef struct axis2_async_io_thread
+{
+    axis2_async_engine_t *async_engine;
+    axutil_thread_t *thread;
+    int epoll_fd;
+
+    /* Written to wake the thread up for new calls or to stop */
+    int wakeup[2];
+
+    /* Guards submitted and stop */
+    axutil_thread_mutex_t *mutex;
+    axis2_async_call_t *submitted;
+    axis2_bool_t stop;
+
+    /* Only touched by the thread itself */
+    axis2_async_call_t *active;
+    axis2_async_conn_t *idle;
+    int idle_count;
+} axis2_async_io_thread_t;
+
+typedef struct axis2_async_engine_sender
+{
+    axis2_transport_sender_t sender;
+} axis2_async_engine_sender_t;
+
+struct axis2_async_engine
+{
+    const axutil_env_t *env;
+
+    /* Transport out whose sender prepares the request instead of
+       sending it */
+    axis2_transport_out_desc_t *transport_out;
+
+    axis2_async_io_thread_t *threads;
+    int io_threads;
+
+    /* Guards next */
+    axutil_thread_mutex_t *mutex;
+    int next;
+
+    struct AXIS2_PLATFORM_TIMEB start;
+};
+
+static void axis2_async_io_thread_connect(
+    axis2_async_io_thread_t * io,
+    const axutil_env_t * env,
+    axis2_async_call_t * call);
+
+static long
+axis2_async_engine_now(
+    axis2_async_engine_t * async_engine)
+{
+    struct AXIS2_PLATFORM_TIMEB now;
+
+    AXIS2_PLATFORM_GET_TIME_IN_MILLIS(&now);
+    return (long) (now.time - async_engine->start.time) * 1000 +
+        (now.millitm - async_engine->start.millitm);
+}
+
+static void
+axis2_async_call_free(
+    axis2_async_call_t * call,
+    const axutil_env_t * env)
+{
+    if (call->fd >= 0)
+    {
+        close(call->fd);
+    }
+    if (call->key)
+    {
+        AXIS2_FREE(env->allocator, call->key);
+    }
+    if (call->request)
+    {
+        AXIS2_FREE(env->allocator, call->request);
+    }
+    if (call->response)
+    {
+        AXIS2_FREE(env->allocator, call->response);
+    }
+    AXIS2_FREE(env->allocator, call);
+}
+
+/* Resolves the endpoint of the message and writes the HTTP request for it.
+   This runs in the calling thread, so name resolution does not hold up
+   the I/O threads */
+static axis2_status_t
+axis2_async_call_prepare(
+    axis2_async_call_t * call,
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx)
+{
+    const axis2_char_t *address = NULL;
+    const axis2_char_t *authority = NULL;
+    const axis2_char_t *port_part = NULL;
+    const axis2_char_t *target = NULL;
+    axis2_char_t *host = NULL;
+    axis2_endpoint_ref_t *to = NULL;
+    axiom_soap_envelope_t *envelope = NULL;
+    axiom_xml_writer_t *xml_writer = NULL;
+    axiom_output_t *om_output = NULL;
+    axis2_char_t *xml = NULL;
+    int xml_len = 0;
+    const axis2_char_t *char_set_enc = NULL;
+    const axis2_char_t *soap_action = NULL;
+    axis2_bool_t is_soap11 = AXIS2_TRUE;
+    axis2_char_t port_str[16];
+    axis2_char_t head[1024];
+    struct addrinfo hints;
+    struct addrinfo *result = NULL;
+    int head_len = 0;
+    int port = 0;
+
+    address = axis2_msg_ctx_get_transport_url(msg_ctx, env);
+    if (!address)
+    {
+        to = axis2_msg_ctx_get_to(msg_ctx, env);
+        if (to)
+        {
+            address = axis2_endpoint_ref_get_address(to, env);
+        }
+    }
+    if (!address)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NULL_URL, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "Cannot find endpoint address for asynchronous call");
+        return AXIS2_FAILURE;
+    }
+
+    /* The authority is parsed here rather than with axutil_url, which does
+       not know bracketed IPv6 literals. The request target is everything
+       after it, query included */
+    authority = strstr(address, "://");
+    authority = authority ? authority + 3 : address;
+    target = authority;
+    while (*target && *target != '/' && *target != '?')
+    {
+        target++;
+    }
+    if (*authority == '[')
+    {
+        port_part = memchr(authority, ']', target - authority);
+        if (port_part)
+        {
+            host = axutil_strndup(env, authority + 1,
+                                  (int) (port_part - authority) - 1);
+            port_part++;
+        }
+    }
+    else
+    {
+        port_part = memchr(authority, ':', target - authority);
+        if (!port_part)
+        {
+            port_part = target;
+        }
+        host = axutil_strndup(env, authority, (int) (port_part - authority));
+    }
+    if (port_part == target)
+    {
+        port = axutil_uri_port_of_scheme("http");
+    }
+    else if (port_part && *port_part == ':')
+    {
+        port = atoi(port_part + 1);
+    }
+    if (!host || !*host || port <= 0 || port > 65535)
+    {
+        if (host)
+        {
+            AXIS2_FREE(env->allocator, host);
+        }
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_INVALID_URL_FORMAT,
+                        AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "Invalid endpoint address %s",
+                        address);
+        return AXIS2_FAILURE;
+    }
+
+    sprintf(port_str, "%d", port);
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, port_str, &hints, &result) || !result)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_SOCKET_ERROR, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "Cannot resolve host %s",
+                        host);
+        AXIS2_FREE(env->allocator, host);
+        return AXIS2_FAILURE;
+    }
+    memcpy(&call->addr, result->ai_addr, result->ai_addrlen);
+    call->addr_len = result->ai_addrlen;
+    freeaddrinfo(result);
+
+    /* The key doubles as the Host header, where IPv6 literals go in
+       brackets */
+    call->key = AXIS2_MALLOC(env->allocator, axutil_strlen(host) + 16);
+    if (!call->key)
+    {
+        AXIS2_FREE(env->allocator, host);
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+    sprintf(call->key, strchr(host, ':') ? "[%s]:%d" : "%s:%d", host, port);
+    AXIS2_FREE(env->allocator, host);
+
+    envelope = axis2_msg_ctx_get_soap_envelope(msg_ctx, env);
+    if (!envelope)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NULL_SOAP_ENVELOPE_IN_MSG_CTX,
+                        AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "%s",
+                        AXIS2_ERROR_GET_MESSAGE(env->error));
+        return AXIS2_FAILURE;
+    }
+
+    xml_writer = axiom_xml_writer_create_for_memory(env, NULL, AXIS2_TRUE, 0,
+                                                    AXIS2_XML_PARSER_TYPE_BUFFER);
+    if (!xml_writer)
+    {
+        return AXIS2_FAILURE;
+    }
+    om_output = axiom_output_create(env, xml_writer);
+    if (!om_output)
+    {
+        axiom_xml_writer_free(xml_writer, env);
+        return AXIS2_FAILURE;
+    }
+    is_soap11 = axis2_msg_ctx_get_is_soap_11(msg_ctx, env);
+    axiom_output_set_soap11(om_output, env, is_soap11);
+    axiom_soap_envelope_serialize(envelope, env, om_output, AXIS2_FALSE);
+    xml = (axis2_char_t *) axiom_xml_writer_get_xml(xml_writer, env);
+    xml_len = axiom_xml_writer_get_xml_size(xml_writer, env);
+
+    if (axis2_msg_ctx_get_charset_encoding(msg_ctx, env))
+    {
+        char_set_enc = axutil_string_get_buffer(
+            axis2_msg_ctx_get_charset_encoding(msg_ctx, env), env);
+    }
+    if (!char_set_enc)
+    {
+        char_set_enc = AXIS2_DEFAULT_CHAR_SET_ENCODING;
+    }
+    if (axis2_msg_ctx_get_soap_action(msg_ctx, env))
+    {
+        soap_action = axutil_string_get_buffer(
+            axis2_msg_ctx_get_soap_action(msg_ctx, env), env);
+    }
+    if (!soap_action)
+    {
+        soap_action = "";
+    }
+
+    if (axutil_strlen(target) + axutil_strlen(call->key) +
+        axutil_strlen(char_set_enc) + axutil_strlen(soap_action) + 256 >
+        sizeof(head))
+    {
+        axiom_output_free(om_output, env);
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_INVALID_URL_FORMAT,
+                        AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "Request line and headers too long for %s", address);
+        return AXIS2_FAILURE;
+    }
+
+    head_len = sprintf(head, "POST %s%s HTTP/1.1\r\n%s: %s\r\n%s: %s\r\n",
+                       *target == '/' ? "" : "/", target,
+                       AXIS2_HTTP_HEADER_HOST, call->key,
+                       AXIS2_HTTP_HEADER_USER_AGENT, AXIS2_USER_AGENT);
+    if (is_soap11)
+    {
+        head_len += sprintf(head + head_len, "%s: %s%s%s\r\n%s: %s%s%s\r\n",
+                            AXIS2_HTTP_HEADER_CONTENT_TYPE,
+                            AXIS2_HTTP_HEADER_ACCEPT_TEXT_XML,
+                            AXIS2_CONTENT_TYPE_CHARSET, char_set_enc,
+                            AXIS2_HTTP_HEADER_SOAP_ACTION,
+                            *soap_action == '"' ? "" : "\"", soap_action,
+                            *soap_action == '"' ? "" : "\"");
+    }
+    else
+    {
+        head_len += sprintf(head + head_len, "%s: %s%s%s",
+                            AXIS2_HTTP_HEADER_CONTENT_TYPE,
+                            AXIS2_HTTP_HEADER_ACCEPT_APPL_SOAP,
+                            AXIS2_CONTENT_TYPE_CHARSET, char_set_enc);
+        if (*soap_action)
+        {
+            head_len += sprintf(head + head_len, "%s%s\"",
+                                AXIS2_CONTENT_TYPE_ACTION, soap_action);
+        }
+        head_len += sprintf(head + head_len, "\r\n");
+    }
+    head_len += sprintf(head + head_len, "%s: %d\r\n\r\n",
+                        AXIS2_HTTP_HEADER_CONTENT_LENGTH, xml_len);
+
+    call->request = AXIS2_MALLOC(env->allocator, head_len + xml_len);
+    if (!call->request)
+    {
+        axiom_output_free(om_output, env);
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+    memcpy(call->request, head, head_len);
+    memcpy(call->request + head_len, xml, xml_len);
+    call->request_len = head_len + xml_len;
+    axiom_output_free(om_output, env);
+
+    AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI,
+                    "Prepared asynchronous request of %d bytes to %s",
+                    call->request_len, address);
+    return AXIS2_SUCCESS;
+}
+
+static axis2_status_t AXIS2_CALL
+axis2_async_engine_sender_init(
+    axis2_transport_sender_t * transport_sender,
+    const axutil_env_t * env,
+    axis2_conf_ctx_t * conf_ctx,
+    axis2_transport_out_desc_t * transport_out)
+{
+    return AXIS2_SUCCESS;
+}
+
+/* Last step of the out flow. The request is only prepared here; it is
+   queued by axis2_async_engine_send once the flow is done */
+static axis2_status_t AXIS2_CALL
+axis2_async_engine_sender_invoke(
+    axis2_transport_sender_t * transport_sender,
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx)
+{
+    axis2_op_ctx_t *op_ctx = NULL;
+    axutil_property_t *property = NULL;
+
+    op_ctx = axis2_msg_ctx_get_op_ctx(msg_ctx, env);
+    if (op_ctx)
+    {
+        property = axis2_ctx_get_property(axis2_op_ctx_get_base(op_ctx, env),
+                                          env, AXIS2_ASYNC_ENGINE_CALL);
+    }
+    if (!property)
+    {
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "Message was not sent through the asynchronous engine");
+        return AXIS2_FAILURE;
+    }
+
+    return axis2_async_call_prepare(axutil_property_get_value(property, env),
+                                    env, msg_ctx);
+}
+
+static axis2_status_t AXIS2_CALL
+axis2_async_engine_sender_clean_up(
+    axis2_transport_sender_t * transport_sender,
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx)
+{
+    return AXIS2_SUCCESS;
+}
+
+static void AXIS2_CALL
+axis2_async_engine_sender_free(
+    axis2_transport_sender_t * transport_sender,
+    const axutil_env_t * env)
+{
+    AXIS2_FREE(env->allocator, transport_sender);
+}
+
+static const axis2_transport_sender_ops_t axis2_async_engine_sender_ops_var = {
+    axis2_async_engine_sender_init,
+    axis2_async_engine_sender_invoke,
+    axis2_async_engine_sender_clean_up,
+    axis2_async_engine_sender_free
+};
+
+/* Builds the response message context and runs it through the in flow,
+   as axis2_op_client_two_way_send does for blocking calls */
+static axis2_msg_ctx_t *
+axis2_async_call_create_response(
+    axis2_async_call_t * call,
+    const axutil_env_t * env)
+{
+    axis2_msg_ctx_t *msg_ctx = call->msg_ctx;
+    axis2_msg_ctx_t *response = NULL;
+    axis2_conf_ctx_t *conf_ctx = NULL;
+    axis2_op_t *op = NULL;
+    axis2_engine_t *engine = NULL;
+    axiom_xml_reader_t *reader = NULL;
+    axiom_stax_builder_t *om_builder = NULL;
+    axiom_soap_builder_t *soap_builder = NULL;
+    axiom_soap_envelope_t *envelope = NULL;
+    axutil_property_t *property = NULL;
+    axis2_status_t status = AXIS2_FAILURE;
+
+    if (call->body_len <= 0 ||
+        ((call->status_code < 200 || call->status_code > 299) &&
+         call->status_code != 500))
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_HTTP_CLIENT_TRANSPORT_ERROR,
+                        AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "No SOAP response from %s, HTTP status %d",
+                        call->key, call->status_code);
+        return NULL;
+    }
+
+    conf_ctx = axis2_msg_ctx_get_conf_ctx(msg_ctx, env);
+    response = axis2_msg_ctx_create(env, conf_ctx,
+                                    axis2_msg_ctx_get_transport_in_desc(msg_ctx,
+                                                                        env),
+                                    axis2_msg_ctx_get_transport_out_desc(msg_ctx,
+                                                                         env));
+    if (!response)
+    {
+        return NULL;
+    }
+    axis2_msg_ctx_set_server_side(response, env, AXIS2_FALSE);
+    axis2_msg_ctx_set_conf_ctx(response, env, conf_ctx);
+    axis2_msg_ctx_set_svc_grp_ctx(response, env,
+                                  axis2_msg_ctx_get_svc_grp_ctx(msg_ctx, env));
+    axis2_msg_ctx_set_status_code(response, env, call->status_code);
+
+    op = axis2_msg_ctx_get_op(msg_ctx, env);
+    if (op)
+    {
+        axis2_op_register_op_ctx(op, env, response, call->op_ctx);
+    }
+
+    /* The parser reads straight from the buffer, so the response message
+       context takes it over */
+    memmove(call->response, call->response + call->header_len,
+            call->body_len);
+    property = axutil_property_create_with_args(env, AXIS2_SCOPE_REQUEST,
+                                                AXIS2_TRUE, NULL,
+                                                call->response);
+    if (!property)
+    {
+        axis2_msg_ctx_free(response, env);
+        return NULL;
+    }
+    axis2_msg_ctx_set_property(response, env, AXIS2_ASYNC_ENGINE_RESPONSE,
+                               property);
+    reader = axiom_xml_reader_create_for_memory(env, call->response,
+                                                call->body_len, NULL,
+                                                AXIS2_XML_PARSER_TYPE_BUFFER);
+    call->response = NULL;
+    if (reader)
+    {
+        om_builder = axiom_stax_builder_create(env, reader);
+    }
+    if (om_builder)
+    {
+        soap_builder = axiom_soap_builder_create(env, om_builder,
+                                                 axis2_msg_ctx_get_is_soap_11
+                                                 (msg_ctx, env) ?
+                                                 AXIOM_SOAP11_SOAP_ENVELOPE_NAMESPACE_URI
+                                                 :
+                                                 AXIOM_SOAP12_SOAP_ENVELOPE_NAMESPACE_URI);
+    }
+    if (soap_builder)
+    {
+        envelope = axiom_soap_builder_get_soap_envelope(soap_builder, env);
+    }
+    if (!envelope)
+    {
+        if (soap_builder)
+        {
+            axiom_soap_builder_free(soap_builder, env);
+        }
+        else if (om_builder)
+        {
+            axiom_stax_builder_free(om_builder, env);
+        }
+        else if (reader)
+        {
+            axiom_xml_reader_free(reader, env);
+        }
+        axis2_msg_ctx_free(response, env);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "Cannot build SOAP envelope from response of %s",
+                        call->key);
+        return NULL;
+    }
+    axis2_msg_ctx_set_soap_envelope(response, env, envelope);
+
+    engine = axis2_engine_create(env, conf_ctx);
+    if (engine)
+    {
+        status = axis2_engine_receive(engine, env, response);
+        axis2_engine_free(engine, env);
+    }
+    if (status != AXIS2_SUCCESS)
+    {
+        axis2_msg_ctx_free(response, env);
+        return NULL;
+    }
+    return response;
+}
+
+/* Reports the outcome of a call to its callback and frees it. Runs in the
+   I/O thread, like the rest of the call after the request is queued */
+static void
+axis2_async_call_finish(
+    axis2_async_call_t * call,
+    const axutil_env_t * env,
+    int error)
+{
+    axis2_callback_t *callback = NULL;
+    axis2_msg_ctx_t *response = NULL;
+    axis2_async_result_t *async_result = NULL;
+
+    callback = axis2_op_client_get_callback(call->op_client, env);
+
+    if (error == AXIS2_ERROR_NONE)
+    {
+        AXIS2_ERROR_SET_STATUS_CODE(env->error, AXIS2_SUCCESS);
+        response = axis2_async_call_create_response(call, env);
+        if (response)
+        {
+            axis2_op_client_add_msg_ctx(call->op_client, env, response);
+            async_result = axis2_async_result_create(env, response);
+            if (callback)
+            {
+                axis2_callback_invoke_on_complete(callback, env, async_result);
+                axis2_callback_set_complete(callback, env, AXIS2_TRUE);
+            }
+            if (async_result)
+            {
+                axis2_async_result_free(async_result, env);
+            }
+        }
+        else
+        {
+            error = env->error->error_number;
+            if (error == AXIS2_ERROR_NONE)
+            {
+                error = AXIS2_ERROR_HTTP_CLIENT_TRANSPORT_ERROR;
+            }
+        }
+    }
+
+    if (error != AXIS2_ERROR_NONE && callback)
+    {
+        axis2_callback_report_error(callback, env, error);
+        axis2_callback_set_complete(callback, env, AXIS2_TRUE);
+    }
+
+    axis2_async_call_free(call, env);
+}
+
+static void
+axis2_async_io_thread_unlink(
+    axis2_async_io_thread_t * io,
+    axis2_async_call_t * call)
+{
+    if (call->prev)
+    {
+        call->prev->next = call->next;
+    }
+    else
+    {
+        io->active = call->next;
+    }
+    if (call->next)
+    {
+        call->next->prev = call->prev;
+    }
+    call->prev = NULL;
+    call->next = NULL;
+}
+
+static void
+axis2_async_io_thread_fail(
+    axis2_async_io_thread_t * io,
+    const axutil_env_t * env,
+    axis2_async_call_t * call,
+    int error)
+{
+    axis2_async_io_thread_unlink(io, call);
+    if (call->fd >= 0)
+    {
+        epoll_ctl(io->epoll_fd, EPOLL_CTL_DEL, call->fd, NULL);
+    }
+    AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                    "Asynchronous call to %s failed with error %d",
+                    call->key, error);
+    axis2_async_call_finish(call, env, error);
+}
+
+/* Fails a call whose connection broke, unless the connection was a reused
+   one that the server closed before answering; then the request is sent
+   again on a new connection */
+static void
+axis2_async_io_thread_fail_or_retry(
+    axis2_async_io_thread_t * io,
+    const axutil_env_t * env,
+    axis2_async_call_t * call)
+{
+    if (!call->reused || call->response_len > 0)
+    {
+        axis2_async_io_thread_fail(io, env, call,
+                                   AXIS2_ERROR_HTTP_CLIENT_TRANSPORT_ERROR);
+        return;
+    }
+
+    AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI,
+                    "Kept alive connection to %s was closed, reconnecting",
+                    call->key);
+    epoll_ctl(io->epoll_fd, EPOLL_CTL_DEL, call->fd, NULL);
+    close(call->fd);
+    call->fd = -1;
+    call->sent = 0;
+    call->reused = AXIS2_FALSE;
+    axis2_async_io_thread_connect(io, env, call);
+}
+
+static void
+axis2_async_io_thread_watch(
+    axis2_async_io_thread_t * io,
+    axis2_async_call_t * call,
+    int op,
+    unsigned int events)
+{
+    struct epoll_event event;
+
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.ptr = call;
+    epoll_ctl(io->epoll_fd, op, call->fd, &event);
+}
+
+static void
+axis2_async_io_thread_connect(
+    axis2_async_io_thread_t * io,
+    const axutil_env_t * env,
+    axis2_async_call_t * call)
+{
+    axis2_async_conn_t *conn = NULL;
+    axis2_async_conn_t *prev = NULL;
+
+    for (conn = io->idle; conn; prev = conn, conn = conn->next)
+    {
+        if (!axutil_strcmp(conn->key, call->key))
+        {
+            break;
+        }
+    }
+    if (conn)
+    {
+        if (prev)
+        {
+            prev->next = conn->next;
+        }
+        else
+        {
+            io->idle = conn->next;
+        }
+        io->idle_count--;
+        call->fd = conn->fd;
+        call->connected = AXIS2_TRUE;
+        call->reused = AXIS2_TRUE;
+        AXIS2_FREE(env->allocator, conn->key);
+        AXIS2_FREE(env->allocator, conn);
+    }
+    else
+    {
+        call->fd = socket(call->addr.ss_family, SOCK_STREAM, 0);
+        if (call->fd < 0)
+        {
+            axis2_async_io_thread_fail(io, env, call, AXIS2_ERROR_SOCKET_ERROR);
+            return;
+        }
+        fcntl(call->fd, F_SETFL, fcntl(call->fd, F_GETFL, 0) | O_NONBLOCK);
+        fcntl(call->fd, F_SETFD, FD_CLOEXEC);
+        if (connect(call->fd, (struct sockaddr *) &call->addr, call->addr_len)
+            && errno != EINPROGRESS)
+        {
+            axis2_async_io_thread_fail(io, env, call, AXIS2_ERROR_SOCKET_ERROR);
+            return;
+        }
+        call->connected = AXIS2_FALSE;
+    }
+
+    axis2_async_io_thread_watch(io, call, EPOLL_CTL_ADD, EPOLLOUT);
+}
+
+static void
+axis2_async_io_thread_keep(
+    axis2_async_io_thread_t * io,
+    const axutil_env_t * env,
+    axis2_async_call_t * call)
+{
+    axis2_async_conn_t *conn = NULL;
+
+    if (io->idle_count < AXIS2_ASYNC_ENGINE_MAX_IDLE)
+    {
+        conn = AXIS2_MALLOC(env->allocator, sizeof(axis2_async_conn_t));
+    }
+    if (!conn)
+    {
+        close(call->fd);
+        call->fd = -1;
+        return;
+    }
+    conn->key = call->key;
+    conn->fd = call->fd;
+    conn->next = io->idle;
+    io->idle = conn;
+    io->idle_count++;
+    call->key = axutil_strdup(env, conn->key);
+    call->fd = -1;
+}
+
+static int
+axis2_async_header_is(
+    const axis2_char_t * line,
+    const axis2_char_t * name,
+    const axis2_char_t ** value)
+{
+    int len = axutil_strlen(name);
+
+    if (axutil_strncasecmp(line, name, len) || line[len] != ':')
+    {
+        return 0;
+    }
+    line += len + 1;
+    while (*line == ' ' || *line == '\t')
+    {
+        line++;
+    }
+    *value = line;
+    return 1;
+}
+
+/* Parses the status line and the headers the engine needs.
+   Returns 1 once the head is read, 0 if more is needed, -1 on error */
+static int
+axis2_async_call_parse_head(
+    axis2_async_call_t * call)
+{
+    axis2_char_t *end = NULL;
+    axis2_char_t *line = NULL;
+    axis2_char_t *next = NULL;
+    const axis2_char_t *value = NULL;
+
+    end = strstr(call->response, "\r\n\r\n");
+    if (!end)
+    {
+        return call->response_len > AXIS2_ASYNC_ENGINE_MAX_HEADER_SIZE ? -1 : 0;
+    }
+    if (strncmp(call->response, "HTTP/1.", 7) || call->response_len < 12)
+    {
+        return -1;
+    }
+    call->header_len = (int) (end - call->response) + 4;
+    call->status_code = atoi(call->response + 9);
+    call->keep_alive = call->response[7] != '0';
+    call->content_length = -1;
+    call->chunked = AXIS2_FALSE;
+
+    *end = '\0';
+    for (line = strstr(call->response, "\r\n"); line; line = next)
+    {
+        line += 2;
+        next = strstr(line, "\r\n");
+        if (next)
+        {
+            *next = '\0';
+        }
+        if (axis2_async_header_is(line, AXIS2_HTTP_HEADER_CONTENT_LENGTH,
+                                  &value))
+        {
+            call->content_length = atoi(value);
+        }
+        else if (axis2_async_header_is(line,
+                                       AXIS2_HTTP_HEADER_TRANSFER_ENCODING,
+                                       &value))
+        {
+            call->chunked = !axutil_strncasecmp(value,
+                                                AXIS2_HTTP_HEADER_TRANSFER_ENCODING_CHUNKED,
+                                                7);
+        }
+        else if (axis2_async_header_is(line, AXIS2_HTTP_HEADER_CONNECTION,
+                                       &value))
+        {
+            if (!axutil_strncasecmp(value, "close", 5))
+            {
+                call->keep_alive = AXIS2_FALSE;
+            }
+            else if (!axutil_strncasecmp(value, "keep-alive", 10))
+            {
+                call->keep_alive = AXIS2_TRUE;
+            }
+        }
+        if (next)
+        {
+            *next = '\r';
+        }
+    }
+    *end = '\r';
+
+    if (call->status_code >= 100 && call->status_code < 200)
+    {
+        /* Interim response such as 100 Continue, the real one follows */
+        call->response_len -= call->header_len;
+        memmove(call->response, call->response + call->header_len,
+                call->response_len);
+        call->response[call->response_len] = '\0';
+        call->header_len = 0;
+        return axis2_async_call_parse_head(call);
+    }
+    return 1;
+}
+
+/* Reads the size from the chunk line at line, which ends at line_end.
+   Returns -1 if the line does not start with a size in hex digits or the
+   size is out of range */
+static long
+axis2_async_chunk_size(
+    const axis2_char_t * line,
+    const axis2_char_t * line_end)
+{
+    axis2_char_t *digits_end = NULL;
+    size_t digits = 0;
+    long size = 0;
+
+    digits = strspn(line, "0123456789abcdefABCDEF");
+    if (!digits || line + digits > line_end)
+    {
+        return -1;
+    }
+    errno = 0;
+    size = strtol(line, &digits_end, 16);
+    if (errno || digits_end != line + digits ||
+        (*digits_end != ';' && *digits_end != ' ' && *digits_end != '\t' &&
+         digits_end != line_end))
+    {
+        return -1;
+    }
+    return size;
+}
+
+/* Checks whether a chunked body is complete and if so decodes it in place.
+   Returns 1 when complete, 0 if more is needed, -1 on error */
+static int
+axis2_async_call_dechunk(
+    axis2_async_call_t * call)
+{
+    axis2_char_t *body = call->response + call->header_len;
+    long avail = call->response_len - call->header_len;
+    axis2_char_t *line_end = NULL;
+    long data = 0;
+    long size = 0;
+    long pos = 0;
+    long out = 0;
+
+    for (;;)
+    {
+        line_end = strstr(body + call->chunk_scan, "\r\n");
+        if (!line_end)
+        {
+            return avail - call->chunk_scan >
+                AXIS2_ASYNC_ENGINE_MAX_HEADER_SIZE ? -1 : 0;
+        }
+        size = axis2_async_chunk_size(body + call->chunk_scan, line_end);
+        data = (long) (line_end - body) + 2;
+        if (size < 0 || size > INT_MAX - data - 2)
+        {
+            return -1;
+        }
+        if (size == 0)
+        {
+            if (data + 2 <= avail && !strncmp(body + data, "\r\n", 2))
+            {
+                break;
+            }
+            if (!strstr(body + data, "\r\n\r\n"))
+            {
+                return 0;
+            }
+            break;
+        }
+        if (size + 2 > avail - data)
+        {
+            return 0;
+        }
+        if (strncmp(body + data + size, "\r\n", 2))
+        {
+            return -1;
+        }
+        call->chunk_scan = (int) (data + size + 2);
+    }
+
+    /* Complete; copy the chunk data over the chunk lines */
+    pos = 0;
+    for (;;)
+    {
+        line_end = strstr(body + pos, "\r\n");
+        if (!line_end)
+        {
+            return -1;
+        }
+        size = axis2_async_chunk_size(body + pos, line_end);
+        data = (long) (line_end - body) + 2;
+        if (size < 0 || size + 2 > avail - data)
+        {
+            return -1;
+        }
+        if (size == 0)
+        {
+            break;
+        }
+        memmove(body + out, body + data, size);
+        out += size;
+        pos = data + size + 2;
+    }
+    call->body_len = (int) out;
+    return 1;
+}
+
+/* Returns 1 when the whole response is read, 0 if more is needed, -1 on
+   error */
+static int
+axis2_async_call_parse(
+    axis2_async_call_t * call,
+    axis2_bool_t eof)
+{
+    int rc = 0;
+
+    if (!call->header_len)
+    {
+        rc = axis2_async_call_parse_head(call);
+        if (rc <= 0)
+        {
+            return rc;
+        }
+        rc = 0;
+    }
+
+    if (call->chunked)
+    {
+        rc = axis2_async_call_dechunk(call);
+    }
+    else if (call->content_length >= 0)
+    {
+        if (call->response_len - call->header_len >= call->content_length)
+        {
+            call->body_len = call->content_length;
+            rc = 1;
+        }
+    }
+    else if (call->status_code == 204 || call->status_code == 304)
+    {
+        rc = 1;
+    }
+    else
+    {
+        /* Body delimited by the end of the connection */
+        call->keep_alive = AXIS2_FALSE;
+        if (eof)
+        {
+            call->body_len = call->response_len - call->header_len;
+            rc = 1;
+        }
+    }
+
+    if (rc == 0 && eof)
+    {
+        rc = -1;
+    }
+    return rc;
+}
+
+static void
+axis2_async_io_thread_read(
+    axis2_async_io_thread_t * io,
+    const axutil_env_t * env,
+    axis2_async_call_t * call)
+{
+    axis2_bool_t eof = AXIS2_FALSE;
+    int n = 0;
+    int rc = 0;
+
+    for (;;)
+    {
+        if (call->response_size - call->response_len <
+            AXIS2_ASYNC_ENGINE_READ_SIZE + 1)
+        {
+            axis2_char_t *buffer = NULL;
+            int size = call->response_size ? call->response_size * 2 :
+                AXIS2_ASYNC_ENGINE_READ_SIZE * 2;
+
+            buffer = AXIS2_REALLOC(env->allocator, call->response, size);
+            if (!buffer)
+            {
+                axis2_async_io_thread_fail(io, env, call,
+                                           AXIS2_ERROR_NO_MEMORY);
+                return;
+            }
+            call->response = buffer;
+            call->response_size = size;
+        }
+        n = recv(call->fd, call->response + call->response_len,
+                 call->response_size - call->response_len - 1, 0);
+        if (n > 0)
+        {
+            call->response_len += n;
+            call->response[call->response_len] = '\0';
+            continue;
+        }
+        if (n == 0)
+        {
+            eof = AXIS2_TRUE;
+            break;
+        }
+        if (errno == EINTR)
+        {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            break;
+        }
+        axis2_async_io_thread_fail_or_retry(io, env, call);
+        return;
+    }
+
+    if (eof && call->response_len == 0)
+    {
+        axis2_async_io_thread_fail_or_retry(io, env, call);
+        return;
+    }
+
+    rc = axis2_async_call_parse(call, eof);
+    if (rc == 0)
+    {
+        return;
+    }
+    if (rc < 0)
+    {
+        axis2_async_io_thread_fail(io, env, call,
+                                   AXIS2_ERROR_HTTP_CLIENT_TRANSPORT_ERROR);
+        return;
+    }
+
+    axis2_async_io_thread_unlink(io, call);
+    epoll_ctl(io->epoll_fd, EPOLL_CTL_DEL, call->fd, NULL);
+    if (call->keep_alive && !eof && (call->chunked ||
+                                     call->response_len - call->header_len ==
+                                     call->body_len))
+    {
+        axis2_async_io_thread_keep(io, env, call);
+    }
+    else
+    {
+        close(call->fd);
+        call->fd = -1;
+    }
+    axis2_async_call_finish(call, env, AXIS2_ERROR_NONE);
+}
+
+static void
+axis2_async_io_thread_write(
+    axis2_async_io_thread_t * io,
+    const axutil_env_t * env,
+    axis2_async_call_t * call)
+{
+    int n = 0;
+
+    if (!call->connected)
+    {
+        int err = 0;
+        socklen_t len = sizeof(err);
+
+        if (getsockopt(call->fd, SOL_SOCKET, SO_ERROR, &err, &len) || err)
+        {
+            axis2_async_io_thread_fail(io, env, call,
+                                       AXIS2_ERROR_SOCKET_ERROR);
+            return;
+        }
+        call->connected = AXIS2_TRUE;
+    }
+
+    while (call->sent < call->request_len)
+    {
+        n = send(call->fd, call->request + call->sent,
+                 call->request_len - call->sent, MSG_NOSIGNAL);
+        if (n > 0)
+        {
+            call->sent += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            return;
+        }
+        axis2_async_io_thread_fail_or_retry(io, env, call);
+        return;
+    }
+
+    axis2_async_io_thread_watch(io, call, EPOLL_CTL_MOD, EPOLLIN);
+}
+
+static void
+axis2_async_io_thread_expire(
+    axis2_async_io_thread_t * io,
+    const axutil_env_t * env)
+{
+    axis2_async_call_t *call = NULL;
+    axis2_async_call_t *next = NULL;
+    long now = axis2_async_engine_now(io->async_engine);
+
+    for (call = io->active; call; call = next)
+    {
+        next = call->next;
+        if (call->deadline && call->deadline <= now)
+        {
+            axis2_async_io_thread_fail(io, env, call,
+                                       AXIS2_ERROR_RESPONSE_TIMED_OUT);
+        }
+    }
+}
+
+static void *AXIS2_THREAD_FUNC
+axis2_async_io_thread_run(
+    axutil_thread_t * thd,
+    void *data)
+{
+    axis2_async_io_thread_t *io = (axis2_async_io_thread_t *) data;
+    axutil_env_t *env = NULL;
+    struct epoll_event events[AXIS2_ASYNC_ENGINE_MAX_EVENTS];
+    axis2_async_call_t *submitted = NULL;
+    axis2_async_call_t *call = NULL;
+    axis2_async_conn_t *conn = NULL;
+    axis2_bool_t stop = AXIS2_FALSE;
+    long last_expiry = 0;
+    char drain[64];
+    int n = 0;
+    int i = 0;
+
+    env = axutil_init_thread_env(io->async_engine->env);
+
+    while (!stop)
+    {
+        n = epoll_wait(io->epoll_fd, events, AXIS2_ASYNC_ENGINE_MAX_EVENTS,
+                       io->active ? AXIS2_ASYNC_ENGINE_TICK : -1);
+        if (n < 0 && errno != EINTR)
+        {
+            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                            "Asynchronous engine I/O thread failed to wait, "
+                            "errno %d", errno);
+            n = 0;
+        }
+
+        for (i = 0; i < n; i++)
+        {
+            call = (axis2_async_call_t *) events[i].data.ptr;
+            if (!call)
+            {
+                while (read(io->wakeup[0], drain, sizeof(drain)) > 0)
+                    ;
+            }
+            else if (call->sent < call->request_len)
+            {
+                axis2_async_io_thread_write(io, env, call);
+            }
+            else
+            {
+                axis2_async_io_thread_read(io, env, call);
+            }
+        }
+
+        axutil_thread_mutex_lock(io->mutex);
+        submitted = io->submitted;
+        io->submitted = NULL;
+        stop = io->stop;
+        axutil_thread_mutex_unlock(io->mutex);
+
+        /* Submitted calls are stacked; start them in order */
+        call = NULL;
+        while (submitted)
+        {
+            axis2_async_call_t *next = submitted->next;
+
+            submitted->next = call;
+            call = submitted;
+            submitted = next;
+        }
+        while (call)
+        {
+            axis2_async_call_t *next = call->next;
+
+            call->prev = NULL;
+            call->next = io->active;
+            if (io->active)
+            {
+                io->active->prev = call;
+            }
+            io->active = call;
+            axis2_async_io_thread_connect(io, env, call);
+            call = next;
+        }
+
+        if (io->active && axis2_async_engine_now(io->async_engine) -
+            last_expiry >= AXIS2_ASYNC_ENGINE_TICK)
+        {
+            last_expiry = axis2_async_engine_now(io->async_engine);
+            axis2_async_io_thread_expire(io, env);
+        }
+    }
+
+    while (io->active)
+    {
+        axis2_async_io_thread_fail(io, env, io->active,
+                                   AXIS2_ERROR_RESPONSE_SERVER_SHUTDOWN);
+    }
+    while (io->idle)
+    {
+        conn = io->idle;
+        io->idle = conn->next;
+        close(conn->fd);
+        AXIS2_FREE(env->allocator, conn->key);
+        AXIS2_FREE(env->allocator, conn);
+    }
+
+    axutil_free_thread_env(env);
+    return NULL;
+}
+
+AXIS2_EXTERN axis2_async_engine_t *AXIS2_CALL
+axis2_async_engine_create(
+    const axutil_env_t * env,
+    int io_threads)
+{
+    axis2_async_engine_t *async_engine = NULL;
+    axis2_async_engine_sender_t *sender = NULL;
+    struct epoll_event event;
+    int i = 0;
+
+    if (io_threads < 1)
+    {
+        io_threads = 1;
+    }
+
+    async_engine = AXIS2_MALLOC(env->allocator, sizeof(axis2_async_engine_t));
+    if (!async_engine)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "No memory. Cannot create asynchronous engine.");
+        return NULL;
+    }
+    memset(async_engine, 0, sizeof(axis2_async_engine_t));
+    async_engine->env = env;
+    AXIS2_PLATFORM_GET_TIME_IN_MILLIS(&async_engine->start);
+
+    async_engine->mutex = axutil_thread_mutex_create(env->allocator,
+                                                     AXIS2_THREAD_MUTEX_DEFAULT);
+    async_engine->transport_out =
+        axis2_transport_out_desc_create(env, AXIS2_TRANSPORT_ENUM_HTTP);
+    sender = AXIS2_MALLOC(env->allocator, sizeof(axis2_async_engine_sender_t));
+    async_engine->threads = AXIS2_MALLOC(env->allocator,
+                                         sizeof(axis2_async_io_thread_t) *
+                                         io_threads);
+    if (!async_engine->mutex || !async_engine->transport_out || !sender ||
+        !async_engine->threads)
+    {
+        if (sender)
+        {
+            AXIS2_FREE(env->allocator, sender);
+        }
+        axis2_async_engine_free(async_engine, env);
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+    sender->sender.ops = &axis2_async_engine_sender_ops_var;
+    axis2_transport_out_desc_set_sender(async_engine->transport_out, env,
+                                        &sender->sender);
+
+    memset(async_engine->threads, 0,
+           sizeof(axis2_async_io_thread_t) * io_threads);
+    for (i = 0; i < io_threads; i++)
+    {
+        async_engine->threads[i].epoll_fd = -1;
+        async_engine->threads[i].wakeup[0] = -1;
+        async_engine->threads[i].wakeup[1] = -1;
+    }
+
+    for (i = 0; i < io_threads; i++)
+    {
+        axis2_async_io_thread_t *io = &async_engine->threads[i];
+
+        io->async_engine = async_engine;
+        io->mutex = axutil_thread_mutex_create(env->allocator,
+                                               AXIS2_THREAD_MUTEX_DEFAULT);
+        io->epoll_fd = epoll_create(AXIS2_ASYNC_ENGINE_MAX_EVENTS);
+        if (!io->mutex || io->epoll_fd < 0 || pipe(io->wakeup))
+        {
+            break;
+        }
+        fcntl(io->wakeup[0], F_SETFL, O_NONBLOCK);
+        fcntl(io->wakeup[1], F_SETFL, O_NONBLOCK);
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.ptr = NULL;
+        if (epoll_ctl(io->epoll_fd, EPOLL_CTL_ADD, io->wakeup[0], &event))
+        {
+            break;
+        }
+
+        io->thread = axutil_thread_pool_get_thread(env->thread_pool,
+                                                   axis2_async_io_thread_run,
+                                                   io);
+        if (!io->thread)
+        {
+            break;
+        }
+        async_engine->io_threads++;
+    }
+
+    if (async_engine->io_threads < io_threads)
+    {
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "Cannot start I/O threads of asynchronous engine");
+        /* Clean up the thread that failed half way as well */
+        async_engine->io_threads++;
+        axis2_async_engine_free(async_engine, env);
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_SOCKET_ERROR, AXIS2_FAILURE);
+        return NULL;
+    }
+
+    AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI,
+                    "Started asynchronous engine with %d I/O threads",
+                    io_threads);
+    return async_engine;
+}
+
+AXIS2_EXTERN axis2_bool_t AXIS2_CALL
+axis2_async_engine_can_send(
+    axis2_async_engine_t * async_engine,
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx)
+{
+    axis2_options_t *options = NULL;
+    axis2_transport_out_desc_t *transport_out = NULL;
+    const axis2_char_t *address = NULL;
+    axis2_endpoint_ref_t *to = NULL;
+
+    if (!async_engine || !msg_ctx)
+    {
+        return AXIS2_FALSE;
+    }
+
+    if (axis2_msg_ctx_get_doing_rest(msg_ctx, env) ||
+        axis2_msg_ctx_get_doing_mtom(msg_ctx, env))
+    {
+        return AXIS2_FALSE;
+    }
+#ifdef AXIS2_JSON_ENABLED
+    if (axis2_msg_ctx_get_doing_json(msg_ctx, env))
+    {
+        return AXIS2_FALSE;
+    }
+#endif
+
+    options = axis2_msg_ctx_get_options(msg_ctx, env);
+    if (options &&
+        (axis2_options_get_property(options, env, AXIS2_HTTP_AUTH_UNAME) ||
+         axis2_options_get_property(options, env, AXIS2_PROXY_AUTH_UNAME) ||
+         axis2_options_get_property(options, env,
+                                    AXIS2_TRANSPORT_HEADER_PROPERTY)))
+    {
+        return AXIS2_FALSE;
+    }
+
+    transport_out = axis2_msg_ctx_get_transport_out_desc(msg_ctx, env);
+    if (!transport_out ||
+        axis2_transport_out_desc_get_enum(transport_out, env) !=
+        AXIS2_TRANSPORT_ENUM_HTTP ||
+        axis2_transport_out_desc_get_param(transport_out, env,
+                                           AXIS2_HTTP_PROXY_API) ||
+        axis2_transport_out_desc_get_param(transport_out, env,
+                                           AXIS2_HTTP_PROXY))
+    {
+        return AXIS2_FALSE;
+    }
+
+    address = axis2_msg_ctx_get_transport_url(msg_ctx, env);
+    if (!address)
+    {
+        to = axis2_msg_ctx_get_to(msg_ctx, env);
+        if (to)
+        {
+            address = axis2_endpoint_ref_get_address(to, env);
+        }
+    }
+    return address && !axutil_strncasecmp(address, "http://", 7);
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_async_engine_send(
+    axis2_async_engine_t * async_engine,
+    const axutil_env_t * env,
+    axis2_op_client_t * op_client,
+    axis2_msg_ctx_t * msg_ctx)
+{
+    axis2_async_call_t *call = NULL;
+    axis2_async_io_thread_t *io = NULL;
+    axis2_svc_ctx_t *svc_ctx = NULL;
+    axis2_conf_ctx_t *conf_ctx = NULL;
+    axis2_engine_t *engine = NULL;
+    axutil_property_t *property = NULL;
+    axis2_status_t status = AXIS2_FAILURE;
+    long timeout = 0;
+
+    AXIS2_PARAM_CHECK(env->error, async_engine, AXIS2_FAILURE);
+    AXIS2_PARAM_CHECK(env->error, op_client, AXIS2_FAILURE);
+    AXIS2_PARAM_CHECK(env->error, msg_ctx, AXIS2_FAILURE);
+
+    call = AXIS2_MALLOC(env->allocator, sizeof(axis2_async_call_t));
+    if (!call)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+    memset(call, 0, sizeof(axis2_async_call_t));
+    call->op_client = op_client;
+    call->msg_ctx = msg_ctx;
+    call->fd = -1;
+    call->content_length = -1;
+
+    svc_ctx = axis2_op_client_get_svc_ctx(op_client, env);
+    conf_ctx = axis2_svc_ctx_get_conf_ctx(svc_ctx, env);
+    call->op_ctx = axis2_op_client_get_operation_context(op_client, env);
+
+    /* The sender finds the call through the operation context, which, unlike
+       the message context properties, is not shared with other calls */
+    property = axutil_property_create_with_args(env, AXIS2_SCOPE_REQUEST,
+                                                AXIS2_FALSE, NULL, call);
+    if (!property)
+    {
+        axis2_async_call_free(call, env);
+        return AXIS2_FAILURE;
+    }
+    axis2_ctx_set_property(axis2_op_ctx_get_base(call->op_ctx, env), env,
+                           AXIS2_ASYNC_ENGINE_CALL, property);
+    axis2_msg_ctx_set_op_ctx(msg_ctx, env, call->op_ctx);
+    axis2_msg_ctx_set_svc_ctx(msg_ctx, env, svc_ctx);
+    axis2_msg_ctx_set_transport_out_desc(msg_ctx, env,
+                                         async_engine->transport_out);
+
+    engine = axis2_engine_create(env, conf_ctx);
+    if (engine)
+    {
+        status = axis2_engine_send(engine, env, msg_ctx);
+        axis2_engine_free(engine, env);
+    }
+    axis2_ctx_set_property(axis2_op_ctx_get_base(call->op_ctx, env), env,
+                           AXIS2_ASYNC_ENGINE_CALL, NULL);
+    axutil_property_free(property, env);
+
+    if (status != AXIS2_SUCCESS || !call->request)
+    {
+        /* Failed, or a handler paused the message */
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "Cannot send message through the asynchronous engine");
+        axis2_async_call_free(call, env);
+        return AXIS2_FAILURE;
+    }
+
+    timeout = axis2_options_get_timeout_in_milli_seconds(
+        axis2_op_client_get_options(op_client, env), env);
+    if (timeout > 0)
+    {
+        call->deadline = axis2_async_engine_now(async_engine) + timeout;
+    }
+
+    axutil_thread_mutex_lock(async_engine->mutex);
+    io = &async_engine->threads[async_engine->next];
+    async_engine->next = (async_engine->next + 1) % async_engine->io_threads;
+    axutil_thread_mutex_unlock(async_engine->mutex);
+
+    axutil_thread_mutex_lock(io->mutex);
+    call->next = io->submitted;
+    io->submitted = call;
+    axutil_thread_mutex_unlock(io->mutex);
+
+    if (write(io->wakeup[1], "", 1) < 0 && errno != EAGAIN)
+    {
+        AXIS2_LOG_WARNING(env->log, AXIS2_LOG_SI,
+                          "Cannot wake up asynchronous engine I/O thread");
+    }
+    return AXIS2_SUCCESS;
+}
+
+AXIS2_EXTERN void AXIS2_CALL
+axis2_async_engine_free(
+    axis2_async_engine_t * async_engine,
+    const axutil_env_t * env)
+{
+    int i = 0;
+
+    if (!async_engine)
+    {
+        return;
+    }
+
+    for (i = 0; async_engine->threads && i < async_engine->io_threads; i++)
+    {
+        axis2_async_io_thread_t *io = &async_engine->threads[i];
+
+        if (io->thread)
+        {
+            axutil_thread_mutex_lock(io->mutex);
+            io->stop = AXIS2_TRUE;
+            axutil_thread_mutex_unlock(io->mutex);
+            if (write(io->wakeup[1], "", 1) < 0)
+            {
+                AXIS2_LOG_WARNING(env->log, AXIS2_LOG_SI,
+                                  "Cannot wake up asynchronous engine I/O thread");
+            }
+            axutil_thread_pool_join_thread(env->thread_pool, io->thread);
+        }
+        if (io->epoll_fd >= 0)
+        {
+            close(io->epoll_fd);
+        }
+        if (io->wakeup[0] >= 0)
+        {
+            close(io->wakeup[0]);
+            close(io->wakeup[1]);
+        }
+        if (io->mutex)
+        {
+            axutil_thread_mutex_destroy(io->mutex);
+        }
+    }
+    if (async_engine->threads)
+    {
+        AXIS2_FREE(env->allocator, async_engine->threads);
+    }
+    if (async_engine->transport_out)
+    {
+        axis2_transport_out_desc_free(async_engine->transport_out, env);
+    }
+    if (async_engine->mutex)
+    {
+        axutil_thread_mutex_destroy(async_engine->mutex);
+    }
+    AXIS2_FREE(env->allocator, async_engine);
+}
+
+#else
+
+AXIS2_EXTERN axis2_async_engine_t *AXIS2_CALL
+axis2_async_engine_create(
+    const axutil_env_t * env,
+    int io_threads)
+{
+    AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                    "Asynchronous engine is not supported on this platform");
+    return NULL;
+}
+
+AXIS2_EXTERN axis2_bool_t AXIS2_CALL
+axis2_async_engine_can_send(
+    axis2_async_engine_t * async_engine,
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx)
+{
+    return AXIS2_FALSE;
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_async_engine_send(
+    axis2_async_engine_t * async_engine,
+    const axutil_env_t * env,
+    axis2_op_client_t * op_client,
+    axis2_msg_ctx_t * msg_ctx)
+{
+    return AXIS2_FAILURE;
+}
+
+AXIS2_EXTERN void AXIS2_CALL
+axis2_async_engine_free(
+    axis2_async_engine_t * async_engine,
+    const axutil_env_t * env)
+{
+}
+
+#endif
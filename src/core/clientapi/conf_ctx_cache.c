@@ -0,0 +1,319 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <axis2_conf_ctx_cache.h>
+#include <axis2_conf_init.h>
+#include <axis2_conf.h>
+#include <axis2_svc_grp.h>
+#include <axis2_svc_grp_ctx.h>
+#include <axutil_array_list.h>
+#include <axutil_thread.h>
+#include <axutil_string.h>
+
+typedef struct axis2_conf_ctx_cache_entry
+{
+    /* Client repository path; "" stands for the default repository */
+    axis2_char_t *client_home;
+
+    axis2_conf_ctx_t *conf_ctx;
+
+    /* Number of references handed out and not yet released */
+    int ref;
+} axis2_conf_ctx_cache_entry_t;
+
+struct axis2_conf_ctx_cache
+{
+    /* There is one entry per repository a process uses, so a list is
+       searched as fast as a hash would be and also serves lookups by
+       configuration context on release */
+    axutil_array_list_t *entries;
+
+    /* Guards entries and changes to the services of shared configurations */
+    axutil_thread_mutex_t *mutex;
+};
+
+static int
+axis2_conf_ctx_cache_find(
+    axis2_conf_ctx_cache_t * cache,
+    const axutil_env_t * env,
+    const axis2_char_t * client_home,
+    axis2_conf_ctx_t * conf_ctx)
+{
+    int i = 0;
+    int size = 0;
+
+    size = axutil_array_list_size(cache->entries, env);
+    for (i = 0; i < size; i++)
+    {
+        axis2_conf_ctx_cache_entry_t *entry = NULL;
+
+        entry = axutil_array_list_get(cache->entries, env, i);
+        if (client_home && !axutil_strcmp(entry->client_home, client_home))
+        {
+            return i;
+        }
+        if (conf_ctx && entry->conf_ctx == conf_ctx)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void
+axis2_conf_ctx_cache_entry_free(
+    axis2_conf_ctx_cache_entry_t * entry,
+    const axutil_env_t * env)
+{
+    if (entry->conf_ctx)
+    {
+        axis2_conf_ctx_free(entry->conf_ctx, env);
+    }
+    AXIS2_FREE(env->allocator, entry->client_home);
+    AXIS2_FREE(env->allocator, entry);
+}
+
+AXIS2_EXTERN axis2_conf_ctx_cache_t *AXIS2_CALL
+axis2_conf_ctx_cache_create(
+    const axutil_env_t * env)
+{
+    axis2_conf_ctx_cache_t *cache = NULL;
+
+    cache = AXIS2_MALLOC(env->allocator, sizeof(axis2_conf_ctx_cache_t));
+    if (!cache)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "No memory. Cannot create configuration context cache.");
+        return NULL;
+    }
+
+    cache->entries = axutil_array_list_create(env, 0);
+    cache->mutex = axutil_thread_mutex_create(env->allocator,
+                                              AXIS2_THREAD_MUTEX_DEFAULT);
+    if (!cache->entries || !cache->mutex)
+    {
+        axis2_conf_ctx_cache_free(cache, env);
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+
+    return cache;
+}
+
+AXIS2_EXTERN axis2_conf_ctx_t *AXIS2_CALL
+axis2_conf_ctx_cache_get(
+    axis2_conf_ctx_cache_t * cache,
+    const axutil_env_t * env,
+    const axis2_char_t * client_home)
+{
+    axis2_conf_ctx_cache_entry_t *entry = NULL;
+    axis2_conf_ctx_t *conf_ctx = NULL;
+    const axis2_char_t *key = client_home ? client_home : "";
+    int index = 0;
+
+    AXIS2_PARAM_CHECK(env->error, cache, NULL);
+
+    axutil_thread_mutex_lock(cache->mutex);
+    index = axis2_conf_ctx_cache_find(cache, env, key, NULL);
+    if (index >= 0)
+    {
+        entry = axutil_array_list_get(cache->entries, env, index);
+        entry->ref++;
+        axutil_thread_mutex_unlock(cache->mutex);
+        return entry->conf_ctx;
+    }
+    axutil_thread_mutex_unlock(cache->mutex);
+
+    /* Deployment takes long, so it runs outside the lock. Should another
+       thread have built the same repository in the meantime, its result is
+       kept and this one dropped */
+    conf_ctx = axis2_build_client_conf_ctx(env, client_home);
+    if (!conf_ctx)
+    {
+        return NULL;
+    }
+
+    entry = AXIS2_MALLOC(env->allocator, sizeof(axis2_conf_ctx_cache_entry_t));
+    if (!entry)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        axis2_conf_ctx_free(conf_ctx, env);
+        return NULL;
+    }
+    entry->client_home = axutil_strdup(env, key);
+    entry->conf_ctx = conf_ctx;
+    entry->ref = 1;
+
+    axutil_thread_mutex_lock(cache->mutex);
+    index = axis2_conf_ctx_cache_find(cache, env, key, NULL);
+    if (index >= 0)
+    {
+        axis2_conf_ctx_cache_entry_t *existing = NULL;
+
+        existing = axutil_array_list_get(cache->entries, env, index);
+        existing->ref++;
+        conf_ctx = existing->conf_ctx;
+        axutil_thread_mutex_unlock(cache->mutex);
+
+        axis2_conf_ctx_cache_entry_free(entry, env);
+        return conf_ctx;
+    }
+    axutil_array_list_add(cache->entries, env, entry);
+    axutil_thread_mutex_unlock(cache->mutex);
+
+    AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI,
+                    "Cached client configuration context for repository %s", key);
+    return conf_ctx;
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_conf_ctx_cache_release(
+    axis2_conf_ctx_cache_t * cache,
+    const axutil_env_t * env,
+    axis2_conf_ctx_t * conf_ctx)
+{
+    axis2_conf_ctx_cache_entry_t *entry = NULL;
+    int index = 0;
+
+    AXIS2_PARAM_CHECK(env->error, cache, AXIS2_FAILURE);
+    AXIS2_PARAM_CHECK(env->error, conf_ctx, AXIS2_FAILURE);
+
+    axutil_thread_mutex_lock(cache->mutex);
+    index = axis2_conf_ctx_cache_find(cache, env, NULL, conf_ctx);
+    if (index < 0)
+    {
+        axutil_thread_mutex_unlock(cache->mutex);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "Configuration context is not held by the cache");
+        return AXIS2_FAILURE;
+    }
+
+    entry = axutil_array_list_get(cache->entries, env, index);
+    if (--entry->ref > 0)
+    {
+        axutil_thread_mutex_unlock(cache->mutex);
+        return AXIS2_SUCCESS;
+    }
+    axutil_array_list_remove(cache->entries, env, index);
+    axutil_thread_mutex_unlock(cache->mutex);
+
+    axis2_conf_ctx_cache_entry_free(entry, env);
+    return AXIS2_SUCCESS;
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_conf_ctx_cache_add_svc(
+    axis2_conf_ctx_cache_t * cache,
+    const axutil_env_t * env,
+    axis2_conf_ctx_t * conf_ctx,
+    axis2_svc_t * svc)
+{
+    axis2_conf_t *conf = NULL;
+    axis2_status_t status = AXIS2_SUCCESS;
+
+    AXIS2_PARAM_CHECK(env->error, cache, AXIS2_FAILURE);
+    AXIS2_PARAM_CHECK(env->error, svc, AXIS2_FAILURE);
+
+    conf = axis2_conf_ctx_get_conf(conf_ctx, env);
+
+    axutil_thread_mutex_lock(cache->mutex);
+    if (!axis2_conf_get_svc(conf, env, axis2_svc_get_name(svc, env)))
+    {
+        status = axis2_conf_add_svc(conf, env, svc);
+    }
+    axutil_thread_mutex_unlock(cache->mutex);
+
+    return status;
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_conf_ctx_cache_remove_svc(
+    axis2_conf_ctx_cache_t * cache,
+    const axutil_env_t * env,
+    axis2_conf_ctx_t * conf_ctx,
+    axis2_svc_t * svc)
+{
+    axis2_conf_t *conf = NULL;
+    axis2_svc_grp_t *svc_grp = NULL;
+    axis2_svc_grp_ctx_t *svc_grp_ctx = NULL;
+    const axis2_char_t *svc_grp_name = NULL;
+
+    AXIS2_PARAM_CHECK(env->error, cache, AXIS2_FAILURE);
+    AXIS2_PARAM_CHECK(env->error, svc, AXIS2_FAILURE);
+
+    conf = axis2_conf_ctx_get_conf(conf_ctx, env);
+    svc_grp = axis2_svc_get_parent(svc, env);
+
+    axutil_thread_mutex_lock(cache->mutex);
+    if (axis2_conf_get_svc(conf, env, axis2_svc_get_name(svc, env)) != svc)
+    {
+        axutil_thread_mutex_unlock(cache->mutex);
+        return AXIS2_FAILURE;
+    }
+    axis2_conf_remove_svc(conf, env, axis2_svc_get_name(svc, env));
+
+    if (svc_grp)
+    {
+        svc_grp_name = axis2_svc_grp_get_name(svc_grp, env);
+        svc_grp_ctx = axis2_conf_ctx_get_svc_grp_ctx(conf_ctx, env,
+                                                     svc_grp_name);
+        axis2_conf_ctx_register_svc_grp_ctx(conf_ctx, env, svc_grp_name,
+                                            NULL);
+        axis2_conf_remove_svc_grp(conf, env, svc_grp_name);
+    }
+    axutil_thread_mutex_unlock(cache->mutex);
+
+    if (svc_grp_ctx)
+    {
+        axis2_svc_grp_ctx_free(svc_grp_ctx, env);
+    }
+    if (svc_grp)
+    {
+        axis2_svc_grp_free(svc_grp, env);
+    }
+    return AXIS2_SUCCESS;
+}
+
+AXIS2_EXTERN void AXIS2_CALL
+axis2_conf_ctx_cache_free(
+    axis2_conf_ctx_cache_t * cache,
+    const axutil_env_t * env)
+{
+    int i = 0;
+
+    if (!cache)
+    {
+        return;
+    }
+
+    if (cache->entries)
+    {
+        for (i = 0; i < axutil_array_list_size(cache->entries, env); i++)
+        {
+            axis2_conf_ctx_cache_entry_free(
+                axutil_array_list_get(cache->entries, env, i), env);
+        }
+        axutil_array_list_free(cache->entries, env);
+    }
+
+    if (cache->mutex)
+    {
+        axutil_thread_mutex_destroy(cache->mutex);
+    }
+
+    AXIS2_FREE(env->allocator, cache);
+}
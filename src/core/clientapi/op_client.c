@@ -22,6 +22,7 @@
 #include <axutil_uuid_gen.h>
 #include <axis2_listener_manager.h>
 #include <axis2_engine.h>
+#include <axis2_async_engine.h>
 #include "axis2_callback_recv.h"
 #include <axiom_xml_reader.h>
 #include <axis2_core_utils.h>
@@ -538,6 +539,24 @@ axis2_op_client_execute(
         {
             axutil_thread_t *worker_thread = NULL;
             axis2_op_client_worker_func_args_t *arg_list = NULL;
+            axis2_async_engine_t *async_engine = NULL;
+            axutil_property_t *property = NULL;
+
+            /* With an asynchronous engine the call is driven by its I/O
+               threads instead of a thread of its own */
+            property = axis2_options_get_property(op_client->options, env,
+                                                  AXIS2_ASYNC_ENGINE);
+            if (property)
+            {
+                async_engine = axutil_property_get_value(property, env);
+            }
+            if (async_engine &&
+                axis2_async_engine_can_send(async_engine, env, msg_ctx))
+            {
+                return axis2_async_engine_send(async_engine, env, op_client,
+                                               msg_ctx);
+            }
+
             arg_list = AXIS2_MALLOC(env->allocator,
                                     sizeof(axis2_op_client_worker_func_args_t));
             if (!arg_list)
@@ -932,6 +951,10 @@ axis2_op_client_infer_transport(
 			else if (!axutil_strcmp(transport, AXIS2_TRANSPORT_UDP))
 			{
 				transport_enum = AXIS2_TRANSPORT_ENUM_UDP;
+			}
+			else if (!axutil_strcmp(transport, AXIS2_TRANSPORT_LOCAL))
+			{
+				transport_enum = AXIS2_TRANSPORT_ENUM_LOCAL;
 			}			
 			
 			AXIS2_FREE(env->allocator, transport);
@@ -1400,7 +1423,7 @@ axis2_op_client_receive(
     if (!response)
         return NULL;
 
-    property = axis2_msg_ctx_get_property(msg_ctx, env, AXIS2_TRANSPORT_IN);
+    property = axis2_msg_ctx_get_property_at(msg_ctx, env, AXIS2_CTX_SLOT_TRANSPORT_IN);
     if (property)
     {
         axis2_msg_ctx_set_property(response, env, AXIS2_TRANSPORT_IN, property);
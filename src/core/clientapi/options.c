@@ -207,7 +207,8 @@ axis2_options_get_transport_in_protocol(
     const axis2_options_t * options,
     const axutil_env_t * env)
 {
-    if (options->parent)
+    if (options->transport_in_protocol == AXIS2_TRANSPORT_ENUM_MAX &&
+        options->parent)
     {
         return axis2_options_get_transport_in_protocol(options->parent, env);
     }
@@ -318,7 +319,8 @@ axis2_options_get_sender_transport_protocol(
     const axis2_options_t * options,
     const axutil_env_t * env)
 {
-    if (options->parent)
+    if (options->sender_transport_protocol == AXIS2_TRANSPORT_ENUM_MAX &&
+        options->parent)
     {
         return axis2_options_get_sender_transport_protocol(options->parent,
                                                            env);
@@ -534,6 +536,37 @@ axis2_options_set_property(
     return AXIS2_SUCCESS;
 }
 
+/* Sets the value of a property as axis2_options_set_property does with a new
+   property, but reuses the property already set with the key, if any */
+static axis2_status_t
+axis2_options_set_property_value(
+    axis2_options_t * options,
+    const axutil_env_t * env,
+    const axis2_char_t * property_key,
+    void *value,
+    AXIS2_FREE_VOID_ARG free_func)
+{
+    axutil_property_t *property =
+            (axutil_property_t *)axutil_hash_get(
+                options->properties, property_key, AXIS2_HASH_KEY_STRING);
+    if (!property)
+    {
+        property = axutil_property_create_with_args(env, AXIS2_SCOPE_REQUEST,
+                                                    AXIS2_TRUE, free_func, value);
+        if (!property)
+            return AXIS2_FAILURE;
+        axutil_hash_set(options->properties, property_key,
+                        AXIS2_HASH_KEY_STRING, property);
+        return AXIS2_SUCCESS;
+    }
+    /* the old value is freed as the old property would have freed it */
+    axutil_property_set_value(property, env, value);
+    axutil_property_set_scope(property, env, AXIS2_SCOPE_REQUEST);
+    axutil_property_set_own_value(property, env, AXIS2_TRUE);
+    axutil_property_set_free_func(property, env, free_func);
+    return AXIS2_SUCCESS;
+}
+
 AXIS2_EXTERN axis2_status_t AXIS2_CALL
 axis2_options_set_relates_to(
     axis2_options_t * options,
@@ -616,16 +649,9 @@ axis2_options_set_timeout_in_milli_seconds(
     if (options->timeout_in_milli_seconds > 0)
     {        
         axis2_char_t time_str[19]; /* supports 18 digit timeout */
-        axutil_property_t *property = axutil_property_create(env);
         sprintf(time_str, "%ld", options->timeout_in_milli_seconds); 
-        if (property)
-        {
-            axutil_property_set_scope(property, env, AXIS2_SCOPE_REQUEST);
-            axutil_property_set_value(property, env,
-                                      axutil_strdup(env, time_str));
-            axis2_options_set_property(options, env, AXIS2_HTTP_CONNECTION_TIMEOUT,
-                                       property);
-        }
+        axis2_options_set_property_value(options, env, AXIS2_HTTP_CONNECTION_TIMEOUT,
+                                         axutil_strdup(env, time_str), NULL);
     }
     return AXIS2_SUCCESS;
 }
@@ -665,21 +691,17 @@ axis2_options_set_use_separate_listener(
     const axutil_env_t * env,
     const axis2_bool_t use_separate_listener)
 {
-    axutil_property_t *property = NULL;
-
     options->use_separate_listener = use_separate_listener;
 
     if (use_separate_listener)
     {
-        property = axutil_property_create(env);
-        axutil_property_set_value(property, env, axutil_strdup(env, AXIS2_VALUE_TRUE));
-        axis2_options_set_property(options, env, AXIS2_USE_SEPARATE_LISTENER, property);
+        axis2_options_set_property_value(options, env, AXIS2_USE_SEPARATE_LISTENER,
+                                         axutil_strdup(env, AXIS2_VALUE_TRUE), NULL);
     }
     else
     {
-        property = axutil_property_create(env);
-        axutil_property_set_value(property, env, axutil_strdup(env, AXIS2_VALUE_FALSE));
-        axis2_options_set_property(options, env, AXIS2_USE_SEPARATE_LISTENER, property);
+        axis2_options_set_property_value(options, env, AXIS2_USE_SEPARATE_LISTENER,
+                                         axutil_strdup(env, AXIS2_VALUE_FALSE), NULL);
     }
     
     return AXIS2_SUCCESS;
@@ -833,15 +855,8 @@ axis2_options_set_enable_mtom(
 
     if (enable_mtom)
     {
-        axutil_property_t *property = axutil_property_create(env);
-        if (property)
-        {
-            axutil_property_set_scope(property, env, AXIS2_SCOPE_REQUEST);
-            axutil_property_set_value(property, env,
-                                      axutil_strdup(env, AXIS2_VALUE_TRUE));
-            axis2_options_set_property(options, env, AXIS2_ENABLE_MTOM,
-                                       property);
-        }
+        axis2_options_set_property_value(options, env, AXIS2_ENABLE_MTOM,
+                                         axutil_strdup(env, AXIS2_VALUE_TRUE), NULL);
     }
     return AXIS2_SUCCESS;
 }
@@ -905,23 +920,15 @@ axis2_options_set_enable_rest(
     const axutil_env_t * env,
     const axis2_bool_t enable_rest)
 {
-    axutil_property_t *rest_property = NULL;
-
     if (enable_rest)
     {
-        rest_property = axutil_property_create(env);
-        axutil_property_set_value(rest_property, env,
-                                  axutil_strdup(env, AXIS2_VALUE_TRUE));
-        axis2_options_set_property(options, env, AXIS2_ENABLE_REST,
-                                   rest_property);
+        axis2_options_set_property_value(options, env, AXIS2_ENABLE_REST,
+                                         axutil_strdup(env, AXIS2_VALUE_TRUE), NULL);
     }
     else
     {
-        rest_property = axutil_property_create(env);
-        axutil_property_set_value(rest_property, env,
-                                  axutil_strdup(env, AXIS2_VALUE_FALSE));
-        axis2_options_set_property(options, env, AXIS2_ENABLE_REST,
-                                   rest_property);
+        axis2_options_set_property_value(options, env, AXIS2_ENABLE_REST,
+                                         axutil_strdup(env, AXIS2_VALUE_FALSE), NULL);
     }
     return AXIS2_SUCCESS;
 }
@@ -932,23 +939,15 @@ axis2_options_set_test_http_auth(
     const axutil_env_t * env,
     const axis2_bool_t test_http_auth)
 {
-    axutil_property_t *test_auth_property = NULL;
-
     if (test_http_auth)
     {
-        test_auth_property = axutil_property_create(env);
-        axutil_property_set_value(test_auth_property, env,
-                                  axutil_strdup(env, AXIS2_VALUE_TRUE));
-        axis2_options_set_property(options, env, AXIS2_TEST_HTTP_AUTH,
-                                   test_auth_property);
+        axis2_options_set_property_value(options, env, AXIS2_TEST_HTTP_AUTH,
+                                         axutil_strdup(env, AXIS2_VALUE_TRUE), NULL);
     }
     else
     {
-        test_auth_property = axutil_property_create(env);
-        axutil_property_set_value(test_auth_property, env,
-                                  axutil_strdup(env, AXIS2_VALUE_FALSE));
-        axis2_options_set_property(options, env, AXIS2_TEST_HTTP_AUTH,
-                                   test_auth_property);
+        axis2_options_set_property_value(options, env, AXIS2_TEST_HTTP_AUTH,
+                                         axutil_strdup(env, AXIS2_VALUE_FALSE), NULL);
     }
     return AXIS2_SUCCESS;
 }
@@ -959,23 +958,15 @@ axis2_options_set_test_proxy_auth(
     const axutil_env_t * env,
     const axis2_bool_t test_proxy_auth)
 {
-    axutil_property_t *test_auth_property = NULL;
-
     if (test_proxy_auth)
     {
-        test_auth_property = axutil_property_create(env);
-        axutil_property_set_value(test_auth_property, env,
-                                  axutil_strdup(env, AXIS2_VALUE_TRUE));
-        axis2_options_set_property(options, env, AXIS2_TEST_PROXY_AUTH,
-                                   test_auth_property);
+        axis2_options_set_property_value(options, env, AXIS2_TEST_PROXY_AUTH,
+                                         axutil_strdup(env, AXIS2_VALUE_TRUE), NULL);
     }
     else
     {
-        test_auth_property = axutil_property_create(env);
-        axutil_property_set_value(test_auth_property, env,
-                                  axutil_strdup(env, AXIS2_VALUE_FALSE));
-        axis2_options_set_property(options, env, AXIS2_TEST_PROXY_AUTH,
-                                   test_auth_property);
+        axis2_options_set_property_value(options, env, AXIS2_TEST_PROXY_AUTH,
+                                         axutil_strdup(env, AXIS2_VALUE_FALSE), NULL);
     }
     return AXIS2_SUCCESS;
 }
@@ -987,13 +978,8 @@ axis2_options_set_http_method(
     const axutil_env_t * env,
     const axis2_char_t * http_method)
 {
-    axutil_property_t *method_property = NULL;
-
-    method_property = axutil_property_create(env);
-    axutil_property_set_value(method_property, env,
-                              axutil_strdup(env, http_method));
-    axis2_options_set_property(options, env, AXIS2_HTTP_METHOD,
-                               method_property);
+    axis2_options_set_property_value(options, env, AXIS2_HTTP_METHOD,
+                                     axutil_strdup(env, http_method), NULL);
     return AXIS2_SUCCESS;
 }
 
@@ -1003,15 +989,9 @@ axis2_options_set_http_headers(
     const axutil_env_t * env,
     axutil_array_list_t * http_header_list)
 {
-    axutil_property_t *headers_property = NULL;
-
-    headers_property = axutil_property_create(env);
-    axutil_property_set_value(headers_property, env,
-                              http_header_list);
-    axis2_options_set_property(options, env, AXIS2_TRANSPORT_HEADER_PROPERTY,
-                               headers_property);
-    axutil_property_set_free_func(headers_property, env,
-                                  axutil_array_list_free_void_arg);
+    axis2_options_set_property_value(options, env, AXIS2_TRANSPORT_HEADER_PROPERTY,
+                                     http_header_list,
+                                     axutil_array_list_free_void_arg);
     return AXIS2_SUCCESS;
 }
 
@@ -1024,16 +1004,12 @@ axis2_options_set_proxy_auth_info(
     const axis2_char_t * auth_type)
 {
     axis2_bool_t force_proxy_auth = AXIS2_FALSE;
-    axutil_property_t *prop_pw = NULL;
-    axutil_property_t *prop_un = NULL;
 
-    prop_un = axutil_property_create(env);
-    axutil_property_set_value(prop_un, env, axutil_strdup(env, username));
-    axis2_options_set_property(options, env, AXIS2_PROXY_AUTH_UNAME, prop_un);
+    axis2_options_set_property_value(options, env, AXIS2_PROXY_AUTH_UNAME,
+                                     axutil_strdup(env, username), NULL);
 
-    prop_pw = axutil_property_create(env);
-    axutil_property_set_value(prop_pw, env, axutil_strdup(env, password));
-    axis2_options_set_property(options, env, AXIS2_PROXY_AUTH_PASSWD, prop_pw);
+    axis2_options_set_property_value(options, env, AXIS2_PROXY_AUTH_PASSWD,
+                                     axutil_strdup(env, password), NULL);
 
 
     if(auth_type)
@@ -1050,26 +1026,16 @@ axis2_options_set_proxy_auth_info(
     }
     if (force_proxy_auth)
     {
-        axutil_property_t *proxy_auth_property = axutil_property_create(env);
-        axutil_property_t *proxy_auth_type_property = axutil_property_create(env);
-        
-        axutil_property_set_value(proxy_auth_property, env,
-                                  axutil_strdup(env, AXIS2_VALUE_TRUE));
-        axis2_options_set_property(options, env, AXIS2_FORCE_PROXY_AUTH,
-                                   proxy_auth_property);
+        axis2_options_set_property_value(options, env, AXIS2_FORCE_PROXY_AUTH,
+                                         axutil_strdup(env, AXIS2_VALUE_TRUE), NULL);
 
-        axutil_property_set_value(proxy_auth_type_property, env,
-                                  axutil_strdup(env, auth_type));
-        axis2_options_set_property(options, env, AXIS2_PROXY_AUTH_TYPE,
-                                   proxy_auth_type_property);
+        axis2_options_set_property_value(options, env, AXIS2_PROXY_AUTH_TYPE,
+                                         axutil_strdup(env, auth_type), NULL);
     }
     else
     {
-        axutil_property_t *proxy_auth_property = axutil_property_create(env);
-        axutil_property_set_value(proxy_auth_property, env,
-                                  axutil_strdup(env, AXIS2_VALUE_FALSE));
-        axis2_options_set_property(options, env, AXIS2_FORCE_PROXY_AUTH,
-                                   proxy_auth_property);
+        axis2_options_set_property_value(options, env, AXIS2_FORCE_PROXY_AUTH,
+                                         axutil_strdup(env, AXIS2_VALUE_FALSE), NULL);
     }
     return AXIS2_SUCCESS; 
 }
@@ -1083,16 +1049,12 @@ axis2_options_set_http_auth_info(
     const axis2_char_t * auth_type)
 {
     axis2_bool_t force_http_auth = AXIS2_FALSE;
-    axutil_property_t *prop_un = NULL;
-    axutil_property_t *prop_pw = NULL;
         
-    prop_un = axutil_property_create(env); 
-    axutil_property_set_value(prop_un, env, axutil_strdup(env, username));
-    axis2_options_set_property(options, env, AXIS2_HTTP_AUTH_UNAME, prop_un);
+    axis2_options_set_property_value(options, env, AXIS2_HTTP_AUTH_UNAME,
+                                     axutil_strdup(env, username), NULL);
 
-    prop_pw = axutil_property_create(env);
-    axutil_property_set_value(prop_pw, env, axutil_strdup(env, password));
-    axis2_options_set_property(options, env, AXIS2_HTTP_AUTH_PASSWD, prop_pw);
+    axis2_options_set_property_value(options, env, AXIS2_HTTP_AUTH_PASSWD,
+                                     axutil_strdup(env, password), NULL);
     
 
     if (auth_type)
@@ -1105,26 +1067,16 @@ axis2_options_set_http_auth_info(
     }    
     if (force_http_auth)
     {
-        axutil_property_t *http_auth_property = axutil_property_create(env);
-        axutil_property_t *http_auth_type_property = axutil_property_create(env);
-        
-        axutil_property_set_value(http_auth_property, env,
-                                  axutil_strdup(env, AXIS2_VALUE_TRUE));
-        axis2_options_set_property(options, env, AXIS2_FORCE_HTTP_AUTH,
-                                   http_auth_property);
+        axis2_options_set_property_value(options, env, AXIS2_FORCE_HTTP_AUTH,
+                                         axutil_strdup(env, AXIS2_VALUE_TRUE), NULL);
 
-        axutil_property_set_value(http_auth_type_property, env,
-                                  axutil_strdup(env, auth_type));
-        axis2_options_set_property(options, env, AXIS2_HTTP_AUTH_TYPE,
-                                   http_auth_type_property);
+        axis2_options_set_property_value(options, env, AXIS2_HTTP_AUTH_TYPE,
+                                         axutil_strdup(env, auth_type), NULL);
     }
     else
     {
-        axutil_property_t *http_auth_property = axutil_property_create(env);
-        axutil_property_set_value(http_auth_property, env,
-                                  axutil_strdup(env, AXIS2_VALUE_FALSE));
-        axis2_options_set_property(options, env, AXIS2_FORCE_HTTP_AUTH,
-                                   http_auth_property);
+        axis2_options_set_property_value(options, env, AXIS2_FORCE_HTTP_AUTH,
+                                         axutil_strdup(env, AXIS2_VALUE_FALSE), NULL);
     }
     return AXIS2_SUCCESS;    
 }
@@ -1142,38 +1094,28 @@ axis2_options_set_ntlm_proxy_auth_info(
 {
     axis2_bool_t force_proxy_auth = AXIS2_FALSE;
     axis2_char_t temp_str[4];
-    axutil_property_t *prop_pw = NULL;
-    axutil_property_t *prop_un = NULL;
-    axutil_property_t *prop_fg = NULL;
-    axutil_property_t *prop_do = NULL;
-    axutil_property_t *prop_wo = NULL;
 
-    prop_un = axutil_property_create(env);
-    axutil_property_set_value(prop_un, env, axutil_strdup(env, username));
-    axis2_options_set_property(options, env, AXIS2_PROXY_AUTH_UNAME, prop_un);
+    axis2_options_set_property_value(options, env, AXIS2_PROXY_AUTH_UNAME,
+                                     axutil_strdup(env, username), NULL);
 
-    prop_pw = axutil_property_create(env);
-    axutil_property_set_value(prop_pw, env, axutil_strdup(env, password));
-    axis2_options_set_property(options, env, AXIS2_PROXY_AUTH_PASSWD, prop_pw);
+    axis2_options_set_property_value(options, env, AXIS2_PROXY_AUTH_PASSWD,
+                                     axutil_strdup(env, password), NULL);
 
     sprintf(temp_str, "%d", flags);
-    prop_fg = axutil_property_create(env);
-    axutil_property_set_value(prop_fg, env, axutil_strdup(env, temp_str));
-    axis2_options_set_property(options, env, AXIS2_NTLM_AUTH_FLAGS, prop_fg);
+    axis2_options_set_property_value(options, env, AXIS2_NTLM_AUTH_FLAGS,
+                                     axutil_strdup(env, temp_str), NULL);
 
 
     if(domain)
     {
-        prop_do = axutil_property_create(env);
-        axutil_property_set_value(prop_do, env, axutil_strdup(env, domain));
-        axis2_options_set_property(options, env, AXIS2_NTLM_AUTH_DOMAIN, prop_do);
+        axis2_options_set_property_value(options, env, AXIS2_NTLM_AUTH_DOMAIN,
+                                         axutil_strdup(env, domain), NULL);
     }
 
     if(workstation)
     {
-        prop_wo = axutil_property_create(env);
-        axutil_property_set_value(prop_wo, env, axutil_strdup(env, workstation));
-        axis2_options_set_property(options, env, AXIS2_NTLM_AUTH_WORKSTATION, prop_wo);
+        axis2_options_set_property_value(options, env, AXIS2_NTLM_AUTH_WORKSTATION,
+                                         axutil_strdup(env, workstation), NULL);
     }
 
     if(auth_type)
@@ -1185,20 +1127,16 @@ axis2_options_set_ntlm_proxy_auth_info(
     }
     if(force_proxy_auth)
     {
-        axutil_property_t *proxy_auth_property = axutil_property_create(env);
-        axutil_property_t *proxy_auth_type_property = axutil_property_create(env);
-
-        axutil_property_set_value(proxy_auth_property, env, axutil_strdup(env, AXIS2_VALUE_TRUE));
-        axis2_options_set_property(options, env, AXIS2_FORCE_PROXY_AUTH, proxy_auth_property);
+        axis2_options_set_property_value(options, env, AXIS2_FORCE_PROXY_AUTH,
+                                         axutil_strdup(env, AXIS2_VALUE_TRUE), NULL);
 
-        axutil_property_set_value(proxy_auth_type_property, env, axutil_strdup(env, auth_type));
-        axis2_options_set_property(options, env, AXIS2_PROXY_AUTH_TYPE, proxy_auth_type_property);
+        axis2_options_set_property_value(options, env, AXIS2_PROXY_AUTH_TYPE,
+                                         axutil_strdup(env, auth_type), NULL);
     }
     else
     {
-        axutil_property_t *proxy_auth_property = axutil_property_create(env);
-        axutil_property_set_value(proxy_auth_property, env, axutil_strdup(env, AXIS2_VALUE_FALSE));
-        axis2_options_set_property(options, env, AXIS2_FORCE_PROXY_AUTH, proxy_auth_property);
+        axis2_options_set_property_value(options, env, AXIS2_FORCE_PROXY_AUTH,
+                                         axutil_strdup(env, AXIS2_VALUE_FALSE), NULL);
     }
     return AXIS2_SUCCESS;
 }
@@ -1216,37 +1154,27 @@ axis2_options_set_ntlm_http_auth_info(
 {
     axis2_bool_t force_http_auth = AXIS2_FALSE;
     axis2_char_t temp_str[4];
-    axutil_property_t *prop_un = NULL;
-    axutil_property_t *prop_pw = NULL;
-    axutil_property_t *prop_fg = NULL;
-    axutil_property_t *prop_do = NULL;
-    axutil_property_t *prop_wo = NULL;
 
-    prop_un = axutil_property_create(env);
-    axutil_property_set_value(prop_un, env, axutil_strdup(env, username));
-    axis2_options_set_property(options, env, AXIS2_HTTP_AUTH_UNAME, prop_un);
+    axis2_options_set_property_value(options, env, AXIS2_HTTP_AUTH_UNAME,
+                                     axutil_strdup(env, username), NULL);
 
-    prop_pw = axutil_property_create(env);
-    axutil_property_set_value(prop_pw, env, axutil_strdup(env, password));
-    axis2_options_set_property(options, env, AXIS2_HTTP_AUTH_PASSWD, prop_pw);
+    axis2_options_set_property_value(options, env, AXIS2_HTTP_AUTH_PASSWD,
+                                     axutil_strdup(env, password), NULL);
 
     sprintf(temp_str, "%d", flags);
-    prop_fg = axutil_property_create(env);
-    axutil_property_set_value(prop_fg, env, axutil_strdup(env, temp_str));
-    axis2_options_set_property(options, env, AXIS2_NTLM_AUTH_FLAGS, prop_fg);
+    axis2_options_set_property_value(options, env, AXIS2_NTLM_AUTH_FLAGS,
+                                     axutil_strdup(env, temp_str), NULL);
 
     if(domain)
     {
-        prop_do = axutil_property_create(env);
-        axutil_property_set_value(prop_do, env, axutil_strdup(env, domain));
-        axis2_options_set_property(options, env, AXIS2_NTLM_AUTH_DOMAIN, prop_do);
+        axis2_options_set_property_value(options, env, AXIS2_NTLM_AUTH_DOMAIN,
+                                         axutil_strdup(env, domain), NULL);
     }
 
     if(workstation)
     {
-        prop_wo = axutil_property_create(env);
-        axutil_property_set_value(prop_wo, env, axutil_strdup(env, workstation));
-        axis2_options_set_property(options, env, AXIS2_NTLM_AUTH_WORKSTATION, prop_wo);
+        axis2_options_set_property_value(options, env, AXIS2_NTLM_AUTH_WORKSTATION,
+                                         axutil_strdup(env, workstation), NULL);
     }
 
 
@@ -1259,20 +1187,16 @@ axis2_options_set_ntlm_http_auth_info(
     }
     if(force_http_auth)
     {
-        axutil_property_t *http_auth_property = axutil_property_create(env);
-        axutil_property_t *http_auth_type_property = axutil_property_create(env);
-
-        axutil_property_set_value(http_auth_property, env, axutil_strdup(env, AXIS2_VALUE_TRUE));
-        axis2_options_set_property(options, env, AXIS2_FORCE_HTTP_AUTH, http_auth_property);
+        axis2_options_set_property_value(options, env, AXIS2_FORCE_HTTP_AUTH,
+                                         axutil_strdup(env, AXIS2_VALUE_TRUE), NULL);
 
-        axutil_property_set_value(http_auth_type_property, env, axutil_strdup(env, auth_type));
-        axis2_options_set_property(options, env, AXIS2_HTTP_AUTH_TYPE, http_auth_type_property);
+        axis2_options_set_property_value(options, env, AXIS2_HTTP_AUTH_TYPE,
+                                         axutil_strdup(env, auth_type), NULL);
     }
     else
     {
-        axutil_property_t *http_auth_property = axutil_property_create(env);
-        axutil_property_set_value(http_auth_property, env, axutil_strdup(env, AXIS2_VALUE_FALSE));
-        axis2_options_set_property(options, env, AXIS2_FORCE_HTTP_AUTH, http_auth_property);
+        axis2_options_set_property_value(options, env, AXIS2_FORCE_HTTP_AUTH,
+                                         axutil_strdup(env, AXIS2_VALUE_FALSE), NULL);
     }
 
     return AXIS2_SUCCESS;
@@ -38,6 +38,7 @@
 #include <axis2_http_header.h>
 #include <neethi_util.h>
 #include <axis2_policy_include.h>
+#include <axis2_conf_ctx_cache.h>
 
 struct axis2_svc_client
 {
@@ -53,6 +54,12 @@ struct axis2_svc_client
 
     axis2_options_t *override_options;
 
+    /* Per call options, owned by the caller */
+    axis2_options_t *call_options;
+
+    /* Parent the call options had before being installed */
+    axis2_options_t *call_options_parent;
+
     /* SOAP Headers */
     axutil_array_list_t *headers;
 
@@ -81,6 +88,9 @@ struct axis2_svc_client
     
     axis2_bool_t keep_externally_passed_ctx_and_svc;
 
+    /* Cache conf_ctx was taken from, if any */
+    axis2_conf_ctx_cache_t *conf_ctx_cache;
+
 };
 
 static void axis2_svc_client_set_http_info(
@@ -98,6 +108,17 @@ static axis2_bool_t axis2_svc_client_init_transports_from_conf_ctx(
     axis2_conf_ctx_t * conf_ctx,
     const axis2_char_t * client_home);
 
+static axis2_svc_client_t *axis2_svc_client_create_impl(
+    const axutil_env_t * env,
+    const axis2_char_t * client_home,
+    axis2_conf_ctx_t * conf_ctx,
+    axis2_svc_t * svc,
+    axis2_conf_ctx_cache_t * conf_ctx_cache);
+
+static axis2_options_t *axis2_svc_client_get_call_options(
+    axis2_svc_client_t * svc_client,
+    const axutil_env_t * env);
+
 static axis2_bool_t axis2_svc_client_init_data(
     const axutil_env_t * env,
     axis2_svc_client_t * svc_client);
@@ -124,12 +145,35 @@ axis2_svc_client_create(
 }
 
 
+AXIS2_EXTERN axis2_svc_client_t *AXIS2_CALL
+axis2_svc_client_create_with_conf_ctx_cache(
+    const axutil_env_t * env,
+    const axis2_char_t * client_home,
+    axis2_conf_ctx_cache_t * conf_ctx_cache)
+{
+    AXIS2_PARAM_CHECK(env->error, conf_ctx_cache, NULL);
+    return axis2_svc_client_create_impl(env, client_home, NULL, NULL,
+                                        conf_ctx_cache);
+}
+
 AXIS2_EXTERN axis2_svc_client_t *AXIS2_CALL
 axis2_svc_client_create_with_conf_ctx_and_svc(
     const axutil_env_t * env,
     const axis2_char_t * client_home,
     axis2_conf_ctx_t * conf_ctx,
     axis2_svc_t * svc)
+{
+    return axis2_svc_client_create_impl(env, client_home, conf_ctx, svc,
+                                        NULL);
+}
+
+static axis2_svc_client_t *
+axis2_svc_client_create_impl(
+    const axutil_env_t * env,
+    const axis2_char_t * client_home,
+    axis2_conf_ctx_t * conf_ctx,
+    axis2_svc_t * svc,
+    axis2_conf_ctx_cache_t * conf_ctx_cache)
 {
     axis2_svc_client_t *svc_client = NULL;
     axis2_svc_grp_t *svc_grp = NULL;
@@ -150,6 +194,8 @@ axis2_svc_client_create_with_conf_ctx_and_svc(
     svc_client->svc_ctx = NULL;
     svc_client->options = NULL;
     svc_client->override_options = NULL;
+    svc_client->call_options = NULL;
+    svc_client->call_options_parent = NULL;
     svc_client->headers = NULL;
     svc_client->callback_recv = NULL;
     svc_client->listener_manager = NULL;
@@ -162,6 +208,7 @@ axis2_svc_client_create_with_conf_ctx_and_svc(
     svc_client->auth_type = NULL;
 	svc_client->http_headers = NULL;
     svc_client->keep_externally_passed_ctx_and_svc = AXIS2_FALSE;
+    svc_client->conf_ctx_cache = conf_ctx_cache;
 
     if (!axis2_svc_client_init_data(env, svc_client))
     {
@@ -196,8 +243,13 @@ axis2_svc_client_create_with_conf_ctx_and_svc(
     }
 
     /** add the service to the config context if it isn't in there already */
-    if (!axis2_conf_get_svc(svc_client->conf, env,
-                            axis2_svc_get_name(svc_client->svc, env)))
+    if (svc_client->conf_ctx_cache)
+    {
+        axis2_conf_ctx_cache_add_svc(svc_client->conf_ctx_cache, env,
+                                     svc_client->conf_ctx, svc_client->svc);
+    }
+    else if (!axis2_conf_get_svc(svc_client->conf, env,
+                                 axis2_svc_get_name(svc_client->svc, env)))
     {
         axis2_conf_add_svc(svc_client->conf, env, svc_client->svc);
     }
@@ -267,6 +319,11 @@ axis2_svc_client_set_options(
         axis2_options_free(svc_client->options, env);
     }
     svc_client->options = (axis2_options_t *) options;
+    if (svc_client->call_options)
+    {
+        axis2_options_set_parent(svc_client->call_options, env,
+                                 svc_client->options);
+    }
     return AXIS2_SUCCESS;
 }
 
@@ -305,6 +362,69 @@ axis2_svc_client_get_override_options(
     return svc_client->override_options;
 }
 
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_svc_client_set_call_options(
+    axis2_svc_client_t * svc_client,
+    const axutil_env_t * env,
+    axis2_options_t * call_options)
+{
+    AXIS2_PARAM_CHECK (env->error, svc_client, AXIS2_FAILURE);
+    if (svc_client->call_options)
+    {
+        axis2_options_set_parent(svc_client->call_options, env,
+                                 svc_client->call_options_parent);
+    }
+    svc_client->call_options = call_options;
+    svc_client->call_options_parent = NULL;
+    if (call_options)
+    {
+        /* The fallback to the client options is the only change made to
+           the caller's options, and is undone when they are taken out */
+        svc_client->call_options_parent =
+            axis2_options_get_parent(call_options, env);
+        axis2_options_set_parent(call_options, env, svc_client->options);
+    }
+    return AXIS2_SUCCESS;
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_svc_client_set_async_engine(
+    axis2_svc_client_t * svc_client,
+    const axutil_env_t * env,
+    axis2_async_engine_t * async_engine)
+{
+    axutil_property_t *property = NULL;
+
+    AXIS2_PARAM_CHECK (env->error, svc_client, AXIS2_FAILURE);
+
+    if (async_engine)
+    {
+        property = axutil_property_create_with_args(env, AXIS2_SCOPE_APPLICATION,
+                                                    AXIS2_FALSE, NULL,
+                                                    async_engine);
+        if (!property)
+        {
+            return AXIS2_FAILURE;
+        }
+    }
+    return axis2_options_set_property(svc_client->options, env,
+                                      AXIS2_ASYNC_ENGINE, property);
+}
+
+/* Options in effect for the next invocation: the call options when set,
+   falling back to the client options for anything they leave unset */
+static axis2_options_t *
+axis2_svc_client_get_call_options(
+    axis2_svc_client_t * svc_client,
+    const axutil_env_t * env)
+{
+    if (svc_client->call_options)
+    {
+        return svc_client->call_options;
+    }
+    return svc_client->options;
+}
+
 AXIS2_EXTERN axis2_status_t AXIS2_CALL
 axis2_svc_client_engage_module(
     axis2_svc_client_t * svc_client,
@@ -639,7 +759,8 @@ axis2_svc_client_send_receive_with_op_qname(
      * a separate listener but don't provide a callback function to acted upon when
      * response is received in the listener thread. What we do here is we create a callback
      * and call axis2_svc_client_send_receive_non_blocking_with_op_qname with it. */
-    if (axis2_options_get_use_separate_listener(svc_client->options, env))
+    if (axis2_options_get_use_separate_listener(
+            axis2_svc_client_get_call_options(svc_client, env), env))
     {
         axis2_callback_t *callback = NULL;
         axis2_msg_ctx_t *msg_ctx = NULL;
@@ -665,8 +786,9 @@ axis2_svc_client_send_receive_with_op_qname(
                                                                  callback);
 
         index =
-            axis2_options_get_timeout_in_milli_seconds(svc_client->options,
-                                                       env) / 10;
+            axis2_options_get_timeout_in_milli_seconds(
+                axis2_svc_client_get_call_options(svc_client, env),
+                env) / 10;
 
         while(!axis2_callback_get_complete(callback, env))
         {
@@ -818,6 +940,13 @@ axis2_svc_client_send_receive_with_op_qname(
     {
         return NULL;
     }
+    /* A body kept as text for passing it on; see AXIS2_PASSTHROUGH_BODY */
+    if (axiom_node_get_first_child(soap_node, env) &&
+        axiom_node_get_node_type(axiom_node_get_first_child(soap_node, env),
+                                 env) == AXIOM_DATA_SOURCE)
+    {
+        return axiom_node_get_first_child(soap_node, env);
+    }
     return axiom_node_get_first_element(soap_node, env);
 }
 
@@ -882,15 +1011,19 @@ axis2_svc_client_send_receive_non_blocking_with_op_qname(
     axis2_op_client_add_out_msg_ctx(svc_client->op_client, env, msg_ctx);
 
     /* If dual channel */
-    if (axis2_options_get_use_separate_listener(svc_client->options, env))
+    if (axis2_options_get_use_separate_listener(
+            axis2_svc_client_get_call_options(svc_client, env), env))
     {
         axis2_op_t *op = NULL;
 		
         transport_in_protocol =
-            axis2_options_get_transport_in_protocol(svc_client->options, env);
+            axis2_options_get_transport_in_protocol(
+                axis2_svc_client_get_call_options(svc_client, env), env);
 		if (transport_in_protocol == AXIS2_TRANSPORT_ENUM_MAX)
 		{
-			axis2_options_set_transport_in_protocol(svc_client->options, env, AXIS2_TRANSPORT_ENUM_HTTP);
+			axis2_options_set_transport_in_protocol(
+                axis2_svc_client_get_call_options(svc_client, env), env,
+                AXIS2_TRANSPORT_ENUM_HTTP);
 			transport_in_protocol = AXIS2_TRANSPORT_ENUM_HTTP;
 		}
         axis2_listener_manager_make_sure_started(svc_client->listener_manager,
@@ -963,7 +1096,8 @@ axis2_svc_client_create_op_client(
             axis2_op_client_free(svc_client->op_client, env);
         svc_client->op_client =
             axis2_op_client_create(env, op, svc_client->svc_ctx,
-                                   svc_client->options);
+                                   axis2_svc_client_get_call_options(
+                                       svc_client, env));
     }
 
     /**
@@ -994,7 +1128,8 @@ axis2_svc_client_finalize_invoke(
     AXIS2_PARAM_CHECK (env->error, svc_client, AXIS2_FAILURE);
 
     transport_in_protocol =
-        axis2_options_get_transport_in_protocol(svc_client->options, env);
+        axis2_options_get_transport_in_protocol(
+            axis2_svc_client_get_call_options(svc_client, env), env);
 
     if (svc_client->listener_manager)
     {
@@ -1048,7 +1183,16 @@ axis2_svc_client_init_transports_from_conf_ctx(
     const axis2_char_t * client_home)
 {
     svc_client->conf_ctx = conf_ctx;
-    if (!svc_client->conf_ctx)
+    if (!svc_client->conf_ctx && svc_client->conf_ctx_cache)
+    {
+        svc_client->conf_ctx = axis2_conf_ctx_cache_get(
+            svc_client->conf_ctx_cache, env, client_home);
+        if (!svc_client->conf_ctx)
+        {
+            return AXIS2_FALSE;
+        }
+    }
+    else if (!svc_client->conf_ctx)
     {
         svc_client->conf_ctx = axis2_build_client_conf_ctx(env, client_home);
         if (!svc_client->conf_ctx)
@@ -1125,7 +1269,19 @@ axis2_svc_client_create_annonymous_svc(
     *op_robust_out_only;
     axis2_phases_info_t *info = NULL;
 
-    tmp_qname = axutil_qname_create(env, AXIS2_ANON_SERVICE, NULL, NULL);
+    if (svc_client->conf_ctx_cache)
+    {
+        /* Every client sharing a cached configuration brings its own
+           anonymous service, so each needs a name of its own there */
+        axis2_char_t svc_name[sizeof(AXIS2_ANON_SERVICE) + 32];
+        AXIS2_SNPRINTF(svc_name, sizeof(svc_name), "%s-%p", AXIS2_ANON_SERVICE,
+                       (void *) svc_client);
+        tmp_qname = axutil_qname_create(env, svc_name, NULL, NULL);
+    }
+    else
+    {
+        tmp_qname = axutil_qname_create(env, AXIS2_ANON_SERVICE, NULL, NULL);
+    }
     if (!tmp_qname)
     {
         return NULL;
@@ -1215,7 +1371,8 @@ axis2_svc_client_free(
         svc_client->headers = NULL;        
     }
 
-    if (svc_client->svc && !svc_client->keep_externally_passed_ctx_and_svc)
+    if (svc_client->svc && !svc_client->keep_externally_passed_ctx_and_svc &&
+        !svc_client->conf_ctx_cache)
     {
         axis2_svc_free(svc_client->svc, env);
     }
@@ -1241,7 +1398,29 @@ axis2_svc_client_free(
         axis2_listener_manager_free(svc_client->listener_manager, env);
     }
 
-    if (svc_client->conf_ctx && !svc_client->keep_externally_passed_ctx_and_svc)
+    axis2_svc_client_set_call_options(svc_client, env, NULL);
+
+    if (svc_client->conf_ctx_cache)
+    {
+        /* The shared configuration outlives this client, so the service
+           has to be taken out of it before going away */
+        if (svc_client->svc && svc_client->conf_ctx)
+        {
+            axis2_conf_ctx_cache_remove_svc(svc_client->conf_ctx_cache, env,
+                                            svc_client->conf_ctx,
+                                            svc_client->svc);
+        }
+        if (svc_client->svc)
+        {
+            axis2_svc_free(svc_client->svc, env);
+        }
+        if (svc_client->conf_ctx)
+        {
+            axis2_conf_ctx_cache_release(svc_client->conf_ctx_cache, env,
+                                         svc_client->conf_ctx);
+        }
+    }
+    else if (svc_client->conf_ctx && !svc_client->keep_externally_passed_ctx_and_svc)
     {
         axis2_conf_ctx_free(svc_client->conf_ctx, env);
     }
@@ -1274,7 +1453,8 @@ axis2_svc_client_fill_soap_envelope(
     AXIS2_PARAM_CHECK (env->error, svc_client, AXIS2_FAILURE);
 
     soap_version_uri =
-        axis2_options_get_soap_version_uri(svc_client->options, env);
+        axis2_options_get_soap_version_uri(
+            axis2_svc_client_get_call_options(svc_client, env), env);
 
     if (!soap_version_uri)
     {
@@ -1485,7 +1665,7 @@ axis2_svc_client_set_proxy_with_auth(
                 password_attr = axiom_attribute_create(env, AXIS2_HTTP_PROXY_PASSWORD, password, NULL);
                 axutil_generic_obj_set_value(username_obj, env, username_attr);
                 axutil_generic_obj_set_value(password_obj, env, password_attr);
-                axutil_generic_obj_set_free_func(username_obj, env, axiom_attribute_free_void_arg);
+                axutil_generic_obj_set_free_func(username_obj, env, axiom_attribute_free_void_arg);
                 axutil_generic_obj_set_free_func(password_obj, env, axiom_attribute_free_void_arg);
                 axutil_hash_set(attribute, AXIS2_HTTP_PROXY_USERNAME, AXIS2_HASH_KEY_STRING,
                                 username_obj);
@@ -1565,9 +1745,14 @@ axis2_svc_client_set_policy(
         return AXIS2_FAILURE;
     }
 
-    axis2_policy_include_add_policy_element(policy_include, env,
-                                            AXIS2_SERVICE_POLICY, policy);
-    return AXIS2_SUCCESS;
+    if (axis2_policy_include_add_policy_element(policy_include, env,
+            AXIS2_SERVICE_POLICY, policy) != AXIS2_SUCCESS)
+    {
+        return AXIS2_FAILURE;
+    }
+
+    /* Merge now rather than on the first request sent with the policy */
+    return axis2_svc_calculate_effective_policies(svc, env);
 }
 
 AXIS2_EXTERN axutil_array_list_t *AXIS2_CALL
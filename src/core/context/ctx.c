@@ -18,7 +18,37 @@
 
 #include <axis2_ctx.h>
 #include <axis2_const.h>
+#include <axis2_msg_ctx.h>
+#include <axis2_addr.h>
+#include <axis2_http_transport.h>
 #include <axutil_hash.h>
+#include <axutil_free_list.h>
+
+#define AXIS2_CTX_SLOT_KEY(key) { key, sizeof(key) - 1 }
+
+/* keys of the slots, in the order of axis2_ctx_slot_t */
+static const axutil_hash_slot_key_t axis2_ctx_slot_keys[AXIS2_CTX_SLOT_COUNT] = {
+    AXIS2_CTX_SLOT_KEY(AXIS2_TRANSPORT_IN),
+    AXIS2_CTX_SLOT_KEY(AXIS2_TRANSPORT_OUT),
+    AXIS2_CTX_SLOT_KEY(AXIS2_TRANSPORT_HEADERS),
+    AXIS2_CTX_SLOT_KEY(AXIS2_TRANSPORT_URL),
+    AXIS2_CTX_SLOT_KEY(AXIS2_CHARACTER_SET_ENCODING),
+    AXIS2_CTX_SLOT_KEY(AXIS2_SVR_PEER_IP_ADDR),
+    AXIS2_CTX_SLOT_KEY(AXIS2_ENABLE_REST),
+    AXIS2_CTX_SLOT_KEY(AXIS2_WSA_VERSION),
+    AXIS2_CTX_SLOT_KEY(AXIS2_HTTP_CLIENT),
+    AXIS2_CTX_SLOT_KEY(AXIS2_HTTP_METHOD),
+    AXIS2_CTX_SLOT_KEY(AXIS2_HTTP_TRANSPORT_ERROR),
+    AXIS2_CTX_SLOT_KEY(AXIS2_HTTP_CONNECTION_TIMEOUT),
+    AXIS2_CTX_SLOT_KEY(AXIS2_TRANSPORT_HEADER_PROPERTY),
+    AXIS2_CTX_SLOT_KEY(AXIS2_USER_DEFINED_HTTP_HEADER_CONTENT_TYPE),
+    AXIS2_CTX_SLOT_KEY(AXIS2_HTTP_HEADER_CONTENT_LENGTH),
+    AXIS2_CTX_SLOT_KEY(MTOM_RECIVED_CONTENT_TYPE),
+    AXIS2_CTX_SLOT_KEY(AXIS2_TEST_HTTP_AUTH),
+    AXIS2_CTX_SLOT_KEY(AXIS2_TEST_PROXY_AUTH),
+    AXIS2_CTX_SLOT_KEY(AXIS2_FORCE_HTTP_AUTH),
+    AXIS2_CTX_SLOT_KEY(AXIS2_FORCE_PROXY_AUTH)
+};
 
 struct axis2_ctx
 {
@@ -38,7 +68,7 @@ axis2_ctx_create(
 
     AXIS2_ENV_CHECK(env, NULL);
 
-    ctx = AXIS2_MALLOC(env->allocator, sizeof(axis2_ctx_t));
+    ctx = axutil_free_list_malloc(env->allocator, sizeof(axis2_ctx_t));
     if (!ctx)
     {
         AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
@@ -54,6 +84,8 @@ axis2_ctx_create(
         axis2_ctx_free(ctx, env);
         return NULL;
     }
+    axutil_hash_set_slots(ctx->property_map, env, axis2_ctx_slot_keys,
+                          AXIS2_CTX_SLOT_COUNT);
 
     return ctx;
 }
@@ -113,6 +145,51 @@ axis2_ctx_get_property(
     return ret;
 }
 
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_ctx_set_property_at(
+    struct axis2_ctx * ctx,
+    const axutil_env_t * env,
+    axis2_ctx_slot_t slot,
+    axutil_property_t * value)
+{
+    AXIS2_ENV_CHECK(env, AXIS2_FAILURE);
+
+    if (slot < 0 || slot >= AXIS2_CTX_SLOT_COUNT)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_INVALID_NULL_PARAM,
+                        AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+    return axis2_ctx_set_property(ctx, env, axis2_ctx_slot_keys[slot].key,
+                                  value);
+}
+
+AXIS2_EXTERN axutil_property_t *AXIS2_CALL
+axis2_ctx_get_property_at(
+    const axis2_ctx_t * ctx,
+    const axutil_env_t * env,
+    axis2_ctx_slot_t slot)
+{
+    if (!ctx)
+    {
+        return NULL;
+    }
+    return (axutil_property_t *) axutil_hash_get_slot(ctx->property_map,
+                                                      slot);
+}
+
+AXIS2_EXTERN const axis2_char_t *AXIS2_CALL
+axis2_ctx_get_slot_key(
+    const axutil_env_t * env,
+    axis2_ctx_slot_t slot)
+{
+    if (slot < 0 || slot >= AXIS2_CTX_SLOT_COUNT)
+    {
+        return NULL;
+    }
+    return axis2_ctx_slot_keys[slot].key;
+}
+
 AXIS2_EXTERN axutil_hash_t *AXIS2_CALL
 axis2_ctx_get_all_properties(
     const axis2_ctx_t * ctx,
@@ -157,7 +234,7 @@ axis2_ctx_free(
         axutil_hash_free(ctx->property_map, env);
     }
 
-    AXIS2_FREE(env->allocator, ctx);
+    axutil_free_list_free(env->allocator, ctx, sizeof(axis2_ctx_t));
 
     return;
 }
@@ -196,6 +273,12 @@ axis2_ctx_set_property_map(
 
     ctx->property_map = map;
     ctx->property_map_deep_copy = AXIS2_FALSE;
+    if (map)
+    {
+        /* a map made elsewhere, such as the properties of the options */
+        axutil_hash_set_slots(map, env, axis2_ctx_slot_keys,
+                              AXIS2_CTX_SLOT_COUNT);
+    }
 
     return AXIS2_SUCCESS;
 }
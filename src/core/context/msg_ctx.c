@@ -30,6 +30,7 @@
 #include <axiom_soap_envelope.h>
 #include <axiom_soap_const.h>
 #include <axis2_options.h>
+#include <axutil_free_list.h>
 
 struct axis2_msg_ctx
 {
@@ -236,7 +237,7 @@ axis2_msg_ctx_create(
 {
     axis2_msg_ctx_t *msg_ctx = NULL;
 
-    msg_ctx = AXIS2_MALLOC(env->allocator, sizeof(axis2_msg_ctx_t));
+    msg_ctx = axutil_free_list_malloc(env->allocator, sizeof(axis2_msg_ctx_t));
     if (!msg_ctx)
     {
         AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
@@ -560,7 +561,7 @@ axis2_msg_ctx_free(
     if (msg_ctx->op_ctx && msg_ctx->op_ctx_owner)
         axis2_op_ctx_free(msg_ctx->op_ctx, env);
 
-    AXIS2_FREE(env->allocator, msg_ctx);
+    axutil_free_list_free(env->allocator, msg_ctx, sizeof(axis2_msg_ctx_t));
 
     return;
 }
@@ -1535,6 +1536,59 @@ axis2_msg_ctx_set_property(
     return axis2_ctx_set_property(msg_ctx->base, env, key, value);
 }
 
+axutil_property_t *AXIS2_CALL
+axis2_msg_ctx_get_property_at(
+    const axis2_msg_ctx_t * msg_ctx,
+    const axutil_env_t * env,
+    axis2_ctx_slot_t slot)
+{
+    axutil_property_t *obj = NULL;
+
+    /* same as axis2_msg_ctx_get_property */
+    if (!msg_ctx)
+    {
+        if (axutil_error_get_status_code(env->error) == AXIS2_SUCCESS)
+        {
+            AXIS2_ERROR_SET (env->error, AXIS2_ERROR_INVALID_NULL_PARAM, AXIS2_FAILURE);
+        }
+        return NULL;
+    }
+
+    obj = axis2_ctx_get_property_at(msg_ctx->base, env, slot);
+    if (!obj && msg_ctx->op_ctx)
+    {
+        obj = axis2_ctx_get_property_at(
+            axis2_op_ctx_get_base(msg_ctx->op_ctx, env), env, slot);
+    }
+    if (!obj && msg_ctx->svc_ctx)
+    {
+        obj = axis2_ctx_get_property_at(
+            axis2_svc_ctx_get_base(msg_ctx->svc_ctx, env), env, slot);
+    }
+    if (!obj && msg_ctx->svc_grp_ctx)
+    {
+        obj = axis2_ctx_get_property_at(
+            axis2_svc_grp_ctx_get_base(msg_ctx->svc_grp_ctx, env), env, slot);
+    }
+    if (!obj && msg_ctx->conf_ctx)
+    {
+        obj = axis2_ctx_get_property_at(
+            axis2_conf_ctx_get_base(msg_ctx->conf_ctx, env), env, slot);
+    }
+    return obj;
+}
+
+axis2_status_t AXIS2_CALL
+axis2_msg_ctx_set_property_at(
+    struct axis2_msg_ctx * msg_ctx,
+    const axutil_env_t * env,
+    axis2_ctx_slot_t slot,
+    axutil_property_t * value)
+{
+    AXIS2_PARAM_CHECK (env->error, msg_ctx, AXIS2_FAILURE);
+    return axis2_ctx_set_property_at(msg_ctx->base, env, slot, value);
+}
+
 const axutil_string_t *AXIS2_CALL
 axis2_msg_ctx_get_paused_handler_name(
     const axis2_msg_ctx_t * msg_ctx,
@@ -1938,8 +1992,8 @@ axis2_msg_ctx_set_options(
 
     axis2_ctx_set_property_map(msg_ctx->base, env,
                                axis2_options_get_properties(options, env));
-    rest_val = (axutil_property_t *) axis2_msg_ctx_get_property(msg_ctx, env,
-                                                                AXIS2_ENABLE_REST);
+    rest_val = (axutil_property_t *) axis2_msg_ctx_get_property_at(msg_ctx, env,
+                                                                   AXIS2_CTX_SLOT_ENABLE_REST);
     if (rest_val)
     {
         value = (axis2_char_t *) axutil_property_get_value(rest_val, env);
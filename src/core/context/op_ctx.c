@@ -21,6 +21,7 @@
 #include <axis2_op.h>
 #include <axis2_const.h>
 #include <axutil_hash.h>
+#include <axutil_free_list.h>
 
 struct axis2_op_ctx
 {
@@ -73,7 +74,7 @@ axis2_op_ctx_create(
     axis2_op_ctx_t *op_ctx = NULL;
     int i = 0;
 
-    op_ctx = AXIS2_MALLOC(env->allocator, sizeof(axis2_op_ctx_t));
+    op_ctx = axutil_free_list_malloc(env->allocator, sizeof(axis2_op_ctx_t));
     if (!op_ctx)
     {
         AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
@@ -90,6 +91,10 @@ axis2_op_ctx_create(
     op_ctx->op_qname = NULL;
     op_ctx->svc_qname = NULL;
     op_ctx->response_written = AXIS2_FALSE;
+    for (i = 0; i < AXIS2_WSDL_MESSAGE_LABEL_MAX; i++)
+    {
+        op_ctx->msg_ctx_array[i] = NULL;
+    }
     op_ctx->mutex = axutil_thread_mutex_create(env->allocator,
                                                AXIS2_THREAD_MUTEX_DEFAULT);
     
@@ -111,11 +116,6 @@ axis2_op_ctx_create(
         op_ctx->op = op;
     }
 
-    for (i = 0; i < AXIS2_WSDL_MESSAGE_LABEL_MAX; i++)
-    {
-        op_ctx->msg_ctx_array[i] = NULL;
-    }
-
     if (op_ctx->op)
     {
         op_ctx->op_qname =
@@ -171,7 +171,7 @@ axis2_op_ctx_free(
         axutil_thread_mutex_destroy(op_ctx->mutex);
     }
 
-    AXIS2_FREE(env->allocator, op_ctx);
+    axutil_free_list_free(env->allocator, op_ctx, sizeof(axis2_op_ctx_t));
 
     return;
 }
@@ -75,6 +75,51 @@ axis2_arch_reader_create_svc(
     return svc;
 }
 
+AXIS2_EXTERN axis2_char_t *AXIS2_CALL
+axis2_arch_reader_get_desc_file_path(
+    const axutil_env_t * env,
+    axis2_char_t * file_name,
+    int type,
+    struct axis2_dep_engine * dep_engine)
+{
+    axis2_char_t *repos_path = NULL;
+    axis2_char_t *folder = NULL;
+    axis2_char_t *desc_file = NULL;
+
+    AXIS2_PARAM_CHECK(env->error, file_name, NULL);
+    AXIS2_PARAM_CHECK(env->error, dep_engine, NULL);
+
+    if (AXIS2_MODULE == type)
+    {
+        folder = AXIS2_MODULE_FOLDER;
+        desc_file = AXIS2_MODULE_XML;
+    }
+    else
+    {
+        folder = AXIS2_SERVICE_FOLDER;
+        desc_file = AXIS2_SVC_XML;
+    }
+
+    if (!axis2_dep_engine_get_file_flag(dep_engine, env))
+    {
+        repos_path = axis2_dep_engine_get_repos_path(dep_engine, env);
+        return axutil_strcat(env, repos_path, AXIS2_PATH_SEP_STR, folder,
+                             AXIS2_PATH_SEP_STR, file_name, AXIS2_PATH_SEP_STR,
+                             desc_file, NULL);
+    }
+
+    if (AXIS2_MODULE == type)
+    {
+        repos_path = axis2_dep_engine_get_module_dir(dep_engine, env);
+    }
+    else
+    {
+        repos_path = axis2_dep_engine_get_svc_dir(dep_engine, env);
+    }
+    return axutil_strcat(env, repos_path, AXIS2_PATH_SEP_STR, file_name,
+                         AXIS2_PATH_SEP_STR, desc_file, NULL);
+}
+
 AXIS2_EXTERN axis2_status_t AXIS2_CALL
 axis2_arch_reader_process_svc_grp(
     axis2_arch_reader_t * arch_reader,
@@ -85,32 +130,12 @@ axis2_arch_reader_process_svc_grp(
 {
     axis2_status_t status = AXIS2_FAILURE;
     axis2_char_t *svc_grp_xml = NULL;
-    axis2_char_t *repos_path = NULL;
-    axis2_bool_t file_flag = AXIS2_FALSE;
     AXIS2_PARAM_CHECK(env->error, file_name, AXIS2_FAILURE);
     AXIS2_PARAM_CHECK(env->error, dep_engine, AXIS2_FAILURE);
     AXIS2_PARAM_CHECK(env->error, svc_grp, AXIS2_FAILURE);
 
-    file_flag = axis2_dep_engine_get_file_flag (dep_engine, env);
-
-    if (!file_flag)
-    { 
-
-        repos_path = axis2_dep_engine_get_repos_path(dep_engine, env);
-        
-        svc_grp_xml = axutil_strcat(env, repos_path, AXIS2_PATH_SEP_STR,
-                                 AXIS2_SERVICE_FOLDER, AXIS2_PATH_SEP_STR,
-                                 file_name, AXIS2_PATH_SEP_STR, AXIS2_SVC_XML,
-                                 NULL);
-    }
-    else
-    {
-        repos_path = axis2_dep_engine_get_svc_dir (dep_engine, env);
-        svc_grp_xml = axutil_strcat (env, repos_path, AXIS2_PATH_SEP_STR,
-                                  file_name, AXIS2_PATH_SEP_STR, AXIS2_SVC_XML,
-                                  NULL);
-    }
-
+    svc_grp_xml = axis2_arch_reader_get_desc_file_path(env, file_name,
+                                                       AXIS2_SVC, dep_engine);
     if (!svc_grp_xml)
     {
         AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
@@ -266,30 +291,13 @@ axis2_arch_reader_read_module_arch(
 {
     axis2_status_t status = AXIS2_FAILURE;
     axis2_char_t *module_xml = NULL;
-    axis2_char_t *repos_path = NULL;
-    axis2_bool_t file_flag;
 
     AXIS2_PARAM_CHECK(env->error, file_name, AXIS2_FAILURE);
     AXIS2_PARAM_CHECK(env->error, dep_engine, AXIS2_FAILURE);
     AXIS2_PARAM_CHECK(env->error, module_desc, AXIS2_FAILURE);
 
-    file_flag = axis2_dep_engine_get_file_flag (dep_engine, env);
-	if (!file_flag)
-	{
-    	repos_path = axis2_dep_engine_get_repos_path(dep_engine, env);
-    	module_xml = axutil_strcat(env, repos_path, AXIS2_PATH_SEP_STR,
-        	                       AXIS2_MODULE_FOLDER, AXIS2_PATH_SEP_STR,
-            	                   file_name, AXIS2_PATH_SEP_STR, AXIS2_MODULE_XML,
-                	               NULL);
-	}
-	else
-	{
-        repos_path = axis2_dep_engine_get_module_dir (dep_engine, env);
-        module_xml = axutil_strcat (env, repos_path, AXIS2_PATH_SEP_STR,
-                                    file_name, AXIS2_PATH_SEP_STR, AXIS2_MODULE_XML,
-                                    NULL);
-	}
-	
+    module_xml = axis2_arch_reader_get_desc_file_path(env, file_name,
+                                                      AXIS2_MODULE, dep_engine);
     if (!module_xml)
     {
         AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
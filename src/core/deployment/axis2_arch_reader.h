@@ -110,6 +110,22 @@ extern "C"
         struct axis2_dep_engine *dep_engine,
         struct axis2_svc_grp *svc_grp);
 
+    /**
+     * Construct the path to the descriptor(services.xml or module.xml) of
+     * a service or module folder in the repository.
+     * @param env pointer to environment struct
+     * @param file_name name of the service or module folder
+     * @param type AXIS2_SVC or AXIS2_MODULE
+     * @param dep_engine pointer to deployment engine
+     * @return newly allocated path, to be freed by the caller
+     */
+    AXIS2_EXTERN axis2_char_t *AXIS2_CALL
+    axis2_arch_reader_get_desc_file_path(
+        const axutil_env_t * env,
+        axis2_char_t * file_name,
+        int type,
+        struct axis2_dep_engine *dep_engine);
+
     /**
      * Construct the path to the module configuration file(module.xml)
      * using the passed file name and populate the passed module description.
@@ -410,6 +410,21 @@ extern "C"
         const axutil_env_t * env,
         struct axis2_svc_grp_builder *svc_grp_builder);
 
+    /**
+     * Hand over the OM tree of a descriptor that was parsed ahead of
+     * deployment. The caller owns the returned tree.
+     * @param dep_engine pointer to deployment engine
+     * @param env pointer to environment struct
+     * @param file_name path to services.xml or module.xml
+     * @return root node of the parsed descriptor, or NULL if it was not
+     * parsed ahead
+     */
+    AXIS2_EXTERN axiom_node_t *AXIS2_CALL
+    axis2_dep_engine_take_prebuilt_om(
+        axis2_dep_engine_t * dep_engine,
+        const axutil_env_t * env,
+        const axis2_char_t * file_name);
+
     /** @} */
 
 #ifdef __cplusplus
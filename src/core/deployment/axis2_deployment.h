@@ -92,6 +92,7 @@ extern "C"
 
 #define AXIS2_HOTDEPLOYMENT "hotdeployment"
 #define AXIS2_HOTUPDATE "hotupdate"
+#define AXIS2_DEPLOYMENT_THREADS "deploymentThreads"
 #define AXIS2_DISPATCH_ORDER "dispatchOrder"
 #define AXIS2_DISPATCHER "dispatcher"
 
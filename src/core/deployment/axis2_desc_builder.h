@@ -81,6 +81,20 @@ extern "C"
         axis2_desc_builder_t * desc_builder,
         const axutil_env_t * env);
 
+    /**
+     * Parse a description document into a fully built OM tree without a
+     * desc builder. Used to parse documents ahead of deployment, possibly
+     * in another thread.
+     * @param env pointer to environment struct
+     * @param file_name path to the document
+     * @return root node of the document, to be freed by the caller, or
+     * NULL on failure
+     */
+    AXIS2_EXTERN axiom_node_t *AXIS2_CALL
+    axis2_desc_builder_build_om_from_file(
+        const axutil_env_t * env,
+        const axis2_char_t * file_name);
+
     /**
      * To process Flow elements in services.xml
      * @param desc_builder pointer to desc builder
@@ -803,6 +803,10 @@ axis2_conf_builder_process_transport_senders(
 				{
 					transport_enum = AXIS2_TRANSPORT_ENUM_UDP;
 				}
+                else if (!axutil_strcmp(name, AXIS2_TRANSPORT_LOCAL))
+                {
+                    transport_enum = AXIS2_TRANSPORT_ENUM_LOCAL;
+                }
                 else
                 {
                     AXIS2_LOG_ERROR (env->log, AXIS2_LOG_SI,
@@ -1159,6 +1163,10 @@ axis2_conf_builder_process_transport_recvs(
 				{
 					transport_enum = AXIS2_TRANSPORT_ENUM_UDP;
 				}
+                else if (!axutil_strcmp(name, AXIS2_TRANSPORT_LOCAL))
+                {
+                    transport_enum = AXIS2_TRANSPORT_ENUM_LOCAL;
+                }
                 else
                 {
                     AXIS2_LOG_ERROR (env->log, AXIS2_LOG_SI, 
@@ -1287,13 +1295,19 @@ axis2_conf_builder_process_transport_recvs(
                                                         env, qparamst,
                                                         transport_node);
             axutil_qname_free(qparamst, env);
-            status =
-                axis2_desc_builder_process_params(conf_builder->desc_builder,
-                                                  env, itr,
-                                                  axis2_transport_in_desc_param_container
-                                                  (transport_in, env),
-                                                  axis2_conf_get_param_container
-                                                  (conf_builder->conf, env));
+            /* An empty element, as the local transport takes, has neither
+               children nor parameters */
+            status = AXIS2_SUCCESS;
+            if (itr)
+            {
+                status =
+                    axis2_desc_builder_process_params(conf_builder->desc_builder,
+                                                      env, itr,
+                                                      axis2_transport_in_desc_param_container
+                                                      (transport_in, env),
+                                                      axis2_conf_get_param_container
+                                                      (conf_builder->conf, env));
+            }
             if (!status)
             {
                 AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, 
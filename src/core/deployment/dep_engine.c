@@ -31,6 +31,25 @@
 #include <axutil_utils.h>
 #include <axis2_core_utils.h>
 #include <axis2_module.h>
+#include <axutil_thread_pool.h>
+#include <axutil_hash.h>
+
+/* A descriptor parsed ahead of deployment */
+typedef struct axis2_dep_engine_prebuilt
+{
+    axis2_char_t *file_name;
+    axiom_node_t *root;
+} axis2_dep_engine_prebuilt_t;
+
+/* Share of the descriptors parsed by one deployment thread */
+typedef struct axis2_dep_engine_parse_args
+{
+    const axutil_env_t *env;
+    axis2_dep_engine_prebuilt_t *items;
+    int count;
+    int first;
+    int step;
+} axis2_dep_engine_parse_args_t;
 
 struct axis2_dep_engine
 {
@@ -92,6 +111,19 @@ struct axis2_dep_engine
     axutil_array_list_t *module_builders;
     axutil_array_list_t *svc_builders;
     axutil_array_list_t *svc_grp_builders;
+
+    /**
+     * Number of threads used to parse services.xml and module.xml files
+     * before they are deployed
+     */
+    int deploy_threads;
+
+    /**
+     * Descriptors parsed ahead by the deployment threads, keyed by path
+     */
+    axis2_dep_engine_prebuilt_t *prebuilt;
+    int prebuilt_count;
+    axutil_hash_t *prebuilt_om;
 };
 
 static axis2_status_t axis2_dep_engine_set_dep_features(
@@ -141,6 +173,23 @@ static axis2_status_t axis2_dep_engine_set_svc_and_module_dir_path (
     axis2_dep_engine_t *dep_engine,
     const axutil_env_t *env);
 
+static axis2_status_t axis2_dep_engine_prebuild_om(
+    axis2_dep_engine_t * dep_engine,
+    const axutil_env_t * env);
+
+static void axis2_dep_engine_free_prebuilt_om(
+    axis2_dep_engine_t * dep_engine,
+    const axutil_env_t * env);
+
+static axis2_status_t axis2_dep_engine_deploy_files(
+    axis2_dep_engine_t * dep_engine,
+    const axutil_env_t * env);
+
+static void axis2_dep_engine_log_stage(
+    const axutil_env_t * env,
+    const axis2_char_t * stage,
+    struct AXIS2_PLATFORM_TIMEB *start);
+
 AXIS2_EXTERN axis2_dep_engine_t *AXIS2_CALL
 axis2_dep_engine_create(
     const axutil_env_t * env)
@@ -180,6 +229,10 @@ axis2_dep_engine_create(
     dep_engine->module_builders = NULL;
     dep_engine->svc_builders = NULL;
     dep_engine->svc_grp_builders = NULL;
+    dep_engine->deploy_threads = 1;
+    dep_engine->prebuilt = NULL;
+    dep_engine->prebuilt_count = 0;
+    dep_engine->prebuilt_om = NULL;
 
     dep_engine->ws_to_deploy = axutil_array_list_create(env, 0);
     if (!(dep_engine->ws_to_deploy))
@@ -380,6 +433,8 @@ axis2_dep_engine_free(
         return;
     }
 
+    axis2_dep_engine_free_prebuilt_om(dep_engine, env);
+
     if (dep_engine->curr_file)
     {
         axis2_arch_file_data_free(dep_engine->curr_file, env);
@@ -672,11 +727,13 @@ axis2_dep_engine_set_dep_features(
     axis2_char_t *value = NULL;
     axutil_param_t *para_hot_dep = NULL;
     axutil_param_t *para_hot_update = NULL;
+    axutil_param_t *para_threads = NULL;
 
     AXIS2_PARAM_CHECK (env->error, dep_engine, AXIS2_FAILURE);
 
     para_hot_dep = axis2_conf_get_param(dep_engine->conf, env, AXIS2_HOTDEPLOYMENT);
     para_hot_update = axis2_conf_get_param(dep_engine->conf, env, AXIS2_HOTUPDATE);
+    para_threads = axis2_conf_get_param(dep_engine->conf, env, AXIS2_DEPLOYMENT_THREADS);
 
     if (para_hot_dep)
     {
@@ -696,6 +753,15 @@ axis2_dep_engine_set_dep_features(
         }
     }
 
+    if (para_threads)
+    {
+        value = (axis2_char_t *) axutil_param_get_value(para_threads, env);
+        if (value && AXIS2_ATOI(value) > 0)
+        {
+            dep_engine->deploy_threads = AXIS2_ATOI(value);
+        }
+    }
+
     return AXIS2_SUCCESS;
 }
 
@@ -706,6 +772,8 @@ axis2_dep_engine_load(
 {
     axis2_status_t status = AXIS2_FAILURE;
     axutil_array_list_t *out_fault_phases = NULL;
+    struct AXIS2_PLATFORM_TIMEB load_start;
+    struct AXIS2_PLATFORM_TIMEB stage_start;
 
     if (!dep_engine->conf_name)
     {
@@ -717,6 +785,9 @@ axis2_dep_engine_load(
         return NULL;
     }
 
+    AXIS2_PLATFORM_GET_TIME_IN_MILLIS(&load_start);
+    stage_start = load_start;
+
     dep_engine->conf = axis2_conf_create(env);
 
     if (!dep_engine->conf)
@@ -752,6 +823,7 @@ axis2_dep_engine_load(
 		AXIS2_LOG_ERROR (env->log, AXIS2_LOG_SI, "Populating Axis2 Configuration failed");
         return NULL;
     }
+    axis2_dep_engine_log_stage(env, "reading axis2.xml", &stage_start);
 
     status = axis2_dep_engine_set_svc_and_module_dir_path (dep_engine, env);
     if (AXIS2_SUCCESS != status)
@@ -785,6 +857,7 @@ axis2_dep_engine_load(
 
         return NULL;
     }
+    axis2_dep_engine_log_stage(env, "deploying services and modules", &stage_start);
 
     axis2_conf_set_repo(dep_engine->conf, env, dep_engine->axis2_repos);
     axis2_core_utils_calculate_default_module_version(env, axis2_conf_get_all_modules(
@@ -843,6 +916,8 @@ axis2_dep_engine_load(
         AXIS2_ERROR_SET(env->error, AXIS2_ERROR_MODULE_VALIDATION_FAILED, AXIS2_FAILURE);
         return NULL;
     }
+    axis2_dep_engine_log_stage(env, "engaging modules", &stage_start);
+    axis2_dep_engine_log_stage(env, "total", &load_start);
 
     return dep_engine->conf;
 }
@@ -1242,7 +1317,27 @@ axis2_dep_engine_add_new_svc(
         axis2_svc_grp_add_svc(svc_metadata, env, svc);
     }
 
-    return axis2_conf_add_svc_grp(dep_engine->conf, env, svc_metadata);
+    if (axis2_conf_add_svc_grp(dep_engine->conf, env, svc_metadata) != AXIS2_SUCCESS)
+    {
+        return AXIS2_FAILURE;
+    }
+
+    /* With the whole description hierarchy in place the effective policies
+     * can be worked out once here instead of on each request */
+    for (i = 0; i < sizei; i++)
+    {
+        axis2_svc_t *svc = (axis2_svc_t *) axutil_array_list_get(svcs, env, i);
+
+        if (axis2_svc_calculate_effective_policies(svc, env) != AXIS2_SUCCESS)
+        {
+            /* Not fatal, each policy is calculated on first use instead */
+            AXIS2_LOG_WARNING(env->log, AXIS2_LOG_SI,
+                "Calculating the effective policies of service %s failed",
+                axis2_svc_get_name(svc, env));
+        }
+    }
+
+    return AXIS2_SUCCESS;
 }
 
 /* Here we will load the actual module implementation dll using the class loader and store it in
@@ -1472,11 +1567,30 @@ axis2_dep_engine_do_deploy(
     axis2_dep_engine_t * dep_engine,
     const axutil_env_t * env)
 {
-    int size = 0;
     axis2_status_t status = AXIS2_FAILURE;
 
     AXIS2_PARAM_CHECK (env->error, dep_engine, AXIS2_FAILURE);
 
+    /* Parsing the descriptors is the costly part of deployment and does not
+     * touch the configuration, so it is done up front by several threads.
+     * Building the descriptions from the parsed trees stays sequential */
+    if (dep_engine->deploy_threads > 1)
+    {
+        axis2_dep_engine_prebuild_om(dep_engine, env);
+    }
+    status = axis2_dep_engine_deploy_files(dep_engine, env);
+    axis2_dep_engine_free_prebuilt_om(dep_engine, env);
+    return status;
+}
+
+static axis2_status_t
+axis2_dep_engine_deploy_files(
+    axis2_dep_engine_t * dep_engine,
+    const axutil_env_t * env)
+{
+    int size = 0;
+    axis2_status_t status = AXIS2_FAILURE;
+
     size = axutil_array_list_size(dep_engine->ws_to_deploy, env);
 
     if (size > 0)
@@ -1999,4 +2113,219 @@ static axis2_status_t axis2_dep_engine_set_svc_and_module_dir_path (
     return AXIS2_SUCCESS;
 }
 
+AXIS2_EXTERN axiom_node_t *AXIS2_CALL
+axis2_dep_engine_take_prebuilt_om(
+    axis2_dep_engine_t * dep_engine,
+    const axutil_env_t * env,
+    const axis2_char_t * file_name)
+{
+    axis2_dep_engine_prebuilt_t *item = NULL;
+    axiom_node_t *root = NULL;
+
+    AXIS2_PARAM_CHECK(env->error, file_name, NULL);
+
+    if (!dep_engine->prebuilt_om)
+    {
+        return NULL;
+    }
+    item = (axis2_dep_engine_prebuilt_t *) axutil_hash_get(
+        dep_engine->prebuilt_om, file_name, AXIS2_HASH_KEY_STRING);
+    if (item)
+    {
+        root = item->root;
+        item->root = NULL;
+    }
+    return root;
+}
+
+static void *AXIS2_THREAD_FUNC
+axis2_dep_engine_parse_worker(
+    axutil_thread_t * thd,
+    void *data)
+{
+    axis2_dep_engine_parse_args_t *args = (axis2_dep_engine_parse_args_t *) data;
+    axutil_env_t *thread_env = NULL;
+    int i = 0;
+
+    thread_env = axutil_init_thread_env(args->env);
+    if (!thread_env)
+    {
+        return NULL;
+    }
+    for (i = args->first; i < args->count; i += args->step)
+    {
+        args->items[i].root = axis2_desc_builder_build_om_from_file(thread_env,
+            args->items[i].file_name);
+    }
+    axutil_free_thread_env(thread_env);
+    return NULL;
+}
+
+static axis2_status_t
+axis2_dep_engine_prebuild_om(
+    axis2_dep_engine_t * dep_engine,
+    const axutil_env_t * env)
+{
+    int size = 0;
+    int count = 0;
+    int threads = 0;
+    int i = 0;
+    axis2_dep_engine_parse_args_t *args = NULL;
+    axutil_thread_t **workers = NULL;
+    struct AXIS2_PLATFORM_TIMEB start;
+
+    size = axutil_array_list_size(dep_engine->ws_to_deploy, env);
+    if (size < 2 || !env->thread_pool)
+    {
+        return AXIS2_SUCCESS;
+    }
+    AXIS2_PLATFORM_GET_TIME_IN_MILLIS(&start);
+
+    axis2_dep_engine_free_prebuilt_om(dep_engine, env);
+    dep_engine->prebuilt = AXIS2_MALLOC(env->allocator,
+        sizeof(axis2_dep_engine_prebuilt_t) * size);
+    dep_engine->prebuilt_om = axutil_hash_make(env);
+    if (!dep_engine->prebuilt || !dep_engine->prebuilt_om)
+    {
+        axis2_dep_engine_free_prebuilt_om(dep_engine, env);
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+    for (i = 0; i < size; i++)
+    {
+        axis2_arch_file_data_t *file_data = NULL;
+        axis2_char_t *file_name = NULL;
+
+        file_data = (axis2_arch_file_data_t *) axutil_array_list_get(
+            dep_engine->ws_to_deploy, env, i);
+        file_name = axis2_arch_reader_get_desc_file_path(env,
+            axis2_arch_file_data_get_name(file_data, env),
+            axis2_arch_file_data_get_type(file_data, env), dep_engine);
+        if (file_name)
+        {
+            dep_engine->prebuilt[count].file_name = file_name;
+            dep_engine->prebuilt[count].root = NULL;
+            count++;
+        }
+    }
+    dep_engine->prebuilt_count = count;
+
+    threads = (dep_engine->deploy_threads < count) ?
+        dep_engine->deploy_threads : count;
+    args = AXIS2_MALLOC(env->allocator,
+        sizeof(axis2_dep_engine_parse_args_t) * threads);
+    workers = AXIS2_MALLOC(env->allocator, sizeof(axutil_thread_t *) * threads);
+    if (!args || !workers)
+    {
+        if (args)
+        {
+            AXIS2_FREE(env->allocator, args);
+        }
+        if (workers)
+        {
+            AXIS2_FREE(env->allocator, workers);
+        }
+        axis2_dep_engine_free_prebuilt_om(dep_engine, env);
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+
+    /* The calling thread takes the first share itself */
+    for (i = 0; i < threads; i++)
+    {
+        args[i].env = env;
+        args[i].items = dep_engine->prebuilt;
+        args[i].count = count;
+        args[i].first = i;
+        args[i].step = threads;
+        workers[i] = NULL;
+        if (i > 0)
+        {
+            workers[i] = axutil_thread_pool_get_thread(env->thread_pool,
+                axis2_dep_engine_parse_worker, &args[i]);
+            if (!workers[i])
+            {
+                AXIS2_LOG_WARNING(env->log, AXIS2_LOG_SI,
+                    "Unable to start deployment thread, its descriptors are "
+                    "parsed when deployed");
+            }
+        }
+    }
+    for (i = 0; i < count; i += threads)
+    {
+        dep_engine->prebuilt[i].root = axis2_desc_builder_build_om_from_file(
+            env, dep_engine->prebuilt[i].file_name);
+    }
+    for (i = 1; i < threads; i++)
+    {
+        if (workers[i])
+        {
+            axutil_thread_pool_join_thread(env->thread_pool, workers[i]);
+        }
+    }
+    AXIS2_FREE(env->allocator, workers);
+    AXIS2_FREE(env->allocator, args);
+
+    for (i = 0; i < count; i++)
+    {
+        axutil_hash_set(dep_engine->prebuilt_om, dep_engine->prebuilt[i].file_name,
+                        AXIS2_HASH_KEY_STRING, &dep_engine->prebuilt[i]);
+    }
+    AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI,
+        "Parsed %d descriptors using %d threads", count, threads);
+    axis2_dep_engine_log_stage(env, "parsing descriptors", &start);
+    return AXIS2_SUCCESS;
+}
+
+static void
+axis2_dep_engine_free_prebuilt_om(
+    axis2_dep_engine_t * dep_engine,
+    const axutil_env_t * env)
+{
+    int i = 0;
+
+    if (dep_engine->prebuilt_om)
+    {
+        axutil_hash_free(dep_engine->prebuilt_om, env);
+        dep_engine->prebuilt_om = NULL;
+    }
+    if (dep_engine->prebuilt)
+    {
+        /* Trees that were not taken belong to descriptors that failed to
+         * deploy */
+        for (i = 0; i < dep_engine->prebuilt_count; i++)
+        {
+            if (dep_engine->prebuilt[i].root)
+            {
+                axiom_node_free_tree(dep_engine->prebuilt[i].root, env);
+            }
+            AXIS2_FREE(env->allocator, dep_engine->prebuilt[i].file_name);
+        }
+        AXIS2_FREE(env->allocator, dep_engine->prebuilt);
+        dep_engine->prebuilt = NULL;
+    }
+    dep_engine->prebuilt_count = 0;
+}
 
+static void
+axis2_dep_engine_log_stage(
+    const axutil_env_t * env,
+    const axis2_char_t * stage,
+    struct AXIS2_PLATFORM_TIMEB *start)
+{
+    struct AXIS2_PLATFORM_TIMEB now;
+    int millisecs = 0;
+    double secs = 0;
+
+    AXIS2_PLATFORM_GET_TIME_IN_MILLIS(&now);
+    millisecs = now.millitm - start->millitm;
+    secs = difftime(now.time, start->time);
+    if (millisecs < 0)
+    {
+        millisecs += 1000;
+        secs--;
+    }
+    secs += millisecs / 1000.0;
+    AXIS2_LOG_INFO(env->log, "Deployment stage %s took %.3f seconds", stage, secs);
+    *start = now;
+}
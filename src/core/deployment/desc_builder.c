@@ -22,6 +22,7 @@
 #include <axutil_utils.h>
 #include <axutil_generic_obj.h>
 #include <axis2_raw_xml_in_out_msg_recv.h>
+#include <axis2_passthrough_msg_recv.h>
 #include <neethi_engine.h>
 
 struct axis2_desc_builder
@@ -153,10 +154,6 @@ axis2_desc_builder_build_om(
     axis2_desc_builder_t * desc_builder,
     const axutil_env_t * env)
 {
-    axiom_xml_reader_t *reader = NULL;
-    axiom_document_t *document = NULL;
-	axiom_stax_builder_t *builder = NULL;
-
     if (!desc_builder->file_name)
     {
         AXIS2_ERROR_SET(env->error, AXIS2_ERROR_INVALID_STATE_DESC_BUILDER,
@@ -166,8 +163,36 @@ axis2_desc_builder_build_om(
         return NULL;
     }
 
+    /** the deployment engine may have parsed the document already */
+    if (desc_builder->engine)
+    {
+        desc_builder->root = axis2_dep_engine_take_prebuilt_om(
+            desc_builder->engine, env, desc_builder->file_name);
+        if (desc_builder->root)
+        {
+            return desc_builder->root;
+        }
+    }
+
+    desc_builder->root = axis2_desc_builder_build_om_from_file(env,
+                                                   desc_builder->file_name);
+    return desc_builder->root;
+}
+
+AXIS2_EXTERN axiom_node_t *AXIS2_CALL
+axis2_desc_builder_build_om_from_file(
+    const axutil_env_t * env,
+    const axis2_char_t * file_name)
+{
+    axiom_xml_reader_t *reader = NULL;
+    axiom_document_t *document = NULL;
+	axiom_stax_builder_t *builder = NULL;
+    axiom_node_t *root = NULL;
+
+    AXIS2_PARAM_CHECK(env->error, file_name, NULL);
+
     /** create pull parser using the file path to configuration file */
-    reader = axiom_xml_reader_create_for_file(env, desc_builder->file_name, 
+    reader = axiom_xml_reader_create_for_file(env, (axis2_char_t *) file_name,
                                               NULL);
 
     if (!reader)
@@ -175,7 +200,7 @@ axis2_desc_builder_build_om(
         AXIS2_ERROR_SET(env->error, AXIS2_ERROR_CREATING_XML_STREAM_READER,
                         AXIS2_FAILURE);
         AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, 
-            "Could not create xml reader for %s", desc_builder->file_name);
+            "Could not create xml reader for %s", file_name);
 		return NULL;
     };
 
@@ -188,7 +213,7 @@ axis2_desc_builder_build_om(
                         AXIS2_FAILURE);
         AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, 
             "Could not create xml stream reader for desc builder %s. Unable "\
-                "to continue", desc_builder->file_name);
+                "to continue", file_name);
 		 return NULL;
     }
 
@@ -207,13 +232,13 @@ axis2_desc_builder_build_om(
     /**
         get root element , building starts hear 
      */
-    desc_builder->root = axiom_document_get_root_element(document, env);
+    root = axiom_document_get_root_element(document, env);
 	/**
 		We have built the whole document. So no need of keeping the builder.
 	*/
 	axiom_stax_builder_free_self(builder, env);
 
-    return desc_builder->root;
+    return root;
 }
 
 AXIS2_EXTERN axis2_flow_t *AXIS2_CALL
@@ -1018,6 +1043,11 @@ axis2_desc_builder_load_msg_recv(
     recv_name = axiom_element_get_attribute(recv_element, env, class_qname);
     axutil_qname_free(class_qname, env);
     class_name = axiom_attribute_get_value(recv_name, env);
+    if (!axutil_strcmp(class_name, AXIS2_PASSTHROUGH_MSG_RECV))
+    {
+        /* Built in, there is no library to load */
+        return axis2_passthrough_msg_recv_create(env);
+    }
 
     conf = axis2_dep_engine_get_axis_conf(desc_builder->engine, env);
     if (!conf)
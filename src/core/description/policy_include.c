@@ -19,6 +19,7 @@
 #include <axis2_policy_include.h>
 #include <neethi_policy.h>
 #include <neethi_engine.h>
+#include <axutil_thread.h>
 
 struct axis2_policy_include
 {
@@ -31,6 +32,32 @@ struct axis2_policy_include
     axis2_desc_t *desc;
 
     axutil_hash_t *wrapper_elements;
+
+    /* Bumped by every call that changes the policy elements, so cached
+       results can tell whether they are still current */
+    long stamp;
+
+    /* Stamp at which policy was merged; 0 when it has never been */
+    long policy_stamp;
+
+    /* Whether policy was created by the merge rather than being one of the
+       wrapped policies */
+    axis2_bool_t policy_owned;
+
+    /* Sum of the stamps of this include and its ancestors at the time the
+       effective policy was calculated, and the parent it was taken from */
+    long effective_stamp;
+
+    axis2_policy_include_t *effective_parent;
+
+    axis2_bool_t effective_owned;
+
+    /* Guards the cached results, which requests calculate lazily */
+    axutil_thread_mutex_t *mutex;
+
+    /* Results replaced by a later calculation. A caller may still use one
+       it was handed, so they are only freed with the include */
+    axutil_array_list_t *retired;
 };
 
 typedef struct axis2_policy_wrapper
@@ -39,6 +66,22 @@ typedef struct axis2_policy_wrapper
     void *value;
 } axis2_policy_wrapper_t;
 
+static long
+axis2_policy_include_get_chain_stamp(
+    axis2_policy_include_t * policy_include,
+    const axutil_env_t * env);
+
+static void
+axis2_policy_include_retire(
+    axis2_policy_include_t * policy_include,
+    const axutil_env_t * env,
+    neethi_policy_t * policy);
+
+static neethi_policy_t *
+axis2_policy_include_get_current_policy(
+    axis2_policy_include_t * policy_include,
+    const axutil_env_t * env);
+
 AXIS2_EXTERN axis2_policy_include_t *AXIS2_CALL
 axis2_policy_include_create(
     const axutil_env_t * env)
@@ -62,6 +105,23 @@ axis2_policy_include_create(
     policy_include->registry = NULL;
     policy_include->desc = NULL;
     policy_include->wrapper_elements = NULL;
+    policy_include->stamp = 1;
+    policy_include->policy_stamp = 0;
+    policy_include->policy_owned = AXIS2_FALSE;
+    policy_include->effective_stamp = 0;
+    policy_include->effective_parent = NULL;
+    policy_include->effective_owned = AXIS2_FALSE;
+    policy_include->mutex = NULL;
+    policy_include->retired = NULL;
+
+    policy_include->mutex = axutil_thread_mutex_create(env->allocator,
+                                                       AXIS2_THREAD_MUTEX_DEFAULT);
+    if (!policy_include->mutex)
+    {
+        axis2_policy_include_free(policy_include, env);
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
 
     policy_include->registry = neethi_registry_create(env);
     if (!policy_include->registry)
@@ -159,6 +219,33 @@ axis2_policy_include_free(
         axutil_hash_free(policy_include->wrapper_elements, env);
     }
 
+    if (policy_include->effective_owned && policy_include->effective_policy)
+    {
+        neethi_policy_free(policy_include->effective_policy, env);
+    }
+
+    if (policy_include->policy_owned && policy_include->policy)
+    {
+        neethi_policy_free(policy_include->policy, env);
+    }
+
+    if (policy_include->retired)
+    {
+        int i = 0;
+        for (i = 0; i < axutil_array_list_size(policy_include->retired, env);
+             i++)
+        {
+            neethi_policy_free((neethi_policy_t *) axutil_array_list_get(
+                policy_include->retired, env, i), env);
+        }
+        axutil_array_list_free(policy_include->retired, env);
+    }
+
+    if (policy_include->mutex)
+    {
+        axutil_thread_mutex_destroy(policy_include->mutex);
+    }
+
     if (policy_include)
     {
         AXIS2_FREE(env->allocator, policy_include);
@@ -175,12 +262,15 @@ axis2_policy_include_set_registry(
 {
     AXIS2_ENV_CHECK(env, AXIS2_FAILURE);
 
+    axutil_thread_mutex_lock(policy_include->mutex);
     if (policy_include->registry)
     {
         neethi_registry_free(policy_include->registry, env);
     }
 
     policy_include->registry = registry;
+    policy_include->stamp++;
+    axutil_thread_mutex_unlock(policy_include->mutex);
 
     return AXIS2_SUCCESS;
 }
@@ -201,6 +291,7 @@ axis2_policy_include_set_policy(
 {
     AXIS2_ENV_CHECK(env, AXIS2_FAILURE);
 
+    axutil_thread_mutex_lock(policy_include->mutex);
     if (policy_include->wrapper_elements)
     {
         axutil_hash_free(policy_include->wrapper_elements, env);
@@ -208,6 +299,7 @@ axis2_policy_include_set_policy(
     }
 
     policy_include->wrapper_elements = axutil_hash_make(env);
+    policy_include->stamp++;
 
     if (!neethi_policy_get_name(policy, env) &&
         !neethi_policy_get_id(policy, env))
@@ -243,6 +335,7 @@ axis2_policy_include_set_policy(
             }
         }
     }
+    axutil_thread_mutex_unlock(policy_include->mutex);
     return AXIS2_SUCCESS;
 }
 
@@ -264,15 +357,17 @@ axis2_policy_include_update_policy(
         return AXIS2_FAILURE;
     }
 
+    axutil_thread_mutex_lock(policy_include->mutex);
     wrapper = axutil_hash_get(policy_include->wrapper_elements, key,
                               AXIS2_HASH_KEY_STRING);
     if (wrapper)
     {
         wrapper->value = policy;
-        return AXIS2_SUCCESS;
+        policy_include->stamp++;
     }
+    axutil_thread_mutex_unlock(policy_include->mutex);
 
-    return AXIS2_FAILURE;
+    return wrapper ? AXIS2_SUCCESS : AXIS2_FAILURE;
 }
 
 AXIS2_EXTERN axis2_status_t AXIS2_CALL
@@ -281,7 +376,24 @@ axis2_policy_include_set_effective_policy(
     const axutil_env_t * env,
     neethi_policy_t * effective_policy)
 {
+    /* An explicitly set effective policy belongs to the caller and stays in
+       place until the policy elements of this include or of an ancestor
+       change */
+    axutil_thread_mutex_lock(policy_include->mutex);
+    if (policy_include->effective_owned && policy_include->effective_policy &&
+        policy_include->effective_policy != effective_policy)
+    {
+        axis2_policy_include_retire(policy_include, env,
+                                    policy_include->effective_policy);
+    }
+
     policy_include->effective_policy = effective_policy;
+    policy_include->effective_owned = AXIS2_FALSE;
+    policy_include->effective_parent =
+        axis2_policy_include_get_parent(policy_include, env);
+    policy_include->effective_stamp =
+        axis2_policy_include_get_chain_stamp(policy_include, env);
+    axutil_thread_mutex_unlock(policy_include->mutex);
     return AXIS2_SUCCESS;
 }
 
@@ -321,12 +433,32 @@ axis2_policy_include_get_parent(
     return NULL;
 }
 
+static long
+axis2_policy_include_get_chain_stamp(
+    axis2_policy_include_t * policy_include,
+    const axutil_env_t * env)
+{
+    long stamp = 0;
+
+    /* Stamps only grow, so the sum changes whenever any include on the way
+       to the root changes. The stamps of ancestors are read without their
+       mutex; a sum missing a change in progress is caught by the next call */
+    while (policy_include)
+    {
+        stamp += policy_include->stamp;
+        policy_include = axis2_policy_include_get_parent(policy_include, env);
+    }
+
+    return stamp;
+}
+
 static axis2_status_t
 axis2_policy_include_calculate_policy(
     axis2_policy_include_t * policy_include,
     const axutil_env_t * env)
 {
     neethi_policy_t *result = NULL;
+    axis2_bool_t result_owned = AXIS2_FALSE;
     axutil_hash_index_t *hi = NULL;
     void *val = NULL;
 
@@ -358,72 +490,152 @@ axis2_policy_include_calculate_policy(
                 policy = (neethi_policy_t *) wrapper->value;
             }
 
-            result = (result == NULL) ? (neethi_policy_t *) policy :
-                (neethi_policy_t *) neethi_engine_merge(env, result, policy);
+            if (!policy)
+            {
+                continue;
+            }
+
+            if (!result)
+            {
+                result = policy;
+            }
+            else
+            {
+                neethi_policy_t *merged = NULL;
+                neethi_policy_t *result_normalized = NULL;
+                neethi_policy_t *normalized = NULL;
+
+                /* Only normalized policies can be merged */
+                result_normalized = neethi_engine_get_normalize(env,
+                    AXIS2_FALSE, result);
+                normalized = neethi_engine_get_normalize(env, AXIS2_FALSE,
+                                                         policy);
+                if (result_normalized && normalized)
+                {
+                    merged = neethi_engine_merge(env, result_normalized,
+                                                 normalized);
+                }
+                if (result_normalized)
+                {
+                    neethi_policy_free(result_normalized, env);
+                }
+                if (normalized)
+                {
+                    neethi_policy_free(normalized, env);
+                }
+                if (merged)
+                {
+                    /* The merged policy holds its own references to the
+                       assertions, so the previous step can go */
+                    if (result_owned)
+                    {
+                        neethi_policy_free(result, env);
+                    }
+                    result = merged;
+                    result_owned = AXIS2_TRUE;
+                }
+            }
         }
     }
 
+    if (policy_include->policy_owned && policy_include->policy)
+    {
+        axis2_policy_include_retire(policy_include, env,
+                                    policy_include->policy);
+    }
+
     policy_include->policy = result;
+    policy_include->policy_owned = result_owned;
+    policy_include->policy_stamp = policy_include->stamp;
     return AXIS2_SUCCESS;
 }
 
 static neethi_policy_t *
 axis2_policy_include_calculate_effective_policy(
     axis2_policy_include_t * policy_include,
-    const axutil_env_t * env)
+    const axutil_env_t * env,
+    axis2_policy_include_t * parent,
+    axis2_bool_t * owned)
 {
-    neethi_policy_t *result;
-    axis2_policy_include_t *parent = NULL;
+    neethi_policy_t *result = NULL;
+    neethi_policy_t *own_policy = NULL;
+    neethi_policy_t *parent_policy = NULL;
 
-    parent = axis2_policy_include_get_parent(policy_include, env);
+    *owned = AXIS2_FALSE;
+
+    own_policy = axis2_policy_include_get_current_policy(policy_include, env);
 
     if (parent)
     {
-        neethi_policy_t *parent_policy =
-            axis2_policy_include_get_effective_policy(parent,
-                                                      env);
+        parent_policy = axis2_policy_include_get_effective_policy(parent, env);
+    }
 
-        if (!parent_policy)
+    if (!parent_policy)
+    {
+        result = own_policy;
+    }
+    else if (!own_policy)
+    {
+        result = parent_policy;
+    }
+    else
+    {
+        neethi_policy_t *parent_normalized = NULL;
+        neethi_policy_t *own_normalized = NULL;
+
+        parent_normalized = neethi_engine_get_normalize(env, AXIS2_FALSE,
+                                                        parent_policy);
+        own_normalized = neethi_engine_get_normalize(env, AXIS2_FALSE,
+                                                     own_policy);
+        if (parent_normalized && own_normalized)
         {
-            result = axis2_policy_include_get_policy(policy_include, env);
+            result = neethi_engine_merge(env, parent_normalized,
+                                         own_normalized);
+            *owned = result ? AXIS2_TRUE : AXIS2_FALSE;
+        }
 
+        if (parent_normalized)
+        {
+            neethi_policy_free(parent_normalized, env);
         }
-        else
+        if (own_normalized)
         {
-            if (axis2_policy_include_get_policy(policy_include, env))
-            {
-                neethi_policy_t *temp_policy = NULL;
-                parent_policy =
-                    (neethi_policy_t *) neethi_engine_get_normalize(env,
-                                                                    AXIS2_FALSE,
-                                                                    parent_policy);
-                temp_policy =
-                    axis2_policy_include_get_policy(policy_include, env);
-                temp_policy =
-                    (neethi_policy_t *) neethi_engine_get_normalize(env,
-                                                                    AXIS2_FALSE,
-                                                                    temp_policy);
-                /* result = (neethi_policy_t*) neethi_engine_merge(env, parent_policy,
-                   axis2_policy_include_get_policy(policy_include, env)); */
-                result =
-                    (neethi_policy_t *) neethi_engine_merge(env, parent_policy,
-                                                            temp_policy);
-
-            }
-            else
-            {
-                result = parent_policy;
-            }
+            neethi_policy_free(own_normalized, env);
         }
     }
-    else
+
+    return result;
+}
+
+static void
+axis2_policy_include_retire(
+    axis2_policy_include_t * policy_include,
+    const axutil_env_t * env,
+    neethi_policy_t * policy)
+{
+    if (!policy_include->retired)
     {
-        result = axis2_policy_include_get_policy(policy_include, env);
+        policy_include->retired = axutil_array_list_create(env, 4);
     }
+    /* Without the list the policy is leaked rather than freed under a
+       caller still using it */
+    if (policy_include->retired)
+    {
+        axutil_array_list_add(policy_include->retired, env, policy);
+    }
+}
 
-    return result;
-    /*policy_include->effective_policy = result;
-       return AXIS2_SUCCESS; */
+/* Called with the mutex held */
+static neethi_policy_t *
+axis2_policy_include_get_current_policy(
+    axis2_policy_include_t * policy_include,
+    const axutil_env_t * env)
+{
+    if (policy_include->policy_stamp != policy_include->stamp)
+    {
+        axis2_policy_include_calculate_policy(policy_include, env);
+    }
+    return policy_include->policy;
 }
 
 AXIS2_EXTERN neethi_policy_t *AXIS2_CALL
@@ -431,8 +643,12 @@ axis2_policy_include_get_policy(
     axis2_policy_include_t * policy_include,
     const axutil_env_t * env)
 {
-    axis2_policy_include_calculate_policy(policy_include, env);
-    return policy_include->policy;
+    neethi_policy_t *policy = NULL;
+
+    axutil_thread_mutex_lock(policy_include->mutex);
+    policy = axis2_policy_include_get_current_policy(policy_include, env);
+    axutil_thread_mutex_unlock(policy_include->mutex);
+    return policy;
 }
 
 AXIS2_EXTERN neethi_policy_t *AXIS2_CALL
@@ -440,11 +656,44 @@ axis2_policy_include_get_effective_policy(
     axis2_policy_include_t * policy_include,
     const axutil_env_t * env)
 {
-    /*if (policy_include->effective_policy)
-       return policy_include->effective_policy;
-     */
-    return axis2_policy_include_calculate_effective_policy(policy_include, env);
-    /*return policy_include->effective_policy; */
+    axis2_policy_include_t *parent = NULL;
+    neethi_policy_t *result = NULL;
+    axis2_bool_t owned = AXIS2_FALSE;
+    long stamp = 0;
+
+    /* The mutex of an ancestor is only taken with the one of its descendant
+       held, never the other way round */
+    axutil_thread_mutex_lock(policy_include->mutex);
+    parent = axis2_policy_include_get_parent(policy_include, env);
+    stamp = axis2_policy_include_get_chain_stamp(policy_include, env);
+
+    /* Once calculated, and as long as neither this include nor any ancestor
+       changed, this is a lookup */
+    if (policy_include->effective_stamp == stamp &&
+        policy_include->effective_parent == parent)
+    {
+        result = policy_include->effective_policy;
+        axutil_thread_mutex_unlock(policy_include->mutex);
+        return result;
+    }
+
+    result = axis2_policy_include_calculate_effective_policy(policy_include,
+                                                             env, parent,
+                                                             &owned);
+
+    if (policy_include->effective_owned && policy_include->effective_policy)
+    {
+        axis2_policy_include_retire(policy_include, env,
+                                    policy_include->effective_policy);
+    }
+
+    policy_include->effective_policy = result;
+    policy_include->effective_owned = owned;
+    policy_include->effective_parent = parent;
+    policy_include->effective_stamp = stamp;
+    axutil_thread_mutex_unlock(policy_include->mutex);
+
+    return result;
 }
 
 AXIS2_EXTERN axutil_array_list_t *AXIS2_CALL
@@ -570,13 +819,16 @@ axis2_policy_include_add_policy_element(
 
             if (policy_name)
             {
+                axutil_thread_mutex_lock(policy_include->mutex);
                 axutil_hash_set(policy_include->wrapper_elements, policy_name,
                                 AXIS2_HASH_KEY_STRING, wrapper);
+                policy_include->stamp++;
                 if (policy_include->registry)
                 {
                     neethi_registry_register(policy_include->registry,
                                              env, policy_name, policy);
                 }
+                axutil_thread_mutex_unlock(policy_include->mutex);
                 return AXIS2_SUCCESS;
             }
         }
@@ -600,9 +852,12 @@ axis2_policy_include_add_policy_reference_element(
     {
         wrapper->type = type;
         wrapper->value = reference;
+        axutil_thread_mutex_lock(policy_include->mutex);
         axutil_hash_set(policy_include->wrapper_elements,
                         neethi_reference_get_uri(reference, env),
                         AXIS2_HASH_KEY_STRING, wrapper);
+        policy_include->stamp++;
+        axutil_thread_mutex_unlock(policy_include->mutex);
     }
     return AXIS2_SUCCESS;
 }
@@ -613,16 +868,27 @@ axis2_policy_include_remove_policy_element(
     const axutil_env_t * env,
     axis2_char_t * policy_uri)
 {
+    axutil_thread_mutex_lock(policy_include->mutex);
     if (policy_include->wrapper_elements)
     {
-        axutil_hash_set(policy_include->wrapper_elements,
-                        policy_uri, AXIS2_HASH_KEY_STRING, NULL);
+        axis2_policy_wrapper_t *wrapper = NULL;
+
+        wrapper = axutil_hash_get(policy_include->wrapper_elements,
+                                  policy_uri, AXIS2_HASH_KEY_STRING);
+        if (wrapper)
+        {
+            axutil_hash_set(policy_include->wrapper_elements,
+                            policy_uri, AXIS2_HASH_KEY_STRING, NULL);
+            AXIS2_FREE(env->allocator, wrapper);
+            policy_include->stamp++;
+        }
     }
     if (policy_include->registry)
     {
         neethi_registry_register(policy_include->registry,
                                  env, policy_uri, NULL);
     }
+    axutil_thread_mutex_unlock(policy_include->mutex);
     return AXIS2_SUCCESS;
 }
 
@@ -631,9 +897,25 @@ axis2_policy_include_remove_all_policy_element(
     axis2_policy_include_t * policy_include,
     const axutil_env_t * env)
 {
+    axutil_thread_mutex_lock(policy_include->mutex);
     if (policy_include->wrapper_elements)
     {
+        axutil_hash_index_t *hi = NULL;
+        void *val = NULL;
+
+        for (hi = axutil_hash_first(policy_include->wrapper_elements, env); hi;
+             hi = axutil_hash_next(env, hi))
+        {
+            axutil_hash_this(hi, NULL, NULL, &val);
+            if (val)
+            {
+                AXIS2_FREE(env->allocator, val);
+            }
+        }
         axutil_hash_free(policy_include->wrapper_elements, env);
+        policy_include->wrapper_elements = axutil_hash_make(env);
     }
+    policy_include->stamp++;
+    axutil_thread_mutex_unlock(policy_include->mutex);
     return AXIS2_SUCCESS;
 }
@@ -24,6 +24,8 @@
 #include <axis2_svc_skeleton.h>
 #include <axutil_thread.h>
 #include <axis2_core_utils.h>
+#include <axis2_msg.h>
+#include <axis2_policy_include.h>
 
 struct axis2_svc
 {
@@ -80,6 +82,11 @@ struct axis2_svc
      */
     axutil_hash_t *op_rest_map;
 
+    /**
+     * REST mappings compiled for dispatching, created with the first one
+     */
+    axis2_core_utils_rest_trie_t *op_rest_trie;
+
     /**
      * Keeps track whether the schema locations are adjusted
      */
@@ -150,6 +157,7 @@ axis2_svc_create(
     svc->op_alias_map = NULL;
     svc->op_action_map = NULL;
     svc->op_rest_map = NULL;
+    svc->op_rest_trie = NULL;
     svc->module_list = NULL;
     svc->ns_map = NULL;
     svc->ns_count = 0;
@@ -437,6 +445,11 @@ axis2_svc_free(
         axis2_core_utils_free_rest_map(env, svc->op_rest_map);
     }
 
+    if (svc->op_rest_trie)
+    {
+        axis2_core_utils_rest_trie_free(svc->op_rest_trie, env);
+    }
+
     if (svc->schema_target_ns_prefix)
     {
         AXIS2_FREE(env->allocator, svc->schema_target_ns_prefix);
@@ -1324,6 +1337,23 @@ axis2_svc_add_rest_mapping(
         AXIS2_FREE(env->allocator, mapping_url);    
     }
 
+    if(status == AXIS2_SUCCESS)
+    {
+        if(!svc->op_rest_trie)
+        {
+            svc->op_rest_trie = axis2_core_utils_rest_trie_create(env);
+        }
+        if(svc->op_rest_trie)
+        {
+            status = axis2_core_utils_rest_trie_add(svc->op_rest_trie, env,
+                method, local_location_str, op_desc);
+        }
+        else
+        {
+            status = AXIS2_FAILURE;
+        }
+    }
+
     /* restore the question character */
     if(question_char) {
         *question_char = '?';
@@ -1568,3 +1598,91 @@ axis2_svc_get_rest_map(
     return svc->op_rest_map;
 }
 
+AXIS2_EXTERN axis2_core_utils_rest_trie_t *AXIS2_CALL
+axis2_svc_get_rest_trie(
+    const axis2_svc_t * svc,
+    const axutil_env_t * env)
+{
+    return svc->op_rest_trie;
+}
+
+/*
+ * Fills the effective policy cache of policy_include. Fails when it has a
+ * policy of its own but no effective policy could be merged from it.
+ */
+static axis2_status_t
+axis2_svc_calculate_effective_policy(
+    axis2_policy_include_t * policy_include,
+    const axutil_env_t * env)
+{
+    if (!policy_include)
+    {
+        return AXIS2_SUCCESS;
+    }
+    if (!axis2_policy_include_get_effective_policy(policy_include, env) &&
+        axis2_policy_include_get_policy(policy_include, env))
+    {
+        return AXIS2_FAILURE;
+    }
+    return AXIS2_SUCCESS;
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_svc_calculate_effective_policies(
+    axis2_svc_t * svc,
+    const axutil_env_t * env)
+{
+    axutil_hash_index_t *hi = NULL;
+    const axis2_char_t *labels[] = { AXIS2_MSG_IN, AXIS2_MSG_OUT,
+        AXIS2_MSG_IN_FAULT, AXIS2_MSG_OUT_FAULT };
+    int label_count = (int) (sizeof(labels) / sizeof(labels[0]));
+    int i = 0;
+    axis2_status_t status = AXIS2_SUCCESS;
+
+    AXIS2_PARAM_CHECK(env->error, svc, AXIS2_FAILURE);
+
+    /* Every include is filled even if an earlier one failed */
+    if (axis2_svc_calculate_effective_policy(
+            axis2_desc_get_policy_include(svc->base, env), env) != AXIS2_SUCCESS)
+    {
+        status = AXIS2_FAILURE;
+    }
+
+    for (hi = axutil_hash_first(svc->op_alias_map, env); hi;
+         hi = axutil_hash_next(env, hi))
+    {
+        void *v = NULL;
+        axis2_op_t *op = NULL;
+
+        axutil_hash_this(hi, NULL, NULL, &v);
+        op = (axis2_op_t *) v;
+        if (!op)
+        {
+            continue;
+        }
+
+        if (axis2_svc_calculate_effective_policy(
+                axis2_desc_get_policy_include(axis2_op_get_base(op, env), env),
+                env) != AXIS2_SUCCESS)
+        {
+            status = AXIS2_FAILURE;
+        }
+
+        for (i = 0; i < label_count; i++)
+        {
+            axis2_msg_t *msg = axis2_op_get_msg(op, env, labels[i]);
+            if (!msg)
+            {
+                continue;
+            }
+            if (axis2_svc_calculate_effective_policy(
+                    axis2_desc_get_policy_include(axis2_msg_get_base(msg, env),
+                                                  env), env) != AXIS2_SUCCESS)
+            {
+                status = AXIS2_FAILURE;
+            }
+        }
+    }
+
+    return status;
+}
@@ -792,6 +792,22 @@ axis2_conf_remove_svc(
     return AXIS2_SUCCESS;
 }
 
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_conf_remove_svc_grp(
+    axis2_conf_t * conf,
+    const axutil_env_t * env,
+    const axis2_char_t * svc_grp_name)
+{
+    AXIS2_PARAM_CHECK(env->error, svc_grp_name, AXIS2_FAILURE);
+
+    if (conf->svc_grps)
+    {
+        axutil_hash_set(conf->svc_grps, svc_grp_name, AXIS2_HASH_KEY_STRING,
+                        NULL);
+    }
+    return AXIS2_SUCCESS;
+}
+
 AXIS2_EXTERN axis2_status_t AXIS2_CALL
 axis2_conf_add_param(
     axis2_conf_t * conf,
@@ -0,0 +1,240 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <axis2_passthrough_msg_recv.h>
+#include <axiom_soap_envelope.h>
+#include <axiom_soap_header.h>
+#include <axiom_soap_body.h>
+#include <axiom_soap_fault.h>
+#include <axiom_soap.h>
+
+static axis2_status_t AXIS2_CALL
+axis2_passthrough_msg_recv_invoke_business_logic_sync(
+    axis2_msg_recv_t * msg_recv,
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx,
+    axis2_msg_ctx_t * new_msg_ctx);
+
+AXIS2_EXTERN axis2_msg_recv_t *AXIS2_CALL
+axis2_passthrough_msg_recv_create(
+    const axutil_env_t * env)
+{
+    axis2_msg_recv_t *msg_recv = NULL;
+    axis2_status_t status = AXIS2_FAILURE;
+
+    msg_recv = axis2_msg_recv_create(env);
+    if (!msg_recv)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+    status = axis2_msg_recv_set_scope(msg_recv, env, AXIS2_APPLICATION_SCOPE);
+    if (!status)
+    {
+        axis2_msg_recv_free(msg_recv, env);
+        return NULL;
+    }
+
+    axis2_msg_recv_set_invoke_business_logic(msg_recv, env,
+        axis2_passthrough_msg_recv_invoke_business_logic_sync);
+
+    return msg_recv;
+}
+
+static axis2_status_t AXIS2_CALL
+axis2_passthrough_msg_recv_invoke_business_logic_sync(
+    axis2_msg_recv_t * msg_recv,
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx,
+    axis2_msg_ctx_t * new_msg_ctx)
+{
+    axis2_svc_skeleton_t *svc_obj = NULL;
+    axis2_op_t *op_desc = NULL;
+    axiom_soap_envelope_t *envelope = NULL;
+    axiom_soap_body_t *body = NULL;
+    axiom_node_t *om_node = NULL;
+    axiom_node_t *result_node = NULL;
+    axiom_node_t *fault_node = NULL;
+    axiom_soap_envelope_t *default_envelope = NULL;
+    axiom_soap_body_t *out_body = NULL;
+    axiom_soap_fault_t *soap_fault = NULL;
+    axiom_namespace_t *env_ns = NULL;
+    const axis2_char_t *soap_ns = AXIOM_SOAP12_SOAP_ENVELOPE_NAMESPACE_URI;
+    int soap_version = AXIOM_SOAP12;
+    axis2_status_t status = AXIS2_SUCCESS;
+    axis2_bool_t skel_invoked = AXIS2_FALSE;
+    axis2_bool_t is_fault = AXIS2_FALSE;
+
+    AXIS2_PARAM_CHECK(env->error, msg_ctx, AXIS2_FAILURE);
+    AXIS2_PARAM_CHECK(env->error, new_msg_ctx, AXIS2_FAILURE);
+
+    AXIS2_LOG_TRACE(env->log, AXIS2_LOG_SI,
+        "[axis2]Entry:axis2_passthrough_msg_recv_invoke_business_logic_sync");
+
+    svc_obj = axis2_msg_recv_get_impl_obj(msg_recv, env, msg_ctx);
+    if (!svc_obj)
+    {
+        axis2_svc_t *svc = axis2_msg_ctx_get_svc(msg_ctx, env);
+
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+            "Impl object for service '%s' not set in message receiver. %d :: %s",
+            svc ? axis2_svc_get_name(svc, env) : "unknown",
+            env->error->error_number, AXIS2_ERROR_GET_MESSAGE(env->error));
+        status = AXIS2_FAILURE;
+    }
+    else
+    {
+        envelope = axis2_msg_ctx_get_soap_envelope(msg_ctx, env);
+        body = axiom_soap_envelope_get_body(envelope, env);
+
+        /* The service gets the body content as text, read without building
+           it; a fault in the request is handed over as it is */
+        om_node = body ? axiom_soap_body_capture_content(body, env) : NULL;
+        if (!om_node && body)
+        {
+            om_node = axiom_node_get_first_element(
+                axiom_soap_body_get_base_node(body, env), env);
+        }
+
+        skel_invoked = AXIS2_TRUE;
+        result_node = AXIS2_SVC_SKELETON_INVOKE(svc_obj, env, om_node,
+                                                new_msg_ctx);
+        if (!result_node)
+        {
+            const axis2_char_t *mep = NULL;
+
+            op_desc = axis2_op_ctx_get_op(axis2_msg_ctx_get_op_ctx(msg_ctx, env),
+                                          env);
+            mep = axis2_op_get_msg_exchange_pattern(op_desc, env);
+            status = AXIS2_ERROR_GET_STATUS_CODE(env->error);
+            if (status == AXIS2_SUCCESS)
+            {
+                axis2_msg_ctx_set_no_content(new_msg_ctx, env, AXIS2_TRUE);
+            }
+            else
+            {
+                /* The worker takes the status code from the request context
+                   when processing fails */
+                axis2_msg_ctx_set_status_code(msg_ctx, env,
+                    axis2_msg_ctx_get_status_code(new_msg_ctx, env));
+            }
+            if ((status != AXIS2_SUCCESS &&
+                 !axutil_strcmp(mep, AXIS2_MEP_URI_ROBUST_IN_ONLY)) ||
+                (axutil_strcmp(mep, AXIS2_MEP_URI_IN_ONLY) &&
+                 axutil_strcmp(mep, AXIS2_MEP_URI_ROBUST_IN_ONLY)))
+            {
+                if (svc_obj->ops->on_fault)
+                {
+                    fault_node = AXIS2_SVC_SKELETON_ON_FAULT(svc_obj, env,
+                                                             om_node);
+                }
+                is_fault = AXIS2_TRUE;
+            }
+        }
+    }
+
+    if (axis2_msg_ctx_get_soap_envelope(new_msg_ctx, env))
+    {
+        /* The service has set the envelope itself */
+        return AXIS2_SUCCESS;
+    }
+
+    if (axis2_msg_ctx_get_is_soap_11(msg_ctx, env))
+    {
+        soap_ns = AXIOM_SOAP11_SOAP_ENVELOPE_NAMESPACE_URI;
+        soap_version = AXIOM_SOAP11;
+    }
+
+    env_ns = axiom_namespace_create(env, soap_ns, "soapenv");
+    if (!env_ns)
+    {
+        return AXIS2_FAILURE;
+    }
+    default_envelope = axiom_soap_envelope_create(env, env_ns);
+    if (!default_envelope)
+    {
+        return AXIS2_FAILURE;
+    }
+    if (!axiom_soap_header_create_with_parent(env, default_envelope))
+    {
+        axiom_soap_envelope_free(default_envelope, env);
+        return AXIS2_FAILURE;
+    }
+    out_body = axiom_soap_body_create_with_parent(env, default_envelope);
+    if (!out_body)
+    {
+        axiom_soap_envelope_free(default_envelope, env);
+        return AXIS2_FAILURE;
+    }
+
+    if (status != AXIS2_SUCCESS || is_fault)
+    {
+        const axis2_char_t *fault_value_str = "soapenv:Sender";
+        const axis2_char_t *fault_reason_str = NULL;
+
+        if (!skel_invoked)
+        {
+            fault_value_str = soap_version == AXIOM_SOAP11 ?
+                AXIOM_SOAP_DEFAULT_NAMESPACE_PREFIX ":"
+                AXIOM_SOAP11_FAULT_CODE_RECEIVER :
+                AXIOM_SOAP_DEFAULT_NAMESPACE_PREFIX ":"
+                AXIOM_SOAP12_SOAP_FAULT_VALUE_RECEIVER;
+        }
+        fault_reason_str = AXIS2_ERROR_GET_MESSAGE(env->error);
+        if (!fault_reason_str)
+        {
+            fault_reason_str =
+                "An error has occured, but could not determine exact details";
+        }
+        soap_fault = axiom_soap_fault_create_default_fault(env, out_body,
+                                                           fault_value_str,
+                                                           fault_reason_str,
+                                                           soap_version);
+        if (soap_fault && fault_node)
+        {
+            axiom_soap_fault_detail_t *fault_detail =
+                axiom_soap_fault_detail_create_with_parent(env, soap_fault);
+
+            axiom_soap_fault_detail_add_detail_entry(fault_detail, env,
+                                                     fault_node);
+        }
+    }
+
+    if (result_node)
+    {
+        /* A result taken from a response kept as text is written as it is */
+        axiom_node_add_child(axiom_soap_body_get_base_node(out_body, env), env,
+                             result_node);
+        status = axis2_msg_ctx_set_soap_envelope(new_msg_ctx, env,
+                                                 default_envelope);
+    }
+    else if (soap_fault)
+    {
+        axis2_msg_ctx_set_soap_envelope(new_msg_ctx, env, default_envelope);
+        status = AXIS2_SUCCESS;
+    }
+    else
+    {
+        /* one way case, the envelope is not used */
+        axiom_soap_envelope_free(default_envelope, env);
+    }
+
+    AXIS2_LOG_TRACE(env->log, AXIS2_LOG_SI,
+        "[axis2]Exit:axis2_passthrough_msg_recv_invoke_business_logic_sync");
+
+    return status;
+}
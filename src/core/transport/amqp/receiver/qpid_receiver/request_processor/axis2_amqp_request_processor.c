@@ -205,6 +205,7 @@ axis2_amqp_process_request(
                 	callback_ctx->content_length = request_resource_pack->content_length;
                 	callback_ctx->unread_len = request_resource_pack->content_length;
                 	callback_ctx->chunked_stream = NULL;
+                	callback_ctx->tee = NULL;
             	}
 
                 binary_data_map = 
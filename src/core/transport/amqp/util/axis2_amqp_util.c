@@ -215,6 +215,7 @@ axis2_amqp_util_get_soap_envelope(
                 	callback_ctx->content_length = response->length;
                 	callback_ctx->unread_len = response->length;
                 	callback_ctx->chunked_stream = NULL;
+                	callback_ctx->tee = NULL;
             	}
 
                 binary_data_map = 
@@ -286,13 +287,19 @@ axis2_amqp_util_get_soap_envelope(
 	
 	if (soap_envelope)
 	{
-		/* hack to get around MTOM problem */
+		/* The buffer read from goes away before the envelope, so the
+		   body is built now */
 		axiom_soap_body_t *soap_body = 
 			axiom_soap_envelope_get_body(soap_envelope, env);
+		axiom_node_t *body_node = soap_body ?
+			axiom_soap_body_get_base_node(soap_body, env) : NULL;
 		
-		if (soap_body)
+		while (body_node && !axiom_node_is_complete(body_node, env))
 		{
-			axiom_soap_body_has_fault(soap_body, env);
+			if (axiom_soap_builder_next(soap_builder, env) == AXIS2_FAILURE)
+			{
+				break;
+			}
 		}
 	}
 	
@@ -0,0 +1,376 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <axis2_http2.h>
+#include <axutil_string.h>
+#include <platforms/axutil_platform_auto_sense.h>
+#include <string.h>
+
+#define AXIS2_HTTP2_FRAME_BUF_SIZE 16384
+
+struct axis2_http2_frame_buf
+{
+    unsigned char *data;
+    int len;
+    int size;
+};
+
+struct axis2_http2_frame_reader
+{
+    unsigned char *data;
+    /* start and end of what was read and not taken yet */
+    int pos;
+    int len;
+    int size;
+    int max_frame_size;
+};
+
+AXIS2_EXTERN axis2_http2_frame_buf_t *AXIS2_CALL
+axis2_http2_frame_buf_create(
+    const axutil_env_t * env)
+{
+    axis2_http2_frame_buf_t *frame_buf = NULL;
+
+    frame_buf = AXIS2_MALLOC(env->allocator, sizeof(axis2_http2_frame_buf_t));
+    if (!frame_buf)
+    {
+        AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+    frame_buf->len = 0;
+    frame_buf->size = AXIS2_HTTP2_FRAME_BUF_SIZE;
+    frame_buf->data = AXIS2_MALLOC(env->allocator, frame_buf->size);
+    if (!frame_buf->data)
+    {
+        AXIS2_FREE(env->allocator, frame_buf);
+        AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+    return frame_buf;
+}
+
+static axis2_status_t
+axis2_http2_frame_buf_reserve(
+    axis2_http2_frame_buf_t * frame_buf,
+    const axutil_env_t * env,
+    int length)
+{
+    unsigned char *data = NULL;
+    int size = frame_buf->size;
+
+    if (frame_buf->len + length <= size)
+    {
+        return AXIS2_SUCCESS;
+    }
+    while (frame_buf->len + length > size)
+    {
+        size *= 2;
+    }
+    data = AXIS2_MALLOC(env->allocator, size);
+    if (!data)
+    {
+        AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+    memcpy(data, frame_buf->data, frame_buf->len);
+    AXIS2_FREE(env->allocator, frame_buf->data);
+    frame_buf->data = data;
+    frame_buf->size = size;
+    return AXIS2_SUCCESS;
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_http2_frame_buf_add(
+    axis2_http2_frame_buf_t * frame_buf,
+    const axutil_env_t * env,
+    int type,
+    int flags,
+    int stream_id,
+    const void *payload,
+    int length)
+{
+    unsigned char *header = NULL;
+
+    if (AXIS2_SUCCESS != axis2_http2_frame_buf_reserve(frame_buf, env,
+            AXIS2_HTTP2_FRAME_HEADER_LEN + length))
+    {
+        return AXIS2_FAILURE;
+    }
+    header = frame_buf->data + frame_buf->len;
+    header[0] = (unsigned char) (length >> 16);
+    header[1] = (unsigned char) (length >> 8);
+    header[2] = (unsigned char) length;
+    header[3] = (unsigned char) type;
+    header[4] = (unsigned char) flags;
+    header[5] = (unsigned char) ((stream_id >> 24) & 0x7f);
+    header[6] = (unsigned char) (stream_id >> 16);
+    header[7] = (unsigned char) (stream_id >> 8);
+    header[8] = (unsigned char) stream_id;
+    if (length > 0)
+    {
+        memcpy(header + AXIS2_HTTP2_FRAME_HEADER_LEN, payload, length);
+    }
+    frame_buf->len += AXIS2_HTTP2_FRAME_HEADER_LEN + length;
+    return AXIS2_SUCCESS;
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_http2_frame_buf_add_raw(
+    axis2_http2_frame_buf_t * frame_buf,
+    const axutil_env_t * env,
+    const void *data,
+    int length)
+{
+    if (AXIS2_SUCCESS != axis2_http2_frame_buf_reserve(frame_buf, env, length))
+    {
+        return AXIS2_FAILURE;
+    }
+    memcpy(frame_buf->data + frame_buf->len, data, length);
+    frame_buf->len += length;
+    return AXIS2_SUCCESS;
+}
+
+AXIS2_EXTERN int AXIS2_CALL
+axis2_http2_frame_buf_get_len(
+    const axis2_http2_frame_buf_t * frame_buf,
+    const axutil_env_t * env)
+{
+    return frame_buf->len;
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_http2_frame_buf_flush(
+    axis2_http2_frame_buf_t * frame_buf,
+    const axutil_env_t * env,
+    int socket)
+{
+    int done = 0;
+
+    while (done < frame_buf->len)
+    {
+        int written = 0;
+
+#ifdef MSG_NOSIGNAL
+        /* A peer that went away must fail the write, not kill the process */
+        written = (int) send(socket, (const char *) frame_buf->data + done,
+                             frame_buf->len - done, MSG_NOSIGNAL);
+#else
+        written = (int) send(socket, (const char *) frame_buf->data + done,
+                             frame_buf->len - done, 0);
+#endif
+        if (written <= 0)
+        {
+            AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI,
+                            "Writing HTTP/2 frames failed, socket %d", socket);
+            frame_buf->len = 0;
+            return AXIS2_FAILURE;
+        }
+        done += written;
+    }
+    frame_buf->len = 0;
+    /* do not keep a large buffer after a large body went out */
+    if (frame_buf->size > 4 * AXIS2_HTTP2_FRAME_BUF_SIZE)
+    {
+        unsigned char *data = AXIS2_MALLOC(env->allocator,
+                                           AXIS2_HTTP2_FRAME_BUF_SIZE);
+        if (data)
+        {
+            AXIS2_FREE(env->allocator, frame_buf->data);
+            frame_buf->data = data;
+            frame_buf->size = AXIS2_HTTP2_FRAME_BUF_SIZE;
+        }
+    }
+    return AXIS2_SUCCESS;
+}
+
+AXIS2_EXTERN void AXIS2_CALL
+axis2_http2_frame_buf_free(
+    axis2_http2_frame_buf_t * frame_buf,
+    const axutil_env_t * env)
+{
+    if (!frame_buf)
+    {
+        return;
+    }
+    AXIS2_FREE(env->allocator, frame_buf->data);
+    AXIS2_FREE(env->allocator, frame_buf);
+}
+
+AXIS2_EXTERN axis2_http2_frame_reader_t *AXIS2_CALL
+axis2_http2_frame_reader_create(
+    const axutil_env_t * env,
+    int max_frame_size)
+{
+    axis2_http2_frame_reader_t *reader = NULL;
+
+    reader = AXIS2_MALLOC(env->allocator, sizeof(axis2_http2_frame_reader_t));
+    if (!reader)
+    {
+        AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+    reader->pos = 0;
+    reader->len = 0;
+    reader->max_frame_size = max_frame_size;
+    /* room for a whole frame and what follows it in the same read */
+    reader->size = 2 * (AXIS2_HTTP2_FRAME_HEADER_LEN + max_frame_size);
+    reader->data = AXIS2_MALLOC(env->allocator, reader->size);
+    if (!reader->data)
+    {
+        AXIS2_FREE(env->allocator, reader);
+        AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+    return reader;
+}
+
+/* Moves what was not taken yet to the start of the buffer */
+static void
+axis2_http2_frame_reader_compact(
+    axis2_http2_frame_reader_t * reader)
+{
+    if (reader->pos > 0)
+    {
+        memmove(reader->data, reader->data + reader->pos,
+                reader->len - reader->pos);
+        reader->len -= reader->pos;
+        reader->pos = 0;
+    }
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_http2_frame_reader_put(
+    axis2_http2_frame_reader_t * reader,
+    const axutil_env_t * env,
+    const void *data,
+    int length)
+{
+    axis2_http2_frame_reader_compact(reader);
+    if (reader->len + length > reader->size)
+    {
+        return AXIS2_FAILURE;
+    }
+    memcpy(reader->data + reader->len, data, length);
+    reader->len += length;
+    return AXIS2_SUCCESS;
+}
+
+AXIS2_EXTERN int AXIS2_CALL
+axis2_http2_frame_reader_fill(
+    axis2_http2_frame_reader_t * reader,
+    const axutil_env_t * env,
+    int socket)
+{
+    int read = 0;
+
+    axis2_http2_frame_reader_compact(reader);
+    if (reader->len >= reader->size)
+    {
+        return -1;
+    }
+    do
+    {
+        read = (int) recv(socket, (char *) reader->data + reader->len,
+                          reader->size - reader->len, 0);
+    }
+    while (read < 0 && EINTR == errno);
+    if (read > 0)
+    {
+        reader->len += read;
+    }
+    return read;
+}
+
+AXIS2_EXTERN int AXIS2_CALL
+axis2_http2_frame_reader_expect(
+    axis2_http2_frame_reader_t * reader,
+    const axutil_env_t * env,
+    const void *expected,
+    int length)
+{
+    int available = reader->len - reader->pos;
+
+    if (memcmp(reader->data + reader->pos, expected,
+               available < length ? available : length))
+    {
+        return -1;
+    }
+    if (available < length)
+    {
+        return 0;
+    }
+    reader->pos += length;
+    return 1;
+}
+
+AXIS2_EXTERN int AXIS2_CALL
+axis2_http2_frame_reader_next(
+    axis2_http2_frame_reader_t * reader,
+    const axutil_env_t * env,
+    axis2_http2_frame_t * frame)
+{
+    const unsigned char *header = reader->data + reader->pos;
+    int length = 0;
+
+    if (reader->len - reader->pos < AXIS2_HTTP2_FRAME_HEADER_LEN)
+    {
+        return 0;
+    }
+    length = (header[0] << 16) | (header[1] << 8) | header[2];
+    if (length > reader->max_frame_size)
+    {
+        return -1;
+    }
+    if (reader->len - reader->pos < AXIS2_HTTP2_FRAME_HEADER_LEN + length)
+    {
+        return 0;
+    }
+    frame->length = length;
+    frame->type = header[3];
+    frame->flags = header[4];
+    frame->stream_id = ((header[5] & 0x7f) << 24) | (header[6] << 16) |
+        (header[7] << 8) | header[8];
+    frame->payload = header + AXIS2_HTTP2_FRAME_HEADER_LEN;
+    reader->pos += AXIS2_HTTP2_FRAME_HEADER_LEN + length;
+    return 1;
+}
+
+AXIS2_EXTERN void AXIS2_CALL
+axis2_http2_frame_reader_free(
+    axis2_http2_frame_reader_t * reader,
+    const axutil_env_t * env)
+{
+    if (!reader)
+    {
+        return;
+    }
+    AXIS2_FREE(env->allocator, reader->data);
+    AXIS2_FREE(env->allocator, reader);
+}
+
+AXIS2_EXTERN axis2_bool_t AXIS2_CALL
+axis2_http2_is_connection_header(
+    const axis2_char_t * name)
+{
+    return !axutil_strcasecmp(name, "Connection") ||
+        !axutil_strcasecmp(name, "Keep-Alive") ||
+        !axutil_strcasecmp(name, "Proxy-Connection") ||
+        !axutil_strcasecmp(name, "Transfer-Encoding") ||
+        !axutil_strcasecmp(name, "TE") ||
+        !axutil_strcasecmp(name, AXIS2_HTTP2_HEADER_UPGRADE) ||
+        !axutil_strcasecmp(name, AXIS2_HTTP2_HEADER_SETTINGS);
+}
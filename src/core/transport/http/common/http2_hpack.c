@@ -0,0 +1,601 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <axis2_http2.h>
+#include <axis2_http_header.h>
+#include <axutil_string.h>
+#include <string.h>
+
+/* size of an entry of the dynamic table besides its name and value */
+#define AXIS2_HTTP2_HPACK_ENTRY_OVERHEAD 32
+
+#define AXIS2_HTTP2_HPACK_STATIC_COUNT 61
+
+#define AXIS2_HTTP2_HUFFMAN_EOS 256
+#define AXIS2_HTTP2_HUFFMAN_MAX_BITS 30
+
+typedef struct axis2_http2_hpack_entry
+{
+    axis2_char_t *name;
+    axis2_char_t *value;
+    int size;
+} axis2_http2_hpack_entry_t;
+
+struct axis2_http2_hpack
+{
+    /* dynamic table, newest entry first */
+    axutil_array_list_t *table;
+    int table_size;
+    /* limit set by the last size update of the peer */
+    int max_table_size;
+    /* limit the peer may not go past, from our settings */
+    int settings_table_size;
+};
+
+static const char *axis2_http2_hpack_static[AXIS2_HTTP2_HPACK_STATIC_COUNT][2] = {
+    {":authority", ""},
+    {":method", "GET"},
+    {":method", "POST"},
+    {":path", "/"},
+    {":path", "/index.html"},
+    {":scheme", "http"},
+    {":scheme", "https"},
+    {":status", "200"},
+    {":status", "204"},
+    {":status", "206"},
+    {":status", "304"},
+    {":status", "400"},
+    {":status", "404"},
+    {":status", "500"},
+    {"accept-charset", ""},
+    {"accept-encoding", "gzip, deflate"},
+    {"accept-language", ""},
+    {"accept-ranges", ""},
+    {"accept", ""},
+    {"access-control-allow-origin", ""},
+    {"age", ""},
+    {"allow", ""},
+    {"authorization", ""},
+    {"cache-control", ""},
+    {"content-disposition", ""},
+    {"content-encoding", ""},
+    {"content-language", ""},
+    {"content-length", ""},
+    {"content-location", ""},
+    {"content-range", ""},
+    {"content-type", ""},
+    {"cookie", ""},
+    {"date", ""},
+    {"etag", ""},
+    {"expect", ""},
+    {"expires", ""},
+    {"from", ""},
+    {"host", ""},
+    {"if-match", ""},
+    {"if-modified-since", ""},
+    {"if-none-match", ""},
+    {"if-range", ""},
+    {"if-unmodified-since", ""},
+    {"last-modified", ""},
+    {"link", ""},
+    {"location", ""},
+    {"max-forwards", ""},
+    {"proxy-authenticate", ""},
+    {"proxy-authorization", ""},
+    {"range", ""},
+    {"referer", ""},
+    {"refresh", ""},
+    {"retry-after", ""},
+    {"server", ""},
+    {"set-cookie", ""},
+    {"strict-transport-security", ""},
+    {"transfer-encoding", ""},
+    {"user-agent", ""},
+    {"vary", ""},
+    {"via", ""},
+    {"www-authenticate", ""}
+};
+
+/* The Huffman code of RFC 7541 is canonical: codes of the same length are
+   consecutive, in the order of their symbols, and shorter codes come first.
+   The number of codes of each length and the symbols in code order are
+   enough to decode it. */
+static const unsigned char axis2_http2_huffman_counts[AXIS2_HTTP2_HUFFMAN_MAX_BITS + 1] = {
+    0, 0, 0, 0, 0, 10, 26, 32, 6, 0, 5, 3, 2, 6, 2, 3, 0, 0, 0, 3, 8, 13, 26,
+    29, 12, 4, 15, 19, 29, 0, 4
+};
+
+static const unsigned short axis2_http2_huffman_symbols[257] = {
+    48, 49, 50, 97, 99, 101, 105, 111, 115, 116, 32, 37, 45, 46, 47, 51, 52,
+    53, 54, 55, 56, 57, 61, 65, 95, 98, 100, 102, 103, 104, 108, 109, 110, 112,
+    114, 117, 58, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79, 80,
+    81, 82, 83, 84, 85, 86, 87, 89, 106, 107, 113, 118, 119, 120, 121, 122, 38,
+    42, 44, 59, 88, 90, 33, 34, 40, 41, 63, 39, 43, 124, 35, 62, 0, 36, 64, 91,
+    93, 126, 94, 125, 60, 96, 123, 92, 195, 208, 128, 130, 131, 162, 184, 194,
+    224, 226, 153, 161, 167, 172, 176, 177, 179, 209, 216, 217, 227, 229, 230,
+    129, 132, 133, 134, 136, 146, 154, 156, 160, 163, 164, 169, 170, 173, 178,
+    181, 185, 186, 187, 189, 190, 196, 198, 228, 232, 233, 1, 135, 137, 138,
+    139, 140, 141, 143, 147, 149, 150, 151, 152, 155, 157, 158, 165, 166, 168,
+    174, 175, 180, 182, 183, 188, 191, 197, 231, 239, 9, 142, 144, 145, 148,
+    159, 171, 206, 215, 225, 236, 237, 199, 207, 234, 235, 192, 193, 200, 201,
+    202, 205, 210, 213, 218, 219, 238, 240, 242, 243, 255, 203, 204, 211, 212,
+    214, 221, 222, 223, 241, 244, 245, 246, 247, 248, 250, 251, 252, 253, 254,
+    2, 3, 4, 5, 6, 7, 8, 11, 12, 14, 15, 16, 17, 18, 19, 20, 21, 23, 24, 25,
+    26, 27, 28, 29, 30, 31, 127, 220, 249, 10, 13, 22, 256
+};
+
+AXIS2_EXTERN axis2_http2_hpack_t *AXIS2_CALL
+axis2_http2_hpack_create(
+    const axutil_env_t * env,
+    int max_table_size)
+{
+    axis2_http2_hpack_t *hpack = NULL;
+
+    hpack = AXIS2_MALLOC(env->allocator, sizeof(axis2_http2_hpack_t));
+    if (!hpack)
+    {
+        AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+    hpack->table = axutil_array_list_create(env, 16);
+    if (!hpack->table)
+    {
+        AXIS2_FREE(env->allocator, hpack);
+        return NULL;
+    }
+    hpack->table_size = 0;
+    hpack->max_table_size = max_table_size;
+    hpack->settings_table_size = max_table_size;
+    return hpack;
+}
+
+AXIS2_EXTERN void AXIS2_CALL
+axis2_http2_hpack_free(
+    axis2_http2_hpack_t * hpack,
+    const axutil_env_t * env)
+{
+    int i = 0;
+
+    if (!hpack)
+    {
+        return;
+    }
+    for (i = 0; i < axutil_array_list_size(hpack->table, env); i++)
+    {
+        AXIS2_FREE(env->allocator, axutil_array_list_get(hpack->table, env, i));
+    }
+    axutil_array_list_free(hpack->table, env);
+    AXIS2_FREE(env->allocator, hpack);
+}
+
+/* Drops the oldest entries until the table fits in size */
+static void
+axis2_http2_hpack_evict(
+    axis2_http2_hpack_t * hpack,
+    const axutil_env_t * env,
+    int size)
+{
+    while (hpack->table_size > size)
+    {
+        int last = axutil_array_list_size(hpack->table, env) - 1;
+        axis2_http2_hpack_entry_t *entry =
+            axutil_array_list_remove(hpack->table, env, last);
+
+        hpack->table_size -= entry->size;
+        AXIS2_FREE(env->allocator, entry);
+    }
+}
+
+static axis2_status_t
+axis2_http2_hpack_add_entry(
+    axis2_http2_hpack_t * hpack,
+    const axutil_env_t * env,
+    const axis2_char_t * name,
+    const axis2_char_t * value)
+{
+    axis2_http2_hpack_entry_t *entry = NULL;
+    int name_len = axutil_strlen(name);
+    int value_len = axutil_strlen(value);
+    int size = name_len + value_len + AXIS2_HTTP2_HPACK_ENTRY_OVERHEAD;
+
+    /* an entry larger than the table empties it and is not added */
+    if (size > hpack->max_table_size)
+    {
+        axis2_http2_hpack_evict(hpack, env, 0);
+        return AXIS2_SUCCESS;
+    }
+
+    /* the strings are kept in the same block as the entry. They are copied
+       before evicting, as name may be that of an entry evicted */
+    entry = AXIS2_MALLOC(env->allocator, sizeof(axis2_http2_hpack_entry_t) +
+                         name_len + value_len + 2);
+    if (!entry)
+    {
+        AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+    entry->name = (axis2_char_t *) (entry + 1);
+    entry->value = entry->name + name_len + 1;
+    memcpy(entry->name, name, name_len + 1);
+    memcpy(entry->value, value, value_len + 1);
+    entry->size = size;
+    axis2_http2_hpack_evict(hpack, env, hpack->max_table_size - size);
+    axutil_array_list_add_at(hpack->table, env, 0, entry);
+    hpack->table_size += size;
+    return AXIS2_SUCCESS;
+}
+
+/* Looks up an index of the static and dynamic tables */
+static axis2_status_t
+axis2_http2_hpack_lookup(
+    axis2_http2_hpack_t * hpack,
+    const axutil_env_t * env,
+    int index,
+    const axis2_char_t ** name,
+    const axis2_char_t ** value)
+{
+    axis2_http2_hpack_entry_t *entry = NULL;
+
+    if (index <= 0)
+    {
+        return AXIS2_FAILURE;
+    }
+    if (index <= AXIS2_HTTP2_HPACK_STATIC_COUNT)
+    {
+        *name = axis2_http2_hpack_static[index - 1][0];
+        *value = axis2_http2_hpack_static[index - 1][1];
+        return AXIS2_SUCCESS;
+    }
+    index -= AXIS2_HTTP2_HPACK_STATIC_COUNT + 1;
+    if (index >= axutil_array_list_size(hpack->table, env))
+    {
+        return AXIS2_FAILURE;
+    }
+    entry = axutil_array_list_get(hpack->table, env, index);
+    *name = entry->name;
+    *value = entry->value;
+    return AXIS2_SUCCESS;
+}
+
+/* Decodes an integer with an n bit prefix, returns -1 on error */
+static int
+axis2_http2_hpack_decode_int(
+    const unsigned char *block,
+    int length,
+    int *pos,
+    int prefix_bits)
+{
+    int max_prefix = (1 << prefix_bits) - 1;
+    int value = 0;
+    int shift = 0;
+
+    if (*pos >= length)
+    {
+        return -1;
+    }
+    value = block[(*pos)++] & max_prefix;
+    if (value < max_prefix)
+    {
+        return value;
+    }
+    while (*pos < length)
+    {
+        unsigned char b = block[(*pos)++];
+
+        if (shift > 21)
+        {
+            return -1;
+        }
+        value += (b & 0x7f) << shift;
+        shift += 7;
+        if (!(b & 0x80))
+        {
+            return value;
+        }
+    }
+    return -1;
+}
+
+static axis2_char_t *
+axis2_http2_hpack_huffman_decode(
+    const axutil_env_t * env,
+    const unsigned char *data,
+    int length)
+{
+    axis2_char_t *out = NULL;
+    int out_len = 0;
+    int first[AXIS2_HTTP2_HUFFMAN_MAX_BITS + 1];
+    int offset[AXIS2_HTTP2_HUFFMAN_MAX_BITS + 1];
+    int code = 0;
+    int bits = 0;
+    int i = 0;
+
+    /* first code and position in the symbol table of each length */
+    first[0] = 0;
+    offset[0] = 0;
+    for (i = 1; i <= AXIS2_HTTP2_HUFFMAN_MAX_BITS; i++)
+    {
+        first[i] = (first[i - 1] + axis2_http2_huffman_counts[i - 1]) << 1;
+        offset[i] = offset[i - 1] + axis2_http2_huffman_counts[i - 1];
+    }
+
+    /* the shortest codes are 5 bits long */
+    out = AXIS2_MALLOC(env->allocator, (length * 8) / 5 + 1);
+    if (!out)
+    {
+        AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+    for (i = 0; i < length * 8; i++)
+    {
+        code = (code << 1) | ((data[i >> 3] >> (7 - (i & 7))) & 1);
+        bits++;
+        if (code >= first[bits] &&
+            code - first[bits] < axis2_http2_huffman_counts[bits])
+        {
+            int symbol = axis2_http2_huffman_symbols[offset[bits] + code -
+                                                     first[bits]];
+            if (AXIS2_HTTP2_HUFFMAN_EOS == symbol)
+            {
+                break;
+            }
+            out[out_len++] = (axis2_char_t) symbol;
+            code = 0;
+            bits = 0;
+        }
+        else if (bits >= AXIS2_HTTP2_HUFFMAN_MAX_BITS)
+        {
+            break;
+        }
+    }
+    /* what is left must be padding, the start of the end of string code */
+    if (i < length * 8 || bits > 7 || code != (1 << bits) - 1)
+    {
+        AXIS2_FREE(env->allocator, out);
+        return NULL;
+    }
+    out[out_len] = '\0';
+    return out;
+}
+
+static axis2_char_t *
+axis2_http2_hpack_decode_string(
+    const axutil_env_t * env,
+    const unsigned char *block,
+    int length,
+    int *pos)
+{
+    axis2_bool_t huffman = AXIS2_FALSE;
+    axis2_char_t *str = NULL;
+    int str_len = 0;
+
+    if (*pos >= length)
+    {
+        return NULL;
+    }
+    huffman = (block[*pos] & 0x80) ? AXIS2_TRUE : AXIS2_FALSE;
+    str_len = axis2_http2_hpack_decode_int(block, length, pos, 7);
+    if (str_len < 0 || str_len > length - *pos)
+    {
+        return NULL;
+    }
+    if (huffman)
+    {
+        str = axis2_http2_hpack_huffman_decode(env, block + *pos, str_len);
+    }
+    else
+    {
+        str = AXIS2_MALLOC(env->allocator, str_len + 1);
+        if (str)
+        {
+            memcpy(str, block + *pos, str_len);
+            str[str_len] = '\0';
+        }
+    }
+    *pos += str_len;
+    return str;
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_http2_hpack_decode(
+    axis2_http2_hpack_t * hpack,
+    const axutil_env_t * env,
+    const unsigned char *block,
+    int length,
+    axutil_array_list_t * headers)
+{
+    int pos = 0;
+
+    while (pos < length)
+    {
+        unsigned char b = block[pos];
+        const axis2_char_t *name = NULL;
+        const axis2_char_t *value = NULL;
+        axis2_char_t *name_str = NULL;
+        axis2_char_t *value_str = NULL;
+        axis2_bool_t add_entry = AXIS2_FALSE;
+        axis2_http_header_t *header = NULL;
+        int index = 0;
+
+        if (b & 0x80)
+        {
+            /* indexed field */
+            index = axis2_http2_hpack_decode_int(block, length, &pos, 7);
+            if (AXIS2_SUCCESS != axis2_http2_hpack_lookup(hpack, env, index,
+                                                          &name, &value))
+            {
+                return AXIS2_FAILURE;
+            }
+        }
+        else if ((b & 0xe0) == 0x20)
+        {
+            /* dynamic table size update */
+            int size = axis2_http2_hpack_decode_int(block, length, &pos, 5);
+
+            if (size < 0 || size > hpack->settings_table_size)
+            {
+                return AXIS2_FAILURE;
+            }
+            hpack->max_table_size = size;
+            axis2_http2_hpack_evict(hpack, env, size);
+            continue;
+        }
+        else
+        {
+            /* literal field, added to the table, not added or never added */
+            add_entry = (b & 0x40) ? AXIS2_TRUE : AXIS2_FALSE;
+            index = axis2_http2_hpack_decode_int(block, length, &pos,
+                                                 add_entry ? 6 : 4);
+            if (index < 0)
+            {
+                return AXIS2_FAILURE;
+            }
+            if (index)
+            {
+                if (AXIS2_SUCCESS != axis2_http2_hpack_lookup(hpack, env, index,
+                                                              &name, &value))
+                {
+                    return AXIS2_FAILURE;
+                }
+            }
+            else
+            {
+                name_str = axis2_http2_hpack_decode_string(env, block, length,
+                                                           &pos);
+                if (!name_str)
+                {
+                    return AXIS2_FAILURE;
+                }
+                name = name_str;
+            }
+            value_str = axis2_http2_hpack_decode_string(env, block, length,
+                                                        &pos);
+            if (!value_str)
+            {
+                AXIS2_FREE(env->allocator, name_str);
+                return AXIS2_FAILURE;
+            }
+            value = value_str;
+        }
+
+        header = axis2_http_header_create(env, name, value);
+        if (add_entry && header)
+        {
+            /* the header keeps its own copies, the entry may be evicted */
+            axis2_http2_hpack_add_entry(hpack, env, name, value);
+        }
+        if (name_str)
+        {
+            AXIS2_FREE(env->allocator, name_str);
+        }
+        if (value_str)
+        {
+            AXIS2_FREE(env->allocator, value_str);
+        }
+        if (!header)
+        {
+            return AXIS2_FAILURE;
+        }
+        axutil_array_list_add(headers, env, header);
+    }
+    return AXIS2_SUCCESS;
+}
+
+/* Encodes an integer with an n bit prefix, the other bits of the first byte
+   taken from first */
+static int
+axis2_http2_hpack_encode_int(
+    unsigned char *buffer,
+    int value,
+    int prefix_bits,
+    unsigned char first)
+{
+    int max_prefix = (1 << prefix_bits) - 1;
+    int len = 0;
+
+    if (value < max_prefix)
+    {
+        buffer[len++] = (unsigned char) (first | value);
+        return len;
+    }
+    buffer[len++] = (unsigned char) (first | max_prefix);
+    value -= max_prefix;
+    while (value >= 0x80)
+    {
+        buffer[len++] = (unsigned char) ((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    buffer[len++] = (unsigned char) value;
+    return len;
+}
+
+static int
+axis2_http2_hpack_encode_string(
+    unsigned char *buffer,
+    const axis2_char_t * str)
+{
+    int str_len = axutil_strlen(str);
+    int len = axis2_http2_hpack_encode_int(buffer, str_len, 7, 0);
+
+    memcpy(buffer + len, str, str_len);
+    return len + str_len;
+}
+
+AXIS2_EXTERN int AXIS2_CALL
+axis2_http2_hpack_encode(
+    const axutil_env_t * env,
+    const axis2_char_t * name,
+    const axis2_char_t * value,
+    unsigned char *buffer)
+{
+    int name_index = 0;
+    int len = 0;
+    int i = 0;
+
+    for (i = 0; i < AXIS2_HTTP2_HPACK_STATIC_COUNT; i++)
+    {
+        if (!strcmp(axis2_http2_hpack_static[i][0], name))
+        {
+            if (!strcmp(axis2_http2_hpack_static[i][1], value))
+            {
+                return axis2_http2_hpack_encode_int(buffer, i + 1, 7, 0x80);
+            }
+            if (!name_index)
+            {
+                name_index = i + 1;
+            }
+        }
+    }
+
+    /* literal not added to the table */
+    len = axis2_http2_hpack_encode_int(buffer, name_index, 4, 0);
+    if (!name_index)
+    {
+        len += axis2_http2_hpack_encode_string(buffer + len, name);
+    }
+    len += axis2_http2_hpack_encode_string(buffer + len, value);
+    return len;
+}
+
+AXIS2_EXTERN int AXIS2_CALL
+axis2_http2_hpack_encoded_max_len(
+    const axis2_char_t * name,
+    const axis2_char_t * value)
+{
+    /* a first byte and three integers of at most five bytes */
+    return axutil_strlen(name) + axutil_strlen(value) + 16;
+}
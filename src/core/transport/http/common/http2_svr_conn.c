@@ -0,0 +1,1710 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <axis2_http2_svr_conn.h>
+#include <axis2_http2.h>
+#include <axis2_http_transport.h>
+#include <axis2_http_header.h>
+#include <axis2_http_request_line.h>
+#include <axutil_string.h>
+#include <axutil_base64.h>
+#include <axutil_thread.h>
+#include <axutil_thread_pool.h>
+#include <platforms/axutil_platform_auto_sense.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <poll.h>
+
+/* receive window of the streams and of the connection. Request bodies are
+   kept in memory until they are complete, the window is given back as they
+   arrive. */
+#define AXIS2_HTTP2_SVR_WINDOW_SIZE (1 << 20)
+
+/* frames buffered past this are written before more are added */
+#define AXIS2_HTTP2_SVR_FLUSH_SIZE 65536
+
+/* the request is being received */
+#define AXIS2_HTTP2_SVR_STREAM_OPEN 0
+/* the worker is processing the request */
+#define AXIS2_HTTP2_SVR_STREAM_PROCESSING 1
+/* the worker wrote the response */
+#define AXIS2_HTTP2_SVR_STREAM_READY 2
+/* the response is being sent */
+#define AXIS2_HTTP2_SVR_STREAM_SENDING 3
+
+#define AXIS2_HTTP2_SVR_UPGRADE_RESPONSE "HTTP/1.1 101 Switching Protocols\r\n"\
+    "Connection: Upgrade\r\nUpgrade: h2c\r\n\r\n"
+
+struct axis2_http2_svr_conn;
+
+typedef struct axis2_http2_svr_stream
+{
+    struct axis2_http2_svr_conn *conn;
+    int id;
+    int state;
+    /* reset by the client while the worker had it */
+    axis2_bool_t cancelled;
+    /* request headers, pseudo headers included */
+    axutil_array_list_t *headers;
+    axis2_char_t *body;
+    int body_len;
+    int body_size;
+    int recv_window;
+    /* the HTTP/1.1 response written by the worker */
+    axutil_stream_t *response;
+    /* body of the response still to send */
+    axis2_char_t *data;
+    int data_len;
+    int send_window;
+} axis2_http2_svr_stream_t;
+
+typedef struct axis2_http2_svr_conn
+{
+    const axutil_env_t *env;
+    axis2_http_worker_t *worker;
+    int socket;
+    axis2_http2_frame_reader_t *reader;
+    axis2_http2_frame_buf_t *out;
+    axis2_http2_hpack_t *decoder;
+    /* streams not closed yet */
+    axutil_array_list_t *streams;
+    /* guards the state of the streams against the worker threads */
+    axutil_thread_mutex_t *mutex;
+    /* written to by a worker thread when its response is ready */
+    int wakeup[2];
+    int processing;
+    /* last stream accepted, and last stream opened or refused */
+    int last_stream_id;
+    int max_stream_id;
+    int accepted;
+    int max_streams;
+    int max_requests;
+    int send_window;
+    int recv_window;
+    /* from the settings of the client */
+    int initial_window;
+    int max_frame_size;
+    const axis2_char_t *preface;
+    int preface_len;
+    axis2_bool_t preface_received;
+    /* header block being received */
+    int block_stream_id;
+    int block_flags;
+    unsigned char *block;
+    int block_len;
+    int block_size;
+    /* no new streams are accepted */
+    axis2_bool_t goaway;
+    axis2_bool_t goaway_sent;
+    /* the connection is to be closed */
+    axis2_bool_t closing;
+} axis2_http2_svr_conn_t;
+
+static void
+axis2_http2_svr_conn_dispatch(
+    axis2_http2_svr_conn_t * conn,
+    axis2_http2_svr_stream_t * stream);
+
+static void
+axis2_http2_svr_conn_free(
+    axis2_http2_svr_conn_t * conn);
+
+AXIS2_EXTERN axis2_bool_t AXIS2_CALL
+axis2_http2_svr_conn_is_preface(
+    const axutil_env_t * env,
+    axis2_http_simple_request_t * request)
+{
+    axis2_http_request_line_t *request_line = NULL;
+
+    request_line = axis2_http_simple_request_get_request_line(request, env);
+    if (!request_line)
+    {
+        return AXIS2_FALSE;
+    }
+    return !axutil_strcmp(axis2_http_request_line_get_method(request_line, env),
+                          AXIS2_HTTP2_PREFACE_METHOD) &&
+        !axutil_strcmp(axis2_http_request_line_get_uri(request_line, env), "*") &&
+        !axutil_strcmp(axis2_http_request_line_get_http_version(request_line,
+                                                                env),
+                       AXIS2_HTTP2_PREFACE_VERSION);
+}
+
+AXIS2_EXTERN axis2_bool_t AXIS2_CALL
+axis2_http2_svr_conn_is_upgrade(
+    const axutil_env_t * env,
+    axis2_http_simple_request_t * request)
+{
+    axis2_http_header_t *upgrade = NULL;
+    axis2_http_request_line_t *request_line = NULL;
+
+    request_line = axis2_http_simple_request_get_request_line(request, env);
+    upgrade = axis2_http_simple_request_get_first_header(request, env,
+                                                         AXIS2_HTTP2_HEADER_UPGRADE);
+    return request_line && upgrade &&
+        axutil_strcasestr(axis2_http_header_get_value(upgrade, env),
+                          AXIS2_HTTP2_UPGRADE_TOKEN) &&
+        !axutil_strcasecmp(axis2_http_request_line_get_http_version(request_line,
+                                                                    env),
+                           AXIS2_HTTP_HEADER_PROTOCOL_11) &&
+        axis2_http_simple_request_contains_header(request, env,
+                                                  AXIS2_HTTP2_HEADER_SETTINGS) &&
+        !axis2_http_simple_request_contains_header(request, env,
+                                                   AXIS2_HTTP_HEADER_TRANSFER_ENCODING);
+}
+
+static void
+axis2_http2_svr_conn_free_headers(
+    const axutil_env_t * env,
+    axutil_array_list_t * headers)
+{
+    int i = 0;
+
+    if (!headers)
+    {
+        return;
+    }
+    for (i = 0; i < axutil_array_list_size(headers, env); i++)
+    {
+        axis2_http_header_t *header = axutil_array_list_get(headers, env, i);
+        if (header)
+        {
+            axis2_http_header_free(header, env);
+        }
+    }
+    axutil_array_list_free(headers, env);
+}
+
+static axis2_http2_svr_stream_t *
+axis2_http2_svr_conn_stream_create(
+    axis2_http2_svr_conn_t * conn,
+    int id,
+    axutil_array_list_t * headers)
+{
+    axis2_http2_svr_stream_t *stream = NULL;
+    const axutil_env_t *env = conn->env;
+
+    stream = AXIS2_MALLOC(env->allocator, sizeof(axis2_http2_svr_stream_t));
+    if (!stream)
+    {
+        AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+    memset(stream, 0, sizeof(axis2_http2_svr_stream_t));
+    stream->conn = conn;
+    stream->id = id;
+    stream->state = AXIS2_HTTP2_SVR_STREAM_OPEN;
+    stream->headers = headers;
+    stream->recv_window = AXIS2_HTTP2_SVR_WINDOW_SIZE;
+    stream->send_window = conn->initial_window;
+    axutil_array_list_add(conn->streams, env, stream);
+    return stream;
+}
+
+static void
+axis2_http2_svr_conn_stream_free(
+    axis2_http2_svr_stream_t * stream,
+    const axutil_env_t * env)
+{
+    axis2_http2_svr_conn_free_headers(env, stream->headers);
+    if (stream->body)
+    {
+        AXIS2_FREE(env->allocator, stream->body);
+    }
+    if (stream->response)
+    {
+        axutil_stream_free(stream->response, env);
+    }
+    AXIS2_FREE(env->allocator, stream);
+}
+
+static axis2_http2_svr_stream_t *
+axis2_http2_svr_conn_find_stream(
+    axis2_http2_svr_conn_t * conn,
+    int id)
+{
+    int i = 0;
+
+    for (i = 0; i < axutil_array_list_size(conn->streams, conn->env); i++)
+    {
+        axis2_http2_svr_stream_t *stream =
+            axutil_array_list_get(conn->streams, conn->env, i);
+        if (stream->id == id)
+        {
+            return stream;
+        }
+    }
+    return NULL;
+}
+
+static void
+axis2_http2_svr_conn_close_stream(
+    axis2_http2_svr_conn_t * conn,
+    axis2_http2_svr_stream_t * stream)
+{
+    int i = 0;
+
+    for (i = 0; i < axutil_array_list_size(conn->streams, conn->env); i++)
+    {
+        if (axutil_array_list_get(conn->streams, conn->env, i) == stream)
+        {
+            axutil_array_list_remove(conn->streams, conn->env, i);
+            break;
+        }
+    }
+    axis2_http2_svr_conn_stream_free(stream, conn->env);
+}
+
+static void
+axis2_http2_svr_conn_add_int(
+    unsigned char *buf,
+    unsigned int value)
+{
+    buf[0] = (unsigned char) (value >> 24);
+    buf[1] = (unsigned char) (value >> 16);
+    buf[2] = (unsigned char) (value >> 8);
+    buf[3] = (unsigned char) value;
+}
+
+static unsigned int
+axis2_http2_svr_conn_get_int(
+    const unsigned char *buf)
+{
+    return ((unsigned int) buf[0] << 24) | ((unsigned int) buf[1] << 16) |
+        ((unsigned int) buf[2] << 8) | (unsigned int) buf[3];
+}
+
+static void
+axis2_http2_svr_conn_window_update(
+    axis2_http2_svr_conn_t * conn,
+    int stream_id,
+    int increment)
+{
+    unsigned char payload[4];
+
+    axis2_http2_svr_conn_add_int(payload, increment);
+    axis2_http2_frame_buf_add(conn->out, conn->env, AXIS2_HTTP2_WINDOW_UPDATE,
+                              0, stream_id, payload, 4);
+}
+
+static void
+axis2_http2_svr_conn_reset_stream(
+    axis2_http2_svr_conn_t * conn,
+    int stream_id,
+    int error)
+{
+    unsigned char payload[4];
+
+    axis2_http2_svr_conn_add_int(payload, error);
+    axis2_http2_frame_buf_add(conn->out, conn->env, AXIS2_HTTP2_RST_STREAM, 0,
+                              stream_id, payload, 4);
+}
+
+/* Tells the client that no more streams are accepted. On an error the
+   connection is closed as soon as the frame is written. */
+static axis2_status_t
+axis2_http2_svr_conn_goaway(
+    axis2_http2_svr_conn_t * conn,
+    int error)
+{
+    unsigned char payload[8];
+
+    conn->goaway = AXIS2_TRUE;
+    if (AXIS2_HTTP2_NO_ERROR != error)
+    {
+        AXIS2_LOG_WARNING(conn->env->log, AXIS2_LOG_SI,
+                          "Closing HTTP/2 connection on error %d", error);
+        conn->closing = AXIS2_TRUE;
+    }
+    if (conn->goaway_sent)
+    {
+        return AXIS2_FAILURE;
+    }
+    conn->goaway_sent = AXIS2_TRUE;
+    axis2_http2_svr_conn_add_int(payload, conn->last_stream_id);
+    axis2_http2_svr_conn_add_int(payload + 4, error);
+    axis2_http2_frame_buf_add(conn->out, conn->env, AXIS2_HTTP2_GOAWAY, 0, 0,
+                              payload, 8);
+    return AXIS2_FAILURE;
+}
+
+static axis2_status_t
+axis2_http2_svr_conn_apply_settings(
+    axis2_http2_svr_conn_t * conn,
+    const unsigned char *payload,
+    int length)
+{
+    int pos = 0;
+
+    for (pos = 0; pos + 6 <= length; pos += 6)
+    {
+        int id = (payload[pos] << 8) | payload[pos + 1];
+        unsigned int value = axis2_http2_svr_conn_get_int(payload + pos + 2);
+
+        if (AXIS2_HTTP2_SETTINGS_INITIAL_WINDOW_SIZE == id)
+        {
+            int delta = 0;
+            int i = 0;
+
+            if (value > AXIS2_HTTP2_MAX_WINDOW_SIZE)
+            {
+                return axis2_http2_svr_conn_goaway(conn,
+                                                   AXIS2_HTTP2_FLOW_CONTROL_ERROR);
+            }
+            /* the change applies to the streams already open */
+            delta = (int) value - conn->initial_window;
+            conn->initial_window = (int) value;
+            for (i = 0; i < axutil_array_list_size(conn->streams, conn->env); i++)
+            {
+                axis2_http2_svr_stream_t *stream =
+                    axutil_array_list_get(conn->streams, conn->env, i);
+                stream->send_window += delta;
+            }
+        }
+        else if (AXIS2_HTTP2_SETTINGS_MAX_FRAME_SIZE == id)
+        {
+            if (value < AXIS2_HTTP2_DEFAULT_MAX_FRAME_SIZE || value > 0xffffff)
+            {
+                return axis2_http2_svr_conn_goaway(conn,
+                                                   AXIS2_HTTP2_PROTOCOL_ERROR);
+            }
+            conn->max_frame_size = (int) value;
+        }
+    }
+    return AXIS2_SUCCESS;
+}
+
+/* Applies the settings a client asking for an upgrade sends, base64url
+   encoded, in the HTTP2-Settings header */
+static void
+axis2_http2_svr_conn_apply_upgrade_settings(
+    axis2_http2_svr_conn_t * conn,
+    const axis2_char_t * value)
+{
+    const axutil_env_t *env = conn->env;
+    axis2_char_t *coded = NULL;
+    unsigned char *plain = NULL;
+    int len = axutil_strlen(value);
+    int i = 0;
+
+    coded = AXIS2_MALLOC(env->allocator, len + 4);
+    if (!coded)
+    {
+        return;
+    }
+    for (i = 0; i < len; i++)
+    {
+        coded[i] = value[i] == '-' ? '+' : value[i] == '_' ? '/' : value[i];
+    }
+    while (i % 4)
+    {
+        coded[i++] = '=';
+    }
+    coded[i] = '\0';
+    plain = AXIS2_MALLOC(env->allocator, axutil_base64_decode_len(coded) + 1);
+    if (plain)
+    {
+        len = axutil_base64_decode_binary(plain, coded);
+        if (len > 0)
+        {
+            axis2_http2_svr_conn_apply_settings(conn, plain, len);
+        }
+        AXIS2_FREE(env->allocator, plain);
+    }
+    AXIS2_FREE(env->allocator, coded);
+}
+
+static axis2_http2_svr_conn_t *
+axis2_http2_svr_conn_create(
+    const axutil_env_t * env,
+    axis2_http_worker_t * worker,
+    int socket,
+    int max_streams,
+    int max_requests)
+{
+    axis2_http2_svr_conn_t *conn = NULL;
+
+    conn = AXIS2_MALLOC(env->allocator, sizeof(axis2_http2_svr_conn_t));
+    if (!conn)
+    {
+        AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+    memset(conn, 0, sizeof(axis2_http2_svr_conn_t));
+    conn->env = env;
+    conn->worker = worker;
+    conn->socket = socket;
+    conn->wakeup[0] = -1;
+    conn->wakeup[1] = -1;
+    conn->max_streams = max_streams;
+    conn->max_requests = max_requests;
+    conn->send_window = AXIS2_HTTP2_DEFAULT_WINDOW_SIZE;
+    conn->recv_window = AXIS2_HTTP2_SVR_WINDOW_SIZE;
+    conn->initial_window = AXIS2_HTTP2_DEFAULT_WINDOW_SIZE;
+    conn->max_frame_size = AXIS2_HTTP2_DEFAULT_MAX_FRAME_SIZE;
+    conn->block_size = AXIS2_HTTP2_DEFAULT_MAX_FRAME_SIZE;
+
+    conn->reader = axis2_http2_frame_reader_create(env,
+                                                   AXIS2_HTTP2_DEFAULT_MAX_FRAME_SIZE);
+    conn->out = axis2_http2_frame_buf_create(env);
+    conn->decoder = axis2_http2_hpack_create(env,
+                                             AXIS2_HTTP2_DEFAULT_HEADER_TABLE_SIZE);
+    conn->streams = axutil_array_list_create(env, max_streams);
+    conn->mutex = axutil_thread_mutex_create(env->allocator,
+                                             AXIS2_THREAD_MUTEX_DEFAULT);
+    conn->block = AXIS2_MALLOC(env->allocator, conn->block_size);
+    if (!conn->reader || !conn->out || !conn->decoder || !conn->streams ||
+        !conn->mutex || !conn->block || pipe(conn->wakeup))
+    {
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "Unable to set up the HTTP/2 connection");
+        conn->wakeup[0] = -1;
+        axis2_http2_svr_conn_free(conn);
+        return NULL;
+    }
+    return conn;
+}
+
+/* Frees the connection once no worker thread has a stream of it */
+static void
+axis2_http2_svr_conn_free(
+    axis2_http2_svr_conn_t * conn)
+{
+    const axutil_env_t *env = conn->env;
+
+    if (conn->mutex)
+    {
+        axutil_thread_mutex_lock(conn->mutex);
+        while (conn->processing > 0)
+        {
+            char wakeup = 0;
+
+            axutil_thread_mutex_unlock(conn->mutex);
+            if (read(conn->wakeup[0], &wakeup, 1) < 0 && EINTR != errno)
+            {
+                AXIS2_SLEEP(1);
+            }
+            axutil_thread_mutex_lock(conn->mutex);
+        }
+        axutil_thread_mutex_unlock(conn->mutex);
+        axutil_thread_mutex_destroy(conn->mutex);
+    }
+    if (conn->streams)
+    {
+        while (axutil_array_list_size(conn->streams, env) > 0)
+        {
+            axis2_http2_svr_conn_stream_free(
+                axutil_array_list_remove(conn->streams, env, 0), env);
+        }
+        axutil_array_list_free(conn->streams, env);
+    }
+    if (conn->wakeup[0] != -1)
+    {
+        close(conn->wakeup[0]);
+        close(conn->wakeup[1]);
+    }
+    if (conn->reader)
+    {
+        axis2_http2_frame_reader_free(conn->reader, env);
+    }
+    if (conn->out)
+    {
+        axis2_http2_frame_buf_free(conn->out, env);
+    }
+    if (conn->decoder)
+    {
+        axis2_http2_hpack_free(conn->decoder, env);
+    }
+    if (conn->block)
+    {
+        AXIS2_FREE(env->allocator, conn->block);
+    }
+    AXIS2_FREE(env->allocator, conn);
+}
+
+static axis2_status_t
+axis2_http2_svr_conn_append(
+    const axutil_env_t * env,
+    axis2_char_t ** data,
+    int *len,
+    int *size,
+    const unsigned char *bytes,
+    int count)
+{
+    if (*len + count > *size)
+    {
+        axis2_char_t *grown = NULL;
+        int new_size = *size ? *size : AXIS2_HTTP2_DEFAULT_MAX_FRAME_SIZE;
+
+        while (*len + count > new_size)
+        {
+            new_size *= 2;
+        }
+        grown = AXIS2_MALLOC(env->allocator, new_size);
+        if (!grown)
+        {
+            AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+            return AXIS2_FAILURE;
+        }
+        if (*data)
+        {
+            memcpy(grown, *data, *len);
+            AXIS2_FREE(env->allocator, *data);
+        }
+        *data = grown;
+        *size = new_size;
+    }
+    memcpy(*data + *len, bytes, count);
+    *len += count;
+    return AXIS2_SUCCESS;
+}
+
+/* Makes the stream into a request for the worker and keeps what the worker
+   writes back. Runs on the thread the stream was dispatched to. */
+static void
+axis2_http2_svr_conn_process(
+    axis2_http2_svr_conn_t * conn,
+    axis2_http2_svr_stream_t * stream,
+    const axutil_env_t * env)
+{
+    axis2_http_simple_request_t *request = NULL;
+    axis2_http_request_line_t *request_line = NULL;
+    axis2_simple_http_svr_conn_t *svr_conn = NULL;
+    const axis2_char_t *method = NULL;
+    const axis2_char_t *path = NULL;
+    const axis2_char_t *authority = NULL;
+    axutil_stream_t *response = NULL;
+    int i = 0;
+
+    for (i = 0; i < axutil_array_list_size(stream->headers, env); i++)
+    {
+        axis2_http_header_t *header = axutil_array_list_get(stream->headers,
+                                                            env, i);
+        axis2_char_t *name = axis2_http_header_get_name(header, env);
+
+        if (!axutil_strcmp(name, ":method"))
+        {
+            method = axis2_http_header_get_value(header, env);
+        }
+        else if (!axutil_strcmp(name, ":path"))
+        {
+            path = axis2_http_header_get_value(header, env);
+        }
+        else if (!axutil_strcmp(name, ":authority"))
+        {
+            authority = axis2_http_header_get_value(header, env);
+        }
+    }
+
+    response = axutil_stream_create_basic(env);
+    if (method && path)
+    {
+        request_line = axis2_http_request_line_create(env, method, path,
+                                                      AXIS2_HTTP_HEADER_PROTOCOL_11);
+    }
+    if (request_line)
+    {
+        request = axis2_http_simple_request_create(env, request_line, NULL, 0,
+                                                   NULL);
+    }
+    if (!request || !response)
+    {
+        if (request)
+        {
+            axis2_http_simple_request_free(request, env);
+        }
+        else if (request_line)
+        {
+            axis2_http_request_line_free(request_line, env);
+        }
+        if (response)
+        {
+            axutil_stream_free(response, env);
+            response = NULL;
+        }
+        AXIS2_LOG_WARNING(env->log, AXIS2_LOG_SI,
+                          "Unable to make a request of HTTP/2 stream %d",
+                          stream->id);
+    }
+    else
+    {
+        axis2_char_t length[16];
+
+        /* the headers move to the request, the pseudo headers are dropped */
+        for (i = 0; i < axutil_array_list_size(stream->headers, env); i++)
+        {
+            axis2_http_header_t *header = axutil_array_list_get(stream->headers,
+                                                                env, i);
+            if (':' == axis2_http_header_get_name(header, env)[0])
+            {
+                axis2_http_header_free(header, env);
+            }
+            else
+            {
+                axis2_http_simple_request_add_header(request, env, header);
+            }
+        }
+        axutil_array_list_free(stream->headers, env);
+        stream->headers = NULL;
+        if (authority && !axis2_http_simple_request_contains_header(request,
+                env, AXIS2_HTTP_HEADER_HOST))
+        {
+            axis2_http_simple_request_add_header(request, env,
+                axis2_http_header_create(env, AXIS2_HTTP_HEADER_HOST, authority));
+        }
+        /* the length of the body is known, HTTP/2 does not need to send it */
+        if (stream->body_len > 0 &&
+            !axis2_http_simple_request_contains_header(request, env,
+                AXIS2_HTTP_HEADER_CONTENT_LENGTH))
+        {
+            sprintf(length, "%d", stream->body_len);
+            axis2_http_simple_request_add_header(request, env,
+                axis2_http_header_create(env, AXIS2_HTTP_HEADER_CONTENT_LENGTH,
+                                         length));
+        }
+        if (stream->body_len > 0)
+        {
+            axis2_http_simple_request_set_body_string(request, env,
+                                                      stream->body,
+                                                      stream->body_len);
+        }
+
+        svr_conn = axis2_simple_http_svr_conn_create_with_stream(env,
+                                                                 conn->socket,
+                                                                 response);
+        if (svr_conn)
+        {
+            if (AXIS2_SUCCESS != axis2_http_worker_process_request(conn->worker,
+                    env, svr_conn, request))
+            {
+                AXIS2_LOG_WARNING(env->log, AXIS2_LOG_SI,
+                                  "Error occured in processing HTTP/2 stream %d",
+                                  stream->id);
+            }
+            axis2_simple_http_svr_conn_free(svr_conn, env);
+        }
+        axis2_http_simple_request_free(request, env);
+    }
+
+    axutil_thread_mutex_lock(conn->mutex);
+    stream->response = response;
+    stream->state = AXIS2_HTTP2_SVR_STREAM_READY;
+    conn->processing--;
+    /* written while locked, the connection may go once it is unlocked */
+    if (write(conn->wakeup[1], "", 1) < 0)
+    {
+        AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI,
+                        "HTTP/2 connection already woken up");
+    }
+    axutil_thread_mutex_unlock(conn->mutex);
+}
+
+#ifdef AXIS2_SVR_MULTI_THREADED
+static void *AXIS2_THREAD_FUNC
+axis2_http2_svr_conn_worker_func(
+    axutil_thread_t * thd,
+    void *data)
+{
+    axis2_http2_svr_stream_t *stream = data;
+    axis2_http2_svr_conn_t *conn = stream->conn;
+    axutil_thread_pool_t *thread_pool = conn->env->thread_pool;
+    axutil_env_t *thread_env = NULL;
+
+    thread_env = axutil_get_thread_env(conn->env);
+    axis2_http2_svr_conn_process(conn, stream,
+                                 thread_env ? thread_env : conn->env);
+    axutil_release_thread_env(thread_env);
+    axutil_thread_pool_exit_thread(thread_pool, thd);
+    return NULL;
+}
+#endif
+
+/* The request of the stream is complete, it goes to the worker */
+static void
+axis2_http2_svr_conn_dispatch(
+    axis2_http2_svr_conn_t * conn,
+    axis2_http2_svr_stream_t * stream)
+{
+#ifdef AXIS2_SVR_MULTI_THREADED
+    axutil_thread_t *worker_thread = NULL;
+#endif
+
+    axutil_thread_mutex_lock(conn->mutex);
+    stream->state = AXIS2_HTTP2_SVR_STREAM_PROCESSING;
+    conn->processing++;
+    axutil_thread_mutex_unlock(conn->mutex);
+
+#ifdef AXIS2_SVR_MULTI_THREADED
+    worker_thread = axutil_thread_pool_get_thread(conn->env->thread_pool,
+                                                  axis2_http2_svr_conn_worker_func,
+                                                  (void *) stream);
+    if (worker_thread)
+    {
+        axutil_thread_pool_thread_detach(conn->env->thread_pool, worker_thread);
+        return;
+    }
+    AXIS2_LOG_WARNING(conn->env->log, AXIS2_LOG_SI, "Thread creation failed, "
+                      "serving HTTP/2 stream %d in the connection thread",
+                      stream->id);
+#endif
+    axis2_http2_svr_conn_process(conn, stream, conn->env);
+}
+
+/* A complete header block of the client opens a stream or ends one with
+   trailers */
+static axis2_status_t
+axis2_http2_svr_conn_on_header_block(
+    axis2_http2_svr_conn_t * conn)
+{
+    const axutil_env_t *env = conn->env;
+    axis2_http2_svr_stream_t *stream = NULL;
+    axutil_array_list_t *headers = NULL;
+    int stream_id = conn->block_stream_id;
+    int flags = conn->block_flags;
+
+    conn->block_stream_id = 0;
+    headers = axutil_array_list_create(env, 10);
+    if (!headers)
+    {
+        return axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_INTERNAL_ERROR);
+    }
+    /* decoded even for a stream refused, the table must follow the client */
+    if (AXIS2_SUCCESS != axis2_http2_hpack_decode(conn->decoder, env,
+                                                  conn->block, conn->block_len,
+                                                  headers))
+    {
+        axis2_http2_svr_conn_free_headers(env, headers);
+        return axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_COMPRESSION_ERROR);
+    }
+
+    stream = axis2_http2_svr_conn_find_stream(conn, stream_id);
+    if (stream)
+    {
+        /* trailers, nothing the worker looks at */
+        axis2_http2_svr_conn_free_headers(env, headers);
+        if (AXIS2_HTTP2_SVR_STREAM_OPEN != stream->state ||
+            !(flags & AXIS2_HTTP2_FLAG_END_STREAM))
+        {
+            return axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_PROTOCOL_ERROR);
+        }
+        axis2_http2_svr_conn_dispatch(conn, stream);
+        return AXIS2_SUCCESS;
+    }
+
+    if (!(stream_id & 1) || stream_id <= conn->max_stream_id)
+    {
+        axis2_http2_svr_conn_free_headers(env, headers);
+        return axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_PROTOCOL_ERROR);
+    }
+    conn->max_stream_id = stream_id;
+    if (conn->goaway ||
+        axutil_array_list_size(conn->streams, env) >= conn->max_streams)
+    {
+        axis2_http2_svr_conn_free_headers(env, headers);
+        axis2_http2_svr_conn_reset_stream(conn, stream_id,
+                                          AXIS2_HTTP2_REFUSED_STREAM);
+        return AXIS2_SUCCESS;
+    }
+    conn->last_stream_id = stream_id;
+    stream = axis2_http2_svr_conn_stream_create(conn, stream_id, headers);
+    if (!stream)
+    {
+        axis2_http2_svr_conn_free_headers(env, headers);
+        return axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_INTERNAL_ERROR);
+    }
+    conn->accepted++;
+    if (flags & AXIS2_HTTP2_FLAG_END_STREAM)
+    {
+        axis2_http2_svr_conn_dispatch(conn, stream);
+    }
+    if (conn->max_requests > 0 && conn->accepted >= conn->max_requests)
+    {
+        axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_NO_ERROR);
+    }
+    return AXIS2_SUCCESS;
+}
+
+static axis2_status_t
+axis2_http2_svr_conn_on_headers(
+    axis2_http2_svr_conn_t * conn,
+    const axis2_http2_frame_t * frame)
+{
+    const unsigned char *payload = frame->payload;
+    int length = frame->length;
+
+    if (!frame->stream_id)
+    {
+        return axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_PROTOCOL_ERROR);
+    }
+    if (AXIS2_HTTP2_HEADERS == frame->type)
+    {
+        int pad = 0;
+
+        if (frame->flags & AXIS2_HTTP2_FLAG_PADDED)
+        {
+            if (length < 1)
+            {
+                return axis2_http2_svr_conn_goaway(conn,
+                                                   AXIS2_HTTP2_PROTOCOL_ERROR);
+            }
+            pad = payload[0];
+            payload++;
+            length--;
+        }
+        if (frame->flags & AXIS2_HTTP2_FLAG_PRIORITY)
+        {
+            payload += 5;
+            length -= 5;
+        }
+        length -= pad;
+        if (length < 0)
+        {
+            return axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_PROTOCOL_ERROR);
+        }
+        conn->block_stream_id = frame->stream_id;
+        conn->block_flags = frame->flags;
+        conn->block_len = 0;
+    }
+    else if (frame->stream_id != conn->block_stream_id)
+    {
+        return axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_PROTOCOL_ERROR);
+    }
+    if (conn->block_len + length > AXIS2_HTTP2_SVR_WINDOW_SIZE)
+    {
+        return axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_PROTOCOL_ERROR);
+    }
+    if (length > 0 && AXIS2_SUCCESS != axis2_http2_svr_conn_append(conn->env,
+            (axis2_char_t **) &conn->block, &conn->block_len, &conn->block_size,
+            payload, length))
+    {
+        return axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_INTERNAL_ERROR);
+    }
+    if (frame->flags & AXIS2_HTTP2_FLAG_END_HEADERS)
+    {
+        return axis2_http2_svr_conn_on_header_block(conn);
+    }
+    return AXIS2_SUCCESS;
+}
+
+static axis2_status_t
+axis2_http2_svr_conn_on_data(
+    axis2_http2_svr_conn_t * conn,
+    const axis2_http2_frame_t * frame)
+{
+    axis2_http2_svr_stream_t *stream = NULL;
+    const unsigned char *payload = frame->payload;
+    int length = frame->length;
+
+    if (!frame->stream_id)
+    {
+        return axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_PROTOCOL_ERROR);
+    }
+    /* the padding counts against the windows too */
+    conn->recv_window -= frame->length;
+    if (conn->recv_window < 0)
+    {
+        return axis2_http2_svr_conn_goaway(conn,
+                                           AXIS2_HTTP2_FLOW_CONTROL_ERROR);
+    }
+    if (conn->recv_window < AXIS2_HTTP2_SVR_WINDOW_SIZE / 2)
+    {
+        axis2_http2_svr_conn_window_update(conn, 0, AXIS2_HTTP2_SVR_WINDOW_SIZE -
+                                           conn->recv_window);
+        conn->recv_window = AXIS2_HTTP2_SVR_WINDOW_SIZE;
+    }
+
+    stream = axis2_http2_svr_conn_find_stream(conn, frame->stream_id);
+    if (!stream || AXIS2_HTTP2_SVR_STREAM_OPEN != stream->state)
+    {
+        if (frame->stream_id > conn->max_stream_id)
+        {
+            return axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_PROTOCOL_ERROR);
+        }
+        axis2_http2_svr_conn_reset_stream(conn, frame->stream_id,
+                                          AXIS2_HTTP2_STREAM_CLOSED);
+        return AXIS2_SUCCESS;
+    }
+    stream->recv_window -= frame->length;
+    if (stream->recv_window < 0)
+    {
+        axis2_http2_svr_conn_reset_stream(conn, stream->id,
+                                          AXIS2_HTTP2_FLOW_CONTROL_ERROR);
+        axis2_http2_svr_conn_close_stream(conn, stream);
+        return AXIS2_SUCCESS;
+    }
+    if (frame->flags & AXIS2_HTTP2_FLAG_PADDED)
+    {
+        if (length < 1 || payload[0] >= length)
+        {
+            return axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_PROTOCOL_ERROR);
+        }
+        length -= 1 + payload[0];
+        payload++;
+    }
+    if (length > 0 && AXIS2_SUCCESS != axis2_http2_svr_conn_append(conn->env,
+            &stream->body, &stream->body_len, &stream->body_size, payload,
+            length))
+    {
+        axis2_http2_svr_conn_reset_stream(conn, stream->id,
+                                          AXIS2_HTTP2_INTERNAL_ERROR);
+        axis2_http2_svr_conn_close_stream(conn, stream);
+        return AXIS2_SUCCESS;
+    }
+    if (frame->flags & AXIS2_HTTP2_FLAG_END_STREAM)
+    {
+        axis2_http2_svr_conn_dispatch(conn, stream);
+    }
+    else if (stream->recv_window < AXIS2_HTTP2_SVR_WINDOW_SIZE / 2)
+    {
+        axis2_http2_svr_conn_window_update(conn, stream->id,
+                                           AXIS2_HTTP2_SVR_WINDOW_SIZE -
+                                           stream->recv_window);
+        stream->recv_window = AXIS2_HTTP2_SVR_WINDOW_SIZE;
+    }
+    return AXIS2_SUCCESS;
+}
+
+static axis2_status_t
+axis2_http2_svr_conn_on_frame(
+    axis2_http2_svr_conn_t * conn,
+    const axis2_http2_frame_t * frame)
+{
+    axis2_http2_svr_stream_t *stream = NULL;
+
+    /* nothing may come between the frames of a header block */
+    if (conn->block_stream_id && AXIS2_HTTP2_CONTINUATION != frame->type)
+    {
+        return axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_PROTOCOL_ERROR);
+    }
+    switch (frame->type)
+    {
+    case AXIS2_HTTP2_DATA:
+        return axis2_http2_svr_conn_on_data(conn, frame);
+
+    case AXIS2_HTTP2_HEADERS:
+    case AXIS2_HTTP2_CONTINUATION:
+        if (AXIS2_HTTP2_CONTINUATION == frame->type && !conn->block_stream_id)
+        {
+            return axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_PROTOCOL_ERROR);
+        }
+        return axis2_http2_svr_conn_on_headers(conn, frame);
+
+    case AXIS2_HTTP2_RST_STREAM:
+        if (!frame->stream_id || 4 != frame->length)
+        {
+            return axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_PROTOCOL_ERROR);
+        }
+        stream = axis2_http2_svr_conn_find_stream(conn, frame->stream_id);
+        if (stream)
+        {
+            axutil_thread_mutex_lock(conn->mutex);
+            if (AXIS2_HTTP2_SVR_STREAM_PROCESSING == stream->state)
+            {
+                /* closed once the worker is done with it */
+                stream->cancelled = AXIS2_TRUE;
+                stream = NULL;
+            }
+            axutil_thread_mutex_unlock(conn->mutex);
+            if (stream)
+            {
+                axis2_http2_svr_conn_close_stream(conn, stream);
+            }
+        }
+        return AXIS2_SUCCESS;
+
+    case AXIS2_HTTP2_SETTINGS:
+        if (frame->stream_id)
+        {
+            return axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_PROTOCOL_ERROR);
+        }
+        if (frame->flags & AXIS2_HTTP2_FLAG_ACK)
+        {
+            return AXIS2_SUCCESS;
+        }
+        if (frame->length % 6)
+        {
+            return axis2_http2_svr_conn_goaway(conn,
+                                               AXIS2_HTTP2_FRAME_SIZE_ERROR);
+        }
+        if (AXIS2_SUCCESS != axis2_http2_svr_conn_apply_settings(conn,
+                frame->payload, frame->length))
+        {
+            return AXIS2_FAILURE;
+        }
+        return axis2_http2_frame_buf_add(conn->out, conn->env,
+                                         AXIS2_HTTP2_SETTINGS,
+                                         AXIS2_HTTP2_FLAG_ACK, 0, NULL, 0);
+
+    case AXIS2_HTTP2_PING:
+        if (frame->stream_id || 8 != frame->length)
+        {
+            return axis2_http2_svr_conn_goaway(conn,
+                                               AXIS2_HTTP2_FRAME_SIZE_ERROR);
+        }
+        if (frame->flags & AXIS2_HTTP2_FLAG_ACK)
+        {
+            return AXIS2_SUCCESS;
+        }
+        return axis2_http2_frame_buf_add(conn->out, conn->env,
+                                         AXIS2_HTTP2_PING, AXIS2_HTTP2_FLAG_ACK,
+                                         0, frame->payload, 8);
+
+    case AXIS2_HTTP2_GOAWAY:
+        /* the streams already open are still answered */
+        conn->goaway = AXIS2_TRUE;
+        return AXIS2_SUCCESS;
+
+    case AXIS2_HTTP2_WINDOW_UPDATE:
+        {
+            int increment = 0;
+
+            if (4 != frame->length)
+            {
+                return axis2_http2_svr_conn_goaway(conn,
+                                                   AXIS2_HTTP2_FRAME_SIZE_ERROR);
+            }
+            increment = (int) (axis2_http2_svr_conn_get_int(frame->payload) &
+                               0x7fffffff);
+            if (!frame->stream_id)
+            {
+                if (!increment || increment > AXIS2_HTTP2_MAX_WINDOW_SIZE -
+                    conn->send_window)
+                {
+                    return axis2_http2_svr_conn_goaway(conn,
+                                                       AXIS2_HTTP2_FLOW_CONTROL_ERROR);
+                }
+                conn->send_window += increment;
+                return AXIS2_SUCCESS;
+            }
+            stream = axis2_http2_svr_conn_find_stream(conn, frame->stream_id);
+            if (stream)
+            {
+                if (!increment || increment > AXIS2_HTTP2_MAX_WINDOW_SIZE -
+                    stream->send_window)
+                {
+                    axis2_http2_svr_conn_reset_stream(conn, stream->id,
+                                                      AXIS2_HTTP2_FLOW_CONTROL_ERROR);
+                    axutil_thread_mutex_lock(conn->mutex);
+                    if (AXIS2_HTTP2_SVR_STREAM_PROCESSING == stream->state)
+                    {
+                        stream->cancelled = AXIS2_TRUE;
+                        stream = NULL;
+                    }
+                    axutil_thread_mutex_unlock(conn->mutex);
+                    if (stream)
+                    {
+                        axis2_http2_svr_conn_close_stream(conn, stream);
+                    }
+                    return AXIS2_SUCCESS;
+                }
+                stream->send_window += increment;
+            }
+            return AXIS2_SUCCESS;
+        }
+
+    case AXIS2_HTTP2_PUSH_PROMISE:
+        return axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_PROTOCOL_ERROR);
+
+    default:
+        /* PRIORITY and unknown frames are ignored */
+        return AXIS2_SUCCESS;
+    }
+}
+
+/* Reads a hex number ending at a line break, -1 if there is none */
+static int
+axis2_http2_svr_conn_chunk_size(
+    const axis2_char_t * data,
+    int len,
+    int *pos)
+{
+    int size = 0;
+    int i = *pos;
+
+    for (; i < len && isxdigit((unsigned char) data[i]); i++)
+    {
+        int digit = data[i] <= '9' ? data[i] - '0' : (data[i] | 0x20) - 'a' + 10;
+
+        if (size > 0x7ffffff)
+        {
+            return -1;
+        }
+        size = size * 16 + digit;
+    }
+    /* chunk extensions are skipped */
+    for (; i + 1 < len && !('\r' == data[i] && '\n' == data[i + 1]); i++);
+    if (i + 1 >= len)
+    {
+        return -1;
+    }
+    *pos = i + 2;
+    return size;
+}
+
+/* Removes the chunked encoding of a body in place, returns its length */
+static int
+axis2_http2_svr_conn_dechunk(
+    axis2_char_t * data,
+    int len)
+{
+    int pos = 0;
+    int out = 0;
+
+    while (pos < len)
+    {
+        int size = axis2_http2_svr_conn_chunk_size(data, len, &pos);
+
+        if (size <= 0)
+        {
+            break;
+        }
+        if (size > len - pos)
+        {
+            size = len - pos;
+        }
+        memmove(data + out, data + pos, size);
+        out += size;
+        pos += size + 2;
+    }
+    return out;
+}
+
+/* Sends the head of the HTTP/1.1 response the worker wrote as the headers
+   of the stream, and keeps its body to go out as data */
+static axis2_status_t
+axis2_http2_svr_conn_start_response(
+    axis2_http2_svr_conn_t * conn,
+    axis2_http2_svr_stream_t * stream)
+{
+    const axutil_env_t *env = conn->env;
+    axis2_char_t *data = NULL;
+    axis2_char_t *head = NULL;
+    axis2_char_t *line = NULL;
+    axis2_char_t *end = NULL;
+    unsigned char *block = NULL;
+    int len = 0;
+    int block_len = 0;
+    int block_size = 0;
+    int status = 0;
+    int sent = 0;
+    axis2_bool_t chunked = AXIS2_FALSE;
+
+    if (stream->response)
+    {
+        data = axutil_stream_get_buffer(stream->response, env);
+        len = axutil_stream_get_len(stream->response, env);
+    }
+    /* interim responses, 100 Continue, are not passed on */
+    while (data && len > 0)
+    {
+        axis2_char_t *space = NULL;
+
+        head = data;
+        for (end = data; end + 3 < data + len; end++)
+        {
+            if (!memcmp(end, "\r\n\r\n", 4))
+            {
+                break;
+            }
+        }
+        if (end + 3 >= data + len)
+        {
+            head = NULL;
+            break;
+        }
+        space = memchr(head, ' ', end - head);
+        status = space ? atoi(space + 1) : 0;
+        len -= (int) (end + 4 - data);
+        data = end + 4;
+        if (status >= 200 || status < 100)
+        {
+            break;
+        }
+    }
+    if (!head || status < 200)
+    {
+        AXIS2_LOG_WARNING(env->log, AXIS2_LOG_SI,
+                          "No response to send for HTTP/2 stream %d",
+                          stream->id);
+        axis2_http2_svr_conn_reset_stream(conn, stream->id,
+                                          AXIS2_HTTP2_INTERNAL_ERROR);
+        axis2_http2_svr_conn_close_stream(conn, stream);
+        return AXIS2_SUCCESS;
+    }
+
+    /* room for the longest encoding of each header line */
+    *end = '\0';
+    block_size = (int) (end - head) + 32;
+    for (line = strstr(head, "\r\n"); line;
+         line = strstr(line + 2, "\r\n"))
+    {
+        block_size += 16;
+    }
+    block = AXIS2_MALLOC(env->allocator, block_size);
+    if (!block)
+    {
+        axis2_http2_svr_conn_reset_stream(conn, stream->id,
+                                          AXIS2_HTTP2_INTERNAL_ERROR);
+        axis2_http2_svr_conn_close_stream(conn, stream);
+        return AXIS2_SUCCESS;
+    }
+    {
+        axis2_char_t status_str[8];
+
+        sprintf(status_str, "%d", status % 1000);
+        block_len += axis2_http2_hpack_encode(env, ":status", status_str,
+                                              block + block_len);
+    }
+    /* the header lines are split in place, the names lower cased */
+    line = strstr(head, "\r\n");
+    while (line)
+    {
+        axis2_char_t *name = line + 2;
+        axis2_char_t *value = NULL;
+        axis2_char_t *next = strstr(name, "\r\n");
+        axis2_char_t *c = NULL;
+
+        if (next)
+        {
+            *next = '\0';
+        }
+        value = strchr(name, ':');
+        if (value)
+        {
+            *value++ = '\0';
+            while (' ' == *value || '\t' == *value)
+            {
+                value++;
+            }
+            for (c = value + strlen(value); c > value &&
+                 (' ' == c[-1] || '\t' == c[-1]); c--);
+            *c = '\0';
+            for (c = name; *c; c++)
+            {
+                *c = (axis2_char_t) tolower((unsigned char) *c);
+            }
+            if (!axutil_strcmp(name, "transfer-encoding"))
+            {
+                chunked = axutil_strcasestr(value, "chunked") != NULL;
+            }
+            if (!axis2_http2_is_connection_header(name) &&
+                block_len + axis2_http2_hpack_encoded_max_len(name, value) <=
+                block_size)
+            {
+                block_len += axis2_http2_hpack_encode(env, name, value,
+                                                      block + block_len);
+            }
+        }
+        line = next;
+    }
+    if (chunked)
+    {
+        len = axis2_http2_svr_conn_dechunk(data, len);
+    }
+    stream->data = data;
+    stream->data_len = len;
+
+    /* a block larger than a frame goes on in CONTINUATION frames */
+    while (sent < block_len || !sent)
+    {
+        int count = block_len - sent;
+        int flags = 0;
+
+        if (count > conn->max_frame_size)
+        {
+            count = conn->max_frame_size;
+        }
+        if (sent + count == block_len)
+        {
+            flags |= AXIS2_HTTP2_FLAG_END_HEADERS;
+        }
+        if (!sent && !stream->data_len)
+        {
+            flags |= AXIS2_HTTP2_FLAG_END_STREAM;
+        }
+        axis2_http2_frame_buf_add(conn->out, env, sent ?
+                                  AXIS2_HTTP2_CONTINUATION : AXIS2_HTTP2_HEADERS,
+                                  flags, stream->id, block + sent, count);
+        sent += count;
+    }
+    AXIS2_FREE(env->allocator, block);
+    stream->state = AXIS2_HTTP2_SVR_STREAM_SENDING;
+    if (!stream->data_len)
+    {
+        axis2_http2_svr_conn_close_stream(conn, stream);
+    }
+    return AXIS2_SUCCESS;
+}
+
+/* Starts the responses the workers are done with and sends as much of the
+   bodies as the windows let, a frame of each stream in turn */
+static axis2_status_t
+axis2_http2_svr_conn_send(
+    axis2_http2_svr_conn_t * conn)
+{
+    const axutil_env_t *env = conn->env;
+    axis2_bool_t progress = AXIS2_TRUE;
+    int i = 0;
+
+    for (i = 0; i < axutil_array_list_size(conn->streams, env); i++)
+    {
+        axis2_http2_svr_stream_t *stream =
+            axutil_array_list_get(conn->streams, env, i);
+        int state = 0;
+        axis2_bool_t cancelled = AXIS2_FALSE;
+
+        axutil_thread_mutex_lock(conn->mutex);
+        state = stream->state;
+        cancelled = stream->cancelled;
+        axutil_thread_mutex_unlock(conn->mutex);
+        if (AXIS2_HTTP2_SVR_STREAM_READY != state)
+        {
+            continue;
+        }
+        if (cancelled)
+        {
+            axis2_http2_svr_conn_close_stream(conn, stream);
+        }
+        else
+        {
+            axis2_http2_svr_conn_start_response(conn, stream);
+        }
+        /* the stream may be gone */
+        if (i < axutil_array_list_size(conn->streams, env) &&
+            axutil_array_list_get(conn->streams, env, i) != stream)
+        {
+            i--;
+        }
+        else if (i >= axutil_array_list_size(conn->streams, env))
+        {
+            break;
+        }
+    }
+
+    while (progress && conn->send_window > 0)
+    {
+        progress = AXIS2_FALSE;
+        for (i = 0; i < axutil_array_list_size(conn->streams, env); i++)
+        {
+            axis2_http2_svr_stream_t *stream =
+                axutil_array_list_get(conn->streams, env, i);
+            int count = stream->data_len;
+            int flags = 0;
+
+            if (AXIS2_HTTP2_SVR_STREAM_SENDING != stream->state)
+            {
+                continue;
+            }
+            if (count > conn->max_frame_size)
+            {
+                count = conn->max_frame_size;
+            }
+            if (count > stream->send_window)
+            {
+                count = stream->send_window;
+            }
+            if (count > conn->send_window)
+            {
+                count = conn->send_window;
+            }
+            if (count <= 0)
+            {
+                continue;
+            }
+            if (count == stream->data_len)
+            {
+                flags = AXIS2_HTTP2_FLAG_END_STREAM;
+            }
+            axis2_http2_frame_buf_add(conn->out, env, AXIS2_HTTP2_DATA, flags,
+                                      stream->id, stream->data, count);
+            stream->data += count;
+            stream->data_len -= count;
+            stream->send_window -= count;
+            conn->send_window -= count;
+            progress = AXIS2_TRUE;
+            if (!stream->data_len)
+            {
+                axis2_http2_svr_conn_close_stream(conn, stream);
+                i--;
+            }
+            if (axis2_http2_frame_buf_get_len(conn->out, env) >
+                AXIS2_HTTP2_SVR_FLUSH_SIZE &&
+                AXIS2_SUCCESS != axis2_http2_frame_buf_flush(conn->out, env,
+                                                             conn->socket))
+            {
+                return AXIS2_FAILURE;
+            }
+        }
+    }
+    return AXIS2_SUCCESS;
+}
+
+/* Takes the request asking for the upgrade as stream 1 */
+static axis2_status_t
+axis2_http2_svr_conn_upgrade(
+    axis2_http2_svr_conn_t * conn,
+    axis2_http_simple_request_t * request)
+{
+    const axutil_env_t *env = conn->env;
+    axis2_http_request_line_t *request_line = NULL;
+    axis2_http2_svr_stream_t *stream = NULL;
+    axutil_array_list_t *headers = NULL;
+    axutil_array_list_t *request_headers = NULL;
+    axis2_http_header_t *settings = NULL;
+    axutil_stream_t *body = NULL;
+    int content_length = 0;
+    int i = 0;
+
+    request_line = axis2_http_simple_request_get_request_line(request, env);
+    headers = axutil_array_list_create(env, 10);
+    if (!headers)
+    {
+        return AXIS2_FAILURE;
+    }
+    axutil_array_list_add(headers, env, axis2_http_header_create(env, ":method",
+        axis2_http_request_line_get_method(request_line, env)));
+    axutil_array_list_add(headers, env, axis2_http_header_create(env, ":path",
+        axis2_http_request_line_get_uri(request_line, env)));
+    request_headers = axis2_http_simple_request_get_headers(request, env);
+    for (i = 0; i < axutil_array_list_size(request_headers, env); i++)
+    {
+        axis2_http_header_t *header = axutil_array_list_get(request_headers,
+                                                            env, i);
+        axis2_char_t *name = axis2_http_header_get_name(header, env);
+
+        if (!axis2_http2_is_connection_header(name))
+        {
+            axutil_array_list_add(headers, env, axis2_http_header_create(env,
+                name, axis2_http_header_get_value(header, env)));
+        }
+    }
+    stream = axis2_http2_svr_conn_stream_create(conn, 1, headers);
+    if (!stream)
+    {
+        axis2_http2_svr_conn_free_headers(env, headers);
+        return AXIS2_FAILURE;
+    }
+    conn->last_stream_id = 1;
+    conn->max_stream_id = 1;
+    conn->accepted = 1;
+
+    /* the body comes before the switch */
+    content_length = axis2_http_simple_request_get_content_length(request, env);
+    body = axis2_http_simple_request_get_body(request, env);
+    while (body && stream->body_len < content_length)
+    {
+        unsigned char buffer[4096];
+        int read = axutil_stream_read(body, env, buffer, sizeof(buffer));
+
+        if (read <= 0 || AXIS2_SUCCESS != axis2_http2_svr_conn_append(env,
+                &stream->body, &stream->body_len, &stream->body_size, buffer,
+                read))
+        {
+            return AXIS2_FAILURE;
+        }
+    }
+
+    axis2_http2_frame_buf_add_raw(conn->out, env,
+                                  AXIS2_HTTP2_SVR_UPGRADE_RESPONSE,
+                                  (int) strlen(AXIS2_HTTP2_SVR_UPGRADE_RESPONSE));
+    settings = axis2_http_simple_request_get_first_header(request, env,
+                                                          AXIS2_HTTP2_HEADER_SETTINGS);
+    axis2_http2_svr_conn_apply_upgrade_settings(conn,
+        axis2_http_header_get_value(settings, env));
+    conn->preface = AXIS2_HTTP2_PREFACE;
+    conn->preface_len = AXIS2_HTTP2_PREFACE_LEN;
+    return AXIS2_SUCCESS;
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_http2_svr_conn_serve(
+    const axutil_env_t * env,
+    axis2_http_worker_t * worker,
+    axis2_simple_http_svr_conn_t * svr_conn,
+    axis2_http_simple_request_t * request,
+    int max_streams,
+    int max_requests,
+    int idle_timeout)
+{
+    axis2_http2_svr_conn_t *conn = NULL;
+    axis2_status_t status = AXIS2_SUCCESS;
+    axis2_http2_svr_stream_t *upgraded = NULL;
+    unsigned char settings[18];
+    char buffer[4096];
+    int len = 0;
+
+    AXIS2_PARAM_CHECK(env->error, svr_conn, AXIS2_FAILURE);
+    AXIS2_PARAM_CHECK(env->error, request, AXIS2_FAILURE);
+
+    conn = axis2_http2_svr_conn_create(env, worker,
+                                       axis2_simple_http_svr_conn_get_socket(svr_conn, env),
+                                       max_streams > 0 ? max_streams : 1,
+                                       max_requests);
+    if (!conn)
+    {
+        return AXIS2_FAILURE;
+    }
+    /* a worker must not block on a full pipe while holding the mutex */
+    fcntl(conn->wakeup[1], F_SETFL, fcntl(conn->wakeup[1], F_GETFL) | O_NONBLOCK);
+
+    if (axis2_http2_svr_conn_is_preface(env, request))
+    {
+        conn->preface = AXIS2_HTTP2_PREFACE_REST;
+        conn->preface_len = AXIS2_HTTP2_PREFACE_REST_LEN;
+    }
+    else if (AXIS2_SUCCESS == axis2_http2_svr_conn_upgrade(conn, request))
+    {
+        upgraded = axis2_http2_svr_conn_find_stream(conn, 1);
+    }
+    else
+    {
+        axis2_http2_svr_conn_free(conn);
+        return AXIS2_FAILURE;
+    }
+    /* what the client sent after the request is the start of the frames */
+    while ((len = axis2_simple_http_svr_conn_take_buffered(svr_conn, env,
+                                                           buffer,
+                                                           sizeof(buffer))) > 0)
+    {
+        if (AXIS2_SUCCESS != axis2_http2_frame_reader_put(conn->reader, env,
+                                                          buffer, len))
+        {
+            axis2_http2_svr_conn_free(conn);
+            return AXIS2_FAILURE;
+        }
+    }
+
+    settings[0] = 0;
+    settings[1] = AXIS2_HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS;
+    axis2_http2_svr_conn_add_int(settings + 2, conn->max_streams);
+    settings[6] = 0;
+    settings[7] = AXIS2_HTTP2_SETTINGS_INITIAL_WINDOW_SIZE;
+    axis2_http2_svr_conn_add_int(settings + 8, AXIS2_HTTP2_SVR_WINDOW_SIZE);
+    settings[12] = 0;
+    settings[13] = AXIS2_HTTP2_SETTINGS_ENABLE_PUSH;
+    axis2_http2_svr_conn_add_int(settings + 14, 0);
+    axis2_http2_frame_buf_add(conn->out, env, AXIS2_HTTP2_SETTINGS, 0, 0,
+                              settings, sizeof(settings));
+    axis2_http2_svr_conn_window_update(conn, 0, AXIS2_HTTP2_SVR_WINDOW_SIZE -
+                                       AXIS2_HTTP2_DEFAULT_WINDOW_SIZE);
+    if (AXIS2_SUCCESS != axis2_http2_frame_buf_flush(conn->out, env,
+                                                     conn->socket))
+    {
+        axis2_http2_svr_conn_free(conn);
+        return AXIS2_FAILURE;
+    }
+    if (upgraded)
+    {
+        axis2_http2_svr_conn_dispatch(conn, upgraded);
+    }
+
+    while (!conn->closing)
+    {
+        struct pollfd fds[2];
+        axis2_http2_frame_t frame;
+        int next = 0;
+        int timeout = idle_timeout > 0 ? idle_timeout : -1;
+        int ready = 0;
+
+        if (!conn->preface_received)
+        {
+            next = axis2_http2_frame_reader_expect(conn->reader, env,
+                                                   conn->preface,
+                                                   conn->preface_len);
+            if (next < 0)
+            {
+                AXIS2_LOG_WARNING(env->log, AXIS2_LOG_SI,
+                                  "Invalid HTTP/2 connection preface");
+                status = AXIS2_FAILURE;
+                break;
+            }
+            conn->preface_received = (next > 0);
+        }
+        while (conn->preface_received && !conn->closing &&
+               (next = axis2_http2_frame_reader_next(conn->reader, env,
+                                                     &frame)) > 0)
+        {
+            axis2_http2_svr_conn_on_frame(conn, &frame);
+        }
+        if (next < 0)
+        {
+            axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_FRAME_SIZE_ERROR);
+        }
+        if (AXIS2_SUCCESS != axis2_http2_svr_conn_send(conn) ||
+            AXIS2_SUCCESS != axis2_http2_frame_buf_flush(conn->out, env,
+                                                         conn->socket))
+        {
+            status = AXIS2_FAILURE;
+            break;
+        }
+        if (conn->closing || (conn->goaway && !conn->block_stream_id &&
+                              !axutil_array_list_size(conn->streams, env)))
+        {
+            break;
+        }
+
+        axutil_thread_mutex_lock(conn->mutex);
+        if (conn->processing > 0)
+        {
+            timeout = -1;
+        }
+        axutil_thread_mutex_unlock(conn->mutex);
+        fds[0].fd = conn->socket;
+        fds[0].events = POLLIN;
+        fds[1].fd = conn->wakeup[0];
+        fds[1].events = POLLIN;
+        ready = poll(fds, 2, timeout);
+        if (ready < 0 && EINTR == errno)
+        {
+            continue;
+        }
+        if (!ready)
+        {
+            AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI,
+                            "Closing idle HTTP/2 connection");
+            axis2_http2_svr_conn_goaway(conn, AXIS2_HTTP2_NO_ERROR);
+            axis2_http2_frame_buf_flush(conn->out, env, conn->socket);
+            break;
+        }
+        if (ready < 0)
+        {
+            status = AXIS2_FAILURE;
+            break;
+        }
+        if (fds[1].revents)
+        {
+            if (read(conn->wakeup[0], buffer, sizeof(buffer)) < 0)
+            {
+                AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI,
+                                "Reading the HTTP/2 wake up pipe failed");
+            }
+        }
+        if (fds[0].revents && axis2_http2_frame_reader_fill(conn->reader, env,
+                                                            conn->socket) <= 0)
+        {
+            /* the client closed the connection */
+            break;
+        }
+    }
+
+    if (conn->closing)
+    {
+        axis2_http2_frame_buf_flush(conn->out, env, conn->socket);
+    }
+    axis2_http2_svr_conn_free(conn);
+    return status;
+}
@@ -1221,8 +1221,8 @@ axis2_http_worker_process_request(
                 return AXIS2_FALSE;
             }
 
-            http_error_property = axis2_msg_ctx_get_property(msg_ctx, env,
-                                                             AXIS2_HTTP_TRANSPORT_ERROR);
+            http_error_property = axis2_msg_ctx_get_property_at(msg_ctx, env,
+                                                                AXIS2_CTX_SLOT_HTTP_TRANSPORT_ERROR);
 
             if (http_error_property)
                 http_error_value =
@@ -2097,6 +2097,17 @@ axis2_http_worker_set_response_headers(
     if (AXIS2_FALSE == axis2_http_simple_response_contains_header
         (simple_response, env, AXIS2_HTTP_HEADER_CONNECTION))
     {
+        axis2_char_t *http_version = NULL;
+        axis2_bool_t http_11 = AXIS2_FALSE;
+        axis2_bool_t keep_alive = AXIS2_FALSE;
+
+        http_version = axis2_http_request_line_get_http_version(
+            axis2_http_simple_request_get_request_line(simple_request, env), env);
+        http_11 = http_version && 0 == axutil_strcasecmp(http_version,
+                                                         AXIS2_HTTP_HEADER_PROTOCOL_11);
+        /* HTTP/1.1 connections persist unless the client closes them */
+        keep_alive = http_11;
+
         conn_header = 
             axis2_http_simple_request_get_first_header(simple_request,
                                                        env,
@@ -2109,47 +2120,39 @@ axis2_http_worker_set_response_headers(
             if (0 == axutil_strcasecmp(value, 
                                        AXIS2_HTTP_HEADER_CONNECTION_KEEPALIVE))
             {
-                axis2_http_header_t *header = axis2_http_header_create(
-                    env,
-                    AXIS2_HTTP_HEADER_CONNECTION,
-                    AXIS2_HTTP_HEADER_CONNECTION_KEEPALIVE);
-
-                axis2_http_simple_response_set_header(simple_response, env,
-                                                      header);
-                axis2_simple_http_svr_conn_set_keep_alive(svr_conn, env,
-                                                          AXIS2_TRUE);
+                keep_alive = AXIS2_TRUE;
             }
+            else if (0 == axutil_strcasecmp(value,
+                                            AXIS2_HTTP_HEADER_CONNECTION_CLOSE))
+            {
+                keep_alive = AXIS2_FALSE;
+            }
+        }
 
-            if (0 == axutil_strcasecmp(value,
-                                       AXIS2_HTTP_HEADER_CONNECTION_CLOSE))
+        /* the connection may still refuse, past its limit of requests */
+        axis2_simple_http_svr_conn_set_keep_alive(svr_conn, env, keep_alive);
+        if (axis2_simple_http_svr_conn_is_keep_alive(svr_conn, env))
+        {
+            if (!http_11)
             {
                 axis2_http_header_t *header = axis2_http_header_create(
                     env,
                     AXIS2_HTTP_HEADER_CONNECTION,
-                    AXIS2_HTTP_HEADER_CONNECTION_CLOSE);
+                    AXIS2_HTTP_HEADER_CONNECTION_KEEPALIVE);
 
                 axis2_http_simple_response_set_header(simple_response, env,
                                                       header);
-                axis2_simple_http_svr_conn_set_keep_alive(svr_conn, env,
-                                                          AXIS2_FALSE);
             }
         }
-        else
-        {   /* Connection Header not available */
-            axis2_char_t *http_version = NULL;
-            http_version = 
-                axis2_http_simple_response_get_http_version(simple_response, env);
-            if (http_version && axutil_strcasecmp(http_version,
-                                                  AXIS2_HTTP_HEADER_PROTOCOL_11))
-            {
-                axis2_simple_http_svr_conn_set_keep_alive(svr_conn, env,
-                                                          AXIS2_TRUE);
-            }
-            else
-            {
-                axis2_simple_http_svr_conn_set_keep_alive(svr_conn, env,
-                                                          AXIS2_FALSE);
-            }
+        else if (http_11 || conn_header)
+        {
+            axis2_http_header_t *header = axis2_http_header_create(
+                env,
+                AXIS2_HTTP_HEADER_CONNECTION,
+                AXIS2_HTTP_HEADER_CONNECTION_CLOSE);
+
+            axis2_http_simple_response_set_header(simple_response, env,
+                                                  header);
         }
 
         if(!axis2_http_simple_response_contains_header(simple_response, env, 
@@ -25,13 +25,82 @@
 #include <axis2_http_simple_response.h>
 #include <axis2_http_transport_utils.h>
 
+#define AXIS2_SIMPLE_HTTP_SVR_CONN_BUF_SIZE 8192
+
+/* how far the body of the current request has been read */
+#define AXIS2_SVR_CONN_BODY_DONE 0
+#define AXIS2_SVR_CONN_BODY_LENGTH 1
+#define AXIS2_SVR_CONN_BODY_UNTIL_CLOSE 2
+#define AXIS2_SVR_CONN_BODY_CHUNK_SIZE 3
+#define AXIS2_SVR_CONN_BODY_CHUNK_DATA 4
+#define AXIS2_SVR_CONN_BODY_CHUNK_END 5
+#define AXIS2_SVR_CONN_BODY_TRAILER 6
+#define AXIS2_SVR_CONN_BODY_BROKEN 7
+
+/**
+ * Stream given to requests as their body. It reads from the connection without
+ * going past the end of the body, as told by the Content-Length or the chunked
+ * framing of the request, so that the connection can carry the next request.
+ * Chunked bodies are passed on as they are, the framing is only followed.
+ */
+typedef struct axis2_simple_http_svr_conn_body
+{
+    axutil_stream_t stream;
+    struct axis2_simple_http_svr_conn *svr_conn;
+    int state;
+    /* bytes left in the body or in the current chunk */
+    int remaining;
+    /* length of the current trailer line */
+    int line_len;
+    axis2_bool_t in_extension;
+} axis2_simple_http_svr_conn_body_t;
+
 struct axis2_simple_http_svr_conn
 {
     int socket;
     axutil_stream_t *stream;
+    /* whether the socket and the stream are closed with the connection */
+    axis2_bool_t owns_socket;
     axis2_bool_t keep_alive;
+    axis2_simple_http_svr_conn_body_t *body;
+    int rcv_timeout;
+    int requests;
+    int max_requests;
+    /* requests in a row that were sent before the previous was answered */
+    int pipelined;
+    int max_pipeline_depth;
+    /* bytes read from the socket and not used yet */
+    int buf_pos;
+    int buf_len;
+    axis2_char_t buf[AXIS2_SIMPLE_HTTP_SVR_CONN_BUF_SIZE];
 };
 
+static int AXIS2_CALL
+axis2_simple_http_svr_conn_body_read(
+    axutil_stream_t * stream,
+    const axutil_env_t * env,
+    void *buffer,
+    size_t count);
+
+static int AXIS2_CALL
+axis2_simple_http_svr_conn_body_write(
+    axutil_stream_t * stream,
+    const axutil_env_t * env,
+    const void *buffer,
+    size_t count);
+
+static int AXIS2_CALL
+axis2_simple_http_svr_conn_body_skip(
+    axutil_stream_t * stream,
+    const axutil_env_t * env,
+    int count);
+
+static void
+axis2_simple_http_svr_conn_frame_body(
+    axis2_simple_http_svr_conn_t * svr_conn,
+    const axutil_env_t * env,
+    axis2_http_simple_request_t * request);
+
 AXIS2_EXTERN axis2_simple_http_svr_conn_t *AXIS2_CALL
 axis2_simple_http_svr_conn_create(
     const axutil_env_t * env,
@@ -50,7 +119,10 @@ axis2_simple_http_svr_conn_create(
     memset ((void *)svr_conn, 0, sizeof (axis2_simple_http_svr_conn_t));
     svr_conn->socket = sockfd;
     svr_conn->stream = NULL;
+    svr_conn->owns_socket = AXIS2_TRUE;
     svr_conn->keep_alive = AXIS2_FALSE;
+    svr_conn->max_requests = 1;
+    svr_conn->max_pipeline_depth = AXIS2_HTTP_DEFAULT_MAX_PIPELINE_DEPTH;
 
     if (-1 != svr_conn->socket)
     {
@@ -63,10 +135,57 @@ axis2_simple_http_svr_conn_create(
                                             svr_conn, env);
             return NULL;
         }
+
+        svr_conn->body = (axis2_simple_http_svr_conn_body_t *)
+            AXIS2_MALLOC(env->allocator, sizeof(axis2_simple_http_svr_conn_body_t));
+        if (!svr_conn->body)
+        {
+            AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+            axis2_simple_http_svr_conn_free(svr_conn, env);
+            return NULL;
+        }
+        memset ((void *)svr_conn->body, 0, sizeof (axis2_simple_http_svr_conn_body_t));
+        svr_conn->body->stream.stream_type = AXIS2_STREAM_MANAGED;
+        svr_conn->body->svr_conn = svr_conn;
+        svr_conn->body->state = AXIS2_SVR_CONN_BODY_DONE;
+        axutil_stream_set_read(&(svr_conn->body->stream), env,
+                               axis2_simple_http_svr_conn_body_read);
+        axutil_stream_set_write(&(svr_conn->body->stream), env,
+                                axis2_simple_http_svr_conn_body_write);
+        axutil_stream_set_skip(&(svr_conn->body->stream), env,
+                               axis2_simple_http_svr_conn_body_skip);
     }
     return svr_conn;
 }
 
+AXIS2_EXTERN axis2_simple_http_svr_conn_t *AXIS2_CALL
+axis2_simple_http_svr_conn_create_with_stream(
+    const axutil_env_t * env,
+    int sockfd,
+    axutil_stream_t * stream)
+{
+    axis2_simple_http_svr_conn_t *svr_conn = NULL;
+
+    svr_conn = (axis2_simple_http_svr_conn_t *)
+        AXIS2_MALLOC(env->allocator, sizeof(axis2_simple_http_svr_conn_t));
+
+    if (!svr_conn)
+    {
+        AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+    memset ((void *)svr_conn, 0, sizeof (axis2_simple_http_svr_conn_t));
+    svr_conn->socket = sockfd;
+    svr_conn->stream = stream;
+    svr_conn->owns_socket = AXIS2_FALSE;
+    svr_conn->keep_alive = AXIS2_FALSE;
+    /* the response is framed by the stream it is copied to, so it may be
+       kept alive and given a Content-Length */
+    svr_conn->max_requests = 1;
+    svr_conn->max_pipeline_depth = AXIS2_HTTP_DEFAULT_MAX_PIPELINE_DEPTH;
+    return svr_conn;
+}
+
 AXIS2_EXTERN void AXIS2_CALL
 axis2_simple_http_svr_conn_free(
     axis2_simple_http_svr_conn_t * svr_conn,
@@ -78,6 +197,10 @@ axis2_simple_http_svr_conn_free(
     }
 
     axis2_simple_http_svr_conn_close(svr_conn, env);
+    if (svr_conn->body)
+    {
+        AXIS2_FREE(env->allocator, svr_conn->body);
+    }
     AXIS2_FREE(env->allocator, svr_conn);
 
     return;
@@ -88,7 +211,17 @@ axis2_simple_http_svr_conn_close(
     axis2_simple_http_svr_conn_t * svr_conn,
     const axutil_env_t * env)
 {
-    axutil_stream_free(svr_conn->stream, env);
+    if (!svr_conn->owns_socket)
+    {
+        svr_conn->stream = NULL;
+        svr_conn->socket = -1;
+        return AXIS2_SUCCESS;
+    }
+    if (svr_conn->stream)
+    {
+        axutil_stream_free(svr_conn->stream, env);
+        svr_conn->stream = NULL;
+    }
     if (-1 != svr_conn->socket)
     {
         axutil_network_handler_close_socket(env, svr_conn->socket);
@@ -117,7 +250,30 @@ axis2_simple_http_svr_conn_set_keep_alive(
     const axutil_env_t * env,
     axis2_bool_t keep_alive)
 {
-    svr_conn->keep_alive = keep_alive;
+    /* past the limit of requests the connection is closed anyway */
+    svr_conn->keep_alive = keep_alive &&
+        svr_conn->requests < svr_conn->max_requests &&
+        svr_conn->pipelined < svr_conn->max_pipeline_depth;
+    return AXIS2_SUCCESS;
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_simple_http_svr_conn_set_max_pipeline_depth(
+    axis2_simple_http_svr_conn_t * svr_conn,
+    const axutil_env_t * env,
+    int max_pipeline_depth)
+{
+    svr_conn->max_pipeline_depth = max_pipeline_depth;
+    return AXIS2_SUCCESS;
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_simple_http_svr_conn_set_max_requests(
+    axis2_simple_http_svr_conn_t * svr_conn,
+    const axutil_env_t * env,
+    int max_requests)
+{
+    svr_conn->max_requests = max_requests;
     return AXIS2_SUCCESS;
 }
 
@@ -149,68 +305,139 @@ axis2_simple_http_svr_conn_get_writer(
 }
 
 
-AXIS2_EXTERN axis2_http_simple_request_t *AXIS2_CALL
-axis2_simple_http_svr_conn_read_request(
+/* Returns the number of bytes buffered, reading more from the socket when
+   there are none */
+static int
+axis2_simple_http_svr_conn_fill(
     axis2_simple_http_svr_conn_t * svr_conn,
     const axutil_env_t * env)
 {
-    axis2_char_t* str_line = NULL;
-    axis2_char_t tmp_buf[2048];
-    int read = -1;
-    axis2_bool_t end_of_line = AXIS2_FALSE;
-    axis2_bool_t end_of_headers = AXIS2_FALSE;
-    axis2_http_request_line_t *request_line = NULL;
-    axis2_http_simple_request_t *request = NULL;
+    int len = svr_conn->buf_len - svr_conn->buf_pos;
+
+    if (len <= 0)
+    {
+        len = axutil_stream_read(svr_conn->stream, env, svr_conn->buf,
+                                 AXIS2_SIMPLE_HTTP_SVR_CONN_BUF_SIZE);
+        svr_conn->buf_pos = 0;
+        svr_conn->buf_len = len > 0 ? len : 0;
+    }
+    return len;
+}
 
-    while ((read =
-            axutil_stream_peek_socket(svr_conn->stream, env, tmp_buf,
-                                      2048 - 1)) > 0)
+/* Reads from the connection, taking the bytes already buffered first. The
+   buffer keeps what is read past the current request for the next one. */
+static int
+axis2_simple_http_svr_conn_read_buffered(
+    axis2_simple_http_svr_conn_t * svr_conn,
+    const axutil_env_t * env,
+    axis2_char_t * buffer,
+    int count,
+    axis2_bool_t to_line_end)
+{
+    axis2_char_t *start = NULL;
+    axis2_char_t *end = NULL;
+    int len = 0;
+
+    /* large reads go straight to the caller */
+    if (!to_line_end && svr_conn->buf_pos >= svr_conn->buf_len &&
+        count >= AXIS2_SIMPLE_HTTP_SVR_CONN_BUF_SIZE)
+    {
+        return axutil_stream_read(svr_conn->stream, env, buffer, count);
+    }
+    len = axis2_simple_http_svr_conn_fill(svr_conn, env);
+    if (len <= 0)
+    {
+        return len;
+    }
+    start = svr_conn->buf + svr_conn->buf_pos;
+    if (to_line_end && (end = memchr(start, '\n', len)))
+    {
+        len = (int)(end - start) + 1;
+    }
+    if (len > count)
+    {
+        len = count;
+    }
+    memcpy(buffer, start, len);
+    svr_conn->buf_pos += len;
+    return len;
+}
+
+/* Reads a line of the request head, returns it with its line end */
+static axis2_char_t *
+axis2_simple_http_svr_conn_read_line(
+    axis2_simple_http_svr_conn_t * svr_conn,
+    const axutil_env_t * env)
+{
+    axis2_char_t *str_line = NULL;
+    int line_len = 0;
+
+    while (1)
     {
-        axis2_char_t *start = tmp_buf;
+        axis2_char_t *start = NULL;
         axis2_char_t *end = NULL;
-        tmp_buf[read] = AXIS2_ESC_NULL;
-        end = strstr(tmp_buf, AXIS2_HTTP_CRLF);
+        axis2_char_t *tmp_str_line = NULL;
+        int len = 0;
+
+        len = axis2_simple_http_svr_conn_fill(svr_conn, env);
+        if (len <= 0)
+        {
+            break;
+        }
+        start = svr_conn->buf + svr_conn->buf_pos;
+        end = memchr(start, '\n', len);
         if (end)
         {
-            read =
-                axutil_stream_read(svr_conn->stream, env, tmp_buf,
-                                   end - start + 2);
-            if (read > 0)
-            {
-                axis2_char_t* tmp_str_line = NULL;
-                tmp_buf[read] = AXIS2_ESC_NULL;
-                tmp_str_line = axutil_stracat(env, str_line, tmp_buf);
-                if(tmp_str_line)
-                {
-                    AXIS2_FREE(env->allocator, str_line);
-                    str_line = tmp_str_line;
-                }
-                break;
-            }
-            else
-            {
-                /* read returns 0 or negative value, this could be an error */
-                break;
-            }
+            len = (int)(end - start) + 1;
         }
-        else
+
+        tmp_str_line = AXIS2_MALLOC(env->allocator, line_len + len + 1);
+        if (!tmp_str_line)
         {
-            /* not reached end yet */
-            read = axutil_stream_read(svr_conn->stream, env, tmp_buf, 2048 - 1);
-            if (read > 0)
-            {
-                axis2_char_t* tmp_str_line = NULL;
-                tmp_buf[read] = AXIS2_ESC_NULL;
-                tmp_str_line = axutil_stracat(env, str_line, tmp_buf);
-                if(tmp_str_line)
-                {
-                    AXIS2_FREE(env->allocator, str_line);
-                    str_line = tmp_str_line;
-                }
-            }
+            AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+            break;
+        }
+        if (str_line)
+        {
+            memcpy(tmp_str_line, str_line, line_len);
+            AXIS2_FREE(env->allocator, str_line);
+        }
+        memcpy(tmp_str_line + line_len, start, len);
+        line_len += len;
+        tmp_str_line[line_len] = AXIS2_ESC_NULL;
+        str_line = tmp_str_line;
+        svr_conn->buf_pos += len;
+
+        if (end)
+        {
+            return str_line;
         }
     }
 
+    /* the connection ended in the middle of a line */
+    if (str_line)
+    {
+        AXIS2_FREE(env->allocator, str_line);
+    }
+    return NULL;
+}
+
+AXIS2_EXTERN axis2_http_simple_request_t *AXIS2_CALL
+axis2_simple_http_svr_conn_read_request(
+    axis2_simple_http_svr_conn_t * svr_conn,
+    const axutil_env_t * env)
+{
+    axis2_char_t* str_line = NULL;
+    axis2_http_request_line_t *request_line = NULL;
+    axis2_http_simple_request_t *request = NULL;
+
+    svr_conn->keep_alive = AXIS2_FALSE;
+    if (svr_conn->body)
+    {
+        svr_conn->body->state = AXIS2_SVR_CONN_BODY_DONE;
+    }
+
+    str_line = axis2_simple_http_svr_conn_read_line(svr_conn, env);
     request_line = axis2_http_request_line_parse_line(env, str_line);
     AXIS2_FREE(env->allocator, str_line);
     str_line = NULL;
@@ -222,95 +449,338 @@ axis2_simple_http_svr_conn_read_request(
                         AXIS2_FAILURE);
         return NULL;
     }
+    svr_conn->requests++;
     request = axis2_http_simple_request_create(env, request_line, NULL, 0,
+                                               svr_conn->body ?
+                                               &(svr_conn->body->stream) :
                                                svr_conn->stream);
     /* now read the headers */
-    end_of_line = AXIS2_FALSE;
-    while (AXIS2_FALSE == end_of_headers)
+    while ((str_line = axis2_simple_http_svr_conn_read_line(svr_conn, env)))
     {
-        axis2_bool_t is_read = AXIS2_FALSE;
-        while ((read =
-                axutil_stream_peek_socket(svr_conn->stream, env, tmp_buf,
-                                          2048 - 1)) > 0)
+        axis2_http_header_t *tmp_header = NULL;
+
+        if (0 == axutil_strcmp(str_line, AXIS2_HTTP_CRLF))
         {
-            axis2_char_t *start = tmp_buf;
-            axis2_char_t *end = NULL;
-            is_read = AXIS2_TRUE;
-            tmp_buf[read] = AXIS2_ESC_NULL;
-            end = strstr(tmp_buf, AXIS2_HTTP_CRLF);
-            if (end)
+            break;
+        }
+        tmp_header = axis2_http_header_create_by_str(env, str_line);
+        AXIS2_FREE(env->allocator, str_line);
+        str_line = NULL;
+        if (tmp_header)
+        {
+            axis2_http_simple_request_add_header(request, env, tmp_header);
+        }
+    }
+
+    AXIS2_FREE(env->allocator, str_line);
+
+    if (svr_conn->body)
+    {
+        axis2_simple_http_svr_conn_frame_body(svr_conn, env, request);
+    }
+
+    return request;
+}
+
+AXIS2_EXTERN axis2_bool_t AXIS2_CALL
+axis2_simple_http_svr_conn_wait_for_request(
+    axis2_simple_http_svr_conn_t * svr_conn,
+    const axutil_env_t * env,
+    int timeout)
+{
+    axis2_char_t c;
+    int read = -1;
+
+    /* a request sent before the previous one was answered is pipelined */
+    if (svr_conn->buf_pos < svr_conn->buf_len
+#ifdef MSG_DONTWAIT
+        || recv(svr_conn->socket, &c, 1, MSG_PEEK | MSG_DONTWAIT) > 0
+#endif
+        )
+    {
+        svr_conn->pipelined++;
+        return AXIS2_TRUE;
+    }
+    svr_conn->pipelined = 0;
+
+    if (timeout != svr_conn->rcv_timeout)
+    {
+        axutil_network_handler_set_sock_option(env, svr_conn->socket,
+                                               SO_RCVTIMEO, timeout);
+    }
+    read = axutil_stream_peek_socket(svr_conn->stream, env, &c, 1);
+    if (timeout != svr_conn->rcv_timeout)
+    {
+        axutil_network_handler_set_sock_option(env, svr_conn->socket,
+                                               SO_RCVTIMEO,
+                                               svr_conn->rcv_timeout);
+    }
+    return read > 0 ? AXIS2_TRUE : AXIS2_FALSE;
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_simple_http_svr_conn_drain_body(
+    axis2_simple_http_svr_conn_t * svr_conn,
+    const axutil_env_t * env)
+{
+    axis2_char_t tmp_buf[2048];
+
+    if (!svr_conn->body ||
+        AXIS2_SVR_CONN_BODY_UNTIL_CLOSE == svr_conn->body->state)
+    {
+        return AXIS2_FAILURE;
+    }
+    while (axis2_simple_http_svr_conn_body_read(&(svr_conn->body->stream), env,
+                                                tmp_buf, sizeof(tmp_buf)) > 0)
+    {
+        /* skipping what the service did not read */
+    }
+    return AXIS2_SVR_CONN_BODY_DONE == svr_conn->body->state ?
+        AXIS2_SUCCESS : AXIS2_FAILURE;
+}
+
+/* Sets up the body stream for the framing of a request just read */
+static void
+axis2_simple_http_svr_conn_frame_body(
+    axis2_simple_http_svr_conn_t * svr_conn,
+    const axutil_env_t * env,
+    axis2_http_simple_request_t * request)
+{
+    axis2_simple_http_svr_conn_body_t *body = svr_conn->body;
+    axis2_http_header_t *encoding_header = NULL;
+    axis2_char_t *method = NULL;
+    int content_length = -1;
+
+    body->remaining = 0;
+    body->line_len = 0;
+    body->in_extension = AXIS2_FALSE;
+    encoding_header = axis2_http_simple_request_get_first_header(request, env,
+        AXIS2_HTTP_HEADER_TRANSFER_ENCODING);
+    if (encoding_header &&
+        axutil_strcasestr(axis2_http_header_get_value(encoding_header, env),
+                          AXIS2_HTTP_HEADER_TRANSFER_ENCODING_CHUNKED))
+    {
+        body->state = AXIS2_SVR_CONN_BODY_CHUNK_SIZE;
+        return;
+    }
+
+    content_length = axis2_http_simple_request_get_content_length(request, env);
+    if (content_length > 0)
+    {
+        body->state = AXIS2_SVR_CONN_BODY_LENGTH;
+        body->remaining = content_length;
+        return;
+    }
+
+    /* a request has no body unless it is framed, except that a POST or a
+       PUT without framing may still send one and close the connection */
+    method = axis2_http_request_line_get_method(
+        axis2_http_simple_request_get_request_line(request, env), env);
+    if (content_length < 0 && method &&
+        (0 == axutil_strcasecmp(method, AXIS2_HTTP_POST) ||
+         0 == axutil_strcasecmp(method, AXIS2_HTTP_PUT)))
+    {
+        body->state = AXIS2_SVR_CONN_BODY_UNTIL_CLOSE;
+        return;
+    }
+    body->state = AXIS2_SVR_CONN_BODY_DONE;
+}
+
+/* Follows the chunked framing over bytes read from a framing line */
+static void
+axis2_simple_http_svr_conn_body_scan_line(
+    axis2_simple_http_svr_conn_body_t * body,
+    const axis2_char_t * buf,
+    int len)
+{
+    int i = 0;
+
+    for (i = 0; i < len && AXIS2_SVR_CONN_BODY_BROKEN != body->state; i++)
+    {
+        axis2_char_t c = buf[i];
+
+        if ('\n' == c)
+        {
+            if (AXIS2_SVR_CONN_BODY_CHUNK_SIZE == body->state)
             {
-                read =
-                    axutil_stream_read(svr_conn->stream, env, tmp_buf,
-                                       end - start + 2);
-                if (read > 0)
-                {
-		    axis2_char_t* tmp_str_line = NULL;
-                    tmp_buf[read] = AXIS2_ESC_NULL;
-                    tmp_str_line = axutil_stracat(env, str_line, tmp_buf);
-                    if(tmp_str_line)
-                    {
-                        AXIS2_FREE(env->allocator, str_line);
-                        str_line = tmp_str_line;
-                    }
-                    end_of_line = AXIS2_TRUE;
-                    break;
-                }
-                else
-                {
-                    break;
-                }
+                body->state = body->remaining ? AXIS2_SVR_CONN_BODY_CHUNK_DATA :
+                    AXIS2_SVR_CONN_BODY_TRAILER;
+                body->in_extension = AXIS2_FALSE;
+                body->line_len = 0;
             }
-            else
+            else if (AXIS2_SVR_CONN_BODY_CHUNK_END == body->state)
             {
-                read =
-                    axutil_stream_read(svr_conn->stream, env, tmp_buf,
-                                       2048 - 1);
-                if (read > 0)
-                {
-		    axis2_char_t* tmp_str_line = NULL;
-                    tmp_buf[read] = AXIS2_ESC_NULL;
-                    tmp_str_line = axutil_stracat(env, str_line, tmp_buf);
-                    if(tmp_str_line)
-                    {
-                        AXIS2_FREE(env->allocator, str_line);
-                        str_line = tmp_str_line;
-                    }
-                }
+                body->state = AXIS2_SVR_CONN_BODY_CHUNK_SIZE;
             }
-
+            else if (0 == body->line_len)
+            {
+                /* the empty line closing the trailer */
+                body->state = AXIS2_SVR_CONN_BODY_DONE;
+            }
+            body->line_len = 0;
+            continue;
         }
-
-        if (AXIS2_TRUE == end_of_line)
+        if ('\r' == c)
+        {
+            continue;
+        }
+        body->line_len++;
+        if (AXIS2_SVR_CONN_BODY_CHUNK_SIZE == body->state && !body->in_extension)
         {
-            if (0 == axutil_strcmp(str_line, AXIS2_HTTP_CRLF))
+            int digit = -1;
+
+            if (c >= '0' && c <= '9')
+                digit = c - '0';
+            else if (c >= 'a' && c <= 'f')
+                digit = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                digit = c - 'A' + 10;
+
+            if (digit < 0)
             {
-                end_of_headers = AXIS2_TRUE;
+                body->in_extension = AXIS2_TRUE;
+            }
+            else if (body->remaining >= 0x8000000)
+            {
+                /* no chunk of 2GB or more */
+                body->state = AXIS2_SVR_CONN_BODY_BROKEN;
             }
             else
             {
-                axis2_http_header_t *tmp_header =
-                    axis2_http_header_create_by_str(env, str_line);
-                AXIS2_FREE(env->allocator, str_line);
-                str_line = NULL;
-                if (tmp_header)
-                {
-                    axis2_http_simple_request_add_header(request, env,
-                                                         tmp_header);
-                }
+                body->remaining = body->remaining * 16 + digit;
             }
         }
-        end_of_line = AXIS2_FALSE;
-        if(!is_read)
+    }
+}
+
+static int AXIS2_CALL
+axis2_simple_http_svr_conn_body_read(
+    axutil_stream_t * stream,
+    const axutil_env_t * env,
+    void *buffer,
+    size_t count)
+{
+    axis2_simple_http_svr_conn_body_t *body =
+        (axis2_simple_http_svr_conn_body_t *) stream;
+    axis2_bool_t line = AXIS2_FALSE;
+    int len = 0;
+
+    switch (body->state)
+    {
+    case AXIS2_SVR_CONN_BODY_DONE:
+    case AXIS2_SVR_CONN_BODY_BROKEN:
+        return 0;
+    case AXIS2_SVR_CONN_BODY_UNTIL_CLOSE:
+        break;
+    case AXIS2_SVR_CONN_BODY_LENGTH:
+    case AXIS2_SVR_CONN_BODY_CHUNK_DATA:
+        if (count > (size_t) body->remaining)
         {
-            /*if nothing is read, this loop should be broken. Otherwise, going to be endless loop */
-            break; 
+            count = body->remaining;
         }
+        break;
+    default:
+        /* a framing line, read no further than its end */
+        line = AXIS2_TRUE;
     }
 
-    AXIS2_FREE(env->allocator, str_line);
+    len = axis2_simple_http_svr_conn_read_buffered(body->svr_conn, env, buffer,
+                                                   (int) count, line);
+    if (len <= 0)
+    {
+        if (AXIS2_SVR_CONN_BODY_UNTIL_CLOSE != body->state)
+        {
+            body->state = AXIS2_SVR_CONN_BODY_BROKEN;
+        }
+        return len;
+    }
 
-    return request;
+    switch (body->state)
+    {
+    case AXIS2_SVR_CONN_BODY_UNTIL_CLOSE:
+        break;
+    case AXIS2_SVR_CONN_BODY_LENGTH:
+        body->remaining -= len;
+        if (!body->remaining)
+        {
+            body->state = AXIS2_SVR_CONN_BODY_DONE;
+        }
+        break;
+    case AXIS2_SVR_CONN_BODY_CHUNK_DATA:
+        body->remaining -= len;
+        if (!body->remaining)
+        {
+            body->state = AXIS2_SVR_CONN_BODY_CHUNK_END;
+        }
+        break;
+    default:
+        axis2_simple_http_svr_conn_body_scan_line(body, buffer, len);
+    }
+    return len;
+}
+
+static int AXIS2_CALL
+axis2_simple_http_svr_conn_body_write(
+    axutil_stream_t * stream,
+    const axutil_env_t * env,
+    const void *buffer,
+    size_t count)
+{
+    /* the response is written to the connection stream */
+    return -1;
+}
+
+static int AXIS2_CALL
+axis2_simple_http_svr_conn_body_skip(
+    axutil_stream_t * stream,
+    const axutil_env_t * env,
+    int count)
+{
+    axis2_char_t tmp_buf[2048];
+    int skipped = 0;
+
+    while (skipped < count)
+    {
+        int len = axis2_simple_http_svr_conn_body_read(stream, env, tmp_buf,
+            count - skipped < (int) sizeof(tmp_buf) ? count - skipped :
+            (int) sizeof(tmp_buf));
+        if (len <= 0)
+        {
+            break;
+        }
+        skipped += len;
+    }
+    return skipped;
+}
+
+AXIS2_EXTERN int AXIS2_CALL
+axis2_simple_http_svr_conn_take_buffered(
+    axis2_simple_http_svr_conn_t * svr_conn,
+    const axutil_env_t * env,
+    axis2_char_t * buffer,
+    int size)
+{
+    int len = svr_conn->buf_len - svr_conn->buf_pos;
+
+    if (len > size)
+    {
+        len = size;
+    }
+    if (len <= 0)
+    {
+        return 0;
+    }
+    memcpy(buffer, svr_conn->buf + svr_conn->buf_pos, len);
+    svr_conn->buf_pos += len;
+    return len;
+}
+
+AXIS2_EXTERN int AXIS2_CALL
+axis2_simple_http_svr_conn_get_socket(
+    const axis2_simple_http_svr_conn_t * svr_conn,
+    const axutil_env_t * env)
+{
+    return svr_conn->socket;
 }
 
 AXIS2_EXTERN axis2_status_t AXIS2_CALL
@@ -379,6 +849,25 @@ axis2_simple_http_svr_conn_write_response(
         response_writer = NULL;
         return AXIS2_FAILURE;
     }
+    response_stream = axis2_http_simple_response_get_body(response, env);
+    if (response_stream)
+    {
+        body_size = axutil_stream_get_len(response_stream, env);
+    }
+
+    /* on a connection kept open the client needs the length of the body */
+    if (svr_conn->keep_alive && !chuked_encoding && !binary_content &&
+        !axis2_http_simple_response_contains_header(response, env,
+                                                    AXIS2_HTTP_HEADER_CONTENT_LENGTH))
+    {
+        axis2_char_t content_len_str[16];
+
+        sprintf(content_len_str, "%d", body_size > 0 ? body_size : 0);
+        axis2_http_simple_response_set_header(response, env,
+            axis2_http_header_create(env, AXIS2_HTTP_HEADER_CONTENT_LENGTH,
+                                     content_len_str));
+    }
+
     axis2_http_response_writer_print_str(response_writer, env, status_line);
     headers = axis2_http_simple_response_get_headers(response, env);
 
@@ -402,10 +891,8 @@ axis2_simple_http_svr_conn_write_response(
     }
     axis2_http_response_writer_println(response_writer, env);
 
-    response_stream = axis2_http_simple_response_get_body(response, env);
     if (response_stream)
     {
-        body_size = axutil_stream_get_len(response_stream, env);
         response_body = axutil_stream_get_buffer(response_stream, env);
         axutil_stream_flush_buffer(response_stream, env);
         response_body[body_size] = AXIS2_ESC_NULL;
@@ -421,19 +908,13 @@ axis2_simple_http_svr_conn_write_response(
     if (AXIS2_FALSE == chuked_encoding && !binary_content)
     {
         axis2_status_t write_stat = AXIS2_FAILURE;
-        if (AXIS2_FALSE == binary_content)
-        {
-            write_stat = axis2_http_response_writer_println_str(response_writer,
-                                                                env,
-                                                                response_body);
-        }
-        else
-        {
-            write_stat = axis2_http_response_writer_write_buf(response_writer,
-                                                              env,
-                                                              response_body, 0,
-                                                              body_size);
-        }
+
+        /* exactly the body, anything after it would be taken for the start
+           of the next response */
+        write_stat = axis2_http_response_writer_write_buf(response_writer,
+                                                          env,
+                                                          response_body, 0,
+                                                          body_size);
 
         if (AXIS2_SUCCESS != write_stat)
         {
@@ -519,6 +1000,7 @@ axis2_simple_http_svr_conn_set_rcv_timeout(
     const axutil_env_t * env,
     int timeout)
 {
+    svr_conn->rcv_timeout = timeout;
     return axutil_network_handler_set_sock_option(env,
                                                   svr_conn->socket, SO_RCVTIMEO,
                                                   timeout);
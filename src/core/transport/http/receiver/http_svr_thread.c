@@ -24,12 +24,19 @@
 #include <axutil_network_handler.h>
 #include <axis2_http_simple_request.h>
 #include <axis2_simple_http_svr_conn.h>
+#include <axis2_http2_svr_conn.h>
 #include <axutil_url.h>
 #include <axutil_error_default.h>
 #include <axiom_xml_reader.h>
 #include <signal.h>
 
 AXIS2_EXPORT int axis2_http_socket_read_timeout = AXIS2_HTTP_DEFAULT_SO_TIMEOUT;
+AXIS2_EXPORT int axis2_http_keep_alive_timeout = AXIS2_HTTP_DEFAULT_KEEP_ALIVE_TIMEOUT;
+AXIS2_EXPORT int axis2_http_keep_alive_max_requests =
+    AXIS2_HTTP_DEFAULT_KEEP_ALIVE_MAX_REQUESTS;
+AXIS2_EXPORT int axis2_http_max_pipeline_depth = AXIS2_HTTP_DEFAULT_MAX_PIPELINE_DEPTH;
+AXIS2_EXPORT int axis2_http2_max_concurrent_streams =
+    AXIS2_HTTP_DEFAULT_HTTP2_MAX_STREAMS;
 
 struct axis2_http_svr_thread
 {
@@ -215,26 +222,76 @@ axis2_http_svr_thread_set_worker(
     return AXIS2_SUCCESS;
 }
 
+static axis2_status_t
+axis2_http_svr_thread_serve(
+    const axutil_env_t * env,
+    axis2_http_worker_t * worker,
+    axis2_simple_http_svr_conn_t * svr_conn,
+    axis2_http_simple_request_t * request)
+{
+    struct AXIS2_PLATFORM_TIMEB t1,
+     t2;
+    int millisecs = 0;
+    double secs = 0;
+    axis2_status_t status = AXIS2_FAILURE;
+
+    AXIS2_PLATFORM_GET_TIME_IN_MILLIS(&t1);
+    status = axis2_http_worker_process_request(worker, env, svr_conn,
+                                               request);
+    AXIS2_PLATFORM_GET_TIME_IN_MILLIS(&t2);
+    millisecs = t2.millitm - t1.millitm;
+    secs = difftime(t2.time, t1.time);
+    if (millisecs < 0)
+    {
+        millisecs += 1000;
+        secs--;
+    }
+    secs += millisecs / 1000.0;
+
+    if (status == AXIS2_SUCCESS)
+    {
+#if defined(WIN32)
+        AXIS2_LOG_INFO(env->log, "Request served successfully");
+#else
+        AXIS2_LOG_INFO(env->log, "Request served in %.3f seconds", secs);
+#endif
+    }
+    else
+    {
+#if defined(WIN32)
+        AXIS2_LOG_WARNING(env->log, AXIS2_LOG_SI,
+                          "Error occured in processing request ");
+#else
+        AXIS2_LOG_WARNING(env->log, AXIS2_LOG_SI,
+                          "Error occured in processing request (%.3f seconds)",
+                          secs);
+#endif
+    }
+    return status;
+}
+
 /**
- * Thread worker function.
+ * Thread worker function. Serves the requests of a connection for as long
+ * as the client keeps it alive, up to axis2_http_keep_alive_max_requests
+ * requests, and closes it when idle for axis2_http_keep_alive_timeout.
+ * Pipelined requests are served one after the other, so responses go out in
+ * the order of the requests. A client starting with the HTTP/2 preface or
+ * asking for an upgrade to h2c is served in HTTP/2 from there on.
  */
 void *AXIS2_THREAD_FUNC
 axis2_svr_thread_worker_func(
     axutil_thread_t * thd,
     void *data)
 {
-    struct AXIS2_PLATFORM_TIMEB t1,
-     t2;
     axis2_simple_http_svr_conn_t *svr_conn = NULL;
     axis2_http_simple_request_t *request = NULL;
-    int millisecs = 0;
-    double secs = 0;
     axis2_http_worker_t *tmp = NULL;
-    axis2_status_t status = AXIS2_FAILURE;
     axutil_env_t *env = NULL;
     axis2_socket_t socket;
     axutil_env_t *thread_env = NULL;
     axis2_http_svr_thd_args_t *arg_list = NULL;
+    int max_requests = 1;
+    int served = 0;
 
 #ifndef WIN32
 #ifdef AXIS2_SVR_MULTI_THREADED
@@ -247,63 +304,93 @@ axis2_svr_thread_worker_func(
     {
         return NULL;
     }
-    AXIS2_PLATFORM_GET_TIME_IN_MILLIS(&t1);
     env = arg_list->env;
-    thread_env = axutil_init_thread_env(env);
+    thread_env = axutil_get_thread_env(env);
     socket = arg_list->socket;
-    svr_conn = axis2_simple_http_svr_conn_create(thread_env, (int)socket);
-    axis2_simple_http_svr_conn_set_rcv_timeout(svr_conn, thread_env,
-                                               axis2_http_socket_read_timeout);
-    request = axis2_simple_http_svr_conn_read_request(svr_conn, thread_env);
     tmp = arg_list->worker;
-    status = axis2_http_worker_process_request(tmp, thread_env, svr_conn,
-                                               request);
-    axis2_simple_http_svr_conn_free(svr_conn, thread_env);
-    if (request)
-        axis2_http_simple_request_free(request, thread_env);
-    AXIS2_PLATFORM_GET_TIME_IN_MILLIS(&t2);
-    millisecs = t2.millitm - t1.millitm;
-    secs = difftime(t2.time, t1.time);
-    if (millisecs < 0)
+
+#ifdef AXIS2_SVR_MULTI_THREADED
+    /* a single threaded server cannot wait on one client */
+    if (axis2_http_keep_alive_timeout > 0 && axis2_http_keep_alive_max_requests > 1)
     {
-        millisecs += 1000;
-        secs--;
+        max_requests = axis2_http_keep_alive_max_requests;
     }
-    secs += millisecs / 1000.0;
+#endif
 
-    if (status == AXIS2_SUCCESS)
+    svr_conn = axis2_simple_http_svr_conn_create(thread_env, (int)socket);
+    if (svr_conn)
     {
-#if defined(WIN32)
-        AXIS2_LOG_INFO(thread_env->log, "Request served successfully");
-#else
-        AXIS2_LOG_INFO(thread_env->log, "Request served in %.3f seconds", secs);
-#endif
+        axis2_simple_http_svr_conn_set_rcv_timeout(svr_conn, thread_env,
+                                                   axis2_http_socket_read_timeout);
+        axis2_simple_http_svr_conn_set_max_requests(svr_conn, thread_env,
+                                                    max_requests);
+        axis2_simple_http_svr_conn_set_max_pipeline_depth(svr_conn, thread_env,
+                                                          axis2_http_max_pipeline_depth);
     }
     else
     {
-#if defined(WIN32)
-        AXIS2_LOG_WARNING(thread_env->log, AXIS2_LOG_SI,
-                          "Error occured in processing request ");
-#else
-        AXIS2_LOG_WARNING(thread_env->log, AXIS2_LOG_SI,
-                          "Error occured in processing request (%.3f seconds)",
-                          secs);
-#endif
+        axutil_network_handler_close_socket(thread_env, socket);
     }
 
-    AXIS2_FREE(thread_env->allocator, arg_list);
+    while (svr_conn)
+    {
+        axis2_bool_t keep_alive = AXIS2_FALSE;
 
-    if (thread_env)
+        if (served && !axis2_simple_http_svr_conn_wait_for_request(
+                svr_conn, thread_env, axis2_http_keep_alive_timeout))
+        {
+            break;
+        }
+        request = axis2_simple_http_svr_conn_read_request(svr_conn, thread_env);
+#ifndef WIN32
+        if (request && axis2_http2_max_concurrent_streams > 0 &&
+            (axis2_http2_svr_conn_is_preface(thread_env, request) ||
+             axis2_http2_svr_conn_is_upgrade(thread_env, request)))
+        {
+            /* the streams are processed in threads of their own, a single
+               threaded server takes them one at a time */
+            axis2_http2_svr_conn_serve(thread_env, tmp, svr_conn, request,
+                                       axis2_http2_max_concurrent_streams,
+                                       axis2_http_keep_alive_max_requests,
+                                       axis2_http_keep_alive_timeout);
+            axis2_http_simple_request_free(request, thread_env);
+            break;
+        }
+#endif
+        axis2_http_svr_thread_serve(thread_env, tmp, svr_conn, request);
+        served++;
+
+        /* the service may leave part of the body unread */
+        keep_alive = request &&
+            axis2_simple_http_svr_conn_is_keep_alive(svr_conn, thread_env) &&
+            AXIS2_SUCCESS == axis2_simple_http_svr_conn_drain_body(svr_conn,
+                                                                   thread_env);
+        if (request)
+        {
+            axis2_http_simple_request_free(request, thread_env);
+            request = NULL;
+        }
+        if (!keep_alive)
+        {
+            break;
+        }
+        /* the next request starts without the errors of this one */
+        axutil_reset_thread_env(thread_env);
+    }
+
+    if (svr_conn)
     {
-        axutil_free_thread_env(thread_env);
-        thread_env = NULL;
+        axis2_simple_http_svr_conn_free(svr_conn, thread_env);
     }
 
+    AXIS2_FREE(thread_env->allocator, arg_list);
+
+    axutil_release_thread_env(thread_env);
+    thread_env = NULL;
+
 #ifdef AXIS2_SVR_MULTI_THREADED
     axutil_thread_pool_exit_thread(env->thread_pool, thd);
 #endif
 
     return NULL;
 }
-
-
@@ -0,0 +1,1433 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <axis2_http2_client.h>
+#include <axis2_http2.h>
+#include <axis2_http_transport.h>
+#include <axis2_http_header.h>
+#include <axis2_http_request_line.h>
+#include <axutil_string.h>
+#include <axutil_hash.h>
+#include <axutil_types.h>
+#include <axutil_thread.h>
+#include <axutil_thread_pool.h>
+#include <axutil_network_handler.h>
+#include <platforms/axutil_platform_auto_sense.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <poll.h>
+
+/* receive window of the streams and of the connection */
+#define AXIS2_HTTP2_CLIENT_WINDOW_SIZE (1 << 20)
+
+/* times a request the server did not process is sent */
+#define AXIS2_HTTP2_CLIENT_MAX_ATTEMPTS 3
+
+/* frames buffered past this are written before more are added */
+#define AXIS2_HTTP2_CLIENT_FLUSH_SIZE 65536
+
+/* a request and its response, owned by the thread sending it */
+typedef struct axis2_http2_exchange
+{
+    /* 0 until the request is sent */
+    int stream_id;
+    /* written to by the reader thread to wake the sending thread */
+    int wakeup[2];
+    axis2_bool_t waiting;
+    axis2_bool_t done;
+    /* not processed by the server, may be sent again */
+    axis2_bool_t refused;
+    axis2_bool_t reset;
+    int status;
+    axutil_array_list_t *headers;
+    axis2_char_t *body;
+    int body_len;
+    int body_size;
+    int send_window;
+    int recv_window;
+} axis2_http2_exchange_t;
+
+struct axis2_http2_client;
+
+typedef struct axis2_http2_client_conn
+{
+    struct axis2_http2_client *client;
+    axis2_char_t *key;
+    int socket;
+    axutil_env_t *thread_env;
+    /* guards all but the reader state, and the writes to the socket */
+    axutil_thread_mutex_t *mutex;
+    /* the reader thread and the threads sending on the connection */
+    int refs;
+    axis2_http2_frame_buf_t *out;
+    axutil_array_list_t *exchanges;
+    int next_stream_id;
+    int open_streams;
+    int send_window;
+    int recv_window;
+    /* from the settings of the server */
+    int max_streams;
+    int initial_window;
+    int max_frame_size;
+    /* no new streams, the server went away or the connection failed */
+    axis2_bool_t closed;
+    /* used by the reader thread only */
+    axis2_http2_frame_reader_t *reader;
+    axis2_http2_hpack_t *decoder;
+    int block_stream_id;
+    int block_flags;
+    unsigned char *block;
+    int block_len;
+    int block_size;
+} axis2_http2_client_conn_t;
+
+struct axis2_http2_client
+{
+    axutil_thread_mutex_t *mutex;
+    /* connections new streams go to, by host and port */
+    axutil_hash_t *conns;
+    /* connections whose reader thread runs */
+    axutil_array_list_t *running;
+    /* written to by a reader thread when it ends */
+    int wakeup[2];
+};
+
+AXIS2_EXTERN axis2_http2_client_t *AXIS2_CALL
+axis2_http2_client_create(
+    const axutil_env_t * env)
+{
+    axis2_http2_client_t *client = NULL;
+
+    client = AXIS2_MALLOC(env->allocator, sizeof(axis2_http2_client_t));
+    if (!client)
+    {
+        AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+    memset(client, 0, sizeof(axis2_http2_client_t));
+    client->wakeup[0] = -1;
+    client->mutex = axutil_thread_mutex_create(env->allocator,
+                                               AXIS2_THREAD_MUTEX_DEFAULT);
+    client->conns = axutil_hash_make(env);
+    client->running = axutil_array_list_create(env, 4);
+    if (!client->mutex || !client->conns || !client->running ||
+        pipe(client->wakeup))
+    {
+        client->wakeup[0] = -1;
+        axis2_http2_client_free(client, env);
+        AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+    return client;
+}
+
+static void
+axis2_http2_client_free_headers(
+    const axutil_env_t * env,
+    axutil_array_list_t * headers)
+{
+    int i = 0;
+
+    if (!headers)
+    {
+        return;
+    }
+    for (i = 0; i < axutil_array_list_size(headers, env); i++)
+    {
+        axis2_http_header_t *header = axutil_array_list_get(headers, env, i);
+        if (header)
+        {
+            axis2_http_header_free(header, env);
+        }
+    }
+    axutil_array_list_free(headers, env);
+}
+
+static void
+axis2_http2_client_add_int(
+    unsigned char *buf,
+    unsigned int value)
+{
+    buf[0] = (unsigned char) (value >> 24);
+    buf[1] = (unsigned char) (value >> 16);
+    buf[2] = (unsigned char) (value >> 8);
+    buf[3] = (unsigned char) value;
+}
+
+static unsigned int
+axis2_http2_client_get_int(
+    const unsigned char *buf)
+{
+    return ((unsigned int) buf[0] << 24) | ((unsigned int) buf[1] << 16) |
+        ((unsigned int) buf[2] << 8) | (unsigned int) buf[3];
+}
+
+static axis2_status_t
+axis2_http2_client_append(
+    const axutil_env_t * env,
+    axis2_char_t ** data,
+    int *len,
+    int *size,
+    const unsigned char *bytes,
+    int count)
+{
+    if (*len + count > *size)
+    {
+        axis2_char_t *grown = NULL;
+        int new_size = *size ? *size : AXIS2_HTTP2_DEFAULT_MAX_FRAME_SIZE;
+
+        while (*len + count > new_size)
+        {
+            new_size *= 2;
+        }
+        grown = AXIS2_MALLOC(env->allocator, new_size);
+        if (!grown)
+        {
+            AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+            return AXIS2_FAILURE;
+        }
+        if (*data)
+        {
+            memcpy(grown, *data, *len);
+            AXIS2_FREE(env->allocator, *data);
+        }
+        *data = grown;
+        *size = new_size;
+    }
+    memcpy(*data + *len, bytes, count);
+    *len += count;
+    return AXIS2_SUCCESS;
+}
+
+static void
+axis2_http2_client_conn_free(
+    axis2_http2_client_conn_t * conn,
+    const axutil_env_t * env)
+{
+    if (conn->socket >= 0)
+    {
+        axutil_network_handler_close_socket(env, conn->socket);
+    }
+    if (conn->mutex)
+    {
+        axutil_thread_mutex_destroy(conn->mutex);
+    }
+    if (conn->out)
+    {
+        axis2_http2_frame_buf_free(conn->out, env);
+    }
+    if (conn->exchanges)
+    {
+        axutil_array_list_free(conn->exchanges, env);
+    }
+    if (conn->reader)
+    {
+        axis2_http2_frame_reader_free(conn->reader, env);
+    }
+    if (conn->decoder)
+    {
+        axis2_http2_hpack_free(conn->decoder, env);
+    }
+    if (conn->block)
+    {
+        AXIS2_FREE(env->allocator, conn->block);
+    }
+    if (conn->key)
+    {
+        AXIS2_FREE(env->allocator, conn->key);
+    }
+    AXIS2_FREE(env->allocator, conn);
+}
+
+/* Drops a reference taken on the connection, the last one frees it */
+static void
+axis2_http2_client_conn_release(
+    axis2_http2_client_conn_t * conn,
+    const axutil_env_t * env)
+{
+    int refs = 0;
+
+    axutil_thread_mutex_lock(conn->mutex);
+    refs = --conn->refs;
+    axutil_thread_mutex_unlock(conn->mutex);
+    if (!refs)
+    {
+        axis2_http2_client_conn_free(conn, env);
+    }
+}
+
+static void
+axis2_http2_client_wake(
+    axis2_http2_exchange_t * exchange)
+{
+    exchange->waiting = AXIS2_FALSE;
+    if (write(exchange->wakeup[1], "", 1) < 0)
+    {
+        /* the pipe is full, the thread is woken up anyway */
+    }
+}
+
+/* Wakes the threads waiting for a window or for a stream to send on */
+static void
+axis2_http2_client_conn_wake_all(
+    axis2_http2_client_conn_t * conn,
+    const axutil_env_t * env)
+{
+    int i = 0;
+
+    for (i = 0; i < axutil_array_list_size(conn->exchanges, env); i++)
+    {
+        axis2_http2_exchange_t *exchange =
+            axutil_array_list_get(conn->exchanges, env, i);
+        if (exchange->waiting)
+        {
+            axis2_http2_client_wake(exchange);
+        }
+    }
+}
+
+static void
+axis2_http2_client_conn_finish(
+    axis2_http2_client_conn_t * conn,
+    const axutil_env_t * env,
+    axis2_http2_exchange_t * exchange)
+{
+    if (exchange->done)
+    {
+        return;
+    }
+    exchange->done = AXIS2_TRUE;
+    if (exchange->stream_id)
+    {
+        conn->open_streams--;
+    }
+    axis2_http2_client_wake(exchange);
+    /* a stream is free for the threads waiting for one */
+    axis2_http2_client_conn_wake_all(conn, env);
+}
+
+static axis2_http2_exchange_t *
+axis2_http2_client_conn_find(
+    axis2_http2_client_conn_t * conn,
+    const axutil_env_t * env,
+    int stream_id)
+{
+    int i = 0;
+
+    for (i = 0; i < axutil_array_list_size(conn->exchanges, env); i++)
+    {
+        axis2_http2_exchange_t *exchange =
+            axutil_array_list_get(conn->exchanges, env, i);
+        if (exchange->stream_id == stream_id)
+        {
+            return exchange;
+        }
+    }
+    return NULL;
+}
+
+/* Called locked. No new streams go to the connection, the exchanges above
+   last_stream_id were not processed and may be sent again. */
+static void
+axis2_http2_client_conn_close(
+    axis2_http2_client_conn_t * conn,
+    const axutil_env_t * env,
+    int last_stream_id)
+{
+    int i = 0;
+
+    conn->closed = AXIS2_TRUE;
+    for (i = 0; i < axutil_array_list_size(conn->exchanges, env); i++)
+    {
+        axis2_http2_exchange_t *exchange =
+            axutil_array_list_get(conn->exchanges, env, i);
+        if (!exchange->done && (!exchange->stream_id ||
+                                exchange->stream_id > last_stream_id))
+        {
+            exchange->refused = AXIS2_TRUE;
+            axis2_http2_client_conn_finish(conn, env, exchange);
+        }
+    }
+}
+
+/* Called locked */
+static axis2_status_t
+axis2_http2_client_conn_flush(
+    axis2_http2_client_conn_t * conn,
+    const axutil_env_t * env)
+{
+    if (AXIS2_SUCCESS != axis2_http2_frame_buf_flush(conn->out, env,
+                                                     conn->socket))
+    {
+        axis2_http2_client_conn_close(conn, env, 0);
+        return AXIS2_FAILURE;
+    }
+    return AXIS2_SUCCESS;
+}
+
+/* Called locked */
+static void
+axis2_http2_client_conn_window_update(
+    axis2_http2_client_conn_t * conn,
+    const axutil_env_t * env,
+    int stream_id,
+    int increment)
+{
+    unsigned char payload[4];
+
+    axis2_http2_client_add_int(payload, increment);
+    axis2_http2_frame_buf_add(conn->out, env, AXIS2_HTTP2_WINDOW_UPDATE, 0,
+                              stream_id, payload, 4);
+}
+
+static axis2_status_t
+axis2_http2_client_conn_on_header_block(
+    axis2_http2_client_conn_t * conn,
+    const axutil_env_t * env)
+{
+    axis2_http2_exchange_t *exchange = NULL;
+    axutil_array_list_t *headers = NULL;
+    int status = 0;
+    int i = 0;
+
+    headers = axutil_array_list_create(env, 10);
+    if (!headers || AXIS2_SUCCESS != axis2_http2_hpack_decode(conn->decoder,
+            env, conn->block, conn->block_len, headers))
+    {
+        axis2_http2_client_free_headers(env, headers);
+        return AXIS2_FAILURE;
+    }
+    for (i = 0; i < axutil_array_list_size(headers, env); i++)
+    {
+        axis2_http_header_t *header = axutil_array_list_get(headers, env, i);
+        if (!axutil_strcmp(axis2_http_header_get_name(header, env), ":status"))
+        {
+            status = AXIS2_ATOI(axis2_http_header_get_value(header, env));
+        }
+    }
+
+    axutil_thread_mutex_lock(conn->mutex);
+    exchange = axis2_http2_client_conn_find(conn, env, conn->block_stream_id);
+    /* interim responses and trailers are not kept */
+    if (exchange && !exchange->done && !exchange->status && status >= 200)
+    {
+        exchange->status = status;
+        exchange->headers = headers;
+        headers = NULL;
+    }
+    if (exchange && exchange->status &&
+        (conn->block_flags & AXIS2_HTTP2_FLAG_END_STREAM))
+    {
+        axis2_http2_client_conn_finish(conn, env, exchange);
+    }
+    axutil_thread_mutex_unlock(conn->mutex);
+    axis2_http2_client_free_headers(env, headers);
+    conn->block_stream_id = 0;
+    return AXIS2_SUCCESS;
+}
+
+static axis2_status_t
+axis2_http2_client_conn_on_data(
+    axis2_http2_client_conn_t * conn,
+    const axutil_env_t * env,
+    const axis2_http2_frame_t * frame)
+{
+    axis2_http2_exchange_t *exchange = NULL;
+    const unsigned char *payload = frame->payload;
+    int length = frame->length;
+    axis2_status_t status = AXIS2_SUCCESS;
+
+    if (frame->flags & AXIS2_HTTP2_FLAG_PADDED)
+    {
+        if (length < 1 || payload[0] >= length)
+        {
+            return AXIS2_FAILURE;
+        }
+        length -= 1 + payload[0];
+        payload++;
+    }
+    axutil_thread_mutex_lock(conn->mutex);
+    conn->recv_window -= frame->length;
+    if (conn->recv_window < AXIS2_HTTP2_CLIENT_WINDOW_SIZE / 2)
+    {
+        axis2_http2_client_conn_window_update(conn, env, 0,
+                                              AXIS2_HTTP2_CLIENT_WINDOW_SIZE -
+                                              conn->recv_window);
+        conn->recv_window = AXIS2_HTTP2_CLIENT_WINDOW_SIZE;
+    }
+    exchange = axis2_http2_client_conn_find(conn, env, frame->stream_id);
+    if (exchange && !exchange->done)
+    {
+        exchange->recv_window -= frame->length;
+        if (length > 0 && AXIS2_SUCCESS != axis2_http2_client_append(env,
+                &exchange->body, &exchange->body_len, &exchange->body_size,
+                payload, length))
+        {
+            exchange->reset = AXIS2_TRUE;
+            axis2_http2_client_conn_finish(conn, env, exchange);
+        }
+        else if (frame->flags & AXIS2_HTTP2_FLAG_END_STREAM)
+        {
+            axis2_http2_client_conn_finish(conn, env, exchange);
+        }
+        else if (exchange->recv_window < AXIS2_HTTP2_CLIENT_WINDOW_SIZE / 2)
+        {
+            axis2_http2_client_conn_window_update(conn, env, exchange->stream_id,
+                                                  AXIS2_HTTP2_CLIENT_WINDOW_SIZE -
+                                                  exchange->recv_window);
+            exchange->recv_window = AXIS2_HTTP2_CLIENT_WINDOW_SIZE;
+        }
+    }
+    if (axis2_http2_frame_buf_get_len(conn->out, env) > 0)
+    {
+        status = axis2_http2_client_conn_flush(conn, env);
+    }
+    axutil_thread_mutex_unlock(conn->mutex);
+    return status;
+}
+
+static axis2_status_t
+axis2_http2_client_conn_on_settings(
+    axis2_http2_client_conn_t * conn,
+    const axutil_env_t * env,
+    const axis2_http2_frame_t * frame)
+{
+    axis2_status_t status = AXIS2_SUCCESS;
+    int pos = 0;
+
+    if (frame->flags & AXIS2_HTTP2_FLAG_ACK)
+    {
+        return AXIS2_SUCCESS;
+    }
+    axutil_thread_mutex_lock(conn->mutex);
+    for (pos = 0; pos + 6 <= frame->length; pos += 6)
+    {
+        int id = (frame->payload[pos] << 8) | frame->payload[pos + 1];
+        unsigned int value = axis2_http2_client_get_int(frame->payload + pos + 2);
+
+        if (AXIS2_HTTP2_SETTINGS_INITIAL_WINDOW_SIZE == id &&
+            value <= AXIS2_HTTP2_MAX_WINDOW_SIZE)
+        {
+            int delta = (int) value - conn->initial_window;
+            int i = 0;
+
+            conn->initial_window = (int) value;
+            for (i = 0; i < axutil_array_list_size(conn->exchanges, env); i++)
+            {
+                axis2_http2_exchange_t *exchange =
+                    axutil_array_list_get(conn->exchanges, env, i);
+                exchange->send_window += delta;
+            }
+        }
+        else if (AXIS2_HTTP2_SETTINGS_MAX_FRAME_SIZE == id &&
+                 value >= AXIS2_HTTP2_DEFAULT_MAX_FRAME_SIZE && value <= 0xffffff)
+        {
+            conn->max_frame_size = (int) value;
+        }
+        else if (AXIS2_HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS == id)
+        {
+            conn->max_streams = value > 0x7fffffff ? 0x7fffffff : (int) value;
+        }
+    }
+    axis2_http2_frame_buf_add(conn->out, env, AXIS2_HTTP2_SETTINGS,
+                              AXIS2_HTTP2_FLAG_ACK, 0, NULL, 0);
+    status = axis2_http2_client_conn_flush(conn, env);
+    axis2_http2_client_conn_wake_all(conn, env);
+    axutil_thread_mutex_unlock(conn->mutex);
+    return status;
+}
+
+static axis2_status_t
+axis2_http2_client_conn_on_frame(
+    axis2_http2_client_conn_t * conn,
+    const axutil_env_t * env,
+    const axis2_http2_frame_t * frame)
+{
+    axis2_http2_exchange_t *exchange = NULL;
+    axis2_status_t status = AXIS2_SUCCESS;
+
+    if (conn->block_stream_id && AXIS2_HTTP2_CONTINUATION != frame->type)
+    {
+        return AXIS2_FAILURE;
+    }
+    switch (frame->type)
+    {
+    case AXIS2_HTTP2_DATA:
+        return axis2_http2_client_conn_on_data(conn, env, frame);
+
+    case AXIS2_HTTP2_HEADERS:
+    case AXIS2_HTTP2_CONTINUATION:
+        {
+            const unsigned char *payload = frame->payload;
+            int length = frame->length;
+
+            if (AXIS2_HTTP2_HEADERS == frame->type)
+            {
+                int pad = 0;
+
+                if (frame->flags & AXIS2_HTTP2_FLAG_PADDED)
+                {
+                    if (length < 1)
+                    {
+                        return AXIS2_FAILURE;
+                    }
+                    pad = payload[0];
+                    payload++;
+                    length--;
+                }
+                if (frame->flags & AXIS2_HTTP2_FLAG_PRIORITY)
+                {
+                    payload += 5;
+                    length -= 5;
+                }
+                length -= pad;
+                if (length < 0 || !frame->stream_id)
+                {
+                    return AXIS2_FAILURE;
+                }
+                conn->block_stream_id = frame->stream_id;
+                conn->block_flags = frame->flags;
+                conn->block_len = 0;
+            }
+            else if (frame->stream_id != conn->block_stream_id)
+            {
+                return AXIS2_FAILURE;
+            }
+            if (length > 0 && AXIS2_SUCCESS != axis2_http2_client_append(env,
+                    (axis2_char_t **) &conn->block, &conn->block_len,
+                    &conn->block_size, payload, length))
+            {
+                return AXIS2_FAILURE;
+            }
+            if (frame->flags & AXIS2_HTTP2_FLAG_END_HEADERS)
+            {
+                return axis2_http2_client_conn_on_header_block(conn, env);
+            }
+            return AXIS2_SUCCESS;
+        }
+
+    case AXIS2_HTTP2_RST_STREAM:
+        if (4 != frame->length)
+        {
+            return AXIS2_FAILURE;
+        }
+        axutil_thread_mutex_lock(conn->mutex);
+        exchange = axis2_http2_client_conn_find(conn, env, frame->stream_id);
+        if (exchange && !exchange->done)
+        {
+            exchange->reset = AXIS2_TRUE;
+            exchange->refused = AXIS2_HTTP2_REFUSED_STREAM ==
+                axis2_http2_client_get_int(frame->payload);
+            axis2_http2_client_conn_finish(conn, env, exchange);
+        }
+        axutil_thread_mutex_unlock(conn->mutex);
+        return AXIS2_SUCCESS;
+
+    case AXIS2_HTTP2_SETTINGS:
+        if (frame->length % 6)
+        {
+            return AXIS2_FAILURE;
+        }
+        return axis2_http2_client_conn_on_settings(conn, env, frame);
+
+    case AXIS2_HTTP2_PING:
+        if (8 != frame->length)
+        {
+            return AXIS2_FAILURE;
+        }
+        if (frame->flags & AXIS2_HTTP2_FLAG_ACK)
+        {
+            return AXIS2_SUCCESS;
+        }
+        axutil_thread_mutex_lock(conn->mutex);
+        axis2_http2_frame_buf_add(conn->out, env, AXIS2_HTTP2_PING,
+                                  AXIS2_HTTP2_FLAG_ACK, 0, frame->payload, 8);
+        status = axis2_http2_client_conn_flush(conn, env);
+        axutil_thread_mutex_unlock(conn->mutex);
+        return status;
+
+    case AXIS2_HTTP2_GOAWAY:
+        if (frame->length < 8)
+        {
+            return AXIS2_FAILURE;
+        }
+        axutil_thread_mutex_lock(conn->mutex);
+        axis2_http2_client_conn_close(conn, env, (int)
+            (axis2_http2_client_get_int(frame->payload) & 0x7fffffff));
+        axutil_thread_mutex_unlock(conn->mutex);
+        return AXIS2_SUCCESS;
+
+    case AXIS2_HTTP2_WINDOW_UPDATE:
+        {
+            int increment = 0;
+
+            if (4 != frame->length)
+            {
+                return AXIS2_FAILURE;
+            }
+            increment = (int) (axis2_http2_client_get_int(frame->payload) &
+                               0x7fffffff);
+            axutil_thread_mutex_lock(conn->mutex);
+            if (!frame->stream_id)
+            {
+                conn->send_window += increment;
+            }
+            else
+            {
+                exchange = axis2_http2_client_conn_find(conn, env,
+                                                        frame->stream_id);
+                if (exchange)
+                {
+                    exchange->send_window += increment;
+                }
+            }
+            axis2_http2_client_conn_wake_all(conn, env);
+            axutil_thread_mutex_unlock(conn->mutex);
+            return AXIS2_SUCCESS;
+        }
+
+    case AXIS2_HTTP2_PUSH_PROMISE:
+        /* disabled in the settings sent */
+        return AXIS2_FAILURE;
+
+    default:
+        return AXIS2_SUCCESS;
+    }
+}
+
+/* Reads the frames of the connection until it is closed. The thread frees
+   the connection when it is the last one using it. */
+static void *AXIS2_THREAD_FUNC
+axis2_http2_client_conn_read(
+    axutil_thread_t * thd,
+    void *data)
+{
+    axis2_http2_client_conn_t *conn = data;
+    axis2_http2_client_t *client = conn->client;
+    axutil_env_t *env = conn->thread_env;
+    axutil_thread_pool_t *thread_pool = env->thread_pool;
+    int i = 0;
+
+    while (axis2_http2_frame_reader_fill(conn->reader, env, conn->socket) > 0)
+    {
+        axis2_http2_frame_t frame;
+        int next = 0;
+
+        while ((next = axis2_http2_frame_reader_next(conn->reader, env,
+                                                     &frame)) > 0)
+        {
+            if (AXIS2_SUCCESS != axis2_http2_client_conn_on_frame(conn, env,
+                                                                  &frame))
+            {
+                next = -1;
+                break;
+            }
+        }
+        if (next < 0)
+        {
+            AXIS2_LOG_WARNING(env->log, AXIS2_LOG_SI,
+                              "Closing HTTP/2 connection to %s on a protocol "
+                              "error", conn->key);
+            break;
+        }
+    }
+
+    axutil_thread_mutex_lock(conn->mutex);
+    /* the streams still open get no response */
+    for (i = 0; i < axutil_array_list_size(conn->exchanges, env); i++)
+    {
+        axis2_http2_exchange_t *exchange =
+            axutil_array_list_get(conn->exchanges, env, i);
+        if (!exchange->done)
+        {
+            exchange->reset = AXIS2_TRUE;
+        }
+    }
+    axis2_http2_client_conn_close(conn, env, 0x7fffffff);
+    for (i = 0; i < axutil_array_list_size(conn->exchanges, env); i++)
+    {
+        axis2_http2_client_conn_finish(conn, env,
+            axutil_array_list_get(conn->exchanges, env, i));
+    }
+    axutil_thread_mutex_unlock(conn->mutex);
+
+    axutil_thread_mutex_lock(client->mutex);
+    if (axutil_hash_get(client->conns, conn->key, AXIS2_HASH_KEY_STRING) == conn)
+    {
+        axutil_hash_set(client->conns, conn->key, AXIS2_HASH_KEY_STRING, NULL);
+    }
+    for (i = 0; i < axutil_array_list_size(client->running, env); i++)
+    {
+        if (axutil_array_list_get(client->running, env, i) == conn)
+        {
+            axutil_array_list_remove(client->running, env, i);
+            break;
+        }
+    }
+    if (write(client->wakeup[1], "", 1) < 0)
+    {
+        AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI,
+                        "HTTP/2 client already woken up");
+    }
+    axutil_thread_mutex_unlock(client->mutex);
+
+    axis2_http2_client_conn_release(conn, env);
+    axutil_free_thread_env(env);
+    axutil_thread_pool_exit_thread(thread_pool, thd);
+    return NULL;
+}
+
+/* Called with the client locked */
+static axis2_http2_client_conn_t *
+axis2_http2_client_conn_create(
+    axis2_http2_client_t * client,
+    const axutil_env_t * env,
+    const axis2_char_t * host,
+    int port,
+    axis2_char_t * key)
+{
+    axis2_http2_client_conn_t *conn = NULL;
+    axutil_thread_t *thread = NULL;
+    unsigned char settings[12];
+
+    conn = AXIS2_MALLOC(env->allocator, sizeof(axis2_http2_client_conn_t));
+    if (!conn)
+    {
+        AXIS2_FREE(env->allocator, key);
+        AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+    memset(conn, 0, sizeof(axis2_http2_client_conn_t));
+    conn->client = client;
+    conn->key = key;
+    conn->refs = 1;
+    conn->next_stream_id = 1;
+    conn->send_window = AXIS2_HTTP2_DEFAULT_WINDOW_SIZE;
+    conn->recv_window = AXIS2_HTTP2_CLIENT_WINDOW_SIZE;
+    conn->max_streams = AXIS2_HTTP_DEFAULT_HTTP2_MAX_STREAMS;
+    conn->initial_window = AXIS2_HTTP2_DEFAULT_WINDOW_SIZE;
+    conn->max_frame_size = AXIS2_HTTP2_DEFAULT_MAX_FRAME_SIZE;
+    conn->socket = (int) axutil_network_handler_open_socket(env,
+                                                            (char *) host, port);
+    conn->mutex = axutil_thread_mutex_create(env->allocator,
+                                             AXIS2_THREAD_MUTEX_DEFAULT);
+    conn->out = axis2_http2_frame_buf_create(env);
+    conn->exchanges = axutil_array_list_create(env, 4);
+    conn->reader = axis2_http2_frame_reader_create(env,
+                                                   AXIS2_HTTP2_DEFAULT_MAX_FRAME_SIZE);
+    conn->decoder = axis2_http2_hpack_create(env,
+                                             AXIS2_HTTP2_DEFAULT_HEADER_TABLE_SIZE);
+    if (conn->socket < 0 || !conn->mutex || !conn->out || !conn->exchanges ||
+        !conn->reader || !conn->decoder)
+    {
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "Unable to open HTTP/2 connection to %s", key);
+        axis2_http2_client_conn_free(conn, env);
+        return NULL;
+    }
+
+    axis2_http2_frame_buf_add_raw(conn->out, env, AXIS2_HTTP2_PREFACE,
+                                  AXIS2_HTTP2_PREFACE_LEN);
+    settings[0] = 0;
+    settings[1] = AXIS2_HTTP2_SETTINGS_ENABLE_PUSH;
+    axis2_http2_client_add_int(settings + 2, 0);
+    settings[6] = 0;
+    settings[7] = AXIS2_HTTP2_SETTINGS_INITIAL_WINDOW_SIZE;
+    axis2_http2_client_add_int(settings + 8, AXIS2_HTTP2_CLIENT_WINDOW_SIZE);
+    axis2_http2_frame_buf_add(conn->out, env, AXIS2_HTTP2_SETTINGS, 0, 0,
+                              settings, sizeof(settings));
+    axis2_http2_client_conn_window_update(conn, env, 0,
+                                          AXIS2_HTTP2_CLIENT_WINDOW_SIZE -
+                                          AXIS2_HTTP2_DEFAULT_WINDOW_SIZE);
+    if (AXIS2_SUCCESS != axis2_http2_frame_buf_flush(conn->out, env,
+                                                     conn->socket))
+    {
+        axis2_http2_client_conn_free(conn, env);
+        return NULL;
+    }
+
+    conn->thread_env = axutil_init_thread_env(env);
+    if (conn->thread_env)
+    {
+        /* a reference for the reader thread */
+        conn->refs++;
+        thread = axutil_thread_pool_get_thread(env->thread_pool,
+                                               axis2_http2_client_conn_read,
+                                               conn);
+    }
+    if (!thread)
+    {
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "Unable to start the HTTP/2 reader thread");
+        if (conn->thread_env)
+        {
+            axutil_free_thread_env(conn->thread_env);
+        }
+        axis2_http2_client_conn_free(conn, env);
+        return NULL;
+    }
+    axutil_thread_pool_thread_detach(env->thread_pool, thread);
+    axutil_array_list_add(client->running, env, conn);
+    axutil_hash_set(client->conns, conn->key, AXIS2_HASH_KEY_STRING, conn);
+    return conn;
+}
+
+/* Takes a reference on a connection to the server that takes new streams,
+   opening one if needed, and adds the exchange to it */
+static axis2_http2_client_conn_t *
+axis2_http2_client_get_conn(
+    axis2_http2_client_t * client,
+    const axutil_env_t * env,
+    const axis2_char_t * host,
+    int port,
+    axis2_http2_exchange_t * exchange)
+{
+    axis2_http2_client_conn_t *conn = NULL;
+    axis2_char_t *key = NULL;
+
+    key = AXIS2_MALLOC(env->allocator, axutil_strlen(host) + 16);
+    if (!key)
+    {
+        AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+    sprintf(key, "%s:%d", host, port);
+
+    axutil_thread_mutex_lock(client->mutex);
+    conn = axutil_hash_get(client->conns, key, AXIS2_HASH_KEY_STRING);
+    if (conn)
+    {
+        axutil_thread_mutex_lock(conn->mutex);
+        if (conn->closed)
+        {
+            /* its reader thread frees it once the streams are answered */
+            axutil_hash_set(client->conns, conn->key, AXIS2_HASH_KEY_STRING,
+                            NULL);
+            axutil_thread_mutex_unlock(conn->mutex);
+            conn = NULL;
+        }
+        else
+        {
+            axutil_thread_mutex_unlock(conn->mutex);
+        }
+    }
+    if (conn)
+    {
+        AXIS2_FREE(env->allocator, key);
+    }
+    else
+    {
+        conn = axis2_http2_client_conn_create(client, env, host, port, key);
+    }
+    if (conn)
+    {
+        axutil_thread_mutex_lock(conn->mutex);
+        conn->refs++;
+        axutil_array_list_add(conn->exchanges, env, exchange);
+        axutil_thread_mutex_unlock(conn->mutex);
+    }
+    axutil_thread_mutex_unlock(client->mutex);
+    return conn;
+}
+
+/* Called with the connection locked. Returns AXIS2_FALSE when the wait
+   timed out. */
+static axis2_bool_t
+axis2_http2_client_wait(
+    axis2_http2_client_conn_t * conn,
+    const axutil_env_t * env,
+    axis2_http2_exchange_t * exchange,
+    int timeout)
+{
+    struct pollfd fds[1];
+    char buffer[16];
+    int ready = 0;
+
+    exchange->waiting = AXIS2_TRUE;
+    axutil_thread_mutex_unlock(conn->mutex);
+    fds[0].fd = exchange->wakeup[0];
+    fds[0].events = POLLIN;
+    do
+    {
+        ready = poll(fds, 1, timeout > 0 ? timeout : -1);
+    }
+    while (ready < 0 && EINTR == errno);
+    if (ready > 0 && read(exchange->wakeup[0], buffer, sizeof(buffer)) < 0)
+    {
+        AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI,
+                        "Reading the HTTP/2 wake up pipe failed");
+    }
+    axutil_thread_mutex_lock(conn->mutex);
+    exchange->waiting = AXIS2_FALSE;
+    return ready > 0;
+}
+
+/* Called with the connection locked. Sends the headers of the request. */
+static axis2_status_t
+axis2_http2_client_send_headers(
+    axis2_http2_client_conn_t * conn,
+    const axutil_env_t * env,
+    axis2_http2_exchange_t * exchange,
+    axis2_http_simple_request_t * request,
+    const axis2_char_t * authority,
+    axis2_bool_t end_stream)
+{
+    axis2_http_request_line_t *request_line = NULL;
+    axutil_array_list_t *headers = NULL;
+    const axis2_char_t *method = NULL;
+    const axis2_char_t *path = NULL;
+    unsigned char *block = NULL;
+    int block_len = 0;
+    int block_size = 0;
+    int sent = 0;
+    int i = 0;
+
+    request_line = axis2_http_simple_request_get_request_line(request, env);
+    method = axis2_http_request_line_get_method(request_line, env);
+    path = axis2_http_request_line_get_uri(request_line, env);
+    headers = axis2_http_simple_request_get_headers(request, env);
+
+    block_size = axis2_http2_hpack_encoded_max_len(":method", method) +
+        axis2_http2_hpack_encoded_max_len(":scheme", "http") +
+        axis2_http2_hpack_encoded_max_len(":authority", authority) +
+        axis2_http2_hpack_encoded_max_len(":path", path);
+    for (i = 0; i < axutil_array_list_size(headers, env); i++)
+    {
+        axis2_http_header_t *header = axutil_array_list_get(headers, env, i);
+        block_size += axis2_http2_hpack_encoded_max_len(
+            axis2_http_header_get_name(header, env),
+            axis2_http_header_get_value(header, env));
+    }
+    block = AXIS2_MALLOC(env->allocator, block_size);
+    if (!block)
+    {
+        AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+    block_len += axis2_http2_hpack_encode(env, ":method", method, block);
+    block_len += axis2_http2_hpack_encode(env, ":scheme", "http",
+                                          block + block_len);
+    block_len += axis2_http2_hpack_encode(env, ":authority", authority,
+                                          block + block_len);
+    block_len += axis2_http2_hpack_encode(env, ":path", path,
+                                          block + block_len);
+    for (i = 0; i < axutil_array_list_size(headers, env); i++)
+    {
+        axis2_http_header_t *header = axutil_array_list_get(headers, env, i);
+        axis2_char_t *name = axutil_strdup(env,
+                                           axis2_http_header_get_name(header, env));
+        axis2_char_t *c = NULL;
+
+        if (!name)
+        {
+            continue;
+        }
+        for (c = name; *c; c++)
+        {
+            *c = (axis2_char_t) tolower((unsigned char) *c);
+        }
+        if (!axis2_http2_is_connection_header(name) &&
+            axutil_strcmp(name, "host"))
+        {
+            block_len += axis2_http2_hpack_encode(env, name,
+                axis2_http_header_get_value(header, env), block + block_len);
+        }
+        AXIS2_FREE(env->allocator, name);
+    }
+
+    exchange->stream_id = conn->next_stream_id;
+    conn->next_stream_id += 2;
+    conn->open_streams++;
+    exchange->send_window = conn->initial_window;
+    exchange->recv_window = AXIS2_HTTP2_CLIENT_WINDOW_SIZE;
+    /* a block larger than a frame goes on in CONTINUATION frames */
+    while (sent < block_len)
+    {
+        int count = block_len - sent;
+        int flags = 0;
+
+        if (count > conn->max_frame_size)
+        {
+            count = conn->max_frame_size;
+        }
+        if (sent + count == block_len)
+        {
+            flags |= AXIS2_HTTP2_FLAG_END_HEADERS;
+        }
+        if (!sent && end_stream)
+        {
+            flags |= AXIS2_HTTP2_FLAG_END_STREAM;
+        }
+        axis2_http2_frame_buf_add(conn->out, env, sent ?
+                                  AXIS2_HTTP2_CONTINUATION : AXIS2_HTTP2_HEADERS,
+                                  flags, exchange->stream_id, block + sent,
+                                  count);
+        sent += count;
+    }
+    AXIS2_FREE(env->allocator, block);
+    return axis2_http2_client_conn_flush(conn, env);
+}
+
+/* Sends the request on a stream of the connection and waits for the
+   response */
+static axis2_status_t
+axis2_http2_client_exchange(
+    axis2_http2_client_conn_t * conn,
+    const axutil_env_t * env,
+    axis2_http2_exchange_t * exchange,
+    axis2_http_simple_request_t * request,
+    const axis2_char_t * authority,
+    const axis2_char_t * body,
+    int body_len,
+    int timeout)
+{
+    int sent = 0;
+
+    axutil_thread_mutex_lock(conn->mutex);
+    while (!conn->closed && conn->open_streams >= conn->max_streams)
+    {
+        if (!axis2_http2_client_wait(conn, env, exchange, timeout))
+        {
+            axutil_thread_mutex_unlock(conn->mutex);
+            return AXIS2_FAILURE;
+        }
+    }
+    if (conn->closed)
+    {
+        exchange->refused = AXIS2_TRUE;
+        axutil_thread_mutex_unlock(conn->mutex);
+        return AXIS2_FAILURE;
+    }
+    if (AXIS2_SUCCESS != axis2_http2_client_send_headers(conn, env, exchange,
+            request, authority, body_len <= 0))
+    {
+        axutil_thread_mutex_unlock(conn->mutex);
+        return AXIS2_FAILURE;
+    }
+
+    while (sent < body_len && !exchange->done)
+    {
+        int count = body_len - sent;
+
+        if (count > conn->max_frame_size)
+        {
+            count = conn->max_frame_size;
+        }
+        if (count > exchange->send_window)
+        {
+            count = exchange->send_window;
+        }
+        if (count > conn->send_window)
+        {
+            count = conn->send_window;
+        }
+        if (count <= 0)
+        {
+            if (axis2_http2_client_conn_flush(conn, env) != AXIS2_SUCCESS ||
+                !axis2_http2_client_wait(conn, env, exchange, timeout))
+            {
+                axutil_thread_mutex_unlock(conn->mutex);
+                return AXIS2_FAILURE;
+            }
+            continue;
+        }
+        axis2_http2_frame_buf_add(conn->out, env, AXIS2_HTTP2_DATA,
+                                  sent + count == body_len ?
+                                  AXIS2_HTTP2_FLAG_END_STREAM : 0,
+                                  exchange->stream_id, body + sent, count);
+        sent += count;
+        exchange->send_window -= count;
+        conn->send_window -= count;
+        if ((sent == body_len || axis2_http2_frame_buf_get_len(conn->out, env) >
+             AXIS2_HTTP2_CLIENT_FLUSH_SIZE) &&
+            AXIS2_SUCCESS != axis2_http2_client_conn_flush(conn, env))
+        {
+            axutil_thread_mutex_unlock(conn->mutex);
+            return AXIS2_FAILURE;
+        }
+    }
+
+    while (!exchange->done)
+    {
+        if (!axis2_http2_client_wait(conn, env, exchange, timeout))
+        {
+            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                            "HTTP/2 response timed out on %s", conn->key);
+            AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_RESPONSE_TIMED_OUT,
+                               AXIS2_FAILURE);
+            axutil_thread_mutex_unlock(conn->mutex);
+            return AXIS2_FAILURE;
+        }
+    }
+    axutil_thread_mutex_unlock(conn->mutex);
+    return exchange->reset || exchange->refused || !exchange->status ?
+        AXIS2_FAILURE : AXIS2_SUCCESS;
+}
+
+/* Takes the exchange off the connection, cancelling its stream if it is
+   still open, and drops the reference on the connection */
+static void
+axis2_http2_client_leave(
+    axis2_http2_client_conn_t * conn,
+    const axutil_env_t * env,
+    axis2_http2_exchange_t * exchange)
+{
+    int i = 0;
+
+    axutil_thread_mutex_lock(conn->mutex);
+    if (exchange->stream_id && !exchange->done)
+    {
+        unsigned char payload[4];
+
+        axis2_http2_client_add_int(payload, AXIS2_HTTP2_CANCEL);
+        axis2_http2_frame_buf_add(conn->out, env, AXIS2_HTTP2_RST_STREAM, 0,
+                                  exchange->stream_id, payload, 4);
+        axis2_http2_client_conn_flush(conn, env);
+        axis2_http2_client_conn_finish(conn, env, exchange);
+    }
+    for (i = 0; i < axutil_array_list_size(conn->exchanges, env); i++)
+    {
+        if (axutil_array_list_get(conn->exchanges, env, i) == exchange)
+        {
+            axutil_array_list_remove(conn->exchanges, env, i);
+            break;
+        }
+    }
+    axutil_thread_mutex_unlock(conn->mutex);
+    axis2_http2_client_conn_release(conn, env);
+}
+
+static void
+axis2_http2_client_exchange_reset(
+    axis2_http2_exchange_t * exchange,
+    const axutil_env_t * env)
+{
+    axis2_http2_client_free_headers(env, exchange->headers);
+    if (exchange->body)
+    {
+        AXIS2_FREE(env->allocator, exchange->body);
+    }
+    exchange->headers = NULL;
+    exchange->body = NULL;
+    exchange->body_len = 0;
+    exchange->body_size = 0;
+    exchange->stream_id = 0;
+    exchange->waiting = AXIS2_FALSE;
+    exchange->done = AXIS2_FALSE;
+    exchange->refused = AXIS2_FALSE;
+    exchange->reset = AXIS2_FALSE;
+    exchange->status = 0;
+}
+
+AXIS2_EXTERN int AXIS2_CALL
+axis2_http2_client_send(
+    axis2_http2_client_t * client,
+    const axutil_env_t * env,
+    const axis2_char_t * host,
+    int port,
+    axis2_http_simple_request_t * request,
+    const axis2_char_t * body,
+    int body_len,
+    int timeout,
+    axis2_http_simple_response_t ** response)
+{
+    axis2_http2_exchange_t exchange;
+    axis2_http_header_t *host_header = NULL;
+    axis2_char_t *authority = NULL;
+    axis2_status_t status = AXIS2_FAILURE;
+    int attempt = 0;
+    int status_code = -1;
+
+    AXIS2_PARAM_CHECK(env->error, request, -1);
+    AXIS2_PARAM_CHECK(env->error, response, -1);
+    *response = NULL;
+
+    memset(&exchange, 0, sizeof(axis2_http2_exchange_t));
+    if (pipe(exchange.wakeup))
+    {
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "Unable to create the HTTP/2 wake up pipe");
+        return -1;
+    }
+    /* the reader thread must never block on it */
+    fcntl(exchange.wakeup[1], F_SETFL,
+          fcntl(exchange.wakeup[1], F_GETFL) | O_NONBLOCK);
+
+    host_header = axis2_http_simple_request_get_first_header(request, env,
+                                                             AXIS2_HTTP_HEADER_HOST);
+    if (host_header)
+    {
+        authority = axutil_strdup(env, axis2_http_header_get_value(host_header,
+                                                                   env));
+    }
+    else
+    {
+        authority = AXIS2_MALLOC(env->allocator, axutil_strlen(host) + 16);
+        if (authority)
+        {
+            sprintf(authority, "%s:%d", host, port);
+        }
+    }
+
+    /* a stream the server did not process is sent again on a new
+       connection */
+    for (attempt = 0; authority && attempt < AXIS2_HTTP2_CLIENT_MAX_ATTEMPTS;
+         attempt++)
+    {
+        axis2_http2_client_conn_t *conn = NULL;
+
+        axis2_http2_client_exchange_reset(&exchange, env);
+        conn = axis2_http2_client_get_conn(client, env, host, port, &exchange);
+        if (!conn)
+        {
+            break;
+        }
+        status = axis2_http2_client_exchange(conn, env, &exchange, request,
+                                             authority, body, body_len,
+                                             timeout);
+        axis2_http2_client_leave(conn, env, &exchange);
+        if (AXIS2_SUCCESS == status || !exchange.refused)
+        {
+            break;
+        }
+        AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI,
+                        "HTTP/2 stream refused by %s:%d, sending again", host,
+                        port);
+    }
+
+    if (AXIS2_SUCCESS == status && exchange.status)
+    {
+        axutil_stream_t *body_stream = axutil_stream_create_basic(env);
+
+        *response = axis2_http_simple_response_create_default(env);
+        if (*response && body_stream)
+        {
+            int i = 0;
+
+            axis2_http_simple_response_set_status_line(*response, env,
+                                                       AXIS2_HTTP_HEADER_PROTOCOL_20,
+                                                       exchange.status, "");
+            for (i = 0; i < axutil_array_list_size(exchange.headers, env); i++)
+            {
+                axis2_http_header_t *header =
+                    axutil_array_list_get(exchange.headers, env, i);
+
+                if (':' == axis2_http_header_get_name(header, env)[0])
+                {
+                    axis2_http_header_free(header, env);
+                }
+                else
+                {
+                    axis2_http_simple_response_set_header(*response, env,
+                                                          header);
+                }
+            }
+            axutil_array_list_free(exchange.headers, env);
+            exchange.headers = NULL;
+            if (exchange.body_len > 0)
+            {
+                axutil_stream_write(body_stream, env, exchange.body,
+                                    exchange.body_len);
+            }
+            axis2_http_simple_response_set_body_stream(*response, env,
+                                                       body_stream);
+            status_code = exchange.status;
+        }
+        else
+        {
+            if (*response)
+            {
+                axis2_http_simple_response_free(*response, env);
+                *response = NULL;
+            }
+            if (body_stream)
+            {
+                axutil_stream_free(body_stream, env);
+            }
+        }
+    }
+    else if (AXIS2_SUCCESS != status)
+    {
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "HTTP/2 request to %s:%d failed", host,
+                        port);
+    }
+
+    axis2_http2_client_exchange_reset(&exchange, env);
+    close(exchange.wakeup[0]);
+    close(exchange.wakeup[1]);
+    if (authority)
+    {
+        AXIS2_FREE(env->allocator, authority);
+    }
+    return status_code;
+}
+
+AXIS2_EXTERN void AXIS2_CALL
+axis2_http2_client_free(
+    axis2_http2_client_t * client,
+    const axutil_env_t * env)
+{
+    if (!client)
+    {
+        return;
+    }
+    if (client->mutex && client->running && client->wakeup[0] != -1)
+    {
+        int i = 0;
+
+        /* the reader threads end as their sockets are shut down */
+        axutil_thread_mutex_lock(client->mutex);
+        for (i = 0; i < axutil_array_list_size(client->running, env); i++)
+        {
+            axis2_http2_client_conn_t *conn =
+                axutil_array_list_get(client->running, env, i);
+            shutdown(conn->socket, SHUT_RDWR);
+        }
+        while (axutil_array_list_size(client->running, env) > 0)
+        {
+            char wakeup = 0;
+
+            axutil_thread_mutex_unlock(client->mutex);
+            if (read(client->wakeup[0], &wakeup, 1) < 0 && EINTR != errno)
+            {
+                AXIS2_SLEEP(1);
+            }
+            axutil_thread_mutex_lock(client->mutex);
+        }
+        axutil_thread_mutex_unlock(client->mutex);
+    }
+    if (client->wakeup[0] != -1)
+    {
+        close(client->wakeup[0]);
+        close(client->wakeup[1]);
+    }
+    if (client->running)
+    {
+        axutil_array_list_free(client->running, env);
+    }
+    if (client->conns)
+    {
+        axutil_hash_free(client->conns, env);
+    }
+    if (client->mutex)
+    {
+        axutil_thread_mutex_destroy(client->mutex);
+    }
+    AXIS2_FREE(env->allocator, client);
+}
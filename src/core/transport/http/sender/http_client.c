@@ -55,6 +55,11 @@ struct axis2_http_client
     axutil_array_list_t *mime_parts;
     axis2_bool_t doing_mtom;
     axis2_char_t *mtom_sending_callback_name;
+
+    /* set when the requests go as HTTP/2 streams */
+    axis2_http2_client_t *http2_client;
+    /* status of the response received over HTTP/2 */
+    int http2_status;
 };
 
 AXIS2_EXTERN axis2_http_client_t *AXIS2_CALL
@@ -177,6 +182,43 @@ axis2_http_client_free_void_arg(
     return;
 }
 
+#ifndef WIN32
+/* Sends the request as a stream of the HTTP/2 client. The whole response
+ * is received, its body is read from a basic stream. */
+static axis2_status_t
+axis2_http_client_send_http2(
+    axis2_http_client_t * client,
+    const axutil_env_t * env,
+    axis2_http_simple_request_t * request)
+{
+    axis2_http_simple_response_t *response = NULL;
+
+    client->http2_status = axis2_http2_client_send(client->http2_client, env,
+        axutil_url_get_host(client->url, env),
+        axutil_url_get_port(client->url, env), request, client->req_body,
+        client->req_body_size, client->timeout, &response);
+    if (!response)
+    {
+        client->http2_status = 0;
+        AXIS2_HANDLE_ERROR(env, AXIS2_ERROR_HTTP_REQUEST_NOT_SENT,
+                           AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+    if (client->response)
+    {
+        axis2_http_simple_response_free(client->response, env);
+    }
+    if (client->data_stream)
+    {
+        axutil_stream_free(client->data_stream, env);
+    }
+    client->response = response;
+    client->data_stream = axis2_http_simple_response_get_body(response, env);
+    client->request_sent = AXIS2_TRUE;
+    return AXIS2_SUCCESS;
+}
+#endif
+
 /* This is the main method which writes to the socket in the case of a client 
  * sends an http_request. Previously this method does not distinguish between a 
  * mtom request and non mtom request. Because what finally it had was the 
@@ -225,6 +267,36 @@ axis2_http_client_send(
     host = axutil_url_get_host(client->url, env);
     port = axutil_url_get_port(client->url, env);
 
+#ifndef WIN32
+    if (client->http2_client)
+    {
+        if (!client->proxy_enabled && !client->doing_mtom &&
+            axutil_strcasecmp(axutil_url_get_protocol(client->url, env),
+                              AXIS2_TRANSPORT_URL_HTTPS))
+        {
+            return axis2_http_client_send_http2(client, env, request);
+        }
+        else
+        {
+            /* the version of the request line is the one HTTP/1.1 is
+               sent with */
+            axis2_http_request_line_t *request_line =
+                axis2_http_simple_request_get_request_line(request, env);
+
+            if (!axutil_strcasecmp(axis2_http_request_line_get_http_version(
+                        request_line, env), AXIS2_HTTP_HEADER_PROTOCOL_20))
+            {
+                axis2_http_simple_request_set_request_line(request, env,
+                    axis2_http_request_line_create(env,
+                        axis2_http_request_line_get_method(request_line, env),
+                        axis2_http_request_line_get_uri(request_line, env),
+                        AXIS2_HTTP_HEADER_PROTOCOL_11));
+                axis2_http_request_line_free(request_line, env);
+            }
+        }
+    }
+#endif
+
     if (-1 != client->sockfd)
     {
         axutil_network_handler_close_socket(env, client->sockfd);
@@ -548,6 +620,11 @@ axis2_http_client_recieve_header(
     axis2_bool_t end_of_line = AXIS2_FALSE;
     axis2_bool_t end_of_headers = AXIS2_FALSE;
 
+    if (client->http2_status && client->request_sent)
+    {
+        /* the response was received with the request */
+        return client->http2_status;
+    }
 
     if (-1 == client->sockfd || !client->data_stream ||
         AXIS2_FALSE == client->request_sent)
@@ -999,3 +1076,13 @@ axis2_http_client_set_mtom_sending_callback_name(
         callback_name;
     return AXIS2_SUCCESS;
 }
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_http_client_set_http2_client(
+    axis2_http_client_t * client,
+    const axutil_env_t * env,
+    axis2_http2_client_t * http2_client)
+{
+    client->http2_client = http2_client;
+    return AXIS2_SUCCESS;
+}
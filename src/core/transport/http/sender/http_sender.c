@@ -36,6 +36,7 @@
 #include <axiom_soap.h>
 #include <axutil_version.h>
 #include <axis2_ntlm.h>
+#include <axis2_http_transport_utils.h>
 
 #ifdef AXIS2_LIBCURL_ENABLED
 #include "libcurl/axis2_libcurl.h"
@@ -56,6 +57,7 @@ struct axis2_http_sender
     axiom_output_t *om_output;
     axis2_http_client_t *client;
     axis2_bool_t is_soap;
+    axis2_http2_client_t *http2_client;
 };
 
 
@@ -300,8 +302,8 @@ axis2_http_sender_send (axis2_http_sender_t * sender,
             data_out = axiom_node_get_first_element (body_node, env);
         }
 
-        method = (axutil_property_t *) axis2_msg_ctx_get_property (msg_ctx, env,
-                                                                   AXIS2_HTTP_METHOD);
+        method = (axutil_property_t *) axis2_msg_ctx_get_property_at (msg_ctx, env,
+                                                                      AXIS2_CTX_SLOT_HTTP_METHOD);
         if (method)
         {
             method_value = (axis2_char_t *) axutil_property_get_value (method,
@@ -351,6 +353,8 @@ axis2_http_sender_send (axis2_http_sender_t * sender,
                          "sender->client creation failed for url %s", url);
         return AXIS2_FAILURE;
     }
+    axis2_http_client_set_http2_client (sender->client, env,
+                                        sender->http2_client);
    
     /* We put the client into msg_ctx so that we can free it once the processing
      * is done at client side
@@ -644,8 +648,8 @@ axis2_http_sender_send (axis2_http_sender_t * sender,
 
 
     http_property =
-        axis2_msg_ctx_get_property (msg_ctx,
-                                    env, AXIS2_TRANSPORT_HEADER_PROPERTY);
+        axis2_msg_ctx_get_property_at (msg_ctx,
+                                       env, AXIS2_CTX_SLOT_TRANSPORT_HEADER_PROPERTY);
     if (http_property)
     {
         array_list = (axutil_array_list_t *)
@@ -805,9 +809,9 @@ axis2_http_sender_send (axis2_http_sender_t * sender,
         else
         {
             content_type_property = (axutil_property_t *)
-                axis2_msg_ctx_get_property (msg_ctx,
-                                            env,
-                                            AXIS2_USER_DEFINED_HTTP_HEADER_CONTENT_TYPE);
+                axis2_msg_ctx_get_property_at (msg_ctx,
+                                               env,
+                                               AXIS2_CTX_SLOT_USER_DEFINED_HTTP_HEADER_CONTENT_TYPE);
 
             if (content_type_property)
             {
@@ -848,9 +852,11 @@ axis2_http_sender_send (axis2_http_sender_t * sender,
     }
 
     if (0 ==
-        axutil_strcasecmp (sender->http_version, AXIS2_HTTP_HEADER_PROTOCOL_11))
+        axutil_strcasecmp (sender->http_version, AXIS2_HTTP_HEADER_PROTOCOL_11)
+        || 0 == axutil_strcasecmp (sender->http_version,
+                                   AXIS2_HTTP_HEADER_PROTOCOL_20))
     {
-        /* HTTP 1.1 */
+        /* HTTP 1.1, or HTTP/2 where it is sent as the authority */
         axis2_char_t *header = NULL;
         int host_len = 0;
         host_len = axutil_strlen (axutil_url_get_host (url, env));
@@ -873,6 +879,8 @@ axis2_http_sender_send (axis2_http_sender_t * sender,
     {
         axis2_http_simple_request_set_body_string (request,
                                                    env, buffer, buffer_size);
+        axis2_http_transport_utils_tee_output(env, msg_ctx, buffer,
+                                              buffer_size);
     }
     
 
@@ -904,8 +912,8 @@ axis2_http_sender_send (axis2_http_sender_t * sender,
     }
 
     test_auth_property = (axutil_property_t *)
-        axis2_msg_ctx_get_property (msg_ctx, env,
-                                    AXIS2_TEST_PROXY_AUTH);
+        axis2_msg_ctx_get_property_at (msg_ctx, env,
+                                       AXIS2_CTX_SLOT_TEST_PROXY_AUTH);
     if (test_auth_property)
     {
         test_auth_property_value = 
@@ -923,8 +931,8 @@ axis2_http_sender_send (axis2_http_sender_t * sender,
     test_auth_property_value = NULL;
 
     test_auth_property = 
-        (axutil_property_t *) axis2_msg_ctx_get_property (msg_ctx, env,
-                                                          AXIS2_TEST_HTTP_AUTH);
+        (axutil_property_t *) axis2_msg_ctx_get_property_at (msg_ctx, env,
+                                                             AXIS2_CTX_SLOT_TEST_HTTP_AUTH);
     if (test_auth_property)
     {
         test_auth_property_value = 
@@ -942,8 +950,8 @@ axis2_http_sender_send (axis2_http_sender_t * sender,
     if (!test_proxy_auth)
     {
         proxy_auth_property = 
-            (axutil_property_t *) axis2_msg_ctx_get_property (msg_ctx, env,
-                                                              AXIS2_FORCE_PROXY_AUTH);
+            (axutil_property_t *) axis2_msg_ctx_get_property_at (msg_ctx, env,
+                                                                 AXIS2_CTX_SLOT_FORCE_PROXY_AUTH);
     }
     if (proxy_auth_property)
     {
@@ -986,8 +994,8 @@ axis2_http_sender_send (axis2_http_sender_t * sender,
     if (!test_http_auth)
     {
         http_auth_property = (axutil_property_t *) 
-            axis2_msg_ctx_get_property (msg_ctx, env,
-                                        AXIS2_FORCE_HTTP_AUTH);
+            axis2_msg_ctx_get_property_at (msg_ctx, env,
+                                           AXIS2_CTX_SLOT_FORCE_HTTP_AUTH);
     }
 
     if (http_auth_property)
@@ -1661,7 +1669,7 @@ axis2_http_sender_get_timeout_values (axis2_http_sender_t * sender,
      * with axis2_options_set_timeout_in_milli_seconds
      */
     property =
-        axis2_msg_ctx_get_property(msg_ctx, env, AXIS2_HTTP_CONNECTION_TIMEOUT);
+        axis2_msg_ctx_get_property_at(msg_ctx, env, AXIS2_CTX_SLOT_HTTP_CONNECTION_TIMEOUT);
     if (property)
     {
         axis2_char_t *value = axutil_property_get_value(property, env);
@@ -1713,6 +1721,15 @@ axis2_http_sender_set_http_version (axis2_http_sender_t * sender,
     return AXIS2_SUCCESS;
 }
 
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_http_sender_set_http2_client (axis2_http_sender_t * sender,
+                                    const axutil_env_t * env,
+                                    axis2_http2_client_t * http2_client)
+{
+    sender->http2_client = http2_client;
+    return AXIS2_SUCCESS;
+}
+
 #ifndef AXIS2_LIBCURL_ENABLED
 static void
 axis2_http_sender_add_header_list (axis2_http_simple_request_t * request,
@@ -2301,9 +2318,9 @@ axis2_http_sender_configure_http_digest_auth (axis2_http_sender_t * sender,
             axutil_strlen(AXIS2_HTTP_AUTHORIZATION_REQUEST_PARAM_USERNAME) +
             axutil_strlen(uname);
 
-        method = (axutil_property_t *) axis2_msg_ctx_get_property (msg_ctx, 
-                                                                   env,
-                                                                   AXIS2_HTTP_METHOD);
+        method = (axutil_property_t *) axis2_msg_ctx_get_property_at (msg_ctx, 
+                                                                      env,
+                                                                      AXIS2_CTX_SLOT_HTTP_METHOD);
         if (method)
         {
             method_value = (axis2_char_t *) axutil_property_get_value (method,
@@ -2865,8 +2882,8 @@ axis2_http_sender_configure_proxy_digest_auth (axis2_http_sender_t * sender,
             + axutil_strlen(uname);
 
         method = (axutil_property_t *) 
-            axis2_msg_ctx_get_property (msg_ctx, env,
-                                        AXIS2_HTTP_METHOD);
+            axis2_msg_ctx_get_property_at (msg_ctx, env,
+                                           AXIS2_CTX_SLOT_HTTP_METHOD);
         if (method)
         {
             method_value = (axis2_char_t *) axutil_property_get_value (method,
@@ -3335,8 +3352,8 @@ axis2_http_sender_configure_http_auth (axis2_http_sender_t * sender,
     axis2_char_t *auth_type_end = NULL;
 
     http_auth_property = 
-        (axutil_property_t *)axis2_msg_ctx_get_property (msg_ctx, env,
-                                                         AXIS2_FORCE_HTTP_AUTH);
+        (axutil_property_t *)axis2_msg_ctx_get_property_at (msg_ctx, env,
+                                                            AXIS2_CTX_SLOT_FORCE_HTTP_AUTH);
     if (http_auth_property)
     {
         http_auth_property_value = 
@@ -3447,8 +3464,8 @@ axis2_http_sender_configure_proxy_auth (axis2_http_sender_t * sender,
     axis2_char_t *auth_type_end = NULL;
 
     proxy_auth_property = 
-        (axutil_property_t *) axis2_msg_ctx_get_property (msg_ctx, env,
-                                                          AXIS2_FORCE_PROXY_AUTH);
+        (axutil_property_t *) axis2_msg_ctx_get_property_at (msg_ctx, env,
+                                                             AXIS2_CTX_SLOT_FORCE_PROXY_AUTH);
     if (proxy_auth_property)
     {
         proxy_auth_property_value = 
@@ -26,6 +26,7 @@
 #include <axis2_http_out_transport_info.h>
 #include <axis2_http_transport.h>
 #include <axis2_http_sender.h>
+#include <axis2_http2_client.h>
 #include <axiom_soap_body.h>
 #include <axutil_types.h>
 #include <axiom_soap_fault_detail.h>
@@ -51,6 +52,8 @@ typedef struct axis2_http_transport_sender_impl
     axis2_bool_t chunked;
     int connection_timeout;
     int so_timeout;
+    /* shared by the threads sending when the version is HTTP/2.0 */
+    axis2_http2_client_t *http2_client;
 #ifdef AXIS2_LIBCURL_ENABLED
     axis2_libcurl_t *libcurl;
 #endif
@@ -157,6 +160,13 @@ axis2_http_transport_sender_free(
         transport_sender_impl->http_version = NULL;
     }
 
+#ifndef WIN32
+    if (transport_sender_impl->http2_client)
+    {
+        axis2_http2_client_free(transport_sender_impl->http2_client, env);
+    }
+#endif
+
 #ifdef AXIS2_LIBCURL_ENABLED
     if (transport_sender_impl->libcurl)
     {
@@ -213,8 +223,8 @@ axis2_http_transport_sender_invoke(
             axis2_ctx_t *ctx = axis2_op_ctx_get_base(op_ctx, env);
             if (ctx)
             {
-                property = axis2_ctx_get_property(ctx, env,
-                                                  AXIS2_CHARACTER_SET_ENCODING);
+                property = axis2_ctx_get_property_at(ctx, env,
+                                                     AXIS2_CTX_SLOT_CHARACTER_SET_ENCODING);
                 if (property)
                 {
                     char_set_enc = axutil_property_get_value(property, env);
@@ -660,6 +670,8 @@ AXIS2_XML_PARSER_TYPE_BUFFER");
                      * function and then copied to the out message context. 
                      */
                     axutil_stream_write(out_stream, env, buffer, buffer_size);
+                    axis2_http_transport_utils_tee_output(env, msg_ctx, buffer,
+                                                          buffer_size);
                 }
             }
 
@@ -778,6 +790,29 @@ axis2_http_transport_sender_init(
                 axutil_strdup(env, version);
             AXIS2_INTF_TO_IMPL(transport_sender)->chunked = AXIS2_FALSE;
         }
+#ifndef WIN32
+        else if (0 == axutil_strcmp(version, AXIS2_HTTP_HEADER_PROTOCOL_20))
+        {
+            /* Handling HTTP/2, bodies are sent as DATA frames */
+            if (AXIS2_INTF_TO_IMPL(transport_sender)->http_version)
+            {
+                AXIS2_FREE(env->allocator,
+                           AXIS2_INTF_TO_IMPL(transport_sender)->http_version);
+            }
+            AXIS2_INTF_TO_IMPL(transport_sender)->http_version =
+                axutil_strdup(env, version);
+            AXIS2_INTF_TO_IMPL(transport_sender)->chunked = AXIS2_FALSE;
+            if (!AXIS2_INTF_TO_IMPL(transport_sender)->http2_client)
+            {
+                AXIS2_INTF_TO_IMPL(transport_sender)->http2_client =
+                    axis2_http2_client_create(env);
+                if (!AXIS2_INTF_TO_IMPL(transport_sender)->http2_client)
+                {
+                    return AXIS2_FAILURE;
+                }
+            }
+        }
+#endif
     }
     else
     {
@@ -881,6 +916,8 @@ axis2_http_transport_sender_write_message(
             AXIS2_INTF_TO_IMPL(transport_sender)->chunked);
         AXIS2_HTTP_SENDER_SET_HTTP_VERSION(sender, env,
             AXIS2_INTF_TO_IMPL(transport_sender)->http_version);
+        axis2_http_sender_set_http2_client(sender, env,
+            AXIS2_INTF_TO_IMPL(transport_sender)->http2_client);
     }
     AXIS2_HTTP_SENDER_SET_OM_OUTPUT(sender, env, om_output);
 
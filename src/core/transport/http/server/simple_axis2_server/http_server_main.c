@@ -33,6 +33,10 @@
 axutil_env_t *system_env = NULL;
 axis2_transport_receiver_t *server = NULL;
 AXIS2_IMPORT extern int axis2_http_socket_read_timeout;
+AXIS2_IMPORT extern int axis2_http_keep_alive_timeout;
+AXIS2_IMPORT extern int axis2_http_keep_alive_max_requests;
+AXIS2_IMPORT extern int axis2_http_max_pipeline_depth;
+AXIS2_IMPORT extern int axis2_http2_max_concurrent_streams;
 AXIS2_IMPORT extern axis2_char_t *axis2_request_url_prefix;
 
 #define DEFAULT_REPO_PATH "../"
@@ -116,7 +120,7 @@ main(
        set with AXIS2_REQUEST_URL_PREFIX macro at compile time */
     axis2_request_url_prefix = AXIS2_REQUEST_URL_PREFIX;
 
-    while ((c = AXIS2_GETOPT(argc, argv, ":p:r:ht:l:s:f:")) != -1)
+    while ((c = AXIS2_GETOPT(argc, argv, ":p:r:ht:k:n:d:m:l:s:f:")) != -1)
     {
 
         switch (c)
@@ -130,6 +134,18 @@ main(
         case 't':
             axis2_http_socket_read_timeout = AXIS2_ATOI(optarg) * 1000;
             break;
+        case 'k':
+            axis2_http_keep_alive_timeout = AXIS2_ATOI(optarg) * 1000;
+            break;
+        case 'n':
+            axis2_http_keep_alive_max_requests = AXIS2_ATOI(optarg);
+            break;
+        case 'd':
+            axis2_http_max_pipeline_depth = AXIS2_ATOI(optarg);
+            break;
+        case 'm':
+            axis2_http2_max_concurrent_streams = AXIS2_ATOI(optarg);
+            break;
         case 'l':
             log_level = AXIS2_ATOI(optarg);
             if (log_level < AXIS2_LOG_LEVEL_CRITICAL)
@@ -184,6 +200,13 @@ main(
     AXIS2_LOG_INFO(env->log, "Repo location : %s", repo_path);
     AXIS2_LOG_INFO(env->log, "Read Timeout : %d ms",
                    axis2_http_socket_read_timeout);
+    AXIS2_LOG_INFO(env->log, "Keep Alive : %d ms, %d requests, "
+                   "pipeline depth %d",
+                   axis2_http_keep_alive_timeout,
+                   axis2_http_keep_alive_max_requests,
+                   axis2_http_max_pipeline_depth);
+    AXIS2_LOG_INFO(env->log, "HTTP/2 : %d concurrent streams",
+                   axis2_http2_max_concurrent_streams);
 	
 	status = axutil_file_handler_access (repo_path, AXIS2_R_OK);
 	if (status == AXIS2_SUCCESS)
@@ -238,6 +261,10 @@ usage(
     fprintf(stdout, "\n Usage : %s", prog_name);
     fprintf(stdout, " [-p PORT]");
     fprintf(stdout, " [-t TIMEOUT]");
+    fprintf(stdout, " [-k KEEP_ALIVE_TIMEOUT]");
+    fprintf(stdout, " [-n KEEP_ALIVE_REQUESTS]");
+    fprintf(stdout, " [-d PIPELINE_DEPTH]");
+    fprintf(stdout, " [-m HTTP2_STREAMS]");
     fprintf(stdout, " [-r REPO_PATH]");
     fprintf(stdout, " [-l LOG_LEVEL]");
     fprintf(stdout, " [-f LOG_FILE]\n");
@@ -247,6 +274,18 @@ usage(
     fprintf(stdout, "\t-r REPO_PATH \t repository path, default is ../\n");
     fprintf(stdout,
             "\t-t TIMEOUT\t socket read timeout, default is 30 seconds\n");
+    fprintf(stdout,
+            "\t-k KEEP_ALIVE_TIMEOUT\t seconds to wait for the next request on"
+            "\n\t\t\t a connection kept alive, default is 15, 0 disables keep alive\n");
+    fprintf(stdout,
+            "\t-n KEEP_ALIVE_REQUESTS\t requests served on one connection,"
+            " default is 100\n");
+    fprintf(stdout,
+            "\t-d PIPELINE_DEPTH\t requests a client may send in a row before"
+            "\n\t\t\t reading a response, default is 16\n");
+    fprintf(stdout,
+            "\t-m HTTP2_STREAMS\t HTTP/2 streams a client may have open on a"
+            "\n\t\t\t connection, default is 100, 0 disables HTTP/2\n");
     fprintf(stdout,
             "\t-l LOG_LEVEL\t log level, available log levels:"
             "\n\t\t\t 0 - critical    1 - errors 2 - warnings"
@@ -195,13 +195,24 @@ axis2_http_transport_utils_handle_media_type_url_encoded(
     axutil_hash_t * param_map,
     axis2_char_t * method);
 
+static void
+axis2_http_transport_utils_start_tee(
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx,
+    axis2_callback_info_t * callback_ctx);
+
+static void
+axis2_http_transport_utils_log_tee(
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx,
+    axis2_callback_info_t * callback_ctx);
+
 static axis2_status_t
 axis2_http_transport_utils_send_attachment_using_file(
     const axutil_env_t * env,
     axutil_http_chunked_stream_t *chunked_stream,
     FILE *fp,
-    axis2_byte_t *buffer,
-    int buffer_size);
+    size_t file_size);
 
 static axis2_status_t
 axis2_http_transport_utils_send_attachment_using_callback(
@@ -326,6 +337,9 @@ axis2_http_transport_utils_process_http_post_request(
     callback_ctx->content_length = content_length;
     callback_ctx->unread_len = content_length;
     callback_ctx->chunked_stream = NULL;
+    callback_ctx->tee = NULL;
+    callback_ctx->tee_max = 0;
+    axis2_http_transport_utils_start_tee(env, msg_ctx, callback_ctx);
 
     soap_action =
         (axis2_char_t *) axutil_string_get_buffer(soap_action_header, env);
@@ -556,6 +570,8 @@ axis2_http_transport_utils_process_http_post_request(
                     mime_cb_ctx->content_length = callback_ctx->content_length;
                     mime_cb_ctx->unread_len = callback_ctx->unread_len;
                     mime_cb_ctx->chunked_stream = callback_ctx->chunked_stream;
+                    mime_cb_ctx->tee = callback_ctx->tee;
+                    mime_cb_ctx->tee_max = callback_ctx->tee_max;
                 }
             }
 
@@ -565,6 +581,7 @@ axis2_http_transport_utils_process_http_post_request(
                 axutil_stream_write(stream, env, soap_body_str, soap_body_len);
                 callback_ctx->in_stream = stream;
                 callback_ctx->chunked_stream = NULL;
+                callback_ctx->tee = NULL;
                 callback_ctx->content_length = soap_body_len;
                 callback_ctx->unread_len = soap_body_len;
             }
@@ -901,6 +918,7 @@ axis2_http_transport_utils_process_http_post_request(
     {
         status = axis2_engine_receive(engine, env, msg_ctx);
     }
+    axis2_http_transport_utils_log_tee(env, msg_ctx, callback_ctx);
 
     if (!axis2_msg_ctx_get_soap_envelope(msg_ctx, env) &&
         AXIS2_FALSE == is_soap11)
@@ -997,6 +1015,9 @@ axis2_http_transport_utils_process_http_put_request(
     callback_ctx->content_length = content_length;
     callback_ctx->unread_len = content_length;
     callback_ctx->chunked_stream = NULL;
+    callback_ctx->tee = NULL;
+    callback_ctx->tee_max = 0;
+    axis2_http_transport_utils_start_tee(env, msg_ctx, callback_ctx);
 
 
     headers = axis2_msg_ctx_get_transport_headers(msg_ctx, env);
@@ -1154,6 +1175,7 @@ axis2_http_transport_utils_process_http_put_request(
                 axutil_stream_write(stream, env, soap_body_str, soap_body_len);
                 callback_ctx->in_stream = stream;
                 callback_ctx->chunked_stream = NULL;
+                callback_ctx->tee = NULL;
                 callback_ctx->content_length = soap_body_len;
                 callback_ctx->unread_len = soap_body_len;
             }
@@ -1431,6 +1453,7 @@ axis2_http_transport_utils_process_http_put_request(
     {
         status = axis2_engine_receive(engine, env, msg_ctx);
     }
+    axis2_http_transport_utils_log_tee(env, msg_ctx, callback_ctx);
     if (!axis2_msg_ctx_get_soap_envelope(msg_ctx, env) &&
         AXIS2_FALSE == is_soap11)
     {
@@ -2290,9 +2313,137 @@ axis2_http_transport_utils_on_data_request(
             ((axis2_callback_info_t *) ctx)->unread_len = 0;
         }
     }
+    if (len > 0 && cb_ctx->tee &&
+        axutil_stream_get_len(cb_ctx->tee, env) < cb_ctx->tee_max)
+    {
+        int room = cb_ctx->tee_max - axutil_stream_get_len(cb_ctx->tee, env);
+
+        axutil_stream_write(cb_ctx->tee, env, buffer, len < room ? len : room);
+    }
     return len;
 }
 
+/* Keeps a copy of the first bytes of the message read through callback_ctx
+   when the configuration asks for one; see AXIS2_TRANSPORT_TEE_IN */
+static void
+axis2_http_transport_utils_start_tee(
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx,
+    axis2_callback_info_t * callback_ctx)
+{
+    axutil_property_t *property = NULL;
+    axutil_stream_t *tee = NULL;
+    int tee_max = 0;
+
+    property = axis2_msg_ctx_get_property(msg_ctx, env, AXIS2_TRANSPORT_TEE_IN);
+    if (property && axutil_property_get_value(property, env))
+    {
+        tee_max = atoi((axis2_char_t *) axutil_property_get_value(property, env));
+    }
+    if (tee_max <= 0)
+    {
+        return;
+    }
+    tee = axutil_stream_create_basic(env);
+    if (!tee)
+    {
+        return;
+    }
+    property = axutil_property_create_with_args(env, AXIS2_SCOPE_REQUEST,
+                                                AXIS2_TRUE,
+                                                axutil_stream_free_void_arg,
+                                                tee);
+    if (!property)
+    {
+        axutil_stream_free(tee, env);
+        return;
+    }
+    axis2_msg_ctx_set_property(msg_ctx, env, AXIS2_TRANSPORT_TEE_DATA, property);
+    callback_ctx->tee = tee;
+    callback_ctx->tee_max = tee_max;
+}
+
+/* Logs the copy kept of a request once the engine is done with it, when the
+   message context asks for it with AXIS2_TRANSPORT_TEE_LOG. Deferred bodies
+   may not have been read to the end by then, so what is left is read into
+   the copy first, up to the size of the copy */
+static void
+axis2_http_transport_utils_log_tee(
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx,
+    axis2_callback_info_t * callback_ctx)
+{
+    axutil_property_t *property = NULL;
+    axutil_stream_t *tee = NULL;
+    axis2_char_t buffer[AXIS2_STREAM_DEFAULT_BUF_SIZE];
+    int log_max = 0;
+    int len = 0;
+
+    property = axis2_msg_ctx_get_property(msg_ctx, env,
+                                          AXIS2_TRANSPORT_TEE_LOG);
+    if (property && axutil_property_get_value(property, env))
+    {
+        log_max = atoi((axis2_char_t *) axutil_property_get_value(property, env));
+    }
+    property = axis2_msg_ctx_get_property(msg_ctx, env,
+                                          AXIS2_TRANSPORT_TEE_DATA);
+    tee = property ?
+        (axutil_stream_t *) axutil_property_get_value(property, env) : NULL;
+    if (log_max <= 0 || !tee)
+    {
+        return;
+    }
+
+    /* MIME requests are read to the end of the SOAP part before they are
+       dispatched, and no longer read through the copy */
+    if (callback_ctx && callback_ctx->tee == tee)
+    {
+        while (axutil_stream_get_len(tee, env) < callback_ctx->tee_max)
+        {
+            if (axis2_http_transport_utils_on_data_request(buffer,
+                                                           sizeof(buffer),
+                                                           callback_ctx) <= 0)
+            {
+                break;
+            }
+        }
+        /* The rest of the request is drained unread, and not copied */
+        callback_ctx->tee = NULL;
+    }
+
+    len = axutil_stream_get_len(tee, env);
+    AXIS2_LOG_INFO(env->log, "Input message: %.*s%s",
+                   len < log_max ? len : log_max,
+                   (axis2_char_t *) axutil_stream_get_buffer(tee, env),
+                   len > log_max || (callback_ctx &&
+                                     len >= callback_ctx->tee_max) ?
+                   " ..." : "");
+}
+
+AXIS2_EXTERN void AXIS2_CALL
+axis2_http_transport_utils_tee_output(
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx,
+    const axis2_char_t * buffer,
+    int size)
+{
+    axutil_property_t *property = NULL;
+    int tee_max = 0;
+
+    property = axis2_msg_ctx_get_property(msg_ctx, env,
+                                          AXIS2_TRANSPORT_TEE_OUT);
+    if (property && axutil_property_get_value(property, env))
+    {
+        tee_max = atoi((axis2_char_t *) axutil_property_get_value(property, env));
+    }
+    if (tee_max > 0 && buffer && size > 0)
+    {
+        AXIS2_LOG_INFO(env->log, "Output message: %.*s%s",
+                       size < tee_max ? size : tee_max, buffer,
+                       size > tee_max ? " ..." : "");
+    }
+}
+
 AXIS2_EXTERN axiom_soap_envelope_t *AXIS2_CALL
 axis2_http_transport_utils_create_soap_msg(
     const axutil_env_t * env,
@@ -2314,7 +2465,7 @@ axis2_http_transport_utils_create_soap_msg(
     AXIS2_PARAM_CHECK(env->error, msg_ctx, NULL);
     AXIS2_PARAM_CHECK(env->error, soap_ns_uri, NULL);
 
-    property = axis2_msg_ctx_get_property(msg_ctx, env, AXIS2_TRANSPORT_IN);
+    property = axis2_msg_ctx_get_property_at(msg_ctx, env, AXIS2_CTX_SLOT_TRANSPORT_IN);
     if (property)
     {
         in_stream = axutil_property_get_value(property, env);
@@ -2333,9 +2484,11 @@ axis2_http_transport_utils_create_soap_msg(
     callback_ctx->content_length = -1;
     callback_ctx->unread_len = -1;
     callback_ctx->chunked_stream = NULL;
+    callback_ctx->tee = NULL;
+    callback_ctx->tee_max = 0;
 
-    property = axis2_msg_ctx_get_property(msg_ctx, env,
-                                          AXIS2_HTTP_HEADER_CONTENT_LENGTH);
+    property = axis2_msg_ctx_get_property_at(msg_ctx, env,
+                                             AXIS2_CTX_SLOT_HTTP_HEADER_CONTENT_LENGTH);
     if (property)
     {
         content_length = axutil_property_get_value(property, env);
@@ -2375,15 +2528,15 @@ axis2_http_transport_utils_create_soap_msg(
         axis2_ctx_t *ctx = axis2_op_ctx_get_base(op_ctx, env);
         if (ctx)
         {
-            property = axis2_ctx_get_property(ctx, env,
-                                              AXIS2_CHARACTER_SET_ENCODING);
+            property = axis2_ctx_get_property_at(ctx, env,
+                                                 AXIS2_CTX_SLOT_CHARACTER_SET_ENCODING);
             if (property)
             {
                 char_set_enc = axutil_property_get_value(property, env);
                 property = NULL;
             }
-            property = axis2_ctx_get_property(ctx, env,
-                                              MTOM_RECIVED_CONTENT_TYPE);
+            property = axis2_ctx_get_property_at(ctx, env,
+                                                 AXIS2_CTX_SLOT_MTOM_RECEIVED_CONTENT_TYPE);
             if (property)
             {
                 content_type = axutil_property_get_value(property, env);
@@ -2530,6 +2683,7 @@ axis2_http_transport_utils_create_soap_msg(
                 axutil_stream_write(stream, env, soap_body_str, soap_body_len);
                 callback_ctx->in_stream = stream;
                 callback_ctx->chunked_stream = NULL;
+                callback_ctx->tee = NULL;
                 callback_ctx->content_length = soap_body_len;
                 callback_ctx->unread_len = soap_body_len;
             }
@@ -2590,13 +2744,30 @@ axis2_http_transport_utils_create_soap_msg(
 
         if (soap_envelope)
         {
-            /* hack to get around MTOM problem */
+            /* The stream is freed below, so the body is built now, or kept
+               as text when it is only passed on */
             axiom_soap_body_t *soap_body =
                 axiom_soap_envelope_get_body(soap_envelope, env);
-
-            if (soap_body)
+            axiom_node_t *body_node = soap_body ?
+                axiom_soap_body_get_base_node(soap_body, env) : NULL;
+            axutil_property_t *passthrough_property =
+                axis2_msg_ctx_get_property(msg_ctx, env,
+                                           AXIS2_PASSTHROUGH_BODY);
+
+            if (body_node && passthrough_property &&
+                !axutil_strcmp(axutil_property_get_value(passthrough_property,
+                                                         env),
+                               AXIS2_VALUE_TRUE))
+            {
+                axiom_soap_body_capture_content(soap_body, env);
+            }
+            while (body_node && !axiom_node_is_complete(body_node, env))
             {
-                axiom_soap_body_has_fault(soap_body, env);
+                if (axiom_soap_builder_next(soap_builder, env) ==
+                    AXIS2_FAILURE)
+                {
+                    break;
+                }
             }
         }
 		if(stream)
@@ -3539,7 +3710,7 @@ axis2_http_transport_utils_send_mtom_message(
     int i = 0;
     axiom_mime_part_t *mime_part = NULL;
     axis2_status_t status = AXIS2_SUCCESS;
-    int written = 0;
+    size_t written = 0;
     int len = 0;    
 
     if(mime_parts)
@@ -3568,19 +3739,18 @@ axis2_http_transport_utils_send_mtom_message(
                     }
                     else
                     {
-                        written += len;
+                        written += (size_t) len;
                     }
                 }
             }
             
-            /* If it is a file we load a very little portion to memory 
-             * and send it as chunked , we keep on doing this until we find
-             * the end of the file */ 
+            /* If it is a file we send it as one chunk, several above 1GB.
+             * The chunk framing is written around the file content so that
+             * plain sockets can use sendfile instead of copying it through
+             * memory */ 
             else if((mime_part->type) == AXIOM_MIME_PART_FILE)
             {
                 FILE *f = NULL;
-                axis2_byte_t *output_buffer = NULL;                
-                int output_buffer_size = 0;
 
                 f = fopen(mime_part->file_name, "rb");
                 if (!f)
@@ -3591,24 +3761,9 @@ axis2_http_transport_utils_send_mtom_message(
                     return AXIS2_FAILURE;
                 }
                 
-                /*If the part_size is less than the defined buffer size then 
-                 *from the first write to the wire we can send the file */
-                
-                if(mime_part->part_size > AXIS2_MTOM_OUTPUT_BUFFER_SIZE)
-                {
-                    output_buffer_size = AXIS2_MTOM_OUTPUT_BUFFER_SIZE;
-                }
-                else
-                {
-                    output_buffer_size = mime_part->part_size;
-                }
-               
-                output_buffer =  AXIS2_MALLOC(env->allocator, 
-                    (output_buffer_size + 1) * sizeof(axis2_char_t));
- 
                 /*This is the method responsible for writing to the wire */    
                 status = axis2_http_transport_utils_send_attachment_using_file(env, chunked_stream, 
-                    f, output_buffer, output_buffer_size);
+                    f, mime_part->part_size);
                 if(status == AXIS2_FAILURE)
                 {
                     return status;
@@ -3688,88 +3843,30 @@ axis2_http_transport_utils_send_attachment_using_file(
     const axutil_env_t * env,
     axutil_http_chunked_stream_t *chunked_stream,
     FILE *fp,
-    axis2_byte_t *buffer,
-    int buffer_size)
+    size_t file_size)
 {
+    axis2_status_t status = AXIS2_SUCCESS;
 
-    int count = 0;     
-    int len = 0;
-    int written = 0;
-    axis2_status_t status = AXIS2_SUCCESS;   
- 
-    /*We do not load the whole file to memory. Just load a buffer_size portion
-     *and send it. Keep on doing this until the end of file */
-    
-    do
-    {
-        count = (int)fread(buffer, 1, buffer_size + 1, fp);
-        if (ferror(fp))
-        {
-            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
-                "Error in reading file containg the attachment");
-            if (buffer)
-            {
-                AXIS2_FREE(env->allocator, buffer);
-                buffer = NULL;
-            }
-            fclose(fp);
-            return AXIS2_FAILURE;
-        }
-
-        /*Writing the part we loaded to memory to the wire*/
-        if(count > 0)
-        {
-            written = 0;
-            while(written < count)
-            {
-                len = 0;
-                len = axutil_http_chunked_stream_write(chunked_stream, env,
-                    buffer + written, count - written);
-                if (len == -1)
-                {
-                    status = AXIS2_FAILURE;
-                    break;
-                }
-                else
-                {
-                    written += len;
-                }
-            }
-        }
-        else
-        {
-            if (buffer)
-            {
-                AXIS2_FREE(env->allocator, buffer);
-                buffer = NULL;
-            }
-            fclose(fp);
-            return AXIS2_FAILURE;
-        }  
-        
-        /*We keep on loading the next part to the same buffer. So need to reset 
-         * te buffer */
-        memset(buffer, 0, buffer_size);    
-        if(status == AXIS2_FAILURE)
-        {
-            if (buffer)
-            {
-                AXIS2_FREE(env->allocator, buffer);
-                buffer = NULL;
-            }
-            fclose(fp);
-            return AXIS2_FAILURE;
-        } 
-    }
-    while(!feof(fp));
-    
-    if(buffer)
+    /* An empty chunk would terminate the chunked body, so there is
+     * nothing to write for an empty file */
+    if(0 == file_size)
     {
-        AXIS2_FREE(env->allocator, buffer);    
-        buffer = NULL;
+        fclose(fp);
+        return AXIS2_SUCCESS;
     }
 
+    /* The file goes out as one chunk per GB; axutil_stream_send_file does
+     * not load it to memory on plain sockets, and otherwise copies it
+     * through a small buffer */
+    status = axutil_http_chunked_stream_write_file(chunked_stream, env, fp,
+        file_size);
     fclose(fp);
+    if(status != AXIS2_SUCCESS)
+    {
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+            "Error in sending the file containg the attachment");
+        return AXIS2_FAILURE;
+    }
     return AXIS2_SUCCESS;    
 }
 
@@ -0,0 +1,73 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AXIS2_LOCAL_TRANSPORT_SENDER_H
+#define AXIS2_LOCAL_TRANSPORT_SENDER_H
+
+/**
+ * @defgroup axis2_core_trans_local local transport
+ * @ingroup axis2_transport
+ * The local transport calls services deployed in the configuration of the
+ * client itself, in the calling thread, without serializing messages. The
+ * sender hands the request envelope to the in flow of the engine and the
+ * response envelope back to the client, so both sides work on the same OM
+ * trees. Addresses take the form local://host/axis2/services/echo, of which
+ * only the service and operation parts are used.
+ *
+ * A service calling another service deployed next to it shares the
+ * configuration context of the server by creating its service client with
+ * axis2_svc_client_create_with_conf_ctx_and_svc. The DEEP_COPY parameter
+ * of the transport makes each side work on a copy of the messages instead,
+ * for services that change or keep what they are given.
+ * @{
+ */
+
+/**
+ * @file axis2_local_transport_sender.h
+ * @brief axis2 local transport sender implementation
+ */
+
+#include <axis2_const.h>
+#include <axis2_defines.h>
+#include <axutil_env.h>
+#include <axis2_msg_ctx.h>
+#include <axis2_conf_ctx.h>
+#include <axis2_transport_out_desc.h>
+#include <axis2_transport_sender.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /** Transport sender parameter; when true each side gets a copy of the
+        messages instead of the trees of the other side */
+#define AXIS2_LOCAL_DEEP_COPY "DEEP_COPY"
+
+    /**
+     * @param env pointer to environment struct
+     */
+    AXIS2_EXTERN axis2_transport_sender_t *AXIS2_CALL
+    axis2_local_transport_sender_create(
+        const axutil_env_t * env);
+
+    /** @} */
+#ifdef __cplusplus
+}
+#endif
+
+#endif                          /* AXIS2_LOCAL_TRANSPORT_SENDER_H */
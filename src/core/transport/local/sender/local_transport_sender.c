@@ -0,0 +1,504 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <axis2_local_transport_sender.h>
+#include <axutil_string.h>
+#include <axis2_endpoint_ref.h>
+#include <axis2_engine.h>
+#include <axis2_op_ctx.h>
+#include <axiom_xml_writer.h>
+#include <axiom_xml_reader.h>
+#include <axiom_output.h>
+#include <axiom_soap.h>
+
+/**
+ * Local Transport Sender struct impl
+ */
+
+typedef struct axis2_local_transport_sender_impl
+{
+    axis2_transport_sender_t transport_sender;
+
+    /* Give each side a copy of the messages of the other */
+    axis2_bool_t deep_copy;
+} axis2_local_transport_sender_impl_t;
+
+#define AXIS2_INTF_TO_IMPL(transport_sender)    \
+    ((axis2_local_transport_sender_impl_t *)    \
+     (transport_sender))
+
+/***************************** Function headers *******************************/
+axis2_status_t AXIS2_CALL axis2_local_transport_sender_invoke(
+    axis2_transport_sender_t * transport_sender,
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx);
+
+axis2_status_t AXIS2_CALL axis2_local_transport_sender_clean_up(
+    axis2_transport_sender_t * transport_sender,
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx);
+
+axis2_status_t AXIS2_CALL axis2_local_transport_sender_init(
+    axis2_transport_sender_t * transport_sender,
+    const axutil_env_t * env,
+    axis2_conf_ctx_t * conf_ctx,
+    axis2_transport_out_desc_t * out_desc);
+
+void AXIS2_CALL axis2_local_transport_sender_free(
+    axis2_transport_sender_t * transport_sender,
+    const axutil_env_t * env);
+
+static const axis2_transport_sender_ops_t local_transport_sender_ops_var = {
+    axis2_local_transport_sender_init,
+    axis2_local_transport_sender_invoke,
+    axis2_local_transport_sender_clean_up,
+    axis2_local_transport_sender_free
+};
+
+axis2_transport_sender_t *AXIS2_CALL
+axis2_local_transport_sender_create(
+    const axutil_env_t * env)
+{
+    axis2_local_transport_sender_impl_t *transport_sender_impl = NULL;
+    AXIS2_ENV_CHECK(env, NULL);
+
+    transport_sender_impl = (axis2_local_transport_sender_impl_t *)
+        AXIS2_MALLOC(env->allocator,
+                     sizeof(axis2_local_transport_sender_impl_t));
+    if (!transport_sender_impl)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
+    transport_sender_impl->deep_copy = AXIS2_FALSE;
+    transport_sender_impl->transport_sender.ops =
+        &local_transport_sender_ops_var;
+    return &(transport_sender_impl->transport_sender);
+}
+
+void AXIS2_CALL
+axis2_local_transport_sender_free(
+    axis2_transport_sender_t * transport_sender,
+    const axutil_env_t * env)
+{
+    AXIS2_FREE(env->allocator, AXIS2_INTF_TO_IMPL(transport_sender));
+    return;
+}
+
+/* Copies an envelope by serializing it and building the result again. The
+   copy is built completely, as the serialized form is freed on return */
+static axiom_soap_envelope_t *
+axis2_local_transport_sender_copy_envelope(
+    const axutil_env_t * env,
+    axiom_soap_envelope_t * envelope)
+{
+    axiom_xml_writer_t *xml_writer = NULL;
+    axiom_output_t *om_output = NULL;
+    axiom_xml_reader_t *reader = NULL;
+    axiom_stax_builder_t *builder = NULL;
+    axiom_soap_builder_t *soap_builder = NULL;
+    axiom_soap_envelope_t *copy = NULL;
+    axiom_node_t *copy_node = NULL;
+    axis2_char_t *buffer = NULL;
+    const axis2_char_t *soap_ns = AXIOM_SOAP12_SOAP_ENVELOPE_NAMESPACE_URI;
+
+    if (AXIOM_SOAP11 == axiom_soap_envelope_get_soap_version(envelope, env))
+    {
+        soap_ns = AXIOM_SOAP11_SOAP_ENVELOPE_NAMESPACE_URI;
+    }
+
+    xml_writer = axiom_xml_writer_create_for_memory(env, NULL, AXIS2_TRUE, 0,
+                                                    AXIS2_XML_PARSER_TYPE_BUFFER);
+    if (!xml_writer)
+    {
+        return NULL;
+    }
+    om_output = axiom_output_create(env, xml_writer);
+    if (!om_output)
+    {
+        axiom_xml_writer_free(xml_writer, env);
+        return NULL;
+    }
+    axiom_soap_envelope_serialize(envelope, env, om_output, AXIS2_FALSE);
+    buffer = (axis2_char_t *) axiom_xml_writer_get_xml(xml_writer, env);
+
+    if (buffer)
+    {
+        reader = axiom_xml_reader_create_for_memory(env, buffer,
+                                                    axiom_xml_writer_get_xml_size
+                                                    (xml_writer, env), NULL,
+                                                    AXIS2_XML_PARSER_TYPE_BUFFER);
+    }
+    if (reader)
+    {
+        builder = axiom_stax_builder_create(env, reader);
+        if (!builder)
+        {
+            axiom_xml_reader_free(reader, env);
+        }
+    }
+    if (builder)
+    {
+        soap_builder = axiom_soap_builder_create(env, builder, soap_ns);
+        if (!soap_builder)
+        {
+            axiom_stax_builder_free(builder, env);
+        }
+    }
+    if (soap_builder)
+    {
+        copy = axiom_soap_builder_get_soap_envelope(soap_builder, env);
+        if (copy)
+        {
+            copy_node = axiom_soap_envelope_get_base_node(copy, env);
+        }
+        while (copy_node && !axiom_node_is_complete(copy_node, env))
+        {
+            if (AXIS2_SUCCESS != axiom_soap_builder_next(soap_builder, env))
+            {
+                break;
+            }
+        }
+        if (!copy_node || !axiom_node_is_complete(copy_node, env))
+        {
+            if (copy)
+            {
+                axiom_soap_envelope_free(copy, env);
+            }
+            else
+            {
+                axiom_soap_builder_free(soap_builder, env);
+            }
+            copy = NULL;
+        }
+    }
+    axiom_output_free(om_output, env);
+
+    if (!copy)
+    {
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "[local]Failed to copy the SOAP envelope");
+    }
+    return copy;
+}
+
+/* Frees the operation context of a served request along with its out
+   message context, as the HTTP worker does; the in message context is
+   freed by the caller */
+static void
+axis2_local_transport_sender_free_op_ctx(
+    const axutil_env_t * env,
+    axis2_op_ctx_t * op_ctx)
+{
+    axis2_msg_ctx_t **msg_ctx_map = NULL;
+    axis2_msg_ctx_t *in_msg_ctx = NULL;
+    axis2_conf_ctx_t *conf_ctx = NULL;
+    axis2_char_t *msg_id = NULL;
+
+    if (!op_ctx)
+    {
+        return;
+    }
+
+    msg_ctx_map = axis2_op_ctx_get_msg_ctx_map(op_ctx, env);
+    if (msg_ctx_map[AXIS2_WSDL_MESSAGE_LABEL_OUT])
+    {
+        axis2_msg_ctx_free(msg_ctx_map[AXIS2_WSDL_MESSAGE_LABEL_OUT], env);
+        msg_ctx_map[AXIS2_WSDL_MESSAGE_LABEL_OUT] = NULL;
+    }
+    in_msg_ctx = msg_ctx_map[AXIS2_WSDL_MESSAGE_LABEL_IN];
+    if (in_msg_ctx)
+    {
+        msg_id = axutil_strdup(env, axis2_msg_ctx_get_msg_id(in_msg_ctx, env));
+        conf_ctx = axis2_msg_ctx_get_conf_ctx(in_msg_ctx, env);
+        msg_ctx_map[AXIS2_WSDL_MESSAGE_LABEL_IN] = NULL;
+    }
+
+    if (!axis2_op_ctx_is_in_use(op_ctx, env))
+    {
+        axis2_op_ctx_destroy_mutex(op_ctx, env);
+        if (conf_ctx && msg_id)
+        {
+            axis2_conf_ctx_register_op_ctx(conf_ctx, env, msg_id, NULL);
+        }
+        axis2_op_ctx_free(op_ctx, env);
+    }
+    if (msg_id)
+    {
+        AXIS2_FREE(env->allocator, msg_id);
+    }
+}
+
+/* Runs the in flow of the engine on a request and returns the envelope the
+   service answered with, a fault envelope, or NULL when there is no
+   response. The caller owns the returned envelope */
+static axiom_soap_envelope_t *
+axis2_local_transport_sender_serve(
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx,
+    axiom_soap_envelope_t * request,
+    axis2_bool_t own_request)
+{
+    axis2_conf_ctx_t *conf_ctx = NULL;
+    axis2_transport_in_desc_t *in_desc = NULL;
+    axis2_msg_ctx_t *svr_msg_ctx = NULL;
+    axis2_msg_ctx_t *out_msg_ctx = NULL;
+    axis2_op_ctx_t *op_ctx = NULL;
+    axis2_endpoint_ref_t *to = NULL;
+    axis2_engine_t *engine = NULL;
+    axiom_soap_envelope_t *response = NULL;
+    axis2_status_t status = AXIS2_FAILURE;
+
+    conf_ctx = axis2_msg_ctx_get_conf_ctx(msg_ctx, env);
+    in_desc =
+        axis2_conf_get_transport_in(axis2_conf_ctx_get_conf(conf_ctx, env),
+                                    env, AXIS2_TRANSPORT_ENUM_LOCAL);
+
+    svr_msg_ctx = axis2_msg_ctx_create(env, conf_ctx, in_desc,
+                                       axis2_msg_ctx_get_transport_out_desc
+                                       (msg_ctx, env));
+    if (!svr_msg_ctx)
+    {
+        if (own_request)
+        {
+            axiom_soap_envelope_free(request, env);
+        }
+        return NULL;
+    }
+    axis2_msg_ctx_set_server_side(svr_msg_ctx, env, AXIS2_TRUE);
+    /* Nothing is written to the stream; the engine takes it as the back
+       channel faults are sent on */
+    axis2_msg_ctx_set_transport_out_stream(svr_msg_ctx, env,
+                                           axutil_stream_create_basic(env));
+    to = axis2_msg_ctx_get_to(msg_ctx, env);
+    if (to)
+    {
+        axis2_msg_ctx_set_to(svr_msg_ctx, env,
+                             axis2_endpoint_ref_create(env,
+                                                       axis2_endpoint_ref_get_address
+                                                       (to, env)));
+    }
+    axis2_msg_ctx_set_soap_action(svr_msg_ctx, env,
+                                  axis2_msg_ctx_get_soap_action(msg_ctx, env));
+    axis2_msg_ctx_set_soap_envelope(svr_msg_ctx, env, request);
+
+    engine = axis2_engine_create(env, conf_ctx);
+    if (engine)
+    {
+        status = axis2_engine_receive(engine, env, svr_msg_ctx);
+    }
+    op_ctx = axis2_msg_ctx_get_op_ctx(svr_msg_ctx, env);
+
+    if (AXIS2_SUCCESS == status)
+    {
+        if (op_ctx)
+        {
+            out_msg_ctx = axis2_op_ctx_get_msg_ctx(op_ctx, env,
+                                                   AXIS2_WSDL_MESSAGE_LABEL_OUT);
+        }
+        if (out_msg_ctx)
+        {
+            response = axis2_msg_ctx_get_soap_envelope(out_msg_ctx, env);
+            axis2_msg_ctx_set_soap_envelope(out_msg_ctx, env, NULL);
+        }
+    }
+    else if (engine)
+    {
+        axis2_msg_ctx_t *fault_ctx = NULL;
+        axis2_char_t *fault_code = NULL;
+
+        if (axis2_msg_ctx_get_is_soap_11(svr_msg_ctx, env))
+        {
+            fault_code = AXIOM_SOAP_DEFAULT_NAMESPACE_PREFIX ":"
+                AXIOM_SOAP11_FAULT_CODE_SENDER;
+        }
+        else
+        {
+            fault_code = AXIOM_SOAP_DEFAULT_NAMESPACE_PREFIX ":"
+                AXIOM_SOAP12_SOAP_FAULT_VALUE_SENDER;
+        }
+        fault_ctx = axis2_engine_create_fault_msg_ctx(engine, env,
+                                                      svr_msg_ctx, fault_code,
+                                                      axutil_error_get_message
+                                                      (env->error));
+        if (fault_ctx)
+        {
+            axis2_engine_send_fault(engine, env, fault_ctx);
+            response = axis2_msg_ctx_get_soap_envelope(fault_ctx, env);
+            axis2_msg_ctx_set_soap_envelope(fault_ctx, env, NULL);
+            axis2_msg_ctx_reset_transport_out_stream(fault_ctx, env);
+            if (response ==
+                axis2_msg_ctx_get_fault_soap_envelope(svr_msg_ctx, env))
+            {
+                axis2_msg_ctx_set_fault_soap_envelope(svr_msg_ctx, env, NULL);
+            }
+            axis2_msg_ctx_free(fault_ctx, env);
+        }
+    }
+
+    if (!own_request)
+    {
+        axis2_msg_ctx_set_soap_envelope(svr_msg_ctx, env, NULL);
+    }
+    axis2_local_transport_sender_free_op_ctx(env, op_ctx);
+    axis2_msg_ctx_free(svr_msg_ctx, env);
+    if (engine)
+    {
+        axis2_engine_free(engine, env);
+    }
+    return response;
+}
+
+axis2_status_t AXIS2_CALL
+axis2_local_transport_sender_invoke(
+    axis2_transport_sender_t * transport_sender,
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx)
+{
+    axis2_bool_t deep_copy = AXIS2_FALSE;
+    axiom_soap_envelope_t *request = NULL;
+    axiom_soap_envelope_t *response = NULL;
+
+    AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI,
+                    "start:local transport sender invoke");
+
+    /* On the server side of a call the response stays in its message
+       context, where the client side below picks it up */
+    if (axis2_msg_ctx_get_server_side(msg_ctx, env))
+    {
+        return AXIS2_SUCCESS;
+    }
+
+    deep_copy = AXIS2_INTF_TO_IMPL(transport_sender)->deep_copy;
+    request = axis2_msg_ctx_get_soap_envelope(msg_ctx, env);
+    if (!request)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NULL_SOAP_ENVELOPE_IN_MSG_CTX,
+                        AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+    if (deep_copy)
+    {
+        request = axis2_local_transport_sender_copy_envelope(env, request);
+        if (!request)
+        {
+            return AXIS2_FAILURE;
+        }
+    }
+
+    response = axis2_local_transport_sender_serve(env, msg_ctx, request,
+                                                  deep_copy);
+    if (response && deep_copy)
+    {
+        axiom_soap_envelope_t *copy = NULL;
+
+        copy = axis2_local_transport_sender_copy_envelope(env, response);
+        axiom_soap_envelope_free(response, env);
+        if (!copy)
+        {
+            return AXIS2_FAILURE;
+        }
+        response = copy;
+    }
+    if (response)
+    {
+        axis2_msg_ctx_set_response_soap_envelope(msg_ctx, env, response);
+    }
+
+    AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI,
+                    "end:local transport sender invoke");
+    return AXIS2_SUCCESS;
+}
+
+axis2_status_t AXIS2_CALL
+axis2_local_transport_sender_clean_up(
+    axis2_transport_sender_t * transport_sender,
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx)
+{
+    AXIS2_ENV_CHECK(env, AXIS2_FAILURE);
+    AXIS2_PARAM_CHECK(env->error, msg_ctx, AXIS2_FAILURE);
+    /*
+     * Clean up is not used. If the local transport need clean up it
+     * should be done here.
+     */
+    return AXIS2_SUCCESS;
+}
+
+axis2_status_t AXIS2_CALL
+axis2_local_transport_sender_init(
+    axis2_transport_sender_t * transport_sender,
+    const axutil_env_t * env,
+    axis2_conf_ctx_t * conf_ctx,
+    axis2_transport_out_desc_t * out_desc)
+{
+    axis2_char_t *temp = NULL;
+    axutil_param_t *temp_param = NULL;
+    AXIS2_ENV_CHECK(env, AXIS2_FAILURE);
+    AXIS2_PARAM_CHECK(env->error, out_desc, AXIS2_FAILURE);
+
+    temp_param =
+        axutil_param_container_get_param
+        (axis2_transport_out_desc_param_container(out_desc, env), env,
+         AXIS2_LOCAL_DEEP_COPY);
+    if (temp_param)
+    {
+        temp = axutil_param_get_value(temp_param, env);
+    }
+    if (temp && !axutil_strcasecmp(temp, AXIS2_VALUE_TRUE))
+    {
+        AXIS2_INTF_TO_IMPL(transport_sender)->deep_copy = AXIS2_TRUE;
+    }
+    return AXIS2_SUCCESS;
+}
+
+/**
+ * Following block distinguish the exposed part of the dll.
+ */
+AXIS2_EXPORT int
+#ifndef AXIS2_STATIC_DEPLOY
+axis2_get_instance(
+#else
+axis2_local_transport_sender_get_instance(
+#endif
+    struct axis2_transport_sender **inst,
+    const axutil_env_t * env)
+{
+    *inst = axis2_local_transport_sender_create(env);
+    if (!(*inst))
+    {
+        return AXIS2_FAILURE;
+    }
+
+    return AXIS2_SUCCESS;
+}
+
+AXIS2_EXPORT int
+#ifndef AXIS2_STATIC_DEPLOY
+axis2_remove_instance(
+#else
+axis2_local_transport_sender_remove_instance(
+#endif
+    axis2_transport_sender_t * inst,
+    const axutil_env_t * env)
+{
+    if (inst)
+    {
+        AXIS2_TRANSPORT_SENDER_FREE(inst, env);
+    }
+    return AXIS2_SUCCESS;
+}
@@ -33,6 +33,7 @@
 #include <axis2_defines.h>
 #include <axutil_env.h>
 #include <axutil_stream.h>
+#include <axis2_tcp_frame.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -72,12 +73,69 @@ extern "C"
         const axutil_env_t * env);
 
     /**
+     * Reads the next request frame. Only the thread serving the connection
+     * reads from it.
      * @param svr_conn pointer to server connection struct
      * @param env pointer to environment struct
+     * @param max_size largest body accepted
+     * @param frame set to the frame read, or to NULL when the client closed
+     * the connection
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
      */
-    AXIS2_EXTERN axis2_char_t *AXIS2_CALL
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_simple_tcp_svr_conn_read_frame(
+        axis2_simple_tcp_svr_conn_t * svr_conn,
+        const axutil_env_t * env,
+        int max_size,
+        axis2_tcp_frame_t ** frame);
 
+    /**
+     * Reads an unframed request, which runs to an empty line or to the end
+     * of the input. It is returned as a frame without metadata, with an id
+     * of 0.
+     * @param svr_conn pointer to server connection struct
+     * @param env pointer to environment struct
+     * @param max_size largest request accepted
+     * @param frame set to the request read, or to NULL when the client
+     * closed the connection without sending anything
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
     axis2_simple_tcp_svr_conn_read_request(
+        axis2_simple_tcp_svr_conn_t * svr_conn,
+        const axutil_env_t * env,
+        int max_size,
+        axis2_tcp_frame_t ** frame);
+
+    /**
+     * Writes a reply frame. Replies to pipelined requests may be written
+     * from several threads; each frame is written as a whole.
+     * @param svr_conn pointer to server connection struct
+     * @param env pointer to environment struct
+     * @param id correlation id of the request
+     * @param content_type content type of the body, may be NULL
+     * @param body body, may be NULL when body_len is 0
+     * @param body_len length of the body
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_simple_tcp_svr_conn_write_frame(
+        axis2_simple_tcp_svr_conn_t * svr_conn,
+        const axutil_env_t * env,
+        unsigned int id,
+        const axis2_char_t * content_type,
+        const axis2_char_t * body,
+        int body_len);
+
+    /**
+     * Takes a reference to the connection for a request served on another
+     * thread. The connection is closed when the last reference is freed.
+     * @param svr_conn pointer to server connection struct
+     * @param env pointer to environment struct
+     * @return number of references now held
+     */
+    AXIS2_EXTERN int AXIS2_CALL
+    axis2_simple_tcp_svr_conn_increment_ref(
         axis2_simple_tcp_svr_conn_t * svr_conn,
         const axutil_env_t * env);
 
@@ -128,9 +186,10 @@ extern "C"
         const axutil_env_t * env);
 
     /**
+     * Drops a reference, freeing the connection with the last one.
      * @param svr_conn pointer to server connection struct
      * @param env pointer to environment struct
-     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     * @return void
      */
     AXIS2_EXTERN void AXIS2_CALL
     axis2_simple_tcp_svr_conn_free(
@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AXIS2_TCP_FRAME_H
+#define AXIS2_TCP_FRAME_H
+
+/**
+ * @defgroup axis2_tcp_frame tcp frame
+ * @ingroup axis2_core_trans_tcp
+ * With the FRAMING transport parameter set to true, every message on a TCP
+ * transport connection travels in a frame, so that a connection can carry
+ * any number of messages of any size, in both directions. Both ends of a
+ * connection have to agree; by default the transport keeps to its unframed
+ * format of one request and reply per connection. A frame starts with a fixed header of
+ * AXIS2_TCP_FRAME_HEADER_SIZE bytes, all numbers in network byte order:
+ *
+ *   0  2 bytes  magic, "AX"
+ *   2  1 byte   version, AXIS2_TCP_FRAME_VERSION
+ *   3  1 byte   reserved, zero
+ *   4  4 bytes  correlation id
+ *   8  4 bytes  length of the metadata
+ *  12  4 bytes  length of the body
+ *
+ * The metadata follows as "Name: value" lines ending with CRLF; the
+ * Content-Type and Action names are understood. The body, the serialized
+ * envelope, comes last. A reply carries the correlation id of its request,
+ * so a client may send several requests before reading the replies. A reply
+ * with an empty body acknowledges a request that has no response message.
+ * @{
+ */
+
+/**
+ * @file axis2_tcp_frame.h
+ */
+
+#include <axis2_const.h>
+#include <axis2_defines.h>
+#include <axutil_env.h>
+#include <axutil_stream.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define AXIS2_TCP_FRAME_HEADER_SIZE 16
+
+#define AXIS2_TCP_FRAME_VERSION 1
+
+    /** Metadata is small; anything beyond this is a corrupt frame */
+#define AXIS2_TCP_FRAME_MAX_META_SIZE 8192
+
+#define AXIS2_TCP_FRAME_CONTENT_TYPE "Content-Type"
+
+#define AXIS2_TCP_FRAME_ACTION "Action"
+
+    /** Type name for struct axis2_tcp_frame */
+    typedef struct axis2_tcp_frame axis2_tcp_frame_t;
+
+    /**
+     * A frame read from a connection. The body is followed by a '\0', so
+     * that it can be given to an XML reader as is.
+     */
+    struct axis2_tcp_frame
+    {
+        unsigned int id;
+        axis2_char_t *content_type;
+        axis2_char_t *action;
+        axis2_char_t *body;
+        int body_len;
+    };
+
+    /**
+     * Reads the next frame from a stream.
+     * @param env pointer to environment struct
+     * @param stream stream to read from
+     * @param max_size largest body accepted
+     * @param frame set to the frame read, to be freed with
+     * axis2_tcp_frame_free, or to NULL when the peer closed the connection
+     * before sending anything
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_tcp_frame_read(
+        const axutil_env_t * env,
+        axutil_stream_t * stream,
+        int max_size,
+        axis2_tcp_frame_t ** frame);
+
+    /**
+     * Writes a frame to a stream. Metadata values containing CR or LF are
+     * refused.
+     * @param env pointer to environment struct
+     * @param stream stream to write to
+     * @param id correlation id
+     * @param content_type content type of the body, may be NULL
+     * @param action action of the message, may be NULL
+     * @param body body, may be NULL when body_len is 0
+     * @param body_len length of the body
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axis2_tcp_frame_write(
+        const axutil_env_t * env,
+        axutil_stream_t * stream,
+        unsigned int id,
+        const axis2_char_t * content_type,
+        const axis2_char_t * action,
+        const axis2_char_t * body,
+        int body_len);
+
+    /**
+     * @param frame pointer to frame
+     * @param env pointer to environment struct
+     * @return void
+     */
+    AXIS2_EXTERN void AXIS2_CALL
+    axis2_tcp_frame_free(
+        axis2_tcp_frame_t * frame,
+        const axutil_env_t * env);
+
+    /** @} */
+#ifdef __cplusplus
+}
+#endif
+#endif                          /* AXIS2_TCP_FRAME_H */
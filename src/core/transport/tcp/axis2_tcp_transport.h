@@ -78,6 +78,45 @@ extern "C"
      */
 #define AXIS2_TCP_DEFAULT_CONNECTION_TIMEOUT 60000
 
+    /**
+     * MAX_FRAME_SIZE
+     */
+#define AXIS2_TCP_MAX_FRAME_SIZE "MAX_FRAME_SIZE"
+
+    /**
+     * DEFAULT_MAX_FRAME_SIZE
+     */
+#define AXIS2_TCP_DEFAULT_MAX_FRAME_SIZE (64 * 1024 * 1024)
+
+    /**
+     * MAX_IDLE_CONNECTIONS, kept open per endpoint by the sender
+     */
+#define AXIS2_TCP_MAX_IDLE_CONNECTIONS "MAX_IDLE_CONNECTIONS"
+
+    /**
+     * DEFAULT_MAX_IDLE_CONNECTIONS
+     */
+#define AXIS2_TCP_DEFAULT_MAX_IDLE_CONNECTIONS 8
+
+    /**
+     * FRAMING, "true" to carry messages in frames. Unframed, a connection
+     * carries one request, ended by an empty line, and the reply, ended by
+     * a '\0' and the close of the connection
+     */
+#define AXIS2_TCP_FRAMING "FRAMING"
+
+    /**
+     * Pipelined requests of a connection the server processes at once
+     */
+#define AXIS2_TCP_MAX_PIPELINED_REQUESTS 16
+
+    /**
+     * Content types of the frames carrying SOAP 1.1 and SOAP 1.2 envelopes
+     */
+#define AXIS2_TCP_CONTENT_TYPE_SOAP11 "text/xml"
+
+#define AXIS2_TCP_CONTENT_TYPE_SOAP12 "application/soap+xml"
+
     /**
      * Field TRANSPORT_TCP
      */
@@ -45,17 +45,42 @@ extern "C"
     typedef struct axis2_tcp_worker axis2_tcp_worker_t;
 
     /**
+     * Runs a request through the engine and writes the reply. A reply frame
+     * carries the correlation id of the request; without framing the reply
+     * is written as is, followed by a '\0'.
      * @param tcp_worker pointer to tcp worker
      * @param env pointer to environment struct
      * @param svr_conn pointer to svr conn
-     * @param simple_request pointer to simple request
+     * @param request request frame. It is not freed
      */
     AXIS2_EXTERN axis2_bool_t AXIS2_CALL
     axis2_tcp_worker_process_request(
         axis2_tcp_worker_t * tcp_worker,
         const axutil_env_t * env,
         axis2_simple_tcp_svr_conn_t * svr_conn,
-        axis2_char_t * simple_request);
+        axis2_tcp_frame_t * request);
+
+    /**
+     * @param tcp_worker pointer to tcp worker
+     * @param env pointer to environment struct
+     * @return AXIS2_TRUE if messages travel in frames, the FRAMING
+     * parameter of the transport receiver
+     */
+    AXIS2_EXTERN axis2_bool_t AXIS2_CALL
+    axis2_tcp_worker_get_framing(
+        const axis2_tcp_worker_t * tcp_worker,
+        const axutil_env_t * env);
+
+    /**
+     * @param tcp_worker pointer to tcp worker
+     * @param env pointer to environment struct
+     * @return largest request body accepted, the MAX_FRAME_SIZE parameter
+     * of the transport receiver
+     */
+    AXIS2_EXTERN int AXIS2_CALL
+    axis2_tcp_worker_get_max_frame_size(
+        const axis2_tcp_worker_t * tcp_worker,
+        const axutil_env_t * env);
 
     /**
      * @param tcp_worker pointer to tcp worker
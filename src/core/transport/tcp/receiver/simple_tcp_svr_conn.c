@@ -20,13 +20,17 @@
 #include <axis2_tcp_transport.h>
 #include <axutil_string.h>
 #include <axutil_network_handler.h>
+#include <axutil_thread.h>
 #include <platforms/axutil_platform_auto_sense.h>
 
 struct axis2_simple_tcp_svr_conn
 {
     int socket;
     axutil_stream_t *stream;
-    axis2_char_t *buffer;
+
+    /* Guards ref and keeps the frames written by concurrent replies apart */
+    axutil_thread_mutex_t *mutex;
+    int ref;
 };
 
 AXIS2_EXTERN axis2_simple_tcp_svr_conn_t *AXIS2_CALL
@@ -46,7 +50,15 @@ axis2_simple_tcp_svr_conn_create(
     }
     svr_conn->socket = sockfd;
     svr_conn->stream = NULL;
-    svr_conn->buffer = NULL;
+    svr_conn->ref = 1;
+    svr_conn->mutex = axutil_thread_mutex_create(env->allocator,
+                                                 AXIS2_THREAD_MUTEX_DEFAULT);
+    if (!svr_conn->mutex)
+    {
+        AXIS2_FREE(env->allocator, svr_conn);
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
 
     if (-1 != svr_conn->socket)
     {
@@ -66,13 +78,33 @@ axis2_simple_tcp_svr_conn_free(
     axis2_simple_tcp_svr_conn_t * svr_conn,
     const axutil_env_t * env)
 {
-    axis2_simple_tcp_svr_conn_close(svr_conn, env);
+    axutil_thread_mutex_lock(svr_conn->mutex);
+    if (--(svr_conn->ref) > 0)
+    {
+        axutil_thread_mutex_unlock(svr_conn->mutex);
+        return;
+    }
+    axutil_thread_mutex_unlock(svr_conn->mutex);
 
+    axis2_simple_tcp_svr_conn_close(svr_conn, env);
+    axutil_thread_mutex_destroy(svr_conn->mutex);
     AXIS2_FREE(env->allocator, svr_conn);
-
     return;
 }
 
+AXIS2_EXTERN int AXIS2_CALL
+axis2_simple_tcp_svr_conn_increment_ref(
+    axis2_simple_tcp_svr_conn_t * svr_conn,
+    const axutil_env_t * env)
+{
+    int ref = 0;
+
+    axutil_thread_mutex_lock(svr_conn->mutex);
+    ref = ++(svr_conn->ref);
+    axutil_thread_mutex_unlock(svr_conn->mutex);
+    return ref;
+}
+
 AXIS2_EXTERN axis2_status_t AXIS2_CALL
 axis2_simple_tcp_svr_conn_close(
     axis2_simple_tcp_svr_conn_t * svr_conn,
@@ -110,44 +142,121 @@ axis2_simple_tcp_svr_conn_get_stream(
     return svr_conn->stream;
 }
 
-AXIS2_EXTERN axis2_char_t *AXIS2_CALL
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_simple_tcp_svr_conn_read_frame(
+    axis2_simple_tcp_svr_conn_t * svr_conn,
+    const axutil_env_t * env,
+    int max_size,
+    axis2_tcp_frame_t ** frame)
+{
+    AXIS2_ENV_CHECK(env, AXIS2_FAILURE);
+
+    return axis2_tcp_frame_read(env, svr_conn->stream, max_size, frame);
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
 axis2_simple_tcp_svr_conn_read_request(
     axis2_simple_tcp_svr_conn_t * svr_conn,
-    const axutil_env_t * env)
+    const axutil_env_t * env,
+    int max_size,
+    axis2_tcp_frame_t ** frame)
 {
-    int size = 32000;
-    axis2_char_t str_line[32000];
-    axis2_char_t tmp_buf[32000];
-    int read = -1;
+    axis2_char_t *buffer = NULL;
+    int size = 4096;
+    int len = 0;
+    int read = 0;
+    axis2_tcp_frame_t *request = NULL;
 
-    AXIS2_ENV_CHECK(env, NULL);
+    AXIS2_ENV_CHECK(env, AXIS2_FAILURE);
+    *frame = NULL;
 
-    memset(str_line, 0, size);
-    while ((read =
-            axutil_stream_peek_socket(svr_conn->stream, env, tmp_buf,
-                                      size - 1)) > 0)
+    buffer = AXIS2_MALLOC(env->allocator, size + 1);
+    if (!buffer)
     {
-        tmp_buf[read] = '\0';
-        if (read > 0)
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+
+    /* The client keeps the connection open for the reply, so the empty line
+       after the envelope is what ends the request */
+    while ((read = axutil_stream_read(svr_conn->stream, env, buffer + len,
+                                      size - len)) > 0)
+    {
+        len += read;
+        if (len >= 4 && !memcmp(buffer + len - 4, AXIS2_CRLF AXIS2_CRLF, 4))
         {
-            read = axutil_stream_read(svr_conn->stream, env, tmp_buf, size - 1);
-            if (read > 0)
-            {
-                tmp_buf[read] = '\0';
-                strcat(str_line, tmp_buf);
-                break;
-            }
-            else
+            len -= 4;
+            break;
+        }
+        if (len > max_size + 4)
+        {
+            break;
+        }
+        if (len == size)
+        {
+            axis2_char_t *grown = NULL;
+
+            size *= 2;
+            grown = AXIS2_REALLOC(env->allocator, buffer, size + 1);
+            if (!grown)
             {
-                break;
+                AXIS2_FREE(env->allocator, buffer);
+                AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY,
+                                AXIS2_FAILURE);
+                return AXIS2_FAILURE;
             }
+            buffer = grown;
         }
     }
-    if (str_line > 0)
+    if (len > max_size)
+    {
+        AXIS2_FREE(env->allocator, buffer);
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_INVALID_HEADER, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "TCP request exceeds the limit of %d bytes", max_size);
+        return AXIS2_FAILURE;
+    }
+    if (read < 0 || !len)
     {
-        svr_conn->buffer = str_line;
+        AXIS2_FREE(env->allocator, buffer);
+        return read < 0 ? AXIS2_FAILURE : AXIS2_SUCCESS;
     }
-    return svr_conn->buffer;
+    buffer[len] = '\0';
+
+    request = AXIS2_MALLOC(env->allocator, sizeof(axis2_tcp_frame_t));
+    if (!request)
+    {
+        AXIS2_FREE(env->allocator, buffer);
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+    request->id = 0;
+    request->content_type = NULL;
+    request->action = NULL;
+    request->body = buffer;
+    request->body_len = len;
+    *frame = request;
+    return AXIS2_SUCCESS;
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_simple_tcp_svr_conn_write_frame(
+    axis2_simple_tcp_svr_conn_t * svr_conn,
+    const axutil_env_t * env,
+    unsigned int id,
+    const axis2_char_t * content_type,
+    const axis2_char_t * body,
+    int body_len)
+{
+    axis2_status_t status = AXIS2_FAILURE;
+
+    AXIS2_ENV_CHECK(env, AXIS2_FAILURE);
+
+    axutil_thread_mutex_lock(svr_conn->mutex);
+    status = axis2_tcp_frame_write(env, svr_conn->stream, id, content_type,
+                                   NULL, body, body_len);
+    axutil_thread_mutex_unlock(svr_conn->mutex);
+    return status;
 }
 
 AXIS2_EXTERN axis2_status_t AXIS2_CALL
@@ -47,6 +47,14 @@ typedef struct axis2_tcp_svr_thd_args
     axutil_thread_t *thread;
 } axis2_tcp_svr_thd_args_t;
 
+typedef struct axis2_tcp_svr_request_args
+{
+    axutil_env_t *env;
+    axis2_simple_tcp_svr_conn_t *svr_conn;
+    axis2_tcp_worker_t *worker;
+    axis2_tcp_frame_t *request;
+} axis2_tcp_svr_request_args_t;
+
 AXIS2_EXTERN const axutil_env_t *AXIS2_CALL init_thread_env(
     const axutil_env_t ** system_env);
 
@@ -54,6 +62,10 @@ void *AXIS2_THREAD_FUNC axis2_svr_thread_worker_func(
     axutil_thread_t * thd,
     void *data);
 
+void *AXIS2_THREAD_FUNC axis2_tcp_svr_thread_request_func(
+    axutil_thread_t * thd,
+    void *data);
+
 axis2_tcp_svr_thread_t *AXIS2_CALL
 axis2_tcp_svr_thread_create(
     const axutil_env_t * env,
@@ -212,26 +224,93 @@ axis2_tcp_svr_thread_set_worker(
     return AXIS2_SUCCESS;
 }
 
+/* Tells whether the client has already sent more than the frame just read,
+   that is, whether it pipelines requests */
+static axis2_bool_t
+axis2_tcp_svr_thread_has_input(
+    axis2_simple_tcp_svr_conn_t * svr_conn,
+    const axutil_env_t * env)
+{
+#ifdef MSG_DONTWAIT
+    axutil_stream_t *stream = NULL;
+    char c;
+
+    stream = axis2_simple_tcp_svr_conn_get_stream(svr_conn, env);
+    return recv(stream->socket, &c, 1, MSG_PEEK | MSG_DONTWAIT) > 0 ?
+        AXIS2_TRUE : AXIS2_FALSE;
+#else
+    return AXIS2_TRUE;
+#endif
+}
+
+static void
+axis2_tcp_svr_thread_serve(
+    const axutil_env_t * env,
+    axis2_tcp_worker_t * worker,
+    axis2_simple_tcp_svr_conn_t * svr_conn,
+    axis2_tcp_frame_t * request)
+{
+    struct AXIS2_PLATFORM_TIMEB t1,
+     t2;
+    int millisecs = 0;
+    double secs = 0;
+    axis2_status_t status = AXIS2_FAILURE;
+
+    AXIS2_PLATFORM_GET_TIME_IN_MILLIS(&t1);
+    AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI, "tcp request %u of %d bytes",
+                    request->id, request->body_len);
+    status = axis2_tcp_worker_process_request(worker, env, svr_conn, request);
+    axis2_tcp_frame_free(request, env);
+
+    AXIS2_PLATFORM_GET_TIME_IN_MILLIS(&t2);
+    millisecs = t2.millitm - t1.millitm;
+    secs = difftime(t2.time, t1.time);
+    if (millisecs < 0)
+    {
+        millisecs += 1000;
+        secs--;
+    }
+    secs += millisecs / 1000.0;
+
+    if (status == AXIS2_SUCCESS)
+    {
+#if defined(WIN32)
+        AXIS2_LOG_INFO(env->log, "Request served successfully");
+#else
+        AXIS2_LOG_INFO(env->log, "Request served in %.3f seconds", secs);
+#endif
+    }
+    else
+    {
+#if defined(WIN32)
+        AXIS2_LOG_WARNING(env->log, AXIS2_LOG_SI,
+                          "Error occured in processing request ");
+#else
+        AXIS2_LOG_WARNING(env->log, AXIS2_LOG_SI,
+                          "Error occured in processing request (%.3f seconds)",
+                          secs);
+#endif
+    }
+}
+
 /**
- * Thread worker function.
+ * Thread worker function. Serves the requests of a connection until the
+ * client closes it or stays idle for longer than the read timeout, or
+ * serves its only request when messages are not framed.
  */
 void *AXIS2_THREAD_FUNC
 axis2_svr_thread_worker_func(
     axutil_thread_t * thd,
     void *data)
 {
-    struct AXIS2_PLATFORM_TIMEB t1,
-     t2;
     axis2_simple_tcp_svr_conn_t *svr_conn = NULL;
-    axis2_char_t *request = NULL;
-    int millisecs = 0;
-    double secs = 0;
+    axis2_tcp_frame_t *request = NULL;
     axis2_tcp_worker_t *tmp = NULL;
-    axis2_status_t status = AXIS2_FAILURE;
     axutil_env_t *env = NULL;
     axis2_socket_t socket;
     axutil_env_t *thread_env = NULL;
     axis2_tcp_svr_thd_args_t *arg_list = NULL;
+    int max_frame_size = 0;
 
 #ifndef WIN32
 #ifdef AXIS2_SVR_MULTI_THREADED
@@ -244,48 +323,95 @@ axis2_svr_thread_worker_func(
     {
         return NULL;
     }
-    AXIS2_PLATFORM_GET_TIME_IN_MILLIS(&t1);
     env = arg_list->env;
     thread_env = axutil_init_thread_env(env);
     socket = arg_list->socket;
-    svr_conn = axis2_simple_tcp_svr_conn_create(thread_env, (int)socket);
-    axis2_simple_tcp_svr_conn_set_rcv_timeout(svr_conn, thread_env,
-                                              axis2_tcp_socket_read_timeout);
-    request = axis2_simple_tcp_svr_conn_read_request(svr_conn, thread_env);
-    AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI, "tcp request %s", request);
     tmp = arg_list->worker;
-    status = axis2_tcp_worker_process_request(tmp, thread_env, svr_conn,
-                                              request);
-    axis2_simple_tcp_svr_conn_free(svr_conn, thread_env);
+    max_frame_size = axis2_tcp_worker_get_max_frame_size(tmp, thread_env);
 
-    AXIS2_PLATFORM_GET_TIME_IN_MILLIS(&t2);
-    millisecs = t2.millitm - t1.millitm;
-    secs = difftime(t2.time, t1.time);
-    if (millisecs < 0)
+    svr_conn = axis2_simple_tcp_svr_conn_create(thread_env, (int)socket);
+    if (!svr_conn)
     {
-        millisecs += 1000;
-        secs--;
+        axutil_network_handler_close_socket(thread_env, socket);
+    }
+    else
+    {
+        axis2_simple_tcp_svr_conn_set_rcv_timeout(svr_conn, thread_env,
+                                                  axis2_tcp_socket_read_timeout);
     }
-    secs += millisecs / 1000.0;
 
-    if (status == AXIS2_SUCCESS)
+    /* Unframed, a connection carries a single request */
+    if (svr_conn && !axis2_tcp_worker_get_framing(tmp, thread_env))
     {
-#if defined(WIN32)
-        AXIS2_LOG_INFO(thread_env->log, "Request served successfully");
-#else
-        AXIS2_LOG_INFO(thread_env->log, "Request served in %.3f seconds", secs);
-#endif
+        if (AXIS2_SUCCESS ==
+            axis2_simple_tcp_svr_conn_read_request(svr_conn, thread_env,
+                                                   max_frame_size, &request) &&
+            request)
+        {
+            axis2_tcp_svr_thread_serve(thread_env, tmp, svr_conn, request);
+        }
+        axis2_simple_tcp_svr_conn_free(svr_conn, thread_env);
+        svr_conn = NULL;
     }
-    else
+
+    while (svr_conn &&
+           AXIS2_SUCCESS == axis2_simple_tcp_svr_conn_read_frame(svr_conn,
+                                                                thread_env,
+                                                                max_frame_size,
+                                                                &request) &&
+           request)
     {
-#if defined(WIN32)
-        AXIS2_LOG_WARNING(thread_env->log, AXIS2_LOG_SI,
-                          "Error occured in processing request ");
-#else
-        AXIS2_LOG_WARNING(thread_env->log, AXIS2_LOG_SI,
-                          "Error occured in processing request (%.3f seconds)",
-                          secs);
+#ifdef AXIS2_SVR_MULTI_THREADED
+        /* When the client pipelines, this request is served on a thread of
+           its own while the next is read. Past the limit of requests in
+           flight the reader serves it itself, and so stops reading more */
+        if (axis2_tcp_svr_thread_has_input(svr_conn, thread_env))
+        {
+            if (axis2_simple_tcp_svr_conn_increment_ref(svr_conn, thread_env) <=
+                AXIS2_TCP_MAX_PIPELINED_REQUESTS + 1)
+            {
+                axis2_tcp_svr_request_args_t *req_args = NULL;
+                axutil_thread_t *request_thread = NULL;
+
+                req_args = AXIS2_MALLOC(thread_env->allocator,
+                                        sizeof(axis2_tcp_svr_request_args_t));
+                if (req_args)
+                {
+                    req_args->env = env;
+                    req_args->svr_conn = svr_conn;
+                    req_args->worker = tmp;
+                    req_args->request = request;
+                    request_thread =
+                        axutil_thread_pool_get_thread(env->thread_pool,
+                                                      axis2_tcp_svr_thread_request_func,
+                                                      (void *) req_args);
+                }
+                if (request_thread)
+                {
+                    axutil_thread_pool_thread_detach(env->thread_pool,
+                                                     request_thread);
+                    request = NULL;
+                    continue;
+                }
+                AXIS2_LOG_ERROR(thread_env->log, AXIS2_LOG_SI,
+                                "Thread creation failed for a pipelined "
+                                "request");
+                if (req_args)
+                {
+                    AXIS2_FREE(thread_env->allocator, req_args);
+                }
+            }
+            /* Gives back the reference taken for the request thread */
+            axis2_simple_tcp_svr_conn_free(svr_conn, thread_env);
+        }
 #endif
+        axis2_tcp_svr_thread_serve(thread_env, tmp, svr_conn, request);
+        request = NULL;
+    }
+
+    if (svr_conn)
+    {
+        axis2_simple_tcp_svr_conn_free(svr_conn, thread_env);
     }
 
     AXIS2_FREE(thread_env->allocator, arg_list);
@@ -303,3 +429,32 @@ axis2_svr_thread_worker_func(
 
     return NULL;
 }
+
+/**
+ * Serves a pipelined request on a thread of its own.
+ */
+void *AXIS2_THREAD_FUNC
+axis2_tcp_svr_thread_request_func(
+    axutil_thread_t * thd,
+    void *data)
+{
+    axis2_tcp_svr_request_args_t *req_args = NULL;
+    axutil_env_t *env = NULL;
+    axutil_env_t *thread_env = NULL;
+
+    req_args = (axis2_tcp_svr_request_args_t *) data;
+    env = req_args->env;
+    thread_env = axutil_init_thread_env(env);
+
+    axis2_tcp_svr_thread_serve(thread_env, req_args->worker,
+                               req_args->svr_conn, req_args->request);
+    axis2_simple_tcp_svr_conn_free(req_args->svr_conn, thread_env);
+    AXIS2_FREE(thread_env->allocator, req_args);
+
+    axutil_free_thread_env(thread_env);
+#ifdef AXIS2_SVR_MULTI_THREADED
+    axutil_thread_pool_exit_thread(env->thread_pool, thd);
+#endif
+
+    return NULL;
+}
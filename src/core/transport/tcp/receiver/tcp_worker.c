@@ -32,19 +32,36 @@
 #include <axiom_soap.h>
 #include <axiom.h>
 #include <axis2_simple_tcp_svr_conn.h>
+#include <axutil_types.h>
 
 struct axis2_tcp_worker
 {
     axis2_conf_ctx_t *conf_ctx;
     int svr_port;
+    int max_frame_size;
+    axis2_bool_t framing;
 };
 
+static void
+axis2_tcp_worker_free_op_ctx(
+    const axutil_env_t * env,
+    axis2_op_ctx_t * op_ctx);
+
+static axis2_status_t
+axis2_tcp_worker_write_unframed(
+    const axutil_env_t * env,
+    axis2_simple_tcp_svr_conn_t * svr_conn,
+    const axis2_char_t * body,
+    int body_len);
+
 AXIS2_EXTERN axis2_tcp_worker_t *AXIS2_CALL
 axis2_tcp_worker_create(
     const axutil_env_t * env,
     axis2_conf_ctx_t * conf_ctx)
 {
     axis2_tcp_worker_t *tcp_worker = NULL;
+    axis2_transport_in_desc_t *in_desc = NULL;
+    axutil_param_t *param = NULL;
     AXIS2_ENV_CHECK(env, NULL);
     tcp_worker = (axis2_tcp_worker_t *)
         AXIS2_MALLOC(env->allocator, sizeof(axis2_tcp_worker_t));
@@ -56,6 +73,41 @@ axis2_tcp_worker_create(
     }
     tcp_worker->conf_ctx = conf_ctx;
     tcp_worker->svr_port = 9090;    /* default - must set later */
+    tcp_worker->max_frame_size = AXIS2_TCP_DEFAULT_MAX_FRAME_SIZE;
+    tcp_worker->framing = AXIS2_FALSE;
+
+    if (conf_ctx)
+    {
+        in_desc =
+            axis2_conf_get_transport_in(axis2_conf_ctx_get_conf(conf_ctx, env),
+                                        env, AXIS2_TRANSPORT_ENUM_TCP);
+    }
+    if (in_desc)
+    {
+        param =
+            axutil_param_container_get_param
+            (axis2_transport_in_desc_param_container(in_desc, env), env,
+             AXIS2_TCP_MAX_FRAME_SIZE);
+    }
+    if (param && axutil_param_get_value(param, env))
+    {
+        tcp_worker->max_frame_size =
+            AXIS2_ATOI(axutil_param_get_value(param, env));
+    }
+    param = NULL;
+    if (in_desc)
+    {
+        param =
+            axutil_param_container_get_param
+            (axis2_transport_in_desc_param_container(in_desc, env), env,
+             AXIS2_TCP_FRAMING);
+    }
+    if (param && axutil_param_get_value(param, env) &&
+        !axutil_strcasecmp(axutil_param_get_value(param, env),
+                           AXIS2_VALUE_TRUE))
+    {
+        tcp_worker->framing = AXIS2_TRUE;
+    }
 
     return tcp_worker;
 }
@@ -79,7 +131,7 @@ axis2_tcp_worker_process_request(
     axis2_tcp_worker_t * tcp_worker,
     const axutil_env_t * env,
     axis2_simple_tcp_svr_conn_t * svr_conn,
-    axis2_char_t * simple_request)
+    axis2_tcp_frame_t * request)
 {
     axis2_conf_ctx_t *conf_ctx = NULL;
     axis2_transport_out_desc_t *out_desc = NULL;
@@ -91,18 +143,46 @@ axis2_tcp_worker_process_request(
     axiom_soap_envelope_t *soap_envelope = NULL;
     axis2_engine_t *engine = NULL;
     axis2_status_t status = AXIS2_FALSE;
-    axutil_stream_t *svr_stream = NULL;
-    axis2_char_t *buffer = NULL;
-    int len = 0;
-    int write = -1;
+    axutil_string_t *soap_action = NULL;
+    axis2_bool_t is_soap11 = AXIS2_FALSE;
+    const axis2_char_t *content_type = NULL;
     axutil_stream_t *out_stream = NULL;
+    int len = 0;
 
     AXIS2_LOG_TRACE(env->log, AXIS2_LOG_SI,
                     "start:axis2_tcp_worker_process_request");
 
-    out_stream = axutil_stream_create_basic(env);
-    reader = axiom_xml_reader_create_for_memory(env, simple_request,
-                                                axutil_strlen(simple_request),
+    conf_ctx = tcp_worker->conf_ctx;
+
+    if (!conf_ctx)
+    {
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "conf ctx not available");
+        return AXIS2_FAILURE;
+    }
+
+    out_desc =
+        axis2_conf_get_transport_out(axis2_conf_ctx_get_conf(conf_ctx, env),
+                                     env, AXIS2_TRANSPORT_ENUM_TCP);
+    if (!out_desc)
+    {
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "Transport out not set");
+        return AXIS2_FAILURE;
+    }
+
+    in_desc =
+        axis2_conf_get_transport_in(axis2_conf_ctx_get_conf(conf_ctx, env), env,
+                                    AXIS2_TRANSPORT_ENUM_TCP);
+
+    /* Frames without a content type come from SOAP 1.2 senders, the only
+       version the transport used to carry */
+    if (request->content_type &&
+        axutil_strstr(request->content_type, AXIS2_TCP_CONTENT_TYPE_SOAP11))
+    {
+        is_soap11 = AXIS2_TRUE;
+    }
+
+    reader = axiom_xml_reader_create_for_memory(env, request->body,
+                                                request->body_len,
                                                 NULL,
                                                 AXIS2_XML_PARSER_TYPE_BUFFER);
     if (!reader)
@@ -116,69 +196,213 @@ axis2_tcp_worker_process_request(
     {
         AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
                         "Failed to create Stax builder");
+        axiom_xml_reader_free(reader, env);
         return AXIS2_FAILURE;
     }
 
-    soap_builder = axiom_soap_builder_create(env, builder,
+    soap_builder = axiom_soap_builder_create(env, builder, is_soap11 ?
+                                             AXIOM_SOAP11_SOAP_ENVELOPE_NAMESPACE_URI :
                                              AXIOM_SOAP12_SOAP_ENVELOPE_NAMESPACE_URI);
-
     if (!soap_builder)
     {
         AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
                         "Failed to create SOAP builder");
+        axiom_stax_builder_free(builder, env);
         return AXIS2_FAILURE;
     }
 
-    conf_ctx = tcp_worker->conf_ctx;
-
-    if (!conf_ctx)
+    soap_envelope = axiom_soap_builder_get_soap_envelope(soap_builder, env);
+    if (!soap_envelope)
     {
-        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "conf ctx not available");
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "Failed to create SOAP envelope");
+        axiom_soap_builder_free(soap_builder, env);
         return AXIS2_FAILURE;
     }
 
-    out_desc =
-        axis2_conf_get_transport_out(axis2_conf_ctx_get_conf(conf_ctx, env),
-                                     env, AXIS2_TRANSPORT_ENUM_TCP);
-    if (!out_desc)
+    out_stream = axutil_stream_create_basic(env);
+    if (!out_stream)
     {
-        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "Transport out not set");
+        axiom_soap_envelope_free(soap_envelope, env);
         return AXIS2_FAILURE;
     }
 
-    in_desc =
-        axis2_conf_get_transport_in(axis2_conf_ctx_get_conf(conf_ctx, env), env,
-                                    AXIS2_TRANSPORT_ENUM_TCP);
-
     msg_ctx = axis2_msg_ctx_create(env, conf_ctx, in_desc, out_desc);
+    if (!msg_ctx)
+    {
+        axiom_soap_envelope_free(soap_envelope, env);
+        axutil_stream_free(out_stream, env);
+        return AXIS2_FAILURE;
+    }
     axis2_msg_ctx_set_server_side(msg_ctx, env, AXIS2_TRUE);
     axis2_msg_ctx_set_transport_out_stream(msg_ctx, env, out_stream);
-
-    soap_envelope = axiom_soap_builder_get_soap_envelope(soap_builder, env);
+    axis2_msg_ctx_set_is_soap_11(msg_ctx, env, is_soap11);
     axis2_msg_ctx_set_soap_envelope(msg_ctx, env, soap_envelope);
+    if (request->action)
+    {
+        soap_action = axutil_string_create(env, request->action);
+        axis2_msg_ctx_set_soap_action(msg_ctx, env, soap_action);
+    }
 
     engine = axis2_engine_create(env, conf_ctx);
-    status = axis2_engine_receive(engine, env, msg_ctx);
+    if (engine)
+    {
+        status = axis2_engine_receive(engine, env, msg_ctx);
+    }
+    if (engine && AXIS2_SUCCESS != status &&
+        !axutil_stream_get_len(out_stream, env))
+    {
+        axis2_msg_ctx_t *fault_ctx = NULL;
+        axis2_char_t *fault_code = NULL;
 
-    svr_stream = axis2_simple_tcp_svr_conn_get_stream(svr_conn, env);
-    buffer = out_stream->buffer;
-    len = out_stream->len;
-    buffer[len] = 0;
-    if (svr_stream && buffer)
+        if (is_soap11)
+        {
+            fault_code = AXIOM_SOAP_DEFAULT_NAMESPACE_PREFIX ":"
+                AXIOM_SOAP11_FAULT_CODE_SENDER;
+        }
+        else
+        {
+            fault_code = AXIOM_SOAP_DEFAULT_NAMESPACE_PREFIX ":"
+                AXIOM_SOAP12_SOAP_FAULT_VALUE_SENDER;
+        }
+        fault_ctx = axis2_engine_create_fault_msg_ctx(engine, env, msg_ctx,
+                                                      fault_code,
+                                                      axutil_error_get_message
+                                                      (env->error));
+        if (fault_ctx)
+        {
+            axis2_engine_send_fault(engine, env, fault_ctx);
+            /* The fault context borrows the out stream and possibly the
+               fault envelope of the request; both are freed with msg_ctx */
+            axis2_msg_ctx_reset_transport_out_stream(fault_ctx, env);
+            if (axis2_msg_ctx_get_soap_envelope(fault_ctx, env) ==
+                axis2_msg_ctx_get_fault_soap_envelope(msg_ctx, env))
+            {
+                axis2_msg_ctx_set_soap_envelope(fault_ctx, env, NULL);
+            }
+            axis2_msg_ctx_free(fault_ctx, env);
+        }
+    }
+
+    /* Every request is answered, an empty body standing for no response
+       message, so that the client can match replies to requests */
+    len = axutil_stream_get_len(out_stream, env);
+    if (!tcp_worker->framing)
+    {
+        status = axis2_tcp_worker_write_unframed(env, svr_conn,
+                                                 axutil_stream_get_buffer
+                                                 (out_stream, env), len);
+    }
+    else
     {
-        write = axutil_stream_write(svr_stream, env, buffer, len + 1);
-        if (write < 0)
+        if (len > 0)
         {
-            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "stream write failed");
-            return AXIS2_FAILURE;
+            content_type = is_soap11 ? AXIS2_TCP_CONTENT_TYPE_SOAP11 :
+                AXIS2_TCP_CONTENT_TYPE_SOAP12;
         }
-        AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI, "stream wrote:%s", buffer);
+        status = axis2_simple_tcp_svr_conn_write_frame(svr_conn, env,
+                                                       request->id,
+                                                       content_type,
+                                                       axutil_stream_get_buffer
+                                                       (out_stream, env), len);
+    }
+    if (AXIS2_SUCCESS != status)
+    {
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "stream write failed");
+    }
+
+    axis2_tcp_worker_free_op_ctx(env, axis2_msg_ctx_get_op_ctx(msg_ctx, env));
+    /* Frees out_stream as well */
+    axis2_msg_ctx_free(msg_ctx, env);
+    if (soap_action)
+    {
+        axutil_string_free(soap_action, env);
     }
+    if (engine)
+    {
+        axis2_engine_free(engine, env);
+    }
+
     AXIS2_LOG_TRACE(env->log, AXIS2_LOG_SI,
                     "end:axis2_tcp_worker_process_request");
+    return status;
+}
+
+/* Writes a reply the unframed way, ended by a '\0' */
+static axis2_status_t
+axis2_tcp_worker_write_unframed(
+    const axutil_env_t * env,
+    axis2_simple_tcp_svr_conn_t * svr_conn,
+    const axis2_char_t * body,
+    int body_len)
+{
+    axutil_stream_t *svr_stream = NULL;
+
+    svr_stream = axis2_simple_tcp_svr_conn_get_stream(svr_conn, env);
+    if (!svr_stream)
+    {
+        return AXIS2_FAILURE;
+    }
+    if (body_len > 0 &&
+        axutil_stream_write(svr_stream, env, body, body_len) != body_len)
+    {
+        return AXIS2_FAILURE;
+    }
+    if (axutil_stream_write(svr_stream, env, "", 1) != 1)
+    {
+        return AXIS2_FAILURE;
+    }
+    AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI, "stream wrote %d bytes", body_len);
     return AXIS2_SUCCESS;
 }
 
+/* Frees the operation context of a served request along with its out
+   message context, as the HTTP worker does; the in message context is
+   freed by the caller */
+static void
+axis2_tcp_worker_free_op_ctx(
+    const axutil_env_t * env,
+    axis2_op_ctx_t * op_ctx)
+{
+    axis2_msg_ctx_t **msg_ctx_map = NULL;
+    axis2_msg_ctx_t *in_msg_ctx = NULL;
+    axis2_conf_ctx_t *conf_ctx = NULL;
+    axis2_char_t *msg_id = NULL;
+
+    if (!op_ctx)
+    {
+        return;
+    }
+
+    msg_ctx_map = axis2_op_ctx_get_msg_ctx_map(op_ctx, env);
+    if (msg_ctx_map[AXIS2_WSDL_MESSAGE_LABEL_OUT])
+    {
+        axis2_msg_ctx_free(msg_ctx_map[AXIS2_WSDL_MESSAGE_LABEL_OUT], env);
+        msg_ctx_map[AXIS2_WSDL_MESSAGE_LABEL_OUT] = NULL;
+    }
+    in_msg_ctx = msg_ctx_map[AXIS2_WSDL_MESSAGE_LABEL_IN];
+    if (in_msg_ctx)
+    {
+        msg_id = axutil_strdup(env, axis2_msg_ctx_get_msg_id(in_msg_ctx, env));
+        conf_ctx = axis2_msg_ctx_get_conf_ctx(in_msg_ctx, env);
+        msg_ctx_map[AXIS2_WSDL_MESSAGE_LABEL_IN] = NULL;
+    }
+
+    if (!axis2_op_ctx_is_in_use(op_ctx, env))
+    {
+        axis2_op_ctx_destroy_mutex(op_ctx, env);
+        if (conf_ctx && msg_id)
+        {
+            axis2_conf_ctx_register_op_ctx(conf_ctx, env, msg_id, NULL);
+        }
+        axis2_op_ctx_free(op_ctx, env);
+    }
+    if (msg_id)
+    {
+        AXIS2_FREE(env->allocator, msg_id);
+    }
+}
+
 AXIS2_EXTERN axis2_status_t AXIS2_CALL
 axis2_tcp_worker_set_svr_port(
     axis2_tcp_worker_t * worker,
@@ -188,3 +412,19 @@ axis2_tcp_worker_set_svr_port(
     worker->svr_port = port;
     return AXIS2_SUCCESS;
 }
+
+AXIS2_EXTERN int AXIS2_CALL
+axis2_tcp_worker_get_max_frame_size(
+    const axis2_tcp_worker_t * worker,
+    const axutil_env_t * env)
+{
+    return worker->max_frame_size;
+}
+
+AXIS2_EXTERN axis2_bool_t AXIS2_CALL
+axis2_tcp_worker_get_framing(
+    const axis2_tcp_worker_t * worker,
+    const axutil_env_t * env)
+{
+    return worker->framing;
+}
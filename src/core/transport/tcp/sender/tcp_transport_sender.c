@@ -29,8 +29,12 @@
 #include <axutil_types.h>
 #include <axutil_url.h>
 #include <axutil_network_handler.h>
+#include <axutil_thread.h>
+#include <axutil_array_list.h>
+#include <axis2_tcp_frame.h>
 
-#define RES_BUFF 50
+/* Initial size of the buffer an unframed response is read into */
+#define RES_BUFF 4096
 
 /**
  * TCP Transport Sender struct impl
@@ -42,6 +46,18 @@ typedef struct axis2_tcp_transport_sender_impl
     axis2_transport_sender_t transport_sender;
     int connection_timeout;
     int so_timeout;
+    int max_frame_size;
+    axis2_bool_t framing;
+
+    /* Idle connections per endpoint: "host:port" -> array list of socket
+       streams. A connection carries one call at a time, so calls made at
+       once from several threads each use a connection of their own */
+    axutil_hash_t *idle;
+    int max_idle;
+
+    /* Guards idle and next_id */
+    axutil_thread_mutex_t *mutex;
+    unsigned int next_id;
 } axis2_tcp_transport_sender_impl_t;
 
 #define AXIS2_INTF_TO_IMPL(transport_sender)    \
@@ -77,6 +93,10 @@ void AXIS2_CALL axis2_tcp_transport_sender_free(
     axis2_transport_sender_t * transport_sender,
     const axutil_env_t * env);
 
+static void axis2_tcp_transport_sender_close_conn(
+    const axutil_env_t * env,
+    axutil_stream_t * conn);
+
 static const axis2_transport_sender_ops_t tcp_transport_sender_ops_var = {
     axis2_tcp_transport_sender_init,
     axis2_tcp_transport_sender_invoke,
@@ -102,7 +122,21 @@ axis2_tcp_transport_sender_create(
     transport_sender_impl->connection_timeout =
         AXIS2_TCP_DEFAULT_CONNECTION_TIMEOUT;
     transport_sender_impl->so_timeout = AXIS2_TCP_DEFAULT_SO_TIMEOUT;
+    transport_sender_impl->max_frame_size = AXIS2_TCP_DEFAULT_MAX_FRAME_SIZE;
+    transport_sender_impl->framing = AXIS2_FALSE;
+    transport_sender_impl->max_idle = AXIS2_TCP_DEFAULT_MAX_IDLE_CONNECTIONS;
+    transport_sender_impl->next_id = 0;
     transport_sender_impl->transport_sender.ops = &tcp_transport_sender_ops_var;
+    transport_sender_impl->idle = axutil_hash_make(env);
+    transport_sender_impl->mutex =
+        axutil_thread_mutex_create(env->allocator, AXIS2_THREAD_MUTEX_DEFAULT);
+    if (!transport_sender_impl->idle || !transport_sender_impl->mutex)
+    {
+        axis2_tcp_transport_sender_free(&(transport_sender_impl->
+                                          transport_sender), env);
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return NULL;
+    }
     return &(transport_sender_impl->transport_sender);
 }
 
@@ -114,18 +148,327 @@ axis2_tcp_transport_sender_free(
     axis2_tcp_transport_sender_impl_t *transport_sender_impl = NULL;
     AXIS2_ENV_CHECK(env, AXIS2_FAILURE);
     transport_sender_impl = AXIS2_INTF_TO_IMPL(transport_sender);
+    if (transport_sender_impl->idle)
+    {
+        axutil_hash_index_t *hi = NULL;
+        const void *key = NULL;
+        void *val = NULL;
+        int i = 0;
+
+        for (hi = axutil_hash_first(transport_sender_impl->idle, env); hi;
+             hi = axutil_hash_next(env, hi))
+        {
+            axutil_array_list_t *conns = NULL;
+
+            axutil_hash_this(hi, &key, NULL, &val);
+            conns = (axutil_array_list_t *) val;
+            for (i = 0; i < axutil_array_list_size(conns, env); i++)
+            {
+                axis2_tcp_transport_sender_close_conn(env,
+                                                      axutil_array_list_get
+                                                      (conns, env, i));
+            }
+            axutil_array_list_free(conns, env);
+            AXIS2_FREE(env->allocator, (void *) key);
+        }
+        axutil_hash_free(transport_sender_impl->idle, env);
+    }
+    if (transport_sender_impl->mutex)
+    {
+        axutil_thread_mutex_destroy(transport_sender_impl->mutex);
+    }
     AXIS2_FREE(env->allocator, transport_sender_impl);
     return;
 }
 
+static void
+axis2_tcp_transport_sender_close_conn(
+    const axutil_env_t * env,
+    axutil_stream_t * conn)
+{
+    axutil_network_handler_close_socket(env, conn->socket);
+    axutil_stream_free(conn, env);
+}
+
+/* Takes an idle connection to an endpoint, if there is one */
+static axutil_stream_t *
+axis2_tcp_transport_sender_get_conn(
+    axis2_tcp_transport_sender_impl_t * sender_impl,
+    const axutil_env_t * env,
+    const axis2_char_t * key)
+{
+    axutil_array_list_t *conns = NULL;
+    axutil_stream_t *conn = NULL;
+    int size = 0;
+
+    axutil_thread_mutex_lock(sender_impl->mutex);
+    conns = axutil_hash_get(sender_impl->idle, key, AXIS2_HASH_KEY_STRING);
+    if (conns)
+    {
+        size = axutil_array_list_size(conns, env);
+        if (size > 0)
+        {
+            conn = axutil_array_list_remove(conns, env, size - 1);
+        }
+    }
+    axutil_thread_mutex_unlock(sender_impl->mutex);
+    return conn;
+}
+
+/* Keeps a connection for later calls to the endpoint, or closes it when
+   enough are kept already */
+static void
+axis2_tcp_transport_sender_put_conn(
+    axis2_tcp_transport_sender_impl_t * sender_impl,
+    const axutil_env_t * env,
+    const axis2_char_t * key,
+    axutil_stream_t * conn)
+{
+    axutil_array_list_t *conns = NULL;
+
+    axutil_thread_mutex_lock(sender_impl->mutex);
+    conns = axutil_hash_get(sender_impl->idle, key, AXIS2_HASH_KEY_STRING);
+    if (!conns)
+    {
+        conns = axutil_array_list_create(env, 0);
+        if (conns)
+        {
+            axutil_hash_set(sender_impl->idle, axutil_strdup(env, key),
+                            AXIS2_HASH_KEY_STRING, conns);
+        }
+    }
+    if (conns && axutil_array_list_size(conns, env) < sender_impl->max_idle)
+    {
+        axutil_array_list_add(conns, env, conn);
+        conn = NULL;
+    }
+    axutil_thread_mutex_unlock(sender_impl->mutex);
+
+    if (conn)
+    {
+        axis2_tcp_transport_sender_close_conn(env, conn);
+    }
+}
+
+static axutil_stream_t *
+axis2_tcp_transport_sender_open_conn(
+    axis2_tcp_transport_sender_impl_t * sender_impl,
+    const axutil_env_t * env,
+    const axis2_char_t * host,
+    int port)
+{
+    axis2_socket_t socket = AXIS2_INVALID_SOCKET;
+    axutil_stream_t *conn = NULL;
+
+    socket = axutil_network_handler_open_socket(env, (char *) host, port);
+    if (AXIS2_INVALID_SOCKET == socket)
+    {
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "socket creation failed");
+        return NULL;
+    }
+    axutil_network_handler_set_sock_option(env, socket, SO_RCVTIMEO,
+                                           sender_impl->so_timeout);
+    axutil_network_handler_set_sock_option(env, socket, SO_SNDTIMEO,
+                                           sender_impl->so_timeout);
+
+    AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI,
+                    "open socket for host:%s port:%d", host, port);
+
+    conn = axutil_stream_create_socket(env, socket);
+    if (!conn)
+    {
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "stream creation failed");
+        axutil_network_handler_close_socket(env, socket);
+    }
+    return conn;
+}
+
+/* Builds the response envelope. It is built completely, as the response
+   body it is read from is freed once the call returns */
+static axis2_status_t
+axis2_tcp_transport_sender_set_response(
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx,
+    axis2_tcp_frame_t * response)
+{
+    axiom_xml_reader_t *reader = NULL;
+    axiom_stax_builder_t *builder = NULL;
+    axiom_soap_builder_t *soap_builder = NULL;
+    axiom_soap_envelope_t *soap_envelope = NULL;
+    axiom_node_t *envelope_node = NULL;
+    const axis2_char_t *soap_ns = AXIOM_SOAP12_SOAP_ENVELOPE_NAMESPACE_URI;
+
+    if (response->content_type &&
+        axutil_strstr(response->content_type, AXIS2_TCP_CONTENT_TYPE_SOAP11))
+    {
+        soap_ns = AXIOM_SOAP11_SOAP_ENVELOPE_NAMESPACE_URI;
+    }
+
+    reader = axiom_xml_reader_create_for_memory(env, response->body,
+                                                response->body_len, NULL,
+                                                AXIS2_XML_PARSER_TYPE_BUFFER);
+    if (!reader)
+    {
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "Failed to create XML reader");
+        return AXIS2_FAILURE;
+    }
+
+    builder = axiom_stax_builder_create(env, reader);
+    if (!builder)
+    {
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "Failed to create Stax builder");
+        axiom_xml_reader_free(reader, env);
+        return AXIS2_FAILURE;
+    }
+
+    soap_builder = axiom_soap_builder_create(env, builder, soap_ns);
+    if (!soap_builder)
+    {
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "Failed to create SOAP builder");
+        axiom_stax_builder_free(builder, env);
+        return AXIS2_FAILURE;
+    }
+
+    soap_envelope = axiom_soap_builder_get_soap_envelope(soap_builder, env);
+    if (soap_envelope)
+    {
+        envelope_node = axiom_soap_envelope_get_base_node(soap_envelope, env);
+    }
+    while (envelope_node && !axiom_node_is_complete(envelope_node, env))
+    {
+        if (AXIS2_SUCCESS != axiom_soap_builder_next(soap_builder, env))
+        {
+            break;
+        }
+    }
+    if (!envelope_node || !axiom_node_is_complete(envelope_node, env))
+    {
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "Failed to create SOAP envelope");
+        if (soap_envelope)
+        {
+            axiom_soap_envelope_free(soap_envelope, env);
+        }
+        else
+        {
+            axiom_soap_builder_free(soap_builder, env);
+        }
+        return AXIS2_FAILURE;
+    }
+
+    axis2_msg_ctx_set_response_soap_envelope(msg_ctx, env, soap_envelope);
+    return AXIS2_SUCCESS;
+}
+
+/* Sends a request the unframed way, on a connection of its own: the
+   envelope and an empty line, answered by the reply and a '\0' up to the
+   close of the connection */
+static axis2_status_t
+axis2_tcp_transport_sender_send_unframed(
+    axis2_tcp_transport_sender_impl_t * sender_impl,
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx,
+    const axis2_char_t * host,
+    int port,
+    const axis2_char_t * buffer,
+    int buffer_size)
+{
+    axutil_stream_t *conn = NULL;
+    axis2_tcp_frame_t response;
+    axis2_char_t *res_buffer = NULL;
+    int res_size = 0;
+    int size = RES_BUFF;
+    int read = 0;
+    axis2_status_t status = AXIS2_FAILURE;
+
+    conn = axis2_tcp_transport_sender_open_conn(sender_impl, env, host, port);
+    if (!conn)
+    {
+        return AXIS2_FAILURE;
+    }
+    if (axutil_stream_write(conn, env, buffer, buffer_size) != buffer_size ||
+        axutil_stream_write(conn, env, AXIS2_CRLF AXIS2_CRLF, 4) != 4)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_SOCKET_ERROR, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "stream write error");
+        axis2_tcp_transport_sender_close_conn(env, conn);
+        return AXIS2_FAILURE;
+    }
+    AXIS2_LOG_TRACE(env->log, AXIS2_LOG_SI, "stream wrote soap msg: %s",
+                    buffer);
+
+    res_buffer = AXIS2_MALLOC(env->allocator, size + 1);
+    while (res_buffer &&
+           (read = axutil_stream_read(conn, env, res_buffer + res_size,
+                                      size - res_size)) > 0)
+    {
+        res_size += read;
+        if (res_size == size)
+        {
+            axis2_char_t *grown = NULL;
+
+            if (size > sender_impl->max_frame_size)
+            {
+                AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                                "TCP response exceeds the limit of %d bytes",
+                                sender_impl->max_frame_size);
+                read = -1;
+                break;
+            }
+            size *= 2;
+            grown = AXIS2_REALLOC(env->allocator, res_buffer, size + 1);
+            if (!grown)
+            {
+                AXIS2_FREE(env->allocator, res_buffer);
+            }
+            res_buffer = grown;
+        }
+    }
+    axis2_tcp_transport_sender_close_conn(env, conn);
+    if (!res_buffer)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+    if (read < 0)
+    {
+        AXIS2_FREE(env->allocator, res_buffer);
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_SOCKET_ERROR, AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+
+    /* The '\0' ending the reply is not part of it */
+    if (res_size > 0 && !res_buffer[res_size - 1])
+    {
+        res_size--;
+    }
+    res_buffer[res_size] = '\0';
+    AXIS2_LOG_TRACE(env->log, AXIS2_LOG_SI, "%s", res_buffer);
+
+    status = AXIS2_SUCCESS;
+    if (res_size > 0)
+    {
+        /* Unframed replies carry SOAP 1.2 envelopes */
+        response.id = 0;
+        response.content_type = NULL;
+        response.action = NULL;
+        response.body = res_buffer;
+        response.body_len = res_size;
+        status = axis2_tcp_transport_sender_set_response(env, msg_ctx,
+                                                         &response);
+    }
+    AXIS2_FREE(env->allocator, res_buffer);
+    return status;
+}
+
 axis2_status_t AXIS2_CALL
 axis2_tcp_transport_sender_invoke(
     axis2_transport_sender_t * transport_sender,
     const axutil_env_t * env,
     axis2_msg_ctx_t * msg_ctx)
 {
-    axis2_op_t *op = NULL;
-    const axis2_char_t *mep_uri = NULL;
     axis2_bool_t is_server = AXIS2_TRUE;
     axiom_soap_envelope_t *soap_envelope = NULL;
     axiom_xml_writer_t *xml_writer = NULL;
@@ -143,9 +486,6 @@ axis2_tcp_transport_sender_invoke(
     AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI,
                     "start:tcp transport sender invoke");
 
-    op = axis2_msg_ctx_get_op(msg_ctx, env);
-    mep_uri = axis2_op_get_msg_exchange_pattern(op, env);
-
     is_server = axis2_msg_ctx_get_server_side(msg_ctx, env);
 
     soap_envelope = axis2_msg_ctx_get_soap_envelope(msg_ctx, env);
@@ -237,25 +577,24 @@ axis2_tcp_transport_sender_invoke(
     }
     else
     {
+        axis2_tcp_transport_sender_impl_t *sender_impl = NULL;
         axis2_endpoint_ref_t *to = NULL;
         axutil_url_t *to_url = NULL;
         const axis2_char_t *to_str = NULL;
         const axis2_char_t *host = NULL;
+        const axis2_char_t *content_type = NULL;
+        const axis2_char_t *action = NULL;
+        axutil_string_t *soap_action = NULL;
+        axis2_char_t *key = NULL;
         int port = 0;
-        int socket = -1;
-        axutil_stream_t *stream;
-        int write = -1;
-        int read = -1;
-        axis2_char_t buff[1];
-        axis2_char_t *res_buffer = (axis2_char_t *) AXIS2_MALLOC(env->allocator,
-                                                                 RES_BUFF);
-        int res_size = 0;
-        int size = 0;
-        axiom_xml_reader_t *reader = NULL;
-        axiom_stax_builder_t *builder = NULL;
-        axiom_soap_builder_t *soap_builder = NULL;
-        axiom_soap_envelope_t *soap_envelope = NULL;
-
+        unsigned int id = 0;
+        axutil_stream_t *conn = NULL;
+        axis2_bool_t reused = AXIS2_FALSE;
+        axis2_bool_t is_soap11 = AXIS2_FALSE;
+        axis2_status_t status = AXIS2_FAILURE;
+        axis2_tcp_frame_t *response = NULL;
+
+        sender_impl = AXIS2_INTF_TO_IMPL(transport_sender);
         to = axis2_msg_ctx_get_to(msg_ctx, env);
 
         if (!to)
@@ -282,106 +621,139 @@ axis2_tcp_transport_sender_invoke(
         }
 
         host = axutil_url_get_host(to_url, env);
-        if (!host)
+        port = axutil_url_get_port(to_url, env);
+        if (!host || !port)
         {
-            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "retrieving host failed");
+            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                            "retrieving host or port failed");
+            axutil_url_free(to_url, env);
             return AXIS2_FAILURE;
         }
 
-        port = axutil_url_get_port(to_url, env);
-        if (!port)
+        if (!sender_impl->framing)
         {
-            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "retrieving port failed");
-            return AXIS2_FAILURE;
+            status = axis2_tcp_transport_sender_send_unframed(sender_impl, env,
+                                                              msg_ctx, host,
+                                                              port, buffer,
+                                                              buffer_size);
+            axutil_url_free(to_url, env);
+            axiom_output_free(om_output, env);
+            AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI,
+                            "end:tcp transport sender invoke");
+            return status;
         }
-        socket = (int)axutil_network_handler_open_socket(env, (char *) host, port);
-        if (!socket)
+
+        key = AXIS2_MALLOC(env->allocator, axutil_strlen(host) + 12);
+        if (!key)
         {
-            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "socket creation failed");
+            AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+            axutil_url_free(to_url, env);
             return AXIS2_FAILURE;
         }
+        sprintf(key, "%s:%d", host, port);
 
-        AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI,
-                        "open socket for host:%s port:%d", host, port);
-
-        stream = axutil_stream_create_socket(env, socket);
-        if (!stream)
+        is_soap11 = axis2_msg_ctx_get_is_soap_11(msg_ctx, env);
+        content_type = is_soap11 ? AXIS2_TCP_CONTENT_TYPE_SOAP11 :
+            AXIS2_TCP_CONTENT_TYPE_SOAP12;
+        soap_action = axis2_msg_ctx_get_soap_action(msg_ctx, env);
+        if (soap_action)
         {
-            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "stream creation failed");
-            return AXIS2_FAILURE;
+            action = axutil_string_get_buffer(soap_action, env);
         }
-
-        write = axutil_stream_write(stream, env, buffer, buffer_size);
-        if (write < 0)
+        if (!action || !*action)
         {
-            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "stream write error");
-            return AXIS2_FAILURE;
+            action = axis2_msg_ctx_get_wsa_action(msg_ctx, env);
         }
-        AXIS2_LOG_TRACE(env->log, AXIS2_LOG_SI, "stream wrote soap msg: %s",
-                        buffer);
-        write = axutil_stream_write(stream, env, "\r\n\r\n", 4);
-        size = RES_BUFF;
-        while ((read = axutil_stream_read(stream, env, &buff, 1)) > 0)
+
+        axutil_thread_mutex_lock(sender_impl->mutex);
+        id = ++sender_impl->next_id;
+        axutil_thread_mutex_unlock(sender_impl->mutex);
+
+        conn = axis2_tcp_transport_sender_get_conn(sender_impl, env, key);
+        reused = conn ? AXIS2_TRUE : AXIS2_FALSE;
+        while (AXIS2_TRUE)
         {
-            if (res_size >= size)
+            axis2_bool_t written = AXIS2_FALSE;
+
+            if (!conn)
             {
-                axis2_char_t *tmp_buff = NULL;
-                size <<= 2;
-                tmp_buff = AXIS2_MALLOC(env->allocator, size);
-                memcpy(tmp_buff, res_buffer, res_size);
-                AXIS2_FREE(env->allocator, res_buffer);
-                res_buffer = tmp_buff;
+                conn = axis2_tcp_transport_sender_open_conn(sender_impl, env,
+                                                            host, port);
+            }
+            if (!conn)
+            {
+                status = AXIS2_FAILURE;
+                break;
             }
-            memcpy(res_buffer + res_size, buff, 1);
-            res_size++;
-        }
 
-        axutil_network_handler_close_socket(env, stream->socket);
-        axutil_stream_close(stream, env);
-        axutil_stream_free(stream, env);
+            status = axis2_tcp_frame_write(env, conn, id, content_type, action,
+                                           buffer, buffer_size);
+            if (AXIS2_SUCCESS == status)
+            {
+                written = AXIS2_TRUE;
+                AXIS2_LOG_TRACE(env->log, AXIS2_LOG_SI,
+                                "stream wrote soap msg: %s", buffer);
+                status = axis2_tcp_frame_read(env, conn,
+                                              sender_impl->max_frame_size,
+                                              &response);
+            }
+            if (AXIS2_SUCCESS == status && response)
+            {
+                break;
+            }
 
-        AXIS2_LOG_TRACE(env->log, AXIS2_LOG_SI, "%s", res_buffer);
+            axis2_tcp_transport_sender_close_conn(env, conn);
+            conn = NULL;
 
-        reader =
-            axiom_xml_reader_create_for_memory(env, res_buffer, (res_size - 1),
-                                               NULL,
-                                               AXIS2_XML_PARSER_TYPE_BUFFER);
+            /* An idle connection may have been closed by the server just as
+               it was taken. The request was not read then, so it is sent
+               again on a new connection */
+            if (!reused || (written && AXIS2_SUCCESS != status))
+            {
+                if (AXIS2_SUCCESS == status)
+                {
+                    AXIS2_ERROR_SET(env->error, AXIS2_ERROR_SOCKET_ERROR,
+                                    AXIS2_FAILURE);
+                    AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                                    "Connection closed before the response");
+                }
+                status = AXIS2_FAILURE;
+                break;
+            }
+            reused = AXIS2_FALSE;
+        }
+        axutil_url_free(to_url, env);
 
-        if (!reader)
+        if (response && response->id != id)
         {
+            AXIS2_ERROR_SET(env->error, AXIS2_ERROR_INVALID_HEADER,
+                            AXIS2_FAILURE);
             AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
-                            "Failed to create XML reader");
-            return AXIS2_FAILURE;
+                            "Response %u does not answer request %u",
+                            response->id, id);
+            axis2_tcp_transport_sender_close_conn(env, conn);
+            conn = NULL;
+            status = AXIS2_FAILURE;
         }
-
-        builder = axiom_stax_builder_create(env, reader);
-        if (!builder)
+        if (conn)
         {
-            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
-                            "Failed to create Stax builder");
-            return AXIS2_FAILURE;
+            axis2_tcp_transport_sender_put_conn(sender_impl, env, key, conn);
         }
+        AXIS2_FREE(env->allocator, key);
 
-        soap_builder = axiom_soap_builder_create(env, builder,
-                                                 AXIOM_SOAP12_SOAP_ENVELOPE_NAMESPACE_URI);
-        if (!soap_builder)
+        if (AXIS2_SUCCESS == status && response->body_len > 0)
         {
-            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
-                            "Failed to create SOAP builder");
-            return AXIS2_FAILURE;
+            status = axis2_tcp_transport_sender_set_response(env, msg_ctx,
+                                                             response);
         }
-        soap_envelope = axiom_soap_builder_get_soap_envelope(soap_builder, env);
-
-        if (!soap_envelope)
+        axis2_tcp_frame_free(response, env);
+        if (AXIS2_SUCCESS != status)
         {
-            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
-                            "Failed to create SOAP envelope");
+            axiom_output_free(om_output, env);
             return AXIS2_FAILURE;
         }
-
-        axis2_msg_ctx_set_response_soap_envelope(msg_ctx, env, soap_envelope);
-
     }
+    axiom_output_free(om_output, env);
     AXIS2_LOG_DEBUG(env->log, AXIS2_LOG_SI, "end:tcp transport sender invoke");
     return AXIS2_SUCCESS;
 }
@@ -426,8 +798,8 @@ axis2_tcp_transport_sender_init(
     {
         AXIS2_INTF_TO_IMPL(transport_sender)->so_timeout = AXIS2_ATOI(temp);
     }
-    temp =
-        (axis2_char_t *)
+    temp = NULL;
+    temp_param =
         axutil_param_container_get_param
         (axis2_transport_out_desc_param_container(out_desc, env), env,
          AXIS2_TCP_CONNECTION_TIMEOUT);
@@ -440,6 +812,45 @@ axis2_tcp_transport_sender_init(
         AXIS2_INTF_TO_IMPL(transport_sender)->connection_timeout =
             AXIS2_ATOI(temp);
     }
+    temp = NULL;
+    temp_param =
+        axutil_param_container_get_param
+        (axis2_transport_out_desc_param_container(out_desc, env), env,
+         AXIS2_TCP_MAX_FRAME_SIZE);
+    if (temp_param)
+    {
+        temp = axutil_param_get_value(temp_param, env);
+    }
+    if (temp)
+    {
+        AXIS2_INTF_TO_IMPL(transport_sender)->max_frame_size = AXIS2_ATOI(temp);
+    }
+    temp = NULL;
+    temp_param =
+        axutil_param_container_get_param
+        (axis2_transport_out_desc_param_container(out_desc, env), env,
+         AXIS2_TCP_MAX_IDLE_CONNECTIONS);
+    if (temp_param)
+    {
+        temp = axutil_param_get_value(temp_param, env);
+    }
+    if (temp)
+    {
+        AXIS2_INTF_TO_IMPL(transport_sender)->max_idle = AXIS2_ATOI(temp);
+    }
+    temp = NULL;
+    temp_param =
+        axutil_param_container_get_param
+        (axis2_transport_out_desc_param_container(out_desc, env), env,
+         AXIS2_TCP_FRAMING);
+    if (temp_param)
+    {
+        temp = axutil_param_get_value(temp_param, env);
+    }
+    if (temp && !axutil_strcasecmp(temp, AXIS2_VALUE_TRUE))
+    {
+        AXIS2_INTF_TO_IMPL(transport_sender)->framing = AXIS2_TRUE;
+    }
 
     return AXIS2_SUCCESS;
 }
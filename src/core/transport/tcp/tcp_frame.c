@@ -0,0 +1,366 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <axis2_tcp_frame.h>
+#include <axutil_string.h>
+#include <platforms/axutil_platform_auto_sense.h>
+
+/* Bodies up to this size are sent in the same write as the header */
+#define AXIS2_TCP_FRAME_COALESCE_SIZE 4096
+
+static void
+axis2_tcp_frame_put_int(
+    unsigned char *buf,
+    unsigned int value)
+{
+    buf[0] = (unsigned char) (value >> 24);
+    buf[1] = (unsigned char) (value >> 16);
+    buf[2] = (unsigned char) (value >> 8);
+    buf[3] = (unsigned char) value;
+}
+
+static unsigned int
+axis2_tcp_frame_get_int(
+    const unsigned char *buf)
+{
+    return ((unsigned int) buf[0] << 24) | ((unsigned int) buf[1] << 16) |
+        ((unsigned int) buf[2] << 8) | (unsigned int) buf[3];
+}
+
+/* Reads exactly len bytes. Returns the number of bytes read, which is less
+   than len only if the peer closed the connection, or -1 on error */
+static int
+axis2_tcp_frame_read_fully(
+    const axutil_env_t * env,
+    axutil_stream_t * stream,
+    void *buffer,
+    int len)
+{
+    int done = 0;
+
+    while (done < len)
+    {
+        int read = axutil_stream_read(stream, env, (char *) buffer + done,
+                                      len - done);
+        if (read < 0)
+        {
+            return -1;
+        }
+        if (read == 0)
+        {
+            break;
+        }
+        done += read;
+    }
+    return done;
+}
+
+static axis2_status_t
+axis2_tcp_frame_write_fully(
+    const axutil_env_t * env,
+    axutil_stream_t * stream,
+    const void *buffer,
+    int len)
+{
+    int done = 0;
+
+    while (done < len)
+    {
+        int written = 0;
+#ifdef MSG_NOSIGNAL
+        /* A peer that went away must fail the write, not kill the process */
+        if (AXIS2_STREAM_SOCKET == stream->stream_type)
+        {
+            written = (int) send(stream->socket, (const char *) buffer + done,
+                                 len - done, MSG_NOSIGNAL);
+        }
+        else
+#endif
+        {
+            written = axutil_stream_write(stream, env,
+                                          (const char *) buffer + done,
+                                          len - done);
+        }
+        if (written <= 0)
+        {
+            return AXIS2_FAILURE;
+        }
+        done += written;
+    }
+    return AXIS2_SUCCESS;
+}
+
+static void
+axis2_tcp_frame_parse_meta(
+    axis2_tcp_frame_t * frame,
+    const axutil_env_t * env,
+    axis2_char_t * meta)
+{
+    axis2_char_t *line = meta;
+
+    while (line && *line)
+    {
+        axis2_char_t *end = strstr(line, AXIS2_CRLF);
+        axis2_char_t *value = NULL;
+
+        if (end)
+        {
+            *end = '\0';
+        }
+        value = strchr(line, ':');
+        if (value)
+        {
+            *value++ = '\0';
+            while (*value == ' ')
+            {
+                value++;
+            }
+            if (!axutil_strcasecmp(line, AXIS2_TCP_FRAME_CONTENT_TYPE) &&
+                !frame->content_type)
+            {
+                frame->content_type = axutil_strdup(env, value);
+            }
+            else if (!axutil_strcasecmp(line, AXIS2_TCP_FRAME_ACTION) &&
+                     !frame->action)
+            {
+                frame->action = axutil_strdup(env, value);
+            }
+        }
+        line = end ? end + 2 : NULL;
+    }
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_tcp_frame_read(
+    const axutil_env_t * env,
+    axutil_stream_t * stream,
+    int max_size,
+    axis2_tcp_frame_t ** frame)
+{
+    unsigned char header[AXIS2_TCP_FRAME_HEADER_SIZE];
+    unsigned int meta_len = 0;
+    unsigned int body_len = 0;
+    axis2_tcp_frame_t *new_frame = NULL;
+    axis2_char_t *meta = NULL;
+    int read = 0;
+
+    AXIS2_PARAM_CHECK(env->error, stream, AXIS2_FAILURE);
+    AXIS2_PARAM_CHECK(env->error, frame, AXIS2_FAILURE);
+    *frame = NULL;
+
+    read = axis2_tcp_frame_read_fully(env, stream, header, sizeof(header));
+    if (read == 0)
+    {
+        return AXIS2_SUCCESS;
+    }
+    if (read != sizeof(header))
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_SOCKET_ERROR, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "Connection closed or failed inside a frame header");
+        return AXIS2_FAILURE;
+    }
+    if (header[0] != 'A' || header[1] != 'X' ||
+        header[2] != AXIS2_TCP_FRAME_VERSION)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_INVALID_HEADER, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "Received data is not a version %d TCP frame",
+                        AXIS2_TCP_FRAME_VERSION);
+        return AXIS2_FAILURE;
+    }
+
+    meta_len = axis2_tcp_frame_get_int(header + 8);
+    body_len = axis2_tcp_frame_get_int(header + 12);
+    if (meta_len > AXIS2_TCP_FRAME_MAX_META_SIZE)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_INVALID_HEADER, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "TCP frame metadata of %u bytes exceeds the limit of "
+                        "%d bytes", meta_len, AXIS2_TCP_FRAME_MAX_META_SIZE);
+        return AXIS2_FAILURE;
+    }
+    if (body_len > (unsigned int) max_size)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_INVALID_HEADER, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "TCP frame of %u bytes exceeds the limit of %d bytes",
+                        body_len, max_size);
+        return AXIS2_FAILURE;
+    }
+
+    new_frame = AXIS2_MALLOC(env->allocator, sizeof(axis2_tcp_frame_t));
+    if (!new_frame)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+    new_frame->id = axis2_tcp_frame_get_int(header + 4);
+    new_frame->content_type = NULL;
+    new_frame->action = NULL;
+    new_frame->body_len = (int) body_len;
+    new_frame->body = AXIS2_MALLOC(env->allocator, body_len + 1);
+    meta = AXIS2_MALLOC(env->allocator, meta_len + 1);
+    if (!new_frame->body || !meta)
+    {
+        AXIS2_FREE(env->allocator, meta);
+        axis2_tcp_frame_free(new_frame, env);
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+
+    if (axis2_tcp_frame_read_fully(env, stream, meta, (int) meta_len) !=
+        (int) meta_len ||
+        axis2_tcp_frame_read_fully(env, stream, new_frame->body,
+                                   (int) body_len) != (int) body_len)
+    {
+        AXIS2_FREE(env->allocator, meta);
+        axis2_tcp_frame_free(new_frame, env);
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_SOCKET_ERROR, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "Connection closed or failed inside a frame");
+        return AXIS2_FAILURE;
+    }
+    meta[meta_len] = '\0';
+    new_frame->body[body_len] = '\0';
+
+    axis2_tcp_frame_parse_meta(new_frame, env, meta);
+    AXIS2_FREE(env->allocator, meta);
+
+    *frame = new_frame;
+    return AXIS2_SUCCESS;
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_tcp_frame_write(
+    const axutil_env_t * env,
+    axutil_stream_t * stream,
+    unsigned int id,
+    const axis2_char_t * content_type,
+    const axis2_char_t * action,
+    const axis2_char_t * body,
+    int body_len)
+{
+    unsigned char *buffer = NULL;
+    int meta_len = 0;
+    int len = 0;
+    int coalesced = 0;
+    axis2_status_t status = AXIS2_FAILURE;
+
+    AXIS2_PARAM_CHECK(env->error, stream, AXIS2_FAILURE);
+
+    /* A line break in a value would end its metadata line early and let the
+       rest pass for lines of its own */
+    if ((content_type && strpbrk(content_type, AXIS2_CRLF)) ||
+        (action && strpbrk(action, AXIS2_CRLF)))
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_INVALID_HEADER, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "TCP frame metadata value contains a line break");
+        return AXIS2_FAILURE;
+    }
+
+    if (content_type)
+    {
+        meta_len += axutil_strlen(AXIS2_TCP_FRAME_CONTENT_TYPE) + 2 +
+            axutil_strlen(content_type) + 2;
+    }
+    if (action)
+    {
+        meta_len += axutil_strlen(AXIS2_TCP_FRAME_ACTION) + 2 +
+            axutil_strlen(action) + 2;
+    }
+    if (meta_len > AXIS2_TCP_FRAME_MAX_META_SIZE)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_INVALID_HEADER, AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+    if (body_len <= AXIS2_TCP_FRAME_COALESCE_SIZE)
+    {
+        coalesced = body_len;
+    }
+
+    buffer = AXIS2_MALLOC(env->allocator,
+                          AXIS2_TCP_FRAME_HEADER_SIZE + meta_len + coalesced + 1);
+    if (!buffer)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+
+    buffer[0] = 'A';
+    buffer[1] = 'X';
+    buffer[2] = AXIS2_TCP_FRAME_VERSION;
+    buffer[3] = 0;
+    axis2_tcp_frame_put_int(buffer + 4, id);
+    axis2_tcp_frame_put_int(buffer + 8, (unsigned int) meta_len);
+    axis2_tcp_frame_put_int(buffer + 12, (unsigned int) body_len);
+    len = AXIS2_TCP_FRAME_HEADER_SIZE;
+    if (content_type)
+    {
+        len += sprintf((char *) buffer + len, "%s: %s" AXIS2_CRLF,
+                       AXIS2_TCP_FRAME_CONTENT_TYPE, content_type);
+    }
+    if (action)
+    {
+        len += sprintf((char *) buffer + len, "%s: %s" AXIS2_CRLF,
+                       AXIS2_TCP_FRAME_ACTION, action);
+    }
+    if (coalesced)
+    {
+        memcpy(buffer + len, body, coalesced);
+        len += coalesced;
+    }
+
+    status = axis2_tcp_frame_write_fully(env, stream, buffer, len);
+    if (AXIS2_SUCCESS == status && body_len > coalesced)
+    {
+        status = axis2_tcp_frame_write_fully(env, stream, body, body_len);
+    }
+    AXIS2_FREE(env->allocator, buffer);
+
+    if (AXIS2_SUCCESS != status)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_SOCKET_ERROR, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "Writing TCP frame failed");
+    }
+    return status;
+}
+
+AXIS2_EXTERN void AXIS2_CALL
+axis2_tcp_frame_free(
+    axis2_tcp_frame_t * frame,
+    const axutil_env_t * env)
+{
+    if (!frame)
+    {
+        return;
+    }
+    if (frame->content_type)
+    {
+        AXIS2_FREE(env->allocator, frame->content_type);
+    }
+    if (frame->action)
+    {
+        AXIS2_FREE(env->allocator, frame->action);
+    }
+    if (frame->body)
+    {
+        AXIS2_FREE(env->allocator, frame->body);
+    }
+    AXIS2_FREE(env->allocator, frame);
+}
@@ -774,6 +774,7 @@ axis2_core_utils_get_rest_op_with_method_and_location(axis2_svc_t *svc,
     axis2_char_t *local_url = NULL;
 
     axis2_op_t *op = NULL;
+    axis2_core_utils_rest_trie_t *trie = NULL;
     
     int key_len = 0;
 
@@ -781,58 +782,101 @@ axis2_core_utils_get_rest_op_with_method_and_location(axis2_svc_t *svc,
                     "Checking for operation using "
                     "REST HTTP Location fragment : %s", location);
 
-    /* we are creating a dup of the location */
-    local_url = (axis2_char_t*)axutil_strdup(env, location);
-    if(!local_url) {
-       AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
-       AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
-                "No memory. Cannot create the live rest mapping url");
-       return NULL;
-    }
-    
-    /* checking the existence of the addition parameters
-       after the question mark '?' */
-    addition_params_str = strchr(local_url, '?');
-    if(addition_params_str)
-    {
-        *addition_params_str = '\0';
-        addition_params_str ++;
-    }
-    
-    /* if the first character is '/' ignore that */
-    if(*local_url == '/')
+    trie = axis2_svc_get_rest_trie(svc, env);
+    if(trie)
     {
-        adjusted_local_url = local_url + 1;
+        axis2_core_utils_rest_capture_t captures[AXIS2_CORE_UTILS_REST_MAX_CAPTURES];
+        int n_captures = 0;
+        int i = 0;
+
+        op = axis2_core_utils_rest_trie_match(trie, env, method, location, captures,
+            AXIS2_CORE_UTILS_REST_MAX_CAPTURES, &n_captures);
+        if(!op)
+        {
+            AXIS2_ERROR_SET(env->error, AXIS2_ERROR_INVALID_URL_FORMAT, AXIS2_FAILURE);
+            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                "REST maping structure is NULL for the accessed URL");
+            return NULL;
+        }
+        for(i = 0; i < n_captures; i++)
+        {
+            axutil_array_list_add(param_keys, env,
+                axutil_strdup(env, captures[i].name));
+            axutil_array_list_add(param_values, env,
+                axutil_strmemdup(captures[i].value, captures[i].value_len, env));
+        }
+
+        /* only the query part is needed further on */
+        addition_params_str = strchr(location, '?');
+        if(!addition_params_str)
+        {
+            return op;
+        }
+        local_url = axutil_strdup(env, addition_params_str + 1);
+        if(!local_url)
+        {
+            AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                "No memory. Cannot create the live rest mapping url");
+            return NULL;
+        }
+        addition_params_str = local_url;
     }
     else
     {
-        adjusted_local_url = local_url;
-    }
+        /* the rest map was filled in directly, match it level by level */
+        local_url = (axis2_char_t*)axutil_strdup(env, location);
+        if(!local_url) {
+           AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+           AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                    "No memory. Cannot create the live rest mapping url");
+           return NULL;
+        }
     
-    /* now create the mapping url */
-    key_len = axutil_strlen(method) + axutil_strlen(adjusted_local_url) + 2;
+        /* checking the existence of the addition parameters
+           after the question mark '?' */
+        addition_params_str = strchr(local_url, '?');
+        if(addition_params_str)
+        {
+            *addition_params_str = '\0';
+            addition_params_str ++;
+        }
     
-    live_mapping_url = (axis2_char_t *) (AXIS2_MALLOC (env->allocator,
-                                              sizeof (axis2_char_t) * key_len));
+        /* if the first character is '/' ignore that */
+        if(*local_url == '/')
+        {
+            adjusted_local_url = local_url + 1;
+        }
+        else
+        {
+            adjusted_local_url = local_url;
+        }
     
-    if(!live_mapping_url)
-    {
-        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
-        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
-                "No memory. Cannot create the live rest mapping url");
-        AXIS2_FREE(env->allocator, local_url);
-        return NULL;
-    }
+        /* now create the mapping url */
+        key_len = axutil_strlen(method) + axutil_strlen(adjusted_local_url) + 2;
+    
+        live_mapping_url = (axis2_char_t *) (AXIS2_MALLOC (env->allocator,
+                                                  sizeof (axis2_char_t) * key_len));
+    
+        if(!live_mapping_url)
+        {
+            AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                    "No memory. Cannot create the live rest mapping url");
+            AXIS2_FREE(env->allocator, local_url);
+            return NULL;
+        }
 
-    sprintf(live_mapping_url, "%s:%s", method, adjusted_local_url);
+        sprintf(live_mapping_url, "%s:%s", method, adjusted_local_url);
 
 
-    op = axis2_core_utils_infer_op_from_parent_rest_map(
-                env,
-                axis2_svc_get_rest_map(svc, env),
-                live_mapping_url,
-                param_keys,
-                param_values);
+        op = axis2_core_utils_infer_op_from_parent_rest_map(
+                    env,
+                    axis2_svc_get_rest_map(svc, env),
+                    live_mapping_url,
+                    param_keys,
+                    param_values);
+    }
     
     
     if (op)
@@ -1667,3 +1711,580 @@ axis2_core_utils_match_url_component_with_pattern(const axutil_env_t *env,
 
     return status;
 }
+
+/* one part of a segment template, a constant or a parameter name */
+typedef struct axis2_core_utils_rest_part
+{
+    axis2_char_t *text;
+    int len;
+    axis2_bool_t is_param;
+} axis2_core_utils_rest_part_t;
+
+typedef struct axis2_core_utils_rest_node
+{
+    /* the segment as written in the template */
+    axis2_char_t *segment;
+    int segment_len;
+
+    /* parsed template of a segment holding parameters, NULL for constants */
+    axis2_core_utils_rest_part_t *parts;
+    int n_parts;
+
+    /* operation mapped to a location ending at this segment */
+    axis2_op_t *op_desc;
+
+    /* constant children sorted by segment, parameter children in order */
+    axutil_array_list_t *consts;
+    axutil_array_list_t *params;
+} axis2_core_utils_rest_node_t;
+
+struct axis2_core_utils_rest_trie
+{
+    /* method => root node */
+    axutil_hash_t *methods;
+};
+
+static int
+axis2_core_utils_rest_compare(
+    const axis2_char_t *s1,
+    int len1,
+    const axis2_char_t *s2,
+    int len2)
+{
+    int ret = memcmp(s1, s2, len1 < len2 ? len1 : len2);
+    if(ret)
+    {
+        return ret;
+    }
+    return len1 - len2;
+}
+
+/* binary search of the constant children, returns the index of the match or
+   -(insert position) - 1 */
+static int
+axis2_core_utils_rest_find_const(
+    const axutil_env_t *env,
+    const axis2_core_utils_rest_node_t *node,
+    const axis2_char_t *segment,
+    int len)
+{
+    int low = 0;
+    int high = 0;
+
+    if(!node->consts)
+    {
+        return -1;
+    }
+    high = axutil_array_list_size(node->consts, env) - 1;
+    while(low <= high)
+    {
+        int mid = (low + high) / 2;
+        axis2_core_utils_rest_node_t *child = axutil_array_list_get(node->consts, env, mid);
+        int ret = axis2_core_utils_rest_compare(child->segment, child->segment_len,
+            segment, len);
+        if(ret < 0)
+        {
+            low = mid + 1;
+        }
+        else if(ret > 0)
+        {
+            high = mid - 1;
+        }
+        else
+        {
+            return mid;
+        }
+    }
+    return -low - 1;
+}
+
+static void
+axis2_core_utils_rest_node_free(
+    axis2_core_utils_rest_node_t *node,
+    const axutil_env_t *env)
+{
+    int i = 0;
+
+    if(node->consts)
+    {
+        for(i = 0; i < axutil_array_list_size(node->consts, env); i++)
+        {
+            axis2_core_utils_rest_node_free(axutil_array_list_get(node->consts, env, i), env);
+        }
+        axutil_array_list_free(node->consts, env);
+    }
+    if(node->params)
+    {
+        for(i = 0; i < axutil_array_list_size(node->params, env); i++)
+        {
+            axis2_core_utils_rest_node_free(axutil_array_list_get(node->params, env, i), env);
+        }
+        axutil_array_list_free(node->params, env);
+    }
+    if(node->parts)
+    {
+        for(i = 0; i < node->n_parts; i++)
+        {
+            AXIS2_FREE(env->allocator, node->parts[i].text);
+        }
+        AXIS2_FREE(env->allocator, node->parts);
+    }
+    if(node->segment)
+    {
+        AXIS2_FREE(env->allocator, node->segment);
+    }
+    AXIS2_FREE(env->allocator, node);
+}
+
+static axis2_core_utils_rest_node_t *
+axis2_core_utils_rest_node_create(
+    const axutil_env_t *env,
+    const axis2_char_t *segment,
+    int len)
+{
+    axis2_core_utils_rest_node_t *node = NULL;
+
+    node = AXIS2_MALLOC(env->allocator, sizeof(axis2_core_utils_rest_node_t));
+    if(!node)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+            "No memory. Cannot create REST routing node");
+        return NULL;
+    }
+    memset(node, 0, sizeof(axis2_core_utils_rest_node_t));
+    node->segment = axutil_strmemdup(segment, len, env);
+    node->segment_len = len;
+    if(!node->segment)
+    {
+        AXIS2_FREE(env->allocator, node);
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+            "No memory. Cannot create REST routing node");
+        return NULL;
+    }
+    return node;
+}
+
+/* parses a segment such as "{name}.{ext}" into its parts */
+static axis2_status_t
+axis2_core_utils_rest_compile_segment(
+    const axutil_env_t *env,
+    axis2_core_utils_rest_node_t *node)
+{
+    const axis2_char_t *c = node->segment;
+    const axis2_char_t *end = node->segment + node->segment_len;
+    int n = 0;
+
+    for(c = node->segment; c < end; c++)
+    {
+        if(*c == '{' || *c == '}')
+        {
+            n++;
+        }
+    }
+    /* every parameter may be followed by a constant, and one may lead */
+    node->parts = AXIS2_MALLOC(env->allocator,
+        sizeof(axis2_core_utils_rest_part_t) * (n + 1));
+    if(!node->parts)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+            "No memory. Cannot create REST routing node");
+        return AXIS2_FAILURE;
+    }
+
+    c = node->segment;
+    while(c < end)
+    {
+        const axis2_char_t *part_end = NULL;
+        axis2_core_utils_rest_part_t *part = &node->parts[node->n_parts];
+
+        if(*c == '{')
+        {
+            part_end = c + 1;
+            while(part_end < end && *part_end != '}' && *part_end != '{')
+            {
+                part_end++;
+            }
+            if(part_end == end || *part_end == '{' || part_end == c + 1 ||
+                (part_end + 1 < end && *(part_end + 1) == '{'))
+            {
+                AXIS2_ERROR_SET(env->error, AXIS2_ERROR_INVALID_URL_FORMAT, AXIS2_FAILURE);
+                AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                    "Invalid URL Format in %s, parameters must be named and "
+                    "separated by a constant", node->segment);
+                return AXIS2_FAILURE;
+            }
+            part->is_param = AXIS2_TRUE;
+            part->len = (int)(part_end - c - 1);
+            part->text = axutil_strmemdup(c + 1, part->len, env);
+            c = part_end + 1;
+        }
+        else
+        {
+            part_end = c;
+            while(part_end < end && *part_end != '{')
+            {
+                if(*part_end == '}')
+                {
+                    AXIS2_ERROR_SET(env->error, AXIS2_ERROR_INVALID_URL_FORMAT, AXIS2_FAILURE);
+                    AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                        "Invalid URL Format in %s, unbalanced brackets", node->segment);
+                    return AXIS2_FAILURE;
+                }
+                part_end++;
+            }
+            part->is_param = AXIS2_FALSE;
+            part->len = (int)(part_end - c);
+            part->text = axutil_strmemdup(c, part->len, env);
+            c = part_end;
+        }
+        if(!part->text)
+        {
+            AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                "No memory. Cannot create REST routing node");
+            return AXIS2_FAILURE;
+        }
+        node->n_parts++;
+    }
+    return AXIS2_SUCCESS;
+}
+
+/* finds or creates the child of node for a template segment */
+static axis2_core_utils_rest_node_t *
+axis2_core_utils_rest_node_add_child(
+    axis2_core_utils_rest_node_t *node,
+    const axutil_env_t *env,
+    const axis2_char_t *segment,
+    int len)
+{
+    axis2_core_utils_rest_node_t *child = NULL;
+    axutil_array_list_t **children = NULL;
+    int index = 0;
+    int i = 0;
+
+    if(memchr(segment, '{', len) || memchr(segment, '}', len))
+    {
+        children = &node->params;
+        for(i = 0; node->params && i < axutil_array_list_size(node->params, env); i++)
+        {
+            child = axutil_array_list_get(node->params, env, i);
+            if(!axis2_core_utils_rest_compare(child->segment, child->segment_len,
+                segment, len))
+            {
+                return child;
+            }
+        }
+        index = i;
+    }
+    else
+    {
+        children = &node->consts;
+        index = axis2_core_utils_rest_find_const(env, node, segment, len);
+        if(index >= 0)
+        {
+            return axutil_array_list_get(node->consts, env, index);
+        }
+        index = -index - 1;
+    }
+
+    if(!*children)
+    {
+        *children = axutil_array_list_create(env, 4);
+        if(!*children)
+        {
+            AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                "No memory. Cannot create REST routing node");
+            return NULL;
+        }
+    }
+    child = axis2_core_utils_rest_node_create(env, segment, len);
+    if(!child)
+    {
+        return NULL;
+    }
+    if(children == &node->params &&
+        axis2_core_utils_rest_compile_segment(env, child) != AXIS2_SUCCESS)
+    {
+        axis2_core_utils_rest_node_free(child, env);
+        return NULL;
+    }
+    axutil_array_list_add_at(*children, env, index, child);
+    return child;
+}
+
+AXIS2_EXTERN axis2_core_utils_rest_trie_t *AXIS2_CALL
+axis2_core_utils_rest_trie_create(
+    const axutil_env_t *env)
+{
+    axis2_core_utils_rest_trie_t *trie = NULL;
+
+    trie = AXIS2_MALLOC(env->allocator, sizeof(axis2_core_utils_rest_trie_t));
+    if(!trie)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+            "No memory. Cannot create REST routing trie");
+        return NULL;
+    }
+    trie->methods = axutil_hash_make(env);
+    if(!trie->methods)
+    {
+        AXIS2_FREE(env->allocator, trie);
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+            "No memory. Cannot create REST routing trie");
+        return NULL;
+    }
+    return trie;
+}
+
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axis2_core_utils_rest_trie_add(
+    axis2_core_utils_rest_trie_t *trie,
+    const axutil_env_t *env,
+    const axis2_char_t *method,
+    const axis2_char_t *location,
+    axis2_op_t *op_desc)
+{
+    axis2_core_utils_rest_node_t *node = NULL;
+    const axis2_char_t *segment = NULL;
+    const axis2_char_t *c = NULL;
+    int n_params = 0;
+
+    AXIS2_PARAM_CHECK(env->error, method, AXIS2_FAILURE);
+    AXIS2_PARAM_CHECK(env->error, location, AXIS2_FAILURE);
+
+    for(c = location; *c != '\0'; c++)
+    {
+        if(*c == '{')
+        {
+            n_params++;
+        }
+    }
+    if(n_params > AXIS2_CORE_UTILS_REST_MAX_CAPTURES)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_INVALID_URL_FORMAT, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+            "Invalid URL Format in %s, more than %d parameters", location,
+            AXIS2_CORE_UTILS_REST_MAX_CAPTURES);
+        return AXIS2_FAILURE;
+    }
+
+    node = axutil_hash_get(trie->methods, method, AXIS2_HASH_KEY_STRING);
+    if(!node)
+    {
+        node = axis2_core_utils_rest_node_create(env, method, axutil_strlen(method));
+        if(!node)
+        {
+            return AXIS2_FAILURE;
+        }
+        axutil_hash_set(trie->methods, node->segment, AXIS2_HASH_KEY_STRING, node);
+    }
+
+    segment = location;
+    do
+    {
+        c = segment;
+        while(*c != '\0' && *c != '/')
+        {
+            c++;
+        }
+        if(c == segment && (*c == '/' || segment != location))
+        {
+            AXIS2_ERROR_SET(env->error, AXIS2_ERROR_INVALID_URL_FORMAT, AXIS2_FAILURE);
+            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                "Invalid URL Format in %s, empty segment", location);
+            return AXIS2_FAILURE;
+        }
+        node = axis2_core_utils_rest_node_add_child(node, env, segment, (int)(c - segment));
+        if(!node)
+        {
+            return AXIS2_FAILURE;
+        }
+        segment = c + 1;
+    }
+    while(*c != '\0');
+
+    if(node->op_desc)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_DUPLICATE_URL_REST_MAPPING, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "Duplicate URL Mapping found");
+        return AXIS2_FAILURE;
+    }
+    node->op_desc = op_desc;
+    return AXIS2_SUCCESS;
+}
+
+/* matches one path segment with a parameter template. A parameter followed
+   by a constant ends where the constant first appears. */
+static axis2_bool_t
+axis2_core_utils_rest_match_segment(
+    const axis2_core_utils_rest_node_t *node,
+    const axis2_char_t *start,
+    const axis2_char_t *end,
+    axis2_core_utils_rest_capture_t *captures,
+    int max_captures,
+    int *n_captures)
+{
+    const axis2_char_t *pos = start;
+    const axis2_core_utils_rest_part_t *param = NULL;
+    int i = 0;
+
+    for(i = 0; i < node->n_parts; i++)
+    {
+        const axis2_core_utils_rest_part_t *part = &node->parts[i];
+
+        if(part->is_param)
+        {
+            param = part;
+            continue;
+        }
+        if(param)
+        {
+            const axis2_char_t *found = pos;
+            while(end - found >= part->len && memcmp(found, part->text, part->len))
+            {
+                found++;
+            }
+            if(end - found < part->len || *n_captures >= max_captures)
+            {
+                return AXIS2_FALSE;
+            }
+            captures[*n_captures].name = param->text;
+            captures[*n_captures].value = pos;
+            captures[*n_captures].value_len = (int)(found - pos);
+            (*n_captures)++;
+            pos = found + part->len;
+            param = NULL;
+        }
+        else
+        {
+            if(end - pos < part->len || memcmp(pos, part->text, part->len))
+            {
+                return AXIS2_FALSE;
+            }
+            pos += part->len;
+        }
+    }
+
+    if(param)
+    {
+        if(*n_captures >= max_captures)
+        {
+            return AXIS2_FALSE;
+        }
+        captures[*n_captures].name = param->text;
+        captures[*n_captures].value = pos;
+        captures[*n_captures].value_len = (int)(end - pos);
+        (*n_captures)++;
+        return AXIS2_TRUE;
+    }
+    return pos == end;
+}
+
+/* matches the path starting at segment against the children of node;
+   constants take precedence over parameters */
+static axis2_op_t *
+axis2_core_utils_rest_match_node(
+    const axutil_env_t *env,
+    const axis2_core_utils_rest_node_t *node,
+    const axis2_char_t *segment,
+    axis2_core_utils_rest_capture_t *captures,
+    int max_captures,
+    int *n_captures)
+{
+    const axis2_char_t *end = segment;
+    axis2_core_utils_rest_node_t *child = NULL;
+    axis2_op_t *op_desc = NULL;
+    axis2_bool_t last = AXIS2_FALSE;
+    int index = 0;
+    int i = 0;
+
+    while(*end != '\0' && *end != '/' && *end != '?')
+    {
+        end++;
+    }
+    last = (*end != '/');
+
+    index = axis2_core_utils_rest_find_const(env, node, segment, (int)(end - segment));
+    if(index >= 0)
+    {
+        child = axutil_array_list_get(node->consts, env, index);
+        op_desc = last ? child->op_desc : axis2_core_utils_rest_match_node(env, child,
+            end + 1, captures, max_captures, n_captures);
+        if(op_desc)
+        {
+            return op_desc;
+        }
+    }
+
+    for(i = 0; node->params && i < axutil_array_list_size(node->params, env); i++)
+    {
+        int saved = *n_captures;
+
+        child = axutil_array_list_get(node->params, env, i);
+        if(axis2_core_utils_rest_match_segment(child, segment, end, captures,
+            max_captures, n_captures))
+        {
+            op_desc = last ? child->op_desc : axis2_core_utils_rest_match_node(env, child,
+                end + 1, captures, max_captures, n_captures);
+            if(op_desc)
+            {
+                return op_desc;
+            }
+        }
+        *n_captures = saved;
+    }
+    return NULL;
+}
+
+AXIS2_EXTERN axis2_op_t *AXIS2_CALL
+axis2_core_utils_rest_trie_match(
+    const axis2_core_utils_rest_trie_t *trie,
+    const axutil_env_t *env,
+    const axis2_char_t *method,
+    const axis2_char_t *path,
+    axis2_core_utils_rest_capture_t *captures,
+    int max_captures,
+    int *n_captures)
+{
+    axis2_core_utils_rest_node_t *root = NULL;
+
+    *n_captures = 0;
+    if(!method || !path)
+    {
+        return NULL;
+    }
+    root = axutil_hash_get(trie->methods, method, AXIS2_HASH_KEY_STRING);
+    if(!root)
+    {
+        return NULL;
+    }
+    if(*path == '/')
+    {
+        path++;
+    }
+    return axis2_core_utils_rest_match_node(env, root, path, captures, max_captures,
+        n_captures);
+}
+
+AXIS2_EXTERN void AXIS2_CALL
+axis2_core_utils_rest_trie_free(
+    axis2_core_utils_rest_trie_t *trie,
+    const axutil_env_t *env)
+{
+    axutil_hash_index_t *hi = NULL;
+    void *val = NULL;
+
+    for(hi = axutil_hash_first(trie->methods, env); hi; hi = axutil_hash_next(env, hi))
+    {
+        axutil_hash_this(hi, NULL, NULL, &val);
+        axis2_core_utils_rest_node_free(val, env);
+    }
+    axutil_hash_free(trie->methods, env);
+    AXIS2_FREE(env->allocator, trie);
+}
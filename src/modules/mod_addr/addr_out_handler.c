@@ -136,7 +136,7 @@ axis2_addr_out_handler_invoke(
     }
     
     ctx = axis2_msg_ctx_get_base(msg_ctx, env);
-    property = axis2_ctx_get_property(ctx, env, AXIS2_WSA_VERSION);
+    property = axis2_ctx_get_property_at(ctx, env, AXIS2_CTX_SLOT_WSA_VERSION);
 
     if (property)
     {
@@ -173,7 +173,7 @@ axis2_addr_out_handler_invoke(
             axis2_ctx_t *in_ctx = NULL;
             in_ctx = axis2_msg_ctx_get_base(in_msg_ctx, env);
 
-            property = axis2_ctx_get_property(in_ctx, env, AXIS2_WSA_VERSION);
+            property = axis2_ctx_get_property_at(in_ctx, env, AXIS2_CTX_SLOT_WSA_VERSION);
             if (property)
             {
                 addr_ns = axutil_property_get_value(property, env);
@@ -20,6 +20,7 @@
 #include <axutil_array_list.h>
 #include <axiom_soap_const.h>
 #include <axiom_soap_envelope.h>
+#include <axiom_soap_body.h>
 #include <axiom_soap_header.h>
 #include <axiom_soap_header_block.h>
 #include <axis2_op.h>
@@ -27,6 +28,7 @@
 #include <axis2_conf_ctx.h>
 #include <axis2_msg_info_headers.h>
 #include <axutil_property.h>
+#include "mod_log.h"
 
 axis2_status_t AXIS2_CALL axutil_log_in_handler_invoke(
     struct axis2_handler * handler,
@@ -61,27 +63,103 @@ axutil_log_in_handler_invoke(
 {
     axiom_soap_envelope_t *soap_envelope = NULL;
     axiom_node_t *ret_node = NULL;
+    int max_size = 0;
 
     AXIS2_ENV_CHECK(env, AXIS2_FAILURE);
     AXIS2_PARAM_CHECK(env->error, msg_ctx, AXIS2_FAILURE);
 
+    if (!axis2_mod_log_is_sampled(env, msg_ctx))
+    {
+        return AXIS2_SUCCESS;
+    }
+
     AXIS2_LOG_INFO(env->log, "Starting logging in handler .........");
 
+    max_size = axis2_mod_log_get_max_size(env, msg_ctx);
+    if (axis2_mod_log_is_tee(env, msg_ctx) &&
+        axis2_msg_ctx_get_property(msg_ctx, env, AXIS2_TRANSPORT_TEE_DATA))
+    {
+        /* The body may not have been read yet; the transport logs the bytes
+           it kept once the request has been read */
+        axis2_char_t tee_size[16];
+        axutil_property_t *property = NULL;
+
+        sprintf(tee_size, "%d", max_size > 0 ? max_size :
+                AXIS2_MOD_LOG_TEE_DEFAULT_SIZE);
+        property = axutil_property_create_with_args(env, AXIS2_SCOPE_REQUEST,
+                                                    AXIS2_TRUE, NULL,
+                                                    axutil_strdup(env,
+                                                                  tee_size));
+        axis2_msg_ctx_set_property(msg_ctx, env, AXIS2_TRANSPORT_TEE_LOG,
+                                   property);
+        return AXIS2_SUCCESS;
+    }
+
     soap_envelope = axis2_msg_ctx_get_soap_envelope(msg_ctx, env);
 
     if (soap_envelope)
     {
+        axiom_soap_body_t *soap_body = NULL;
+        axiom_node_t *body_node = NULL;
+
         /* ensure SOAP buider state is in sync */
-        axiom_soap_envelope_get_body(soap_envelope, env);
-        ret_node = axiom_soap_envelope_get_base_node(soap_envelope, env);
+        soap_body = axiom_soap_envelope_get_body(soap_envelope, env);
+        body_node = soap_body ?
+            axiom_soap_body_get_base_node(soap_body, env) : NULL;
+
+        if (body_node && !axiom_node_is_complete(body_node, env))
+        {
+            /* Serializing the envelope would build the whole body for the
+               log alone; the headers and the first body element do */
+            axiom_soap_header_t *soap_header = NULL;
+            axiom_node_t *first_node = NULL;
+            axis2_char_t *header_str = NULL;
+            axis2_char_t *localname = NULL;
 
-        if (ret_node)
+            /* Builds the body up to its first element, as a fault check
+               does anyway */
+            axiom_soap_body_has_fault(soap_body, env);
+            first_node = axiom_node_get_first_element(body_node, env);
+            if (first_node)
+            {
+                localname = axiom_element_get_localname((axiom_element_t *)
+                                                        axiom_node_get_data_element
+                                                        (first_node, env), env);
+            }
+            soap_header = axiom_soap_envelope_get_header(soap_envelope, env);
+            if (soap_header)
+            {
+                header_str =
+                    axiom_node_to_string(axiom_soap_header_get_base_node
+                                         (soap_header, env), env);
+            }
+            if (max_size > 0 && header_str &&
+                axutil_strlen(header_str) > max_size)
+            {
+                header_str[max_size] = '\0';
+            }
+            AXIS2_LOG_INFO(env->log,
+                           "Input message: %s, body not built, first body "
+                           "element %s", header_str ? header_str : "no headers",
+                           localname ? localname : "none");
+            if (header_str)
+            {
+                AXIS2_FREE(env->allocator, header_str);
+            }
+        }
+        else
         {
-            axis2_char_t *om_str = NULL;
-            om_str = axiom_node_to_string(ret_node, env);
-            if (om_str)
+            ret_node = axiom_soap_envelope_get_base_node(soap_envelope, env);
+            if (ret_node)
             {
-                AXIS2_LOG_INFO(env->log, "Input message: %s", om_str);
+                axis2_char_t *om_str = NULL;
+                om_str = axiom_node_to_string(ret_node, env);
+                if (om_str)
+                {
+                    axis2_mod_log_message(env, "Input message", om_str,
+                                          axutil_strlen(om_str), max_size);
+                    AXIS2_FREE(env->allocator, om_str);
+                }
             }
         }
     }
@@ -27,6 +27,7 @@
 #include <axis2_conf_ctx.h>
 #include <axis2_msg_info_headers.h>
 #include <axutil_property.h>
+#include "mod_log.h"
 
 axis2_status_t AXIS2_CALL axutil_log_out_handler_invoke(
     struct axis2_handler * handler,
@@ -61,12 +62,36 @@ axutil_log_out_handler_invoke(
 {
     axiom_soap_envelope_t *soap_envelope = NULL;
     axiom_node_t *ret_node = NULL;
+    int max_size = 0;
 
     AXIS2_ENV_CHECK(env, AXIS2_FAILURE);
     AXIS2_PARAM_CHECK(env->error, msg_ctx, AXIS2_FAILURE);
 
+    if (!axis2_mod_log_is_sampled(env, msg_ctx))
+    {
+        return AXIS2_SUCCESS;
+    }
+
     AXIS2_LOG_INFO(env->log, "Starting logging out handler .........");
 
+    max_size = axis2_mod_log_get_max_size(env, msg_ctx);
+    if (axis2_mod_log_is_tee(env, msg_ctx))
+    {
+        /* The transport logs the bytes as it writes them */
+        axis2_char_t tee_size[16];
+        axutil_property_t *property = NULL;
+
+        sprintf(tee_size, "%d", max_size > 0 ? max_size :
+                AXIS2_MOD_LOG_TEE_DEFAULT_SIZE);
+        property = axutil_property_create_with_args(env, AXIS2_SCOPE_REQUEST,
+                                                    AXIS2_TRUE, NULL,
+                                                    axutil_strdup(env,
+                                                                  tee_size));
+        axis2_msg_ctx_set_property(msg_ctx, env, AXIS2_TRANSPORT_TEE_OUT,
+                                   property);
+        return AXIS2_SUCCESS;
+    }
+
     soap_envelope = axis2_msg_ctx_get_soap_envelope(msg_ctx, env);
 
     if (soap_envelope)
@@ -79,7 +104,9 @@ axutil_log_out_handler_invoke(
             om_str = axiom_node_to_string(ret_node, env);
             if (om_str)
             {
-                AXIS2_LOG_INFO(env->log, "Output message: %s", om_str);
+                axis2_mod_log_message(env, "Output message", om_str,
+                                      axutil_strlen(om_str), max_size);
+                AXIS2_FREE(env->allocator, om_str);
             }
         }
     }
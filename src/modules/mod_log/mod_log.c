@@ -17,9 +17,38 @@
  */
 #include <axis2_module.h>
 #include <axis2_conf_ctx.h>
+#include <axis2_op_ctx.h>
+#include <axis2_svc.h>
+#include <axutil_thread.h>
+#include <stdlib.h>
 
 #include "mod_log.h"
 
+/* Conf context property holding the axis2_mod_log_state_t */
+#define AXIS2_MOD_LOG_STATE "axis2_mod_log_state"
+
+/* Op context property recording whether the exchange is logged, so that
+   the in and out messages of an exchange are sampled together */
+#define AXIS2_MOD_LOG_SAMPLED "axis2_mod_log_sampled"
+
+typedef struct axis2_mod_log_counter
+{
+    int count;
+} axis2_mod_log_counter_t;
+
+typedef struct axis2_mod_log_state
+{
+    /* defaults from module.xml */
+    int sample_rate;
+    int max_size;
+    axis2_bool_t tee;
+
+    /* axis2_mod_log_counter_t of exchanges per "service/operation" name, so
+       that an operation keeps its count when its service is reloaded */
+    axutil_hash_t *counters;
+    axutil_thread_mutex_t *mutex;
+} axis2_mod_log_state_t;
+
 axis2_status_t AXIS2_CALL axis2_mod_log_shutdown(
     axis2_module_t * module,
     const axutil_env_t * env);
@@ -56,6 +85,57 @@ axis2_mod_log_create(
     return module;
 }
 
+static void AXIS2_CALL
+axis2_mod_log_state_free(
+    void *data,
+    const axutil_env_t * env)
+{
+    axis2_mod_log_state_t *state = (axis2_mod_log_state_t *) data;
+
+    if (state->counters)
+    {
+        axutil_hash_index_t *hi = NULL;
+        const void *key = NULL;
+        void *val = NULL;
+
+        for (hi = axutil_hash_first(state->counters, env); hi;
+             hi = axutil_hash_next(env, hi))
+        {
+            axutil_hash_this(hi, &key, NULL, &val);
+            AXIS2_FREE(env->allocator, (void *) key);
+            AXIS2_FREE(env->allocator, val);
+        }
+        axutil_hash_free(state->counters, env);
+    }
+    if (state->mutex)
+    {
+        axutil_thread_mutex_destroy(state->mutex);
+    }
+    AXIS2_FREE(env->allocator, state);
+}
+
+static int
+axis2_mod_log_get_module_param(
+    const axutil_env_t * env,
+    axis2_module_desc_t * module_desc,
+    const axis2_char_t * name,
+    int default_value)
+{
+    axutil_param_t *param = axis2_module_desc_get_param(module_desc, env, name);
+    axis2_char_t *value = param ?
+        (axis2_char_t *) axutil_param_get_value(param, env) : NULL;
+
+    if (!value)
+    {
+        return default_value;
+    }
+    if (!axutil_strcmp(value, AXIS2_VALUE_TRUE))
+    {
+        return AXIS2_TRUE;
+    }
+    return atoi(value);
+}
+
 axis2_status_t AXIS2_CALL
 axis2_mod_log_init(
     axis2_module_t * module,
@@ -63,10 +143,225 @@ axis2_mod_log_init(
     axis2_conf_ctx_t * conf_ctx,
     axis2_module_desc_t * module_desc)
 {
-    /* Any initialization stuff related to this module can be here */
+    axis2_mod_log_state_t *state = NULL;
+    axutil_property_t *property = NULL;
+
+    if (axis2_conf_ctx_get_property(conf_ctx, env, AXIS2_MOD_LOG_STATE))
+    {
+        return AXIS2_SUCCESS;
+    }
+
+    state = AXIS2_MALLOC(env->allocator, sizeof(axis2_mod_log_state_t));
+    if (!state)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+    state->sample_rate = axis2_mod_log_get_module_param(env, module_desc,
+                                                        AXIS2_MOD_LOG_SAMPLE_RATE,
+                                                        1);
+    state->max_size = axis2_mod_log_get_module_param(env, module_desc,
+                                                     AXIS2_MOD_LOG_MAX_SIZE, 0);
+    state->tee = axis2_mod_log_get_module_param(env, module_desc,
+                                                AXIS2_MOD_LOG_TEE,
+                                                AXIS2_FALSE) == AXIS2_TRUE;
+    state->counters = axutil_hash_make(env);
+    state->mutex = axutil_thread_mutex_create(env->allocator,
+                                              AXIS2_THREAD_MUTEX_DEFAULT);
+    if (!state->counters || !state->mutex)
+    {
+        axis2_mod_log_state_free(state, env);
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+    property = axutil_property_create_with_args(env, AXIS2_SCOPE_APPLICATION,
+                                                AXIS2_TRUE,
+                                                axis2_mod_log_state_free,
+                                                state);
+    if (!property)
+    {
+        axis2_mod_log_state_free(state, env);
+        return AXIS2_FAILURE;
+    }
+    axis2_conf_ctx_set_property(conf_ctx, env, AXIS2_MOD_LOG_STATE, property);
+
+    if (state->tee)
+    {
+        /* Requests are read before they are dispatched, so the transport
+           keeps the first bytes of every request */
+        axis2_char_t tee_size[16];
+
+        sprintf(tee_size, "%d", state->max_size > 0 ? state->max_size :
+                AXIS2_MOD_LOG_TEE_DEFAULT_SIZE);
+        property = axutil_property_create_with_args(env,
+                                                    AXIS2_SCOPE_APPLICATION,
+                                                    AXIS2_TRUE, NULL,
+                                                    axutil_strdup(env,
+                                                                  tee_size));
+        axis2_conf_ctx_set_property(conf_ctx, env, AXIS2_TRANSPORT_TEE_IN,
+                                    property);
+    }
     return AXIS2_SUCCESS;
 }
 
+static axis2_mod_log_state_t *
+axis2_mod_log_get_state(
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx)
+{
+    axis2_conf_ctx_t *conf_ctx = axis2_msg_ctx_get_conf_ctx(msg_ctx, env);
+    axutil_property_t *property = conf_ctx ?
+        axis2_conf_ctx_get_property(conf_ctx, env, AXIS2_MOD_LOG_STATE) : NULL;
+
+    return property ?
+        (axis2_mod_log_state_t *) axutil_property_get_value(property, env) :
+        NULL;
+}
+
+/* Gets a parameter of the operation, service or configuration of msg_ctx,
+   or the default of the module */
+static int
+axis2_mod_log_get_param(
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx,
+    const axis2_char_t * name,
+    int default_value)
+{
+    axutil_param_t *param = axis2_msg_ctx_get_parameter(msg_ctx, env, name);
+    axis2_char_t *value = param ?
+        (axis2_char_t *) axutil_param_get_value(param, env) : NULL;
+
+    if (!value)
+    {
+        return default_value;
+    }
+    if (!axutil_strcmp(value, AXIS2_VALUE_TRUE))
+    {
+        return AXIS2_TRUE;
+    }
+    return atoi(value);
+}
+
+axis2_bool_t
+axis2_mod_log_is_sampled(
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx)
+{
+    axis2_mod_log_state_t *state = axis2_mod_log_get_state(env, msg_ctx);
+    axis2_op_ctx_t *op_ctx = axis2_msg_ctx_get_op_ctx(msg_ctx, env);
+    axis2_op_t *op = axis2_msg_ctx_get_op(msg_ctx, env);
+    axis2_svc_t *svc = axis2_msg_ctx_get_svc(msg_ctx, env);
+    const axutil_qname_t *op_qname = NULL;
+    axutil_property_t *property = NULL;
+    axis2_bool_t sampled = AXIS2_TRUE;
+    int sample_rate = 1;
+
+    if (!state)
+    {
+        return AXIS2_TRUE;
+    }
+    property = axis2_msg_ctx_get_property(msg_ctx, env, AXIS2_MOD_LOG_SAMPLED);
+    if (property)
+    {
+        return axutil_property_get_value(property, env) ?
+            AXIS2_TRUE : AXIS2_FALSE;
+    }
+
+    sample_rate = axis2_mod_log_get_param(env, msg_ctx,
+                                          AXIS2_MOD_LOG_SAMPLE_RATE,
+                                          state->sample_rate);
+    if (op)
+    {
+        op_qname = axis2_op_get_qname(op, env);
+    }
+    if (sample_rate > 1 && op_qname)
+    {
+        axis2_mod_log_counter_t *counter = NULL;
+        axis2_char_t *key = NULL;
+
+        key = axutil_strcat(env, svc ? axis2_svc_get_name(svc, env) : "", "/",
+                            axutil_qname_get_localpart(op_qname, env), NULL);
+        axutil_thread_mutex_lock(state->mutex);
+        counter = key ? axutil_hash_get(state->counters, key,
+                                        AXIS2_HASH_KEY_STRING) : NULL;
+        if (!counter && key)
+        {
+            counter = AXIS2_MALLOC(env->allocator,
+                                   sizeof(axis2_mod_log_counter_t));
+            if (counter)
+            {
+                counter->count = 0;
+                axutil_hash_set(state->counters, key, AXIS2_HASH_KEY_STRING,
+                                counter);
+                key = NULL;
+            }
+        }
+        if (counter)
+        {
+            sampled = counter->count++ % sample_rate == 0;
+        }
+        axutil_thread_mutex_unlock(state->mutex);
+        if (key)
+        {
+            AXIS2_FREE(env->allocator, key);
+        }
+    }
+
+    if (op_ctx)
+    {
+        /* The value is only tested for NULL */
+        property = axutil_property_create_with_args(env, AXIS2_SCOPE_REQUEST,
+                                                    AXIS2_FALSE, NULL,
+                                                    sampled ? (void *) state :
+                                                    NULL);
+        axis2_ctx_set_property(axis2_op_ctx_get_base(op_ctx, env), env,
+                               AXIS2_MOD_LOG_SAMPLED, property);
+    }
+    return sampled;
+}
+
+int
+axis2_mod_log_get_max_size(
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx)
+{
+    axis2_mod_log_state_t *state = axis2_mod_log_get_state(env, msg_ctx);
+
+    return axis2_mod_log_get_param(env, msg_ctx, AXIS2_MOD_LOG_MAX_SIZE,
+                                   state ? state->max_size : 0);
+}
+
+axis2_bool_t
+axis2_mod_log_is_tee(
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx)
+{
+    axis2_mod_log_state_t *state = axis2_mod_log_get_state(env, msg_ctx);
+
+    return axis2_mod_log_get_param(env, msg_ctx, AXIS2_MOD_LOG_TEE,
+                                   state ? state->tee : AXIS2_FALSE) ==
+        AXIS2_TRUE;
+}
+
+void
+axis2_mod_log_message(
+    const axutil_env_t * env,
+    const axis2_char_t * label,
+    const axis2_char_t * message,
+    int size,
+    int max_size)
+{
+    if (max_size > 0 && size > max_size)
+    {
+        AXIS2_LOG_INFO(env->log, "%s: %.*s ... (%d more bytes)", label,
+                       max_size, message, size - max_size);
+    }
+    else
+    {
+        AXIS2_LOG_INFO(env->log, "%s: %.*s", label, size, message);
+    }
+}
+
 axis2_status_t AXIS2_CALL
 axis2_mod_log_shutdown(
     axis2_module_t * module,
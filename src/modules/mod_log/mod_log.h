@@ -25,12 +25,59 @@
  */
 
 #include <axis2_handler.h>
+#include <axis2_msg_ctx.h>
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
+    /*
+     * Parameters of the module, given in module.xml and overridden for a
+     * service or an operation by parameters of the same name in
+     * services.xml:
+     * logSampleRate: log one in so many exchanges of an operation, counted
+     * by service and operation name
+     * logMaxSize: log no more than so many bytes of a message
+     * logTee: log the bytes the transport reads and writes instead of
+     * serializing the envelope, so that logging does not build the body.
+     * The bytes read are kept for every request once the module sets
+     * logTee to true, since the operation is not known while they are read.
+     */
+#define AXIS2_MOD_LOG_SAMPLE_RATE "logSampleRate"
+#define AXIS2_MOD_LOG_MAX_SIZE "logMaxSize"
+#define AXIS2_MOD_LOG_TEE "logTee"
+
+    /* Bytes kept by the transport for logTee when no logMaxSize is set */
+#define AXIS2_MOD_LOG_TEE_DEFAULT_SIZE 65536
+
+    /** Tells whether the exchange of msg_ctx is one sampled for logging */
+    axis2_bool_t
+    axis2_mod_log_is_sampled(
+        const axutil_env_t * env,
+        axis2_msg_ctx_t * msg_ctx);
+
+    /** Gets logMaxSize for msg_ctx, 0 for no limit */
+    int
+    axis2_mod_log_get_max_size(
+        const axutil_env_t * env,
+        axis2_msg_ctx_t * msg_ctx);
+
+    /** Gets logTee for msg_ctx */
+    axis2_bool_t
+    axis2_mod_log_is_tee(
+        const axutil_env_t * env,
+        axis2_msg_ctx_t * msg_ctx);
+
+    /** Logs a message, cut at max_size bytes unless max_size is 0 */
+    void
+    axis2_mod_log_message(
+        const axutil_env_t * env,
+        const axis2_char_t * label,
+        const axis2_char_t * message,
+        int size,
+        int max_size);
+
     AXIS2_EXTERN axis2_handler_t *AXIS2_CALL
     axutil_log_in_handler_create(
         const axutil_env_t * env,
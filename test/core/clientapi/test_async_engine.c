@@ -0,0 +1,526 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <axutil_env.h>
+#include <axutil_string.h>
+#include <axutil_thread.h>
+#include <axiom.h>
+#include <axiom_soap.h>
+#include <axis2_callback.h>
+#include <axis2_options.h>
+#include <axis2_endpoint_ref.h>
+#include <axis2_svc_client.h>
+#include <axis2_async_engine.h>
+#include <platforms/axutil_platform_auto_sense.h>
+
+#define TEST_ENVELOPE \
+    "<soapenv:Envelope xmlns:soapenv=\"http://www.w3.org/2003/05/soap-envelope\">" \
+    "<soapenv:Body><t:result xmlns:t=\"urn:test\">%s</t:result></soapenv:Body>" \
+    "</soapenv:Envelope>"
+
+/* Steps the test server goes through, one request each */
+typedef struct test_step
+{
+    /* Response to write, NULL to leave the request unanswered until the
+       client gives up on the connection */
+    const char *response;
+    int close_after;
+} test_step_t;
+
+typedef struct test_server
+{
+    int listen_fd;
+    const test_step_t *steps;
+    int step_count;
+    int accepts;
+
+    /* Host header of the last request */
+    char host[128];
+} test_server_t;
+
+static int failures = 0;
+
+static volatile int call_errored = 0;
+static volatile int call_error = 0;
+static char call_result[64];
+
+static void
+check(
+    int condition,
+    const char *what)
+{
+    if (!condition)
+    {
+        printf("test_async_engine: %s FAILED\n", what);
+        failures++;
+    }
+}
+
+/* Reads a request up to the end of its body and records its Host header */
+static int
+test_server_read_request(
+    test_server_t * server,
+    int fd)
+{
+    char request[16384];
+    char *head_end = NULL;
+    char *header = NULL;
+    int len = 0;
+    int n = 0;
+    int content_length = 0;
+
+    while (!head_end)
+    {
+        n = (int) read(fd, request + len, sizeof(request) - 1 - len);
+        if (n <= 0)
+        {
+            return 0;
+        }
+        len += n;
+        request[len] = '\0';
+        head_end = strstr(request, "\r\n\r\n");
+    }
+
+    header = strstr(request, "\r\nContent-Length: ");
+    if (header && header < head_end)
+    {
+        content_length = atoi(header + 18);
+    }
+    header = strstr(request, "\r\nHost: ");
+    if (header && header < head_end)
+    {
+        n = (int) strcspn(header + 8, "\r");
+        if (n >= (int) sizeof(server->host))
+        {
+            n = sizeof(server->host) - 1;
+        }
+        memcpy(server->host, header + 8, n);
+        server->host[n] = '\0';
+    }
+
+    len -= (int) (head_end + 4 - request);
+    while (len < content_length)
+    {
+        n = (int) read(fd, request, sizeof(request));
+        if (n <= 0)
+        {
+            return 0;
+        }
+        len += n;
+    }
+    return 1;
+}
+
+static void *AXIS2_THREAD_FUNC
+test_server_run(
+    axutil_thread_t * thd,
+    void *data)
+{
+    test_server_t *server = (test_server_t *) data;
+    char buffer[256];
+    int fd = -1;
+    int i = 0;
+
+    for (i = 0; i < server->step_count; i++)
+    {
+        const char *response = server->steps[i].response;
+
+        if (fd < 0)
+        {
+            fd = accept(server->listen_fd, NULL, NULL);
+            if (fd < 0)
+            {
+                return NULL;
+            }
+            server->accepts++;
+        }
+        if (!test_server_read_request(server, fd))
+        {
+            break;
+        }
+        if (!response)
+        {
+            while (read(fd, buffer, sizeof(buffer)) > 0)
+                ;
+            close(fd);
+            fd = -1;
+            continue;
+        }
+        if (write(fd, response, strlen(response)) != (ssize_t) strlen(response)
+            || server->steps[i].close_after)
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    return NULL;
+}
+
+/* Listens on the loopback address of the family, returning the port or 0
+   if the family is not available */
+static int
+test_server_listen(
+    test_server_t * server,
+    int family)
+{
+    struct sockaddr_storage addr;
+    socklen_t addr_len = 0;
+    int on = 1;
+
+    memset(&addr, 0, sizeof(addr));
+    if (family == AF_INET6)
+    {
+        struct sockaddr_in6 *in6 = (struct sockaddr_in6 *) &addr;
+
+        in6->sin6_family = AF_INET6;
+        in6->sin6_addr = in6addr_loopback;
+        addr_len = sizeof(struct sockaddr_in6);
+    }
+    else
+    {
+        struct sockaddr_in *in = (struct sockaddr_in *) &addr;
+
+        in->sin_family = AF_INET;
+        in->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr_len = sizeof(struct sockaddr_in);
+    }
+
+    server->listen_fd = socket(family, SOCK_STREAM, 0);
+    if (server->listen_fd < 0)
+    {
+        return 0;
+    }
+    setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (bind(server->listen_fd, (struct sockaddr *) &addr, addr_len) ||
+        listen(server->listen_fd, 8) ||
+        getsockname(server->listen_fd, (struct sockaddr *) &addr, &addr_len))
+    {
+        close(server->listen_fd);
+        return 0;
+    }
+    return ntohs(family == AF_INET6 ?
+                 ((struct sockaddr_in6 *) &addr)->sin6_port :
+                 ((struct sockaddr_in *) &addr)->sin_port);
+}
+
+static axis2_status_t AXIS2_CALL
+test_on_complete(
+    axis2_callback_t * callback,
+    const axutil_env_t * env)
+{
+    axiom_soap_envelope_t *envelope = NULL;
+    axiom_node_t *node = NULL;
+    axiom_element_t *element = NULL;
+    axis2_char_t *text = NULL;
+
+    envelope = axis2_callback_get_envelope(callback, env);
+    if (envelope)
+    {
+        node = axiom_soap_body_get_base_node(
+            axiom_soap_envelope_get_body(envelope, env), env);
+        node = axiom_node_get_first_element(node, env);
+    }
+    if (node)
+    {
+        element = (axiom_element_t *) axiom_node_get_data_element(node, env);
+        text = axiom_element_get_text(element, env, node);
+    }
+    if (text)
+    {
+        strncpy(call_result, text, sizeof(call_result) - 1);
+    }
+    return AXIS2_SUCCESS;
+}
+
+static axis2_status_t AXIS2_CALL
+test_on_error(
+    axis2_callback_t * callback,
+    const axutil_env_t * env,
+    int exception)
+{
+    call_error = exception;
+    call_errored = 1;
+    return AXIS2_SUCCESS;
+}
+
+/* Makes a non blocking call and waits for its callback. Returns 1 if the
+   call completed with the response text expected, or failed when no text
+   is expected */
+static int
+test_call(
+    const axutil_env_t * env,
+    axis2_svc_client_t * svc_client,
+    const char *expected)
+{
+    axis2_callback_t *callback = NULL;
+    axiom_namespace_t *ns = NULL;
+    axiom_node_t *payload = NULL;
+    int i = 0;
+
+    call_errored = 0;
+    call_error = 0;
+    memset(call_result, 0, sizeof(call_result));
+
+    ns = axiom_namespace_create(env, "urn:test", "t");
+    axiom_element_create(env, NULL, "call", ns, &payload);
+    callback = axis2_callback_create(env);
+    axis2_callback_set_on_complete(callback, test_on_complete);
+    axis2_callback_set_on_error(callback, test_on_error);
+    axis2_svc_client_send_receive_non_blocking(svc_client, env, payload,
+                                               callback);
+
+    for (i = 0; i < 500 && !axis2_callback_get_complete(callback, env); i++)
+    {
+        AXIS2_USLEEP(10000);
+    }
+    if (!axis2_callback_get_complete(callback, env))
+    {
+        printf("test_async_engine: call did not complete\n");
+        return 0;
+    }
+    if (expected)
+    {
+        return !call_errored && !strcmp(call_result, expected);
+    }
+    return call_errored;
+}
+
+static void
+test_server_stop(
+    test_server_t * server,
+    axutil_thread_t * thread)
+{
+    /* wakes the server up should it still wait for a connection */
+    shutdown(server->listen_fd, SHUT_RDWR);
+    axutil_thread_join(thread);
+    close(server->listen_fd);
+}
+
+static void
+test_set_address(
+    const axutil_env_t * env,
+    axis2_options_t * options,
+    const char *host,
+    int port)
+{
+    char address[128];
+
+    sprintf(address, "http://%s:%d/axis2/services/test", host, port);
+    axis2_options_set_to(options, env, axis2_endpoint_ref_create(env, address));
+}
+
+/* Responses delimited by length and by chunks, the connection kept alive
+   between them, malformed chunks and a call timing out */
+static void
+test_async_responses(
+    const axutil_env_t * env,
+    axis2_svc_client_t * svc_client,
+    axis2_options_t * options)
+{
+    char plain[512];
+    char length_response[1024];
+    char chunked_response[2048];
+    char trailing_garbage[2048];
+    char oversized[1024];
+    char overflow[1024];
+    char *out = NULL;
+    test_step_t steps[6];
+    test_server_t server;
+    axutil_thread_t *thread = NULL;
+    int port = 0;
+    int len = 0;
+    int i = 0;
+
+    memset(&server, 0, sizeof(server));
+    port = test_server_listen(&server, AF_INET);
+    check(port != 0, "listen");
+    if (!port)
+    {
+        return;
+    }
+
+    sprintf(plain, TEST_ENVELOPE, "content-length");
+    sprintf(length_response, "HTTP/1.1 200 OK\r\n"
+            "Content-Type: application/soap+xml\r\n"
+            "Content-Length: %d\r\n\r\n%s", (int) strlen(plain), plain);
+
+    /* Ten bytes a chunk, the first with an extension */
+    sprintf(plain, TEST_ENVELOPE, "chunked");
+    len = (int) strlen(plain);
+    out = chunked_response;
+    out += sprintf(out, "HTTP/1.1 200 OK\r\n"
+                   "Content-Type: application/soap+xml\r\n"
+                   "Transfer-Encoding: chunked\r\n\r\n");
+    for (i = 0; i < len; i += 10)
+    {
+        int size = len - i < 10 ? len - i : 10;
+
+        out += sprintf(out, i ? "%x\r\n" : "%x;ext=1\r\n", size);
+        memcpy(out, plain + i, size);
+        out += size;
+        out += sprintf(out, "\r\n");
+    }
+    sprintf(out, "0\r\n\r\n");
+
+    /* A whole envelope followed by a line with no size on it */
+    sprintf(trailing_garbage, "HTTP/1.1 200 OK\r\n"
+            "Transfer-Encoding: chunked\r\n\r\n%x\r\n%s\r\nzz\r\n\r\n",
+            len, plain);
+    sprintf(oversized, "HTTP/1.1 200 OK\r\n"
+            "Transfer-Encoding: chunked\r\n\r\n7fffffff\r\n%s\r\n0\r\n\r\n",
+            plain);
+    sprintf(overflow, "HTTP/1.1 200 OK\r\n"
+            "Transfer-Encoding: chunked\r\n\r\nffffffffffffffffffff\r\n%s"
+            "\r\n0\r\n\r\n", plain);
+
+    steps[0].response = length_response;
+    steps[0].close_after = 0;
+    steps[1].response = chunked_response;
+    steps[1].close_after = 0;
+    steps[2].response = trailing_garbage;
+    steps[2].close_after = 1;
+    steps[3].response = oversized;
+    steps[3].close_after = 1;
+    steps[4].response = overflow;
+    steps[4].close_after = 1;
+    steps[5].response = NULL;
+    steps[5].close_after = 1;
+    server.steps = steps;
+    server.step_count = 6;
+    thread = axutil_thread_create(env->allocator, NULL, test_server_run,
+                                  &server);
+
+    test_set_address(env, options, "127.0.0.1", port);
+    axis2_options_set_timeout_in_milli_seconds(options, env, 5000);
+
+    check(test_call(env, svc_client, "content-length"),
+          "response with a content length");
+    check(test_call(env, svc_client, "chunked"), "chunked response");
+    check(server.accepts == 1, "connection reused");
+    sprintf(plain, "127.0.0.1:%d", port);
+    check(!strcmp(server.host, plain), "host header");
+
+    check(test_call(env, svc_client, NULL), "chunk line without a size");
+    check(test_call(env, svc_client, NULL), "chunk larger than a body");
+    check(test_call(env, svc_client, NULL), "chunk size out of range");
+
+    axis2_options_set_timeout_in_milli_seconds(options, env, 300);
+    check(test_call(env, svc_client, NULL) &&
+          call_error == AXIS2_ERROR_RESPONSE_TIMED_OUT, "time out");
+
+    test_server_stop(&server, thread);
+    printf("test_async_responses: done\n");
+}
+
+/* IPv6 literals go in brackets in the Host header */
+static void
+test_async_ipv6(
+    const axutil_env_t * env,
+    axis2_svc_client_t * svc_client,
+    axis2_options_t * options)
+{
+    char plain[512];
+    char response[1024];
+    char host[64];
+    test_step_t step;
+    test_server_t server;
+    axutil_thread_t *thread = NULL;
+    int port = 0;
+
+    memset(&server, 0, sizeof(server));
+    port = test_server_listen(&server, AF_INET6);
+    if (!port)
+    {
+        printf("IPv6 loopback is not available, IPv6 hosts are not tested\n");
+        return;
+    }
+
+    sprintf(plain, TEST_ENVELOPE, "ipv6");
+    sprintf(response, "HTTP/1.1 200 OK\r\nContent-Length: %d\r\n\r\n%s",
+            (int) strlen(plain), plain);
+    step.response = response;
+    step.close_after = 1;
+    server.steps = &step;
+    server.step_count = 1;
+    thread = axutil_thread_create(env->allocator, NULL, test_server_run,
+                                  &server);
+
+    test_set_address(env, options, "[::1]", port);
+    axis2_options_set_timeout_in_milli_seconds(options, env, 5000);
+    check(test_call(env, svc_client, "ipv6"), "IPv6 call");
+    sprintf(host, "[::1]:%d", port);
+    check(!strcmp(server.host, host), "bracketed host header");
+
+    test_server_stop(&server, thread);
+    printf("test_async_ipv6: done\n");
+}
+
+int
+main(
+    )
+{
+    axutil_env_t *env = NULL;
+    const axis2_char_t *home = NULL;
+    axis2_async_engine_t *async_engine = NULL;
+    axis2_svc_client_t *svc_client = NULL;
+    axis2_options_t *options = NULL;
+
+    home = AXIS2_GETENV("AXIS2C_HOME");
+    if (!home)
+    {
+        printf("AXIS2C_HOME is not set, the asynchronous engine is not "
+               "tested\n");
+        return 0;
+    }
+
+    env = axutil_env_create_all("test_async_engine.log", AXIS2_LOG_LEVEL_INFO);
+    async_engine = axis2_async_engine_create(env, 1);
+    if (!async_engine)
+    {
+        printf("No asynchronous engine on this platform\n");
+        axutil_env_free(env);
+        return 0;
+    }
+
+    svc_client = axis2_svc_client_create(env, home);
+    check(svc_client != NULL, "create client");
+    if (svc_client)
+    {
+        options = axis2_options_create(env);
+        axis2_svc_client_set_options(svc_client, env, options);
+        axis2_svc_client_set_async_engine(svc_client, env, async_engine);
+
+        test_async_responses(env, svc_client, options);
+        test_async_ipv6(env, svc_client, options);
+        axis2_svc_client_free(svc_client, env);
+    }
+    axis2_async_engine_free(async_engine, env);
+    axutil_env_free(env);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,198 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <axutil_env.h>
+#include <axutil_string.h>
+#include <axutil_qname.h>
+#include <axis2_const.h>
+#include <axis2_options.h>
+#include <axis2_op_client.h>
+#include <axis2_svc_client.h>
+#include <axis2_endpoint_ref.h>
+#include <platforms/axutil_platform_auto_sense.h>
+
+static int failures = 0;
+
+static void
+check(
+    int condition,
+    const char *what)
+{
+    if (!condition)
+    {
+        printf("test_call_options: %s FAILED\n", what);
+        failures++;
+    }
+}
+
+/* Options of the op client created for the next call */
+static const axis2_options_t *
+next_call_options(
+    axis2_svc_client_t * svc_client,
+    const axutil_env_t * env)
+{
+    axutil_qname_t *op_qname = NULL;
+    axis2_op_client_t *op_client = NULL;
+
+    op_qname = axutil_qname_create(env, AXIS2_ANON_OUT_IN_OP, NULL, NULL);
+    op_client = axis2_svc_client_create_op_client(svc_client, env, op_qname);
+    axutil_qname_free(op_qname, env);
+    return op_client ? axis2_op_client_get_options(op_client, env) : NULL;
+}
+
+/* Call options override what they set and fall back to the client options
+   for the rest */
+static void
+test_call_options_effective(
+    const axutil_env_t * env,
+    axis2_svc_client_t * svc_client)
+{
+    axis2_options_t *options = NULL;
+    axis2_options_t *call_options = NULL;
+    const axis2_options_t *effective = NULL;
+    const axis2_endpoint_ref_t *to = NULL;
+
+    options = axis2_options_create(env);
+    axis2_options_set_to(options, env, axis2_endpoint_ref_create(env,
+        "http://localhost:9090/axis2/services/echo"));
+    axis2_options_set_action(options, env, "urn:client");
+    axis2_options_set_timeout_in_milli_seconds(options, env, 1000);
+    axis2_options_set_transport_in_protocol(options, env,
+                                            AXIS2_TRANSPORT_ENUM_HTTP);
+    axis2_svc_client_set_options(svc_client, env, options);
+
+    call_options = axis2_options_create(env);
+    axis2_options_set_action(call_options, env, "urn:call");
+    axis2_options_set_transport_in_protocol(call_options, env,
+                                            AXIS2_TRANSPORT_ENUM_TCP);
+    axis2_svc_client_set_call_options(svc_client, env, call_options);
+
+    effective = next_call_options(svc_client, env);
+    check(effective == call_options, "op client gets the call options");
+    if (effective)
+    {
+        to = axis2_options_get_to(effective, env);
+        check(!axutil_strcmp(axis2_options_get_action(effective, env),
+                             "urn:call"), "action set for the call");
+        check(to && !axutil_strcmp(axis2_endpoint_ref_get_address(to, env),
+            "http://localhost:9090/axis2/services/echo"),
+              "address taken from the client");
+        check(axis2_options_get_timeout_in_milli_seconds(effective, env) ==
+              1000, "timeout taken from the client");
+        check(axis2_options_get_transport_in_protocol(effective, env) ==
+              AXIS2_TRANSPORT_ENUM_TCP, "transport set for the call");
+    }
+
+    /* without call options the client options apply again */
+    axis2_svc_client_set_call_options(svc_client, env, NULL);
+    effective = next_call_options(svc_client, env);
+    check(effective == options, "op client gets the client options");
+    if (effective)
+    {
+        check(!axutil_strcmp(axis2_options_get_action(effective, env),
+                             "urn:client"), "client action");
+        check(axis2_options_get_transport_in_protocol(effective, env) ==
+              AXIS2_TRANSPORT_ENUM_HTTP, "client transport");
+    }
+
+    axis2_options_free(call_options, env);
+    printf("test_call_options_effective: done\n");
+}
+
+/* The parent the caller's options had is given back */
+static void
+test_call_options_parent(
+    const axutil_env_t * env,
+    axis2_svc_client_t * svc_client)
+{
+    axis2_options_t *own_parent = NULL;
+    axis2_options_t *call_options = NULL;
+    axis2_options_t *other_call_options = NULL;
+    axis2_options_t *options = NULL;
+
+    own_parent = axis2_options_create(env);
+    call_options = axis2_options_create_with_parent(env, own_parent);
+    other_call_options = axis2_options_create(env);
+
+    axis2_svc_client_set_call_options(svc_client, env, call_options);
+    check(axis2_options_get_parent(call_options, env) ==
+          axis2_svc_client_get_options(svc_client, env),
+          "parent is the client options while installed");
+
+    /* new client options while installed */
+    options = axis2_options_create(env);
+    axis2_svc_client_set_options(svc_client, env, options);
+    check(axis2_options_get_parent(call_options, env) == options,
+          "parent follows new client options");
+
+    axis2_svc_client_set_call_options(svc_client, env, other_call_options);
+    check(axis2_options_get_parent(call_options, env) == own_parent,
+          "parent restored on replace");
+
+    axis2_svc_client_set_call_options(svc_client, env, call_options);
+    axis2_svc_client_set_call_options(svc_client, env, NULL);
+    check(axis2_options_get_parent(call_options, env) == own_parent,
+          "parent restored on unset");
+    check(axis2_options_get_parent(other_call_options, env) == NULL,
+          "parent restored to none");
+
+    axis2_options_free(call_options, env);
+    axis2_options_free(other_call_options, env);
+    axis2_options_free(own_parent, env);
+    printf("test_call_options_parent: done\n");
+}
+
+int
+main(
+    )
+{
+    axutil_env_t *env = NULL;
+    const axis2_char_t *home = NULL;
+    axis2_svc_client_t *svc_client = NULL;
+    axis2_options_t *own_parent = NULL;
+    axis2_options_t *call_options = NULL;
+
+    home = AXIS2_GETENV("AXIS2C_HOME");
+    if (!home)
+    {
+        printf("AXIS2C_HOME is not set, call options are not tested\n");
+        return 0;
+    }
+
+    env = axutil_env_create_all("test_call_options.log", AXIS2_LOG_LEVEL_INFO);
+    svc_client = axis2_svc_client_create(env, home);
+    check(svc_client != NULL, "create client");
+    if (svc_client)
+    {
+        test_call_options_effective(env, svc_client);
+        test_call_options_parent(env, svc_client);
+
+        /* freeing the client also gives the parent back */
+        own_parent = axis2_options_create(env);
+        call_options = axis2_options_create_with_parent(env, own_parent);
+        axis2_svc_client_set_call_options(svc_client, env, call_options);
+        axis2_svc_client_free(svc_client, env);
+        check(axis2_options_get_parent(call_options, env) == own_parent,
+              "parent restored on free");
+        axis2_options_free(call_options, env);
+        axis2_options_free(own_parent, env);
+    }
+    axutil_env_free(env);
+
+    return failures ? 1 : 0;
+}
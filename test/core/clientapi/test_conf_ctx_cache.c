@@ -0,0 +1,270 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <axutil_env.h>
+#include <axutil_string.h>
+#include <axutil_property.h>
+#include <axis2_conf.h>
+#include <axis2_conf_ctx.h>
+#include <axis2_conf_ctx_cache.h>
+#include <axis2_svc_client.h>
+#include <axis2_svc_grp.h>
+#include <axis2_op.h>
+#include <platforms/axutil_platform_auto_sense.h>
+
+#define TEST_CACHE_MARKER "test_conf_ctx_cache_marker"
+
+static int failures = 0;
+
+static void
+check(
+    int condition,
+    const char *what)
+{
+    if (!condition)
+    {
+        printf("test_conf_ctx_cache: %s FAILED\n", what);
+        failures++;
+    }
+}
+
+static void
+mark(
+    const axutil_env_t * env,
+    axis2_conf_ctx_t * conf_ctx)
+{
+    axutil_property_t *property = NULL;
+
+    property = axutil_property_create_with_args(env, AXIS2_SCOPE_APPLICATION,
+                                                AXIS2_TRUE, NULL,
+                                                axutil_strdup(env, "1"));
+    axis2_conf_ctx_set_property(conf_ctx, env, TEST_CACHE_MARKER, property);
+}
+
+/* Lookups of the same repository share a context, other repositories and
+   lookups after the last release get a new one */
+static void
+test_cache_get_release(
+    const axutil_env_t * env,
+    const axis2_char_t * home)
+{
+    axis2_conf_ctx_cache_t *cache = NULL;
+    axis2_conf_ctx_t *first = NULL;
+    axis2_conf_ctx_t *hit = NULL;
+    axis2_conf_ctx_t *other = NULL;
+    axis2_conf_ctx_t *again = NULL;
+    axis2_char_t *other_home = NULL;
+
+    cache = axis2_conf_ctx_cache_create(env);
+    check(cache != NULL, "create");
+    if (!cache)
+    {
+        return;
+    }
+
+    first = axis2_conf_ctx_cache_get(cache, env, home);
+    check(first != NULL, "get");
+    if (!first)
+    {
+        axis2_conf_ctx_cache_free(cache, env);
+        return;
+    }
+    mark(env, first);
+
+    hit = axis2_conf_ctx_cache_get(cache, env, home);
+    check(hit == first, "hit returns the cached context");
+
+    /* the cache goes by the path as given */
+    other_home = axutil_stracat(env, home, AXIS2_PATH_SEP_STR);
+    other = axis2_conf_ctx_cache_get(cache, env, other_home);
+    check(other && other != first, "miss builds a new context");
+    check(other && !axis2_conf_ctx_get_property(other, env, TEST_CACHE_MARKER),
+          "miss context is not the marked one");
+
+    check(axis2_conf_ctx_cache_release(cache, env, other) == AXIS2_SUCCESS,
+          "release");
+    check(axis2_conf_ctx_cache_release(cache, env, other) == AXIS2_FAILURE,
+          "release of an evicted context");
+
+    /* one reference left, so the context stays */
+    check(axis2_conf_ctx_cache_release(cache, env, hit) == AXIS2_SUCCESS,
+          "release of a shared context");
+    again = axis2_conf_ctx_cache_get(cache, env, home);
+    check(again == first &&
+          axis2_conf_ctx_get_property(again, env, TEST_CACHE_MARKER) != NULL,
+          "context kept while referenced");
+    axis2_conf_ctx_cache_release(cache, env, again);
+    axis2_conf_ctx_cache_release(cache, env, first);
+
+    /* the last release evicted it */
+    again = axis2_conf_ctx_cache_get(cache, env, home);
+    check(again && !axis2_conf_ctx_get_property(again, env, TEST_CACHE_MARKER),
+          "context rebuilt after eviction");
+    if (again)
+    {
+        axis2_conf_ctx_cache_release(cache, env, again);
+    }
+
+    AXIS2_FREE(env->allocator, other_home);
+    axis2_conf_ctx_cache_free(cache, env);
+    printf("test_cache_get_release: done\n");
+}
+
+/* Services added to a shared configuration go away with their group */
+static void
+test_cache_svc(
+    const axutil_env_t * env,
+    const axis2_char_t * home)
+{
+    axis2_conf_ctx_cache_t *cache = NULL;
+    axis2_conf_ctx_t *conf_ctx = NULL;
+    axis2_conf_t *conf = NULL;
+    axis2_svc_t *svc = NULL;
+    axis2_svc_grp_t *svc_grp = NULL;
+    axutil_qname_t *qname = NULL;
+
+    cache = axis2_conf_ctx_cache_create(env);
+    conf_ctx = axis2_conf_ctx_cache_get(cache, env, home);
+    check(conf_ctx != NULL, "get for services");
+    if (!conf_ctx)
+    {
+        axis2_conf_ctx_cache_free(cache, env);
+        return;
+    }
+    conf = axis2_conf_ctx_get_conf(conf_ctx, env);
+
+    qname = axutil_qname_create(env, "test_cache_svc", NULL, NULL);
+    svc = axis2_svc_create_with_qname(env, qname);
+    axutil_qname_free(qname, env);
+    qname = axutil_qname_create(env, "test_cache_op", NULL, NULL);
+    axis2_svc_add_op(svc, env, axis2_op_create_with_qname(env, qname));
+    axutil_qname_free(qname, env);
+
+    check(axis2_conf_ctx_cache_add_svc(cache, env, conf_ctx, svc) ==
+          AXIS2_SUCCESS, "add_svc");
+    check(axis2_conf_get_svc(conf, env, "test_cache_svc") == svc,
+          "service added");
+    check(axis2_conf_get_svc_grp(conf, env, "test_cache_svc") != NULL,
+          "service group added");
+
+    check(axis2_conf_ctx_cache_remove_svc(cache, env, conf_ctx, svc) ==
+          AXIS2_SUCCESS, "remove_svc");
+    check(axis2_conf_get_svc(conf, env, "test_cache_svc") == NULL,
+          "service removed");
+    check(axis2_conf_get_svc_grp(conf, env, "test_cache_svc") == NULL,
+          "service group removed");
+    check(axis2_conf_ctx_cache_remove_svc(cache, env, conf_ctx, svc) ==
+          AXIS2_FAILURE, "remove_svc of a service not added");
+    axis2_svc_free(svc, env);
+
+    /* axis2_conf_remove_svc_grp leaves the group to the caller */
+    svc_grp = axis2_svc_grp_create(env);
+    axis2_svc_grp_set_name(svc_grp, env, "test_cache_grp");
+    axis2_conf_add_svc_grp(conf, env, svc_grp);
+    check(axis2_conf_get_svc_grp(conf, env, "test_cache_grp") == svc_grp,
+          "group added");
+    check(axis2_conf_remove_svc_grp(conf, env, "test_cache_grp") ==
+          AXIS2_SUCCESS, "remove_svc_grp");
+    check(axis2_conf_get_svc_grp(conf, env, "test_cache_grp") == NULL,
+          "group removed");
+    check(axis2_conf_remove_svc_grp(conf, env, "test_cache_grp") ==
+          AXIS2_SUCCESS, "remove_svc_grp of an unknown group");
+    axis2_svc_grp_free(svc_grp, env);
+
+    axis2_conf_ctx_cache_release(cache, env, conf_ctx);
+    axis2_conf_ctx_cache_free(cache, env);
+    printf("test_cache_svc: done\n");
+}
+
+/* Clients of one repository share its context, each with a service of its
+   own that leaves the configuration with the client */
+static void
+test_cache_svc_clients(
+    const axutil_env_t * env,
+    const axis2_char_t * home)
+{
+    axis2_conf_ctx_cache_t *cache = NULL;
+    axis2_svc_client_t *first = NULL;
+    axis2_svc_client_t *second = NULL;
+    axis2_conf_t *conf = NULL;
+    axis2_char_t *first_name = NULL;
+    const axis2_char_t *second_name = NULL;
+
+    cache = axis2_conf_ctx_cache_create(env);
+    first = axis2_svc_client_create_with_conf_ctx_cache(env, home, cache);
+    second = axis2_svc_client_create_with_conf_ctx_cache(env, home, cache);
+    check(first && second, "create clients");
+    if (!first || !second)
+    {
+        axis2_svc_client_free(first, env);
+        axis2_svc_client_free(second, env);
+        axis2_conf_ctx_cache_free(cache, env);
+        return;
+    }
+
+    check(axis2_svc_client_get_conf_ctx(first, env) ==
+          axis2_svc_client_get_conf_ctx(second, env),
+          "clients share the context");
+    conf = axis2_conf_ctx_get_conf(axis2_svc_client_get_conf_ctx(first, env),
+                                   env);
+    first_name = axutil_strdup(env,
+        axis2_svc_get_name(axis2_svc_client_get_svc(first, env), env));
+    second_name =
+        axis2_svc_get_name(axis2_svc_client_get_svc(second, env), env);
+    check(axutil_strcmp(first_name, second_name) != 0,
+          "clients have services of their own");
+    check(axis2_conf_get_svc(conf, env, first_name) != NULL &&
+          axis2_conf_get_svc(conf, env, second_name) != NULL,
+          "client services added");
+
+    axis2_svc_client_free(first, env);
+    check(axis2_conf_get_svc(conf, env, first_name) == NULL &&
+          axis2_conf_get_svc_grp(conf, env, first_name) == NULL,
+          "freed client service removed");
+    check(axis2_conf_get_svc(conf, env, second_name) ==
+          axis2_svc_client_get_svc(second, env), "other client service kept");
+
+    AXIS2_FREE(env->allocator, first_name);
+    axis2_svc_client_free(second, env);
+    axis2_conf_ctx_cache_free(cache, env);
+    printf("test_cache_svc_clients: done\n");
+}
+
+int
+main(
+    )
+{
+    axutil_env_t *env = NULL;
+    const axis2_char_t *home = NULL;
+
+    home = AXIS2_GETENV("AXIS2C_HOME");
+    if (!home)
+    {
+        printf("AXIS2C_HOME is not set, the cache is not tested\n");
+        return 0;
+    }
+
+    env = axutil_env_create_all("test_conf_ctx_cache.log",
+                                AXIS2_LOG_LEVEL_INFO);
+    test_cache_get_release(env, home);
+    test_cache_svc(env, home);
+    test_cache_svc_clients(env, home);
+    axutil_env_free(env);
+
+    return failures ? 1 : 0;
+}
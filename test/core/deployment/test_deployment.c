@@ -31,6 +31,10 @@
 #include <axis2_transport_sender.h>
 #include <axis2_transport_receiver.h>
 #include <axis2_core_utils.h>
+#include <axutil_thread_pool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 const axutil_env_t *env = NULL;
 
@@ -339,6 +343,249 @@ axis2_test_default_module_version(
     return AXIS2_SUCCESS;
 }
 
+static int
+axis2_test_compare_names(
+    const void *a,
+    const void *b)
+{
+    return strcmp(*(const char *const *) a, *(const char *const *) b);
+}
+
+/* Appends the names of the operations of every service and of the modules
+ * of conf to summary, sorted so two loads can be compared */
+static void
+axis2_test_conf_summary(
+    const axutil_env_t * env,
+    axis2_conf_t * conf,
+    char *summary,
+    size_t size)
+{
+    char *names[256];
+    char entry[512];
+    int count = 0;
+    int i = 0;
+    axutil_hash_t *map = NULL;
+    axutil_hash_index_t *hi = NULL;
+    axutil_hash_index_t *hi2 = NULL;
+    void *value = NULL;
+
+    summary[0] = '\0';
+    map = axis2_conf_get_all_svcs(conf, env);
+    for (hi = map ? axutil_hash_first(map, env) : NULL; hi && count < 256;
+         hi = axutil_hash_next(env, hi))
+    {
+        axis2_svc_t *svc = NULL;
+        axutil_hash_t *ops = NULL;
+
+        axutil_hash_this(hi, NULL, NULL, &value);
+        svc = (axis2_svc_t *) value;
+        ops = axis2_svc_get_all_ops(svc, env);
+        for (hi2 = ops ? axutil_hash_first(ops, env) : NULL;
+             hi2 && count < 256; hi2 = axutil_hash_next(env, hi2))
+        {
+            axutil_hash_this(hi2, NULL, NULL, &value);
+            snprintf(entry, sizeof(entry), "svc %s op %s",
+                     axis2_svc_get_name(svc, env),
+                     axutil_qname_get_localpart(axis2_op_get_qname(
+                         (axis2_op_t *) value, env), env));
+            names[count++] = strdup(entry);
+        }
+    }
+    map = axis2_conf_get_all_modules(conf, env);
+    for (hi = map ? axutil_hash_first(map, env) : NULL; hi && count < 256;
+         hi = axutil_hash_next(env, hi))
+    {
+        axutil_hash_this(hi, NULL, NULL, &value);
+        snprintf(entry, sizeof(entry), "module %s",
+                 axutil_qname_get_localpart(axis2_module_desc_get_qname(
+                     (axis2_module_desc_t *) value, env), env));
+        names[count++] = strdup(entry);
+    }
+    qsort(names, count, sizeof(names[0]), axis2_test_compare_names);
+    for (i = 0; i < count; i++)
+    {
+        if (strlen(summary) + strlen(names[i]) + 2 < size)
+        {
+            strcat(summary, names[i]);
+            strcat(summary, "\n");
+        }
+        free(names[i]);
+    }
+}
+
+static axis2_conf_t *
+axis2_test_load_conf(
+    const axutil_env_t * env,
+    const axis2_char_t * repos)
+{
+    axis2_dep_engine_t *dep_engine = NULL;
+    axis2_conf_t *conf = NULL;
+
+    dep_engine = axis2_dep_engine_create_with_repos_name(env, repos);
+    if (!dep_engine)
+    {
+        return NULL;
+    }
+    conf = axis2_dep_engine_load(dep_engine, env);
+    if (!conf)
+    {
+        axis2_dep_engine_free(dep_engine, env);
+        return NULL;
+    }
+    axis2_conf_set_dep_engine(conf, env, dep_engine);
+    return conf;
+}
+
+/* Writes a repository that shares services, modules and lib with home
+ * and whose axis2.xml asks for several deployment threads */
+static int
+axis2_test_threaded_repos(
+    const axis2_char_t * home,
+    char *repos)
+{
+    static const char *dirs[] = { "services", "modules", "lib" };
+    static const char *param =
+        "\n    <parameter name=\"deploymentThreads\">4</parameter>";
+    char path[512];
+    char target[512];
+    char line[4096];
+    FILE *in = NULL;
+    FILE *out = NULL;
+    int inserted = 0;
+    int i = 0;
+
+    strcpy(repos, "/tmp/axis2_deploymentXXXXXX");
+    if (!mkdtemp(repos))
+    {
+        return 0;
+    }
+    for (i = 0; i < 3; i++)
+    {
+        snprintf(target, sizeof(target), "%s/%s", home, dirs[i]);
+        snprintf(path, sizeof(path), "%s/%s", repos, dirs[i]);
+        if (symlink(target, path) != 0)
+        {
+            return 0;
+        }
+    }
+    snprintf(path, sizeof(path), "%s/axis2.xml", home);
+    in = fopen(path, "r");
+    snprintf(path, sizeof(path), "%s/axis2.xml", repos);
+    out = fopen(path, "w");
+    if (!in || !out)
+    {
+        if (in)
+            fclose(in);
+        if (out)
+            fclose(out);
+        return 0;
+    }
+    while (fgets(line, sizeof(line), in))
+    {
+        fputs(line, out);
+        if (!inserted && strstr(line, "<axisconfig"))
+        {
+            fputs(param, out);
+            fputs("\n", out);
+            inserted = 1;
+        }
+    }
+    fclose(in);
+    fclose(out);
+    return inserted;
+}
+
+static void
+axis2_test_remove_repos(
+    const char *repos)
+{
+    static const char *files[] = { "services", "modules", "lib", "axis2.xml" };
+    char path[512];
+    int i = 0;
+
+    for (i = 0; i < 4; i++)
+    {
+        snprintf(path, sizeof(path), "%s/%s", repos, files[i]);
+        unlink(path);
+    }
+    rmdir(repos);
+}
+
+/* Loads the repository in AXIS2C_HOME sequentially and with descriptors
+ * parsed on several threads, and compares the services, operations and
+ * modules deployed */
+int
+axis2_test_deployment_threads(
+    axutil_allocator_t * allocator)
+{
+    const axis2_char_t *home = NULL;
+    axutil_env_t *pool_env = NULL;
+    axutil_thread_pool_t *pool = NULL;
+    axis2_conf_t *conf = NULL;
+    axutil_param_t *param = NULL;
+    char repos[64];
+    char sequential[16384];
+    char parallel[16384];
+    int result = -1;
+
+    printf("******************************************\n");
+    printf("testing deployment threads\n");
+    printf("******************************************\n");
+
+    home = AXIS2_GETENV("AXIS2C_HOME");
+    if (!home)
+    {
+        printf("AXIS2C_HOME is not set, deployment threads are not tested\n");
+        return 0;
+    }
+    conf = axis2_test_load_conf(env, home);
+    if (!conf)
+    {
+        printf("deployment threads .. FAILED, sequential load\n");
+        return -1;
+    }
+    axis2_test_conf_summary(env, conf, sequential, sizeof(sequential));
+    axis2_conf_free(conf, env);
+
+    if (!axis2_test_threaded_repos(home, repos))
+    {
+        printf("deployment threads .. FAILED, no repository copy\n");
+        return -1;
+    }
+    pool = axutil_thread_pool_init(allocator);
+    pool_env = axutil_env_create_with_error_log_thread_pool(allocator,
+        env->error, env->log, pool);
+    conf = axis2_test_load_conf(pool_env, repos);
+    if (!conf)
+    {
+        printf("deployment threads .. FAILED, threaded load\n");
+    }
+    else
+    {
+        param = axis2_conf_get_param(conf, pool_env, "deploymentThreads");
+        axis2_test_conf_summary(pool_env, conf, parallel, sizeof(parallel));
+        axis2_conf_free(conf, pool_env);
+        if (!param)
+        {
+            printf("deployment threads .. FAILED, parameter not read\n");
+        }
+        else if (!sequential[0] || strcmp(sequential, parallel))
+        {
+            printf("deployment threads .. FAILED, loads differ\n"
+                   "sequential:\n%sthreaded:\n%s", sequential, parallel);
+        }
+        else
+        {
+            printf("deployment threads .. SUCCESS\n");
+            result = 0;
+        }
+    }
+    axutil_thread_pool_free(pool);
+    AXIS2_FREE(allocator, pool_env);
+    axis2_test_remove_repos(repos);
+    return result;
+}
+
 int
 main(
     )
@@ -356,5 +603,9 @@ main(
        axis2_test_transport_sender_load(); */
     axis2_test_dep_engine_load();
     axis2_test_default_module_version();
+    if (axis2_test_deployment_threads(allocator) != 0)
+    {
+        return 1;
+    }
     return 0;
 }
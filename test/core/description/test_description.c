@@ -23,6 +23,23 @@
 #include <axis2_phases_info.h>
 #include <axutil_env.h>
 #include <axutil_allocator.h>
+#include <axis2_svc.h>
+#include <axis2_policy_include.h>
+#include <axiom_node.h>
+#include <axiom_element.h>
+#include <neethi_engine.h>
+#include <neethi_policy.h>
+#include <neethi_operator.h>
+#include <neethi_all.h>
+#include <neethi_exactlyone.h>
+#include <neethi_assertion.h>
+#include <string.h>
+
+#define TEST_POLICY_START \
+    "<wsp:Policy xmlns:wsp=\"http://schemas.xmlsoap.org/ws/2004/09/policy\" " \
+    "xmlns:mtom=\"http://schemas.xmlsoap.org/ws/2004/09/policy/optimizedmimeserialization\" " \
+    "xmlns:sp=\"http://schemas.xmlsoap.org/ws/2005/07/securitypolicy\">"
+#define TEST_POLICY_END "</wsp:Policy>"
 
 struct axis2_module_desc *create_module_desc(
     const axutil_env_t * env);
@@ -203,6 +220,305 @@ axis2_test_svc_get_op(
     return 0;
 }
 
+/* Builds a policy from the assertions in body. The tree is kept, because
+ * the policy refers to it */
+static neethi_policy_t *
+axis2_test_policy_create(
+    const axutil_env_t * env,
+    const char *body,
+    axutil_array_list_t * trees)
+{
+    char xml[1024];
+    axiom_node_t *node = NULL;
+
+    sprintf(xml, "%s%s%s", TEST_POLICY_START, body, TEST_POLICY_END);
+    node = axiom_node_create_from_buffer(env, xml);
+    if (!node)
+    {
+        return NULL;
+    }
+    axutil_array_list_add(trees, env, node);
+    return neethi_engine_get_policy(env, node, (axiom_element_t *)
+                                    axiom_node_get_data_element(node, env));
+}
+
+/* Appends the operators of components and the types of their assertions
+ * to text */
+static void
+axis2_test_policy_outline(
+    const axutil_env_t * env,
+    axutil_array_list_t * components,
+    char *text,
+    size_t size)
+{
+    static const char *names[] = { "policy", "all", "exactlyone",
+        "reference", "assertion", "unknown" };
+    neethi_operator_t *operator = NULL;
+    axutil_array_list_t *children = NULL;
+    void *value = NULL;
+    char item[32];
+    int type = 0;
+    int i = 0;
+
+    for (i = 0; components && i < axutil_array_list_size(components, env); i++)
+    {
+        operator = (neethi_operator_t *) axutil_array_list_get(components,
+                                                               env, i);
+        type = neethi_operator_get_type(operator, env);
+        value = neethi_operator_get_value(operator, env);
+        children = NULL;
+        if (type == OPERATOR_TYPE_ASSERTION)
+        {
+            sprintf(item, " assertion:%d", (int) neethi_assertion_get_type(
+                (neethi_assertion_t *) value, env));
+        }
+        else
+        {
+            sprintf(item, " %s(", names[type]);
+        }
+        if (type == OPERATOR_TYPE_POLICY)
+        {
+            children = neethi_policy_get_policy_components(
+                (neethi_policy_t *) value, env);
+        }
+        else if (type == OPERATOR_TYPE_ALL)
+        {
+            children = neethi_all_get_policy_components(
+                (neethi_all_t *) value, env);
+        }
+        else if (type == OPERATOR_TYPE_EXACTLYONE)
+        {
+            children = neethi_exactlyone_get_policy_components(
+                (neethi_exactlyone_t *) value, env);
+        }
+        if (strlen(text) + strlen(item) + 1 < size)
+        {
+            strcat(text, item);
+        }
+        if (type != OPERATOR_TYPE_ASSERTION)
+        {
+            axis2_test_policy_outline(env, children, text, size);
+            if (strlen(text) + 3 < size)
+            {
+                strcat(text, " )");
+            }
+        }
+    }
+}
+
+/* Outline of policy, freed by the caller. neethi cannot serialize the
+ * assertions it builds into typed values, so policies are compared by
+ * their outlines */
+static axis2_char_t *
+axis2_test_policy_to_string(
+    const axutil_env_t * env,
+    neethi_policy_t * policy)
+{
+    char text[1024] = "";
+
+    if (policy)
+    {
+        axis2_test_policy_outline(env,
+            neethi_policy_get_policy_components(policy, env), text,
+            sizeof(text));
+    }
+    return axutil_strdup(env, text);
+}
+
+/* Whether the outline text holds an assertion of type */
+static int
+axis2_test_policy_has(
+    const axis2_char_t * text,
+    int type)
+{
+    char item[32];
+
+    sprintf(item, " assertion:%d", type);
+    return strstr(text, item) != NULL;
+}
+
+/* The effective policy of an operation, merged the way it is without the
+ * cache */
+static axis2_char_t *
+axis2_test_policy_fresh_merge(
+    const axutil_env_t * env,
+    axis2_policy_include_t * svc_include,
+    axis2_policy_include_t * op_include)
+{
+    neethi_policy_t *parent = NULL;
+    neethi_policy_t *own = NULL;
+    neethi_policy_t *merged = NULL;
+    axis2_char_t *text = NULL;
+
+    parent = neethi_engine_get_normalize(env, AXIS2_FALSE,
+        axis2_policy_include_get_effective_policy(svc_include, env));
+    own = neethi_engine_get_normalize(env, AXIS2_FALSE,
+        axis2_policy_include_get_policy(op_include, env));
+    merged = neethi_engine_merge(env, parent, own);
+    text = axis2_test_policy_to_string(env, merged);
+    neethi_policy_free(merged, env);
+    neethi_policy_free(parent, env);
+    neethi_policy_free(own, env);
+    return text;
+}
+
+static int policy_failures = 0;
+
+static void
+axis2_test_policy_check(
+    int cond,
+    const char *what)
+{
+    if (!cond)
+    {
+        printf("axis2_test_svc_effective_policy FAILED, %s\n", what);
+        policy_failures++;
+    }
+}
+
+/* The effective policy cached for an operation is the merge of the service
+ * and operation policies, and is calculated again when either changes.
+ * Policies handed out before a change can still be read */
+int
+axis2_test_svc_effective_policy(
+    )
+{
+    axutil_allocator_t *allocator = NULL;
+    const axutil_env_t *env = NULL;
+    axutil_array_list_t *trees = NULL;
+    axis2_svc_t *svc = NULL;
+    axis2_op_t *op = NULL;
+    axis2_policy_include_t *svc_include = NULL;
+    axis2_policy_include_t *op_include = NULL;
+    neethi_policy_t *svc_policy = NULL;
+    neethi_policy_t *op_policy = NULL;
+    neethi_policy_t *policy = NULL;
+    neethi_policy_t *cached = NULL;
+    neethi_policy_t *earlier = NULL;
+    axis2_char_t *cached_text = NULL;
+    axis2_char_t *fresh_text = NULL;
+    axis2_char_t *earlier_text = NULL;
+    int i = 0;
+
+    printf("******************************************\n");
+    printf("testing axis2_svc_calculate_effective_policies\n");
+    printf("******************************************\n");
+
+    allocator = axutil_allocator_init(NULL);
+    env = axutil_env_create(allocator);
+    trees = axutil_array_list_create(env, 8);
+    svc = axis2_svc_create_with_qname(env,
+        axutil_qname_create(env, "policy_svc", NULL, NULL));
+    op = axis2_op_create_with_qname(env,
+        axutil_qname_create(env, "policy_op", NULL, NULL));
+    axis2_svc_add_op(svc, env, op);
+    svc_include = axis2_desc_get_policy_include(axis2_svc_get_base(svc, env),
+                                                env);
+    op_include = axis2_desc_get_policy_include(axis2_op_get_base(op, env), env);
+
+    svc_policy = axis2_test_policy_create(env,
+        "<mtom:OptimizedMimeSerialization/>", trees);
+    op_policy = axis2_test_policy_create(env, "<sp:EncryptBeforeSigning/>",
+                                         trees);
+    axis2_test_policy_check(svc_policy && op_policy, "policies not built");
+    axis2_policy_include_add_policy_element(svc_include, env,
+                                            AXIS2_SERVICE_POLICY, svc_policy);
+    axis2_policy_include_add_policy_element(op_include, env,
+                                            AXIS2_OPERATION_POLICY, op_policy);
+
+    axis2_test_policy_check(axis2_svc_calculate_effective_policies(svc, env)
+                            == AXIS2_SUCCESS, "calculation failed");
+    cached = axis2_policy_include_get_effective_policy(op_include, env);
+    axis2_test_policy_check(cached != NULL, "no effective policy");
+    axis2_test_policy_check(
+        axis2_policy_include_get_effective_policy(op_include, env) == cached,
+        "unchanged policy calculated again");
+    cached_text = axis2_test_policy_to_string(env, cached);
+    fresh_text = axis2_test_policy_fresh_merge(env, svc_include, op_include);
+    axis2_test_policy_check(!strcmp(cached_text, fresh_text),
+                            "cached policy differs from a fresh merge");
+    axis2_test_policy_check(axis2_test_policy_has(cached_text,
+                            ASSERTION_TYPE_OPTIMIZED_MIME_SERIALIZATION)
+                            && axis2_test_policy_has(cached_text,
+                            ASSERTION_TYPE_ENCRYPT_BEFORE_SIGNING),
+                            "assertions missing from the merge");
+    AXIS2_FREE(env->allocator, fresh_text);
+
+    /* a policy attached to the service invalidates the operation */
+    earlier = cached;
+    earlier_text = cached_text;
+    policy = axis2_test_policy_create(env, "<sp:ProtectTokens/>", trees);
+    axis2_policy_include_add_policy_element(svc_include, env,
+                                            AXIS2_SERVICE_POLICY, policy);
+    cached = axis2_policy_include_get_effective_policy(op_include, env);
+    cached_text = axis2_test_policy_to_string(env, cached);
+    fresh_text = axis2_test_policy_fresh_merge(env, svc_include, op_include);
+    axis2_test_policy_check(axis2_test_policy_has(cached_text,
+                            ASSERTION_TYPE_PROTECT_TOKENS),
+                            "service policy attached later not merged");
+    axis2_test_policy_check(!strcmp(cached_text, fresh_text),
+                            "policy after attaching differs from a fresh merge");
+    AXIS2_FREE(env->allocator, fresh_text);
+    fresh_text = axis2_test_policy_to_string(env, earlier);
+    axis2_test_policy_check(!strcmp(fresh_text, earlier_text),
+                            "policy handed out earlier changed");
+    AXIS2_FREE(env->allocator, fresh_text);
+    AXIS2_FREE(env->allocator, earlier_text);
+    AXIS2_FREE(env->allocator, cached_text);
+
+    /* an operation policy replaced in place */
+    policy = axis2_test_policy_create(env, "<sp:SignBeforeEncrypting/>",
+                                      trees);
+    neethi_policy_set_id(policy, env, neethi_policy_get_id(op_policy, env));
+    axis2_test_policy_check(axis2_policy_include_update_policy(op_include, env,
+                            policy) == AXIS2_SUCCESS, "update failed");
+    cached = axis2_policy_include_get_effective_policy(op_include, env);
+    cached_text = axis2_test_policy_to_string(env, cached);
+    fresh_text = axis2_test_policy_fresh_merge(env, svc_include, op_include);
+    axis2_test_policy_check(axis2_test_policy_has(cached_text,
+                            ASSERTION_TYPE_SIGN_BEFORE_ENCRYPTING) &&
+                            !axis2_test_policy_has(cached_text,
+                            ASSERTION_TYPE_ENCRYPT_BEFORE_SIGNING),
+                            "updated operation policy not merged");
+    axis2_test_policy_check(!strcmp(cached_text, fresh_text),
+                            "policy after updating differs from a fresh merge");
+    AXIS2_FREE(env->allocator, fresh_text);
+    AXIS2_FREE(env->allocator, cached_text);
+
+    /* an effective policy set explicitly is kept until the next change */
+    policy = axis2_test_policy_create(env, "<sp:ProtectTokens/>", trees);
+    axis2_policy_include_set_effective_policy(op_include, env, policy);
+    axis2_test_policy_check(
+        axis2_policy_include_get_effective_policy(op_include, env) == policy,
+        "explicit effective policy not used");
+    axis2_policy_include_remove_policy_element(op_include, env,
+        neethi_policy_get_id(op_policy, env));
+    cached = axis2_policy_include_get_effective_policy(op_include, env);
+    cached_text = axis2_test_policy_to_string(env, cached);
+    axis2_test_policy_check(cached != policy &&
+                            !axis2_test_policy_has(cached_text,
+                            ASSERTION_TYPE_SIGN_BEFORE_ENCRYPTING) &&
+                            axis2_test_policy_has(cached_text,
+                            ASSERTION_TYPE_OPTIMIZED_MIME_SERIALIZATION),
+                            "removed operation policy still merged");
+    AXIS2_FREE(env->allocator, cached_text);
+
+    axis2_svc_free(svc, env);
+    for (i = 0; i < axutil_array_list_size(trees, env); i++)
+    {
+        axiom_node_free_tree((axiom_node_t *) axutil_array_list_get(trees, env,
+                                                                    i), env);
+    }
+    axutil_array_list_free(trees, env);
+
+    if (policy_failures)
+    {
+        return -1;
+    }
+    printf("axis2_test_svc_effective_policy SUCCESS\n");
+    return 0;
+}
+
 int
 main(
     )
@@ -211,5 +527,9 @@ main(
     axis2_test_svc_add_module_ops();
     axis2_test_svc_engage_module();
     axis2_test_svc_get_op();
+    if (axis2_test_svc_effective_policy() != 0)
+    {
+        return 1;
+    }
     return 0;
 }
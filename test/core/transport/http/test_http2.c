@@ -0,0 +1,872 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Decodes the header blocks of the examples of RFC 7541 Appendix C and
+ * checks the dynamic table after each, then writes HTTP/2 frames with a
+ * frame buffer and reads them back with a frame reader, through a
+ * socketpair and a byte at a time.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <axutil_env.h>
+#include <axutil_error_default.h>
+#include <axutil_log_default.h>
+#include <axis2_http_header.h>
+#include <axis2_http2.h>
+
+/* room kept before each block for its size */
+#define TEST_BLOCK_HEADER 16
+
+static int failures = 0;
+
+typedef struct test_field
+{
+    const char *name;
+    const char *value;
+} test_field_t;
+
+/* Freed blocks are overwritten, so that what is read from them after they
+   were freed shows */
+static void *AXIS2_CALL
+test_malloc(
+    axutil_allocator_t * allocator,
+    size_t size)
+{
+    char *block = (char *) malloc(size + TEST_BLOCK_HEADER);
+
+    if (!block)
+    {
+        return NULL;
+    }
+    *(size_t *) block = size;
+    return block + TEST_BLOCK_HEADER;
+}
+
+static void AXIS2_CALL
+test_free(
+    axutil_allocator_t * allocator,
+    void *ptr)
+{
+    char *block = NULL;
+
+    if (!ptr)
+    {
+        return;
+    }
+    if (ptr == allocator)
+    {
+        /* the allocator was not allocated by test_malloc */
+        free(ptr);
+        return;
+    }
+    block = (char *) ptr - TEST_BLOCK_HEADER;
+    memset(ptr, 0xdd, *(size_t *) block);
+    free(block);
+}
+
+static void *AXIS2_CALL
+test_realloc(
+    axutil_allocator_t * allocator,
+    void *ptr,
+    size_t size)
+{
+    void *copy = test_malloc(allocator, size);
+    size_t old_size = 0;
+
+    if (copy && ptr)
+    {
+        old_size = *(size_t *) ((char *) ptr - TEST_BLOCK_HEADER);
+        memcpy(copy, ptr, old_size < size ? old_size : size);
+        test_free(allocator, ptr);
+    }
+    return copy;
+}
+
+static void
+test_check(
+    const char *test_name,
+    int cond,
+    const char *what)
+{
+    if (!cond)
+    {
+        printf("%s: FAILED, %s\n", test_name, what);
+        failures++;
+    }
+}
+
+/* Converts the hex dump of an example, spaces ignored, returns its length */
+static int
+test_unhex(
+    const char *hex,
+    unsigned char *block)
+{
+    int len = 0;
+    unsigned int byte = 0;
+
+    while (*hex)
+    {
+        if (*hex == ' ')
+        {
+            hex++;
+            continue;
+        }
+        sscanf(hex, "%2x", &byte);
+        block[len++] = (unsigned char) byte;
+        hex += 2;
+    }
+    return len;
+}
+
+static void
+test_free_headers(
+    const axutil_env_t * env,
+    axutil_array_list_t * headers)
+{
+    int i = 0;
+
+    for (i = 0; i < axutil_array_list_size(headers, env); i++)
+    {
+        axis2_http_header_free(axutil_array_list_get(headers, env, i), env);
+    }
+    axutil_array_list_free(headers, env);
+}
+
+/* Decodes a header block, returns the status and compares the fields
+   decoded with the expected ones when given */
+static axis2_status_t
+test_decode(
+    const char *test_name,
+    const axutil_env_t * env,
+    axis2_http2_hpack_t * hpack,
+    const unsigned char *block,
+    int len,
+    const test_field_t * fields,
+    int count)
+{
+    axutil_array_list_t *headers = axutil_array_list_create(env, 8);
+    axis2_status_t status = AXIS2_FAILURE;
+    int i = 0;
+
+    status = axis2_http2_hpack_decode(hpack, env, block, len, headers);
+    if (fields && AXIS2_SUCCESS == status)
+    {
+        test_check(test_name, axutil_array_list_size(headers, env) == count,
+                   "number of fields decoded");
+        for (i = 0; i < count && i < axutil_array_list_size(headers, env); i++)
+        {
+            axis2_http_header_t *header = axutil_array_list_get(headers, env,
+                                                                i);
+
+            if (strcmp(axis2_http_header_get_name(header, env),
+                       fields[i].name) ||
+                strcmp(axis2_http_header_get_value(header, env),
+                       fields[i].value))
+            {
+                printf("%s: FAILED, field %d is %s: %s, expected %s: %s\n",
+                       test_name, i, axis2_http_header_get_name(header, env),
+                       axis2_http_header_get_value(header, env),
+                       fields[i].name, fields[i].value);
+                failures++;
+            }
+        }
+    }
+    test_free_headers(env, headers);
+    return status;
+}
+
+static void
+test_decode_hex(
+    const char *test_name,
+    const axutil_env_t * env,
+    axis2_http2_hpack_t * hpack,
+    const char *hex,
+    const test_field_t * fields,
+    int count)
+{
+    unsigned char block[512];
+    int len = test_unhex(hex, block);
+
+    test_check(test_name, AXIS2_SUCCESS == test_decode(test_name, env, hpack,
+                                                       block, len, fields,
+                                                       count),
+               "header block not decoded");
+}
+
+/* Checks the dynamic table, newest entry first, through indexed fields,
+   which leave it as it is */
+static void
+test_check_table(
+    const char *test_name,
+    const axutil_env_t * env,
+    axis2_http2_hpack_t * hpack,
+    const test_field_t * entries,
+    int count)
+{
+    unsigned char block[1];
+    int i = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        block[0] = (unsigned char) (0x80 | (62 + i));
+        test_check(test_name, AXIS2_SUCCESS == test_decode(test_name, env,
+                                                           hpack, block, 1,
+                                                           entries + i, 1),
+                   "table entry missing");
+    }
+    block[0] = (unsigned char) (0x80 | (62 + count));
+    test_check(test_name, AXIS2_FAILURE == test_decode(test_name, env, hpack,
+                                                       block, 1, NULL, 0),
+               "table entry past the last one");
+}
+
+/* C.2, fields decoded one at a time */
+static void
+test_hpack_fields(
+    const axutil_env_t * env)
+{
+    static const test_field_t c21[] = { {"custom-key", "custom-header"} };
+    static const test_field_t c22[] = { {":path", "/sample/path"} };
+    static const test_field_t c23[] = { {"password", "secret"} };
+    static const test_field_t c24[] = { {":method", "GET"} };
+    axis2_http2_hpack_t *hpack = NULL;
+
+    hpack = axis2_http2_hpack_create(env, 4096);
+    test_decode_hex("C.2.1", env, hpack,
+                    "400a 6375 7374 6f6d 2d6b 6579 0d63 7573 746f 6d2d 6865"
+                    "6164 6572", c21, 1);
+    test_check_table("C.2.1", env, hpack, c21, 1);
+    axis2_http2_hpack_free(hpack, env);
+
+    hpack = axis2_http2_hpack_create(env, 4096);
+    test_decode_hex("C.2.2", env, hpack,
+                    "040c 2f73 616d 706c 652f 7061 7468", c22, 1);
+    test_check_table("C.2.2", env, hpack, NULL, 0);
+    test_decode_hex("C.2.3", env, hpack,
+                    "1008 7061 7373 776f 7264 0673 6563 7265 74", c23, 1);
+    test_check_table("C.2.3", env, hpack, NULL, 0);
+    test_decode_hex("C.2.4", env, hpack, "82", c24, 1);
+    test_check_table("C.2.4", env, hpack, NULL, 0);
+    axis2_http2_hpack_free(hpack, env);
+    printf("test_hpack_fields: done\n");
+}
+
+/* C.3 and C.4, the same requests with plain and Huffman coded strings */
+static void
+test_hpack_requests(
+    const axutil_env_t * env,
+    axis2_bool_t huffman)
+{
+    static const char *plain[] = {
+        "8286 8441 0f77 7777 2e65 7861 6d70 6c65 2e63 6f6d",
+        "8286 84be 5808 6e6f 2d63 6163 6865",
+        "8287 85bf 400a 6375 7374 6f6d 2d6b 6579 0c63 7573 746f 6d2d 7661"
+        "6c75 65"
+    };
+    static const char *coded[] = {
+        "8286 8441 8cf1 e3c2 e5f2 3a6b a0ab 90f4 ff",
+        "8286 84be 5886 a8eb 1064 9cbf",
+        "8287 85bf 4088 25a8 49e9 5ba9 7d7f 8925 a849 e95b b8e8 b4bf"
+    };
+    static const test_field_t first[] = {
+        {":method", "GET"}, {":scheme", "http"}, {":path", "/"},
+        {":authority", "www.example.com"}
+    };
+    static const test_field_t second[] = {
+        {":method", "GET"}, {":scheme", "http"}, {":path", "/"},
+        {":authority", "www.example.com"}, {"cache-control", "no-cache"}
+    };
+    static const test_field_t third[] = {
+        {":method", "GET"}, {":scheme", "https"}, {":path", "/index.html"},
+        {":authority", "www.example.com"}, {"custom-key", "custom-value"}
+    };
+    static const test_field_t table[] = {
+        {"custom-key", "custom-value"}, {"cache-control", "no-cache"},
+        {":authority", "www.example.com"}
+    };
+    const char *test_name = huffman ? "C.4" : "C.3";
+    const char **blocks = huffman ? coded : plain;
+    axis2_http2_hpack_t *hpack = axis2_http2_hpack_create(env, 4096);
+
+    test_decode_hex(test_name, env, hpack, blocks[0], first, 4);
+    test_check_table(test_name, env, hpack, table + 2, 1);
+    test_decode_hex(test_name, env, hpack, blocks[1], second, 5);
+    test_check_table(test_name, env, hpack, table + 1, 2);
+    test_decode_hex(test_name, env, hpack, blocks[2], third, 5);
+    test_check_table(test_name, env, hpack, table, 3);
+    axis2_http2_hpack_free(hpack, env);
+    printf("test_hpack_requests %s: done\n", test_name);
+}
+
+/* C.5 and C.6, responses that evict entries of a 256 byte table */
+static void
+test_hpack_responses(
+    const axutil_env_t * env,
+    axis2_bool_t huffman)
+{
+    static const char *plain[] = {
+        "4803 3330 3258 0770 7269 7661 7465 611d 4d6f 6e2c 2032 3120 4f63"
+        "7420 3230 3133 2032 303a 3133 3a32 3120 474d 546e 1768 7474 7073"
+        "3a2f 2f77 7777 2e65 7861 6d70 6c65 2e63 6f6d",
+        "4803 3330 37c1 c0bf",
+        "88c1 611d 4d6f 6e2c 2032 3120 4f63 7420 3230 3133 2032 303a 3133"
+        "3a32 3220 474d 54c0 5a04 677a 6970 7738 666f 6f3d 4153 444a 4b48"
+        "514b 425a 584f 5157 454f 5049 5541 5851 5745 4f49 553b 206d 6178"
+        "2d61 6765 3d33 3630 303b 2076 6572 7369 6f6e 3d31"
+    };
+    static const char *coded[] = {
+        "4882 6402 5885 aec3 771a 4b61 96d0 7abe 9410 54d4 44a8 2005 9504"
+        "0b81 66e0 82a6 2d1b ff6e 919d 29ad 1718 63c7 8f0b 97c8 e9ae 82ae"
+        "43d3",
+        "4883 640e ffc1 c0bf",
+        "88c1 6196 d07a be94 1054 d444 a820 0595 040b 8166 e084 a62d 1bff"
+        "c05a 839b d9ab 77ad 94e7 821d d7f2 e6c7 b335 dfdf cd5b 3960 d5af"
+        "2708 7f36 72c1 ab27 0fb5 291f 9587 3160 65c0 03ed 4ee5 b106 3d50"
+        "07"
+    };
+    static const test_field_t first[] = {
+        {":status", "302"}, {"cache-control", "private"},
+        {"date", "Mon, 21 Oct 2013 20:13:21 GMT"},
+        {"location", "https://www.example.com"}
+    };
+    static const test_field_t first_table[] = {
+        {"location", "https://www.example.com"},
+        {"date", "Mon, 21 Oct 2013 20:13:21 GMT"},
+        {"cache-control", "private"}, {":status", "302"}
+    };
+    static const test_field_t second[] = {
+        {":status", "307"}, {"cache-control", "private"},
+        {"date", "Mon, 21 Oct 2013 20:13:21 GMT"},
+        {"location", "https://www.example.com"}
+    };
+    static const test_field_t second_table[] = {
+        {":status", "307"}, {"location", "https://www.example.com"},
+        {"date", "Mon, 21 Oct 2013 20:13:21 GMT"},
+        {"cache-control", "private"}
+    };
+    static const test_field_t third[] = {
+        {":status", "200"}, {"cache-control", "private"},
+        {"date", "Mon, 21 Oct 2013 20:13:22 GMT"},
+        {"location", "https://www.example.com"},
+        {"content-encoding", "gzip"},
+        {"set-cookie",
+         "foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1"}
+    };
+    static const test_field_t third_table[] = {
+        {"set-cookie",
+         "foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1"},
+        {"content-encoding", "gzip"},
+        {"date", "Mon, 21 Oct 2013 20:13:22 GMT"}
+    };
+    const char *test_name = huffman ? "C.6" : "C.5";
+    const char **blocks = huffman ? coded : plain;
+    axis2_http2_hpack_t *hpack = axis2_http2_hpack_create(env, 256);
+
+    test_decode_hex(test_name, env, hpack, blocks[0], first, 4);
+    test_check_table(test_name, env, hpack, first_table, 4);
+    test_decode_hex(test_name, env, hpack, blocks[1], second, 4);
+    test_check_table(test_name, env, hpack, second_table, 4);
+    test_decode_hex(test_name, env, hpack, blocks[2], third, 6);
+    test_check_table(test_name, env, hpack, third_table, 3);
+    axis2_http2_hpack_free(hpack, env);
+    printf("test_hpack_responses %s: done\n", test_name);
+}
+
+/* Fields added to a full table whose name is that of an entry they evict */
+static void
+test_hpack_evicted_name(
+    const axutil_env_t * env)
+{
+    static const test_field_t status[] = { {":status", "307"} };
+    static const test_field_t table[] = {
+        {":status", "307"}, {"location", "https://www.example.com"},
+        {"date", "Mon, 21 Oct 2013 20:13:21 GMT"},
+        {"cache-control", "private"}
+    };
+    static const test_field_t public_table[] = {
+        {"cache-control", "public"}, {":status", "307"},
+        {"location", "https://www.example.com"},
+        {"date", "Mon, 21 Oct 2013 20:13:21 GMT"}
+    };
+    test_field_t large[1];
+    axis2_http2_hpack_t *hpack = axis2_http2_hpack_create(env, 256);
+    char value[221];
+    unsigned char block[512];
+    int len = 0;
+
+    /* the table of C.5.1, :status 302 is the oldest entry, index 65 */
+    test_decode_hex("evicted_name", env, hpack,
+                    "4803 3330 3258 0770 7269 7661 7465 611d 4d6f 6e2c 2032"
+                    "3120 4f63 7420 3230 3133 2032 303a 3133 3a32 3120 474d"
+                    "546e 1768 7474 7073 3a2f 2f77 7777 2e65 7861 6d70 6c65"
+                    "2e63 6f6d", NULL, 0);
+    /* :status 307 with the name of index 65, which it evicts */
+    test_decode_hex("evicted_name", env, hpack, "7f02 0333 3037", status, 1);
+    test_check_table("evicted_name", env, hpack, table, 4);
+    /* cache-control public with the name of index 65, cache-control
+       private, which it evicts */
+    test_decode_hex("evicted_name", env, hpack, "7f02 0670 7562 6c69 63",
+                    public_table, 1);
+    test_check_table("evicted_name", env, hpack, public_table, 4);
+
+    /* an entry larger than the table, with the name of the newest entry */
+    memset(value, 'a', sizeof(value) - 1);
+    value[sizeof(value) - 1] = '\0';
+    large[0].name = "cache-control";
+    large[0].value = value;
+    len = test_unhex("7e7f", block);
+    block[len++] = (unsigned char) (sizeof(value) - 1 - 127);
+    memcpy(block + len, value, sizeof(value) - 1);
+    len += (int) sizeof(value) - 1;
+    test_check("evicted_name", AXIS2_SUCCESS == test_decode("evicted_name",
+                                                            env, hpack, block,
+                                                            len, large, 1),
+               "field larger than the table not decoded");
+    test_check_table("evicted_name", env, hpack, NULL, 0);
+    axis2_http2_hpack_free(hpack, env);
+    printf("test_hpack_evicted_name: done\n");
+}
+
+/* C.1 integers, the limits of the prefixes and integers that are too long
+   or cut short, read from table size updates and field indexes */
+static void
+test_hpack_integers(
+    const axutil_env_t * env)
+{
+    static const test_field_t custom[] = { {"custom-key", "custom-header"} };
+    static const test_field_t customs[] = {
+        {"custom-key", "custom-header"}, {"custom-key", "custom-header"},
+        {"custom-key", "custom-header"}
+    };
+    static const test_field_t accept[] = {
+        {"accept-encoding", "gzip, deflate"}
+    };
+    static const test_field_t charset[] = { {"accept-charset", "utf-8"} };
+    static const char *bad[] = {
+        "3f", "3f80", "3fff ffff", "3fff ffff ff0f", "3f80 8080 8000",
+        "ff", "ffff", "0f", "00", "0085 6375 7374", "1f", "80", "c0", "be"
+    };
+    axis2_http2_hpack_t *hpack = NULL;
+    unsigned char block[64];
+    int len = 0;
+    int i = 0;
+
+    /* C.1.1, 10 in a 5 bit prefix: no entry of 55 bytes fits */
+    hpack = axis2_http2_hpack_create(env, 4096);
+    test_decode_hex("C.1.1", env, hpack,
+                    "2a40 0a63 7573 746f 6d2d 6b65 790d 6375 7374 6f6d 2d68"
+                    "6561 6465 72", custom, 1);
+    test_check_table("C.1.1", env, hpack, NULL, 0);
+    /* C.1.2, 1337 in a 5 bit prefix */
+    test_decode_hex("C.1.2", env, hpack,
+                    "3f9a 0a40 0a63 7573 746f 6d2d 6b65 790d 6375 7374 6f6d"
+                    "2d68 6561 6465 72", custom, 1);
+    test_check_table("C.1.2", env, hpack, custom, 1);
+    /* 30 and 31, on both sides of the largest 5 bit prefix, 31 taking a
+       byte of 0 after it; a table of 55 bytes holds the entry */
+    test_decode_hex("prefix", env, hpack, "3e", NULL, 0);
+    test_check_table("prefix", env, hpack, NULL, 0);
+    test_decode_hex("prefix", env, hpack,
+                    "3f00 3f18 400a 6375 7374 6f6d 2d6b 6579 0d63 7573 746f 6d2d"
+                    "6865 6164 6572", custom, 1);
+    test_check_table("prefix", env, hpack, custom, 1);
+    /* indexes 15 and 16 of a 4 bit prefix */
+    test_decode_hex("prefix", env, hpack, "0f00 0575 7466 2d38", charset, 1);
+    test_decode_hex("prefix", env, hpack, "0f01 0d67 7a69 702c 2064 6566 6c61"
+                    "7465", accept, 1);
+    /* a table of 4096 bytes again, indexes 62 and 63 of the dynamic table,
+       on both sides of the largest 6 bit prefix */
+    test_decode_hex("prefix", env, hpack, "3fe1 1f7e 0d63 7573 746f 6d2d 6865"
+                    "6164 6572", custom, 1);
+    test_check_table("prefix", env, hpack, customs, 2);
+    test_decode_hex("prefix", env, hpack, "7f00 0d63 7573 746f 6d2d 6865 6164"
+                    "6572", custom, 1);
+    test_check_table("prefix", env, hpack, customs, 3);
+    axis2_http2_hpack_free(hpack, env);
+
+    /* integers cut short or too large, indexes past the tables, a size
+       above the settings, strings longer than the block, bad padding */
+    for (i = 0; i < (int) (sizeof(bad) / sizeof(bad[0])); i++)
+    {
+        hpack = axis2_http2_hpack_create(env, 4096);
+        len = test_unhex(bad[i], block);
+        if (AXIS2_FAILURE != test_decode("bad", env, hpack, block, len, NULL,
+                                         0))
+        {
+            printf("bad: FAILED, %s decoded\n", bad[i]);
+            failures++;
+        }
+        axis2_http2_hpack_free(hpack, env);
+    }
+    hpack = axis2_http2_hpack_create(env, 4096);
+    /* size update to 4097 */
+    len = test_unhex("3fe2 1f", block);
+    test_check("bad", AXIS2_FAILURE == test_decode("bad", env, hpack, block,
+                                                   len, NULL, 0),
+               "size update above the settings accepted");
+    /* Huffman padded with a zero, or with more than 7 bits */
+    len = test_unhex("0081 0001 30", block);
+    test_check("bad", AXIS2_FAILURE == test_decode("bad", env, hpack, block,
+                                                   len, NULL, 0),
+               "Huffman padding of zeros accepted");
+    len = test_unhex("0082 07ff 0130", block);
+    test_check("bad", AXIS2_FAILURE == test_decode("bad", env, hpack, block,
+                                                   len, NULL, 0),
+               "Huffman padding longer than 7 bits accepted");
+    axis2_http2_hpack_free(hpack, env);
+    printf("test_hpack_integers: done\n");
+}
+
+/* What the encoder writes, byte for byte, and decoded back */
+static void
+test_hpack_encode(
+    const axutil_env_t * env)
+{
+    test_field_t fields[] = {
+        {":method", "GET"}, {":path", "/sample/path"},
+        {"accept-encoding", "gzip, deflate"}, {"accept-charset", "utf-8"},
+        {"x-long", NULL}
+    };
+    static const char *expected[] = {
+        "82", "040c 2f73 616d 706c 652f 7061 7468", "90",
+        "0f00 0575 7466 2d38", NULL
+    };
+    axis2_http2_hpack_t *hpack = axis2_http2_hpack_create(env, 4096);
+    unsigned char block[512];
+    unsigned char hex_block[64];
+    char value[128];
+    int len = 0;
+    int hex_len = 0;
+    int i = 0;
+
+    memset(value, 'x', sizeof(value) - 1);
+    value[sizeof(value) - 1] = '\0';
+    fields[4].value = value;
+    for (i = 0; i < (int) (sizeof(fields) / sizeof(fields[0])); i++)
+    {
+        len = axis2_http2_hpack_encode(env, fields[i].name, fields[i].value,
+                                       block);
+        test_check("encode", len <= axis2_http2_hpack_encoded_max_len(
+                       fields[i].name, fields[i].value), "longer than said");
+        if (expected[i])
+        {
+            hex_len = test_unhex(expected[i], hex_block);
+            test_check("encode", len == hex_len &&
+                       !memcmp(block, hex_block, len), expected[i]);
+        }
+        test_check("encode", AXIS2_SUCCESS == test_decode("encode", env, hpack,
+                                                          block, len,
+                                                          fields + i, 1),
+                   fields[i].name);
+    }
+    /* 127 bytes take a byte of 0 after the 7 bit prefix of the length */
+    test_check("encode", block[8] == 0x7f && block[9] == 0x00,
+               "length of 127 bytes");
+    /* nothing was added to the table */
+    test_check_table("encode", env, hpack, NULL, 0);
+    axis2_http2_hpack_free(hpack, env);
+    printf("test_hpack_encode: done\n");
+}
+
+/* Frames of every kind of length and stream, and the preface before them */
+static axis2_http2_frame_buf_t *
+test_frames_write(
+    const axutil_env_t * env,
+    unsigned char *payload,
+    int payload_len)
+{
+    axis2_http2_frame_buf_t *frame_buf = axis2_http2_frame_buf_create(env);
+    int i = 0;
+
+    for (i = 0; i < payload_len; i++)
+    {
+        payload[i] = (unsigned char) (i * 7);
+    }
+    axis2_http2_frame_buf_add_raw(frame_buf, env, AXIS2_HTTP2_PREFACE,
+                                  AXIS2_HTTP2_PREFACE_LEN);
+    axis2_http2_frame_buf_add(frame_buf, env, AXIS2_HTTP2_SETTINGS, 0, 0,
+                              payload, 6);
+    axis2_http2_frame_buf_add(frame_buf, env, AXIS2_HTTP2_SETTINGS,
+                              AXIS2_HTTP2_FLAG_ACK, 0, NULL, 0);
+    axis2_http2_frame_buf_add(frame_buf, env, AXIS2_HTTP2_HEADERS,
+                              AXIS2_HTTP2_FLAG_END_HEADERS, 1, payload, 300);
+    axis2_http2_frame_buf_add(frame_buf, env, AXIS2_HTTP2_DATA, 0, 1, payload,
+                              payload_len);
+    axis2_http2_frame_buf_add(frame_buf, env, AXIS2_HTTP2_DATA,
+                              AXIS2_HTTP2_FLAG_END_STREAM, 0x7fffffff, payload,
+                              payload_len);
+    /* the reserved bit of the stream is not written */
+    axis2_http2_frame_buf_add(frame_buf, env, AXIS2_HTTP2_WINDOW_UPDATE, 0,
+                              (int) 0x80000003, payload, 4);
+    return frame_buf;
+}
+
+/* Takes the frames test_frames_write wrote that were read whole, count
+   being the number taken before */
+static void
+test_frames_read(
+    const char *test_name,
+    const axutil_env_t * env,
+    axis2_http2_frame_reader_t * reader,
+    const unsigned char *payload,
+    int payload_len,
+    int *count)
+{
+    static const int types[] = {
+        AXIS2_HTTP2_SETTINGS, AXIS2_HTTP2_SETTINGS, AXIS2_HTTP2_HEADERS,
+        AXIS2_HTTP2_DATA, AXIS2_HTTP2_DATA, AXIS2_HTTP2_WINDOW_UPDATE
+    };
+    static const int flags[] = {
+        0, AXIS2_HTTP2_FLAG_ACK, AXIS2_HTTP2_FLAG_END_HEADERS, 0,
+        AXIS2_HTTP2_FLAG_END_STREAM, 0
+    };
+    static const int streams[] = { 0, 0, 1, 1, 0x7fffffff, 3 };
+    int lengths[6];
+    axis2_http2_frame_t frame;
+
+    lengths[0] = 6;
+    lengths[1] = 0;
+    lengths[2] = 300;
+    lengths[3] = payload_len;
+    lengths[4] = payload_len;
+    lengths[5] = 4;
+    while (*count < 6 &&
+           axis2_http2_frame_reader_next(reader, env, &frame) == 1)
+    {
+        if (frame.type != types[*count] || frame.flags != flags[*count] ||
+            frame.stream_id != streams[*count] ||
+            frame.length != lengths[*count] ||
+            memcmp(frame.payload, payload, frame.length))
+        {
+            printf("%s: FAILED, frame %d is type %d, flags %d, stream %d, "
+                   "length %d\n", test_name, *count, frame.type, frame.flags,
+                   frame.stream_id, frame.length);
+            failures++;
+        }
+        (*count)++;
+    }
+}
+
+/* Frames written to a socket and read from its peer */
+static void
+test_frames_socket(
+    const axutil_env_t * env)
+{
+    unsigned char payload[AXIS2_HTTP2_DEFAULT_MAX_FRAME_SIZE];
+    axis2_http2_frame_buf_t *frame_buf = NULL;
+    axis2_http2_frame_reader_t *reader = NULL;
+    axis2_http2_frame_t frame;
+    int fds[2];
+    int count = 0;
+    int preface = 0;
+    int total = 0;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+    {
+        perror("socketpair");
+        exit(1);
+    }
+    frame_buf = test_frames_write(env, payload, sizeof(payload));
+    total = axis2_http2_frame_buf_get_len(frame_buf, env);
+    test_check("frames_socket", total == AXIS2_HTTP2_PREFACE_LEN + 6 *
+               AXIS2_HTTP2_FRAME_HEADER_LEN + 6 + 300 + 2 * (int) sizeof(payload) +
+               4, "bytes buffered");
+    test_check("frames_socket", AXIS2_SUCCESS ==
+               axis2_http2_frame_buf_flush(frame_buf, env, fds[0]),
+               "frames not written");
+    test_check("frames_socket", 0 == axis2_http2_frame_buf_get_len(frame_buf,
+                                                                   env),
+               "bytes left after the flush");
+    close(fds[0]);
+
+    reader = axis2_http2_frame_reader_create(env,
+                                             AXIS2_HTTP2_DEFAULT_MAX_FRAME_SIZE);
+    while (count < 6)
+    {
+        if (!preface)
+        {
+            preface = axis2_http2_frame_reader_expect(reader, env,
+                                                      AXIS2_HTTP2_PREFACE,
+                                                      AXIS2_HTTP2_PREFACE_LEN);
+            test_check("frames_socket", preface >= 0, "preface differs");
+        }
+        if (preface == 1)
+        {
+            test_frames_read("frames_socket", env, reader, payload,
+                             sizeof(payload), &count);
+            if (count >= 6)
+            {
+                break;
+            }
+        }
+        if (preface < 0 || axis2_http2_frame_reader_fill(reader, env,
+                                                         fds[1]) <= 0)
+        {
+            break;
+        }
+    }
+    test_check("frames_socket", count == 6, "frames missing");
+    test_check("frames_socket", 0 == axis2_http2_frame_reader_fill(reader, env,
+                                                                   fds[1]),
+               "end of the connection not seen");
+    test_check("frames_socket", 0 == axis2_http2_frame_reader_next(reader, env,
+                                                                   &frame),
+               "frame past the last one");
+    close(fds[1]);
+    axis2_http2_frame_reader_free(reader, env);
+    axis2_http2_frame_buf_free(frame_buf, env);
+    printf("test_frames_socket: done\n");
+}
+
+/* Frames put in the reader a byte at a time, each taken once it is whole */
+static void
+test_frames_bytes(
+    const axutil_env_t * env)
+{
+    unsigned char payload[1000];
+    axis2_http2_frame_buf_t *frame_buf = NULL;
+    axis2_http2_frame_reader_t *reader = NULL;
+    axis2_http2_frame_t frame;
+    unsigned char *data = NULL;
+    int fds[2];
+    int len = 0;
+    int count = 0;
+    int i = 0;
+
+    /* the buffer is only written through a socket */
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+    {
+        perror("socketpair");
+        exit(1);
+    }
+    frame_buf = test_frames_write(env, payload, sizeof(payload));
+    len = axis2_http2_frame_buf_get_len(frame_buf, env);
+    axis2_http2_frame_buf_flush(frame_buf, env, fds[0]);
+    data = (unsigned char *) malloc(len);
+    for (i = 0; i < len; )
+    {
+        int got = (int) read(fds[1], data + i, len - i);
+
+        if (got <= 0)
+        {
+            break;
+        }
+        i += got;
+    }
+    close(fds[0]);
+    close(fds[1]);
+
+    reader = axis2_http2_frame_reader_create(env, sizeof(payload));
+    for (i = 0; i < len; i++)
+    {
+        axis2_http2_frame_reader_put(reader, env, data + i, 1);
+        if (i < AXIS2_HTTP2_PREFACE_LEN - 1)
+        {
+            test_check("frames_bytes", 0 == axis2_http2_frame_reader_expect(
+                           reader, env, AXIS2_HTTP2_PREFACE,
+                           AXIS2_HTTP2_PREFACE_LEN), "preface taken early");
+        }
+        else if (i == AXIS2_HTTP2_PREFACE_LEN - 1)
+        {
+            test_check("frames_bytes", 1 == axis2_http2_frame_reader_expect(
+                           reader, env, AXIS2_HTTP2_PREFACE,
+                           AXIS2_HTTP2_PREFACE_LEN), "preface not taken");
+        }
+        else
+        {
+            test_frames_read("frames_bytes", env, reader, payload,
+                             sizeof(payload), &count);
+        }
+    }
+    test_check("frames_bytes", count == 6, "frames missing");
+    axis2_http2_frame_reader_free(reader, env);
+
+    /* a frame larger than the reader takes, and what is not the preface */
+    reader = axis2_http2_frame_reader_create(env, 100);
+    axis2_http2_frame_reader_put(reader, env, data + AXIS2_HTTP2_PREFACE_LEN,
+                                 2 * AXIS2_HTTP2_FRAME_HEADER_LEN + 6);
+    test_check("frames_bytes", 1 == axis2_http2_frame_reader_next(reader, env,
+                                                                  &frame),
+               "settings not taken");
+    test_check("frames_bytes", 1 == axis2_http2_frame_reader_next(reader, env,
+                                                                  &frame),
+               "settings ack not taken");
+    test_check("frames_bytes", 0 == axis2_http2_frame_reader_next(reader, env,
+                                                                  &frame),
+               "frame taken before it was whole");
+    axis2_http2_frame_reader_put(reader, env, data + AXIS2_HTTP2_PREFACE_LEN +
+                                 2 * AXIS2_HTTP2_FRAME_HEADER_LEN + 6,
+                                 AXIS2_HTTP2_FRAME_HEADER_LEN);
+    test_check("frames_bytes", -1 == axis2_http2_frame_reader_next(reader, env,
+                                                                   &frame),
+               "frame larger than the reader takes");
+    axis2_http2_frame_reader_free(reader, env);
+
+    reader = axis2_http2_frame_reader_create(env, 100);
+    axis2_http2_frame_reader_put(reader, env, "PRI * HTTP/1.1", 14);
+    test_check("frames_bytes", -1 == axis2_http2_frame_reader_expect(reader,
+                   env, AXIS2_HTTP2_PREFACE, AXIS2_HTTP2_PREFACE_LEN),
+               "HTTP/1.1 taken for the preface");
+    axis2_http2_frame_reader_free(reader, env);
+
+    free(data);
+    axis2_http2_frame_buf_free(frame_buf, env);
+    printf("test_frames_bytes: done\n");
+}
+
+int
+main(
+    void)
+{
+    axutil_allocator_t *allocator = axutil_allocator_init(NULL);
+    axutil_error_t *error = NULL;
+    axutil_log_t *log = NULL;
+    axutil_env_t *env = NULL;
+
+    allocator->malloc_fn = test_malloc;
+    allocator->realloc = test_realloc;
+    allocator->free_fn = test_free;
+    error = axutil_error_create(allocator);
+    log = axutil_log_create(allocator, NULL, "test_http2.log");
+    env = axutil_env_create_with_error_log(allocator, error, log);
+
+    test_hpack_fields(env);
+    test_hpack_requests(env, AXIS2_FALSE);
+    test_hpack_requests(env, AXIS2_TRUE);
+    test_hpack_responses(env, AXIS2_FALSE);
+    test_hpack_responses(env, AXIS2_TRUE);
+    test_hpack_evicted_name(env);
+    test_hpack_integers(env);
+    test_hpack_encode(env);
+    test_frames_socket(env);
+    test_frames_bytes(env);
+
+    axutil_env_free(env);
+    if (failures)
+    {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
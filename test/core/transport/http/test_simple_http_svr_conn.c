@@ -0,0 +1,534 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Feeds requests to a server connection through a socketpair, written at
+ * once or a byte at a time, so that request lines, headers, chunk sizes,
+ * chunk extensions and trailers arrive whole or split across reads.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <axutil_env.h>
+#include <axutil_error_default.h>
+#include <axutil_log_default.h>
+#include <axis2_http_simple_request.h>
+#include <axis2_http_request_line.h>
+#include <axis2_simple_http_svr_conn.h>
+
+/* how the client writes the requests */
+#define TEST_WRITE_ALL 0
+#define TEST_WRITE_BYTES 1
+
+static int failures = 0;
+
+typedef struct test_conn
+{
+    axis2_simple_http_svr_conn_t *svr_conn;
+    pid_t writer;
+} test_conn_t;
+
+static void
+test_check(
+    const char *test_name,
+    int cond,
+    const char *what)
+{
+    if (!cond)
+    {
+        printf("%s: FAILED, %s\n", test_name, what);
+        failures++;
+    }
+}
+
+/* Opens a server connection that a child process writes data to, then
+   closes */
+static void
+test_conn_open(
+    const axutil_env_t * env,
+    test_conn_t * conn,
+    const char *data,
+    int len,
+    int how)
+{
+    int fds[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+    {
+        perror("socketpair");
+        exit(1);
+    }
+    conn->writer = fork();
+    if (conn->writer == 0)
+    {
+        int i = 0;
+
+        close(fds[0]);
+        if (how == TEST_WRITE_ALL)
+        {
+            while (i < len)
+            {
+                int written = (int) write(fds[1], data + i, len - i);
+                if (written <= 0)
+                {
+                    break;
+                }
+                i += written;
+            }
+        }
+        else
+        {
+            /* each byte is read on its own, as the reader waits for it */
+            for (i = 0; i < len; i++)
+            {
+                if (write(fds[1], data + i, 1) != 1)
+                {
+                    break;
+                }
+                usleep(50);
+            }
+        }
+        close(fds[1]);
+        _exit(0);
+    }
+    close(fds[1]);
+    conn->svr_conn = axis2_simple_http_svr_conn_create(env, fds[0]);
+    axis2_simple_http_svr_conn_set_max_requests(conn->svr_conn, env, 100);
+}
+
+static void
+test_conn_close(
+    const axutil_env_t * env,
+    test_conn_t * conn)
+{
+    axis2_simple_http_svr_conn_free(conn->svr_conn, env);
+    kill(conn->writer, SIGKILL);
+    waitpid(conn->writer, NULL, 0);
+}
+
+/* Reads a request, checks its method and URI and returns it */
+static axis2_http_simple_request_t *
+test_read_request(
+    const axutil_env_t * env,
+    const char *test_name,
+    test_conn_t * conn,
+    const char *method,
+    const char *uri)
+{
+    axis2_http_simple_request_t *request = NULL;
+    axis2_http_request_line_t *request_line = NULL;
+
+    request = axis2_simple_http_svr_conn_read_request(conn->svr_conn, env);
+    test_check(test_name, request != NULL, "request not read");
+    if (!request)
+    {
+        return NULL;
+    }
+    request_line = axis2_http_simple_request_get_request_line(request, env);
+    test_check(test_name, request_line &&
+               0 == axutil_strcmp(axis2_http_request_line_get_method
+                                  (request_line, env), method) &&
+               0 == axutil_strcmp(axis2_http_request_line_get_uri
+                                  (request_line, env), uri),
+               "request line differs");
+    return request;
+}
+
+/* Reads the body of a request to its end, in reads of at most count bytes,
+   and compares it with the expected body */
+static void
+test_read_body(
+    const axutil_env_t * env,
+    const char *test_name,
+    axis2_http_simple_request_t * request,
+    const char *expected,
+    int expected_len,
+    int count)
+{
+    axutil_stream_t *body = axis2_http_simple_request_get_body(request, env);
+    char *got = malloc(expected_len + count + 1);
+    int got_len = 0;
+    int len = 0;
+
+    while ((len = axutil_stream_read(body, env, got + got_len, count)) > 0)
+    {
+        got_len += len;
+        if (got_len > expected_len)
+        {
+            break;
+        }
+    }
+    test_check(test_name, got_len == expected_len &&
+               0 == memcmp(got, expected, expected_len),
+               "body differs");
+    test_check(test_name, axutil_stream_read(body, env, got, count) <= 0,
+               "read past the end of the body");
+    free(got);
+}
+
+/* Reads count bytes of a body, as far as it goes */
+static int
+test_read_some(
+    const axutil_env_t * env,
+    axutil_stream_t * stream,
+    char *buffer,
+    int count)
+{
+    int read = 0;
+    int len = 0;
+
+    while (read < count &&
+           (len = axutil_stream_read(stream, env, buffer + read,
+                                     count - read)) > 0)
+    {
+        read += len;
+    }
+    return read;
+}
+
+/* Two requests sent at once, each with a Content-Length body */
+static void
+test_pipelined(
+    const axutil_env_t * env,
+    int how)
+{
+    const char *data =
+        "POST /axis2/services/first HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Content-Length: 5\r\n"
+        "\r\n"
+        "first"
+        "POST /axis2/services/second HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Content-Length: 6\r\n"
+        "\r\n"
+        "second";
+    test_conn_t conn;
+    axis2_http_simple_request_t *request = NULL;
+
+    test_conn_open(env, &conn, data, (int) strlen(data), how);
+
+    request = test_read_request(env, "test_pipelined", &conn, "POST",
+                                "/axis2/services/first");
+    if (request)
+    {
+        test_read_body(env, "test_pipelined", request, "first", 5, 64);
+        axis2_http_simple_request_free(request, env);
+    }
+    test_check("test_pipelined",
+               axis2_simple_http_svr_conn_wait_for_request(conn.svr_conn, env,
+                                                           1000),
+               "second request not seen");
+    request = test_read_request(env, "test_pipelined", &conn, "POST",
+                                "/axis2/services/second");
+    if (request)
+    {
+        test_read_body(env, "test_pipelined", request, "second", 6, 4);
+        axis2_http_simple_request_free(request, env);
+    }
+    test_check("test_pipelined",
+               !axis2_simple_http_svr_conn_wait_for_request(conn.svr_conn, env,
+                                                            1000),
+               "request after the last one");
+    test_conn_close(env, &conn);
+    printf("test_pipelined %s: done\n", how == TEST_WRITE_ALL ? "at once" :
+           "by bytes");
+}
+
+/* A chunked body with chunk extensions, sizes in both cases and a trailer,
+   followed by another request. The chunked body is passed on as sent. */
+static void
+test_chunked(
+    const axutil_env_t * env,
+    int how,
+    int count)
+{
+    const char *body =
+        "5;name=value\r\n"
+        "hello\r\n"
+        "1A ; ext=\"quoted;\"\r\n"
+        "abcdefghijklmnopqrstuvwxyz\r\n"
+        "00b\r\n"
+        "0123456789\n\r\n"
+        "0;last\r\n"
+        "X-Trailer: t\r\n"
+        "X-Other: u\r\n"
+        "\r\n";
+    const char *head =
+        "POST /axis2/services/chunked HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n";
+    const char *next =
+        "GET /axis2/services/next HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "\r\n";
+    char data[1024];
+    test_conn_t conn;
+    axis2_http_simple_request_t *request = NULL;
+
+    sprintf(data, "%s%s%s", head, body, next);
+    test_conn_open(env, &conn, data, (int) strlen(data), how);
+
+    request = test_read_request(env, "test_chunked", &conn, "POST",
+                                "/axis2/services/chunked");
+    if (request)
+    {
+        test_read_body(env, "test_chunked", request, body, (int) strlen(body),
+                       count);
+        axis2_http_simple_request_free(request, env);
+    }
+    test_check("test_chunked",
+               AXIS2_SUCCESS ==
+               axis2_simple_http_svr_conn_drain_body(conn.svr_conn, env),
+               "connection not at the next request");
+    request = test_read_request(env, "test_chunked", &conn, "GET",
+                                "/axis2/services/next");
+    if (request)
+    {
+        axis2_http_simple_request_free(request, env);
+    }
+    test_conn_close(env, &conn);
+    printf("test_chunked %s, reads of %d: done\n",
+           how == TEST_WRITE_ALL ? "at once" : "by bytes", count);
+}
+
+/* Bodies the service left unread, or read in part, are skipped before the
+   next request */
+static void
+test_drain(
+    const axutil_env_t * env,
+    int how)
+{
+    const char *chunked =
+        "POST /axis2/services/chunked HTTP/1.1\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "3;x=y\r\nabc\r\n4\r\ndefg\r\n0\r\nTrailer: z\r\n\r\n";
+    const char *next =
+        "GET /axis2/services/next HTTP/1.1\r\n"
+        "\r\n";
+    char head[128];
+    char *data = NULL;
+    int body_len = 3 * 8192 + 17;
+    int len = 0;
+    test_conn_t conn;
+    axis2_http_simple_request_t *request = NULL;
+    axutil_stream_t *stream = NULL;
+    char buffer[16];
+
+    /* a body longer than the buffer of the connection, a chunked body and
+       another request */
+    sprintf(head, "POST /axis2/services/length HTTP/1.1\r\n"
+            "Content-Length: %d\r\n\r\n", body_len);
+    data = malloc(strlen(head) + body_len + strlen(chunked) + strlen(next) + 1);
+    strcpy(data, head);
+    len = (int) strlen(head);
+    memset(data + len, 'b', body_len);
+    len += body_len;
+    strcpy(data + len, chunked);
+    strcat(data + len, next);
+    len = (int) strlen(data);
+
+    test_conn_open(env, &conn, data, len, how);
+
+    request = test_read_request(env, "test_drain", &conn, "POST",
+                                "/axis2/services/length");
+    if (request)
+    {
+        stream = axis2_http_simple_request_get_body(request, env);
+        test_check("test_drain", test_read_some(env, stream, buffer, 10) == 10,
+                   "start of the body not read");
+        axis2_http_simple_request_free(request, env);
+    }
+    test_check("test_drain",
+               AXIS2_SUCCESS ==
+               axis2_simple_http_svr_conn_drain_body(conn.svr_conn, env),
+               "body not drained");
+
+    request = test_read_request(env, "test_drain", &conn, "POST",
+                                "/axis2/services/chunked");
+    if (request)
+    {
+        /* into the second chunk */
+        stream = axis2_http_simple_request_get_body(request, env);
+        test_check("test_drain", test_read_some(env, stream, buffer, 13) == 13,
+                   "start of the chunked body not read");
+        axis2_http_simple_request_free(request, env);
+    }
+    test_check("test_drain",
+               AXIS2_SUCCESS ==
+               axis2_simple_http_svr_conn_drain_body(conn.svr_conn, env),
+               "chunked body not drained");
+
+    request = test_read_request(env, "test_drain", &conn, "GET",
+                                "/axis2/services/next");
+    if (request)
+    {
+        axis2_http_simple_request_free(request, env);
+    }
+    test_conn_close(env, &conn);
+    free(data);
+    printf("test_drain %s: done\n", how == TEST_WRITE_ALL ? "at once" :
+           "by bytes");
+}
+
+/* Chunk sizes up to 0x7ffffff0 are followed, chunks of 2GB and more break
+   the body and the connection */
+static void
+test_chunk_limit(
+    const axutil_env_t * env)
+{
+    static const struct
+    {
+        const char *size_line;
+        axis2_bool_t valid;
+    } sizes[] = {
+        {"7ffffff0\r\n", AXIS2_TRUE},
+        {"0007FFFFFFF;big\r\n", AXIS2_TRUE},
+        {"80000000\r\n", AXIS2_FALSE},
+        {"100000000\r\n", AXIS2_FALSE},
+        {"fffffffffff\r\n", AXIS2_FALSE}
+    };
+    char data[512];
+    char buffer[64];
+    int i = 0;
+
+    for (i = 0; i < (int) (sizeof(sizes) / sizeof(sizes[0])); i++)
+    {
+        test_conn_t conn;
+        axis2_http_simple_request_t *request = NULL;
+        int size_len = (int) strlen(sizes[i].size_line);
+        int read = 0;
+
+        sprintf(data, "POST /axis2/services/big HTTP/1.1\r\n"
+                "Transfer-Encoding: chunked\r\n\r\n%sdata of the chunk",
+                sizes[i].size_line);
+        test_conn_open(env, &conn, data, (int) strlen(data), TEST_WRITE_ALL);
+
+        request = test_read_request(env, "test_chunk_limit", &conn, "POST",
+                                    "/axis2/services/big");
+        if (request)
+        {
+            axutil_stream_t *stream =
+                axis2_http_simple_request_get_body(request, env);
+
+            /* the size line, then the start of the chunk if it is taken */
+            read = test_read_some(env, stream, buffer, size_len + 4);
+            if (sizes[i].valid)
+            {
+                test_check("test_chunk_limit", read == size_len + 4 &&
+                           0 == memcmp(buffer + size_len, "data", 4),
+                           "chunk of a valid size not read");
+            }
+            else
+            {
+                test_check("test_chunk_limit", read <= size_len,
+                           "data read from a chunk over the limit");
+                test_check("test_chunk_limit", AXIS2_FAILURE ==
+                           axis2_simple_http_svr_conn_drain_body(conn.svr_conn,
+                                                                 env),
+                           "connection kept after a chunk over the limit");
+            }
+            axis2_http_simple_request_free(request, env);
+        }
+        test_conn_close(env, &conn);
+    }
+    printf("test_chunk_limit: done\n");
+}
+
+/* Header lines longer than the buffer of the connection, and a connection
+   ending in the middle of a line */
+static void
+test_long_lines(
+    const axutil_env_t * env)
+{
+    axis2_http_simple_request_t *request = NULL;
+    axis2_http_header_t *header = NULL;
+    test_conn_t conn;
+    char *value = NULL;
+    char *data = NULL;
+    int value_len = 20000;
+
+    value = malloc(value_len + 1);
+    memset(value, 'v', value_len);
+    value[value_len] = '\0';
+    data = malloc(value_len + 256);
+    sprintf(data, "GET /axis2/services/long HTTP/1.1\r\n"
+            "X-Long: %s\r\n\r\nGET /axis2/services/cut HT", value);
+    test_conn_open(env, &conn, data, (int) strlen(data), TEST_WRITE_ALL);
+
+    request = test_read_request(env, "test_long_lines", &conn, "GET",
+                                "/axis2/services/long");
+    if (request)
+    {
+        header = axis2_http_simple_request_get_first_header(request, env,
+                                                            "X-Long");
+        test_check("test_long_lines", header &&
+                   0 == axutil_strcmp(axis2_http_header_get_value(header, env),
+                                      value), "long header differs");
+        axis2_http_simple_request_free(request, env);
+    }
+    request = axis2_simple_http_svr_conn_read_request(conn.svr_conn, env);
+    test_check("test_long_lines", request == NULL,
+               "request read from a cut request line");
+    if (request)
+    {
+        axis2_http_simple_request_free(request, env);
+    }
+    test_conn_close(env, &conn);
+    free(data);
+    free(value);
+    printf("test_long_lines: done\n");
+}
+
+int
+main(
+    void)
+{
+    axutil_allocator_t *allocator = axutil_allocator_init(NULL);
+    axutil_error_t *error = axutil_error_create(allocator);
+    axutil_log_t *log = axutil_log_create(allocator, NULL,
+                                          "test_simple_http_svr_conn.log");
+    axutil_env_t *env = axutil_env_create_with_error_log(allocator, error, log);
+
+    test_pipelined(env, TEST_WRITE_ALL);
+    test_pipelined(env, TEST_WRITE_BYTES);
+    test_chunked(env, TEST_WRITE_ALL, 1);
+    test_chunked(env, TEST_WRITE_ALL, 7);
+    test_chunked(env, TEST_WRITE_ALL, 4096);
+    test_chunked(env, TEST_WRITE_BYTES, 4096);
+    test_drain(env, TEST_WRITE_ALL);
+    test_drain(env, TEST_WRITE_BYTES);
+    test_chunk_limit(env);
+    test_long_lines(env);
+
+    axutil_env_free(env);
+    if (failures)
+    {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,380 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Calls the echo service of the repository in AXIS2C_HOME through the local
+ * transport, in the configuration context the service is deployed in, with
+ * DEEP_COPY off and on.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <axutil_env.h>
+#include <axutil_error_default.h>
+#include <axutil_log_default.h>
+#include <axis2_util.h>
+#include <axis2_client.h>
+#include <axis2_conf_init.h>
+#include <axis2_conf_ctx.h>
+
+#define LOCAL_ECHO_ADDRESS "local://localhost/axis2/services/echo"
+#define LOCAL_ECHO_NS "http://ws.apache.org/axis2/c/samples"
+#define LOCAL_ECHO_TEXT "Hello local transport"
+#define LOCAL_CALLS 20
+
+/* End of the local transport sender of axis2.xml once uncommented */
+#define LOCAL_SENDER_COPY \
+    "<parameter name=\"DEEP_COPY\" locked=\"false\">true</parameter>\n" \
+    "    </transportSender>"
+#define LOCAL_SENDER_NO_COPY \
+    "<parameter name=\"DEEP_COPY\" locked=\"false\">false</parameter>\n" \
+    "    </transportSender>"
+
+/* Number of blocks allocated and not freed yet */
+static long outstanding = 0;
+
+static void *AXIS2_CALL
+test_malloc(
+    axutil_allocator_t * allocator,
+    size_t size)
+{
+    outstanding++;
+    return malloc(size);
+}
+
+static void *AXIS2_CALL
+test_realloc(
+    axutil_allocator_t * allocator,
+    void *ptr,
+    size_t size)
+{
+    if (!ptr)
+    {
+        outstanding++;
+    }
+    return realloc(ptr, size);
+}
+
+static void AXIS2_CALL
+test_free(
+    axutil_allocator_t * allocator,
+    void *ptr)
+{
+    if (ptr)
+    {
+        outstanding--;
+    }
+    free(ptr);
+}
+
+/* Replaces the first occurrence of from in str, which is reallocated */
+static char *
+test_replace(
+    char *str,
+    const char *from,
+    const char *to)
+{
+    char *pos = strstr(str, from);
+    char *result = NULL;
+    size_t prefix = 0;
+
+    if (!pos)
+    {
+        return str;
+    }
+    prefix = (size_t) (pos - str);
+    result = (char *) malloc(strlen(str) - strlen(from) + strlen(to) + 1);
+    memcpy(result, str, prefix);
+    strcpy(result + prefix, to);
+    strcat(result, pos + strlen(from));
+    free(str);
+    return result;
+}
+
+/* Makes a repository in dir that shares the services, modules and
+   libraries of home and has the local transport enabled */
+static int
+test_make_repo(
+    const char *home,
+    const char *dir,
+    axis2_bool_t deep_copy)
+{
+    static const char *shared[] = { "services", "modules", "lib" };
+    char path[1024];
+    char target[1024];
+    char *xml = NULL;
+    FILE *file = NULL;
+    long len = 0;
+    int i = 0;
+
+    sprintf(path, "%s/axis2.xml", home);
+    file = fopen(path, "rb");
+    if (!file)
+    {
+        printf("cannot read %s\n", path);
+        return 0;
+    }
+    fseek(file, 0, SEEK_END);
+    len = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    xml = (char *) malloc((size_t) len + 1);
+    len = (long) fread(xml, 1, (size_t) len, file);
+    xml[len] = '\0';
+    fclose(file);
+
+    xml = test_replace(xml, "<!--transportReceiver name=\"local\"/-->",
+                       "<transportReceiver name=\"local\"/>");
+    xml = test_replace(xml,
+        "<!--transportSender name=\"local\" class=\"axis2_local_sender\">",
+        "<transportSender name=\"local\" class=\"axis2_local_sender\">");
+    xml = test_replace(xml,
+        "<parameter name=\"DEEP_COPY\" locked=\"false\">false</parameter>\n"
+        "    </transportSender-->", deep_copy ? LOCAL_SENDER_COPY :
+        LOCAL_SENDER_NO_COPY);
+    if (!strstr(xml, "<transportReceiver name=\"local\"/>") ||
+        !strstr(xml, deep_copy ? LOCAL_SENDER_COPY : LOCAL_SENDER_NO_COPY))
+    {
+        printf("no local transport to enable in %s/axis2.xml\n", home);
+        free(xml);
+        return 0;
+    }
+
+    mkdir(dir, 0755);
+    sprintf(path, "%s/axis2.xml", dir);
+    file = fopen(path, "wb");
+    if (!file)
+    {
+        free(xml);
+        return 0;
+    }
+    fwrite(xml, 1, strlen(xml), file);
+    fclose(file);
+    free(xml);
+
+    for (i = 0; i < 3; i++)
+    {
+        sprintf(path, "%s/%s", dir, shared[i]);
+        sprintf(target, "%s/%s", home, shared[i]);
+        unlink(path);
+        if (symlink(target, path) != 0)
+        {
+            printf("cannot link %s\n", path);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int
+test_count(
+    const axutil_env_t * env,
+    axutil_hash_t * map)
+{
+    return map ? (int) axutil_hash_count(map) : 0;
+}
+
+/* Checks the response of the echo service */
+static int
+test_check_response(
+    const axutil_env_t * env,
+    axiom_node_t * response)
+{
+    axiom_element_t *element = NULL;
+    axiom_node_t *text_node = NULL;
+    axis2_char_t *text = NULL;
+
+    if (!response || axiom_node_get_node_type(response, env) != AXIOM_ELEMENT)
+    {
+        printf("no response element\n");
+        return 0;
+    }
+    element = (axiom_element_t *) axiom_node_get_data_element(response, env);
+    if (axutil_strcmp(axiom_element_get_localname(element, env), "echoString"))
+    {
+        printf("response element is %s\n",
+               axiom_element_get_localname(element, env));
+        return 0;
+    }
+    text_node = axiom_node_get_first_element(response, env);
+    if (text_node)
+    {
+        text = axiom_element_get_text((axiom_element_t *)
+                                      axiom_node_get_data_element(text_node,
+                                                                  env),
+                                      env, text_node);
+    }
+    if (axutil_strcmp(text, LOCAL_ECHO_TEXT))
+    {
+        printf("response text is %s\n", text ? text : "(null)");
+        return 0;
+    }
+    return 1;
+}
+
+static axiom_node_t *
+test_build_payload(
+    const axutil_env_t * env)
+{
+    axiom_namespace_t *ns = NULL;
+    axiom_element_t *element = NULL;
+    axiom_node_t *echo_node = NULL;
+    axiom_node_t *text_node = NULL;
+
+    ns = axiom_namespace_create(env, LOCAL_ECHO_NS, "ns1");
+    axiom_element_create(env, NULL, "echoString", ns, &echo_node);
+    element = axiom_element_create(env, echo_node, "text", NULL, &text_node);
+    axiom_element_set_text(element, env, LOCAL_ECHO_TEXT, text_node);
+    return echo_node;
+}
+
+static int
+test_local_transport(
+    const axutil_env_t * env,
+    const char *home,
+    axis2_bool_t deep_copy)
+{
+    const char *repo = deep_copy ? "local_repo_copy" : "local_repo";
+    axis2_conf_ctx_t *conf_ctx = NULL;
+    axis2_svc_client_t *svc_client = NULL;
+    axis2_options_t *options = NULL;
+    axis2_endpoint_ref_t *endpoint_ref = NULL;
+    axiom_node_t *response = NULL;
+    int op_ctxs = 0, svc_grp_ctxs = 0;
+    long allocated = 0;
+    int failures = 0;
+    int i = 0;
+
+    printf("Starting local transport tests, DEEP_COPY %s\n",
+           deep_copy ? "on" : "off");
+    if (!test_make_repo(home, repo, deep_copy))
+    {
+        return 1;
+    }
+    conf_ctx = axis2_build_conf_ctx(env, repo);
+    if (!conf_ctx)
+    {
+        printf("configuration of %s not built\n", repo);
+        return 1;
+    }
+    svc_client = axis2_svc_client_create_with_conf_ctx_and_svc(env, repo,
+                                                               conf_ctx, NULL);
+    if (!svc_client)
+    {
+        printf("service client not created\n");
+        axis2_conf_ctx_free(conf_ctx, env);
+        return 1;
+    }
+    options = axis2_options_create(env);
+    endpoint_ref = axis2_endpoint_ref_create(env, LOCAL_ECHO_ADDRESS);
+    axis2_options_set_to(options, env, endpoint_ref);
+    axis2_options_set_action(options, env, LOCAL_ECHO_NS "/echoString");
+    axis2_svc_client_set_options(svc_client, env, options);
+
+    for (i = 0; i < LOCAL_CALLS; i++)
+    {
+        response = axis2_svc_client_send_receive(svc_client, env,
+                                                 test_build_payload(env));
+        if (!test_check_response(env, response))
+        {
+            printf("call %d: FAILED, %s\n", i,
+                   axutil_error_get_message(env->error));
+            failures++;
+            break;
+        }
+        if (i == 1)
+        {
+            /* The first calls fill the caches of the configuration */
+            op_ctxs = test_count(env,
+                                 axis2_conf_ctx_get_op_ctx_map(conf_ctx, env));
+            svc_grp_ctxs = test_count(env,
+                axis2_conf_ctx_get_svc_grp_ctx_map(conf_ctx, env));
+            allocated = outstanding;
+        }
+    }
+
+    if (!failures)
+    {
+        /* The contexts of every served call are freed with it */
+        if (test_count(env, axis2_conf_ctx_get_op_ctx_map(conf_ctx, env)) !=
+            op_ctxs)
+        {
+            printf("FAILED, operation contexts left: %d, were %d\n",
+                   test_count(env,
+                              axis2_conf_ctx_get_op_ctx_map(conf_ctx, env)),
+                   op_ctxs);
+            failures++;
+        }
+        if (test_count(env,
+                       axis2_conf_ctx_get_svc_grp_ctx_map(conf_ctx, env)) !=
+            svc_grp_ctxs)
+        {
+            printf("FAILED, service group contexts left: %d, were %d\n",
+                   test_count(env,
+                              axis2_conf_ctx_get_svc_grp_ctx_map(conf_ctx,
+                                                                 env)),
+                   svc_grp_ctxs);
+            failures++;
+        }
+        if (outstanding != allocated)
+        {
+            printf("FAILED, %ld blocks more allocated after %d calls\n",
+                   outstanding - allocated, LOCAL_CALLS - 2);
+            failures++;
+        }
+    }
+
+    axis2_svc_client_free(svc_client, env);
+    axis2_conf_ctx_free(conf_ctx, env);
+    printf("Finished local transport tests, DEEP_COPY %s: %s\n\n",
+           deep_copy ? "on" : "off", failures ? "FAILED" : "passed");
+    return failures;
+}
+
+int
+main(
+    void)
+{
+    axutil_allocator_t *allocator = axutil_allocator_init(NULL);
+    axutil_error_t *error = NULL;
+    axutil_log_t *log = NULL;
+    axutil_env_t *env = NULL;
+    const char *home = AXIS2_GETENV("AXIS2C_HOME");
+    int failures = 0;
+
+    if (!home)
+    {
+        printf("AXIS2C_HOME is not set, the local transport is not tested\n");
+        return 0;
+    }
+
+    allocator->malloc_fn = test_malloc;
+    allocator->realloc = test_realloc;
+    allocator->free_fn = test_free;
+    error = axutil_error_create(allocator);
+    log = axutil_log_create(allocator, NULL, "test_local_transport.log");
+    env = axutil_env_create_with_error_log(allocator, error, log);
+    axutil_error_init();
+
+    failures += test_local_transport(env, home, AXIS2_FALSE);
+    failures += test_local_transport(env, home, AXIS2_TRUE);
+
+    axutil_env_free(env);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,418 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Writes TCP transport frames and reads them back through socket pairs,
+ * and reads unframed requests from a server connection.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <axutil_env.h>
+#include <axutil_string.h>
+#include <axutil_stream.h>
+#include <axis2_tcp_frame.h>
+#include <axis2_tcp_transport.h>
+#include <axis2_simple_tcp_svr_conn.h>
+
+#define TEST_BODY "<soapenv:Envelope xmlns:soapenv=" \
+    "\"http://www.w3.org/2003/05/soap-envelope\"><soapenv:Body/>" \
+    "</soapenv:Envelope>"
+
+#define TEST_PIPELINED 3
+
+static int failures = 0;
+
+static void
+check(
+    int condition,
+    const char *what)
+{
+    if (!condition)
+    {
+        printf("test_tcp_frame: %s FAILED\n", what);
+        failures++;
+    }
+}
+
+/* A socket stream to read len bytes of data from, up to the close of the
+   connection. Memory streams cannot stand in for it, as they end what they
+   read with a '\0' */
+static axutil_stream_t *
+socket_stream(
+    const axutil_env_t * env,
+    const void *data,
+    int len)
+{
+    int fds[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+    {
+        return NULL;
+    }
+    if (len > 0)
+    {
+        write(fds[0], data, len);
+    }
+    close(fds[0]);
+    return axutil_stream_create_socket(env, fds[1]);
+}
+
+static void
+socket_stream_free(
+    const axutil_env_t * env,
+    axutil_stream_t * stream)
+{
+    close(stream->socket);
+    axutil_stream_free(stream, env);
+}
+
+/* A frame read back holds what was written, small bodies and large ones,
+   which are written apart from the header */
+static void
+test_frame_round_trip(
+    const axutil_env_t * env)
+{
+    axutil_stream_t *written = axutil_stream_create_basic(env);
+    axutil_stream_t *stream = NULL;
+    axis2_tcp_frame_t *frame = NULL;
+    axis2_char_t large[10000];
+
+    memset(large, 'x', sizeof(large));
+    check(axis2_tcp_frame_write(env, written, 7,
+                                AXIS2_TCP_CONTENT_TYPE_SOAP12, "urn:echo",
+                                TEST_BODY, (int) strlen(TEST_BODY)) ==
+          AXIS2_SUCCESS, "write");
+    check(axis2_tcp_frame_write(env, written, 8, NULL, NULL, large,
+                                (int) sizeof(large)) == AXIS2_SUCCESS,
+          "write of a large body");
+    check(axis2_tcp_frame_write(env, written, 9, NULL, NULL, NULL, 0) ==
+          AXIS2_SUCCESS, "write of an empty body");
+    stream = socket_stream(env, axutil_stream_get_buffer(written, env),
+                           axutil_stream_get_len(written, env));
+    axutil_stream_free(written, env);
+
+    check(axis2_tcp_frame_read(env, stream, AXIS2_TCP_DEFAULT_MAX_FRAME_SIZE,
+                               &frame) == AXIS2_SUCCESS && frame,
+          "read");
+    if (frame)
+    {
+        check(frame->id == 7, "id");
+        check(!axutil_strcmp(frame->content_type,
+                             AXIS2_TCP_CONTENT_TYPE_SOAP12), "content type");
+        check(!axutil_strcmp(frame->action, "urn:echo"), "action");
+        check(frame->body_len == (int) strlen(TEST_BODY) &&
+              !strcmp(frame->body, TEST_BODY), "body");
+        axis2_tcp_frame_free(frame, env);
+        frame = NULL;
+    }
+
+    check(axis2_tcp_frame_read(env, stream, AXIS2_TCP_DEFAULT_MAX_FRAME_SIZE,
+                               &frame) == AXIS2_SUCCESS && frame,
+          "read of a large body");
+    if (frame)
+    {
+        check(frame->id == 8 && !frame->content_type && !frame->action,
+              "large frame without metadata");
+        check(frame->body_len == (int) sizeof(large) &&
+              !memcmp(frame->body, large, sizeof(large)) &&
+              frame->body[frame->body_len] == '\0', "large body");
+        axis2_tcp_frame_free(frame, env);
+        frame = NULL;
+    }
+
+    check(axis2_tcp_frame_read(env, stream, AXIS2_TCP_DEFAULT_MAX_FRAME_SIZE,
+                               &frame) == AXIS2_SUCCESS && frame &&
+          frame->id == 9 && frame->body_len == 0, "read of an empty body");
+    axis2_tcp_frame_free(frame, env);
+    frame = NULL;
+
+    /* nothing left: the peer closed the connection between frames */
+    check(axis2_tcp_frame_read(env, stream, AXIS2_TCP_DEFAULT_MAX_FRAME_SIZE,
+                               &frame) == AXIS2_SUCCESS && !frame,
+          "read at the end");
+    socket_stream_free(env, stream);
+    printf("test_frame_round_trip: done\n");
+}
+
+/* Metadata values with line breaks are refused, as they would add lines of
+   their own */
+static void
+test_frame_line_breaks(
+    const axutil_env_t * env)
+{
+    axutil_stream_t *stream = axutil_stream_create_basic(env);
+
+    check(axis2_tcp_frame_write(env, stream, 1, NULL,
+                                "urn:echo\r\nContent-Type: text/xml",
+                                TEST_BODY, (int) strlen(TEST_BODY)) ==
+          AXIS2_FAILURE, "action with CRLF");
+    check(axis2_tcp_frame_write(env, stream, 1, NULL, "urn:echo\n",
+                                TEST_BODY, (int) strlen(TEST_BODY)) ==
+          AXIS2_FAILURE, "action with LF");
+    check(axis2_tcp_frame_write(env, stream, 1, "text/xml\r", NULL,
+                                TEST_BODY, (int) strlen(TEST_BODY)) ==
+          AXIS2_FAILURE, "content type with CR");
+    check(axutil_stream_get_len(stream, env) == 0, "nothing written");
+    axutil_stream_free(stream, env);
+    printf("test_frame_line_breaks: done\n");
+}
+
+/* A frame cut short in its header, metadata or body fails to read */
+static void
+test_frame_truncated(
+    const axutil_env_t * env)
+{
+    axutil_stream_t *stream = axutil_stream_create_basic(env);
+    axutil_stream_t *cut = NULL;
+    axis2_tcp_frame_t *frame = NULL;
+    int len = 0;
+    int cuts[3];
+    int i = 0;
+
+    axis2_tcp_frame_write(env, stream, 1, AXIS2_TCP_CONTENT_TYPE_SOAP12,
+                          "urn:echo", TEST_BODY, (int) strlen(TEST_BODY));
+    len = axutil_stream_get_len(stream, env);
+    cuts[0] = AXIS2_TCP_FRAME_HEADER_SIZE / 2;
+    cuts[1] = AXIS2_TCP_FRAME_HEADER_SIZE + 4;
+    cuts[2] = len - 1;
+    for (i = 0; i < 3; i++)
+    {
+        cut = socket_stream(env, axutil_stream_get_buffer(stream, env),
+                            cuts[i]);
+        check(axis2_tcp_frame_read(env, cut, AXIS2_TCP_DEFAULT_MAX_FRAME_SIZE,
+                                   &frame) == AXIS2_FAILURE && !frame,
+              "read of a truncated frame");
+        socket_stream_free(env, cut);
+    }
+
+    cut = socket_stream(env, axutil_stream_get_buffer(stream, env), len);
+    check(axis2_tcp_frame_read(env, cut, AXIS2_TCP_DEFAULT_MAX_FRAME_SIZE,
+                               &frame) == AXIS2_SUCCESS && frame,
+          "read of the whole frame");
+    axis2_tcp_frame_free(frame, env);
+    socket_stream_free(env, cut);
+    axutil_stream_free(stream, env);
+    printf("test_frame_truncated: done\n");
+}
+
+/* Lengths beyond the limits fail before anything is allocated for them */
+static void
+test_frame_oversized(
+    const axutil_env_t * env)
+{
+    axutil_stream_t *written = axutil_stream_create_basic(env);
+    axutil_stream_t *stream = NULL;
+    axis2_tcp_frame_t *frame = NULL;
+    unsigned char header[AXIS2_TCP_FRAME_HEADER_SIZE];
+
+    axis2_tcp_frame_write(env, written, 1, NULL, NULL, TEST_BODY,
+                          (int) strlen(TEST_BODY));
+    stream = socket_stream(env, axutil_stream_get_buffer(written, env),
+                           axutil_stream_get_len(written, env));
+    axutil_stream_free(written, env);
+    check(axis2_tcp_frame_read(env, stream, (int) strlen(TEST_BODY) - 1,
+                               &frame) == AXIS2_FAILURE && !frame,
+          "body above the limit");
+    socket_stream_free(env, stream);
+
+    /* a body length of 0xffffffff */
+    memset(header, 0, sizeof(header));
+    header[0] = 'A';
+    header[1] = 'X';
+    header[2] = AXIS2_TCP_FRAME_VERSION;
+    memset(header + 12, 0xff, 4);
+    stream = socket_stream(env, header, sizeof(header));
+    check(axis2_tcp_frame_read(env, stream, AXIS2_TCP_DEFAULT_MAX_FRAME_SIZE,
+                               &frame) == AXIS2_FAILURE && !frame,
+          "largest body length");
+    socket_stream_free(env, stream);
+
+    /* metadata past its limit */
+    memset(header + 8, 0, 8);
+    header[9] = 0x01;
+    stream = socket_stream(env, header, sizeof(header));
+    check(axis2_tcp_frame_read(env, stream, AXIS2_TCP_DEFAULT_MAX_FRAME_SIZE,
+                               &frame) == AXIS2_FAILURE && !frame,
+          "metadata above the limit");
+    socket_stream_free(env, stream);
+
+    /* not a frame at all */
+    stream = socket_stream(env, TEST_BODY, (int) strlen(TEST_BODY));
+    check(axis2_tcp_frame_read(env, stream, AXIS2_TCP_DEFAULT_MAX_FRAME_SIZE,
+                               &frame) == AXIS2_FAILURE && !frame,
+          "unframed data");
+    socket_stream_free(env, stream);
+    printf("test_frame_oversized: done\n");
+}
+
+/* Requests sent one after the other on a connection are read in order and
+   answered out of order, the replies matched by their ids */
+static void
+test_frame_pipelined(
+    const axutil_env_t * env)
+{
+    int fds[2];
+    axutil_stream_t *client = NULL;
+    axis2_simple_tcp_svr_conn_t *svr_conn = NULL;
+    axis2_tcp_frame_t *frame = NULL;
+    axis2_char_t action[32];
+    axis2_char_t body[32];
+    unsigned int ids[TEST_PIPELINED];
+    int i = 0;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+    {
+        check(0, "socketpair");
+        return;
+    }
+    client = axutil_stream_create_socket(env, fds[0]);
+    svr_conn = axis2_simple_tcp_svr_conn_create(env, fds[1]);
+
+    for (i = 0; i < TEST_PIPELINED; i++)
+    {
+        sprintf(action, "urn:request%d", i);
+        sprintf(body, "<request%d/>", i);
+        check(axis2_tcp_frame_write(env, client, 100 + i, NULL, action, body,
+                                    (int) strlen(body)) == AXIS2_SUCCESS,
+              "pipelined write");
+    }
+
+    for (i = 0; i < TEST_PIPELINED; i++)
+    {
+        check(axis2_simple_tcp_svr_conn_read_frame(svr_conn, env,
+                                                   AXIS2_TCP_DEFAULT_MAX_FRAME_SIZE,
+                                                   &frame) == AXIS2_SUCCESS &&
+              frame, "pipelined read");
+        if (!frame)
+        {
+            break;
+        }
+        sprintf(action, "urn:request%d", i);
+        check(frame->id == (unsigned int) (100 + i) &&
+              !axutil_strcmp(frame->action, action), "requests in order");
+        ids[i] = frame->id;
+        axis2_tcp_frame_free(frame, env);
+        frame = NULL;
+    }
+
+    for (i = TEST_PIPELINED - 1; i >= 0; i--)
+    {
+        sprintf(body, "<reply%u/>", ids[i]);
+        check(axis2_simple_tcp_svr_conn_write_frame(svr_conn, env, ids[i],
+                                                    AXIS2_TCP_CONTENT_TYPE_SOAP12,
+                                                    body, (int) strlen(body))
+              == AXIS2_SUCCESS, "reply write");
+    }
+
+    for (i = TEST_PIPELINED - 1; i >= 0; i--)
+    {
+        check(axis2_tcp_frame_read(env, client,
+                                   AXIS2_TCP_DEFAULT_MAX_FRAME_SIZE,
+                                   &frame) == AXIS2_SUCCESS && frame,
+              "reply read");
+        if (!frame)
+        {
+            break;
+        }
+        sprintf(body, "<reply%u/>", frame->id);
+        check(frame->id == ids[i] && !strcmp(frame->body, body),
+              "reply matches its request");
+        axis2_tcp_frame_free(frame, env);
+        frame = NULL;
+    }
+
+    /* the client closing ends the requests */
+    axutil_stream_free(client, env);
+    close(fds[0]);
+    check(axis2_simple_tcp_svr_conn_read_frame(svr_conn, env,
+                                               AXIS2_TCP_DEFAULT_MAX_FRAME_SIZE,
+                                               &frame) == AXIS2_SUCCESS &&
+          !frame, "read after the close");
+    axis2_simple_tcp_svr_conn_free(svr_conn, env);
+    printf("test_frame_pipelined: done\n");
+}
+
+/* Without framing a request runs to the empty line after it */
+static void
+test_unframed_request(
+    const axutil_env_t * env)
+{
+    int fds[2];
+    axis2_simple_tcp_svr_conn_t *svr_conn = NULL;
+    axis2_tcp_frame_t *frame = NULL;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+    {
+        check(0, "socketpair");
+        return;
+    }
+    svr_conn = axis2_simple_tcp_svr_conn_create(env, fds[1]);
+    write(fds[0], TEST_BODY, strlen(TEST_BODY));
+    write(fds[0], "\r\n\r\n", 4);
+    check(axis2_simple_tcp_svr_conn_read_request(svr_conn, env,
+                                                 AXIS2_TCP_DEFAULT_MAX_FRAME_SIZE,
+                                                 &frame) == AXIS2_SUCCESS &&
+          frame, "unframed read");
+    if (frame)
+    {
+        check(frame->id == 0 && !frame->content_type && !frame->action,
+              "unframed request without metadata");
+        check(frame->body_len == (int) strlen(TEST_BODY) &&
+              !strcmp(frame->body, TEST_BODY), "unframed body");
+        axis2_tcp_frame_free(frame, env);
+        frame = NULL;
+    }
+    axis2_simple_tcp_svr_conn_free(svr_conn, env);
+    close(fds[0]);
+
+    /* a request longer than the limit */
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+    {
+        check(0, "socketpair");
+        return;
+    }
+    svr_conn = axis2_simple_tcp_svr_conn_create(env, fds[1]);
+    write(fds[0], TEST_BODY, strlen(TEST_BODY));
+    write(fds[0], "\r\n\r\n", 4);
+    check(axis2_simple_tcp_svr_conn_read_request(svr_conn, env, 16, &frame) ==
+          AXIS2_FAILURE && !frame, "unframed request above the limit");
+    axis2_simple_tcp_svr_conn_free(svr_conn, env);
+    close(fds[0]);
+    printf("test_unframed_request: done\n");
+}
+
+int
+main(
+    )
+{
+    axutil_env_t *env = NULL;
+
+    env = axutil_env_create_all("test_tcp_frame.log", AXIS2_LOG_LEVEL_INFO);
+    test_frame_round_trip(env);
+    test_frame_line_breaks(env);
+    test_frame_truncated(env);
+    test_frame_oversized(env);
+    test_frame_pipelined(env);
+    test_unframed_request(env);
+    axutil_env_free(env);
+
+    return failures ? 1 : 0;
+}
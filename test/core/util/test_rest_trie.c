@@ -0,0 +1,399 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Dispatches REST locations through the routing trie of a service and
+ * through the rest map, matched level by level as it was before the trie,
+ * and checks both against the expected operations and parameters.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <axutil_env.h>
+#include <axutil_allocator.h>
+#include <axutil_error_default.h>
+#include <axutil_log_default.h>
+#include <axutil_qname.h>
+#include <axutil_array_list.h>
+#include <axis2_op.h>
+#include <axis2_svc.h>
+#include <axis2_core_utils.h>
+
+typedef struct test_rest_template
+{
+    const char *method;
+    const char *location;
+    const char *op_name;
+} test_rest_template_t;
+
+typedef struct test_rest_request
+{
+    const char *method;
+    const char *location;
+    /* NULL when no template matches */
+    const char *op_name;
+    /* parameter names and values, in template order */
+    const char *params[7];
+} test_rest_request_t;
+
+static const test_rest_template_t templates[] = {
+    {"GET", "students", "listStudents"},
+    {"GET", "students/{name}", "getStudent"},
+    {"GET", "students/all", "allStudents"},
+    {"GET", "students/{name}/marks/{subject}", "getMark"},
+    {"GET", "students/{name}/marks/all", "allMarks"},
+    {"POST", "students/{name}", "addStudent"},
+    {"DELETE", "/students/{name}/marks/{subject}", "deleteMark"},
+    {"GET", "files/{name}.{ext}", "getFile"},
+    {"GET", "reports/report-{year}-{month}.pdf", "getReport"},
+    {"GET", "{course}/info", "getInfo"},
+    {"GET", "search?q={query}", "search"}
+};
+
+static const test_rest_request_t requests[] = {
+    /* constants */
+    {"GET", "/students", "listStudents", {NULL}},
+    {"GET", "students", "listStudents", {NULL}},
+    /* a constant segment is chosen over a parameter segment */
+    {"GET", "/students/all", "allStudents", {NULL}},
+    {"GET", "/students/john/marks/all", "allMarks", {"name", "john", NULL}},
+    {"GET", "/students/info", "getStudent", {"name", "info", NULL}},
+    /* parameters */
+    {"GET", "/students/john", "getStudent", {"name", "john", NULL}},
+    /* parameters of the query follow those of the path */
+    {"GET", "/students/john?verbose=1", "getStudent",
+     {"name", "john", "verbose", "1", NULL}},
+    {"GET", "/students/john/marks/maths", "getMark",
+     {"name", "john", "subject", "maths", NULL}},
+    {"GET", "/courses/info", "getInfo", {"course", "courses", NULL}},
+    {"GET", "/search", "search", {NULL}},
+    /* the method selects the template */
+    {"POST", "/students/john", "addStudent", {"name", "john", NULL}},
+    {"DELETE", "/students/john/marks/maths", "deleteMark",
+     {"name", "john", "subject", "maths", NULL}},
+    /* constants and parameters mixed in a segment */
+    {"GET", "/files/notes.txt", "getFile",
+     {"name", "notes", "ext", "txt", NULL}},
+    {"GET", "/files/archive.tar.gz", "getFile",
+     {"name", "archive", "ext", "tar.gz", NULL}},
+    {"GET", "/reports/report-2009-05.pdf", "getReport",
+     {"year", "2009", "month", "05", NULL}},
+    /* no template matches */
+    {"GET", "/teachers", NULL, {NULL}},
+    {"GET", "/students/john/grades", NULL, {NULL}},
+    {"GET", "/students/john/marks", NULL, {NULL}},
+    {"GET", "/students/john/marks/maths/final", NULL, {NULL}},
+    {"GET", "/files/notes", NULL, {NULL}},
+    {"GET", "/reports/summary-2009-05.pdf", NULL, {NULL}},
+    {"GET", "/reports/report-2009-05.txt", NULL, {NULL}},
+    {"PUT", "/students/john", NULL, {NULL}},
+    {"DELETE", "/students/john", NULL, {NULL}}
+};
+
+#define TEST_N_TEMPLATES ((int) (sizeof(templates) / sizeof(templates[0])))
+#define TEST_N_REQUESTS ((int) (sizeof(requests) / sizeof(requests[0])))
+
+static int failures = 0;
+
+static const axis2_char_t *
+test_op_name(
+    const axutil_env_t * env,
+    axis2_op_t * op)
+{
+    const axutil_qname_t *qname = op ? axis2_op_get_qname(op, env) : NULL;
+
+    return qname ? axutil_qname_get_localpart(qname, env) : NULL;
+}
+
+static void
+test_free_list(
+    const axutil_env_t * env,
+    axutil_array_list_t * list)
+{
+    int i = 0;
+
+    for (i = 0; i < axutil_array_list_size(list, env); i++)
+    {
+        AXIS2_FREE(env->allocator, axutil_array_list_get(list, env, i));
+    }
+    axutil_array_list_free(list, env);
+}
+
+/* Dispatches a request through svc and checks the operation and the
+   parameters found, which are left in keys and values */
+static axis2_op_t *
+test_dispatch(
+    const axutil_env_t * env,
+    axis2_svc_t * svc,
+    const char *how,
+    const test_rest_request_t * request,
+    axutil_array_list_t * keys,
+    axutil_array_list_t * values)
+{
+    axis2_op_t *op = NULL;
+    const axis2_char_t *op_name = NULL;
+    int n_params = 0;
+    int i = 0;
+
+    op = axis2_core_utils_get_rest_op_with_method_and_location(svc, env,
+        request->method, request->location, keys, values);
+    op_name = test_op_name(env, op);
+    if (op_name != request->op_name &&
+        (!op_name || !request->op_name || strcmp(op_name, request->op_name)))
+    {
+        printf("%s %s %s: FAILED, dispatched to %s, expected %s\n", how,
+               request->method, request->location,
+               op_name ? op_name : "no operation",
+               request->op_name ? request->op_name : "no operation");
+        failures++;
+        return op;
+    }
+    if (!op)
+    {
+        return op;
+    }
+
+    while (request->params[2 * n_params])
+    {
+        n_params++;
+    }
+    if (axutil_array_list_size(keys, env) != n_params ||
+        axutil_array_list_size(values, env) != n_params)
+    {
+        printf("%s %s %s: FAILED, %d parameters, expected %d\n", how,
+               request->method, request->location,
+               axutil_array_list_size(keys, env), n_params);
+        failures++;
+        return op;
+    }
+    for (i = 0; i < n_params; i++)
+    {
+        const axis2_char_t *key = axutil_array_list_get(keys, env, i);
+        const axis2_char_t *value = axutil_array_list_get(values, env, i);
+
+        if (axutil_strcmp(key, request->params[2 * i]) ||
+            axutil_strcmp(value, request->params[2 * i + 1]))
+        {
+            printf("%s %s %s: FAILED, parameter %s=%s, expected %s=%s\n",
+                   how, request->method, request->location, key, value,
+                   request->params[2 * i], request->params[2 * i + 1]);
+            failures++;
+        }
+    }
+    return op;
+}
+
+/* Checks that the trie and the rest map find the same operation and the
+   same parameters */
+static void
+test_compare(
+    const axutil_env_t * env,
+    const test_rest_request_t * request,
+    axis2_op_t * trie_op,
+    axutil_array_list_t * trie_keys,
+    axutil_array_list_t * trie_values,
+    axis2_op_t * map_op,
+    axutil_array_list_t * map_keys,
+    axutil_array_list_t * map_values)
+{
+    int i = 0;
+
+    if (trie_op != map_op)
+    {
+        printf("%s %s: FAILED, trie found %s, rest map found %s\n",
+               request->method, request->location,
+               trie_op ? test_op_name(env, trie_op) : "no operation",
+               map_op ? test_op_name(env, map_op) : "no operation");
+        failures++;
+        return;
+    }
+    if (!trie_op)
+    {
+        return;
+    }
+    if (axutil_array_list_size(trie_keys, env) !=
+        axutil_array_list_size(map_keys, env))
+    {
+        printf("%s %s: FAILED, trie found %d parameters, rest map %d\n",
+               request->method, request->location,
+               axutil_array_list_size(trie_keys, env),
+               axutil_array_list_size(map_keys, env));
+        failures++;
+        return;
+    }
+    for (i = 0; i < axutil_array_list_size(trie_keys, env); i++)
+    {
+        if (axutil_strcmp(axutil_array_list_get(trie_keys, env, i),
+                          axutil_array_list_get(map_keys, env, i)) ||
+            axutil_strcmp(axutil_array_list_get(trie_values, env, i),
+                          axutil_array_list_get(map_values, env, i)))
+        {
+            printf("%s %s: FAILED, parameter %d differs, trie %s=%s, "
+                   "rest map %s=%s\n", request->method, request->location, i,
+                   (char *) axutil_array_list_get(trie_keys, env, i),
+                   (char *) axutil_array_list_get(trie_values, env, i),
+                   (char *) axutil_array_list_get(map_keys, env, i),
+                   (char *) axutil_array_list_get(map_values, env, i));
+            failures++;
+        }
+    }
+}
+
+static void
+test_rest_dispatch(
+    const axutil_env_t * env)
+{
+    axis2_op_t *ops[TEST_N_TEMPLATES];
+    axis2_svc_t *trie_svc = NULL;
+    axis2_svc_t *map_svc = NULL;
+    axis2_char_t buffer[256];
+    int i = 0;
+
+    printf("testing REST dispatching through the routing trie\n");
+
+    /* one service with the trie, as deployed, and one with only the rest
+       map, filled in directly */
+    trie_svc = axis2_svc_create(env);
+    map_svc = axis2_svc_create(env);
+    for (i = 0; i < TEST_N_TEMPLATES; i++)
+    {
+        axutil_qname_t *qname =
+            axutil_qname_create(env, templates[i].op_name, NULL, NULL);
+
+        ops[i] = axis2_op_create_with_qname(env, qname);
+        axutil_qname_free(qname, env);
+
+        /* the location is cut at '?' while it is added */
+        strcpy(buffer, templates[i].location);
+        if (axis2_svc_add_rest_mapping(trie_svc, env, templates[i].method,
+                                       buffer, ops[i]) != AXIS2_SUCCESS)
+        {
+            printf("%s %s: FAILED, not added\n", templates[i].method,
+                   templates[i].location);
+            failures++;
+        }
+
+        sprintf(buffer, "%s:%s", templates[i].method,
+                templates[i].location + (*templates[i].location == '/'));
+        if (strchr(buffer, '?'))
+        {
+            *strchr(buffer, '?') = '\0';
+        }
+        axis2_core_utils_prepare_rest_mapping(env, buffer,
+                                              axis2_svc_get_rest_map(map_svc,
+                                                                     env),
+                                              ops[i]);
+    }
+    if (!axis2_svc_get_rest_trie(trie_svc, env) ||
+        axis2_svc_get_rest_trie(map_svc, env))
+    {
+        printf("FAILED, the trie is not built for deployed mappings only\n");
+        failures++;
+    }
+
+    for (i = 0; i < TEST_N_REQUESTS; i++)
+    {
+        axutil_array_list_t *trie_keys = axutil_array_list_create(env, 4);
+        axutil_array_list_t *trie_values = axutil_array_list_create(env, 4);
+        axutil_array_list_t *map_keys = axutil_array_list_create(env, 4);
+        axutil_array_list_t *map_values = axutil_array_list_create(env, 4);
+        axis2_op_t *trie_op = NULL;
+        axis2_op_t *map_op = NULL;
+
+        trie_op = test_dispatch(env, trie_svc, "trie", &requests[i],
+                                trie_keys, trie_values);
+        map_op = test_dispatch(env, map_svc, "rest map", &requests[i],
+                               map_keys, map_values);
+        test_compare(env, &requests[i], trie_op, trie_keys, trie_values,
+                     map_op, map_keys, map_values);
+
+        test_free_list(env, trie_keys);
+        test_free_list(env, trie_values);
+        test_free_list(env, map_keys);
+        test_free_list(env, map_values);
+    }
+
+    axis2_svc_free(trie_svc, env);
+    axis2_svc_free(map_svc, env);
+    for (i = 0; i < TEST_N_TEMPLATES; i++)
+    {
+        axis2_op_free(ops[i], env);
+    }
+}
+
+/* Templates the trie does not take */
+static void
+test_rest_trie_add_invalid(
+    const axutil_env_t * env)
+{
+    static const char *invalid[] = {
+        "students/{}", "students/{name", "students/name}",
+        "students/{first}{last}", "students/{a{b}}"
+    };
+    axis2_core_utils_rest_trie_t *trie = NULL;
+    axis2_op_t *op = axis2_op_create(env);
+    int i = 0;
+
+    printf("testing malformed REST location templates\n");
+
+    trie = axis2_core_utils_rest_trie_create(env);
+    if (axis2_core_utils_rest_trie_add(trie, env, "GET", "students/{name}", op)
+        != AXIS2_SUCCESS)
+    {
+        printf("students/{name}: FAILED, not added\n");
+        failures++;
+    }
+    if (axis2_core_utils_rest_trie_add(trie, env, "GET", "students/{name}", op)
+        == AXIS2_SUCCESS)
+    {
+        printf("students/{name}: FAILED, added twice\n");
+        failures++;
+    }
+    for (i = 0; i < (int) (sizeof(invalid) / sizeof(invalid[0])); i++)
+    {
+        if (axis2_core_utils_rest_trie_add(trie, env, "GET", invalid[i], op) ==
+            AXIS2_SUCCESS)
+        {
+            printf("%s: FAILED, added\n", invalid[i]);
+            failures++;
+        }
+    }
+    axis2_core_utils_rest_trie_free(trie, env);
+    axis2_op_free(op, env);
+}
+
+int
+main(
+    void)
+{
+    axutil_allocator_t *allocator = axutil_allocator_init(NULL);
+    axutil_error_t *error = axutil_error_create(allocator);
+    axutil_log_t *log = axutil_log_create(allocator, NULL, "test_rest_trie.log");
+    axutil_env_t *env = axutil_env_create_with_error_log(allocator, error, log);
+
+    test_rest_dispatch(env);
+    test_rest_trie_add_invalid(env);
+
+    axutil_env_free(env);
+    if (failures)
+    {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,442 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Drives the in handler of mod_log with message contexts of a bare
+ * configuration and checks what it logs through a log of its own.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <axutil_env.h>
+#include <axutil_log.h>
+#include <axutil_string.h>
+#include <axutil_property.h>
+#include <axutil_param.h>
+#include <axutil_qname.h>
+#include <axiom_soap.h>
+#include <axis2_const.h>
+#include <axis2_conf.h>
+#include <axis2_conf_ctx.h>
+#include <axis2_msg_ctx.h>
+#include <axis2_op_ctx.h>
+#include <axis2_op.h>
+#include <axis2_svc.h>
+#include <axis2_module.h>
+#include <axis2_module_desc.h>
+#include <axis2_handler.h>
+#include "mod_log.h"
+
+#define TEST_TEXT "0123456789012345678901234567890123456789"
+
+#define TEST_REQUEST "<soapenv:Envelope xmlns:soapenv=" \
+    "\"http://www.w3.org/2003/05/soap-envelope\"><soapenv:Body>" \
+    "<t:echo xmlns:t=\"urn:test\">" TEST_TEXT "</t:echo>" \
+    "</soapenv:Body></soapenv:Envelope>"
+
+#define TEST_INPUT "Input message: "
+
+/* Entry points of the module library, as the module loader finds them */
+AXIS2_EXPORT int axis2_get_instance(
+    axis2_module_t ** inst,
+    const axutil_env_t * env);
+
+AXIS2_EXPORT int axis2_remove_instance(
+    axis2_module_t * inst,
+    const axutil_env_t * env);
+
+static int failures = 0;
+
+/* Messages logged, and the last of them */
+static int logged = 0;
+static char last_logged[4096];
+
+static void
+check(
+    int condition,
+    const char *what)
+{
+    if (!condition)
+    {
+        printf("test_mod_log: %s FAILED\n", what);
+        failures++;
+    }
+}
+
+static void AXIS2_CALL
+capture_free(
+    axutil_allocator_t * allocator,
+    axutil_log_t * log)
+{
+}
+
+static void AXIS2_CALL
+capture_write(
+    axutil_log_t * log,
+    const axis2_char_t * buffer,
+    axutil_log_levels_t level,
+    const axis2_char_t * file,
+    const int line)
+{
+    if (!strncmp(buffer, TEST_INPUT, strlen(TEST_INPUT)))
+    {
+        logged++;
+        strncpy(last_logged, buffer, sizeof(last_logged) - 1);
+        last_logged[sizeof(last_logged) - 1] = '\0';
+    }
+}
+
+static const axutil_log_ops_t capture_ops = {
+    capture_free,
+    capture_write
+};
+
+/* A configuration context with the module initialized from the given
+   module.xml parameters */
+static axis2_conf_ctx_t *
+create_conf_ctx(
+    const axutil_env_t * env,
+    axis2_module_t * module,
+    const char *sample_rate,
+    const char *max_size,
+    const char *tee)
+{
+    axis2_conf_ctx_t *conf_ctx = NULL;
+    axis2_module_desc_t *module_desc = NULL;
+
+    conf_ctx = axis2_conf_ctx_create(env, axis2_conf_create(env));
+    module_desc = axis2_module_desc_create(env);
+    axis2_module_desc_add_param(module_desc, env,
+                                axutil_param_create(env,
+                                                    AXIS2_MOD_LOG_SAMPLE_RATE,
+                                                    axutil_strdup(env,
+                                                                  sample_rate)));
+    axis2_module_desc_add_param(module_desc, env,
+                                axutil_param_create(env,
+                                                    AXIS2_MOD_LOG_MAX_SIZE,
+                                                    axutil_strdup(env,
+                                                                  max_size)));
+    axis2_module_desc_add_param(module_desc, env,
+                                axutil_param_create(env, AXIS2_MOD_LOG_TEE,
+                                                    axutil_strdup(env, tee)));
+    check(module->ops->init(module, env, conf_ctx, module_desc) ==
+          AXIS2_SUCCESS, "module init");
+    axis2_module_desc_free(module_desc, env);
+    return conf_ctx;
+}
+
+/* An in message context of op, in an exchange of its own unless op_ctx is
+   given, carrying a request read up to its body, or read completely when
+   built is set */
+static axis2_msg_ctx_t *
+create_msg_ctx(
+    const axutil_env_t * env,
+    axis2_conf_ctx_t * conf_ctx,
+    axis2_svc_t * svc,
+    axis2_op_t * op,
+    axis2_op_ctx_t * op_ctx,
+    axis2_bool_t built)
+{
+    axis2_msg_ctx_t *msg_ctx = NULL;
+    axiom_xml_reader_t *reader = NULL;
+    axiom_soap_builder_t *soap_builder = NULL;
+    axiom_soap_envelope_t *envelope = NULL;
+    axiom_node_t *envelope_node = NULL;
+
+    msg_ctx = axis2_msg_ctx_create(env, conf_ctx, NULL, NULL);
+    axis2_msg_ctx_set_svc(msg_ctx, env, svc);
+    axis2_msg_ctx_set_op(msg_ctx, env, op);
+    axis2_msg_ctx_set_op_ctx(msg_ctx, env, op_ctx ? op_ctx :
+                             axis2_op_ctx_create(env, op, NULL));
+
+    reader = axiom_xml_reader_create_for_memory(env, TEST_REQUEST,
+                                                (int) strlen(TEST_REQUEST),
+                                                NULL,
+                                                AXIS2_XML_PARSER_TYPE_BUFFER);
+    soap_builder =
+        axiom_soap_builder_create(env, axiom_stax_builder_create(env, reader),
+                                  AXIOM_SOAP12_SOAP_ENVELOPE_NAMESPACE_URI);
+    envelope = axiom_soap_builder_get_soap_envelope(soap_builder, env);
+    envelope_node = axiom_soap_envelope_get_base_node(envelope, env);
+    while (built && !axiom_node_is_complete(envelope_node, env) &&
+           axiom_soap_builder_next(soap_builder, env) == AXIS2_SUCCESS)
+    {
+    }
+    axis2_msg_ctx_set_soap_envelope(msg_ctx, env, envelope);
+    return msg_ctx;
+}
+
+static void
+free_msg_ctx(
+    const axutil_env_t * env,
+    axis2_msg_ctx_t * msg_ctx,
+    axis2_bool_t free_op_ctx)
+{
+    axis2_op_ctx_t *op_ctx = axis2_msg_ctx_get_op_ctx(msg_ctx, env);
+
+    axis2_msg_ctx_free(msg_ctx, env);
+    if (free_op_ctx)
+    {
+        axis2_op_ctx_free(op_ctx, env);
+    }
+}
+
+static axis2_handler_t *
+create_in_handler(
+    const axutil_env_t * env,
+    axis2_module_t * module)
+{
+    AXIS2_HANDLER_CREATE_FUNC create = NULL;
+
+    create = (AXIS2_HANDLER_CREATE_FUNC)
+        axutil_hash_get(module->handler_create_func_map, "LoggingInHandler",
+                        AXIS2_HASH_KEY_STRING);
+    return create ? create(env, NULL) : NULL;
+}
+
+/* Invokes the handler on a new exchange of op and tells whether it logged
+   the request */
+static axis2_bool_t
+invoke_logs(
+    const axutil_env_t * env,
+    axis2_handler_t * handler,
+    axis2_conf_ctx_t * conf_ctx,
+    axis2_svc_t * svc,
+    axis2_op_t * op)
+{
+    axis2_msg_ctx_t *msg_ctx = NULL;
+    int before = logged;
+
+    msg_ctx = create_msg_ctx(env, conf_ctx, svc, op, NULL, AXIS2_TRUE);
+    axis2_handler_invoke(handler, env, msg_ctx);
+    free_msg_ctx(env, msg_ctx, AXIS2_TRUE);
+    return logged > before;
+}
+
+/* One exchange in logSampleRate is logged, counted per operation name, and
+   the messages of an exchange are all logged or skipped together */
+static void
+test_mod_log_sampling(
+    const axutil_env_t * env,
+    axis2_module_t * module,
+    axis2_handler_t * handler)
+{
+    axis2_conf_ctx_t *conf_ctx = NULL;
+    axutil_qname_t *qname = NULL;
+    axis2_svc_t *svc = NULL;
+    axis2_op_t *op = NULL;
+    axis2_op_t *reloaded = NULL;
+    axis2_op_t *other = NULL;
+    axis2_msg_ctx_t *msg_ctx = NULL;
+    axis2_op_ctx_t *op_ctx = NULL;
+    int i = 0;
+    int count = 0;
+
+    conf_ctx = create_conf_ctx(env, module, "3", "0", "false");
+    qname = axutil_qname_create(env, "test_svc", NULL, NULL);
+    svc = axis2_svc_create_with_qname(env, qname);
+    axutil_qname_free(qname, env);
+    qname = axutil_qname_create(env, "echo", NULL, NULL);
+    op = axis2_op_create_with_qname(env, qname);
+    reloaded = axis2_op_create_with_qname(env, qname);
+    axutil_qname_free(qname, env);
+    qname = axutil_qname_create(env, "ping", NULL, NULL);
+    other = axis2_op_create_with_qname(env, qname);
+    axutil_qname_free(qname, env);
+
+    check(invoke_logs(env, handler, conf_ctx, svc, op), "first sampled");
+    check(!invoke_logs(env, handler, conf_ctx, svc, op), "second skipped");
+    check(!invoke_logs(env, handler, conf_ctx, svc, op), "third skipped");
+    check(invoke_logs(env, handler, conf_ctx, svc, op), "fourth sampled");
+    for (i = 0; i < 6; i++)
+    {
+        count += invoke_logs(env, handler, conf_ctx, svc, op) ? 1 : 0;
+    }
+    check(count == 2, "one in three sampled");
+
+    /* an operation of the same name, as after a reload, keeps the count */
+    check(!invoke_logs(env, handler, conf_ctx, svc, reloaded),
+          "count kept for the same name");
+    check(!invoke_logs(env, handler, conf_ctx, svc, reloaded),
+          "count kept for the same name, next");
+    check(invoke_logs(env, handler, conf_ctx, svc, reloaded),
+          "sampled for the same name");
+    /* another operation has a count of its own */
+    check(invoke_logs(env, handler, conf_ctx, svc, other),
+          "other operation counted apart");
+
+    /* the exchange sampled out above stays out for its other messages */
+    check(!invoke_logs(env, handler, conf_ctx, svc, op), "skipped exchange");
+    msg_ctx = create_msg_ctx(env, conf_ctx, svc, op, NULL, AXIS2_TRUE);
+    op_ctx = axis2_msg_ctx_get_op_ctx(msg_ctx, env);
+    count = logged;
+    axis2_handler_invoke(handler, env, msg_ctx);
+    free_msg_ctx(env, msg_ctx, AXIS2_FALSE);
+    msg_ctx = create_msg_ctx(env, conf_ctx, svc, op, op_ctx, AXIS2_TRUE);
+    axis2_handler_invoke(handler, env, msg_ctx);
+    free_msg_ctx(env, msg_ctx, AXIS2_TRUE);
+    check(logged == count, "exchange skipped as a whole");
+
+    axis2_op_free(op, env);
+    axis2_op_free(reloaded, env);
+    axis2_op_free(other, env);
+    axis2_svc_free(svc, env);
+    axis2_conf_ctx_free(conf_ctx, env);
+    printf("test_mod_log_sampling: done\n");
+}
+
+/* Messages are cut at logMaxSize bytes, and bodies not read yet are not
+   built for the log */
+static void
+test_mod_log_max_size(
+    const axutil_env_t * env,
+    axis2_module_t * module,
+    axis2_handler_t * handler)
+{
+    axis2_conf_ctx_t *conf_ctx = NULL;
+    axis2_msg_ctx_t *msg_ctx = NULL;
+    axiom_node_t *body_node = NULL;
+    axutil_qname_t *qname = NULL;
+    axis2_op_t *op = NULL;
+
+    qname = axutil_qname_create(env, "echo", NULL, NULL);
+    op = axis2_op_create_with_qname(env, qname);
+    axutil_qname_free(qname, env);
+
+    conf_ctx = create_conf_ctx(env, module, "1", "20", "false");
+    check(invoke_logs(env, handler, conf_ctx, NULL, op), "logged");
+    check(strlen(last_logged) > strlen(TEST_INPUT) + 20 &&
+          strstr(last_logged + strlen(TEST_INPUT) + 20, " ... (") ==
+          last_logged + strlen(TEST_INPUT) + 20 &&
+          strstr(last_logged, "more bytes)") != NULL, "cut at the limit");
+    check(strstr(last_logged, TEST_TEXT) == NULL, "text cut off");
+    axis2_conf_ctx_free(conf_ctx, env);
+
+    conf_ctx = create_conf_ctx(env, module, "1", "0", "false");
+    check(invoke_logs(env, handler, conf_ctx, NULL, op), "logged whole");
+    check(strstr(last_logged, TEST_TEXT) != NULL &&
+          strstr(last_logged, "more bytes)") == NULL, "not cut");
+
+    /* a body not read yet is left to the service */
+    msg_ctx = create_msg_ctx(env, conf_ctx, NULL, op, NULL, AXIS2_FALSE);
+    axis2_handler_invoke(handler, env, msg_ctx);
+    check(strstr(last_logged, "body not built, first body element echo") !=
+          NULL, "unbuilt body named");
+    body_node = axiom_soap_body_get_base_node(axiom_soap_envelope_get_body
+                                              (axis2_msg_ctx_get_soap_envelope
+                                               (msg_ctx, env), env), env);
+    check(!axiom_node_is_complete(body_node, env), "body left unbuilt");
+    free_msg_ctx(env, msg_ctx, AXIS2_TRUE);
+    axis2_conf_ctx_free(conf_ctx, env);
+
+    axis2_op_free(op, env);
+    printf("test_mod_log_max_size: done\n");
+}
+
+/* With logTee the transport is asked for the bytes it kept, up to
+   logMaxSize, instead of the envelope being serialized */
+static void
+test_mod_log_tee(
+    const axutil_env_t * env,
+    axis2_module_t * module,
+    axis2_handler_t * handler)
+{
+    axis2_conf_ctx_t *conf_ctx = NULL;
+    axis2_msg_ctx_t *msg_ctx = NULL;
+    axutil_property_t *property = NULL;
+    axutil_stream_t *tee_data = NULL;
+    axutil_qname_t *qname = NULL;
+    axis2_op_t *op = NULL;
+    int before = 0;
+
+    qname = axutil_qname_create(env, "echo", NULL, NULL);
+    op = axis2_op_create_with_qname(env, qname);
+    axutil_qname_free(qname, env);
+
+    conf_ctx = create_conf_ctx(env, module, "1", "20", "true");
+    property = axis2_conf_ctx_get_property(conf_ctx, env,
+                                           AXIS2_TRANSPORT_TEE_IN);
+    check(property && !axutil_strcmp(axutil_property_get_value(property, env),
+                                     "20"), "transport asked to keep bytes");
+
+    msg_ctx = create_msg_ctx(env, conf_ctx, NULL, op, NULL, AXIS2_TRUE);
+    tee_data = axutil_stream_create_basic(env);
+    property = axutil_property_create_with_args(env, AXIS2_SCOPE_REQUEST,
+                                                AXIS2_TRUE, NULL, tee_data);
+    axis2_msg_ctx_set_property(msg_ctx, env, AXIS2_TRANSPORT_TEE_DATA,
+                               property);
+    before = logged;
+    axis2_handler_invoke(handler, env, msg_ctx);
+    check(logged == before, "envelope not serialized");
+    property = axis2_msg_ctx_get_property(msg_ctx, env,
+                                          AXIS2_TRANSPORT_TEE_LOG);
+    check(property && !axutil_strcmp(axutil_property_get_value(property, env),
+                                     "20"), "transport asked to log");
+    axis2_msg_ctx_set_property(msg_ctx, env, AXIS2_TRANSPORT_TEE_DATA, NULL);
+    axutil_stream_free(tee_data, env);
+    free_msg_ctx(env, msg_ctx, AXIS2_TRUE);
+
+    /* nothing kept by the transport: the envelope is logged */
+    check(invoke_logs(env, handler, conf_ctx, NULL, op),
+          "logged without transport bytes");
+    axis2_conf_ctx_free(conf_ctx, env);
+
+    conf_ctx = create_conf_ctx(env, module, "1", "0", "false");
+    check(!axis2_conf_ctx_get_property(conf_ctx, env, AXIS2_TRANSPORT_TEE_IN),
+          "no bytes kept without logTee");
+    axis2_conf_ctx_free(conf_ctx, env);
+
+    axis2_op_free(op, env);
+    printf("test_mod_log_tee: done\n");
+}
+
+int
+main(
+    )
+{
+    axutil_env_t *env = NULL;
+    axutil_log_t *env_log = NULL;
+    axutil_log_t capture_log;
+    axis2_module_t *module = NULL;
+    axis2_handler_t *handler = NULL;
+
+    env = axutil_env_create_all("test_mod_log.log", AXIS2_LOG_LEVEL_INFO);
+    env_log = env->log;
+    capture_log.ops = &capture_ops;
+    capture_log.level = AXIS2_LOG_LEVEL_INFO;
+    capture_log.size = 0;
+    capture_log.enabled = AXIS2_TRUE;
+    env->log = &capture_log;
+
+    check(axis2_get_instance(&module, env) == AXIS2_SUCCESS, "module");
+    module->ops->fill_handler_create_func_map(module, env);
+    handler = create_in_handler(env, module);
+    check(handler != NULL, "in handler");
+    if (handler)
+    {
+        test_mod_log_sampling(env, module, handler);
+        test_mod_log_max_size(env, module, handler);
+        test_mod_log_tee(env, module, handler);
+        axis2_handler_free(handler, env);
+    }
+    axis2_remove_instance(module, env);
+
+    env->log = env_log;
+    axutil_env_free(env);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,686 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * End to end benchmark. Unless a url is given, the simple http server is
+ * started in this process on the repository, which must have the echo and
+ * math samples deployed. Requests are sent from several threads, each with a
+ * service client of its own sharing one configuration context, and the
+ * result is printed as one line of JSON, to be appended to a file and
+ * compared from one build to the next.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <axiom.h>
+#include <axis2_util.h>
+#include <axis2_client.h>
+#include <axis2_conf.h>
+#include <axis2_conf_ctx.h>
+#include <axis2_transport_out_desc.h>
+#include <axis2_transport_sender.h>
+#include <axis2_http_server.h>
+#include <axis2_http_transport.h>
+#include <axutil_error_default.h>
+#include <axutil_log_default.h>
+#include <axutil_thread_pool.h>
+#include <axutil_network_handler.h>
+#include <axiom_xml_reader.h>
+#include <platforms/axutil_platform_auto_sense.h>
+#ifndef WIN32
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
+#define AXIS2_BENCH_MAX_THREADS 1024
+
+AXIS2_IMPORT extern axis2_char_t *axis2_request_url_prefix;
+
+typedef enum axis2_bench_mep
+{
+    AXIS2_BENCH_OUT_IN = 0,
+    AXIS2_BENCH_ROBUST_OUT_ONLY,
+    AXIS2_BENCH_OUT_ONLY
+} axis2_bench_mep_t;
+
+static const axis2_char_t *axis2_bench_mep_names[] =
+    { "out-in", "robust-out-only", "out-only" };
+
+typedef struct axis2_bench_config
+{
+    const axis2_char_t *repo;
+    const axis2_char_t *url;
+    const axis2_char_t *svc;
+    int port;
+    int threads;
+    int requests;
+    int warmup;
+    int payload;
+    axis2_bench_mep_t mep;
+    axis2_bool_t mtom;
+    axis2_bool_t keep_alive;
+    axis2_bool_t count_allocs;
+} axis2_bench_config_t;
+
+typedef struct axis2_bench_thread
+{
+    const axis2_bench_config_t *config;
+    const axutil_env_t *system_env;
+    axis2_conf_ctx_t *conf_ctx;
+    axis2_svc_t *svc;
+    /* microseconds each measured request took */
+    long *latencies;
+    int done;
+    int errors;
+} axis2_bench_thread_t;
+
+/* the server started in this process */
+static axis2_transport_receiver_t *axis2_bench_server = NULL;
+static const axutil_env_t *axis2_bench_server_env = NULL;
+
+/* allocations made through the counting allocator, see -a */
+static long axis2_bench_allocs = 0;
+static axutil_thread_mutex_t *axis2_bench_allocs_mutex = NULL;
+
+static void *AXIS2_CALL
+axis2_bench_malloc(
+    axutil_allocator_t * allocator,
+    size_t size)
+{
+    axutil_thread_mutex_lock(axis2_bench_allocs_mutex);
+    axis2_bench_allocs++;
+    axutil_thread_mutex_unlock(axis2_bench_allocs_mutex);
+    return malloc(size);
+}
+
+static void *AXIS2_CALL
+axis2_bench_realloc(
+    axutil_allocator_t * allocator,
+    void *ptr,
+    size_t size)
+{
+    return realloc(ptr, size);
+}
+
+static void AXIS2_CALL
+axis2_bench_free(
+    axutil_allocator_t * allocator,
+    void *ptr)
+{
+    free(ptr);
+}
+
+static double
+axis2_bench_now(void)
+{
+#ifndef WIN32
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+#else
+    struct AXIS2_PLATFORM_TIMEB t;
+
+    AXIS2_PLATFORM_GET_TIME_IN_MILLIS(&t);
+    return t.time * 1000000.0 + t.millitm * 1000.0;
+#endif
+}
+
+static long
+axis2_bench_max_rss_kb(void)
+{
+#ifndef WIN32
+    struct rusage usage;
+
+    if (0 == getrusage(RUSAGE_SELF, &usage))
+    {
+        return usage.ru_maxrss;
+    }
+#endif
+    return -1;
+}
+
+static int
+axis2_bench_compare_latency(
+    const void *a,
+    const void *b)
+{
+    long la = *(const long *) a;
+    long lb = *(const long *) b;
+
+    return la < lb ? -1 : la > lb;
+}
+
+/* nearest rank percentile of sorted latencies */
+static long
+axis2_bench_percentile(
+    long *latencies,
+    int count,
+    double percent)
+{
+    int rank = 0;
+
+    if (count <= 0)
+    {
+        return 0;
+    }
+    rank = (int) (percent / 100.0 * count + 0.999999);
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+    if (rank > count)
+    {
+        rank = count;
+    }
+    return latencies[rank - 1];
+}
+
+static axiom_node_t *
+axis2_bench_build_payload(
+    const axutil_env_t * env,
+    const axis2_bench_config_t * config,
+    const axis2_char_t * text)
+{
+    axiom_namespace_t *ns = NULL;
+    axiom_element_t *element = NULL;
+    axiom_node_t *payload = NULL;
+    axiom_node_t *node = NULL;
+
+    if (0 == axutil_strcmp(config->svc, "math"))
+    {
+        ns = axiom_namespace_create(env,
+            "http://ws.apache.org/axis2/services/math", "ns1");
+        axiom_element_create(env, NULL, "add", ns, &payload);
+        element = axiom_element_create(env, payload, "param1", NULL, &node);
+        axiom_element_set_text(element, env, "40", node);
+        element = axiom_element_create(env, payload, "param2", NULL, &node);
+        axiom_element_set_text(element, env, "8", node);
+    }
+    else
+    {
+        ns = axiom_namespace_create(env,
+            "http://ws.apache.org/axis2/c/samples", "ns1");
+        axiom_element_create(env, NULL, "echoString", ns, &payload);
+        element = axiom_element_create(env, payload, "text", NULL, &node);
+        axiom_element_set_text(element, env, text, node);
+    }
+    return payload;
+}
+
+/* Sends one request, returns AXIS2_TRUE if it got the expected answer */
+static axis2_bool_t
+axis2_bench_send(
+    const axutil_env_t * env,
+    const axis2_bench_config_t * config,
+    axis2_svc_client_t * svc_client,
+    const axis2_char_t * text)
+{
+    axiom_node_t *payload = axis2_bench_build_payload(env, config, text);
+    axiom_node_t *response = NULL;
+    int status = 0;
+
+    if (!payload)
+    {
+        return AXIS2_FALSE;
+    }
+    switch (config->mep)
+    {
+    case AXIS2_BENCH_ROBUST_OUT_ONLY:
+        return AXIS2_SUCCESS ==
+            axis2_svc_client_send_robust(svc_client, env, payload);
+    case AXIS2_BENCH_OUT_ONLY:
+        /* nothing tells whether it failed but the status of the response */
+        axis2_svc_client_fire_and_forget(svc_client, env, payload);
+        status = axis2_svc_client_get_http_status_code(svc_client, env);
+        return status >= 200 && status < 300;
+    default:
+        response = axis2_svc_client_send_receive(svc_client, env, payload);
+        return response && !axis2_svc_client_get_last_response_has_fault(
+            svc_client, env);
+    }
+}
+
+static void *AXIS2_THREAD_FUNC
+axis2_bench_thread_run(
+    axutil_thread_t * thd,
+    void *data)
+{
+    axis2_bench_thread_t *bench = (axis2_bench_thread_t *) data;
+    const axis2_bench_config_t *config = bench->config;
+    axutil_env_t *env = axutil_init_thread_env(bench->system_env);
+    axis2_svc_client_t *svc_client = NULL;
+    axis2_options_t *options = NULL;
+    axis2_char_t *text = NULL;
+    int i = 0;
+
+    if (!env)
+    {
+        bench->errors = config->requests;
+        return NULL;
+    }
+    text = AXIS2_MALLOC(env->allocator, config->payload + 1);
+    svc_client = axis2_svc_client_create_with_conf_ctx_and_svc(env,
+        config->repo, bench->conf_ctx, bench->svc);
+    options = axis2_options_create(env);
+    if (!text || !svc_client || !options)
+    {
+        bench->errors = config->requests;
+        axutil_free_thread_env(env);
+        return NULL;
+    }
+    memset(text, 'x', config->payload);
+    text[config->payload] = '\0';
+
+    axis2_options_set_to(options, env,
+        axis2_endpoint_ref_create(env, config->url));
+    axis2_options_set_action(options, env,
+        0 == axutil_strcmp(config->svc, "math") ?
+        "http://ws.apache.org/axis2/c/samples/math/add" :
+        "http://ws.apache.org/axis2/c/samples/echoString");
+    axis2_options_set_timeout_in_milli_seconds(options, env, 60000);
+    if (config->mtom)
+    {
+        axis2_options_set_soap_version(options, env, AXIOM_SOAP11);
+        axis2_options_set_enable_mtom(options, env, AXIS2_TRUE);
+    }
+    axis2_svc_client_set_options(svc_client, env, options);
+
+    for (i = 0; i < config->warmup; i++)
+    {
+        axutil_reset_thread_env(env);
+        axis2_bench_send(env, config, svc_client, text);
+    }
+    for (i = 0; i < config->requests; i++)
+    {
+        double start = 0;
+
+        axutil_reset_thread_env(env);
+        start = axis2_bench_now();
+
+        if (!axis2_bench_send(env, config, svc_client, text))
+        {
+            bench->errors++;
+            continue;
+        }
+        bench->latencies[bench->done++] =
+            (long) (axis2_bench_now() - start);
+    }
+
+    axis2_svc_client_free(svc_client, env);
+    AXIS2_FREE(env->allocator, text);
+    axutil_free_thread_env(env);
+    return NULL;
+}
+
+static void *AXIS2_THREAD_FUNC
+axis2_bench_server_run(
+    axutil_thread_t * thd,
+    void *data)
+{
+    axis2_transport_receiver_start(axis2_bench_server,
+        axis2_bench_server_env);
+    return NULL;
+}
+
+/* Waits for the server to have deployed its services and listen */
+static axis2_bool_t
+axis2_bench_wait_for_server(
+    const axutil_env_t * env,
+    int port)
+{
+    int i = 0;
+
+    for (i = 0; i < 600; i++)
+    {
+        axis2_socket_t socket =
+            axutil_network_handler_open_socket(env, "127.0.0.1", port);
+
+        if (socket >= 0)
+        {
+            axutil_network_handler_close_socket(env, socket);
+            return AXIS2_TRUE;
+        }
+        AXIS2_USLEEP(100000);
+    }
+    return AXIS2_FALSE;
+}
+
+/* The http sender keeps its connections open only in HTTP/2, where all the
+   threads send their requests as streams of one connection, so keep alive
+   switches the sender of the shared configuration to HTTP/2 */
+static axis2_status_t
+axis2_bench_keep_alive(
+    const axutil_env_t * env,
+    axis2_conf_ctx_t * conf_ctx)
+{
+    axis2_conf_t *conf = axis2_conf_ctx_get_conf(conf_ctx, env);
+    axis2_transport_out_desc_t *out_desc = NULL;
+    axis2_transport_sender_t *sender = NULL;
+    axutil_param_t *param = NULL;
+
+    out_desc = axis2_conf_get_transport_out(conf, env,
+        AXIS2_TRANSPORT_ENUM_HTTP);
+    if (!out_desc)
+    {
+        return AXIS2_FAILURE;
+    }
+    param = axutil_param_container_get_param(
+        axis2_transport_out_desc_param_container(out_desc, env), env,
+        AXIS2_HTTP_PROTOCOL_VERSION);
+    sender = axis2_transport_out_desc_get_sender(out_desc, env);
+    if (!param || !sender)
+    {
+        return AXIS2_FAILURE;
+    }
+    axutil_param_set_value(param, env,
+        axutil_strdup(env, AXIS2_HTTP_HEADER_PROTOCOL_20));
+    return AXIS2_TRANSPORT_SENDER_INIT(sender, env, conf_ctx, out_desc);
+}
+
+static void
+axis2_bench_usage(
+    const axis2_char_t * prog_name)
+{
+    fprintf(stdout, "\n Usage : %s", prog_name);
+    fprintf(stdout, " [-r REPO_PATH] [-u URL] [-p PORT] [-s SERVICE]"
+        " [-t THREADS]\n          [-n REQUESTS] [-w WARMUP] [-b BYTES]"
+        " [-e MEP] [-m] [-k] [-a]\n          [-l LOG_LEVEL] [-f LOG_FILE]\n");
+    fprintf(stdout, " Options :\n");
+    fprintf(stdout, "\t-r REPO_PATH \t repository of the server and of the"
+        " clients, with the\n\t\t\t echo and math samples. The default is"
+        " AXIS2C_HOME\n");
+    fprintf(stdout, "\t-u URL \t\t send to this url instead of a server"
+        " started here\n");
+    fprintf(stdout, "\t-p PORT \t port of the server started here. The"
+        " default is 9099\n");
+    fprintf(stdout, "\t-s SERVICE \t echo or math. The default is echo\n");
+    fprintf(stdout, "\t-t THREADS \t threads sending requests. The default"
+        " is 4\n");
+    fprintf(stdout, "\t-n REQUESTS \t requests measured per thread. The"
+        " default is 1000\n");
+    fprintf(stdout, "\t-w WARMUP \t requests sent per thread before"
+        " measuring. The default\n\t\t\t is 50\n");
+    fprintf(stdout, "\t-b BYTES \t size of the text echoed. The default"
+        " is 100\n");
+    fprintf(stdout, "\t-e MEP \t\t out-in, robust-out-only or out-only."
+        " The default is\n\t\t\t out-in\n");
+    fprintf(stdout, "\t-m \t\t send the requests as MTOM\n");
+    fprintf(stdout, "\t-k \t\t keep connections alive, sending over"
+        " HTTP/2\n");
+    fprintf(stdout, "\t-a \t\t count allocations. Slows down the"
+        " allocator\n");
+    fprintf(stdout, "\t-l LOG_LEVEL\t log level, 0 - 6. The default is 1"
+        " (errors)\n");
+    fprintf(stdout, "\t-f LOG_FILE\t log file. The default is"
+        " axis2_bench.log\n");
+    fprintf(stdout, "\t-h \t\t display this help screen.\n\n");
+    fprintf(stdout, " The result is printed as one line of JSON.\n\n");
+}
+
+int
+main(
+    int argc,
+    char **argv)
+{
+    extern char *optarg;
+    extern int optopt;
+    axutil_allocator_t *allocator = NULL;
+    axutil_env_t *env = NULL;
+    axis2_bench_config_t config;
+    axis2_bench_thread_t *benches = NULL;
+    axutil_thread_t **threads = NULL;
+    axis2_svc_client_t *svc_client = NULL;
+    axutil_log_levels_t log_level = AXIS2_LOG_LEVEL_ERROR;
+    const axis2_char_t *log_file = "axis2_bench.log";
+    axis2_char_t url[256];
+    long *latencies = NULL;
+    long allocs = 0;
+    double start = 0;
+    double seconds = 0;
+    int done = 0;
+    int errors = 0;
+    int c = 0;
+    int i = 0;
+
+    memset(&config, 0, sizeof(config));
+    config.repo = AXIS2_GETENV("AXIS2C_HOME");
+    config.svc = "echo";
+    config.port = 9099;
+    config.threads = 4;
+    config.requests = 1000;
+    config.warmup = 50;
+    config.payload = 100;
+    config.mep = AXIS2_BENCH_OUT_IN;
+
+    while ((c = AXIS2_GETOPT(argc, argv, ":r:u:p:s:t:n:w:b:e:mkal:f:h")) != -1)
+    {
+        switch (c)
+        {
+        case 'r':
+            config.repo = optarg;
+            break;
+        case 'u':
+            config.url = optarg;
+            break;
+        case 'p':
+            config.port = AXIS2_ATOI(optarg);
+            break;
+        case 's':
+            config.svc = optarg;
+            break;
+        case 't':
+            config.threads = AXIS2_ATOI(optarg);
+            break;
+        case 'n':
+            config.requests = AXIS2_ATOI(optarg);
+            break;
+        case 'w':
+            config.warmup = AXIS2_ATOI(optarg);
+            break;
+        case 'b':
+            config.payload = AXIS2_ATOI(optarg);
+            break;
+        case 'e':
+            for (i = 0; i < 3; i++)
+            {
+                if (0 == axutil_strcmp(optarg, axis2_bench_mep_names[i]))
+                {
+                    config.mep = (axis2_bench_mep_t) i;
+                    break;
+                }
+            }
+            if (3 == i)
+            {
+                fprintf(stderr, "\nUnknown MEP %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'm':
+            config.mtom = AXIS2_TRUE;
+            break;
+        case 'k':
+            config.keep_alive = AXIS2_TRUE;
+            break;
+        case 'a':
+            config.count_allocs = AXIS2_TRUE;
+            break;
+        case 'l':
+            log_level = AXIS2_ATOI(optarg);
+            break;
+        case 'f':
+            log_file = optarg;
+            break;
+        case 'h':
+            axis2_bench_usage(argv[0]);
+            return 0;
+        default:
+            axis2_bench_usage(argv[0]);
+            return -1;
+        }
+    }
+    if (!config.repo || config.threads < 1 ||
+        config.threads > AXIS2_BENCH_MAX_THREADS || config.requests < 1 ||
+        config.payload < 0 || (axutil_strcmp(config.svc, "echo") &&
+                               axutil_strcmp(config.svc, "math")))
+    {
+        axis2_bench_usage(argv[0]);
+        return -1;
+    }
+
+    allocator = axutil_allocator_init(NULL);
+    if (config.count_allocs)
+    {
+        axis2_bench_allocs_mutex = axutil_thread_mutex_create(allocator,
+            AXIS2_THREAD_MUTEX_DEFAULT);
+        allocator = (axutil_allocator_t *) malloc(sizeof(axutil_allocator_t));
+        memset(allocator, 0, sizeof(axutil_allocator_t));
+        allocator->malloc_fn = axis2_bench_malloc;
+        allocator->realloc = axis2_bench_realloc;
+        allocator->free_fn = axis2_bench_free;
+    }
+    axiom_xml_reader_init();
+    env = axutil_env_create_with_error_log_thread_pool(allocator,
+        axutil_error_create(allocator),
+        axutil_log_create(allocator, NULL, log_file),
+        axutil_thread_pool_init(allocator));
+    if (!env)
+    {
+        fprintf(stderr, "\nCould not create the environment\n");
+        return -1;
+    }
+    env->log->level = log_level;
+    axutil_error_init();
+
+    if (!config.url)
+    {
+        axutil_thread_t *server_thread = NULL;
+
+        axis2_request_url_prefix = AXIS2_REQUEST_URL_PREFIX;
+        axis2_bench_server = axis2_http_server_create(env, config.repo,
+            config.port);
+        axis2_bench_server_env = env;
+        if (axis2_bench_server)
+        {
+            server_thread = axutil_thread_pool_get_thread(env->thread_pool,
+                axis2_bench_server_run, NULL);
+        }
+        if (!server_thread || !axis2_bench_wait_for_server(env, config.port))
+        {
+            fprintf(stderr, "\nCould not start the server on port %d, see"
+                " %s\n", config.port, log_file);
+            return -1;
+        }
+        axutil_thread_pool_thread_detach(env->thread_pool, server_thread);
+        sprintf(url, "http://127.0.0.1:%d/axis2/services/%s", config.port,
+            config.svc);
+        config.url = url;
+    }
+
+    svc_client = axis2_svc_client_create(env, config.repo);
+    if (!svc_client || (config.keep_alive && AXIS2_SUCCESS !=
+        axis2_bench_keep_alive(env,
+            axis2_svc_client_get_conf_ctx(svc_client, env))))
+    {
+        fprintf(stderr, "\nCould not create the service client, see %s\n",
+            log_file);
+        return -1;
+    }
+
+    benches = AXIS2_MALLOC(env->allocator,
+        sizeof(axis2_bench_thread_t) * config.threads);
+    threads = AXIS2_MALLOC(env->allocator,
+        sizeof(axutil_thread_t *) * config.threads);
+    latencies = AXIS2_MALLOC(env->allocator,
+        sizeof(long) * config.threads * config.requests);
+    if (!benches || !threads || !latencies)
+    {
+        fprintf(stderr, "\nOut of memory\n");
+        return -1;
+    }
+    for (i = 0; i < config.threads; i++)
+    {
+        benches[i].config = &config;
+        benches[i].system_env = env;
+        benches[i].conf_ctx = axis2_svc_client_get_conf_ctx(svc_client, env);
+        benches[i].svc = axis2_svc_client_get_svc(svc_client, env);
+        benches[i].latencies = latencies + i * config.requests;
+        benches[i].done = 0;
+        benches[i].errors = 0;
+    }
+
+    allocs = axis2_bench_allocs;
+    start = axis2_bench_now();
+    for (i = 0; i < config.threads; i++)
+    {
+        threads[i] = axutil_thread_create(env->allocator, NULL,
+            axis2_bench_thread_run, &benches[i]);
+        if (!threads[i])
+        {
+            benches[i].errors = config.requests;
+        }
+    }
+    for (i = 0; i < config.threads; i++)
+    {
+        if (threads[i])
+        {
+            axutil_thread_join(threads[i]);
+        }
+    }
+    seconds = (axis2_bench_now() - start) / 1000000.0;
+    allocs = axis2_bench_allocs - allocs;
+
+    /* the latencies of the threads are packed one after the other */
+    for (i = 0; i < config.threads; i++)
+    {
+        memmove(latencies + done, benches[i].latencies,
+            sizeof(long) * benches[i].done);
+        done += benches[i].done;
+        errors += benches[i].errors;
+    }
+    qsort(latencies, done, sizeof(long), axis2_bench_compare_latency);
+
+    fprintf(stdout, "{\"bench\":\"e2e\",\"service\":\"%s\",\"mep\":\"%s\","
+        "\"threads\":%d,\"requests\":%d,\"payload\":%d,\"mtom\":%s,"
+        "\"keep_alive\":%s,\"in_process\":%s,\"ok\":%d,\"errors\":%d,"
+        "\"seconds\":%.3f,\"throughput\":%.1f,\"p50_us\":%ld,"
+        "\"p99_us\":%ld,\"p999_us\":%ld,\"max_us\":%ld,",
+        config.svc, axis2_bench_mep_names[config.mep], config.threads,
+        config.requests, config.payload, config.mtom ? "true" : "false",
+        config.keep_alive ? "true" : "false",
+        axis2_bench_server ? "true" : "false", done, errors, seconds,
+        seconds > 0 ? done / seconds : 0.0,
+        axis2_bench_percentile(latencies, done, 50),
+        axis2_bench_percentile(latencies, done, 99),
+        axis2_bench_percentile(latencies, done, 99.9),
+        done ? latencies[done - 1] : 0);
+    if (config.count_allocs && done + errors > 0)
+    {
+        fprintf(stdout, "\"allocs_per_request\":%.1f,",
+            (double) allocs / (done + errors));
+    }
+    else
+    {
+        fprintf(stdout, "\"allocs_per_request\":null,");
+    }
+    fprintf(stdout, "\"max_rss_kb\":%ld}\n", axis2_bench_max_rss_kb());
+    fflush(stdout);
+
+    /* the server thread waits in accept, so it is left to the exit */
+    return errors ? 1 : 0;
+}
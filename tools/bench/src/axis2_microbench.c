@@ -0,0 +1,879 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Microbenchmarks of the util, guththila and axiom code the profiles of the
+ * engine keep showing. Each benchmark repeats one operation until it has run
+ * for long enough and prints the time, throughput and allocations of one
+ * operation as a line of JSON. The documents parsed are the fixed ones of
+ * guththila/tests/resources and axiom/test/resources, read from the source
+ * tree given with -d.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <axiom.h>
+#include <axiom_mime_parser.h>
+#include <axiom_data_handler.h>
+#include <axiom_xml_reader.h>
+#include <axiom_xml_writer.h>
+#include <axis2_util.h>
+#include <axutil_base64.h>
+#include <axutil_http_chunked_stream.h>
+#include <axutil_error_default.h>
+#include <axutil_log_default.h>
+#include <guththila.h>
+#include <guththila_xml_writer.h>
+#include <platforms/axutil_platform_auto_sense.h>
+#ifndef WIN32
+#include <sys/time.h>
+#endif
+
+/* the backend axiom_xml_reader was built with */
+#ifdef AXIS2_LIBXML2_ENABLED
+#define AXIS2_MICROBENCH_PARSER "libxml2"
+#else
+#define AXIS2_MICROBENCH_PARSER "guththila"
+#endif
+
+#define AXIS2_MICROBENCH_KEYS 1024
+#define AXIS2_MICROBENCH_BLOCK 4096
+#define AXIS2_MICROBENCH_ATTACHMENT 65536
+#define AXIS2_MICROBENCH_BOUNDARY "MIMEBoundaryurn_uuid_microbench"
+
+typedef struct axis2_microbench axis2_microbench_t;
+
+/* Runs the operation of the benchmark iterations times. Returns the number
+   of bytes one operation went through, 0 when it does not apply, or -1 on
+   error */
+typedef int (*axis2_microbench_run_t)(
+    const axutil_env_t * env,
+    axis2_microbench_t * bench,
+    int iterations);
+
+struct axis2_microbench
+{
+    const axis2_char_t *name;
+    /* document of the benchmark, relative to the source tree */
+    const axis2_char_t *corpus;
+    axis2_microbench_run_t run;
+    /* parser the operation goes through, if any */
+    const axis2_char_t *parser;
+    /* run only with -c */
+    axis2_bool_t compare;
+    /* contents of the corpus */
+    axis2_char_t *data;
+    int len;
+};
+
+/* allocations made through the environment, counted for allocs_per_op */
+static long axis2_microbench_allocs = 0;
+
+static axis2_char_t *axis2_microbench_keys[AXIS2_MICROBENCH_KEYS];
+static axutil_hash_t *axis2_microbench_hash = NULL;
+static axis2_char_t axis2_microbench_block[AXIS2_MICROBENCH_BLOCK];
+static axis2_char_t *axis2_microbench_encoded = NULL;
+static axis2_char_t *axis2_microbench_message = NULL;
+static int axis2_microbench_message_len = 0;
+/* tree axiom_serialize writes out, built from its corpus */
+static axiom_stax_builder_t *axis2_microbench_builder = NULL;
+static axiom_node_t *axis2_microbench_tree = NULL;
+
+static void *AXIS2_CALL
+axis2_microbench_malloc(
+    axutil_allocator_t * allocator,
+    size_t size)
+{
+    axis2_microbench_allocs++;
+    return malloc(size);
+}
+
+static void *AXIS2_CALL
+axis2_microbench_realloc(
+    axutil_allocator_t * allocator,
+    void *ptr,
+    size_t size)
+{
+    axis2_microbench_allocs++;
+    return realloc(ptr, size);
+}
+
+static void AXIS2_CALL
+axis2_microbench_free(
+    axutil_allocator_t * allocator,
+    void *ptr)
+{
+    free(ptr);
+}
+
+static double
+axis2_microbench_now(void)
+{
+#ifndef WIN32
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+#else
+    struct AXIS2_PLATFORM_TIMEB t;
+
+    AXIS2_PLATFORM_GET_TIME_IN_MILLIS(&t);
+    return t.time * 1000000.0 + t.millitm * 1000.0;
+#endif
+}
+
+static int
+axis2_microbench_hash_set(
+    const axutil_env_t * env,
+    axis2_microbench_t * bench,
+    int iterations)
+{
+    int i = 0;
+
+    for (i = 0; i < iterations; i++)
+    {
+        axis2_char_t *key =
+            axis2_microbench_keys[i % AXIS2_MICROBENCH_KEYS];
+
+        axutil_hash_set(axis2_microbench_hash, key, AXIS2_HASH_KEY_STRING,
+            key);
+    }
+    return 0;
+}
+
+static int
+axis2_microbench_hash_get(
+    const axutil_env_t * env,
+    axis2_microbench_t * bench,
+    int iterations)
+{
+    int i = 0;
+
+    for (i = 0; i < iterations; i++)
+    {
+        if (!axutil_hash_get(axis2_microbench_hash,
+            axis2_microbench_keys[i % AXIS2_MICROBENCH_KEYS],
+            AXIS2_HASH_KEY_STRING))
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* writes a block to a basic stream and reads it back */
+static int
+axis2_microbench_stream(
+    const axutil_env_t * env,
+    axis2_microbench_t * bench,
+    int iterations)
+{
+    axutil_stream_t *stream = axutil_stream_create_basic(env);
+    /* a basic stream ends what it reads with a '\0' */
+    axis2_char_t buffer[AXIS2_MICROBENCH_BLOCK + 1];
+    int i = 0;
+
+    if (!stream)
+    {
+        return -1;
+    }
+    for (i = 0; i < iterations; i++)
+    {
+        axutil_stream_write(stream, env, axis2_microbench_block,
+            AXIS2_MICROBENCH_BLOCK);
+        if (axutil_stream_read(stream, env, buffer, sizeof(buffer)) !=
+            AXIS2_MICROBENCH_BLOCK)
+        {
+            axutil_stream_free(stream, env);
+            return -1;
+        }
+    }
+    axutil_stream_free(stream, env);
+    return AXIS2_MICROBENCH_BLOCK;
+}
+
+static int
+axis2_microbench_base64_encode(
+    const axutil_env_t * env,
+    axis2_microbench_t * bench,
+    int iterations)
+{
+    axis2_char_t *encoded = AXIS2_MALLOC(env->allocator,
+        axutil_base64_encode_len(AXIS2_MICROBENCH_BLOCK));
+    int i = 0;
+
+    if (!encoded)
+    {
+        return -1;
+    }
+    for (i = 0; i < iterations; i++)
+    {
+        axutil_base64_encode_binary(encoded,
+            (const unsigned char *) axis2_microbench_block,
+            AXIS2_MICROBENCH_BLOCK);
+    }
+    AXIS2_FREE(env->allocator, encoded);
+    return AXIS2_MICROBENCH_BLOCK;
+}
+
+static int
+axis2_microbench_base64_decode(
+    const axutil_env_t * env,
+    axis2_microbench_t * bench,
+    int iterations)
+{
+    unsigned char *decoded = AXIS2_MALLOC(env->allocator,
+        axutil_base64_decode_len(axis2_microbench_encoded));
+    int i = 0;
+
+    if (!decoded)
+    {
+        return -1;
+    }
+    for (i = 0; i < iterations; i++)
+    {
+        if (axutil_base64_decode_binary(decoded, axis2_microbench_encoded) !=
+            AXIS2_MICROBENCH_BLOCK)
+        {
+            AXIS2_FREE(env->allocator, decoded);
+            return -1;
+        }
+    }
+    AXIS2_FREE(env->allocator, decoded);
+    return AXIS2_MICROBENCH_BLOCK;
+}
+
+/* pulls all the events of the corpus from guththila, with the names of the
+   elements as a consumer would */
+static int
+axis2_microbench_guththila_parse(
+    const axutil_env_t * env,
+    axis2_microbench_t * bench,
+    int iterations)
+{
+    int i = 0;
+
+    for (i = 0; i < iterations; i++)
+    {
+        guththila_reader_t *reader = NULL;
+        guththila_t *parser = NULL;
+        guththila_char_t *name = NULL;
+        int events = 0;
+        int event = 0;
+
+        reader = guththila_reader_create_for_memory(bench->data, bench->len,
+            env);
+        parser = (guththila_t *) AXIS2_MALLOC(env->allocator,
+            sizeof(guththila_t));
+        if (!reader || !parser)
+        {
+            return -1;
+        }
+        guththila_init(parser, reader, env);
+        while ((event = guththila_next(parser, env)) != -1)
+        {
+            if (GUTHTHILA_START_ELEMENT == event ||
+                GUTHTHILA_EMPTY_ELEMENT == event)
+            {
+                name = guththila_get_name(parser, env);
+                AXIS2_FREE(env->allocator, name);
+            }
+            events++;
+        }
+        guththila_reader_free(reader, env);
+        guththila_un_init(parser, env);
+        if (!events)
+        {
+            return -1;
+        }
+    }
+    return bench->len;
+}
+
+/* the same as guththila_parse, through the axiom_xml_reader built in */
+static int
+axis2_microbench_reader_parse(
+    const axutil_env_t * env,
+    axis2_microbench_t * bench,
+    int iterations)
+{
+    int i = 0;
+
+    for (i = 0; i < iterations; i++)
+    {
+        axiom_xml_reader_t *reader = NULL;
+        axis2_char_t *name = NULL;
+        int events = 0;
+        int event = 0;
+
+        reader = axiom_xml_reader_create_for_memory(env, bench->data,
+            bench->len, "UTF-8", AXIS2_XML_PARSER_TYPE_BUFFER);
+        if (!reader)
+        {
+            return -1;
+        }
+        while ((event = axiom_xml_reader_next(reader, env)) != -1)
+        {
+            if (AXIOM_XML_READER_START_ELEMENT == event ||
+                AXIOM_XML_READER_EMPTY_ELEMENT == event)
+            {
+                name = axiom_xml_reader_get_name(reader, env);
+                axiom_xml_reader_xml_free(reader, env, name);
+            }
+            events++;
+        }
+        axiom_xml_reader_free(reader, env);
+        if (!events)
+        {
+            return -1;
+        }
+    }
+    return bench->len;
+}
+
+/* writes a document of a hundred qualified elements with an attribute and
+   some text each */
+static int
+axis2_microbench_guththila_write(
+    const axutil_env_t * env,
+    axis2_microbench_t * bench,
+    int iterations)
+{
+    int len = 0;
+    int i = 0;
+    int j = 0;
+
+    for (i = 0; i < iterations; i++)
+    {
+        guththila_xml_writer_t *writer =
+            guththila_create_xml_stream_writer_for_memory(env);
+
+        if (!writer)
+        {
+            return -1;
+        }
+        guththila_write_start_document(writer, env, "UTF-8", "1.0");
+        guththila_write_start_element_with_prefix_and_namespace(writer,
+            "ns1", "http://ws.apache.org/axis2/c/samples", "items", env);
+        for (j = 0; j < 100; j++)
+        {
+            guththila_write_start_element_with_prefix(writer, "ns1", "item",
+                env);
+            guththila_write_attribute(writer, "id", "value of an attribute",
+                env);
+            guththila_write_characters(writer,
+                "the text of an element, long enough to be copied", env);
+            guththila_write_end_element(writer, env);
+        }
+        guththila_write_end_element(writer, env);
+        guththila_write_end_document(writer, env);
+        len = guththila_get_memory_buffer_size(writer, env);
+        guththila_xml_writer_free(writer, env);
+    }
+    return len;
+}
+
+/* builds the whole tree of the corpus */
+static int
+axis2_microbench_axiom_build(
+    const axutil_env_t * env,
+    axis2_microbench_t * bench,
+    int iterations)
+{
+    int i = 0;
+
+    for (i = 0; i < iterations; i++)
+    {
+        axiom_xml_reader_t *reader = NULL;
+        axiom_stax_builder_t *builder = NULL;
+        axiom_document_t *document = NULL;
+
+        reader = axiom_xml_reader_create_for_memory(env, bench->data,
+            bench->len, "UTF-8", AXIS2_XML_PARSER_TYPE_BUFFER);
+        builder = reader ? axiom_stax_builder_create(env, reader) : NULL;
+        document = builder ? axiom_stax_builder_get_document(builder, env) :
+            NULL;
+        if (!document || !axiom_document_build_all(document, env))
+        {
+            return -1;
+        }
+        axiom_stax_builder_free(builder, env);
+    }
+    return bench->len;
+}
+
+static int
+axis2_microbench_axiom_serialize(
+    const axutil_env_t * env,
+    axis2_microbench_t * bench,
+    int iterations)
+{
+    int len = 0;
+    int i = 0;
+
+    for (i = 0; i < iterations; i++)
+    {
+        axiom_xml_writer_t *writer = NULL;
+        axiom_output_t *output = NULL;
+
+        writer = axiom_xml_writer_create_for_memory(env, NULL, AXIS2_TRUE, 0,
+            AXIS2_XML_PARSER_TYPE_BUFFER);
+        output = writer ? axiom_output_create(env, writer) : NULL;
+        if (!output || AXIS2_SUCCESS != axiom_node_serialize(
+            axis2_microbench_tree, env, output))
+        {
+            return -1;
+        }
+        len = axiom_xml_writer_get_xml_size(writer, env);
+        axiom_output_free(output, env);
+    }
+    return len;
+}
+
+/* hands out the message as the http transport hands out a request body */
+static int AXIS2_CALL
+axis2_microbench_on_data_request(
+    char *buffer,
+    int size,
+    void *ctx)
+{
+    axis2_callback_info_t *callback_info = (axis2_callback_info_t *) ctx;
+    int len = size - 1;
+
+    if (len > callback_info->unread_len)
+    {
+        len = callback_info->unread_len;
+    }
+    memcpy(buffer, axis2_microbench_message + axis2_microbench_message_len -
+        callback_info->unread_len, len);
+    buffer[len] = '\0';
+    callback_info->unread_len -= len;
+    return len;
+}
+
+/* parses a SOAP part and its attachment, as for an MTOM request */
+static int
+axis2_microbench_mime_parse(
+    const axutil_env_t * env,
+    axis2_microbench_t * bench,
+    int iterations)
+{
+    int i = 0;
+
+    for (i = 0; i < iterations; i++)
+    {
+        axiom_mime_parser_t *mime_parser = NULL;
+        axis2_callback_info_t callback_info;
+        axutil_hash_t *parts = NULL;
+        axutil_hash_index_t *hi = NULL;
+        const void *key = NULL;
+        void *part = NULL;
+
+        memset(&callback_info, 0, sizeof(callback_info));
+        callback_info.env = env;
+        callback_info.content_length = axis2_microbench_message_len;
+        callback_info.unread_len = axis2_microbench_message_len;
+
+        mime_parser = axiom_mime_parser_create(env);
+        if (!mime_parser)
+        {
+            return -1;
+        }
+        axiom_mime_parser_set_mime_boundary(mime_parser, env,
+            AXIS2_MICROBENCH_BOUNDARY);
+        if (AXIS2_SUCCESS != axiom_mime_parser_parse_for_soap(mime_parser,
+            env, axis2_microbench_on_data_request, &callback_info,
+            AXIS2_MICROBENCH_BOUNDARY))
+        {
+            return -1;
+        }
+        parts = axiom_mime_parser_parse_for_attachments(mime_parser, env,
+            axis2_microbench_on_data_request, &callback_info,
+            AXIS2_MICROBENCH_BOUNDARY, NULL);
+        if (!parts || 1 != axutil_hash_count(parts))
+        {
+            return -1;
+        }
+        for (hi = axutil_hash_first(parts, env); hi;
+            hi = axutil_hash_next(env, hi))
+        {
+            axutil_hash_this(hi, &key, NULL, &part);
+            AXIS2_FREE(env->allocator, (void *) key);
+            axiom_data_handler_free((axiom_data_handler_t *) part, env);
+        }
+        axutil_hash_free(parts, env);
+        AXIS2_FREE(env->allocator,
+            axiom_mime_parser_get_soap_body_str(mime_parser, env));
+        axiom_mime_parser_free(mime_parser, env);
+    }
+    return axis2_microbench_message_len;
+}
+
+static axis2_microbench_t axis2_microbench_benches[] = {
+    {"hash_set", NULL, axis2_microbench_hash_set},
+    {"hash_get", NULL, axis2_microbench_hash_get},
+    {"stream_write_read", NULL, axis2_microbench_stream},
+    {"base64_encode", NULL, axis2_microbench_base64_encode},
+    {"base64_decode", NULL, axis2_microbench_base64_decode},
+    {"guththila_parse", "guththila/tests/resources/soap/soapmessage.xml",
+     axis2_microbench_guththila_parse, "guththila"},
+    {"guththila_parse",
+     "guththila/tests/resources/soap/reallyReallyBigMessage.xml",
+     axis2_microbench_guththila_parse, "guththila"},
+    {"guththila_parse", "guththila/tests/resources/soap/security2-soap.xml",
+     axis2_microbench_guththila_parse, "guththila"},
+    {"reader_parse", "guththila/tests/resources/soap/soapmessage.xml",
+     axis2_microbench_reader_parse, AXIS2_MICROBENCH_PARSER, AXIS2_TRUE},
+    {"reader_parse",
+     "guththila/tests/resources/soap/reallyReallyBigMessage.xml",
+     axis2_microbench_reader_parse, AXIS2_MICROBENCH_PARSER, AXIS2_TRUE},
+    {"reader_parse", "guththila/tests/resources/soap/security2-soap.xml",
+     axis2_microbench_reader_parse, AXIS2_MICROBENCH_PARSER, AXIS2_TRUE},
+    {"guththila_write", NULL, axis2_microbench_guththila_write},
+    {"axiom_build", "axiom/test/resources/xml/soap/soapmessage.xml",
+     axis2_microbench_axiom_build, AXIS2_MICROBENCH_PARSER},
+    {"axiom_build", "axiom/test/resources/xml/om/much_ado.xml",
+     axis2_microbench_axiom_build, AXIS2_MICROBENCH_PARSER},
+    {"axiom_serialize", "axiom/test/resources/xml/om/much_ado.xml",
+     axis2_microbench_axiom_serialize, AXIS2_MICROBENCH_PARSER},
+    {"mime_parse", NULL, axis2_microbench_mime_parse},
+    {NULL}
+};
+
+static axis2_char_t *
+axis2_microbench_read_file(
+    const axutil_env_t * env,
+    const axis2_char_t * dir,
+    const axis2_char_t * name,
+    int *len)
+{
+    axis2_char_t path[1024];
+    axis2_char_t *data = NULL;
+    FILE *f = NULL;
+    long size = 0;
+
+    sprintf(path, "%.500s/%.500s", dir, name);
+    f = fopen(path, "rb");
+    if (!f)
+    {
+        fprintf(stderr, "\nCould not open %s, see -d\n", path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    data = AXIS2_MALLOC(env->allocator, size + 1);
+    if (data && fread(data, 1, size, f) != (size_t) size)
+    {
+        AXIS2_FREE(env->allocator, data);
+        data = NULL;
+    }
+    fclose(f);
+    if (data)
+    {
+        data[size] = '\0';
+        *len = (int) size;
+    }
+    return data;
+}
+
+/* the keys, blocks and message the benchmarks without a corpus work on */
+static axis2_status_t
+axis2_microbench_setup(
+    const axutil_env_t * env,
+    const axis2_char_t * dir)
+{
+    axis2_char_t key[32];
+    axis2_char_t *soap = NULL;
+    axiom_xml_reader_t *reader = NULL;
+    axiom_document_t *document = NULL;
+    axis2_char_t *attachment = NULL;
+    int soap_len = 0;
+    int len = 0;
+    int i = 0;
+
+    axis2_microbench_hash = axutil_hash_make(env);
+    for (i = 0; i < AXIS2_MICROBENCH_KEYS; i++)
+    {
+        sprintf(key, "urn:microbench:key:%d", i);
+        axis2_microbench_keys[i] = axutil_strdup(env, key);
+        axutil_hash_set(axis2_microbench_hash, axis2_microbench_keys[i],
+            AXIS2_HASH_KEY_STRING, axis2_microbench_keys[i]);
+    }
+
+    for (i = 0; i < AXIS2_MICROBENCH_BLOCK; i++)
+    {
+        axis2_microbench_block[i] = (axis2_char_t) (i * 7 + i / 256);
+    }
+    axis2_microbench_encoded = AXIS2_MALLOC(env->allocator,
+        axutil_base64_encode_len(AXIS2_MICROBENCH_BLOCK));
+    axutil_base64_encode_binary(axis2_microbench_encoded,
+        (const unsigned char *) axis2_microbench_block,
+        AXIS2_MICROBENCH_BLOCK);
+
+    soap = axis2_microbench_read_file(env, dir,
+        "axiom/test/resources/xml/soap/soapmessage.xml", &soap_len);
+    if (!soap)
+    {
+        return AXIS2_FAILURE;
+    }
+    axis2_microbench_message = AXIS2_MALLOC(env->allocator,
+        soap_len + AXIS2_MICROBENCH_ATTACHMENT + 1024);
+    len = sprintf(axis2_microbench_message, "--%s\r\n"
+        "content-type: application/xop+xml; charset=UTF-8; "
+        "type=\"text/xml\";\r\ncontent-transfer-encoding: binary\r\n"
+        "content-id: <0.urn:uuid:microbench@apache.org>\r\n\r\n",
+        AXIS2_MICROBENCH_BOUNDARY);
+    memcpy(axis2_microbench_message + len, soap, soap_len);
+    len += soap_len;
+    len += sprintf(axis2_microbench_message + len, "\r\n--%s\r\n"
+        "content-type: application/octet-stream\r\n"
+        "content-transfer-encoding: binary\r\n"
+        "content-id: <1.urn:uuid:microbench@apache.org>\r\n\r\n",
+        AXIS2_MICROBENCH_BOUNDARY);
+    attachment = axis2_microbench_message + len;
+    for (i = 0; i < AXIS2_MICROBENCH_ATTACHMENT; i++)
+    {
+        attachment[i] = axis2_microbench_block[i % AXIS2_MICROBENCH_BLOCK];
+    }
+    len += AXIS2_MICROBENCH_ATTACHMENT;
+    len += sprintf(axis2_microbench_message + len, "\r\n--%s--\r\n",
+        AXIS2_MICROBENCH_BOUNDARY);
+    axis2_microbench_message_len = len;
+    AXIS2_FREE(env->allocator, soap);
+
+    for (i = 0; axis2_microbench_benches[i].name; i++)
+    {
+        axis2_microbench_t *bench = &axis2_microbench_benches[i];
+
+        if (bench->corpus)
+        {
+            bench->data = axis2_microbench_read_file(env, dir, bench->corpus,
+                &bench->len);
+            if (!bench->data)
+            {
+                return AXIS2_FAILURE;
+            }
+        }
+        if (axis2_microbench_axiom_serialize == bench->run)
+        {
+            reader = axiom_xml_reader_create_for_memory(env, bench->data,
+                bench->len, "UTF-8", AXIS2_XML_PARSER_TYPE_BUFFER);
+            axis2_microbench_builder = axiom_stax_builder_create(env, reader);
+            document = axiom_stax_builder_get_document(
+                axis2_microbench_builder, env);
+            axiom_document_build_all(document, env);
+            axis2_microbench_tree = axiom_document_get_root_element(document,
+                env);
+            if (!axis2_microbench_tree)
+            {
+                return AXIS2_FAILURE;
+            }
+        }
+    }
+    return AXIS2_SUCCESS;
+}
+
+static void
+axis2_microbench_usage(
+    const axis2_char_t * prog_name)
+{
+    fprintf(stdout, "\n Usage : %s", prog_name);
+    fprintf(stdout, " [-d SOURCE_DIR] [-b NAME] [-c] [-n ITERATIONS]"
+        " [-T MILLISECONDS] [-l LOG_LEVEL] [-f LOG_FILE]\n");
+    fprintf(stdout, " Options :\n");
+    fprintf(stdout, "\t-d SOURCE_DIR \t top of the source tree the documents"
+        " are read from. Default is .\n");
+    fprintf(stdout, "\t-b NAME \t run only the benchmarks whose name starts"
+        " with NAME\n");
+    fprintf(stdout, "\t-c \t\t compare parsers: also parse the documents of"
+        " guththila_parse through axiom_xml_reader, which was built with "
+        AXIS2_MICROBENCH_PARSER "\n");
+    fprintf(stdout, "\t-n ITERATIONS \t run each benchmark that many times"
+        " instead of timing it\n");
+    fprintf(stdout, "\t-T MILLISECONDS  least time each benchmark is run"
+        " for. Default is 500\n");
+    fprintf(stdout, "\t-l LOG_LEVEL\t set log level, available levels:\n"
+        "\t\t\t 0 - critical    1 - errors 2 - warnings\n"
+        "\t\t\t 3 - information 4 - debug  5- user 6 - trace\n"
+        "\t\t\t Default log level is 1(errors).\n");
+    fprintf(stdout, "\t-f LOG_FILE\t set log file, default is"
+        " axis2_microbench.log\n");
+    fprintf(stdout, "\t-h \t\t display this help screen.\n\n");
+    fprintf(stdout, " Each benchmark prints one line of JSON.\n\n");
+}
+
+int
+main(
+    int argc,
+    char *argv[])
+{
+    extern char *optarg;
+    extern int optopt;
+    axutil_allocator_t *allocator = NULL;
+    axutil_env_t *env = NULL;
+    axutil_log_levels_t log_level = AXIS2_LOG_LEVEL_ERROR;
+    const axis2_char_t *log_file = "axis2_microbench.log";
+    const axis2_char_t *dir = ".";
+    const axis2_char_t *only = NULL;
+    axis2_bool_t compare = AXIS2_FALSE;
+    int fixed_iterations = 0;
+    double min_time = 500000;
+    int errors = 0;
+    int c = 0;
+    int i = 0;
+
+    while ((c = AXIS2_GETOPT(argc, argv, ":d:b:cn:T:l:f:h")) != -1)
+    {
+        switch (c)
+        {
+        case 'd':
+            dir = optarg;
+            break;
+        case 'b':
+            only = optarg;
+            break;
+        case 'c':
+            compare = AXIS2_TRUE;
+            break;
+        case 'n':
+            fixed_iterations = AXIS2_ATOI(optarg);
+            break;
+        case 'T':
+            min_time = AXIS2_ATOI(optarg) * 1000.0;
+            break;
+        case 'l':
+            log_level = AXIS2_ATOI(optarg);
+            break;
+        case 'f':
+            log_file = optarg;
+            break;
+        case 'h':
+            axis2_microbench_usage(argv[0]);
+            return 0;
+        default:
+            axis2_microbench_usage(argv[0]);
+            return -1;
+        }
+    }
+    if (fixed_iterations < 0 || min_time <= 0)
+    {
+        axis2_microbench_usage(argv[0]);
+        return -1;
+    }
+
+    allocator = (axutil_allocator_t *) malloc(sizeof(axutil_allocator_t));
+    memset(allocator, 0, sizeof(axutil_allocator_t));
+    allocator->malloc_fn = axis2_microbench_malloc;
+    allocator->realloc = axis2_microbench_realloc;
+    allocator->free_fn = axis2_microbench_free;
+    axiom_xml_reader_init();
+    env = axutil_env_create_with_error_log(allocator,
+        axutil_error_create(allocator),
+        axutil_log_create(allocator, NULL, log_file));
+    if (!env)
+    {
+        fprintf(stderr, "\nCould not create the environment\n");
+        return -1;
+    }
+    env->log->level = log_level;
+    axutil_error_init();
+
+    if (AXIS2_SUCCESS != axis2_microbench_setup(env, dir))
+    {
+        fprintf(stderr, "\nCould not set the benchmarks up, see %s\n",
+            log_file);
+        return -1;
+    }
+
+    for (i = 0; axis2_microbench_benches[i].name; i++)
+    {
+        axis2_microbench_t *bench = &axis2_microbench_benches[i];
+        const axis2_char_t *corpus = NULL;
+        int iterations = fixed_iterations ? fixed_iterations : 1;
+        long allocs = 0;
+        double elapsed = 0;
+        double start = 0;
+        int bytes = 0;
+
+        if ((bench->compare && !compare) || (only && 0 != strncmp(
+            bench->name, only, strlen(only))))
+        {
+            continue;
+        }
+
+        /* a first run warms up, and times the operation for the next */
+        bytes = bench->run(env, bench, 1);
+        while (bytes >= 0)
+        {
+            allocs = axis2_microbench_allocs;
+            start = axis2_microbench_now();
+            bytes = bench->run(env, bench, iterations);
+            elapsed = axis2_microbench_now() - start;
+            allocs = axis2_microbench_allocs - allocs;
+            if (fixed_iterations || elapsed >= min_time)
+            {
+                break;
+            }
+            /* aim a little past the least time, at most a hundred times
+               further */
+            if (elapsed * 100 < min_time * 1.2)
+            {
+                iterations *= 100;
+            }
+            else
+            {
+                iterations = (int) (iterations * min_time * 1.2 / elapsed) + 1;
+            }
+        }
+        if (bytes < 0)
+        {
+            fprintf(stderr, "\n%s failed, see %s\n", bench->name, log_file);
+            errors++;
+            continue;
+        }
+
+        corpus = bench->corpus ? strrchr(bench->corpus, '/') + 1 : NULL;
+        fprintf(stdout, "{\"bench\":\"micro\",\"name\":\"%s\",", bench->name);
+        fprintf(stdout, corpus ? "\"corpus\":\"%s\"," : "\"corpus\":null,",
+            corpus);
+        if (bench->parser)
+        {
+            fprintf(stdout, "\"parser\":\"%s\",", bench->parser);
+        }
+        else
+        {
+            fprintf(stdout, "\"parser\":null,");
+        }
+        fprintf(stdout, "\"iterations\":%d,\"bytes\":%d,\"ns_per_op\":%.1f,",
+            iterations, bytes, elapsed * 1000.0 / iterations);
+        if (bytes > 0 && elapsed > 0)
+        {
+            fprintf(stdout, "\"mb_per_s\":%.1f,",
+                (double) bytes * iterations / elapsed);
+        }
+        else
+        {
+            fprintf(stdout, "\"mb_per_s\":null,");
+        }
+        fprintf(stdout, "\"allocs_per_op\":%.1f}\n",
+            (double) allocs / iterations);
+        fflush(stdout);
+    }
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,79 @@
+
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TCPMON_REPLAY_H
+#define TCPMON_REPLAY_H
+
+#include <axutil_env.h>
+
+/**
+ * @file tcpmon_replay.h
+ * @brief replays the requests of a tcpmon log file
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup replay of captured requests
+     * @ingroup tcpmon
+     * @{
+     */
+
+    typedef struct tcpmon_replay_options
+    {
+        /* log file written by tcpmon */
+        char *log_file;
+        char *target_host;
+        int target_port;
+        /* connections the requests are sent on at the same time */
+        int concurrency;
+        /* requests per second over all the connections, 0 for no limit */
+        double rate;
+        /* requests sent, the log is gone through again as needed; 0 to send
+           each request of the log once */
+        int requests;
+        /* milliseconds to wait for a response */
+        int timeout;
+    } tcpmon_replay_options_t;
+
+    /**
+     * Sends the requests captured in a log file to the target again. Each
+     * connection is kept open for the requests after it for as long as the
+     * target keeps it alive. A request is counted as failed when its
+     * response has another status than the response captured with it, or
+     * than 2xx when none was. A summary with the latency distribution is
+     * printed.
+     * @param env pointer to environment struct. MUST NOT be NULL.
+     * @param options what to replay, where and how fast
+     * @return 0 when every request got the expected status, 1 otherwise,
+     * -1 if the log could not be replayed
+     */
+    int tcpmon_replay(
+        const axutil_env_t * env,
+        const tcpmon_replay_options_t * options);
+
+    /** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif                          /* TCPMON_REPLAY_H */
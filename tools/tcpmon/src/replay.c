@@ -0,0 +1,952 @@
+
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <axutil_utils.h>
+#include <axutil_string.h>
+#include <axutil_stream.h>
+#include <axutil_thread.h>
+#include <axutil_thread_pool.h>
+#include <axutil_network_handler.h>
+#include <platforms/axutil_platform_auto_sense.h>
+#include <tcpmon_replay.h>
+#ifndef WIN32
+#include <sys/time.h>
+#endif
+
+/* what on_new_entry_to_file writes between two messages */
+#define TCPMON_REPLAY_SEPARATOR "\n= = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =\n"
+#define TCPMON_REPLAY_MESSAGE_START "---------------------\n"
+#define TCPMON_REPLAY_BUF_SIZE 16384
+#define TCPMON_REPLAY_MAX_STATUS 600
+
+typedef struct tcpmon_replay_request
+{
+    /* the request as it is sent */
+    axis2_char_t *data;
+    int len;
+    /* a response to a HEAD request has no body */
+    axis2_bool_t is_head;
+    /* status of the response captured with it, 0 if there was none */
+    int expected_status;
+} tcpmon_replay_request_t;
+
+typedef struct tcpmon_replay_conn
+{
+    axis2_socket_t socket;
+    axutil_stream_t *stream;
+    /* responses read on the connection */
+    int served;
+    axis2_char_t buf[TCPMON_REPLAY_BUF_SIZE];
+    int pos;
+    int len;
+} tcpmon_replay_conn_t;
+
+typedef struct tcpmon_replay_run
+{
+    const axutil_env_t *env;
+    const tcpmon_replay_options_t *options;
+    tcpmon_replay_request_t *requests;
+    int request_count;
+    int total;
+    /* index of the next request to send, taken under mutex */
+    int next;
+    axutil_thread_mutex_t *mutex;
+    double start;
+    /* microseconds each request took, -1 when it failed */
+    long *latencies;
+    int ok;
+    int wrong_status;
+    int failed;
+    int connections;
+    int statuses[TCPMON_REPLAY_MAX_STATUS];
+} tcpmon_replay_run_t;
+
+static double
+tcpmon_replay_now(void)
+{
+#ifndef WIN32
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+#else
+    struct AXIS2_PLATFORM_TIMEB t;
+
+    AXIS2_PLATFORM_GET_TIME_IN_MILLIS(&t);
+    return t.time * 1000000.0 + t.millitm * 1000.0;
+#endif
+}
+
+static axis2_bool_t
+tcpmon_replay_starts_with(
+    const axis2_char_t * str,
+    const axis2_char_t * end,
+    const axis2_char_t * prefix)
+{
+    int len = (int) strlen(prefix);
+
+    return end - str >= len && 0 == axutil_strncasecmp(str, prefix, len);
+}
+
+/* Finds what between str and end, which may hold a '\0' as message bodies
+   are binary. Returns NULL if it is not there */
+static axis2_char_t *
+tcpmon_replay_find(
+    axis2_char_t * str,
+    axis2_char_t * end,
+    const axis2_char_t * what)
+{
+    int len = (int) strlen(what);
+
+    for (; end - str >= len; str++)
+    {
+        if (*str == *what && 0 == memcmp(str, what, len))
+        {
+            return str;
+        }
+    }
+    return NULL;
+}
+
+/* Tells whether a chunk size line starts at str: hex digits, maybe chunk
+   extensions, and CRLF */
+static axis2_bool_t
+tcpmon_replay_is_chunk_line(
+    const axis2_char_t * str,
+    const axis2_char_t * end)
+{
+    const axis2_char_t *p = str;
+
+    while (p < end && isxdigit((unsigned char) *p))
+    {
+        p++;
+    }
+    if (p == str)
+    {
+        return AXIS2_FALSE;
+    }
+    while (p < end && ';' == *p)
+    {
+        while (p < end && '\r' != *p && '\n' != *p)
+        {
+            p++;
+        }
+    }
+    return end - p >= 2 && '\r' == p[0] && '\n' == p[1];
+}
+
+/* Takes out in place the line breaks the log adds between the elements of
+   an XML body, and returns the length left */
+static int
+tcpmon_replay_unformat(
+    axis2_char_t * body,
+    int len)
+{
+    axis2_char_t *out = body;
+    int i = 0;
+
+    for (i = 0; i < len; i++)
+    {
+        if (!('\n' == body[i] && i > 0 && i < len - 1 && '>' == body[i - 1] &&
+            '<' == body[i + 1]))
+        {
+            *out++ = body[i];
+        }
+    }
+    return (int) (out - body);
+}
+
+/* Removes the chunk framing of a captured body in place and returns the
+   length of the data, and in declared the length the chunk sizes add up to.
+   The log has line breaks added between the elements, so a chunk is taken
+   to run up to the next chunk size line found after its size */
+static int
+tcpmon_replay_dechunk(
+    axis2_char_t * body,
+    int len,
+    int *declared)
+{
+    axis2_char_t *end = body + len;
+    axis2_char_t *p = body;
+    axis2_char_t *out = body;
+
+    while (p < end)
+    {
+        axis2_char_t *data = NULL;
+        axis2_char_t *next = NULL;
+        long size = strtol(p, NULL, 16);
+
+        *declared += size > 0 ? (int) size : 0;
+        while (p < end && '\n' != *p)
+        {
+            p++;
+        }
+        if (p == end || 0 >= size)
+        {
+            break;
+        }
+        data = ++p;
+        for (next = data + size > end ? end : data + size; next < end - 1;
+            next++)
+        {
+            if ('\r' == next[0] && '\n' == next[1] &&
+                tcpmon_replay_is_chunk_line(next + 2, end))
+            {
+                break;
+            }
+        }
+        if (next >= end - 1)
+        {
+            next = end;
+        }
+        memmove(out, data, next - data);
+        out += next - data;
+        p = next + 2;
+    }
+    return (int) (out - body);
+}
+
+/* Makes the request to send out of a message of the log. The headers are
+   put back on one line each, the Host header is set to the target, and the
+   body, which the log may have changed, is sent with its length. Returns
+   AXIS2_FAILURE if the message is not a request */
+static axis2_status_t
+tcpmon_replay_make_request(
+    const axutil_env_t * env,
+    const tcpmon_replay_options_t * options,
+    axis2_char_t * message,
+    axis2_char_t * end,
+    tcpmon_replay_request_t * request)
+{
+    axis2_char_t *headers_end = NULL;
+    axis2_char_t *body = NULL;
+    axis2_char_t *line = NULL;
+    axis2_char_t *out = NULL;
+    int body_len = 0;
+    /* length of the body when it was sent, -1 if unknown */
+    int sent_len = -1;
+    axis2_bool_t chunked = AXIS2_FALSE;
+    axis2_bool_t has_body = AXIS2_TRUE;
+    axis2_bool_t first = AXIS2_TRUE;
+    axis2_bool_t http10 = AXIS2_FALSE;
+
+    /* the log is read as a string, the body may hold binary data */
+    for (headers_end = message; headers_end + 4 <= end; headers_end++)
+    {
+        if (0 == memcmp(headers_end, "\r\n\r\n", 4))
+        {
+            break;
+        }
+    }
+    if (headers_end + 4 > end || !isupper((unsigned char) *message))
+    {
+        return AXIS2_FAILURE;
+    }
+    body = headers_end + 4;
+    body_len = (int) (end - body);
+
+    request->is_head = tcpmon_replay_starts_with(message, end, "HEAD ");
+    if (request->is_head || tcpmon_replay_starts_with(message, end, "GET ") ||
+        tcpmon_replay_starts_with(message, end, "DELETE "))
+    {
+        has_body = AXIS2_FALSE;
+        body_len = 0;
+    }
+
+    request->data = AXIS2_MALLOC(env->allocator, (headers_end - message) +
+        body_len + strlen(options->target_host) + 128);
+    if (!request->data)
+    {
+        return AXIS2_FAILURE;
+    }
+    out = request->data;
+    line = message;
+    while (line < headers_end)
+    {
+        axis2_char_t *line_end = line;
+
+        /* a header the log broke at "; " goes on with a tab */
+        while (line_end < headers_end && !('\r' == line_end[0] &&
+            '\n' == line_end[1]))
+        {
+            line_end++;
+        }
+        if (tcpmon_replay_starts_with(line, line_end, "Transfer-Encoding:"))
+        {
+            chunked = NULL != tcpmon_replay_find(line, line_end, "chunked");
+        }
+        else if (tcpmon_replay_starts_with(line, line_end, "Content-Length:"))
+        {
+            sent_len = atoi(line + 15);
+        }
+        if (first || !(tcpmon_replay_starts_with(line, line_end, "Host:") ||
+            tcpmon_replay_starts_with(line, line_end, "Content-Length:") ||
+            tcpmon_replay_starts_with(line, line_end, "Transfer-Encoding:") ||
+            tcpmon_replay_starts_with(line, line_end, "Connection:") ||
+            tcpmon_replay_starts_with(line, line_end, "Keep-Alive:")))
+        {
+            axis2_char_t *p = NULL;
+
+            for (p = line; p < line_end; p++)
+            {
+                if (';' == p[0] && line_end - p >= 3 && '\n' == p[1] &&
+                    '\t' == p[2])
+                {
+                    *out++ = ';';
+                    *out++ = ' ';
+                    p += 2;
+                }
+                else
+                {
+                    *out++ = *p;
+                }
+            }
+            *out++ = '\r';
+            *out++ = '\n';
+        }
+        if (first)
+        {
+            http10 = line_end - line > 9 &&
+                0 == memcmp(line_end - 9, " HTTP/1.0", 9);
+        }
+        first = AXIS2_FALSE;
+        line = line_end + 2;
+    }
+    out += sprintf(out, "Host: %s:%d\r\n", options->target_host,
+        options->target_port);
+    if (chunked)
+    {
+        sent_len = 0;
+        body_len = tcpmon_replay_dechunk(body, body_len, &sent_len);
+    }
+    if (has_body && sent_len >= 0 && sent_len != body_len)
+    {
+        body_len = tcpmon_replay_unformat(body, body_len);
+    }
+    if (has_body)
+    {
+        out += sprintf(out, "Content-Length: %d\r\n", body_len);
+    }
+    if (http10)
+    {
+        out += sprintf(out, "Connection: Keep-Alive\r\n");
+    }
+    *out++ = '\r';
+    *out++ = '\n';
+    memcpy(out, body, body_len);
+    out += body_len;
+    request->len = (int) (out - request->data);
+    request->expected_status = 0;
+    return AXIS2_SUCCESS;
+}
+
+/* Reads the requests of the log, each with the status of the response
+   captured after it. count is set to -1 if the log could not be read. Responses are matched to the requests in order, which
+   holds unless the log was written by several connections at once */
+static tcpmon_replay_request_t *
+tcpmon_replay_load(
+    const axutil_env_t * env,
+    const tcpmon_replay_options_t * options,
+    int *count)
+{
+    tcpmon_replay_request_t *requests = NULL;
+    axis2_char_t *log = NULL;
+    axis2_char_t *section = NULL;
+    axis2_char_t *log_end = NULL;
+    FILE *file = NULL;
+    long size = 0;
+    int max = 0;
+    int answered = 0;
+
+    *count = 0;
+    file = fopen(options->log_file, "rb");
+    if (!file)
+    {
+        printf("\ncould not open log-file %s\n", options->log_file);
+        *count = -1;
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    log = AXIS2_MALLOC(env->allocator, size + 1);
+    if (!log || fread(log, 1, size, file) != (size_t) size)
+    {
+        fclose(file);
+        AXIS2_FREE(env->allocator, log);
+        printf("\ncould not read log-file %s\n", options->log_file);
+        *count = -1;
+        return NULL;
+    }
+    fclose(file);
+    log[size] = '\0';
+    log_end = log + size;
+
+    section = log;
+    while (section < log_end)
+    {
+        axis2_char_t *section_end = NULL;
+        axis2_char_t *message = NULL;
+
+        section_end = tcpmon_replay_find(section, log_end,
+            TCPMON_REPLAY_SEPARATOR);
+        if (!section_end)
+        {
+            section_end = log_end;
+        }
+        message = tcpmon_replay_find(section, section_end,
+            TCPMON_REPLAY_MESSAGE_START);
+        if (message)
+        {
+            message += strlen(TCPMON_REPLAY_MESSAGE_START);
+            if (tcpmon_replay_starts_with(section, section_end,
+                "SENDING DATA..") || tcpmon_replay_starts_with(section,
+                section_end, "RESENDING DATA.."))
+            {
+                if (*count == max)
+                {
+                    max = max ? max * 2 : 64;
+                    requests = AXIS2_REALLOC(env->allocator, requests,
+                        sizeof(tcpmon_replay_request_t) * max);
+                }
+                if (AXIS2_SUCCESS == tcpmon_replay_make_request(env, options,
+                    message, section_end, &requests[*count]))
+                {
+                    (*count)++;
+                }
+            }
+            else if (tcpmon_replay_starts_with(section, section_end,
+                "RETRIEVING DATA..") && answered < *count &&
+                tcpmon_replay_starts_with(message, section_end, "HTTP/"))
+            {
+                axis2_char_t *status = tcpmon_replay_find(message,
+                    section_end, " ");
+
+                if (status)
+                {
+                    requests[answered++].expected_status = atoi(status + 1);
+                }
+            }
+        }
+        section = section_end + strlen(TCPMON_REPLAY_SEPARATOR);
+    }
+    AXIS2_FREE(env->allocator, log);
+    return requests;
+}
+
+static void
+tcpmon_replay_close(
+    const axutil_env_t * env,
+    tcpmon_replay_conn_t * conn)
+{
+    if (conn->stream)
+    {
+        axutil_stream_free(conn->stream, env);
+        conn->stream = NULL;
+    }
+    if (conn->socket >= 0)
+    {
+        axutil_network_handler_close_socket(env, conn->socket);
+        conn->socket = -1;
+    }
+    conn->served = 0;
+    conn->pos = 0;
+    conn->len = 0;
+}
+
+/* Reads once more of the response into the buffer. Returns the number of
+   bytes read, 0 or -1 at the end of the connection */
+static int
+tcpmon_replay_fill(
+    const axutil_env_t * env,
+    tcpmon_replay_conn_t * conn)
+{
+    int len = 0;
+
+    if (conn->pos > 0)
+    {
+        memmove(conn->buf, conn->buf + conn->pos, conn->len - conn->pos);
+        conn->len -= conn->pos;
+        conn->pos = 0;
+    }
+    if (conn->len >= TCPMON_REPLAY_BUF_SIZE - 1)
+    {
+        return -1;
+    }
+    len = axutil_stream_read(conn->stream, env, conn->buf + conn->len,
+        TCPMON_REPLAY_BUF_SIZE - 1 - conn->len);
+    if (len > 0)
+    {
+        conn->len += len;
+    }
+    return len;
+}
+
+/* Returns the next line of the response, without its line end */
+static axis2_char_t *
+tcpmon_replay_read_line(
+    const axutil_env_t * env,
+    tcpmon_replay_conn_t * conn)
+{
+    while (1)
+    {
+        axis2_char_t *start = conn->buf + conn->pos;
+        axis2_char_t *end = memchr(start, '\n', conn->len - conn->pos);
+
+        if (end)
+        {
+            *end = '\0';
+            if (end > start && '\r' == end[-1])
+            {
+                end[-1] = '\0';
+            }
+            conn->pos = (int) (end - conn->buf) + 1;
+            return start;
+        }
+        if (tcpmon_replay_fill(env, conn) <= 0)
+        {
+            return NULL;
+        }
+    }
+}
+
+/* Reads and drops count bytes of the response, or up to the end of the
+   connection when count is -1 */
+static axis2_status_t
+tcpmon_replay_skip(
+    const axutil_env_t * env,
+    tcpmon_replay_conn_t * conn,
+    long count)
+{
+    while (count)
+    {
+        int len = conn->len - conn->pos;
+
+        if (0 == len)
+        {
+            conn->pos = conn->len = 0;
+            if (tcpmon_replay_fill(env, conn) <= 0)
+            {
+                return count < 0 ? AXIS2_SUCCESS : AXIS2_FAILURE;
+            }
+            continue;
+        }
+        if (count > 0 && len > count)
+        {
+            len = (int) count;
+        }
+        conn->pos += len;
+        if (count > 0)
+        {
+            count -= len;
+        }
+    }
+    return AXIS2_SUCCESS;
+}
+
+/* Reads a response and returns its status, or -1. keep_alive tells
+   whether the connection can take the next request */
+static int
+tcpmon_replay_read_response(
+    const axutil_env_t * env,
+    tcpmon_replay_conn_t * conn,
+    const tcpmon_replay_request_t * request,
+    axis2_bool_t * keep_alive)
+{
+    axis2_char_t *line = NULL;
+    int status = 0;
+
+    do
+    {
+        long content_length = -1;
+        axis2_bool_t chunked = AXIS2_FALSE;
+
+        line = tcpmon_replay_read_line(env, conn);
+        if (!line || 0 != strncmp(line, "HTTP/1.", 7) || !strchr(line, ' '))
+        {
+            return -1;
+        }
+        *keep_alive = '0' != line[7];
+        status = atoi(strchr(line, ' ') + 1);
+        while ((line = tcpmon_replay_read_line(env, conn)) && *line)
+        {
+            if (0 == axutil_strncasecmp(line, "Content-Length:", 15))
+            {
+                content_length = atol(line + 15);
+            }
+            else if (0 == axutil_strncasecmp(line, "Transfer-Encoding:", 18))
+            {
+                chunked = NULL != axutil_strcasestr(line, "chunked");
+            }
+            else if (0 == axutil_strncasecmp(line, "Connection:", 11))
+            {
+                *keep_alive = NULL != axutil_strcasestr(line, "keep-alive");
+            }
+        }
+        if (!line)
+        {
+            return -1;
+        }
+        if (request->is_head || status < 200 || 204 == status ||
+            304 == status)
+        {
+            continue;
+        }
+        if (chunked)
+        {
+            long size = 0;
+
+            do
+            {
+                line = tcpmon_replay_read_line(env, conn);
+                size = line ? strtol(line, NULL, 16) : -1;
+                if (size > 0 && (AXIS2_SUCCESS != tcpmon_replay_skip(env,
+                    conn, size) || !tcpmon_replay_read_line(env, conn)))
+                {
+                    return -1;
+                }
+            }
+            while (size > 0);
+            /* the trailer ends with an empty line */
+            while (0 == size && (line = tcpmon_replay_read_line(env, conn)) &&
+                *line);
+            if (size < 0 || !line)
+            {
+                return -1;
+            }
+        }
+        else if (content_length >= 0)
+        {
+            if (AXIS2_SUCCESS != tcpmon_replay_skip(env, conn,
+                content_length))
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            /* the body ends with the connection */
+            *keep_alive = AXIS2_FALSE;
+            tcpmon_replay_skip(env, conn, -1);
+        }
+    }
+    /* an interim response, such as 100 Continue, comes before the real one */
+    while (status < 200);
+    return status;
+}
+
+/* Sends the request on the connection, opened if it is not, and reads the
+   response. Returns the status of the response or -1 */
+static int
+tcpmon_replay_send(
+    const axutil_env_t * env,
+    tcpmon_replay_run_t * run,
+    tcpmon_replay_conn_t * conn,
+    const tcpmon_replay_request_t * request)
+{
+    axis2_bool_t keep_alive = AXIS2_FALSE;
+    axis2_bool_t reused = AXIS2_FALSE;
+    int status = -1;
+    int sent = 0;
+    int len = 0;
+
+    while (1)
+    {
+        if (conn->socket < 0)
+        {
+            conn->socket = axutil_network_handler_open_socket(env,
+                run->options->target_host, run->options->target_port);
+            if (conn->socket < 0)
+            {
+                return -1;
+            }
+            axutil_network_handler_set_sock_option(env, conn->socket,
+                SO_RCVTIMEO, run->options->timeout);
+            conn->stream = axutil_stream_create_socket(env, conn->socket);
+            axutil_thread_mutex_lock(run->mutex);
+            run->connections++;
+            axutil_thread_mutex_unlock(run->mutex);
+        }
+        reused = conn->served > 0;
+        for (sent = 0; sent < request->len; sent += len)
+        {
+            len = axutil_stream_write(conn->stream, env, request->data + sent,
+                request->len - sent);
+            if (len <= 0)
+            {
+                break;
+            }
+        }
+        if (sent == request->len)
+        {
+            status = tcpmon_replay_read_response(env, conn, request,
+                &keep_alive);
+        }
+        if (status > 0)
+        {
+            break;
+        }
+        /* a connection kept alive may have been closed by the target before
+           it read the request, which is sent again on a new one */
+        tcpmon_replay_close(env, conn);
+        if (!reused)
+        {
+            return -1;
+        }
+    }
+    conn->served++;
+    if (!keep_alive)
+    {
+        tcpmon_replay_close(env, conn);
+    }
+    return status;
+}
+
+static void *AXIS2_THREAD_FUNC
+tcpmon_replay_worker(
+    axutil_thread_t * thd,
+    void *data)
+{
+    tcpmon_replay_run_t *run = (tcpmon_replay_run_t *) data;
+    tcpmon_replay_conn_t *conn = NULL;
+    axutil_env_t *env = axutil_init_thread_env(run->env);
+
+    conn = AXIS2_MALLOC(env->allocator, sizeof(tcpmon_replay_conn_t));
+    if (!conn)
+    {
+        axutil_free_thread_env(env);
+        return NULL;
+    }
+    conn->socket = -1;
+    conn->stream = NULL;
+    tcpmon_replay_close(env, conn);
+
+    while (1)
+    {
+        tcpmon_replay_request_t *request = NULL;
+        double start = 0;
+        int status = 0;
+        int index = 0;
+
+        axutil_thread_mutex_lock(run->mutex);
+        index = run->next++;
+        axutil_thread_mutex_unlock(run->mutex);
+        if (index >= run->total)
+        {
+            break;
+        }
+        request = &run->requests[index % run->request_count];
+
+        start = tcpmon_replay_now();
+        if (run->options->rate > 0)
+        {
+            /* the latency counts from when the request was due, so that a
+               target falling behind the rate shows in it */
+            double due = run->start + index * 1000000.0 / run->options->rate;
+
+            while (start < due)
+            {
+                AXIS2_USLEEP((due - start) > 500000 ? 500000 :
+                    (unsigned int) (due - start));
+                start = tcpmon_replay_now();
+            }
+            start = due;
+        }
+        status = tcpmon_replay_send(env, run, conn, request);
+        run->latencies[index] = status > 0 ?
+            (long) (tcpmon_replay_now() - start) : -1;
+
+        axutil_thread_mutex_lock(run->mutex);
+        if (status <= 0)
+        {
+            run->failed++;
+        }
+        else
+        {
+            if (status < TCPMON_REPLAY_MAX_STATUS)
+            {
+                run->statuses[status]++;
+            }
+            if (request->expected_status ? status == request->expected_status
+                : status / 100 == 2)
+            {
+                run->ok++;
+            }
+            else
+            {
+                run->wrong_status++;
+            }
+        }
+        axutil_thread_mutex_unlock(run->mutex);
+    }
+
+    tcpmon_replay_close(env, conn);
+    AXIS2_FREE(env->allocator, conn);
+    axutil_free_thread_env(env);
+    return NULL;
+}
+
+static int
+tcpmon_replay_compare_latency(
+    const void *a,
+    const void *b)
+{
+    long la = *(const long *) a;
+    long lb = *(const long *) b;
+
+    return la < lb ? -1 : la > lb;
+}
+
+/* nearest rank percentile of sorted latencies, in milliseconds */
+static double
+tcpmon_replay_percentile(
+    long *latencies,
+    int count,
+    double percent)
+{
+    int rank = (int) (percent / 100.0 * count + 0.999999);
+
+    if (count <= 0)
+    {
+        return 0;
+    }
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+    if (rank > count)
+    {
+        rank = count;
+    }
+    return latencies[rank - 1] / 1000.0;
+}
+
+int
+tcpmon_replay(
+    const axutil_env_t * env,
+    const tcpmon_replay_options_t * options)
+{
+    tcpmon_replay_run_t run;
+    axutil_thread_t **threads = NULL;
+    double seconds = 0;
+    int done = 0;
+    int i = 0;
+
+    memset(&run, 0, sizeof(run));
+    run.env = env;
+    run.options = options;
+    run.requests = tcpmon_replay_load(env, options, &run.request_count);
+    if (run.request_count < 0)
+    {
+        return -1;
+    }
+    if (!run.request_count)
+    {
+        printf("\nno request found in log-file %s\n", options->log_file);
+        AXIS2_FREE(env->allocator, run.requests);
+        return -1;
+    }
+    run.total = options->requests > 0 ? options->requests : run.request_count;
+    run.latencies = AXIS2_MALLOC(env->allocator, sizeof(long) * run.total);
+    threads = AXIS2_MALLOC(env->allocator,
+        sizeof(axutil_thread_t *) * options->concurrency);
+    run.mutex = axutil_thread_mutex_create(env->allocator,
+        AXIS2_THREAD_MUTEX_DEFAULT);
+    if (!run.latencies || !threads || !run.mutex)
+    {
+        printf("\ngimme more memory\n");
+        return -1;
+    }
+
+    printf("Replaying %d requests of %s (%d captured) to %s:%d on %d "
+        "connection(s)", run.total, options->log_file, run.request_count,
+        options->target_host, options->target_port, options->concurrency);
+    if (options->rate > 0)
+    {
+        printf(" at %.1f requests/s", options->rate);
+    }
+    printf("\n");
+    fflush(stdout);
+
+    run.start = tcpmon_replay_now();
+    for (i = 0; i < options->concurrency; i++)
+    {
+        threads[i] = axutil_thread_create(env->allocator, NULL,
+            tcpmon_replay_worker, &run);
+    }
+    for (i = 0; i < options->concurrency; i++)
+    {
+        if (threads[i])
+        {
+            axutil_thread_join(threads[i]);
+        }
+    }
+    seconds = (tcpmon_replay_now() - run.start) / 1000000.0;
+
+    /* the requests that failed have no latency */
+    for (i = 0; i < run.total; i++)
+    {
+        if (i < run.next && run.latencies[i] >= 0)
+        {
+            run.latencies[done++] = run.latencies[i];
+        }
+    }
+    qsort(run.latencies, done, sizeof(long), tcpmon_replay_compare_latency);
+
+    printf("requests  : %d ok, %d with another status than captured, "
+        "%d failed\n", run.ok, run.wrong_status, run.failed);
+    printf("statuses  :");
+    for (i = 0; i < TCPMON_REPLAY_MAX_STATUS; i++)
+    {
+        if (run.statuses[i])
+        {
+            printf(" %d x %d", i, run.statuses[i]);
+        }
+    }
+    printf("\nconnections opened : %d\n", run.connections);
+    printf("time      : %.3f s, %.1f requests/s\n", seconds,
+        seconds > 0 ? (run.ok + run.wrong_status) / seconds : 0.0);
+    printf("latency ms: min %.3f p50 %.3f p90 %.3f p99 %.3f p99.9 %.3f "
+        "max %.3f\n", done ? run.latencies[0] / 1000.0 : 0.0,
+        tcpmon_replay_percentile(run.latencies, done, 50),
+        tcpmon_replay_percentile(run.latencies, done, 90),
+        tcpmon_replay_percentile(run.latencies, done, 99),
+        tcpmon_replay_percentile(run.latencies, done, 99.9),
+        done ? run.latencies[done - 1] / 1000.0 : 0.0);
+
+    for (i = 0; i < options->concurrency; i++)
+    {
+        if (threads[i])
+        {
+            AXIS2_FREE(env->allocator, threads[i]);
+        }
+    }
+    AXIS2_FREE(env->allocator, threads);
+    axutil_thread_mutex_destroy(run.mutex);
+    AXIS2_FREE(env->allocator, run.latencies);
+    for (i = 0; i < run.request_count; i++)
+    {
+        AXIS2_FREE(env->allocator, run.requests[i].data);
+    }
+    AXIS2_FREE(env->allocator, run.requests);
+    return run.ok == run.total ? 0 : 1;
+}
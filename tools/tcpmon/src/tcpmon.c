@@ -24,6 +24,7 @@
 #include <tcpmon_session.h>
 #include <tcpmon_entry.h>
 #include <tcpmon_util.h>
+#include <tcpmon_replay.h>
 #include <signal.h>
 #include <stdio.h>
 #include <axutil_stream.h>
@@ -73,12 +74,19 @@ main(
     int test_bit = 0;
     int format_bit = 0;  /* pretty print the request/response SOAP messages */
     int ii = 1;
+    int replay = 0;
+    tcpmon_replay_options_t replay_options;
+
+    memset(&replay_options, 0, sizeof(replay_options));
+    replay_options.concurrency = 1;
+    replay_options.timeout = 30000;
 
     if (!axutil_strcmp(argv[1], "-h"))
     {
         printf
-            ("Usage : %s [-lp LISTEN_PORT] [-tp TARGET_PORT] [-th TARGET_HOST] [-f LOG_FILE] [options]\n",
-             argv[0]);
+            ("Usage : %s [-lp LISTEN_PORT] [-tp TARGET_PORT] [-th TARGET_HOST] [-f LOG_FILE] [options]\n"
+             "        %s --replay [-tp TARGET_PORT] [-th TARGET_HOST] [-f LOG_FILE] [-c CONCURRENCY] [-r RATE] [-n REQUESTS]\n",
+             argv[0], argv[0]);
         fprintf(stdout, " Options :\n");
         fprintf(stdout,
                 "\t-lp LISTEN_PORT \tport number to listen on, default is 9099\n");
@@ -93,6 +101,17 @@ main(
                 "\t--format        \tenable xml formatting\n");
         fprintf(stdout,
                 "\t--test          \tenable testing last request/response by logging it separately\n");
+        fprintf(stdout,
+                "\t--replay        \tsend the requests of LOG_FILE to the target again instead of listening\n");
+        fprintf(stdout,
+                "\t-c  CONCURRENCY \tconnections to replay on at the same time, default is 1\n");
+        fprintf(stdout,
+                "\t-r  RATE        \trequests per second to replay at, default is as fast as the target answers\n");
+        fprintf(stdout,
+                "\t-n  REQUESTS    \trequests to replay, going through LOG_FILE again as needed, default is each once\n");
+        fprintf(stdout,
+                "\t-to TIMEOUT     \tmilliseconds to wait for a replayed response, default is %d\n",
+                replay_options.timeout);
         fprintf(stdout, " Help :\n\t-h              \tdisplay this help screen.\n\n");
         return 0;
     }
@@ -168,6 +187,31 @@ main(
             ii++;
             format_bit = 1;
         }
+        else if (!strcmp("--replay", argv[ii]))
+        {
+            ii++;
+            replay = 1;
+        }
+        else if (!strcmp("-c", argv[ii]) && ii + 1 < argc)
+        {
+            ii++;
+            replay_options.concurrency = atoi(argv[ii++]);
+        }
+        else if (!strcmp("-r", argv[ii]) && ii + 1 < argc)
+        {
+            ii++;
+            replay_options.rate = atof(argv[ii++]);
+        }
+        else if (!strcmp("-n", argv[ii]) && ii + 1 < argc)
+        {
+            ii++;
+            replay_options.requests = atoi(argv[ii++]);
+        }
+        else if (!strcmp("-to", argv[ii]) && ii + 1 < argc)
+        {
+            ii++;
+            replay_options.timeout = atoi(argv[ii++]);
+        }
         else if (!strcmp("-f", argv[ii]))
         {
             ii++;
@@ -204,6 +248,28 @@ main(
         return 0;
     }
 
+    if (replay)
+    {
+        int status = -1;
+
+        if (replay_options.concurrency <= 0 || replay_options.rate < 0 ||
+            replay_options.requests < 0 || replay_options.timeout <= 0)
+        {
+            printf("INVALID value for -c, -r, -n or -to\n");
+            printf("Use -h for help\n");
+        }
+        else
+        {
+            replay_options.log_file = tcpmon_traffic_log;
+            replay_options.target_host = target_host;
+            replay_options.target_port = target_port;
+            status = tcpmon_replay(env, &replay_options);
+        }
+        AXIS2_FREE(env->allocator, target_host);
+        axutil_env_free(env);
+        return status < 0 ? 2 : status;
+    }
+
     printf("Listen port : %d Target port : %d Target host: %s\n",
            listen_port, target_port, target_host);
     session = tcpmon_session_create(env);
@@ -1010,8 +1076,11 @@ sig_handler(
             AXIS2_LOG_INFO(system_env->log, "Received signal SIGINT. Utility "
                            "shutting down");
             printf("\n\n");
-            TCPMON_SESSION_STOP(session, system_env);
-            TCPMON_SESSION_FREE(session, system_env);
+            if (session)
+            {
+                TCPMON_SESSION_STOP(session, system_env);
+                TCPMON_SESSION_FREE(session, system_env);
+            }
             AXIS2_FREE(system_env->allocator, target_host);
             if (system_env)
             {
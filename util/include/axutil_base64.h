@@ -16,6 +16,7 @@
  */
 
 #include <axutil_utils_defines.h>
+#include <axutil_env.h>
 
 /*
  * @file axutil_base64.h
@@ -114,6 +115,54 @@ extern "C"
         unsigned char *plain_dst,
         const char *coded_src);
 
+    /** Type name for struct axutil_base64_decoder */
+    typedef struct axutil_base64_decoder axutil_base64_decoder_t;
+
+    /*
+     * Create an incremental decoder, for base64 text that arrives in
+     * several pieces (e.g. split over text nodes or read buffers).
+     * @param env pointer to environment struct
+     * @return the decoder, or NULL on error
+     */
+    AXIS2_EXTERN axutil_base64_decoder_t *AXIS2_CALL
+    axutil_base64_decoder_create(
+        const axutil_env_t * env);
+
+    AXIS2_EXTERN void AXIS2_CALL
+    axutil_base64_decoder_free(
+        axutil_base64_decoder_t * decoder,
+        const axutil_env_t * env);
+
+    /*
+     * Decode the next piece of encoded text. Whitespace is skipped, and
+     * padding or any other non valid char ends the data; the rest of that
+     * piece and all later pieces are ignored. Chars of an incomplete quad
+     * are kept until the next call.
+     * @param plain_dst The destination buffer. size of this should be at
+     * least (len_coded_src / 4 + 1) * 3
+     * @param coded_src The encoded text, not assumed '\0' terminated
+     * @param len_coded_src The length of the encoded text
+     * @return the number of bytes written to plain_dst, -1 on error
+     */
+    AXIS2_EXTERN int AXIS2_CALL
+    axutil_base64_decoder_decode(
+        axutil_base64_decoder_t * decoder,
+        const axutil_env_t * env,
+        unsigned char *plain_dst,
+        const char *coded_src,
+        int len_coded_src);
+
+    /*
+     * Flush an unpadded trailing group after the last piece was decoded.
+     * @param plain_dst The destination buffer, with room for 2 bytes
+     * @return the number of bytes written to plain_dst, -1 on error
+     */
+    AXIS2_EXTERN int AXIS2_CALL
+    axutil_base64_decoder_finish(
+        axutil_base64_decoder_t * decoder,
+        const axutil_env_t * env,
+        unsigned char *plain_dst);
+
     /* @} */
 #ifdef __cplusplus
 }
@@ -0,0 +1,87 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AXUTIL_FREE_LIST_H
+#define AXUTIL_FREE_LIST_H
+
+/**
+ * @file axutil_free_list.h
+ * @brief per thread free lists of fixed size objects
+ */
+
+#include <axutil_utils_defines.h>
+#include <axutil_allocator.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup axutil_free_list free list
+     * @ingroup axis2_util
+     * @{
+     */
+
+    /**
+     * Allocates an object of a fixed size, taking it from the free list the
+     * calling thread keeps for that size when there is one. Objects created
+     * and freed for every request, such as message contexts and om nodes,
+     * are so allocated once per thread rather than once per request.
+     * The memory is not cleared; as with AXIS2_MALLOC every field has to be
+     * set by the caller. Free lists are kept only for allocators that do not
+     * allocate out of memory pools, other allocators are used directly.
+     * @param allocator allocator the object is allocated with
+     * @param size size of the object, the same for all objects of its type
+     * @return the object. NULL on error.
+     */
+    AXIS2_EXTERN void *AXIS2_CALL
+    axutil_free_list_malloc(
+        axutil_allocator_t * allocator,
+        size_t size);
+
+    /**
+     * Frees an object allocated with axutil_free_list_malloc or with
+     * AXIS2_MALLOC, putting it on the free list of the calling thread for
+     * its size unless that list is full.
+     * @param allocator allocator the object was allocated with
+     * @param ptr object to be freed, may be NULL
+     * @param size size the object was allocated with
+     */
+    AXIS2_EXTERN void AXIS2_CALL
+    axutil_free_list_free(
+        axutil_allocator_t * allocator,
+        void *ptr,
+        size_t size);
+
+    /**
+     * Frees the objects kept on the free lists of the calling thread for the
+     * given allocator. The free lists of a thread are released when it
+     * exits, and those of the thread freeing an allocator when it is freed.
+     * @param allocator allocator whose objects are freed
+     */
+    AXIS2_EXTERN void AXIS2_CALL
+    axutil_free_list_release(
+        axutil_allocator_t * allocator);
+
+    /** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif                          /* AXUTIL_FREE_LIST_H */
@@ -263,6 +263,48 @@ extern "C"
         const axutil_env_t * env,
         const axis2_char_t * key);
 
+    /**
+     * A string key whose entry a hash table keeps a slot for, see
+     * axutil_hash_set_slots.
+     */
+    typedef struct axutil_hash_slot_key
+    {
+        const axis2_char_t *key;
+        /** length of the key, without the NUL terminator */
+        axis2_ssize_t klen;
+    } axutil_hash_slot_key_t;
+
+    /**
+     * Make the hash table keep track of the entries of the given keys, so
+     * that their values can be got by position with axutil_hash_get_slot
+     * without hashing the key. The entries stay ordinary entries, set,
+     * deleted and iterated over as any other.
+     * @param ht The hash table
+     * @param env The environment to use for hash table
+     * @param keys The keys, which must outlive the hash table
+     * @param count The number of keys
+     * @return AXIS2_SUCCESS on success, else AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axutil_hash_set_slots(
+        axutil_hash_t * ht,
+        const axutil_env_t * env,
+        const axutil_hash_slot_key_t * keys,
+        int count);
+
+    /**
+     * Look up the value of a slot key in the hash table.
+     * @param ht The hash table
+     * @param slot Position of the key in the keys given to
+     *  axutil_hash_set_slots
+     * @return Returns NULL if the key is not present, or if the table has
+     *  no such slot.
+     */
+    AXIS2_EXTERN void *AXIS2_CALL
+    axutil_hash_get_slot(
+        axutil_hash_t * ht,
+        int slot);
+
     /**
      * @param ht hash table to be freed
      * @param env The environment to use for hash table
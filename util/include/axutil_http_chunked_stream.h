@@ -49,6 +49,9 @@ extern "C"
         int content_length;
         int unread_len;
         axutil_http_chunked_stream_t *chunked_stream;
+        /* when set, gets a copy of up to tee_max of the bytes read */
+        axutil_stream_t *tee;
+        int tee_max;
     };
     typedef struct axis2_callback_info axis2_callback_info_t;
 
@@ -66,6 +69,21 @@ extern "C"
         void *buffer,
         size_t count);
 
+    /**
+    * Reads the next part of the chunk data without copying it. The bytes are
+    * left where the chunked stream buffered them and stay valid until the
+    * next call on the chunked stream.
+    * @param chunked_stream pointer to chunked stream
+    * @param env pointer to environment struct
+    * @param slice set to the start of the bytes read
+    * @return no: of bytes read, 0 after the last chunk, -1 on error
+    */
+    AXIS2_EXTERN int AXIS2_CALL
+    axutil_http_chunked_stream_read_slice(
+        axutil_http_chunked_stream_t * chunked_stream,
+        const axutil_env_t * env,
+        const axis2_char_t ** slice);
+
     /**
     * @param env pointer to environment struct
     * @param buffer
@@ -78,6 +96,25 @@ extern "C"
         const void *buffer,
         size_t count);
 
+    /**
+    * Writes count bytes of a file as chunks, a single one unless the file
+    * is larger than 1 GB. The chunk framing is written around the file
+    * content, which is passed to axutil_stream_send_file so that plain
+    * sockets can use sendfile(2).
+    * @param chunked_stream pointer to chunked stream
+    * @param env pointer to environment struct
+    * @param fp file opened for reading
+    * @param count number of bytes to be sent from the file, must be > 0
+    * @return AXIS2_SUCCESS if all count bytes were written, else
+    * AXIS2_FAILURE
+    */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axutil_http_chunked_stream_write_file(
+        axutil_http_chunked_stream_t * chunked_stream,
+        const axutil_env_t * env,
+        FILE * fp,
+        size_t count);
+
     /**
     * @param chunked_stream pointer to chunked stream
     * @param env pointer to environment struct
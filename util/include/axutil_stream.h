@@ -257,6 +257,24 @@ extern "C"
         void *buffer,
         size_t count);
 
+    /**
+     * Writes count bytes of the given file, starting from its current
+     * position, into the stream. On a plain socket stream the data is handed
+     * to sendfile(2) where the platform provides it, so the file content is
+     * never copied through user space. Other streams fall back to a buffered
+     * read/write loop.
+     * @param fp file opened for reading
+     * @param count number of bytes to be written
+     * @return AXIS2_SUCCESS if all count bytes were written, else
+     * AXIS2_FAILURE
+     */
+    AXIS2_EXTERN axis2_status_t AXIS2_CALL
+    axutil_stream_send_file(
+        axutil_stream_t * stream,
+        const axutil_env_t * env,
+        FILE * fp,
+        size_t count);
+
     AXIS2_EXTERN axis2_status_t AXIS2_CALL
     axutil_stream_flush(
         axutil_stream_t * stream,
@@ -117,6 +117,40 @@ extern "C"
     axutil_free_thread_env(
         struct axutil_env *thread_env);
 
+    /**
+     * Gets the environment of the calling thread. It is created from
+     * system_env the first time and kept for the thread, so a thread serving
+     * one request after another does not create a new environment, and error,
+     * for each. It is freed when the thread exits. Only one user at a time
+     * per thread; on Windows a new environment is created on every call.
+     * @param system_env environment whose allocator, log and thread pool are
+     * shared
+     * @return the environment, reset, to be given back with
+     * axutil_release_thread_env and never freed. NULL on error.
+     */
+    AXIS2_EXTERN struct axutil_env *AXIS2_CALL
+                axutil_get_thread_env(
+                    const struct axutil_env *system_env);
+
+    /**
+     * Gives back an environment got from axutil_get_thread_env. The
+     * environment kept for the thread is reset, any other is freed.
+     * @param thread_env environment to give back
+     */
+    AXIS2_EXTERN void AXIS2_CALL
+    axutil_release_thread_env(
+        struct axutil_env *thread_env);
+
+    /**
+     * Clears what a request left in a thread environment, that is the error
+     * number, status and message of its error, so that it can be used for
+     * the next request.
+     * @param thread_env environment to reset
+     */
+    AXIS2_EXTERN void AXIS2_CALL
+    axutil_reset_thread_env(
+        struct axutil_env *thread_env);
+
     /** @} */
 
 #ifdef __cplusplus
@@ -17,6 +17,7 @@
 
 #include <axutil_allocator.h>
 #include <axutil_utils.h>
+#include <axutil_free_list.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -62,6 +63,7 @@ axutil_allocator_free(
 {
     if (allocator)
     {
+        axutil_free_list_release(allocator);
         allocator->free_fn(allocator, allocator);
     }
     return;
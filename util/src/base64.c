@@ -23,6 +23,33 @@
  */
 
 #include <axutil_base64.h>
+#include <axutil_utils.h>
+
+/* Vectorized encode/decode for x86. The SSSE3 and AVX2 code paths are built
+ * with per-function target attributes and picked at run time, so the
+ * library still runs on CPUs without these extensions. Define
+ * AXIS2_BASE64_NO_SIMD to build only the table driven code */
+#if !defined(__OS400__) && !defined(AXIS2_BASE64_NO_SIMD) && \
+    (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && \
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define AXUTIL_BASE64_SIMD
+#include <immintrin.h>
+#endif
+
+#define AXUTIL_BASE64_SIMD_NONE 0
+#define AXUTIL_BASE64_SIMD_SSSE3 1
+#define AXUTIL_BASE64_SIMD_AVX2 2
+
+struct axutil_base64_decoder
+{
+    /* 6 bit values of an incomplete quad carried over between calls */
+    unsigned char quad[4];
+    int nquad;
+
+    /* padding or a terminating char was seen */
+    axis2_bool_t done;
+};
 
 static const unsigned char pr2six[256] = {
 #ifndef __OS400__
@@ -90,6 +117,256 @@ static unsigned char os_toascii[256] = {
 
 #endif                          /* __OS400__ */
 
+#ifdef AXUTIL_BASE64_SIMD
+
+static int axutil_base64_simd_level = -1;
+
+static int
+axutil_base64_get_simd_level(void)
+{
+    /* Racing threads all compute the same value, so no locking is needed */
+    if (axutil_base64_simd_level < 0)
+    {
+        int level = AXUTIL_BASE64_SIMD_NONE;
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+            level = AXUTIL_BASE64_SIMD_AVX2;
+        }
+        else if (__builtin_cpu_supports("ssse3"))
+        {
+            level = AXUTIL_BASE64_SIMD_SSSE3;
+        }
+        axutil_base64_simd_level = level;
+    }
+    return axutil_base64_simd_level;
+}
+
+/* Splits each group of 3 input bytes into 4 sextets, one per byte */
+#define AXUTIL_BASE64_SPLIT(P, S, in) \
+    P##_or_si##S( \
+        P##_mulhi_epu16(P##_and_si##S(in, \
+            P##_set1_epi32(0x0fc0fc00)), P##_set1_epi32(0x04000040)), \
+        P##_mullo_epi16(P##_and_si##S(in, \
+            P##_set1_epi32(0x003f03f0)), P##_set1_epi32(0x01000010)))
+
+/* Maps sextets to the base64 alphabet: every range of the alphabet is a
+ * fixed offset from its sextet values, picked with a byte shuffle */
+#define AXUTIL_BASE64_TO_ASCII(P, S, idx) \
+    P##_add_epi8(idx, P##_shuffle_epi8( \
+        P##_setr_epi8(AXUTIL_BASE64_OFFSETS_##S), \
+        P##_or_si##S(P##_subs_epu8(idx, P##_set1_epi8(51)), \
+            P##_and_si##S(P##_cmpgt_epi8(P##_set1_epi8(26), idx), \
+                P##_set1_epi8(13)))))
+
+#define AXUTIL_BASE64_OFFSETS \
+    'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, \
+    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, \
+    '/' - 63, 'A', 0, 0
+#define AXUTIL_BASE64_OFFSETS_128 AXUTIL_BASE64_OFFSETS
+#define AXUTIL_BASE64_OFFSETS_256 AXUTIL_BASE64_OFFSETS, AXUTIL_BASE64_OFFSETS
+
+#define AXUTIL_BASE64_SPREAD \
+    1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10
+
+/* Classifies base64 chars and converts them to sextets. valid gets 0xff
+ * for every byte that is part of the alphabet */
+#define AXUTIL_BASE64_FROM_ASCII(P, S, in, valid, out) \
+    { \
+        __m##S##i upper = P##_and_si##S( \
+            P##_cmpgt_epi8(in, P##_set1_epi8('A' - 1)), \
+            P##_cmpgt_epi8(P##_set1_epi8('Z' + 1), in)); \
+        __m##S##i lower = P##_and_si##S( \
+            P##_cmpgt_epi8(in, P##_set1_epi8('a' - 1)), \
+            P##_cmpgt_epi8(P##_set1_epi8('z' + 1), in)); \
+        __m##S##i digit = P##_and_si##S( \
+            P##_cmpgt_epi8(in, P##_set1_epi8('0' - 1)), \
+            P##_cmpgt_epi8(P##_set1_epi8('9' + 1), in)); \
+        __m##S##i plus = P##_cmpeq_epi8(in, P##_set1_epi8('+')); \
+        __m##S##i slash = P##_cmpeq_epi8(in, P##_set1_epi8('/')); \
+        valid = P##_or_si##S(P##_or_si##S(upper, lower), \
+            P##_or_si##S(P##_or_si##S(digit, plus), slash)); \
+        out = P##_add_epi8(in, P##_or_si##S( \
+            P##_or_si##S( \
+                P##_and_si##S(upper, P##_set1_epi8(-65)), \
+                P##_and_si##S(lower, P##_set1_epi8(-71))), \
+            P##_or_si##S( \
+                P##_or_si##S( \
+                    P##_and_si##S(digit, P##_set1_epi8(4)), \
+                    P##_and_si##S(plus, P##_set1_epi8(19))), \
+                P##_and_si##S(slash, P##_set1_epi8(16))))); \
+    }
+
+/* Packs 4 sextets per 32 bit lane into 3 bytes, leaving the 12 bytes of
+ * each 128 bit lane at its start */
+#define AXUTIL_BASE64_PACK(P, S, in) \
+    P##_shuffle_epi8( \
+        P##_madd_epi16( \
+            P##_maddubs_epi16(in, P##_set1_epi32(0x01400140)), \
+            P##_set1_epi32(0x00011000)), \
+        P##_setr_epi8(AXUTIL_BASE64_GATHER_##S))
+
+#define AXUTIL_BASE64_GATHER \
+    2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+#define AXUTIL_BASE64_GATHER_128 AXUTIL_BASE64_GATHER
+#define AXUTIL_BASE64_GATHER_256 AXUTIL_BASE64_GATHER, AXUTIL_BASE64_GATHER
+#define AXUTIL_BASE64_SPREAD_128 AXUTIL_BASE64_SPREAD
+#define AXUTIL_BASE64_SPREAD_256 AXUTIL_BASE64_SPREAD, AXUTIL_BASE64_SPREAD
+
+/* The encoders consume input in blocks of 12 (24) bytes but load 16 (28),
+ * and return the number of input bytes consumed */
+__attribute__((target("ssse3")))
+static int
+axutil_base64_encode_ssse3(
+    char *encoded,
+    const unsigned char *string,
+    int len)
+{
+    int i = 0;
+    __m128i in;
+
+    for (i = 0; i + 16 <= len; i += 12)
+    {
+        in = _mm_loadu_si128((const __m128i *) (string + i));
+        in = _mm_shuffle_epi8(in, _mm_setr_epi8(AXUTIL_BASE64_SPREAD_128));
+        in = AXUTIL_BASE64_SPLIT(_mm, 128, in);
+        _mm_storeu_si128((__m128i *) encoded, AXUTIL_BASE64_TO_ASCII(_mm, 128, in));
+        encoded += 16;
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static int
+axutil_base64_encode_avx2(
+    char *encoded,
+    const unsigned char *string,
+    int len)
+{
+    int i = 0;
+    __m256i in;
+
+    for (i = 0; i + 28 <= len; i += 24)
+    {
+        in = _mm256_inserti128_si256(_mm256_castsi128_si256(
+            _mm_loadu_si128((const __m128i *) (string + i))),
+            _mm_loadu_si128((const __m128i *) (string + i + 12)), 1);
+        in = _mm256_shuffle_epi8(in,
+            _mm256_setr_epi8(AXUTIL_BASE64_SPREAD_256));
+        in = AXUTIL_BASE64_SPLIT(_mm256, 256, in);
+        _mm256_storeu_si256((__m256i *) encoded,
+            AXUTIL_BASE64_TO_ASCII(_mm256, 256, in));
+        encoded += 32;
+    }
+    return i;
+}
+
+/* The decoders consume blocks of 16 (32) chars and stop at the first block
+ * holding a char outside the alphabet. Every block stores 16 (28) bytes for
+ * its 12 (24) bytes of output, so they only run while at least 8 more chars
+ * follow the block, whose output covers the excess */
+__attribute__((target("ssse3")))
+static int
+axutil_base64_decode_ssse3(
+    unsigned char *bufplain,
+    const unsigned char *bufcoded,
+    int len)
+{
+    int i = 0;
+    __m128i in;
+    __m128i valid;
+    __m128i values;
+
+    for (i = 0; i + 24 <= len; i += 16)
+    {
+        in = _mm_loadu_si128((const __m128i *) (bufcoded + i));
+        AXUTIL_BASE64_FROM_ASCII(_mm, 128, in, valid, values);
+        if (_mm_movemask_epi8(valid) != 0xffff)
+        {
+            break;
+        }
+        _mm_storeu_si128((__m128i *) bufplain, AXUTIL_BASE64_PACK(_mm, 128, values));
+        bufplain += 12;
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static int
+axutil_base64_decode_avx2(
+    unsigned char *bufplain,
+    const unsigned char *bufcoded,
+    int len)
+{
+    int i = 0;
+    __m256i in;
+    __m256i valid;
+    __m256i values;
+
+    for (i = 0; i + 40 <= len; i += 32)
+    {
+        in = _mm256_loadu_si256((const __m256i *) (bufcoded + i));
+        AXUTIL_BASE64_FROM_ASCII(_mm256, 256, in, valid, values);
+        if (_mm256_movemask_epi8(valid) != -1)
+        {
+            break;
+        }
+        values = AXUTIL_BASE64_PACK(_mm256, 256, values);
+        _mm_storeu_si128((__m128i *) bufplain,
+            _mm256_castsi256_si128(values));
+        _mm_storeu_si128((__m128i *) (bufplain + 12),
+            _mm256_extracti128_si256(values, 1));
+        bufplain += 24;
+    }
+    return i;
+}
+
+#endif                          /* AXUTIL_BASE64_SIMD */
+
+/* Decodes whole quads of chars, stopping at the first quad that holds a
+ * char outside the alphabet. len is rounded down to a multiple of 4.
+ * Returns the number of chars consumed */
+static int
+axutil_base64_decode_quads(
+    unsigned char *bufplain,
+    const unsigned char *bufcoded,
+    int len)
+{
+    int i = 0;
+    unsigned char a, b, c, d;
+
+#ifdef AXUTIL_BASE64_SIMD
+    switch (axutil_base64_get_simd_level())
+    {
+    case AXUTIL_BASE64_SIMD_AVX2:
+        i = axutil_base64_decode_avx2(bufplain, bufcoded, len);
+        break;
+    case AXUTIL_BASE64_SIMD_SSSE3:
+        i = axutil_base64_decode_ssse3(bufplain, bufcoded, len);
+        break;
+    default:
+        break;
+    }
+    bufplain += (i >> 2) * 3;
+#endif
+
+    for (; i + 4 <= len; i += 4)
+    {
+        a = pr2six[bufcoded[i]];
+        b = pr2six[bufcoded[i + 1]];
+        c = pr2six[bufcoded[i + 2]];
+        d = pr2six[bufcoded[i + 3]];
+        if ((a | b | c | d) > 63)
+        {
+            break;
+        }
+        *(bufplain++) = (unsigned char) (a << 2 | b >> 4);
+        *(bufplain++) = (unsigned char) (b << 4 | c >> 2);
+        *(bufplain++) = (unsigned char) (c << 6 | d);
+    }
+    return i;
+}
+
 AXIS2_EXTERN int AXIS2_CALL
 axutil_base64_decode_len(
     const char *bufcoded)
@@ -138,6 +415,7 @@ axutil_base64_decode_binary(
     const char *bufcoded)
 {
     int nbytesdecoded;
+    int consumed;
     register const unsigned char *bufin;
     register unsigned char *bufout;
     register int nprbytes;
@@ -156,16 +434,14 @@ axutil_base64_decode_binary(
     bufout = (unsigned char *) bufplain;
     bufin = (const unsigned char *) bufcoded;
 
-    while (nprbytes > 4)
+    if (nprbytes > 4)
     {
-        *(bufout++) =
-            (unsigned char) (pr2six[*bufin] << 2 | pr2six[bufin[1]] >> 4);
-        *(bufout++) =
-            (unsigned char) (pr2six[bufin[1]] << 4 | pr2six[bufin[2]] >> 2);
-        *(bufout++) =
-            (unsigned char) (pr2six[bufin[2]] << 6 | pr2six[bufin[3]]);
-        bufin += 4;
-        nprbytes -= 4;
+        /* all but the last (possibly partial) quad */
+        consumed = axutil_base64_decode_quads(bufout, bufin,
+                                              ((nprbytes - 1) >> 2) << 2);
+        bufin += consumed;
+        bufout += (consumed >> 2) * 3;
+        nprbytes -= consumed;
     }
 
     /* Note: (nprbytes == 1) would be an error, so just ingore that case */
@@ -256,11 +532,25 @@ axutil_base64_encode_binary(
     const unsigned char *string,
     int len)
 {
-    int i;
+    int i = 0;
     char *p;
 
     p = encoded;
-    for (i = 0; i < len - 2; i += 3)
+#ifdef AXUTIL_BASE64_SIMD
+    switch (axutil_base64_get_simd_level())
+    {
+    case AXUTIL_BASE64_SIMD_AVX2:
+        i = axutil_base64_encode_avx2(p, string, len);
+        break;
+    case AXUTIL_BASE64_SIMD_SSSE3:
+        i = axutil_base64_encode_ssse3(p, string, len);
+        break;
+    default:
+        break;
+    }
+    p += (i / 3) * 4;
+#endif
+    for (; i < len - 2; i += 3)
     {
         *p++ = basis_64[(string[i] >> 2) & 0x3F];
         *p++ =
@@ -293,3 +583,129 @@ axutil_base64_encode_binary(
     return (int)(p - encoded);
     /* We are sure that the difference lies within the int range */
 }
+
+AXIS2_EXTERN axutil_base64_decoder_t *AXIS2_CALL
+axutil_base64_decoder_create(
+    const axutil_env_t *env)
+{
+    axutil_base64_decoder_t *decoder = NULL;
+
+    decoder = (axutil_base64_decoder_t *) AXIS2_MALLOC(env->allocator,
+        sizeof(axutil_base64_decoder_t));
+    if (!decoder)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "Out of memory");
+        return NULL;
+    }
+    decoder->nquad = 0;
+    decoder->done = AXIS2_FALSE;
+    return decoder;
+}
+
+AXIS2_EXTERN void AXIS2_CALL
+axutil_base64_decoder_free(
+    axutil_base64_decoder_t *decoder,
+    const axutil_env_t *env)
+{
+    AXIS2_FREE(env->allocator, decoder);
+}
+
+/* Writes out the 1 or 2 bytes held by a partial quad */
+static int
+axutil_base64_decoder_flush(
+    axutil_base64_decoder_t *decoder,
+    unsigned char *bufplain)
+{
+    int len = 0;
+
+    /* Note: (nquad == 1) would be an error, so just ingore that case */
+    if (decoder->nquad > 1)
+    {
+        bufplain[len++] = (unsigned char) (decoder->quad[0] << 2 |
+                                           decoder->quad[1] >> 4);
+    }
+    if (decoder->nquad > 2)
+    {
+        bufplain[len++] = (unsigned char) (decoder->quad[1] << 4 |
+                                           decoder->quad[2] >> 2);
+    }
+    decoder->nquad = 0;
+    return len;
+}
+
+AXIS2_EXTERN int AXIS2_CALL
+axutil_base64_decoder_decode(
+    axutil_base64_decoder_t *decoder,
+    const axutil_env_t *env,
+    unsigned char *bufplain,
+    const char *bufcoded,
+    int len)
+{
+    const unsigned char *bufin = (const unsigned char *) bufcoded;
+    unsigned char *bufout = bufplain;
+    unsigned char c;
+    int consumed;
+    int i = 0;
+
+    AXIS2_PARAM_CHECK(env->error, bufplain, -1);
+    AXIS2_PARAM_CHECK(env->error, bufcoded, -1);
+
+    while (i < len && !decoder->done)
+    {
+        if (0 == decoder->nquad)
+        {
+            /* quad aligned, so decode the clean run in bulk */
+            consumed = axutil_base64_decode_quads(bufout, bufin + i,
+                                                  ((len - i) >> 2) << 2);
+            bufout += (consumed >> 2) * 3;
+            i += consumed;
+            if (i >= len)
+            {
+                break;
+            }
+        }
+
+        c = bufin[i++];
+        if (pr2six[c] <= 63)
+        {
+            decoder->quad[decoder->nquad++] = pr2six[c];
+            if (4 == decoder->nquad)
+            {
+                *(bufout++) = (unsigned char) (decoder->quad[0] << 2 |
+                                               decoder->quad[1] >> 4);
+                *(bufout++) = (unsigned char) (decoder->quad[1] << 4 |
+                                               decoder->quad[2] >> 2);
+                *(bufout++) = (unsigned char) (decoder->quad[2] << 6 |
+                                               decoder->quad[3]);
+                decoder->nquad = 0;
+            }
+        }
+        else if (' ' != c && '\t' != c && '\r' != c && '\n' != c)
+        {
+            /* padding, or any other char, terminates the data */
+            decoder->done = AXIS2_TRUE;
+        }
+    }
+
+    if (decoder->done)
+    {
+        bufout += axutil_base64_decoder_flush(decoder, bufout);
+    }
+    return (int)(bufout - bufplain);
+    /* We are sure that the difference lies within the int range */
+}
+
+AXIS2_EXTERN int AXIS2_CALL
+axutil_base64_decoder_finish(
+    axutil_base64_decoder_t *decoder,
+    const axutil_env_t *env,
+    unsigned char *bufplain)
+{
+    int len = 0;
+
+    AXIS2_PARAM_CHECK(env->error, bufplain, -1);
+    len = axutil_base64_decoder_flush(decoder, bufplain);
+    decoder->done = AXIS2_TRUE;
+    return len;
+}
@@ -0,0 +1,238 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <axutil_free_list.h>
+#include <stdlib.h>
+#ifndef WIN32
+#include <pthread.h>
+#endif
+
+/* object sizes a thread keeps free lists for */
+#define AXUTIL_FREE_LIST_SIZES 16
+
+/* bytes a free list holds at most, the objects freed beyond it are given
+   back to the allocator */
+#define AXUTIL_FREE_LIST_MAX_BYTES 65536
+
+typedef struct axutil_free_list_obj
+{
+    struct axutil_free_list_obj *next;
+} axutil_free_list_obj_t;
+
+typedef struct axutil_free_list
+{
+    size_t size;
+    size_t count;
+    axutil_free_list_obj_t *first;
+} axutil_free_list_t;
+
+/* the free lists of one thread, all for objects of the same allocator */
+typedef struct axutil_free_lists
+{
+    axutil_allocator_t *allocator;
+    /* kept apart from the allocator, which may be gone by the time the
+       thread exits */
+    void (AXIS2_CALL *free_fn) (
+        struct axutil_allocator * allocator,
+        void *ptr);
+    size_t count;
+    axutil_free_list_t lists[AXUTIL_FREE_LIST_SIZES];
+} axutil_free_lists_t;
+
+#ifndef WIN32
+static pthread_key_t axutil_free_lists_key;
+static pthread_once_t axutil_free_lists_once = PTHREAD_ONCE_INIT;
+static axis2_bool_t axutil_free_lists_key_created = AXIS2_FALSE;
+
+static void
+axutil_free_lists_clear(
+    axutil_free_lists_t * free_lists)
+{
+    int i = 0;
+
+    for (i = 0; i < AXUTIL_FREE_LIST_SIZES; i++)
+    {
+        axutil_free_list_t *list = &free_lists->lists[i];
+
+        while (list->first)
+        {
+            axutil_free_list_obj_t *obj = list->first;
+
+            list->first = obj->next;
+            free_lists->free_fn(free_lists->allocator, obj);
+        }
+        list->count = 0;
+    }
+    free_lists->count = 0;
+}
+
+static void
+axutil_free_lists_destroy(
+    void *free_lists)
+{
+    axutil_free_lists_clear((axutil_free_lists_t *) free_lists);
+    free(free_lists);
+}
+
+static void
+axutil_free_lists_key_create(void)
+{
+    axutil_free_lists_key_created =
+        (0 == pthread_key_create(&axutil_free_lists_key,
+                                 axutil_free_lists_destroy));
+}
+#endif
+
+/* the free list of the calling thread for objects of the given size and
+   allocator, NULL if there is none to be used */
+static axutil_free_list_t *
+axutil_free_list_get(
+    axutil_allocator_t * allocator,
+    size_t size,
+    axutil_free_lists_t ** lists_of_thread)
+{
+#ifndef WIN32
+    axutil_free_lists_t *free_lists = NULL;
+    axutil_free_list_t *list = NULL;
+    int i = 0;
+
+    if (!allocator || allocator->current_pool || allocator->local_pool ||
+        allocator->global_pool || size < sizeof(axutil_free_list_obj_t))
+    {
+        /* what is allocated out of a pool is freed with the pool */
+        return NULL;
+    }
+    pthread_once(&axutil_free_lists_once, axutil_free_lists_key_create);
+    if (!axutil_free_lists_key_created)
+    {
+        return NULL;
+    }
+    free_lists = (axutil_free_lists_t *)
+        pthread_getspecific(axutil_free_lists_key);
+    if (!free_lists)
+    {
+        /* not out of the allocator, as it has to outlive it */
+        free_lists = (axutil_free_lists_t *) calloc(1,
+            sizeof(axutil_free_lists_t));
+        if (!free_lists)
+        {
+            return NULL;
+        }
+        if (0 != pthread_setspecific(axutil_free_lists_key, free_lists))
+        {
+            free(free_lists);
+            return NULL;
+        }
+    }
+    if (free_lists->allocator != allocator)
+    {
+        if (free_lists->count)
+        {
+            /* holding the objects of another allocator */
+            return NULL;
+        }
+        free_lists->allocator = allocator;
+        free_lists->free_fn = allocator->free_fn;
+    }
+    *lists_of_thread = free_lists;
+
+    for (i = 0; i < AXUTIL_FREE_LIST_SIZES; i++)
+    {
+        list = &free_lists->lists[i];
+        if (list->size == size)
+        {
+            return list;
+        }
+        if (!list->size)
+        {
+            list->size = size;
+            return list;
+        }
+    }
+    return NULL;
+#else
+    return NULL;
+#endif
+}
+
+AXIS2_EXTERN void *AXIS2_CALL
+axutil_free_list_malloc(
+    axutil_allocator_t * allocator,
+    size_t size)
+{
+    axutil_free_lists_t *free_lists = NULL;
+    axutil_free_list_t *list = NULL;
+
+    list = axutil_free_list_get(allocator, size, &free_lists);
+    if (list && list->first)
+    {
+        axutil_free_list_obj_t *obj = list->first;
+
+        list->first = obj->next;
+        list->count--;
+        free_lists->count--;
+        return obj;
+    }
+    return AXIS2_MALLOC(allocator, size);
+}
+
+AXIS2_EXTERN void AXIS2_CALL
+axutil_free_list_free(
+    axutil_allocator_t * allocator,
+    void *ptr,
+    size_t size)
+{
+    axutil_free_lists_t *free_lists = NULL;
+    axutil_free_list_t *list = NULL;
+
+    if (!ptr)
+    {
+        return;
+    }
+    list = axutil_free_list_get(allocator, size, &free_lists);
+    if (list && (list->count + 1) * size <= AXUTIL_FREE_LIST_MAX_BYTES)
+    {
+        axutil_free_list_obj_t *obj = (axutil_free_list_obj_t *) ptr;
+
+        obj->next = list->first;
+        list->first = obj;
+        list->count++;
+        free_lists->count++;
+        return;
+    }
+    AXIS2_FREE(allocator, ptr);
+}
+
+AXIS2_EXTERN void AXIS2_CALL
+axutil_free_list_release(
+    axutil_allocator_t * allocator)
+{
+#ifndef WIN32
+    axutil_free_lists_t *free_lists = NULL;
+
+    if (!axutil_free_lists_key_created)
+    {
+        return;
+    }
+    free_lists = (axutil_free_lists_t *)
+        pthread_getspecific(axutil_free_lists_key);
+    if (free_lists && free_lists->allocator == allocator)
+    {
+        axutil_free_lists_clear(free_lists);
+    }
+#endif
+}
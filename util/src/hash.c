@@ -70,6 +70,12 @@ struct axutil_hash_t
     unsigned int max;
     axutil_hashfunc_t hash_func;
     axutil_hash_entry_t *free;  /* List of recycled entries */
+    const axutil_hash_slot_key_t *slot_keys;
+    int slot_count;
+    /* Entries of the slot keys, allocated when the first one is added */
+    axutil_hash_entry_t **slots;
+    /* The slots could not be allocated, the keys are looked up instead */
+    axis2_bool_t slots_lost;
 };
 
 #define INITIAL_MAX 15          /* tunable == 2^n - 1 */
@@ -111,6 +117,10 @@ axutil_hash_make(
     ht->max = INITIAL_MAX;
     ht->array = axutil_hash_alloc_array(ht, ht->max);
     ht->hash_func = axutil_hashfunc_default;
+    ht->slot_keys = NULL;
+    ht->slot_count = 0;
+    ht->slots = NULL;
+    ht->slots_lost = AXIS2_FALSE;
     return ht;
 }
 
@@ -328,6 +338,38 @@ axutil_hashfunc_default(
     return hash;
 }
 
+/*
+ * Record a new entry in the slot of its key, if it has one.
+ */
+
+static void
+axutil_hash_slot_entry(
+    axutil_hash_t *ht,
+    axutil_hash_entry_t *he)
+{
+    int i;
+
+    for (i = 0; i < ht->slot_count; i++)
+    {
+        if (ht->slot_keys[i].klen == he->klen &&
+            memcmp(ht->slot_keys[i].key, he->key, he->klen) == 0)
+        {
+            if (!ht->slots && !ht->slots_lost)
+            {
+                ht->slots = AXIS2_MALLOC(ht->env->allocator,
+                    sizeof(*ht->slots) * ht->slot_count);
+                if (ht->slots)
+                    memset(ht->slots, 0, sizeof(*ht->slots) * ht->slot_count);
+                else
+                    ht->slots_lost = AXIS2_TRUE;
+            }
+            if (ht->slots)
+                ht->slots[i] = he;
+            return;
+        }
+    }
+}
+
 /*
  * This is where we keep the details of the hash function and control
  * the maximum collision rate.
@@ -386,6 +428,8 @@ axutil_hash_find_entry(
     he->val = val;
     *hep = he;
     ht->count++;
+    if (ht->slot_count)
+        axutil_hash_slot_entry(ht, he);
     return hep;
 }
 
@@ -417,6 +461,10 @@ axutil_hash_copy(
     ht->count = orig->count;
     ht->max = orig->max;
     ht->hash_func = orig->hash_func;
+    ht->slot_keys = NULL;
+    ht->slot_count = 0;
+    ht->slots = NULL;
+    ht->slots_lost = AXIS2_FALSE;
     ht->array = (axutil_hash_entry_t **) ((char *) ht + sizeof(axutil_hash_t));
 
     new_vals = (axutil_hash_entry_t *) ((char *) (ht) + sizeof(axutil_hash_t) +
@@ -479,6 +527,18 @@ axutil_hash_set(
         {
             /* delete entry */
             axutil_hash_entry_t *old = *hep;
+            if (ht->slots)
+            {
+                int i;
+                for (i = 0; i < ht->slot_count; i++)
+                {
+                    if (ht->slots[i] == old)
+                    {
+                        ht->slots[i] = NULL;
+                        break;
+                    }
+                }
+            }
             *hep = (*hep)->next;
             old->next = ht->free;
             ht->free = old;
@@ -564,6 +624,10 @@ axutil_hash_merge(
     axutil_env_increment_ref((axutil_env_t*)env);
     res->free = NULL;
     res->hash_func = base->hash_func;
+    res->slot_keys = NULL;
+    res->slot_count = 0;
+    res->slots = NULL;
+    res->slots_lost = AXIS2_FALSE;
     res->count = base->count;
     res->max = (overlay->max > base->max) ? overlay->max : base->max;
     if (base->count + overlay->count > res->max)
@@ -661,6 +725,59 @@ axutil_hash_contains_key(
     return AXIS2_FALSE;
 }
 
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axutil_hash_set_slots(
+    axutil_hash_t *ht,
+    const axutil_env_t *env,
+    const axutil_hash_slot_key_t *keys,
+    int count)
+{
+    int i;
+
+    AXIS2_PARAM_CHECK(env->error, ht, AXIS2_FAILURE);
+
+    if (ht->slot_keys == keys && ht->slot_count == count)
+        return AXIS2_SUCCESS;
+
+    if (ht->slots)
+    {
+        AXIS2_FREE(ht->env->allocator, ht->slots);
+        ht->slots = NULL;
+    }
+    ht->slots_lost = AXIS2_FALSE;
+    ht->slot_keys = keys;
+    ht->slot_count = count;
+
+    /* entries set before the keys were given */
+    for (i = 0; i < count && ht->count; i++)
+    {
+        axutil_hash_entry_t **hep = axutil_hash_find_entry(ht, keys[i].key,
+            keys[i].klen, NULL);
+
+        if (hep && *hep)
+            axutil_hash_slot_entry(ht, *hep);
+    }
+    return ht->slots_lost ? AXIS2_FAILURE : AXIS2_SUCCESS;
+}
+
+AXIS2_EXTERN void *AXIS2_CALL
+axutil_hash_get_slot(
+    axutil_hash_t *ht,
+    int slot)
+{
+    if (!ht || slot < 0 || slot >= ht->slot_count)
+        return NULL;
+
+    if (ht->slots)
+        return ht->slots[slot] ? (void *) ht->slots[slot]->val : NULL;
+
+    if (ht->slots_lost)
+        return axutil_hash_get(ht, ht->slot_keys[slot].key,
+            ht->slot_keys[slot].klen);
+
+    return NULL;
+}
+
 /*
 void
 axutil_hash_entry_free(
@@ -716,6 +833,8 @@ axutil_hash_free(
             }
         }
 
+        if (ht->slots)
+            AXIS2_FREE(hash_env->allocator, ht->slots);
         AXIS2_FREE(hash_env->allocator, (ht->array));
         AXIS2_FREE(hash_env->allocator, ht);
         
@@ -753,6 +872,8 @@ axutil_hash_free_void_arg(
                 current = next;
             }
         }
+        if (ht->slots)
+            AXIS2_FREE(hash_env->allocator, ht->slots);
         AXIS2_FREE(hash_env->allocator, (ht->array));
         AXIS2_FREE(hash_env->allocator, ht);
     }
@@ -19,19 +19,41 @@
 #include <axutil_string.h>
 #include <string.h>
 #include <stdlib.h>
+#include <ctype.h>
 
 #define AXIS2_HTTP_CRLF "\r\n"
 
+/* size of the buffer chunk headers are parsed from, the longest chunk size
+   line or trailer line accepted */
+#define AXIS2_HTTP_CHUNKED_BUF_SIZE 8192
+
+/* largest chunk a file is sent in, well below the 2GB chunk readers take */
+#define AXIS2_HTTP_CHUNKED_FILE_CHUNK_MAX 0x40000000
+
 struct axutil_http_chunked_stream
 {
     axutil_stream_t *stream;
     int current_chunk_size;
+    /* bytes of the current chunk not read yet */
     int unread_len;
     axis2_bool_t end_of_chunks;
+    /* set while the data of a chunk, or the CRLF after it, is being read */
     axis2_bool_t chunk_started;
+    /* set while the trailer after the last chunk is being read */
+    axis2_bool_t in_trailer;
+    /* bytes read from stream, allocated on the first read; the unused ones
+       are from buf_pos to buf_len */
+    axis2_char_t *buf;
+    int buf_pos;
+    int buf_len;
 };
 
-static axis2_status_t axutil_http_chunked_stream_start_chunk(
+static int axutil_http_chunked_stream_start_chunk(
+    axutil_http_chunked_stream_t * chunked_stream,
+    const axutil_env_t *env,
+    axis2_bool_t may_read);
+
+static int axutil_http_chunked_stream_fill(
     axutil_http_chunked_stream_t * chunked_stream,
     const axutil_env_t *env);
 
@@ -58,6 +80,10 @@ axutil_http_chunked_stream_create(
     chunked_stream->unread_len = -1;
     chunked_stream->end_of_chunks = AXIS2_FALSE;
     chunked_stream->chunk_started = AXIS2_FALSE;
+    chunked_stream->in_trailer = AXIS2_FALSE;
+    chunked_stream->buf = NULL;
+    chunked_stream->buf_pos = 0;
+    chunked_stream->buf_len = 0;
 
     return chunked_stream;
 }
@@ -69,6 +95,10 @@ axutil_http_chunked_stream_free(
 {
     AXIS2_ENV_CHECK(env, void);
 
+    if (chunked_stream->buf)
+    {
+        AXIS2_FREE(env->allocator, chunked_stream->buf);
+    }
     AXIS2_FREE(env->allocator, chunked_stream);
     return;
 }
@@ -81,7 +111,8 @@ axutil_http_chunked_stream_read(
     size_t count)
 {
     int len = -1;
-    int yet_to_read = 0;
+    int read = 0;
+    int status = 0;
     axutil_stream_t *stream = chunked_stream->stream;
 
     if (!buffer)
@@ -94,41 +125,136 @@ axutil_http_chunked_stream_read(
             AXIS2_FAILURE);
         return -1;
     }
-    if (AXIS2_TRUE == chunked_stream->end_of_chunks)
+    while (AXIS2_FALSE == chunked_stream->end_of_chunks && read < (int)count)
     {
-        return 0;
+        int wanted = (int)count - read;
+
+        if (chunked_stream->unread_len <= 0)
+        {
+            status = axutil_http_chunked_stream_start_chunk(chunked_stream,
+                env, AXIS2_TRUE);
+            if (status < 0)
+            {
+                break;
+            }
+            continue;
+        }
+        if (wanted > chunked_stream->unread_len)
+        {
+            wanted = chunked_stream->unread_len;
+        }
+        len = chunked_stream->buf_len - chunked_stream->buf_pos;
+        if (len > 0)
+        {
+            if (len > wanted)
+            {
+                len = wanted;
+            }
+            memcpy((axis2_char_t *) buffer + read,
+                chunked_stream->buf + chunked_stream->buf_pos, len);
+            chunked_stream->buf_pos += len;
+        }
+        else if (wanted >= AXIS2_HTTP_CHUNKED_BUF_SIZE)
+        {
+            /* large enough to be read into the caller's buffer directly */
+            len = axutil_stream_read(stream, env, (axis2_char_t *) buffer + read,
+                wanted);
+            if (len <= 0)
+            {
+                status = -1;
+                break;
+            }
+        }
+        else
+        {
+            if (axutil_http_chunked_stream_fill(chunked_stream, env) <= 0)
+            {
+                status = -1;
+                break;
+            }
+            continue;
+        }
+        read += len;
+        chunked_stream->unread_len -= len;
     }
-    if (AXIS2_FALSE == chunked_stream->chunk_started)
+    if (status < 0)
     {
-        axutil_http_chunked_stream_start_chunk(chunked_stream, env);
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+            "Chunked stream ended before its last chunk");
+        chunked_stream->end_of_chunks = AXIS2_TRUE;
+        return read > 0 ? read : -1;
     }
-    yet_to_read = (int)count;
-    /* We are sure that the difference lies within the int range */
-    while (AXIS2_FALSE == chunked_stream->end_of_chunks && yet_to_read > 0)
+    /* Parses the next chunk header if it was read along with the data, so that
+       the end of the chunks is known without another read */
+    if (read > 0 && 0 == chunked_stream->unread_len &&
+        AXIS2_FALSE == chunked_stream->end_of_chunks &&
+        axutil_http_chunked_stream_start_chunk(chunked_stream, env,
+            AXIS2_FALSE) < 0)
     {
-        if (chunked_stream->unread_len < yet_to_read)
+        chunked_stream->end_of_chunks = AXIS2_TRUE;
+    }
+    return read;
+}
+
+AXIS2_EXTERN int AXIS2_CALL
+axutil_http_chunked_stream_read_slice(
+    axutil_http_chunked_stream_t *chunked_stream,
+    const axutil_env_t *env,
+    const axis2_char_t **slice)
+{
+    int len = 0;
+
+    if (!slice)
+    {
+        return -1;
+    }
+    *slice = NULL;
+    if (!chunked_stream->stream)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NULL_STREAM_IN_CHUNKED_STREAM,
+            AXIS2_FAILURE);
+        return -1;
+    }
+    while (AXIS2_FALSE == chunked_stream->end_of_chunks && 0 == len)
+    {
+        if (chunked_stream->unread_len <= 0)
         {
-            len = axutil_stream_read(chunked_stream->stream, env,
-                (axis2_char_t *) buffer + count -
-                yet_to_read, chunked_stream->unread_len);
-            yet_to_read -= len;
-            chunked_stream->unread_len -= len;
-            if (chunked_stream->unread_len <= 0)
+            if (axutil_http_chunked_stream_start_chunk(chunked_stream, env,
+                AXIS2_TRUE) < 0)
             {
-                axutil_http_chunked_stream_start_chunk(chunked_stream, env);
+                chunked_stream->end_of_chunks = AXIS2_TRUE;
+                return -1;
             }
+            continue;
         }
-        else
+        len = chunked_stream->buf_len - chunked_stream->buf_pos;
+        if (0 == len &&
+            axutil_http_chunked_stream_fill(chunked_stream, env) <= 0)
         {
-            len = axutil_stream_read(chunked_stream->stream, env,
-                (axis2_char_t *) buffer + count -
-                yet_to_read, yet_to_read);
-            yet_to_read -= len;
-            chunked_stream->unread_len -= len;
+            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                "Chunked stream ended before its last chunk");
+            chunked_stream->end_of_chunks = AXIS2_TRUE;
+            return -1;
         }
     }
-    return ((int)count - yet_to_read);
-    /* We are sure that the difference lies within the int range */
+    if (0 == len)
+    {
+        return 0;
+    }
+    if (len > chunked_stream->unread_len)
+    {
+        len = chunked_stream->unread_len;
+    }
+    *slice = chunked_stream->buf + chunked_stream->buf_pos;
+    chunked_stream->buf_pos += len;
+    chunked_stream->unread_len -= len;
+    if (0 == chunked_stream->unread_len &&
+        axutil_http_chunked_stream_start_chunk(chunked_stream, env,
+            AXIS2_FALSE) < 0)
+    {
+        chunked_stream->end_of_chunks = AXIS2_TRUE;
+    }
+    return len;
 }
 
 AXIS2_EXTERN int AXIS2_CALL
@@ -159,6 +285,56 @@ axutil_http_chunked_stream_write(
     return len;
 }
 
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axutil_http_chunked_stream_write_file(
+    axutil_http_chunked_stream_t *chunked_stream,
+    const axutil_env_t *env,
+    FILE *fp,
+    size_t count)
+{
+    axutil_stream_t *stream = chunked_stream->stream;
+    axis2_char_t tmp_buf[20];
+
+    if (!fp || 0 == count)
+    {
+        return AXIS2_FAILURE;
+    }
+    if (!stream)
+    {
+        AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NULL_STREAM_IN_CHUNKED_STREAM,
+            AXIS2_FAILURE);
+        return AXIS2_FAILURE;
+    }
+    while (count > 0)
+    {
+        /* the chunk size has to fit the hex field of the chunk header */
+        size_t chunk_size = count > AXIS2_HTTP_CHUNKED_FILE_CHUNK_MAX ?
+            AXIS2_HTTP_CHUNKED_FILE_CHUNK_MAX : count;
+
+        sprintf(tmp_buf, "%x%s", (unsigned int) chunk_size, AXIS2_HTTP_CRLF);
+        if (axutil_stream_write(stream, env, tmp_buf,
+                                axutil_strlen(tmp_buf)) < 0)
+        {
+            return AXIS2_FAILURE;
+        }
+        if (AXIS2_SUCCESS != axutil_stream_send_file(stream, env, fp,
+                                                     chunk_size))
+        {
+            /* the chunk header already promised chunk_size bytes */
+            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                "Could not send the %u bytes of the file chunk",
+                (unsigned int) chunk_size);
+            return AXIS2_FAILURE;
+        }
+        if (axutil_stream_write(stream, env, AXIS2_HTTP_CRLF, 2) != 2)
+        {
+            return AXIS2_FAILURE;
+        }
+        count -= chunk_size;
+    }
+    return AXIS2_SUCCESS;
+}
+
 AXIS2_EXTERN int AXIS2_CALL
 axutil_http_chunked_stream_get_current_chunk_size(
     const axutil_http_chunked_stream_t *chunked_stream,
@@ -167,53 +343,177 @@ axutil_http_chunked_stream_get_current_chunk_size(
     return chunked_stream->current_chunk_size;
 }
 
-static axis2_status_t
-axutil_http_chunked_stream_start_chunk(
+/* Moves the unused bytes to the start of the buffer and reads once into the
+   rest of it. Returns the number of bytes read, 0 or -1 at the end of the
+   stream or when there is no room left */
+static int
+axutil_http_chunked_stream_fill(
     axutil_http_chunked_stream_t *chunked_stream,
     const axutil_env_t *env)
 {
-    axis2_char_t tmp_buf[3] = "";
-    axis2_char_t str_chunk_len[512] = "";
-    axis2_char_t *tmp = NULL;
-    int read = -1;
+    int len = 0;
 
-    /* remove the last CRLF of the previous chunk if any */
-    if (AXIS2_TRUE == chunked_stream->chunk_started)
+    if (!chunked_stream->buf)
     {
-        read = axutil_stream_read(chunked_stream->stream, env, tmp_buf, 2);
-        chunked_stream->chunk_started = AXIS2_FALSE;
+        chunked_stream->buf = AXIS2_MALLOC(env->allocator,
+            AXIS2_HTTP_CHUNKED_BUF_SIZE);
+        if (!chunked_stream->buf)
+        {
+            AXIS2_ERROR_SET(env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "Out of memory");
+            return -1;
+        }
+    }
+    if (chunked_stream->buf_pos > 0)
+    {
+        memmove(chunked_stream->buf,
+            chunked_stream->buf + chunked_stream->buf_pos,
+            chunked_stream->buf_len - chunked_stream->buf_pos);
+        chunked_stream->buf_len -= chunked_stream->buf_pos;
+        chunked_stream->buf_pos = 0;
     }
-    /* read the len and chunk extension */
-    while ((read = axutil_stream_read(chunked_stream->stream, env, tmp_buf,
-                                      1)) > 0)
+    if (chunked_stream->buf_len >= AXIS2_HTTP_CHUNKED_BUF_SIZE)
+    {
+        AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "Chunk header line too long");
+        return -1;
+    }
+    len = axutil_stream_read(chunked_stream->stream, env,
+        chunked_stream->buf + chunked_stream->buf_len,
+        AXIS2_HTTP_CHUNKED_BUF_SIZE - chunked_stream->buf_len);
+    if (len > 0)
+    {
+        chunked_stream->buf_len += len;
+    }
+    return len;
+}
+
+/* Finds the next line in the buffer, reading more of the stream for it only
+   when may_read is set. The line is left in place, without its CRLF.
+   Returns 1 for a line, 0 if it is not all in the buffer, -1 on error */
+static int
+axutil_http_chunked_stream_read_line(
+    axutil_http_chunked_stream_t *chunked_stream,
+    const axutil_env_t *env,
+    axis2_bool_t may_read,
+    axis2_char_t **line,
+    int *line_len)
+{
+    axis2_char_t *start = NULL;
+    axis2_char_t *end = NULL;
+
+    while (1)
     {
-        tmp_buf[read] = '\0';
-        strcat(str_chunk_len, tmp_buf);
-        if (0 != strstr(str_chunk_len, AXIS2_HTTP_CRLF))
+        if (chunked_stream->buf)
         {
-            break;
+            start = chunked_stream->buf + chunked_stream->buf_pos;
+            end = memchr(start, '\n',
+                chunked_stream->buf_len - chunked_stream->buf_pos);
+            if (end)
+            {
+                *line = start;
+                *line_len = (int)(end - start);
+                if (*line_len > 0 && '\r' == start[*line_len - 1])
+                {
+                    --*line_len;
+                }
+                chunked_stream->buf_pos += (int)(end - start) + 1;
+                return 1;
+            }
+        }
+        if (!may_read)
+        {
+            return 0;
+        }
+        if (axutil_http_chunked_stream_fill(chunked_stream, env) <= 0)
+        {
+            return -1;
         }
     }
-    /* check whether we have extensions */
-    tmp = strchr(str_chunk_len, ';');
-    if (tmp)
+}
+
+/* Reads the CRLF after the data of a chunk and the size line of the next
+   one. After the last chunk the trailer is read and skipped, and
+   end_of_chunks is set. The header is parsed where it lies in the buffer;
+   unless may_read is set nothing more is read for it, and a header not all
+   in the buffer is picked up again on the next call.
+   Returns 1 when a chunk or the end was reached, 0 if more bytes are needed,
+   -1 on error */
+static int
+axutil_http_chunked_stream_start_chunk(
+    axutil_http_chunked_stream_t *chunked_stream,
+    const axutil_env_t *env,
+    axis2_bool_t may_read)
+{
+    axis2_char_t *line = NULL;
+    int line_len = 0;
+    int status = 0;
+    int size = 0;
+    int i = 0;
+
+    /* remove the last CRLF of the previous chunk if any */
+    if (AXIS2_TRUE == chunked_stream->chunk_started)
     {
-        /* we don't use extensions right now */
-        *tmp = '\0';
+        status = axutil_http_chunked_stream_read_line(chunked_stream, env,
+            may_read, &line, &line_len);
+        if (status <= 0)
+        {
+            return status;
+        }
+        if (line_len > 0)
+        {
+            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                "Chunk longer than its size");
+            return -1;
+        }
+        chunked_stream->chunk_started = AXIS2_FALSE;
     }
-    chunked_stream->current_chunk_size = strtol(str_chunk_len, NULL, 16);
-    if (0 == chunked_stream->current_chunk_size)
+    if (AXIS2_FALSE == chunked_stream->in_trailer)
     {
-        /* Read the last CRLF */
-        read = axutil_stream_read(chunked_stream->stream, env, tmp_buf, 2);
-        chunked_stream->end_of_chunks = AXIS2_TRUE;
+        status = axutil_http_chunked_stream_read_line(chunked_stream, env,
+            may_read, &line, &line_len);
+        if (status <= 0)
+        {
+            return status;
+        }
+        /* the size ends at the chunk extensions, we don't use them */
+        for (i = 0; i < line_len && isxdigit((unsigned char) line[i]); i++)
+        {
+            if (size >= 0x8000000)
+            {
+                AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "Chunk too long");
+                return -1;
+            }
+            size = size * 16 + (isdigit((unsigned char) line[i]) ?
+                line[i] - '0' : (tolower((unsigned char) line[i]) - 'a' + 10));
+        }
+        if (0 == i)
+        {
+            AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI, "Invalid chunk size line");
+            return -1;
+        }
+        chunked_stream->current_chunk_size = size;
+        if (size > 0)
+        {
+            chunked_stream->chunk_started = AXIS2_TRUE;
+            chunked_stream->unread_len = size;
+            return 1;
+        }
+        chunked_stream->in_trailer = AXIS2_TRUE;
     }
-    else
+    /* the trailer ends with an empty line */
+    do
     {
-        chunked_stream->chunk_started = AXIS2_TRUE;
-        chunked_stream->unread_len = chunked_stream->current_chunk_size;
+        status = axutil_http_chunked_stream_read_line(chunked_stream, env,
+            may_read, &line, &line_len);
+        if (status <= 0)
+        {
+            return status;
+        }
     }
-    return AXIS2_SUCCESS;
+    while (line_len > 0);
+    chunked_stream->in_trailer = AXIS2_FALSE;
+    chunked_stream->end_of_chunks = AXIS2_TRUE;
+    return 1;
 }
 
 AXIS2_EXTERN axis2_status_t AXIS2_CALL
@@ -21,6 +21,7 @@
 #include <axutil_string.h>
 #include <zlib.h>
 #include <fcntl.h>
+#include <sys/stat.h>
 #include <axis2_unzip.h>
 #include <axis2_crypt.h>
 #include <axis2_ioapi.h>
@@ -33,6 +34,11 @@
 #define WRITEBUFFERSIZE (8192)
 #define MAXFILENAME (256)
 
+/* An extracted archive is marked by a file named .<archive>.extracted
+ * holding the modification time and size the archive had */
+#define AXIS2_EXTRACTED_PREFIX "."
+#define AXIS2_EXTRACTED_SUFFIX ".extracted"
+
 axis2_status_t aar_select(
     );
 int aar_extract(
@@ -284,10 +290,77 @@ aar_extract(
 
     ret = axis2_extract(uf, opt_do_extract_withoutpath, opt_overwrite,
                          password);
-    /*unzCloseCurrentFile(uf);*/
+    unzClose(uf);
     return ret;
 }
 
+/*
+ * Writes the stamp of an archive into buf, returns 0 if the archive could
+ * not be read.
+ */
+static int
+axis2_archive_stamp(
+    const axis2_char_t *archive,
+    axis2_char_t *buf,
+    size_t size)
+{
+    struct stat st;
+
+    if (stat(archive, &st) != 0)
+        return 0;
+    sprintf(buf, "%lu %lu", (unsigned long) st.st_mtime,
+            (unsigned long) st.st_size);
+    return 1;
+}
+
+/*
+ * Returns non zero if the archive was extracted before and has not been
+ * changed since, so starting up does not unpack every archive again.
+ */
+static int
+axis2_archive_is_extracted(
+    const axis2_char_t *archive)
+{
+    axis2_char_t marker[MAXFILENAME + 16];
+    axis2_char_t stamp[64];
+    axis2_char_t saved[64];
+    FILE *fp = NULL;
+    int extracted = 0;
+
+    if (strlen(archive) >= MAXFILENAME ||
+        !axis2_archive_stamp(archive, stamp, sizeof(stamp)))
+        return 0;
+    sprintf(marker, "%s%s%s", AXIS2_EXTRACTED_PREFIX, archive,
+            AXIS2_EXTRACTED_SUFFIX);
+    fp = fopen(marker, "r");
+    if (!fp)
+        return 0;
+    if (fgets(saved, sizeof(saved), fp))
+        extracted = (strcmp(saved, stamp) == 0);
+    fclose(fp);
+    return extracted;
+}
+
+static void
+axis2_archive_set_extracted(
+    const axis2_char_t *archive)
+{
+    axis2_char_t marker[MAXFILENAME + 16];
+    axis2_char_t stamp[64];
+    FILE *fp = NULL;
+
+    if (strlen(archive) >= MAXFILENAME ||
+        !axis2_archive_stamp(archive, stamp, sizeof(stamp)))
+        return;
+    sprintf(marker, "%s%s%s", AXIS2_EXTRACTED_PREFIX, archive,
+            AXIS2_EXTRACTED_SUFFIX);
+    fp = fopen(marker, "w");
+    if (!fp)
+        return;
+    fputs(stamp, fp);
+    fclose(fp);
+}
+
 int
 axis2_extract_onefile(
     unzFile uf,
@@ -339,20 +412,12 @@ axis2_archive_extract(
             ptr = axutil_rindex(namelist[n]->d_name, '.');
             if ((ptr) &&
                 (((strcmp(ptr, AXIS2_AAR_SUFFIX) == 0)) ||
-                 (strcmp(ptr, AXIS2_MAR_SUFFIX) == 0)))
-                for (i = 0; i < n; i++)
-                    if (strncmp
-                        (namelist[n]->d_name, namelist[i]->d_name,
-                         strlen(namelist[i]->d_name)) == 0)
-                    {
-                        int j;
-                        for (j = n; j >= 0; j--)    /* clean remaining memory before return */
-                            free(namelist[j]);
-                        free(namelist);
-                        return (AXIS2_FALSE);
-                    }
-
-            aar_extract(namelist[n]->d_name);
+                 (strcmp(ptr, AXIS2_MAR_SUFFIX) == 0)) &&
+                !axis2_archive_is_extracted(namelist[n]->d_name))
+            {
+                if (aar_extract(namelist[n]->d_name) == 0)
+                    axis2_archive_set_extracted(namelist[n]->d_name);
+            }
             free(namelist[n]);
         }
         free(namelist);
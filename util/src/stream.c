@@ -19,6 +19,10 @@
 #include <stdlib.h>
 #include <axutil_stream.h>
 #include <platforms/axutil_platform_auto_sense.h>
+#ifdef HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#include <poll.h>
+#endif
 
 /** basic stream operatons **/
 int AXIS2_CALL axutil_stream_write_basic(
@@ -314,7 +318,14 @@ axutil_stream_write_basic(
 
     new_len = (int)(stream->len + count);
     /* We are sure that the difference lies within the int range */
-    if (new_len > stream->max_len)
+    if (new_len <= stream->max_len && new_len > stream->max_len -
+        (int)(stream->buffer - stream->buffer_head))
+    {
+        /* the bytes already read leave room enough at the head */
+        memmove(stream->buffer_head, stream->buffer, stream->len);
+        stream->buffer = stream->buffer_head;
+    }
+    else if (new_len > stream->max_len)
     {
         axis2_char_t *tmp = (axis2_char_t *) AXIS2_MALLOC(env->allocator,
                                                           sizeof(axis2_char_t) *
@@ -683,6 +694,117 @@ axutil_stream_peek_socket(
     return len;
 }
 
+AXIS2_EXTERN axis2_status_t AXIS2_CALL
+axutil_stream_send_file(
+    axutil_stream_t *stream,
+    const axutil_env_t *env,
+    FILE *fp,
+    size_t count)
+{
+    axis2_char_t buffer[AXIS2_STREAM_DEFAULT_BUF_SIZE];
+    size_t sent = 0;
+
+    AXIS2_PARAM_CHECK(env->error, stream, AXIS2_FAILURE);
+    AXIS2_PARAM_CHECK(env->error, fp, AXIS2_FAILURE);
+
+#if defined(HAVE_SYS_SENDFILE_H) && !defined(AXIS2_TCPMON)
+    /* Only a plain socket stream can be bypassed; wrapped streams (SSL,
+     * Apache2 etc.) override the write function and must see every byte */
+    if (AXIS2_STREAM_SOCKET == stream->stream_type && -1 != stream->socket &&
+        axutil_stream_write_socket == stream->write)
+    {
+        off_t offset = 0;
+        ssize_t len = 0;
+        axis2_bool_t fallback = AXIS2_FALSE;
+
+        offset = ftello(fp);
+        while (sent < count)
+        {
+            len = sendfile(stream->socket, fileno(fp), &offset, count - sent);
+            if (len < 0)
+            {
+                if (EINTR == errno)
+                {
+                    continue;
+                }
+                if (EAGAIN == errno || EWOULDBLOCK == errno)
+                {
+                    /* a non blocking socket that is full, wait until it
+                       takes more */
+                    struct pollfd fds;
+
+                    fds.fd = stream->socket;
+                    fds.events = POLLOUT;
+                    fds.revents = 0;
+                    if (poll(&fds, 1, -1) >= 0 || EINTR == errno)
+                    {
+                        continue;
+                    }
+                }
+                if (0 == sent && (EINVAL == errno || ENOSYS == errno))
+                {
+                    /* file type not supported by sendfile, copy instead */
+                    fallback = AXIS2_TRUE;
+                    break;
+                }
+                AXIS2_ERROR_SET(env->error, AXIS2_ERROR_SOCKET_ERROR,
+                                AXIS2_FAILURE);
+                AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                                "sendfile failed with errno %d", errno);
+                return AXIS2_FAILURE;
+            }
+            if (0 == len)
+            {
+                break;
+            }
+            sent += (size_t)len;
+        }
+        /* keep the stdio position in sync with what went to the wire */
+        fseeko(fp, offset, SEEK_SET);
+        if (!fallback)
+        {
+            return sent == count ? AXIS2_SUCCESS : AXIS2_FAILURE;
+        }
+    }
+#endif
+
+    while (sent < count)
+    {
+        size_t to_read = count - sent;
+        size_t read = 0;
+        size_t written = 0;
+        int len = 0;
+
+        if (to_read > sizeof(buffer))
+        {
+            to_read = sizeof(buffer);
+        }
+        read = fread(buffer, 1, to_read, fp);
+        if (0 == read)
+        {
+            if (ferror(fp))
+            {
+                AXIS2_LOG_ERROR(env->log, AXIS2_LOG_SI,
+                                "Error in reading file to be sent");
+                return AXIS2_FAILURE;
+            }
+            break;
+        }
+        while (written < read)
+        {
+            len = axutil_stream_write(stream, env, buffer + written,
+                                      read - written);
+            if (len <= 0)
+            {
+                return AXIS2_FAILURE;
+            }
+            written += (size_t)len;
+        }
+        sent += read;
+    }
+    return sent == count ? AXIS2_SUCCESS : AXIS2_FAILURE;
+}
+
 /********************** End of Socket Stream Operations ***********************/
 
 AXIS2_EXTERN axis2_status_t AXIS2_CALL
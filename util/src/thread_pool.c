@@ -18,12 +18,37 @@
 #include <axutil_thread_pool.h>
 #include <axutil_env.h>
 #include <axutil_error_default.h>
+#ifndef WIN32
+#include <pthread.h>
+#endif
 
 struct axutil_thread_pool
 {
     axutil_allocator_t *allocator;
 };
 
+#ifndef WIN32
+/* holds the environment axutil_get_thread_env keeps for each thread */
+static pthread_key_t axutil_thread_env_key;
+static pthread_once_t axutil_thread_env_once = PTHREAD_ONCE_INIT;
+static axis2_bool_t axutil_thread_env_key_created = AXIS2_FALSE;
+
+static void
+axutil_thread_env_destroy(
+    void *thread_env)
+{
+    axutil_free_thread_env((axutil_env_t *) thread_env);
+}
+
+static void
+axutil_thread_env_key_create(void)
+{
+    axutil_thread_env_key_created =
+        (0 == pthread_key_create(&axutil_thread_env_key,
+                                 axutil_thread_env_destroy));
+}
+#endif
+
 AXIS2_EXTERN axutil_thread_pool_t *AXIS2_CALL
 axutil_thread_pool_init(
     axutil_allocator_t *allocator)
@@ -158,3 +183,77 @@ axutil_free_thread_env(
     }
     AXIS2_FREE(thread_env->allocator, thread_env);
 }
+
+AXIS2_EXTERN axutil_env_t *AXIS2_CALL
+axutil_get_thread_env(
+    const axutil_env_t *system_env)
+{
+#ifndef WIN32
+    axutil_env_t *thread_env = NULL;
+
+    pthread_once(&axutil_thread_env_once, axutil_thread_env_key_create);
+    if (!axutil_thread_env_key_created)
+    {
+        return axutil_init_thread_env(system_env);
+    }
+    thread_env = (axutil_env_t *) pthread_getspecific(axutil_thread_env_key);
+    if (thread_env && (thread_env->allocator != system_env->allocator ||
+                       thread_env->log != system_env->log ||
+                       thread_env->thread_pool != system_env->thread_pool))
+    {
+        /* kept for another system environment */
+        pthread_setspecific(axutil_thread_env_key, NULL);
+        axutil_free_thread_env(thread_env);
+        thread_env = NULL;
+    }
+    if (!thread_env)
+    {
+        /* if it cannot be kept, axutil_release_thread_env frees it */
+        thread_env = axutil_init_thread_env(system_env);
+        if (thread_env)
+        {
+            pthread_setspecific(axutil_thread_env_key, thread_env);
+        }
+    }
+    else
+    {
+        axutil_reset_thread_env(thread_env);
+    }
+    return thread_env;
+#else
+    return axutil_init_thread_env(system_env);
+#endif
+}
+
+AXIS2_EXTERN void AXIS2_CALL
+axutil_release_thread_env(
+    axutil_env_t *thread_env)
+{
+    if (!thread_env)
+    {
+        return;
+    }
+#ifndef WIN32
+    if (axutil_thread_env_key_created &&
+        pthread_getspecific(axutil_thread_env_key) == thread_env)
+    {
+        axutil_reset_thread_env(thread_env);
+        return;
+    }
+#endif
+    axutil_free_thread_env(thread_env);
+}
+
+AXIS2_EXTERN void AXIS2_CALL
+axutil_reset_thread_env(
+    axutil_env_t *thread_env)
+{
+    if (!thread_env || !thread_env->error)
+    {
+        return;
+    }
+    /* as axutil_error_create leaves them */
+    thread_env->error->error_number = AXIS2_ERROR_NONE;
+    thread_env->error->status_code = 0;
+    thread_env->error->message = NULL;
+}
@@ -0,0 +1,149 @@
+#include <string.h>
+#include <stdlib.h>
+#include "../util/create_env.h"
+#include <axutil_base64.h>
+
+#define MAX_LEN 1024
+
+static const char basis[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* byte at a time reference encoder */
+static int ref_encode(
+    char *encoded,
+    const unsigned char *plain,
+    int len)
+{
+    int i;
+    int n = 0;
+    unsigned long bits;
+
+    for (i = 0; i < len; i += 3)
+    {
+        bits = (unsigned long) plain[i] << 16;
+        if (i + 1 < len)
+            bits |= (unsigned long) plain[i + 1] << 8;
+        if (i + 2 < len)
+            bits |= plain[i + 2];
+        encoded[n++] = basis[(bits >> 18) & 0x3f];
+        encoded[n++] = basis[(bits >> 12) & 0x3f];
+        encoded[n++] = (i + 1 < len) ? basis[(bits >> 6) & 0x3f] : '=';
+        encoded[n++] = (i + 2 < len) ? basis[bits & 0x3f] : '=';
+    }
+    encoded[n++] = '\0';
+    return n;
+}
+
+/** @brief test encoding and decoding against the reference for every
+ *  length, so that both the vector blocks and the tails are covered
+ */
+axis2_status_t test_base64_round_trip(axutil_env_t *env)
+{
+    unsigned char plain[MAX_LEN];
+    unsigned char decoded[MAX_LEN + 16];
+    char encoded[MAX_LEN * 2];
+    char expected[MAX_LEN * 2];
+    int len, i, n;
+
+    for (i = 0; i < MAX_LEN; i++)
+        plain[i] = (unsigned char) (rand() & 0xff);
+
+    for (len = 0; len < MAX_LEN; len++)
+    {
+        n = axutil_base64_encode_binary(encoded, plain, len);
+        if (n != ref_encode(expected, plain, len) || strcmp(encoded, expected))
+        {
+            printf("Test axutil_base64_encode_binary failed for length %d\n", len);
+            return AXIS2_FAILURE;
+        }
+        if (axutil_base64_decode_len(encoded) != len)
+        {
+            printf("Test axutil_base64_decode_len failed for length %d\n", len);
+            return AXIS2_FAILURE;
+        }
+        n = axutil_base64_decode_binary(decoded, encoded);
+        if (n != len || memcmp(decoded, plain, len))
+        {
+            printf("Test axutil_base64_decode_binary failed for length %d\n", len);
+            return AXIS2_FAILURE;
+        }
+    }
+    printf("Test base64 round trip is successfull\n");
+    return AXIS2_SUCCESS;
+}
+
+/** @brief test the incremental decoder with line wrapped input fed in
+ *  pieces of every size
+ */
+axis2_status_t test_base64_decoder(axutil_env_t *env)
+{
+    unsigned char plain[MAX_LEN];
+    unsigned char decoded[MAX_LEN + 16];
+    char encoded[MAX_LEN * 2];
+    char wrapped[MAX_LEN * 3];
+    axutil_base64_decoder_t *decoder = NULL;
+    int i, j, n, len, step;
+
+    for (i = 0; i < MAX_LEN; i++)
+        plain[i] = (unsigned char) (rand() & 0xff);
+    axutil_base64_encode_binary(encoded, plain, MAX_LEN);
+
+    /* wrap at 76 chars as MIME encoders do */
+    for (i = 0, j = 0; encoded[i]; i++)
+    {
+        if (i && 0 == i % 76)
+        {
+            wrapped[j++] = '\r';
+            wrapped[j++] = '\n';
+        }
+        wrapped[j++] = encoded[i];
+    }
+    len = j;
+
+    for (step = 1; step < 200; step++)
+    {
+        decoder = axutil_base64_decoder_create(env);
+        n = 0;
+        for (i = 0; i < len; i += step)
+        {
+            n += axutil_base64_decoder_decode(decoder, env, decoded + n,
+                wrapped + i, (len - i < step) ? len - i : step);
+        }
+        n += axutil_base64_decoder_finish(decoder, env, decoded + n);
+        axutil_base64_decoder_free(decoder, env);
+        if (n != MAX_LEN || memcmp(decoded, plain, MAX_LEN))
+        {
+            printf("Test axutil_base64_decoder_decode failed for step %d\n", step);
+            return AXIS2_FAILURE;
+        }
+    }
+
+    /* unpadded input is flushed by finish */
+    decoder = axutil_base64_decoder_create(env);
+    n = axutil_base64_decoder_decode(decoder, env, decoded, "QUJD RA", 7);
+    n += axutil_base64_decoder_finish(decoder, env, decoded + n);
+    axutil_base64_decoder_free(decoder, env);
+    if (n != 4 || memcmp(decoded, "ABCD", 4))
+    {
+        printf("Test axutil_base64_decoder_finish failed\n");
+        return AXIS2_FAILURE;
+    }
+    printf("Test axutil_base64_decoder is successfull\n");
+    return AXIS2_SUCCESS;
+}
+
+int main()
+{
+    axutil_env_t *env = NULL;
+    int status = AXIS2_SUCCESS;
+    env = create_environment();
+    status = test_base64_round_trip(env);
+    if (status == AXIS2_SUCCESS)
+        status = test_base64_decoder(env);
+    if(status == AXIS2_FAILURE)
+    {
+        printf("build  failed");
+    }
+    axutil_env_free(env);
+    return status == AXIS2_SUCCESS ? 0 : 1;
+}
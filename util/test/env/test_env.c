@@ -1,6 +1,10 @@
 #include <stdio.h>
 #include <axutil_env.h>
 #include <axutil_properties.h>
+#include <axutil_thread_pool.h>
+#include <axutil_utils.h>
+#include <axutil_error_default.h>
+#include <axutil_log_default.h>
 #include "../test_common/axis2c_test_macros.h"
 
 #define THREAD_AMMOUNT 100
@@ -82,6 +86,58 @@ void test_thread_env()
     END_TEST_CASE();
 }
 
+void *AXIS2_CALL
+test_get_thread_env(
+    axutil_thread_t * td,
+    void *param)
+{
+    axutil_env_t **thread_env = (axutil_env_t **) param;
+
+    thread_env[1] = axutil_get_thread_env(thread_env[0]);
+    axutil_release_thread_env(thread_env[1]);
+
+    return (void *) 1;
+}
+
+void test_kept_thread_env()
+{
+    START_TEST_CASE("test_kept_thread_env");
+
+    axutil_env_t *env = NULL;
+    axutil_env_t *thread_env[2];
+    axutil_env_t *kept_env = NULL;
+    axutil_thread_t *thread = NULL;
+
+    env = axutil_env_create_all("test_kept_thread_env.log", AXIS2_LOG_LEVEL_TRACE);
+    TEST_ASSERT_VOID(env);
+
+    kept_env = axutil_get_thread_env(env);
+    EXPECT_NOT_NULL(kept_env);
+    AXIS2_ERROR_SET(kept_env->error, AXIS2_ERROR_NO_MEMORY, AXIS2_FAILURE);
+    axutil_release_thread_env(kept_env);
+
+    /* the same environment comes back, without the error */
+    EXPECT_EQ(axutil_get_thread_env(env), kept_env);
+    EXPECT_EQ(kept_env->error->error_number, AXIS2_ERROR_NONE);
+    EXPECT_NULL(kept_env->error->message);
+    EXPECT_EQ(kept_env->log, env->log);
+    axutil_release_thread_env(kept_env);
+
+    /* another thread has one of its own */
+    thread_env[0] = env;
+    thread_env[1] = NULL;
+    thread = axutil_thread_create(env->allocator, NULL, test_get_thread_env,
+                                  (void *) thread_env);
+    EXPECT_NOT_NULL(thread);
+    axutil_thread_join(thread);
+    EXPECT_NOT_NULL(thread_env[1]);
+    EXPECT_NEQ(thread_env[1], kept_env);
+
+    axutil_env_free(env);
+
+    END_TEST_CASE();
+}
+
 void *AXIS2_CALL
 test_ref(
     axutil_thread_t * td,
@@ -203,6 +259,7 @@ int main()
     test_create_env();
     test_log_env();
     test_thread_env();
+    test_kept_thread_env();
     test_reference_count();
     test_thread_env_reference_count();
     test_multiple_envs();
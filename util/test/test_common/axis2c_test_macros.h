@@ -14,8 +14,15 @@
 
 #define TEST_FAILURE_PRINT  printf("In %s:%i: failure\n",__FILE__, __LINE__);
 
+/* the counters are defined by the file with main, files with more test
+   cases of the same program define AXIS2C_TEST_CASES_ONLY first */
+#ifdef AXIS2C_TEST_CASES_ONLY
+extern int tests_ok;
+extern int tests_failures;
+#else
 int tests_ok;
 int tests_failures;
+#endif
 
 
 #define START_TEST() \
@@ -0,0 +1,249 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <test_archive_extract.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <utime.h>
+#include <axutil_array_list.h>
+#include <axutil_dir_handler.h>
+#include <axutil_file.h>
+#define AXIS2C_TEST_CASES_ONLY
+#include "../test_common/axis2c_test_macros.h"
+
+#ifdef AXIS2_ARCHIVE_ENABLED
+
+#define ARCHIVE_ENTRY "svc/services.xml"
+#define ARCHIVE_DATA "<service name=\"svc\"/>"
+
+static unsigned long
+archive_crc32(
+    const unsigned char *data,
+    size_t len)
+{
+    unsigned long crc = 0xffffffffUL;
+    size_t i = 0;
+    int bit = 0;
+
+    for (i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xedb88320UL & (0UL - (crc & 1)));
+        }
+    }
+    return crc ^ 0xffffffffUL;
+}
+
+static void
+archive_put16(
+    FILE *fp,
+    unsigned long value)
+{
+    fputc((int) (value & 0xff), fp);
+    fputc((int) ((value >> 8) & 0xff), fp);
+}
+
+static void
+archive_put32(
+    FILE *fp,
+    unsigned long value)
+{
+    archive_put16(fp, value & 0xffff);
+    archive_put16(fp, (value >> 16) & 0xffff);
+}
+
+/* Writes a zip archive holding ARCHIVE_ENTRY, stored without compression */
+static int
+archive_write(
+    const char *path)
+{
+    FILE *fp = fopen(path, "wb");
+    size_t name_len = strlen(ARCHIVE_ENTRY);
+    size_t data_len = strlen(ARCHIVE_DATA);
+    unsigned long crc = archive_crc32((const unsigned char *) ARCHIVE_DATA,
+        data_len);
+    unsigned long central = 0;
+
+    if (!fp)
+    {
+        return 0;
+    }
+    /* local file header */
+    archive_put32(fp, 0x04034b50UL);
+    archive_put16(fp, 10);
+    archive_put16(fp, 0);
+    archive_put16(fp, 0);
+    archive_put16(fp, 0);
+    archive_put16(fp, 0x21);
+    archive_put32(fp, crc);
+    archive_put32(fp, data_len);
+    archive_put32(fp, data_len);
+    archive_put16(fp, name_len);
+    archive_put16(fp, 0);
+    fputs(ARCHIVE_ENTRY, fp);
+    fputs(ARCHIVE_DATA, fp);
+    central = (unsigned long) ftell(fp);
+    /* central directory */
+    archive_put32(fp, 0x02014b50UL);
+    archive_put16(fp, 20);
+    archive_put16(fp, 10);
+    archive_put16(fp, 0);
+    archive_put16(fp, 0);
+    archive_put16(fp, 0);
+    archive_put16(fp, 0x21);
+    archive_put32(fp, crc);
+    archive_put32(fp, data_len);
+    archive_put32(fp, data_len);
+    archive_put16(fp, name_len);
+    archive_put16(fp, 0);
+    archive_put16(fp, 0);
+    archive_put16(fp, 0);
+    archive_put16(fp, 0);
+    archive_put32(fp, 0);
+    archive_put32(fp, 0);
+    fputs(ARCHIVE_ENTRY, fp);
+    /* end of central directory */
+    archive_put32(fp, 0x06054b50UL);
+    archive_put16(fp, 0);
+    archive_put16(fp, 0);
+    archive_put16(fp, 1);
+    archive_put16(fp, 1);
+    archive_put32(fp, (unsigned long) ftell(fp) - central - 12);
+    archive_put32(fp, central);
+    archive_put16(fp, 0);
+    return fclose(fp) == 0;
+}
+
+/* Returns non zero if the file at path holds exactly text */
+static int
+archive_file_is(
+    const char *path,
+    const char *text)
+{
+    char buffer[256];
+    size_t len = 0;
+    FILE *fp = fopen(path, "rb");
+
+    if (!fp)
+    {
+        return 0;
+    }
+    len = fread(buffer, 1, sizeof(buffer) - 1, fp);
+    fclose(fp);
+    buffer[len] = '\0';
+    return 0 == strcmp(buffer, text);
+}
+
+static void
+archive_write_text(
+    const char *path,
+    const char *text)
+{
+    FILE *fp = fopen(path, "wb");
+
+    if (fp)
+    {
+        fputs(text, fp);
+        fclose(fp);
+    }
+}
+
+/* Lists the directory as the deployment engine does, which extracts the
+ * archives in it first */
+static void
+archive_list(
+    const axutil_env_t *env,
+    const char *dir)
+{
+    axutil_array_list_t *list = NULL;
+    int i = 0;
+
+    list = axutil_dir_handler_list_service_or_module_dirs(env, dir);
+    if (list)
+    {
+        for (i = 0; i < axutil_array_list_size(list, env); i++)
+        {
+            axutil_file_free((axutil_file_t *) axutil_array_list_get(list,
+                env, i), env);
+        }
+        axutil_array_list_free(list, env);
+    }
+}
+
+/* An archive is extracted once and a marker is left next to it. It is not
+ * extracted again while it is unchanged, and is once it is touched */
+static void
+test_archive_extract_stamp(
+    const axutil_env_t *env)
+{
+    char dir[] = "/tmp/axis2_archiveXXXXXX";
+    char archive[64];
+    char marker[64];
+    char entry[64];
+    char subdir[64];
+    struct stat st;
+    struct utimbuf times;
+
+    START_TEST_CASE("test_archive_extract_stamp");
+    TEST_ASSERT_VOID(mkdtemp(dir));
+    sprintf(archive, "%s/svc.aar", dir);
+    sprintf(marker, "%s/.svc.aar.extracted", dir);
+    sprintf(entry, "%s/%s", dir, ARCHIVE_ENTRY);
+    sprintf(subdir, "%s/svc", dir);
+    EXPECT_EQ(archive_write(archive), 1);
+
+    archive_list(env, dir);
+    EXPECT_EQ(archive_file_is(entry, ARCHIVE_DATA), 1);
+    EXPECT_EQ(stat(marker, &st), 0);
+
+    /* unchanged, the extracted file is left alone */
+    archive_write_text(entry, "changed");
+    archive_list(env, dir);
+    EXPECT_EQ(archive_file_is(entry, "changed"), 1);
+
+    /* touched, it is extracted again */
+    EXPECT_EQ(stat(archive, &st), 0);
+    times.actime = st.st_atime;
+    times.modtime = st.st_mtime + 10;
+    EXPECT_EQ(utime(archive, &times), 0);
+    archive_list(env, dir);
+    EXPECT_EQ(archive_file_is(entry, ARCHIVE_DATA), 1);
+
+    unlink(entry);
+    rmdir(subdir);
+    unlink(marker);
+    unlink(archive);
+    rmdir(dir);
+    END_TEST_CASE();
+}
+
+#endif
+
+void
+test_archive_extract(
+    const axutil_env_t *env)
+{
+#ifdef AXIS2_ARCHIVE_ENABLED
+    test_archive_extract_stamp(env);
+#endif
+}
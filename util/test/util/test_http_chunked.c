@@ -0,0 +1,221 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <test_http_chunked.h>
+#include <stdio.h>
+#include <string.h>
+#include <axutil_string.h>
+#include <axutil_stream.h>
+#include <axutil_http_chunked_stream.h>
+#define AXIS2C_TEST_CASES_ONLY
+#include "../test_common/axis2c_test_macros.h"
+
+#define CHUNKED_BODY "5;name=value\r\nhello\r\nA\r\n0123456789\r\n" \
+    "1\r\n!\r\n0\r\nX-Trailer: 1\r\n\r\n"
+
+static axutil_stream_t *trickle_source = NULL;
+
+/* Hands out the source a few bytes at a time, as a slow socket would */
+static int AXIS2_CALL
+trickle_read(
+    axutil_stream_t *stream,
+    const axutil_env_t *env,
+    void *buffer,
+    size_t count)
+{
+    return axutil_stream_read(trickle_source, env, buffer, count < 3 ? count : 3);
+}
+
+static axutil_stream_t *
+create_source(
+    const axutil_env_t *env,
+    const axis2_char_t *data,
+    int len)
+{
+    axutil_stream_t *stream = axutil_stream_create_basic(env);
+    axutil_stream_write(stream, env, data, len);
+    return stream;
+}
+
+static void
+test_http_chunked_stream_round_trip(
+    const axutil_env_t *env)
+{
+    axutil_stream_t *stream = axutil_stream_create_basic(env);
+    axutil_http_chunked_stream_t *chunked_stream = NULL;
+    char buffer[64];
+    int len = 0;
+
+    START_TEST_CASE("test_http_chunked_stream_round_trip");
+    chunked_stream = axutil_http_chunked_stream_create(env, stream);
+    axutil_http_chunked_stream_write(chunked_stream, env, "hello", 5);
+    axutil_http_chunked_stream_write(chunked_stream, env, " world", 6);
+    axutil_http_chunked_stream_write_last_chunk(chunked_stream, env);
+
+    len = axutil_http_chunked_stream_read(chunked_stream, env, buffer,
+        sizeof(buffer) - 1);
+    EXPECT_EQ(len, 11);
+    buffer[len > 0 ? len : 0] = '\0';
+    EXPECT_STREQ(buffer, "hello world");
+    EXPECT_EQ(axutil_http_chunked_stream_get_end_of_chunks(chunked_stream,
+        env), AXIS2_TRUE);
+    EXPECT_EQ(axutil_http_chunked_stream_read(chunked_stream, env, buffer,
+        sizeof(buffer)), 0);
+
+    axutil_http_chunked_stream_free(chunked_stream, env);
+    axutil_stream_free(stream, env);
+    END_TEST_CASE();
+}
+
+static void
+test_http_chunked_stream_split_headers(
+    const axutil_env_t *env)
+{
+    axutil_stream_t *stream = axutil_stream_create_basic(env);
+    axutil_http_chunked_stream_t *chunked_stream = NULL;
+    char buffer[64];
+    int total = 0;
+    int len = 0;
+
+    START_TEST_CASE("test_http_chunked_stream_split_headers");
+    trickle_source = create_source(env, CHUNKED_BODY, strlen(CHUNKED_BODY));
+    axutil_stream_set_read(stream, env, trickle_read);
+    chunked_stream = axutil_http_chunked_stream_create(env, stream);
+
+    while ((len = axutil_http_chunked_stream_read(chunked_stream, env,
+        buffer + total, 4)) > 0)
+    {
+        total += len;
+    }
+    EXPECT_EQ(len, 0);
+    buffer[total] = '\0';
+    EXPECT_STREQ(buffer, "hello0123456789!");
+    EXPECT_EQ(axutil_http_chunked_stream_get_end_of_chunks(chunked_stream,
+        env), AXIS2_TRUE);
+    /* the trailer was read too */
+    EXPECT_EQ(axutil_stream_read(trickle_source, env, buffer, 1), 0);
+
+    axutil_http_chunked_stream_free(chunked_stream, env);
+    axutil_stream_free(trickle_source, env);
+    axutil_stream_free(stream, env);
+    END_TEST_CASE();
+}
+
+static void
+test_http_chunked_stream_slices(
+    const axutil_env_t *env)
+{
+    axutil_stream_t *stream = create_source(env, CHUNKED_BODY,
+        strlen(CHUNKED_BODY));
+    axutil_http_chunked_stream_t *chunked_stream = NULL;
+    const axis2_char_t *slice = NULL;
+    char buffer[64];
+    int total = 0;
+    int len = 0;
+
+    START_TEST_CASE("test_http_chunked_stream_slices");
+    chunked_stream = axutil_http_chunked_stream_create(env, stream);
+    while ((len = axutil_http_chunked_stream_read_slice(chunked_stream, env,
+        &slice)) > 0)
+    {
+        memcpy(buffer + total, slice, len);
+        total += len;
+    }
+    EXPECT_EQ(len, 0);
+    buffer[total] = '\0';
+    EXPECT_STREQ(buffer, "hello0123456789!");
+
+    axutil_http_chunked_stream_free(chunked_stream, env);
+    axutil_stream_free(stream, env);
+    END_TEST_CASE();
+}
+
+static void
+test_http_chunked_stream_large_chunk(
+    const axutil_env_t *env)
+{
+    axutil_stream_t *stream = axutil_stream_create_basic(env);
+    axutil_http_chunked_stream_t *chunked_stream = NULL;
+    int size = 20000;
+    char *data = AXIS2_MALLOC(env->allocator, size);
+    char *buffer = AXIS2_MALLOC(env->allocator, size);
+    int total = 0;
+    int len = 0;
+    int i = 0;
+
+    START_TEST_CASE("test_http_chunked_stream_large_chunk");
+    for (i = 0; i < size; i++)
+    {
+        data[i] = (char) ('a' + i % 26);
+    }
+    chunked_stream = axutil_http_chunked_stream_create(env, stream);
+    axutil_http_chunked_stream_write(chunked_stream, env, data, size);
+    axutil_http_chunked_stream_write_last_chunk(chunked_stream, env);
+
+    while (total < size && (len = axutil_http_chunked_stream_read(
+        chunked_stream, env, buffer + total, size - total)) > 0)
+    {
+        total += len;
+    }
+    EXPECT_EQ(total, size);
+    EXPECT_EQ(memcmp(data, buffer, size), 0);
+    EXPECT_EQ(axutil_http_chunked_stream_get_end_of_chunks(chunked_stream,
+        env), AXIS2_TRUE);
+
+    axutil_http_chunked_stream_free(chunked_stream, env);
+    axutil_stream_free(stream, env);
+    AXIS2_FREE(env->allocator, buffer);
+    AXIS2_FREE(env->allocator, data);
+    END_TEST_CASE();
+}
+
+static void
+test_http_chunked_stream_truncated(
+    const axutil_env_t *env)
+{
+    axutil_stream_t *stream = create_source(env, "5\r\nhel", 6);
+    axutil_http_chunked_stream_t *chunked_stream = NULL;
+    char buffer[16];
+
+    START_TEST_CASE("test_http_chunked_stream_truncated");
+    chunked_stream = axutil_http_chunked_stream_create(env, stream);
+    EXPECT_EQ(axutil_http_chunked_stream_read(chunked_stream, env, buffer,
+        sizeof(buffer)), 3);
+    EXPECT_EQ(axutil_http_chunked_stream_get_end_of_chunks(chunked_stream,
+        env), AXIS2_TRUE);
+    axutil_http_chunked_stream_free(chunked_stream, env);
+    axutil_stream_free(stream, env);
+
+    stream = create_source(env, "zz\r\n", 4);
+    chunked_stream = axutil_http_chunked_stream_create(env, stream);
+    EXPECT_EQ(axutil_http_chunked_stream_read(chunked_stream, env, buffer,
+        sizeof(buffer)), -1);
+    axutil_http_chunked_stream_free(chunked_stream, env);
+    axutil_stream_free(stream, env);
+    END_TEST_CASE();
+}
+
+void
+test_http_chunked_stream(
+    const axutil_env_t *env)
+{
+    test_http_chunked_stream_round_trip(env);
+    test_http_chunked_stream_split_headers(env);
+    test_http_chunked_stream_slices(env);
+    test_http_chunked_stream_large_chunk(env);
+    test_http_chunked_stream_truncated(env);
+}
@@ -24,6 +24,7 @@
 #include <axutil_allocator.h>
 #include <test_log.h>
 #include <string.h>
+#define AXIS2C_TEST_CASES_ONLY
 #include "../test_common/axis2c_test_macros.h"
 
 const axutil_env_t *
@@ -20,6 +20,7 @@
 #include <stdio.h>
 #include <axutil_string.h>
 #include <axutil_md5.h>
+#define AXIS2C_TEST_CASES_ONLY
 #include "../test_common/axis2c_test_macros.h"
 
 /* Digests a string and prints the result.
@@ -0,0 +1,294 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <test_send_file.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <axutil_string.h>
+#include <axutil_stream.h>
+#include <axutil_http_chunked_stream.h>
+#define AXIS2C_TEST_CASES_ONLY
+#include "../test_common/axis2c_test_macros.h"
+
+/* largest chunk a file is written in by the chunked stream */
+#define SEND_FILE_CHUNK_MAX 0x40000000
+
+/* the large file is a hole with data at its start, around the end of the
+   first chunk and at its end */
+#define SEND_FILE_TAIL 8202
+#define SEND_FILE_SIZE ((off_t) SEND_FILE_CHUNK_MAX + SEND_FILE_TAIL)
+#define SEND_FILE_REGION 4096
+
+#define SEND_FILE_BLOCK 65536
+
+static unsigned char
+send_file_byte(
+    off_t offset)
+{
+    return (unsigned char) ((offset * 31 + 7) & 0xff);
+}
+
+/* Fills block with the content of the large file from offset on */
+static void
+send_file_expected(
+    unsigned char *block,
+    off_t offset,
+    size_t len)
+{
+    static const off_t regions[3] = { 0,
+        (off_t) SEND_FILE_CHUNK_MAX - SEND_FILE_REGION,
+        SEND_FILE_SIZE - SEND_FILE_REGION };
+    static const off_t region_lens[3] = { SEND_FILE_REGION,
+        2 * SEND_FILE_REGION, SEND_FILE_REGION };
+    off_t o = 0;
+    off_t end = 0;
+    int i = 0;
+
+    memset(block, 0, len);
+    for (i = 0; i < 3; i++)
+    {
+        o = regions[i] > offset ? regions[i] : offset;
+        end = regions[i] + region_lens[i];
+        if (end > offset + (off_t) len)
+        {
+            end = offset + (off_t) len;
+        }
+        for (; o < end; o++)
+        {
+            block[o - offset] = send_file_byte(o);
+        }
+    }
+}
+
+static FILE *
+send_file_create_large(void)
+{
+    FILE *fp = tmpfile();
+    unsigned char block[2 * SEND_FILE_REGION];
+
+    if (!fp)
+    {
+        return NULL;
+    }
+    send_file_expected(block, 0, SEND_FILE_REGION);
+    fwrite(block, 1, SEND_FILE_REGION, fp);
+    send_file_expected(block, SEND_FILE_CHUNK_MAX - SEND_FILE_REGION,
+        2 * SEND_FILE_REGION);
+    fseeko(fp, SEND_FILE_CHUNK_MAX - SEND_FILE_REGION, SEEK_SET);
+    fwrite(block, 1, 2 * SEND_FILE_REGION, fp);
+    send_file_expected(block, SEND_FILE_SIZE - SEND_FILE_REGION,
+        SEND_FILE_REGION);
+    fseeko(fp, SEND_FILE_SIZE - SEND_FILE_REGION, SEEK_SET);
+    fwrite(block, 1, SEND_FILE_REGION, fp);
+    fflush(fp);
+    rewind(fp);
+    return fp;
+}
+
+static int
+send_file_read_exact(
+    int fd,
+    unsigned char *buffer,
+    size_t len)
+{
+    size_t done = 0;
+
+    while (done < len)
+    {
+        ssize_t got = read(fd, buffer + done, len - done);
+        if (got <= 0)
+        {
+            return 0;
+        }
+        done += (size_t) got;
+    }
+    return 1;
+}
+
+/* Reads len bytes and compares them with text */
+static int
+send_file_expect_text(
+    int fd,
+    const char *text)
+{
+    unsigned char buffer[32];
+    size_t len = strlen(text);
+
+    return send_file_read_exact(fd, buffer, len) &&
+        0 == memcmp(buffer, text, len);
+}
+
+/* Reads len bytes of chunk data and compares them with the file content at
+   offset */
+static int
+send_file_expect_data(
+    int fd,
+    off_t offset,
+    size_t len,
+    unsigned char *buffer,
+    unsigned char *expected)
+{
+    while (len > 0)
+    {
+        size_t block = len < SEND_FILE_BLOCK ? len : SEND_FILE_BLOCK;
+
+        if (!send_file_read_exact(fd, buffer, block))
+        {
+            return 0;
+        }
+        send_file_expected(expected, offset, block);
+        if (memcmp(buffer, expected, block))
+        {
+            printf("file data differs in the block at %ld\n", (long) offset);
+            return 0;
+        }
+        offset += (off_t) block;
+        len -= block;
+    }
+    return 1;
+}
+
+/* A file written through a basic stream, which copies it, byte for byte
+   with its chunk framing */
+static void
+test_send_file_copy(
+    const axutil_env_t *env)
+{
+    axutil_stream_t *stream = axutil_stream_create_basic(env);
+    axutil_http_chunked_stream_t *chunked_stream = NULL;
+    FILE *fp = tmpfile();
+    char data[5000];
+    char buffer[6000];
+    const char *header = "137e\r\n";
+    int len = 0;
+    int total = 0;
+    int i = 0;
+
+    START_TEST_CASE("test_send_file_copy");
+    TEST_ASSERT_VOID(fp);
+    for (i = 0; i < (int) sizeof(data); i++)
+    {
+        data[i] = (char) ('a' + i % 26);
+    }
+    fwrite(data, 1, sizeof(data), fp);
+    /* from the current position of the file on */
+    fseek(fp, 10, SEEK_SET);
+    chunked_stream = axutil_http_chunked_stream_create(env, stream);
+    EXPECT_EQ(axutil_http_chunked_stream_write_file(chunked_stream, env, fp,
+        sizeof(data) - 10), AXIS2_SUCCESS);
+    EXPECT_EQ((int) ftell(fp), (int) sizeof(data));
+    /* more bytes than the file has left */
+    fseek(fp, -5, SEEK_END);
+    EXPECT_EQ(axutil_http_chunked_stream_write_file(chunked_stream, env, fp,
+        10), AXIS2_FAILURE);
+    fclose(fp);
+    axutil_http_chunked_stream_free(chunked_stream, env);
+
+    while ((len = axutil_stream_read(stream, env, buffer + total,
+        sizeof(buffer) - total)) > 0)
+    {
+        total += len;
+    }
+    /* the chunk, then the header of the failed one and the 5 bytes left */
+    EXPECT_EQ(total, (int) (strlen(header) + sizeof(data) - 10 + 2 + 3 + 5));
+    EXPECT_EQ(memcmp(buffer, header, strlen(header)), 0);
+    EXPECT_EQ(memcmp(buffer + strlen(header), data + 10, sizeof(data) - 10),
+        0);
+    EXPECT_EQ(memcmp(buffer + strlen(header) + sizeof(data) - 10, "\r\na\r\n",
+        5), 0);
+    EXPECT_EQ(memcmp(buffer + strlen(header) + sizeof(data) - 5, data +
+        sizeof(data) - 5, 5), 0);
+    axutil_stream_free(stream, env);
+    END_TEST_CASE();
+}
+
+/* A file larger than a chunk written to a non blocking socket, through
+   sendfile where there is one, byte for byte with the framing of its two
+   chunks */
+static void
+test_send_file_chunks(
+    const axutil_env_t *env)
+{
+    FILE *fp = send_file_create_large();
+    unsigned char *buffer = NULL;
+    unsigned char *expected = NULL;
+    char header[32];
+    int fds[2];
+    int status = 0;
+    pid_t writer = 0;
+
+    START_TEST_CASE("test_send_file_chunks");
+    TEST_ASSERT_VOID(fp);
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+    {
+        fclose(fp);
+        TEST_ABORT("socketpair failed");
+    }
+    writer = fork();
+    if (0 == writer)
+    {
+        axutil_stream_t *stream = NULL;
+        axutil_http_chunked_stream_t *chunked_stream = NULL;
+        axis2_status_t sent = AXIS2_FAILURE;
+
+        close(fds[0]);
+        /* the reader is slower than sendfile, which has to wait for it */
+        fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+        stream = axutil_stream_create_socket(env, fds[1]);
+        chunked_stream = axutil_http_chunked_stream_create(env, stream);
+        sent = axutil_http_chunked_stream_write_file(chunked_stream, env, fp,
+            (size_t) SEND_FILE_SIZE);
+        close(fds[1]);
+        _exit(AXIS2_SUCCESS == sent && SEND_FILE_SIZE == ftello(fp) ? 0 : 1);
+    }
+    close(fds[1]);
+    fclose(fp);
+
+    buffer = (unsigned char *) malloc(SEND_FILE_BLOCK);
+    expected = (unsigned char *) malloc(SEND_FILE_BLOCK);
+    EXPECT_EQ(send_file_expect_text(fds[0], "40000000\r\n"), 1);
+    EXPECT_EQ(send_file_expect_data(fds[0], 0, SEND_FILE_CHUNK_MAX, buffer,
+        expected), 1);
+    sprintf(header, "\r\n%x\r\n", SEND_FILE_TAIL);
+    EXPECT_EQ(send_file_expect_text(fds[0], header), 1);
+    EXPECT_EQ(send_file_expect_data(fds[0], SEND_FILE_CHUNK_MAX,
+        SEND_FILE_TAIL, buffer, expected), 1);
+    EXPECT_EQ(send_file_expect_text(fds[0], "\r\n"), 1);
+    /* nothing after the last chunk */
+    EXPECT_EQ((int) read(fds[0], buffer, 1), 0);
+    close(fds[0]);
+    free(buffer);
+    free(expected);
+
+    waitpid(writer, &status, 0);
+    EXPECT_EQ(WIFEXITED(status) && 0 == WEXITSTATUS(status), 1);
+    END_TEST_CASE();
+}
+
+void
+test_send_file(
+    const axutil_env_t *env)
+{
+    test_send_file_copy(env);
+    test_send_file_chunks(env);
+}
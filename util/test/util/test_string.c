@@ -20,6 +20,7 @@
 #include <axutil_error_default.h>
 #include <axutil_log.h>
 #include <axutil_string.h>
+#define AXIS2C_TEST_CASES_ONLY
 #include "../test_common/axis2c_test_macros.h"
 
 void
@@ -17,6 +17,8 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <axutil_hash.h>
 #include <axutil_string.h>
 #include <axutil_error_default.h>
@@ -28,9 +30,14 @@
 #include <axutil_dir_handler.h>
 #include <axutil_thread_pool.h>
 #include <axutil_file.h>
+#include <axutil_stream.h>
+#include <axutil_free_list.h>
 #include "axutil_log.h"
 #include "test_thread.h"
 #include <test_log.h>
+#include <test_http_chunked.h>
+#include <test_send_file.h>
+#include <test_archive_extract.h>
 #include "../test_common/axis2c_test_macros.h"
 
 typedef struct a
@@ -461,6 +468,127 @@ void test_quote_string(
     END_TEST_CASE();
 }
 
+void test_stream_write_after_read(
+    const axutil_env_t *env)
+{
+    axutil_stream_t *stream = axutil_stream_create_basic(env);
+    char block[1000];
+    char buffer[1001];
+    int i = 0;
+
+    START_TEST_CASE("test_stream_write_after_read");
+    memset(block, 'x', sizeof(block));
+    for (i = 0; i < 10; i++)
+    {
+        EXPECT_EQ(axutil_stream_write(stream, env, block, sizeof(block)),
+            (int) sizeof(block));
+        EXPECT_EQ(axutil_stream_read(stream, env, buffer, sizeof(buffer)),
+            (int) sizeof(block));
+    }
+    EXPECT_EQ(memcmp(buffer, block, sizeof(block)), 0);
+    EXPECT_EQ(axutil_stream_get_len(stream, env), 0);
+    axutil_stream_free(stream, env);
+    END_TEST_CASE();
+}
+
+void test_hash_slots(
+    const axutil_env_t *env)
+{
+    static const axutil_hash_slot_key_t slot_keys[] = {
+        { "slot0", 5 },
+        { "slot1", 5 }
+    };
+    axutil_hash_t *ht = axutil_hash_make(env);
+    axutil_hash_t *copy = NULL;
+    char *v0 = "v0";
+    char *v1 = "v1";
+    char *other = "other";
+
+    START_TEST_CASE("test_hash_slots");
+    /* entries set before and after the slots are known */
+    axutil_hash_set(ht, "slot1", AXIS2_HASH_KEY_STRING, v1);
+    axutil_hash_set(ht, "other", AXIS2_HASH_KEY_STRING, other);
+    EXPECT_EQ(axutil_hash_set_slots(ht, env, slot_keys, 2), AXIS2_SUCCESS);
+    EXPECT_NULL(axutil_hash_get_slot(ht, 0));
+    EXPECT_EQ(axutil_hash_get_slot(ht, 1), v1);
+    axutil_hash_set(ht, "slot0", AXIS2_HASH_KEY_STRING, v0);
+    EXPECT_EQ(axutil_hash_get_slot(ht, 0), v0);
+    EXPECT_EQ(axutil_hash_get(ht, "slot0", AXIS2_HASH_KEY_STRING), v0);
+    EXPECT_EQ(axutil_hash_count(ht), 3);
+
+    /* replaced and deleted values, and slots that do not exist */
+    axutil_hash_set(ht, "slot0", AXIS2_HASH_KEY_STRING, other);
+    EXPECT_EQ(axutil_hash_get_slot(ht, 0), other);
+    axutil_hash_set(ht, "slot1", AXIS2_HASH_KEY_STRING, NULL);
+    EXPECT_NULL(axutil_hash_get_slot(ht, 1));
+    EXPECT_NULL(axutil_hash_get_slot(ht, 2));
+    EXPECT_NULL(axutil_hash_get_slot(ht, -1));
+
+    /* a copy has no slots */
+    copy = axutil_hash_copy(ht, env);
+    EXPECT_NULL(axutil_hash_get_slot(copy, 0));
+    EXPECT_EQ(axutil_hash_get(copy, "slot0", AXIS2_HASH_KEY_STRING), other);
+
+    axutil_hash_free(ht, env);
+    END_TEST_CASE();
+}
+
+static int test_free_list_mallocs = 0;
+static int test_free_list_frees = 0;
+
+static void *AXIS2_CALL
+test_free_list_malloc(
+    axutil_allocator_t * allocator,
+    size_t size)
+{
+    test_free_list_mallocs++;
+    return malloc(size);
+}
+
+static void AXIS2_CALL
+test_free_list_free(
+    axutil_allocator_t * allocator,
+    void *ptr)
+{
+    test_free_list_frees++;
+    free(ptr);
+}
+
+void test_free_list(
+    const axutil_env_t *env)
+{
+    axutil_allocator_t allocator;
+    void *obj = NULL;
+    void *other = NULL;
+
+    START_TEST_CASE("test_free_list");
+    memset(&allocator, 0, sizeof(allocator));
+    allocator.malloc_fn = test_free_list_malloc;
+    allocator.free_fn = test_free_list_free;
+
+    /* a freed object is kept for the next one of its size */
+    obj = axutil_free_list_malloc(&allocator, 48);
+    EXPECT_NOT_NULL(obj);
+    axutil_free_list_free(&allocator, obj, 48);
+    EXPECT_EQ(test_free_list_frees, 0);
+    EXPECT_EQ(axutil_free_list_malloc(&allocator, 48), obj);
+    other = axutil_free_list_malloc(&allocator, 64);
+    EXPECT_NEQ(other, obj);
+    EXPECT_EQ(test_free_list_mallocs, 2);
+    axutil_free_list_free(&allocator, obj, 48);
+    axutil_free_list_free(&allocator, other, 64);
+    axutil_free_list_release(&allocator);
+    EXPECT_EQ(test_free_list_frees, 2);
+
+    /* what is allocated out of a pool is not kept */
+    allocator.current_pool = &allocator;
+    obj = axutil_free_list_malloc(&allocator, 48);
+    axutil_free_list_free(&allocator, obj, 48);
+    EXPECT_EQ(test_free_list_mallocs, 3);
+    EXPECT_EQ(test_free_list_frees, 3);
+    END_TEST_CASE();
+}
+
 int
 main(
     void)
@@ -473,6 +601,12 @@ main(
     test_array_list(env);
     test_uuid_gen(env);
     test_md5(env);
+    test_http_chunked_stream(env);
+    test_send_file(env);
+    test_archive_extract(env);
+    test_stream_write_after_read(env);
+    test_hash_slots(env);
+    test_free_list(env);
     run_test_string(env);
     test_quote_string(env);
     test_parse_url(env);